@@ -55,6 +55,12 @@ namespace pcpp
 		PacketLogModuleSSHLayer, ///< SSHLayer module (Packet++)
 		PacketLogModuleTcpReassembly, ///< TcpReassembly module (Packet++)
 		PacketLogModuleIPReassembly, ///< IPReassembly module (Packet++)
+		PacketLogModuleIPFragmentation, ///< IPFragmentation module (Packet++)
+		PacketLogModulePacketGenerator, ///< PacketGenerator module (Packet++)
+		PacketLogModuleVoipCallTracker, ///< VoipCallTracker module (Packet++)
+		PacketLogModuleProtocolStats, ///< ProtocolStats module (Packet++)
+		PacketLogModuleDnsResponder, ///< DnsResponder module (Packet++)
+		PacketLogModulePacketBuilder, ///< PacketBuilder module (Packet++)
 		PcapLogModuleWinPcapLiveDevice, ///< WinPcapLiveDevice module (Pcap++)
 		PcapLogModuleRemoteDevice, ///< WinPcapRemoteDevice module (Pcap++)
 		PcapLogModuleLiveDevice, ///< PcapLiveDevice module (Pcap++)
@@ -63,6 +69,12 @@ namespace pcpp
 		PcapLogModuleMBufRawPacket, ///< MBufRawPacket module (Pcap++)
 		PcapLogModuleDpdkDevice, ///< DpdkDevice module (Pcap++)
 		PcapLogModuleKniDevice, ///< KniDevice module (Pcap++)
+		PcapLogModuleCaptureStream, ///< CaptureStreamServer and CaptureStreamClientDevice module (Pcap++)
+		PcapLogModuleXdpDevice, ///< XdpDevice module (Pcap++)
+		PcapLogModuleFlightRecorder, ///< PacketFlightRecorder module (Pcap++)
+		PcapLogModulePacketMerger, ///< PacketMerger module (Pcap++)
+		PcapLogModuleLoadBalancer, ///< PacketLoadBalancer module (Pcap++)
+		PcapLogModuleSharedMemoryRing, ///< SharedMemoryRingWriterDevice and SharedMemoryRingReaderDevice module (Pcap++)
 		NetworkUtils, ///< NetworkUtils module (Pcap++)
 		NumOfLogModules
 	};
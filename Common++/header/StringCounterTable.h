@@ -0,0 +1,186 @@
+#ifndef PCAPPP_STRING_COUNTER_TABLE
+#define PCAPPP_STRING_COUNTER_TABLE
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include <utility>
+
+/// @file
+
+/**
+ * \namespace pcpp
+ * \brief The main namespace for the PcapPlusPlus lib
+ */
+namespace pcpp
+{
+
+	/**
+	 * @struct PrehashedString
+	 * A string key for StringCounterTable: a pointer to characters that aren't necessarily NULL-terminated (for example a field inside
+	 * packet data), their length and their hash. The hash is computed once when the key is created, so a key that is used often (or
+	 * a string that is counted in more than one table) doesn't need to be hashed again. The key doesn't own or copy the characters
+	 */
+	struct PrehashedString
+	{
+		/** A pointer to the characters */
+		const char* data;
+		/** The number of characters */
+		size_t length;
+		/** The hash of the characters as computed by hashString() */
+		uint32_t hash;
+
+		/**
+		 * A c'tor that hashes the characters
+		 * @param[in] strData A pointer to the characters
+		 * @param[in] strLength The number of characters
+		 */
+		PrehashedString(const char* strData, size_t strLength) : data(strData), length(strLength), hash(hashString(strData, strLength)) {}
+
+		/**
+		 * A c'tor that hashes a string. The string must outlive the key
+		 * @param[in] str The string
+		 */
+		PrehashedString(const std::string& str) : data(str.c_str()), length(str.length()), hash(hashString(str.c_str(), str.length())) {}
+
+		/**
+		 * A c'tor for a key whose hash was already computed by hashString()
+		 * @param[in] strData A pointer to the characters
+		 * @param[in] strLength The number of characters
+		 * @param[in] strHash The hash of the characters
+		 */
+		PrehashedString(const char* strData, size_t strLength, uint32_t strHash) : data(strData), length(strLength), hash(strHash) {}
+
+		/**
+		 * Hash characters with 32-bit FNV-1a
+		 * @param[in] strData A pointer to the characters
+		 * @param[in] strLength The number of characters
+		 * @return The hash value
+		 */
+		static uint32_t hashString(const char* strData, size_t strLength);
+	};
+
+
+	/**
+	 * @class StringCounterTable
+	 * A hash table that counts occurrences of strings, such as hostnames or content types seen in traffic, without allocating memory for
+	 * every lookup like a std::map<std::string, int> does:
+	 * - The table is an open-addressing hash table with linear probing, keyed by PrehashedString. Looking up a string that is already in
+	 *   the table hashes nothing (the key carries its hash) and compares the characters of one entry in most cases
+	 * - The first time a string is counted its characters are copied ("interned") into large memory blocks owned by the table, so
+	 *   entries are small and adding a string allocates memory only when a block is full or the table grows
+	 * - Tables can be merged, which is how tables of different threads are combined for reporting. Merging reuses the stored hashes
+	 *
+	 * A max number of strings can be set so a table fed with untrusted traffic can't grow without a limit. Once it's reached, new strings
+	 * aren't added and their counts are summed in a single "other" counter. The class isn't thread-safe
+	 */
+	class StringCounterTable
+	{
+	public:
+
+		/**
+		 * A c'tor for this class
+		 * @param[in] maxNumOfStrings The max number of different strings to count. 0 means no limit. The default is 0
+		 */
+		StringCounterTable(size_t maxNumOfStrings = 0);
+
+		/**
+		 * A d'tor for this class, frees all memory
+		 */
+		~StringCounterTable();
+
+		/**
+		 * A copy c'tor for this class. The strings are interned again in the new table
+		 * @param[in] other The table to copy
+		 */
+		StringCounterTable(const StringCounterTable& other);
+
+		/**
+		 * Assignment operator for this class. The strings are interned again in this table
+		 * @param[in] other The table to copy
+		 * @return A reference to this table
+		 */
+		StringCounterTable& operator=(const StringCounterTable& other);
+
+		/**
+		 * Add to the count of a string. If the string isn't in the table it's added with this count, unless the table is full
+		 * @param[in] key The string
+		 * @param[in] count The number to add. The default is 1
+		 * @return The count of the string after it's updated, or 0 if the string isn't in the table and the table is full (the count is
+		 * added to the "other" counter in this case)
+		 */
+		uint64_t increment(const PrehashedString& key, uint64_t count = 1);
+
+		/**
+		 * Add to the count of a string. The string is hashed before it's looked up
+		 * @param[in] str A pointer to the characters of the string
+		 * @param[in] length The number of characters
+		 * @param[in] count The number to add. The default is 1
+		 * @return The count of the string after it's updated, or 0 if the table is full
+		 */
+		uint64_t increment(const char* str, size_t length, uint64_t count = 1) { return increment(PrehashedString(str, length), count); }
+
+		/**
+		 * @param[in] key The string
+		 * @return The count of the string or 0 if it's not in the table
+		 */
+		uint64_t getCount(const PrehashedString& key) const;
+
+		/**
+		 * @return The number of different strings in the table
+		 */
+		size_t size() const { return m_NumOfEntries; }
+
+		/**
+		 * @return The sum of counts of strings that weren't added because the table was full
+		 */
+		uint64_t getOtherCount() const { return m_OtherCount; }
+
+		/**
+		 * Add all counts of another table to this table, including its "other" counter
+		 * @param[in] other The table to merge into this one
+		 */
+		void merge(const StringCounterTable& other);
+
+		/**
+		 * Remove all strings and free the interned characters
+		 */
+		void clear();
+
+		/**
+		 * Get all strings and their counts
+		 * @param[out] result A vector the strings and their counts are appended to
+		 * @param[in] sortByCount If true the result is sorted by count in descending order (strings with the same count are sorted
+		 * alphabetically), otherwise the order is arbitrary. The default is true
+		 */
+		void getAll(std::vector<std::pair<std::string, uint64_t> >& result, bool sortByCount = true) const;
+
+	private:
+		struct Entry
+		{
+			const char* data;
+			uint32_t length;
+			uint32_t hash;
+			uint64_t count;
+		};
+
+		Entry* m_Entries;
+		size_t m_Capacity;
+		size_t m_NumOfEntries;
+		size_t m_MaxNumOfStrings;
+		uint64_t m_OtherCount;
+		std::vector<char*> m_Blocks;
+		size_t m_CurBlockUsed;
+		size_t m_CurBlockSize;
+
+		void init(size_t capacity);
+		void freeAll();
+		const char* intern(const char* str, size_t length);
+		Entry* findEntry(const PrehashedString& key) const;
+		void grow();
+	};
+
+} // namespace pcpp
+
+#endif /* PCAPPP_STRING_COUNTER_TABLE */
@@ -7,7 +7,16 @@
 
 /// @file
 
-#define MAX_NUM_OF_CORES 32
+/**
+ * The maximum number of cores PcapPlusPlus can address. Core IDs are in the range of 0 to MAX_NUM_OF_CORES-1. It can be overridden
+ * at build time but shouldn't exceed 256 since SystemCore#Id is an 8-bit value
+ */
+#ifndef MAX_NUM_OF_CORES
+#define MAX_NUM_OF_CORES 256
+#endif
+
+/// The number of 64-bit words needed for a bit mask of MAX_NUM_OF_CORES cores
+#define PCPP_CORE_MASK_NUM_OF_WORDS ((MAX_NUM_OF_CORES + 63) / 64)
 
 #ifdef _MSC_VER
 int gettimeofday(struct timeval * tp, struct timezone * tzp);
@@ -20,21 +29,140 @@ int gettimeofday(struct timeval * tp, struct timezone * tzp);
 namespace pcpp
 {
 
+	/**
+	 * @class CoreMask
+	 * A set of CPU cores represented as a bit mask where bit #N is set if core #N is in the set. Unlike a plain integer the mask isn't
+	 * limited to 32 or 64 cores: it has room for MAX_NUM_OF_CORES cores. The bits are kept in a fixed-size array so a CoreMask never
+	 * allocates memory, and masks created from integers (like the ones in SystemCores) are initialized statically.
+	 * For backward compatibility a CoreMask can be implicitly constructed from an integer and supports the bitwise operators that were
+	 * used with the integer representation, so code like <code>CoreMask mask = 0x3; mask |= SystemCores::Core5.Mask;</code> still works
+	 */
+	class CoreMask
+	{
+	public:
+#if __cplusplus >= 201103L || _MSC_VER >= 1900
+		/**
+		 * A c'tor that creates an empty core mask
+		 */
+		constexpr CoreMask() : m_Words{} {}
+
+		/**
+		 * A c'tor that creates a core mask from an integer where bit #N represents core #N. This c'tor is intentionally not explicit
+		 * so integers can be used where a CoreMask is expected
+		 * @param[in] mask The mask of the first 64 cores
+		 */
+		constexpr CoreMask(uint64_t mask) : m_Words{mask} {}
+#else
+		/**
+		 * A c'tor that creates an empty core mask
+		 */
+		CoreMask() { clear(0); }
+
+		/**
+		 * A c'tor that creates a core mask from an integer where bit #N represents core #N. This c'tor is intentionally not explicit
+		 * so integers can be used where a CoreMask is expected
+		 * @param[in] mask The mask of the first 64 cores
+		 */
+		CoreMask(uint64_t mask) { clear(mask); }
+#endif
+
+		/**
+		 * Add a core to the mask
+		 * @param[in] coreId The core ID to add. IDs outside the range of 0 to MAX_NUM_OF_CORES-1 are ignored
+		 */
+		void setCore(int coreId);
+
+		/**
+		 * Remove a core from the mask
+		 * @param[in] coreId The core ID to remove
+		 */
+		void clearCore(int coreId);
+
+		/**
+		 * @param[in] coreId The core ID to look for
+		 * @return True if the core is in the mask, false otherwise
+		 */
+		bool isCoreSet(int coreId) const;
+
+		/**
+		 * @return True if no core is set in the mask, false otherwise
+		 */
+		bool isEmpty() const;
+
+		/**
+		 * @return The number of cores set in the mask
+		 */
+		int getCoreCount() const;
+
+		/**
+		 * @return The lowest core ID set in the mask or -1 if the mask is empty
+		 */
+		int getFirstCore() const { return getNextCore(-1); }
+
+		/**
+		 * Find the next core set in the mask. Together with getFirstCore() it can be used for iterating over the cores in the mask:
+		 * <code>for (int coreId = mask.getFirstCore(); coreId >= 0; coreId = mask.getNextCore(coreId))</code>
+		 * @param[in] coreId The core ID to start the search after
+		 * @return The lowest core ID in the mask which is greater than coreId or -1 if there is no such core
+		 */
+		int getNextCore(int coreId) const;
+
+		/**
+		 * @return The highest core ID set in the mask or -1 if the mask is empty
+		 */
+		int getLastCore() const;
+
+		/**
+		 * @return The first 64 cores of the mask as an integer. Cores with higher IDs are ignored
+		 */
+		uint64_t toUint64() const { return m_Words[0]; }
+
+		/**
+		 * @return The mask as a hex string without leading zeros, for example "0x1ff" or "0x100000000000000000". This is the format
+		 * used by the DPDK EAL "-c" parameter
+		 */
+		std::string toHexString() const;
+
+		CoreMask operator|(const CoreMask& other) const;
+		CoreMask operator&(const CoreMask& other) const;
+
+		/**
+		 * Complement the mask. The result contains all cores up to MAX_NUM_OF_CORES which aren't in the original mask
+		 */
+		CoreMask operator~() const;
+
+		CoreMask& operator|=(const CoreMask& other);
+		CoreMask& operator&=(const CoreMask& other);
+		bool operator==(const CoreMask& other) const;
+		bool operator!=(const CoreMask& other) const { return !(*this == other); }
+
+	private:
+		uint64_t m_Words[PCPP_CORE_MASK_NUM_OF_WORDS];
+
+#if __cplusplus < 201103L && !(_MSC_VER >= 1900)
+		void clear(uint64_t firstWord)
+		{
+			m_Words[0] = firstWord;
+			for (int i = 1; i < PCPP_CORE_MASK_NUM_OF_WORDS; i++)
+				m_Words[i] = 0;
+		}
+#endif
+	};
+
 	/**
 	 * @struct SystemCore
-	 * Represents data of 1 CPU core. Current implementation supports up to 32 cores
+	 * Represents data of 1 CPU core. Current implementation supports up to MAX_NUM_OF_CORES cores
 	 */
 	struct SystemCore
 	{
 		/**
-		 * Core position in a 32-bit mask. For each core this attribute holds a 4B integer where only 1 bit is set, according to the core ID.
-		 * For example: in core #0 the right-most bit will be set (meaning the number 0x01);
-		 * 				in core #5 the 5th right-most bit will be set (meaning the number 0x20)...
+		 * A core mask with only this core set. For example: in core #0 only the right-most bit will be set (meaning the number 0x01);
+		 * 				in core #5 only the 5th right-most bit will be set (meaning the number 0x20)...
 		 */
-		uint32_t Mask;
+		CoreMask Mask;
 
 		/**
-		 * Core ID - a value between 0 and 31
+		 * Core ID - a value between 0 and MAX_NUM_OF_CORES-1
 		 */
 		uint8_t Id;
 
@@ -45,9 +173,25 @@ namespace pcpp
 		bool operator==(const SystemCore& other) const { return Id == other.Id; }
 	};
 
+	/**
+	 * @struct SystemCoreTable
+	 * Maps a core ID (integer) to a SystemCore struct, for example: <code>SystemCores::IdToSystemCore[40].Mask</code>. It holds no data:
+	 * each SystemCore is created on access, so it's safe to use from the static initialization of other translation units
+	 */
+	struct SystemCoreTable
+	{
+		/**
+		 * @param[in] coreId A core ID between 0 and MAX_NUM_OF_CORES-1
+		 * @return The SystemCore struct of this core ID
+		 */
+		SystemCore operator[](int coreId) const;
+	};
+
 	/**
 	 * @struct SystemCores
-	 * Contains static representation to all 32 cores and a static array to map core ID (integer) to a SystemCore struct
+	 * Contains static representation to the first 32 cores and a static table to map core ID (integer) to a SystemCore struct.
+	 * The table is always initialized statically, and so are the cores when compiling with C++11 or later (a C++98 compiler may
+	 * initialize them dynamically since CoreMask has constructors)
 	 */
 	struct SystemCores
 	{
@@ -181,13 +325,11 @@ namespace pcpp
 		static const SystemCore Core31;
 
 		/**
-		 * A static array for mapping core ID (integer) to the corresponding static SystemCore representation
+		 * A static table for mapping core ID (integer) to the corresponding SystemCore representation
 		 */
-		static const SystemCore IdToSystemCore[MAX_NUM_OF_CORES];
+		static const SystemCoreTable IdToSystemCore;
 	};
 
-	typedef uint32_t CoreMask;
-
 	/**
 	 * Get total number of cores on device
 	 * @return Total number of CPU cores on device
@@ -222,7 +364,58 @@ namespace pcpp
 	 * @param[in] coreMask The input core mask
 	 * @param[out] resultVec The vector that will contain the system cores
 	 */
-	void createCoreVectorFromCoreMask(CoreMask coreMask, std::vector<SystemCore>& resultVec);
+	void createCoreVectorFromCoreMask(const CoreMask& coreMask, std::vector<SystemCore>& resultVec);
+
+	/**
+	 * @struct SystemCoreTopology
+	 * The location of a single logical core in the machine topology: its CPU socket, physical core, SMT (hyper-threading) siblings
+	 * and NUMA node
+	 */
+	struct SystemCoreTopology
+	{
+		/** The logical core ID */
+		int CoreId;
+		/** The physical package (CPU socket) the core belongs to */
+		int SocketId;
+		/** The physical core ID inside its socket. SMT siblings share the same SocketId and PhysicalCoreId */
+		int PhysicalCoreId;
+		/** The NUMA node the core belongs to */
+		int NumaNode;
+		/** All logical cores sharing the physical core with this core, including this core */
+		CoreMask SmtSiblings;
+	};
+
+	/**
+	 * Read the topology of all online cores. On Linux the data is read from sysfs (/sys/devices/system/cpu and
+	 * /sys/devices/system/node). On other platforms, or if sysfs isn't available, each core is reported as a separate physical core
+	 * on socket 0 and NUMA node 0
+	 * @param[out] result A vector that will contain the topology of each online core, sorted by core ID
+	 * @return True if the topology was read from the operating system, false if the fallback topology was used
+	 */
+	bool getSystemCoreTopology(std::vector<SystemCoreTopology>& result);
+
+	/**
+	 * Create a core mask of all online cores on a certain CPU socket
+	 * @param[in] socketId The socket (physical package) ID
+	 * @return A core mask of the cores on this socket. The mask is empty if the socket doesn't exist
+	 */
+	CoreMask getCoreMaskForSocket(int socketId);
+
+	/**
+	 * Create a core mask of all online cores which belong to a certain NUMA node. This is useful for running capture threads on
+	 * the NUMA node the NIC is attached to
+	 * @param[in] numaNode The NUMA node ID
+	 * @return A core mask of the cores on this NUMA node. The mask is empty if the node doesn't exist
+	 */
+	CoreMask getCoreMaskForNumaNode(int numaNode);
+
+	/**
+	 * Remove SMT (hyper-threading) siblings from a core mask so only one logical core per physical core remains (the one with the
+	 * lowest ID). This is useful for spreading busy-polling threads over physical cores
+	 * @param[in] coreMask The input core mask
+	 * @return A core mask that contains at most one logical core of each physical core
+	 */
+	CoreMask getCoreMaskWithoutSmtSiblings(const CoreMask& coreMask);
 
 	/**
 	 * Execute a shell command and return its output
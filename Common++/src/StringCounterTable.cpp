@@ -0,0 +1,210 @@
+#include "StringCounterTable.h"
+#include <string.h>
+#include <algorithm>
+
+namespace pcpp
+{
+
+#define PCPP_STRING_COUNTER_INITIAL_CAPACITY 64
+#define PCPP_STRING_COUNTER_BLOCK_SIZE (16 * 1024)
+
+uint32_t PrehashedString::hashString(const char* strData, size_t strLength)
+{
+	uint32_t hash = 2166136261U;
+	for (size_t i = 0; i < strLength; i++)
+	{
+		hash ^= (uint8_t)strData[i];
+		hash *= 16777619U;
+	}
+
+	return hash;
+}
+
+static bool compareByCount(const std::pair<std::string, uint64_t>& first, const std::pair<std::string, uint64_t>& second)
+{
+	if (first.second == second.second)
+		return first.first < second.first;
+
+	return first.second > second.second;
+}
+
+StringCounterTable::StringCounterTable(size_t maxNumOfStrings) : m_MaxNumOfStrings(maxNumOfStrings)
+{
+	init(PCPP_STRING_COUNTER_INITIAL_CAPACITY);
+}
+
+StringCounterTable::~StringCounterTable()
+{
+	freeAll();
+}
+
+StringCounterTable::StringCounterTable(const StringCounterTable& other) : m_MaxNumOfStrings(other.m_MaxNumOfStrings)
+{
+	init(PCPP_STRING_COUNTER_INITIAL_CAPACITY);
+	merge(other);
+}
+
+StringCounterTable& StringCounterTable::operator=(const StringCounterTable& other)
+{
+	if (this == &other)
+		return *this;
+
+	clear();
+	m_MaxNumOfStrings = other.m_MaxNumOfStrings;
+	merge(other);
+	return *this;
+}
+
+void StringCounterTable::init(size_t capacity)
+{
+	m_Capacity = capacity;
+	m_Entries = new Entry[m_Capacity];
+	memset(m_Entries, 0, sizeof(Entry) * m_Capacity);
+	m_NumOfEntries = 0;
+	m_OtherCount = 0;
+	m_CurBlockUsed = 0;
+	m_CurBlockSize = 0;
+}
+
+void StringCounterTable::freeAll()
+{
+	delete [] m_Entries;
+	m_Entries = NULL;
+	for (std::vector<char*>::iterator iter = m_Blocks.begin(); iter != m_Blocks.end(); iter++)
+		delete [] *iter;
+	m_Blocks.clear();
+}
+
+void StringCounterTable::clear()
+{
+	freeAll();
+	init(PCPP_STRING_COUNTER_INITIAL_CAPACITY);
+}
+
+const char* StringCounterTable::intern(const char* str, size_t length)
+{
+	if (length == 0)
+		return "";
+
+	if (m_CurBlockSize - m_CurBlockUsed < length)
+	{
+		// a string longer than a block gets a block of its own
+		m_CurBlockSize = std::max(length, (size_t)PCPP_STRING_COUNTER_BLOCK_SIZE);
+		m_Blocks.push_back(new char[m_CurBlockSize]);
+		m_CurBlockUsed = 0;
+	}
+
+	char* result = m_Blocks.back() + m_CurBlockUsed;
+	memcpy(result, str, length);
+	m_CurBlockUsed += length;
+	return result;
+}
+
+StringCounterTable::Entry* StringCounterTable::findEntry(const PrehashedString& key) const
+{
+	size_t mask = m_Capacity - 1;
+	for (size_t index = key.hash & mask; ; index = (index + 1) & mask)
+	{
+		Entry* entry = &m_Entries[index];
+		if (entry->data == NULL)
+			return entry;
+
+		if (entry->hash == key.hash && entry->length == key.length && memcmp(entry->data, key.data, key.length) == 0)
+			return entry;
+	}
+}
+
+void StringCounterTable::grow()
+{
+	Entry* oldEntries = m_Entries;
+	size_t oldCapacity = m_Capacity;
+
+	m_Capacity *= 2;
+	m_Entries = new Entry[m_Capacity];
+	memset(m_Entries, 0, sizeof(Entry) * m_Capacity);
+
+	// the interned characters don't move, only the entries are rehashed by their stored hash
+	size_t mask = m_Capacity - 1;
+	for (size_t i = 0; i < oldCapacity; i++)
+	{
+		if (oldEntries[i].data == NULL)
+			continue;
+
+		size_t index = oldEntries[i].hash & mask;
+		while (m_Entries[index].data != NULL)
+			index = (index + 1) & mask;
+		m_Entries[index] = oldEntries[i];
+	}
+
+	delete [] oldEntries;
+}
+
+uint64_t StringCounterTable::increment(const PrehashedString& key, uint64_t count)
+{
+	Entry* entry = findEntry(key);
+	if (entry->data != NULL)
+	{
+		entry->count += count;
+		return entry->count;
+	}
+
+	if ((m_MaxNumOfStrings != 0 && m_NumOfEntries >= m_MaxNumOfStrings) || key.length > 0xffffffff)
+	{
+		m_OtherCount += count;
+		return 0;
+	}
+
+	// keep the load factor under 3/4 so probe sequences stay short
+	if ((m_NumOfEntries + 1) * 4 > m_Capacity * 3)
+	{
+		grow();
+		entry = findEntry(key);
+	}
+
+	entry->data = intern(key.data, key.length);
+	entry->length = (uint32_t)key.length;
+	entry->hash = key.hash;
+	entry->count = count;
+	m_NumOfEntries++;
+	return count;
+}
+
+uint64_t StringCounterTable::getCount(const PrehashedString& key) const
+{
+	Entry* entry = findEntry(key);
+	return (entry->data != NULL ? entry->count : 0);
+}
+
+void StringCounterTable::merge(const StringCounterTable& other)
+{
+	if (this == &other)
+	{
+		StringCounterTable copy(other);
+		merge(copy);
+		return;
+	}
+
+	for (size_t i = 0; i < other.m_Capacity; i++)
+	{
+		const Entry& otherEntry = other.m_Entries[i];
+		if (otherEntry.data != NULL)
+			increment(PrehashedString(otherEntry.data, otherEntry.length, otherEntry.hash), otherEntry.count);
+	}
+
+	m_OtherCount += other.m_OtherCount;
+}
+
+void StringCounterTable::getAll(std::vector<std::pair<std::string, uint64_t> >& result, bool sortByCount) const
+{
+	size_t firstNewItem = result.size();
+	for (size_t i = 0; i < m_Capacity; i++)
+	{
+		if (m_Entries[i].data != NULL)
+			result.push_back(std::make_pair(std::string(m_Entries[i].data, m_Entries[i].length), m_Entries[i].count));
+	}
+
+	if (sortByCount)
+		std::sort(result.begin() + firstNewItem, result.end(), compareByCount);
+}
+
+} // namespace pcpp
@@ -11,6 +11,10 @@
 #include <signal.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
 #ifdef MAC_OS_X
 #include <mach/clock.h>
 #include <mach/mach.h>
@@ -85,41 +89,198 @@ const SystemCore SystemCores::Core29 = { 0x20000000, 29 };
 const SystemCore SystemCores::Core30 = { 0x40000000, 30 };
 const SystemCore SystemCores::Core31 = { 0x80000000, 31 };
 
-const SystemCore SystemCores::IdToSystemCore[MAX_NUM_OF_CORES] =
-{
-	SystemCores::Core0,
-	SystemCores::Core1,
-	SystemCores::Core2,
-	SystemCores::Core3,
-	SystemCores::Core4,
-	SystemCores::Core5,
-	SystemCores::Core6,
-	SystemCores::Core7,
-	SystemCores::Core8,
-	SystemCores::Core9,
-	SystemCores::Core10,
-	SystemCores::Core11,
-	SystemCores::Core12,
-	SystemCores::Core13,
-	SystemCores::Core14,
-	SystemCores::Core15,
-	SystemCores::Core16,
-	SystemCores::Core17,
-	SystemCores::Core18,
-	SystemCores::Core19,
-	SystemCores::Core20,
-	SystemCores::Core21,
-	SystemCores::Core22,
-	SystemCores::Core23,
-	SystemCores::Core24,
-	SystemCores::Core25,
-	SystemCores::Core26,
-	SystemCores::Core27,
-	SystemCores::Core28,
-	SystemCores::Core29,
-	SystemCores::Core30,
-	SystemCores::Core31
-};
+const SystemCoreTable SystemCores::IdToSystemCore = {};
+
+SystemCore SystemCoreTable::operator[](int coreId) const
+{
+	SystemCore result;
+	result.Mask.setCore(coreId);
+	result.Id = (uint8_t)coreId;
+	return result;
+}
+
+
+#define PCPP_CORE_MASK_WORD_BITS 64
+
+void CoreMask::setCore(int coreId)
+{
+	if (coreId < 0 || coreId >= MAX_NUM_OF_CORES)
+		return;
+
+	m_Words[coreId / PCPP_CORE_MASK_WORD_BITS] |= ((uint64_t)1 << (coreId % PCPP_CORE_MASK_WORD_BITS));
+}
+
+void CoreMask::clearCore(int coreId)
+{
+	if (coreId < 0 || coreId >= MAX_NUM_OF_CORES)
+		return;
+
+	m_Words[coreId / PCPP_CORE_MASK_WORD_BITS] &= ~((uint64_t)1 << (coreId % PCPP_CORE_MASK_WORD_BITS));
+}
+
+bool CoreMask::isCoreSet(int coreId) const
+{
+	if (coreId < 0 || coreId >= MAX_NUM_OF_CORES)
+		return false;
+
+	return (m_Words[coreId / PCPP_CORE_MASK_WORD_BITS] & ((uint64_t)1 << (coreId % PCPP_CORE_MASK_WORD_BITS))) != 0;
+}
+
+bool CoreMask::isEmpty() const
+{
+	for (int i = 0; i < PCPP_CORE_MASK_NUM_OF_WORDS; i++)
+	{
+		if (m_Words[i] != 0)
+			return false;
+	}
+
+	return true;
+}
+
+int CoreMask::getCoreCount() const
+{
+	int result = 0;
+	for (int i = 0; i < PCPP_CORE_MASK_NUM_OF_WORDS; i++)
+	{
+		uint64_t word = m_Words[i];
+		while (word != 0)
+		{
+			word &= (word - 1);
+			result++;
+		}
+	}
+
+	return result;
+}
+
+int CoreMask::getNextCore(int coreId) const
+{
+	int curCoreId = (coreId < 0 ? 0 : coreId + 1);
+	while (curCoreId < MAX_NUM_OF_CORES)
+	{
+		uint64_t bits = m_Words[curCoreId / PCPP_CORE_MASK_WORD_BITS] >> (curCoreId % PCPP_CORE_MASK_WORD_BITS);
+		if (bits == 0)
+		{
+			// skip to the next word
+			curCoreId = (curCoreId / PCPP_CORE_MASK_WORD_BITS + 1) * PCPP_CORE_MASK_WORD_BITS;
+			continue;
+		}
+
+		while ((bits & 1) == 0)
+		{
+			bits >>= 1;
+			curCoreId++;
+		}
+
+		return curCoreId;
+	}
+
+	return -1;
+}
+
+int CoreMask::getLastCore() const
+{
+	for (int wordIndex = PCPP_CORE_MASK_NUM_OF_WORDS - 1; wordIndex >= 0; wordIndex--)
+	{
+		uint64_t word = m_Words[wordIndex];
+		if (word == 0)
+			continue;
+
+		int bit = PCPP_CORE_MASK_WORD_BITS - 1;
+		while ((word & ((uint64_t)1 << bit)) == 0)
+			bit--;
+
+		return wordIndex * PCPP_CORE_MASK_WORD_BITS + bit;
+	}
+
+	return -1;
+}
+
+std::string CoreMask::toHexString() const
+{
+	std::stringstream stream;
+	stream << "0x" << std::hex;
+
+	bool leadingWordWritten = false;
+	for (int wordIndex = PCPP_CORE_MASK_NUM_OF_WORDS - 1; wordIndex >= 0; wordIndex--)
+	{
+		if (!leadingWordWritten)
+		{
+			if (m_Words[wordIndex] == 0 && wordIndex > 0)
+				continue;
+
+			stream << m_Words[wordIndex];
+			leadingWordWritten = true;
+		}
+		else
+		{
+			stream << std::setw(16) << std::setfill('0') << m_Words[wordIndex];
+		}
+	}
+
+	return stream.str();
+}
+
+CoreMask CoreMask::operator|(const CoreMask& other) const
+{
+	CoreMask result = *this;
+	result |= other;
+	return result;
+}
+
+CoreMask CoreMask::operator&(const CoreMask& other) const
+{
+	CoreMask result = *this;
+	result &= other;
+	return result;
+}
+
+CoreMask CoreMask::operator~() const
+{
+	CoreMask result;
+	for (int i = 0; i < PCPP_CORE_MASK_NUM_OF_WORDS; i++)
+	{
+		result.m_Words[i] = ~m_Words[i];
+	}
+
+	// clear bits above MAX_NUM_OF_CORES
+	if (MAX_NUM_OF_CORES % PCPP_CORE_MASK_WORD_BITS != 0)
+		result.m_Words[PCPP_CORE_MASK_NUM_OF_WORDS - 1] &= (((uint64_t)1 << (MAX_NUM_OF_CORES % PCPP_CORE_MASK_WORD_BITS)) - 1);
+
+	return result;
+}
+
+CoreMask& CoreMask::operator|=(const CoreMask& other)
+{
+	for (int i = 0; i < PCPP_CORE_MASK_NUM_OF_WORDS; i++)
+	{
+		m_Words[i] |= other.m_Words[i];
+	}
+
+	return *this;
+}
+
+CoreMask& CoreMask::operator&=(const CoreMask& other)
+{
+	for (int i = 0; i < PCPP_CORE_MASK_NUM_OF_WORDS; i++)
+	{
+		m_Words[i] &= other.m_Words[i];
+	}
+
+	return *this;
+}
+
+bool CoreMask::operator==(const CoreMask& other) const
+{
+	for (int i = 0; i < PCPP_CORE_MASK_NUM_OF_WORDS; i++)
+	{
+		if (m_Words[i] != other.m_Words[i])
+			return false;
+	}
+
+	return true;
+}
+
 
 
 int getNumOfCores()
@@ -135,11 +296,11 @@ int getNumOfCores()
 
 CoreMask getCoreMaskForAllMachineCores()
 {
-	int numOfCores = getNumOfCores() < 32 ? getNumOfCores() : 32;
-	CoreMask result = 0;
+	int numOfCores = getNumOfCores() < MAX_NUM_OF_CORES ? getNumOfCores() : MAX_NUM_OF_CORES;
+	CoreMask result;
 	for (int i = 0; i < numOfCores; i++)
 	{
-		result = result | SystemCores::IdToSystemCore[i].Mask;
+		result.setCore(i);
 	}
 
 	return result;
@@ -161,25 +322,197 @@ CoreMask createCoreMaskFromCoreIds(std::vector<int> coreIds)
 	CoreMask result = 0;
 	for (std::vector<int>::iterator iter = coreIds.begin(); iter != coreIds.end(); iter++)
 	{
-		result |= SystemCores::IdToSystemCore[*iter].Mask;
+		result.setCore(*iter);
 	}
 
 	return result;
 }
 
-void createCoreVectorFromCoreMask(CoreMask coreMask, std::vector<SystemCore>& resultVec)
+void createCoreVectorFromCoreMask(const CoreMask& coreMask, std::vector<SystemCore>& resultVec)
 {
-	int i = 0;
-	while (coreMask != 0)
+	for (int coreId = coreMask.getFirstCore(); coreId >= 0 && coreId < MAX_NUM_OF_CORES; coreId = coreMask.getNextCore(coreId))
 	{
-		if (1 & coreMask)
+		resultVec.push_back(SystemCores::IdToSystemCore[coreId]);
+	}
+}
+
+#ifdef LINUX
+// parse a list in the sysfs format, for example: "0-3,8,10-11"
+static void parseSysfsCoreList(const std::string& list, std::vector<int>& result)
+{
+	std::stringstream stream(list);
+	std::string range;
+	while (std::getline(stream, range, ','))
+	{
+		int first = -1, last = -1;
+		int numOfValues = sscanf(range.c_str(), "%d-%d", &first, &last);
+		if (numOfValues < 1 || first < 0)
+			continue;
+		if (numOfValues == 1)
+			last = first;
+
+		for (int value = first; value <= last && value < MAX_NUM_OF_CORES; value++)
+			result.push_back(value);
+	}
+}
+
+static bool readSysfsLine(const std::string& path, std::string& result)
+{
+	std::ifstream file(path.c_str());
+	if (!file.is_open())
+		return false;
+
+	std::getline(file, result);
+	return true;
+}
+
+static int readSysfsInt(const std::string& path, int defaultValue)
+{
+	std::string line;
+	int result = defaultValue;
+	if (readSysfsLine(path, line))
+		sscanf(line.c_str(), "%d", &result);
+
+	return result;
+}
+#endif
+
+bool getSystemCoreTopology(std::vector<SystemCoreTopology>& result)
+{
+	result.clear();
+
+#ifdef LINUX
+	std::string onlineCores;
+	if (readSysfsLine("/sys/devices/system/cpu/online", onlineCores))
+	{
+		std::vector<int> coreIds;
+		parseSysfsCoreList(onlineCores, coreIds);
+
+		for (std::vector<int>::iterator iter = coreIds.begin(); iter != coreIds.end(); iter++)
+		{
+			std::stringstream topologyDir;
+			topologyDir << "/sys/devices/system/cpu/cpu" << *iter << "/topology/";
+
+			SystemCoreTopology core;
+			core.CoreId = *iter;
+			core.SocketId = readSysfsInt(topologyDir.str() + "physical_package_id", 0);
+			core.PhysicalCoreId = readSysfsInt(topologyDir.str() + "core_id", *iter);
+			core.NumaNode = 0;
+
+			std::string siblings;
+			std::vector<int> siblingIds;
+			if (readSysfsLine(topologyDir.str() + "thread_siblings_list", siblings))
+				parseSysfsCoreList(siblings, siblingIds);
+			core.SmtSiblings = createCoreMaskFromCoreIds(siblingIds);
+			core.SmtSiblings.setCore(*iter);
+
+			result.push_back(core);
+		}
+
+		// NUMA nodes may not be exposed on machines without NUMA support. In that case all cores stay on node 0
+		std::string onlineNodes;
+		std::vector<int> nodeIds;
+		if (readSysfsLine("/sys/devices/system/node/online", onlineNodes))
+			parseSysfsCoreList(onlineNodes, nodeIds);
+
+		for (std::vector<int>::iterator nodeIter = nodeIds.begin(); nodeIter != nodeIds.end(); nodeIter++)
 		{
-			resultVec.push_back(SystemCores::IdToSystemCore[i]);
+			std::stringstream cpuListPath;
+			cpuListPath << "/sys/devices/system/node/node" << *nodeIter << "/cpulist";
+
+			std::string nodeCores;
+			std::vector<int> nodeCoreIds;
+			if (!readSysfsLine(cpuListPath.str(), nodeCores))
+				continue;
+			parseSysfsCoreList(nodeCores, nodeCoreIds);
+			CoreMask nodeMask = createCoreMaskFromCoreIds(nodeCoreIds);
+
+			for (std::vector<SystemCoreTopology>::iterator coreIter = result.begin(); coreIter != result.end(); coreIter++)
+			{
+				if (nodeMask.isCoreSet(coreIter->CoreId))
+					coreIter->NumaNode = *nodeIter;
+			}
 		}
 
-		coreMask = coreMask >> 1;
-		i++;
+		if (!result.empty())
+			return true;
+	}
+#endif
+
+	// fallback: every core is a separate physical core on socket 0 and NUMA node 0
+	int numOfCores = getNumOfCores() < MAX_NUM_OF_CORES ? getNumOfCores() : MAX_NUM_OF_CORES;
+	for (int i = 0; i < numOfCores; i++)
+	{
+		SystemCoreTopology core;
+		core.CoreId = i;
+		core.SocketId = 0;
+		core.PhysicalCoreId = i;
+		core.NumaNode = 0;
+		core.SmtSiblings.setCore(i);
+		result.push_back(core);
 	}
+
+	return false;
+}
+
+CoreMask getCoreMaskForSocket(int socketId)
+{
+	std::vector<SystemCoreTopology> topology;
+	getSystemCoreTopology(topology);
+
+	CoreMask result;
+	for (std::vector<SystemCoreTopology>::iterator iter = topology.begin(); iter != topology.end(); iter++)
+	{
+		if (iter->SocketId == socketId)
+			result.setCore(iter->CoreId);
+	}
+
+	return result;
+}
+
+CoreMask getCoreMaskForNumaNode(int numaNode)
+{
+	std::vector<SystemCoreTopology> topology;
+	getSystemCoreTopology(topology);
+
+	CoreMask result;
+	for (std::vector<SystemCoreTopology>::iterator iter = topology.begin(); iter != topology.end(); iter++)
+	{
+		if (iter->NumaNode == numaNode)
+			result.setCore(iter->CoreId);
+	}
+
+	return result;
+}
+
+CoreMask getCoreMaskWithoutSmtSiblings(const CoreMask& coreMask)
+{
+	std::vector<SystemCoreTopology> topology;
+	getSystemCoreTopology(topology);
+
+	CoreMask result;
+	for (std::vector<SystemCoreTopology>::iterator iter = topology.begin(); iter != topology.end(); iter++)
+	{
+		if (!coreMask.isCoreSet(iter->CoreId))
+			continue;
+
+		// keep the core only if no lower sibling from the input mask was already kept
+		if ((result & iter->SmtSiblings).isEmpty())
+			result.setCore(iter->CoreId);
+	}
+
+	// cores which are in the mask but not online are kept as is
+	for (int coreId = coreMask.getFirstCore(); coreId >= 0; coreId = coreMask.getNextCore(coreId))
+	{
+		bool found = false;
+		for (std::vector<SystemCoreTopology>::iterator iter = topology.begin(); iter != topology.end() && !found; iter++)
+			found = (iter->CoreId == coreId);
+
+		if (!found)
+			result.setCore(coreId);
+	}
+
+	return result;
 }
 
 std::string executeShellCommand(const std::string command)
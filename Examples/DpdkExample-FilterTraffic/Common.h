@@ -58,7 +58,7 @@ struct AppWorkerConfig
 struct PacketStats
 {
 public:
-	uint8_t WorkerId;
+	uint16_t WorkerId;
 
 	int PacketCount;
 	int EthCount;
@@ -8,7 +8,7 @@
 #include "Packet.h"
 #include "IPv4Layer.h"
 #include "IPv6Layer.h"
-#include "PayloadLayer.h"
+#include "IPFragmentation.h"
 #include "PcapFileDevice.h"
 #include "SystemUtils.h"
 #include "getopt.h"
@@ -86,36 +86,6 @@ void printAppVersion()
 }
 
 
-/**
- * Set fragment parameters in an IPv4 fragment packet
- */
-void setIPv4FragmentParams(IPv4Layer* fragIpLayer, size_t fragOffset, bool lastFrag)
-{
-	// calculate the fragment offset field
-	uint16_t fragOffsetValue = pcpp::hostToNet16((uint16_t)(fragOffset/8));
-
-	// set the fragment flags bits to zero
-	fragOffsetValue &= (uint16_t)0xff1f;
-
-	// if this is not the last fragment, set a "more fragments" flag
-	if (!lastFrag)
-		fragOffsetValue |= (uint16_t)0x20;
-
-	// write fragment flags + fragment offset to packet
-	fragIpLayer->getIPv4Header()->fragmentOffset = fragOffsetValue;
-}
-
-
-/**
- * Add IPv6 fragmentation extension to an IPv6 fragment packet and set fragmentation parameters
- */
-void setIPv6FragmentParams(IPv6Layer* fragIpLayer, size_t fragOffset, bool lastFrag, uint32_t fragId)
-{
-	IPv6FragmentationHeader fragHeader(fragId, fragOffset, lastFrag);
-	fragIpLayer->addExtension<IPv6FragmentationHeader>(fragHeader);
-}
-
-
 /**
  * Generate a 4-byte positive random number. Used for generating IPv6 fragment ID
  */
@@ -135,7 +105,7 @@ uint32_t generateRandomNumber()
  * A method that takes a raw packet and a requested fragment size and splits the packet into fragments.
  * Fragments are written to a  RawPacketVector instance supplied by the user.
  * The input packet isn't modified in any way.
- * If the packet isn't of type IPv4 or IPv6, nothing happens and the result vector remains empty.
+ * If the packet isn't of type IPv4 or IPv6 or can't be fragmented, nothing happens and the result vector remains empty.
  * If the packet payload size is smaller or equal than the request fragment size the packet isn't fragmented, but the packet is copied
  * and pushed into the result vector
  */
@@ -145,80 +115,30 @@ void splitIPPacketToFragmentsBySize(RawPacket* rawPacket, size_t fragmentSize, R
 	Packet packet(rawPacket);
 
 	// check if IPv4/6
-	ProtocolType ipProto = UnknownProtocol;
-	if (packet.isPacketOfType(IPv4))
-		ipProto = IPv4;
-	else if (packet.isPacketOfType(IPv6))
-		ipProto = IPv6;
-	else
+	if (!packet.isPacketOfType(IPv4) && !packet.isPacketOfType(IPv6))
 		return;
 
-	Layer* ipLayer = NULL;
-	if (ipProto == IPv4)
-		ipLayer = packet.getLayerOfType<IPv4Layer>();
-	else // ipProto == IPv6
-		ipLayer = packet.getLayerOfType<IPv6Layer>();
-
-	// if packet payload size is less than the requested fragment size, don't fragment and return
-	if (ipLayer->getLayerPayloadSize() <= fragmentSize)
-	{
-		RawPacket* copyOfRawPacket = new RawPacket(*rawPacket);
-		resultFragments.pushBack(copyOfRawPacket);
-		return;
-	}
+	// the fragmentation engine builds each fragment directly from the original packet. Fragments carry up to fragmentSize bytes of
+	// IP payload each, and the "Don't Fragment" flag is cleared as the user explicitly asked to fragment the packet
+	IPFragmentation ipFrag;
+	ipFrag.setMaxFragmentPayloadSize(fragmentSize);
+	ipFrag.setIgnoreDontFragment(true);
 
 	// generate a random number for IPv6 fragment ID (not used in IPv4 packets)
-	uint32_t randomNum = generateRandomNumber();
-
-	// go over the payload and create fragments until reaching the end of the payload
-	size_t curOffset = 0;
-	while (curOffset < ipLayer->getLayerPayloadSize())
-	{
-		bool lastFrag = false;
-		size_t curFragSize = fragmentSize;
-
-		// check if this is the last fragment by comparing the size of the rest of the payload to the requested fragment size
-		if (ipLayer->getLayerPayloadSize() - curOffset <= fragmentSize)
-		{
-			curFragSize = ipLayer->getLayerPayloadSize() - curOffset;
-			lastFrag = true;
-		}
-
-		// create the fragment packet
-		// first, duplicate the input packet and create a new parsed packet out of it
-		RawPacket* newFragRawPacket = new RawPacket(*packet.getRawPacket());
-		Packet newFrag(newFragRawPacket);
+	ipFrag.setIPv6FragmentId(generateRandomNumber());
 
-		// find the IPv4/6 layer of the new fragment
-		Layer* fragIpLayer = NULL;
-		if (ipProto == IPv4)
-			fragIpLayer = newFrag.getLayerOfType<IPv4Layer>();
-		else // ipProto == IPv6
-			fragIpLayer = newFrag.getLayerOfType<IPv6Layer>();
+	int numOfFragments = ipFrag.fragmentPacket(&packet, resultFragments);
 
-		// delete all layers above IP layer
-		newFrag.removeAllLayersAfter(fragIpLayer);
-
-		// create a new PayloadLayer with the fragmented data and add it to the new fragment packet
-		PayloadLayer newPayload(ipLayer->getLayerPayload() + curOffset, curFragSize, false);
-		newFrag.addLayer(&newPayload);
-
-		// set fragment parameters in IPv4/6 layer
-		if (ipProto == IPv4)
-			setIPv4FragmentParams((IPv4Layer*)fragIpLayer, curOffset, lastFrag);
-		else // ipProto == IPv6
-			setIPv6FragmentParams((IPv6Layer*)fragIpLayer, curOffset, lastFrag, randomNum);
-
-		// compute all calculated fields of the new fragment
-		newFrag.computeCalculateFields();
-
-		// add fragment to result list
-		resultFragments.pushBack(newFrag.getRawPacket());
+	// packet couldn't be fragmented
+	if (numOfFragments < 0)
+		return;
 
-		// increment offset pointer
-		curOffset += curFragSize;
+	// packet payload size is less than the requested fragment size, copy the packet as is
+	if (numOfFragments == 0)
+	{
+		RawPacket* copyOfRawPacket = new RawPacket(*rawPacket);
+		resultFragments.pushBack(copyOfRawPacket);
 	}
-
 }
 
 
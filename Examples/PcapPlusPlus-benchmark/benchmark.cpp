@@ -15,7 +15,9 @@
 
 #include <Packet.h>
 #include <DnsLayer.h>
+#include <StackParser.h>
 #include <PcapFileDevice.h>
+#include <PcapLiveDeviceList.h>
 #include <iostream>
 #include <chrono>
 #include <string>
@@ -54,14 +56,58 @@ bool handle_packet(Packet& packet) {
     return true;
 }
 
+bool handle_stack(StackParser<EthLayer, IPv4Layer, TcpLayer>& parser) {
+    count++;
+    return true;
+}
+
+// measures how long it takes to list the live devices, "startup-full" also loads DNS servers and every device's lazily fetched attributes
+int run_startup(bool full, int total_runs) {
+    if(total_runs <= 0) {
+        std::cout << "The number of repetitions must be positive\n";
+        return 1;
+    }
+    size_t total_devices = 0;
+    std::chrono::high_resolution_clock::duration total_time(0);
+    for(int i = 0; i < total_runs; ++i) {
+        // drop the devices fetched by the previous run so each run measures a cold start
+        PcapLiveDeviceList::getInstance().reset();
+        auto start = std::chrono::high_resolution_clock::now();
+        const std::vector<PcapLiveDevice*>& devices = PcapLiveDeviceList::getInstance().getPcapLiveDevicesList();
+        if (full) {
+            PcapLiveDeviceList::getInstance().getDnsServers();
+            for (std::vector<PcapLiveDevice*>::const_iterator iter = devices.begin(); iter != devices.end(); iter++) {
+                (*iter)->getMtu();
+                (*iter)->getMacAddress();
+                (*iter)->getDefaultGateway();
+            }
+        }
+        total_time += std::chrono::high_resolution_clock::now() - start;
+        total_devices += devices.size();
+    }
+
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+    std::cout << (total_devices / total_runs) << " " << (duration_cast<microseconds>(total_time).count() / total_runs) << std::endl;
+    return 0;
+}
+
 int main(int argc, char *argv[]) { 
+    if(argc == 3 && (std::string(argv[1]) == "startup" || std::string(argv[1]) == "startup-full")) {
+        return run_startup(std::string(argv[1]) == "startup-full", std::stoi(argv[2]));
+    }
     if(argc != 4) {
-        std::cout << "Usage: " << *argv << " <input-file> <dns|packet> <repetitions>\n";
+        std::cout << "Usage: " << *argv << " <input-file> <dns|packet|stack> <repetitions>\n";
+        std::cout << "       " << *argv << " <startup|startup-full> <repetitions>\n";
         return 1;
     }
     std::chrono::high_resolution_clock myClock;
     std::string input_type(argv[2]);
     int total_runs = std::stoi(argv[3]);
+    if(total_runs <= 0) {
+        std::cout << "The number of repetitions must be positive\n";
+        return 1;
+    }
     size_t total_packets = 0;
     std::vector<std::chrono::high_resolution_clock::duration> durations;
     for(int i = 0; i < total_runs; ++i) {
@@ -78,6 +124,23 @@ int main(int argc, char *argv[]) {
             	handle_dns(packet);
             }
         }
+        else if(input_type == "stack") {
+            // same as "packet" but Eth/IPv4/TCP packets are parsed by StackParser, other packets fall back to Packet
+            start = std::chrono::high_resolution_clock::now();
+            RawPacket rawPacket;
+            StackParser<EthLayer, IPv4Layer, TcpLayer> parser;
+            while (reader.getNextPacket(rawPacket))
+            {
+            	if (parser.parse(&rawPacket))
+            	{
+            		handle_stack(parser);
+            		continue;
+            	}
+
+            	Packet packet(&rawPacket, pcpp::TCP);
+            	handle_packet(packet);
+            }
+        }
         else {
             start = std::chrono::high_resolution_clock::now();
             RawPacket rawPacket;
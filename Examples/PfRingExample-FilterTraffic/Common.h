@@ -35,7 +35,7 @@ using namespace std;
 struct PacketStats
 {
 public:
-	uint8_t ThreadId;
+	uint16_t ThreadId;
 
 	int PacketCount;
 	int EthCount;
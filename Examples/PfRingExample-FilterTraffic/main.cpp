@@ -425,7 +425,7 @@ int main(int argc, char* argv[])
 	}
 
 
-	printf("Start capturing on %d threads core mask = 0x%X\n", numOfCaptureThreads, coreMask);
+	printf("Start capturing on %d threads core mask = %s\n", numOfCaptureThreads, coreMask.toHexString().c_str());
 
 	// prepare packet capture configuration
 	CaptureThreadArgs args;
@@ -437,7 +437,7 @@ int main(int argc, char* argv[])
 
 	// start capturing packets on all threads
 	if (!dev->startCaptureMultiThread(packetArrived, &args, coreMask))
-		EXIT_WITH_ERROR("Couldn't start capturing on core mask %X on interface '%s'", coreMask, dev->getDeviceName().c_str());
+		EXIT_WITH_ERROR("Couldn't start capturing on core mask %s on interface '%s'", coreMask.toHexString().c_str(), dev->getDeviceName().c_str());
 
 	bool shouldStop = false;
 
@@ -57,6 +57,10 @@ namespace pcpp
 	class ArpLayer : public Layer
 	{
 	public:
+		/** %ArpLayer instances carry ::ARP, see Layer#LayerProtocol */
+		static const ProtocolType LayerProtocol = ARP;
+		typedef ArpLayer LayerProtocolClass;
+
 		/**
 		 * A constructor that creates the layer from an existing packet raw data
 		 * @param[in] data A pointer to the raw data (will be casted to @ref arphdr)
@@ -134,6 +138,9 @@ namespace pcpp
 		std::string toString() const;
 
 		OsiModelLayer getOsiModelLayer() const { return OsiModelNetworkLayer; }
+
+	private:
+		Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new ArpLayer(data, m_DataLen, prevLayer, packet); }
 	};
 
 } // namespace pcpp
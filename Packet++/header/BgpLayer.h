@@ -28,6 +28,9 @@ namespace pcpp
 class BgpLayer : public Layer
 {
 public:
+  /** %BgpLayer instances carry ::BGP, see Layer#LayerProtocol */
+  static const ProtocolType LayerProtocol = BGP;
+  typedef BgpLayer LayerProtocolClass;
 
   /**
    * An enum representing BGP message types
@@ -139,6 +142,14 @@ class BgpOpenMessageLayer : public BgpLayer
 {
 public:
 
+  /**
+   * All BGP message layers carry ::BGP, this method tells OPEN messages apart (see Layer#isInstance())
+   * @param[in] layer A BGP message layer
+   * @return True if the layer is a BGP OPEN message
+   */
+  static bool isInstance(const Layer& layer) { return static_cast<const BgpLayer&>(layer).getBgpMessageType() == BgpLayer::Open; }
+  typedef BgpOpenMessageLayer LayerProtocolClass;
+
   /**
    * @struct bgp_open_message
    * BGP OPEN message structure
@@ -261,6 +272,7 @@ private:
 
   size_t optionalParamsToByteArray(const std::vector<optional_parameter>& optionalParams, uint8_t* resultByteArr, size_t maxByteArrSize);
 
+  Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new BgpOpenMessageLayer(data, m_DataLen, prevLayer, packet); }
 };
 
 
@@ -273,6 +285,14 @@ class BgpUpdateMessageLayer : public BgpLayer
 {
 public:
 
+  /**
+   * All BGP message layers carry ::BGP, this method tells UPDATE messages apart (see Layer#isInstance())
+   * @param[in] layer A BGP message layer
+   * @return True if the layer is a BGP UPDATE message
+   */
+  static bool isInstance(const Layer& layer) { return static_cast<const BgpLayer&>(layer).getBgpMessageType() == BgpLayer::Update; }
+  typedef BgpUpdateMessageLayer LayerProtocolClass;
+
   /**
    * @struct prefix_and_ip
    * A structure that contains IPv4 address and IP address mask (prefix) information. 
@@ -454,6 +474,7 @@ private:
 
   size_t pathAttributesToByteArray(const std::vector<path_attribute>& pathAttributes, uint8_t* resultByteArr, size_t maxByteArrSize);
 
+  Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new BgpUpdateMessageLayer(data, m_DataLen, prevLayer, packet); }
 };
 
 
@@ -466,6 +487,14 @@ class BgpNotificationMessageLayer : public BgpLayer
 {
 public:
 
+  /**
+   * All BGP message layers carry ::BGP, this method tells NOTIFICATION messages apart (see Layer#isInstance())
+   * @param[in] layer A BGP message layer
+   * @return True if the layer is a BGP NOTIFICATION message
+   */
+  static bool isInstance(const Layer& layer) { return static_cast<const BgpLayer&>(layer).getBgpMessageType() == BgpLayer::Notification; }
+  typedef BgpNotificationMessageLayer LayerProtocolClass;
+
   /**
    * @struct bgp_notification_message
    * BGP NOTIFICATION message structure
@@ -566,6 +595,7 @@ private:
 
   void initMessageData(uint8_t errorCode, uint8_t errorSubCode, const uint8_t* notificationData, size_t notificationDataLen);
 
+  Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new BgpNotificationMessageLayer(data, m_DataLen, prevLayer, packet); }
 };
 
 
@@ -578,6 +608,14 @@ class BgpKeepaliveMessageLayer : public BgpLayer
 {
 public:
 
+  /**
+   * All BGP message layers carry ::BGP, this method tells KEEPALIVE messages apart (see Layer#isInstance())
+   * @param[in] layer A BGP message layer
+   * @return True if the layer is a BGP KEEPALIVE message
+   */
+  static bool isInstance(const Layer& layer) { return static_cast<const BgpLayer&>(layer).getBgpMessageType() == BgpLayer::Keepalive; }
+  typedef BgpKeepaliveMessageLayer LayerProtocolClass;
+
   /**
    * @typedef bgp_keepalive_message
    * BGP KEEPALIVE message structure
@@ -608,6 +646,8 @@ public:
 
   BgpMessageType getBgpMessageType() const { return BgpLayer::Keepalive; }
 
+private:
+  Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new BgpKeepaliveMessageLayer(data, m_DataLen, prevLayer, packet); }
 };
 
 
@@ -620,6 +660,14 @@ class BgpRouteRefreshMessageLayer : public BgpLayer
 {
 public:
 
+  /**
+   * All BGP message layers carry ::BGP, this method tells ROUTE-REFRESH messages apart (see Layer#isInstance())
+   * @param[in] layer A BGP message layer
+   * @return True if the layer is a BGP ROUTE-REFRESH message
+   */
+  static bool isInstance(const Layer& layer) { return static_cast<const BgpLayer&>(layer).getBgpMessageType() == BgpLayer::RouteRefresh; }
+  typedef BgpRouteRefreshMessageLayer LayerProtocolClass;
+
   /**
    * @struct bgp_route_refresh_message
    * BGP ROUTE-REFRESH message structure
@@ -662,6 +710,8 @@ public:
 
   BgpMessageType getBgpMessageType() const { return BgpLayer::RouteRefresh; }
 
+private:
+  Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new BgpRouteRefreshMessageLayer(data, m_DataLen, prevLayer, packet); }
 };
 
 }
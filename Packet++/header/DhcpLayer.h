@@ -584,6 +584,9 @@ namespace pcpp
 	class DhcpLayer : public Layer
 	{
 	public:
+		/** %DhcpLayer instances carry ::DHCP, see Layer#LayerProtocol */
+		static const ProtocolType LayerProtocol = DHCP;
+		typedef DhcpLayer LayerProtocolClass;
 
 		/**
 		 * A constructor that creates the layer from an existing packet raw data
@@ -719,6 +722,18 @@ namespace pcpp
 		 */
 		DhcpOption getOptionData(DhcpOptionTypes option) const;
 
+		/**
+		 * Get several DHCP options by type at once. DHCP layers keep an index of their option types, so every option is
+		 * retrieved in O(1) once the index is built (which happens in one pass over the options on the first lookup)
+		 * @param[in] optionTypes An array of the DHCP option types to retrieve
+		 * @param[in] numOfOptionTypes The number of option types in the array
+		 * @param[out] result A vector that will be filled with one DhcpOption object per option type, in the same order as
+		 * optionTypes. Each object contains the first DHCP option data that matches the type, or logical NULL
+		 * (DhcpOption#isNull() == true) if no such option found
+		 * @return The number of option types that were found
+		 */
+		size_t getOptionsData(const DhcpOptionTypes* optionTypes, size_t numOfOptionTypes, std::vector<DhcpOption>& result) const;
+
 		/**
 		 * @return The number of DHCP options in this layer
 		 */
@@ -790,6 +805,8 @@ namespace pcpp
 		void initDhcpLayer(size_t numOfBytesToAllocate);
 
 		DhcpOption addOptionAt(const DhcpOptionBuilder& optionBuilder, int offset);
+
+		Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new DhcpLayer(data, m_DataLen, prevLayer, packet); }
 	};
 }
 
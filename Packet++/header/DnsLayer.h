@@ -101,6 +101,9 @@ namespace pcpp
 		friend class DnsResource;
 
 	public:
+		/** %DnsLayer instances carry ::DNS, see Layer#LayerProtocol */
+		static const ProtocolType LayerProtocol = DNS;
+		typedef DnsLayer LayerProtocolClass;
 
 		/**
 		 * A constructor that creates the layer from an existing packet raw data
@@ -456,6 +459,7 @@ namespace pcpp
 
 		bool removeResource(IDnsResource* resourceToRemove);
 
+		Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new DnsLayer(data, m_DataLen, prevLayer, packet); }
 	};
 
 
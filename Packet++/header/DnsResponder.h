@@ -0,0 +1,168 @@
+#ifndef PACKETPP_DNS_RESPONDER
+#define PACKETPP_DNS_RESPONDER
+
+#include "RawPacket.h"
+#include "DnsLayerEnums.h"
+#include "IpAddress.h"
+#include <string>
+#include <vector>
+
+/**
+ * @file
+ * This file includes a DNS responder that turns DNS query packets into response packets in place, for local authoritative servers and
+ * sinkholes that need to answer a very large number of queries per core.<BR>
+ *
+ * Building a response with DnsLayer#addAnswer() allocates a DnsResource, extends the layer, shifts the bytes after it and then
+ * recomputes all fields with Packet#computeCalculateFields(). DnsResponder works on the RawPacket instead, without parsing it into
+ * layers and without allocating memory:
+ * - Answers are compiled when records are added. Each answer record starts with a compression pointer to the question name (which
+ *   is always at offset 12 of the DNS message), so its bytes don't depend on the query and are stored ready to be copied. The
+ *   answers of a name and type are kept together in a hash table indexed by the lowercase name, with their checksum precomputed
+ * - A response is created by swapping the MAC addresses, IP addresses and UDP ports, changing the DNS header, cutting the message
+ *   after the question section and appending the compiled answers
+ * - The IPv4 header checksum and the UDP checksum are updated incrementally (RFC 1624) from the bytes that changed instead of being
+ *   recomputed over the whole packet
+ *
+ * The responder handles Ethernet packets (optionally with VLAN tags) carrying IPv4 or IPv6 (without extension headers), UDP and a
+ * standard DNS query with a single question and no answer or authority records. Additional records of the query (such as an EDNS OPT
+ * record) aren't copied to the response, so responses are limited to 512 bytes of DNS data. After all records are added the responder
+ * can be used by multiple threads at the same time, since creating a response doesn't change it
+ */
+
+/**
+ * @namespace pcpp
+ * @brief The main namespace for the PcapPlusPlus lib
+ */
+namespace pcpp
+{
+
+	/**
+	 * @class DnsResponder
+	 * Turns DNS query packets into response packets in place using a table of precompiled answers. Please refer to the documentation
+	 * at the top of DnsResponder.h to understand how it works
+	 */
+	class DnsResponder
+	{
+	public:
+
+		/**
+		 * @enum ResponseResult
+		 * The result of DnsResponder#createResponse()
+		 */
+		enum ResponseResult
+		{
+			/** The packet was turned into a response with answers */
+			ResponseCreated,
+			/** The packet was turned into a name error (NXDOMAIN) response because no record matched its question */
+			NameErrorResponseCreated,
+			/** The packet isn't a DNS query the responder can answer. The packet wasn't changed */
+			NotSupportedQuery,
+			/** No record matched the question of the query. The packet wasn't changed */
+			NoMatchingRecords,
+			/** The response would be larger than 512 bytes of DNS data. The packet wasn't changed */
+			ResponseTooLarge,
+			/** The packet buffer couldn't be extended. The packet may have been partially changed */
+			BufferError
+		};
+
+		/**
+		 * A c'tor for this class
+		 * @param[in] authoritative Set the authoritative answer flag in responses. The default is true
+		 * @param[in] dnsPort The UDP port queries are sent to. The default is 53
+		 */
+		DnsResponder(bool authoritative = true, uint16_t dnsPort = 53);
+
+		/**
+		 * Add a record with raw record data. Records with the same name and type are returned together, in the order they were added
+		 * @param[in] name The name of the record, for example "www.example.com". Names are matched case insensitively. The name "*"
+		 * matches any name that has no records of the question type
+		 * @param[in] dnsType The type of the record
+		 * @param[in] ttl The TTL of the record in seconds
+		 * @param[in] data The record data in wire format
+		 * @param[in] dataLen The record data length in bytes
+		 * @return True if the record was added, false if the name is invalid or the data is too long (an error will be printed to log)
+		 */
+		bool addRecord(const std::string& name, DnsType dnsType, uint32_t ttl, const uint8_t* data, size_t dataLen);
+
+		/**
+		 * Add an A record
+		 * @param[in] name The name of the record. Please see addRecord() for details
+		 * @param[in] ttl The TTL of the record in seconds
+		 * @param[in] address The IPv4 address the name resolves to
+		 * @return True if the record was added, false otherwise (an error will be printed to log)
+		 */
+		bool addARecord(const std::string& name, uint32_t ttl, const IPv4Address& address);
+
+		/**
+		 * Add an AAAA record
+		 * @param[in] name The name of the record. Please see addRecord() for details
+		 * @param[in] ttl The TTL of the record in seconds
+		 * @param[in] address The IPv6 address the name resolves to
+		 * @return True if the record was added, false otherwise (an error will be printed to log)
+		 */
+		bool addAAAARecord(const std::string& name, uint32_t ttl, const IPv6Address& address);
+
+		/**
+		 * Add a record whose data is a single domain name, such as a CNAME, NS or PTR record
+		 * @param[in] name The name of the record. Please see addRecord() for details
+		 * @param[in] dnsType The type of the record
+		 * @param[in] ttl The TTL of the record in seconds
+		 * @param[in] targetName The domain name in the record data, for example "alias.example.com"
+		 * @return True if the record was added, false otherwise (an error will be printed to log)
+		 */
+		bool addNameRecord(const std::string& name, DnsType dnsType, uint32_t ttl, const std::string& targetName);
+
+		/**
+		 * Set whether to answer queries that no record matches with a name error (NXDOMAIN) response, like an authoritative server
+		 * does, or leave them unchanged. The default is to leave them unchanged
+		 * @param[in] respond True to answer with a name error response, false otherwise
+		 */
+		void setNameErrorForUnknownNames(bool respond) { m_NameErrorForUnknownNames = respond; }
+
+		/**
+		 * @return The number of records added
+		 */
+		size_t getNumOfRecords() const { return m_NumOfRecords; }
+
+		/**
+		 * Remove all records
+		 */
+		void clear();
+
+		/**
+		 * Turn a DNS query packet into a response in place. If the response is longer than the query the raw packet is extended with
+		 * RawPacket#appendData(). Packet instances that were created from the raw packet before the call need to be re-parsed
+		 * @param[in,out] rawPacket The query packet
+		 * @param[in] bufferCapacity The size of the buffer the raw data is in. If the response fits in it the data is appended without
+		 * allocating memory, otherwise RawPacket#reallocateData() is called first. The default is 0, which means the raw data length
+		 * @return The result of the operation. Please see ResponseResult for details
+		 */
+		ResponseResult createResponse(RawPacket& rawPacket, size_t bufferCapacity = 0) const;
+
+	private:
+		struct AnswerSet
+		{
+			std::string name;
+			uint32_t nameHash;
+			uint16_t dnsType;
+			uint16_t numOfAnswers;
+			uint16_t checksumSum;
+			std::vector<uint8_t> answers;
+		};
+
+		std::vector<AnswerSet> m_AnswerSets;
+		std::vector<int> m_Index;
+		size_t m_NumOfRecords;
+		bool m_Authoritative;
+		bool m_NameErrorForUnknownNames;
+		uint16_t m_DnsPort;
+		std::string m_WildcardName;
+		uint32_t m_WildcardHash;
+
+		const AnswerSet* findAnswerSet(const uint8_t* name, size_t nameLen, uint32_t nameHash, uint16_t dnsType) const;
+		void rebuildIndex(size_t capacity);
+	};
+
+} // namespace pcpp
+
+#endif /* PACKETPP_DNS_RESPONDER */
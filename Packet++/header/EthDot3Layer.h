@@ -35,6 +35,9 @@ namespace pcpp
 	class EthDot3Layer : public Layer
 	{
 	public:
+		/** %EthDot3Layer instances carry ::EthernetDot3, see Layer#LayerProtocol */
+		static const ProtocolType LayerProtocol = EthernetDot3;
+		typedef EthDot3Layer LayerProtocolClass;
 
 		/**
 		 * A constructor that creates the layer from an existing packet raw data
@@ -104,6 +107,9 @@ namespace pcpp
 		std::string toString() const;
 
 		OsiModelLayer getOsiModelLayer() const { return OsiModelDataLinkLayer; }
+
+	private:
+		Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new EthDot3Layer(data, m_DataLen, packet); }
 	};
 }
 
@@ -65,6 +65,10 @@ namespace pcpp
 	class EthLayer : public Layer
 	{
 	public:
+		/** %EthLayer instances carry ::Ethernet, see Layer#LayerProtocol */
+		static const ProtocolType LayerProtocol = Ethernet;
+		typedef EthLayer LayerProtocolClass;
+
 		/**
 		 * A constructor that creates the layer from an existing packet raw data
 		 * @param[in] data A pointer to the raw data (will be casted to ether_header)
@@ -144,6 +148,9 @@ namespace pcpp
 		std::string toString() const;
 
 		OsiModelLayer getOsiModelLayer() const { return OsiModelDataLinkLayer; }
+
+	private:
+		Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new EthLayer(data, m_DataLen, prevLayer, packet); }
 	};
 
 } // namespace pcpp
@@ -108,6 +108,9 @@ namespace pcpp
 	class GreLayer : public Layer
 	{
 	public:
+		/** %GreLayer instances carry ::GRE, see Layer#LayerProtocol */
+		static const ProtocolType LayerProtocol = GRE;
+		typedef GreLayer LayerProtocolClass;
 
 		virtual ~GreLayer() {}
 
@@ -188,6 +191,9 @@ namespace pcpp
 	class GREv0Layer : public GreLayer
 	{
 	public:
+		/** %GREv0Layer instances carry ::GREv0, see Layer#LayerProtocol */
+		static const ProtocolType LayerProtocol = GREv0;
+		typedef GREv0Layer LayerProtocolClass;
 
 		 /** A constructor that creates the layer from an existing packet raw data
 		 * @param[in] data A pointer to the raw data
@@ -288,6 +294,8 @@ namespace pcpp
 
 		std::string toString() const;
 
+	private:
+		Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new GREv0Layer(data, m_DataLen, prevLayer, packet); }
 	};
 
 
@@ -298,6 +306,9 @@ namespace pcpp
 	class GREv1Layer : public GreLayer
 	{
 	public:
+		/** %GREv1Layer instances carry ::GREv1, see Layer#LayerProtocol */
+		static const ProtocolType LayerProtocol = GREv1;
+		typedef GREv1Layer LayerProtocolClass;
 
 		 /** A constructor that creates the layer from an existing packet raw data
 		 * @param[in] data A pointer to the raw data
@@ -361,6 +372,8 @@ namespace pcpp
 
 		std::string toString() const;
 
+	private:
+		Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new GREv1Layer(data, m_DataLen, prevLayer, packet); }
 	};
 
 
@@ -371,6 +384,10 @@ namespace pcpp
 	class PPP_PPTPLayer : public Layer
 	{
 	public:
+		/** %PPP_PPTPLayer instances carry ::PPP_PPTP, see Layer#LayerProtocol */
+		static const ProtocolType LayerProtocol = PPP_PPTP;
+		typedef PPP_PPTPLayer LayerProtocolClass;
+
 		/**
 		 * A constructor that creates the layer from an existing packet raw data
 		 * @param[in] data A pointer to the raw data (will be casted to @ref ppp_pptp_header)
@@ -418,6 +435,8 @@ namespace pcpp
 
 		OsiModelLayer getOsiModelLayer() const { return OsiModelSesionLayer; }
 
+	private:
+		Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new PPP_PPTPLayer(data, m_DataLen, prevLayer, packet); }
 	};
 
 } // namespace pcpp
@@ -225,6 +225,9 @@ namespace pcpp
 		void init(GtpV1MessageType messageType, uint32_t teid, bool setSeqNum, uint16_t seqNum, bool setNpduNum, uint8_t npduNum);
 
 	public:
+		/** %GtpV1Layer instances carry ::GTPv1, see Layer#LayerProtocol */
+		static const ProtocolType LayerProtocol = GTPv1;
+		typedef GtpV1Layer LayerProtocolClass;
 
 		/**
 		 * @class GtpExtension
@@ -452,6 +455,9 @@ namespace pcpp
 		std::string toString() const;
 
 		OsiModelLayer getOsiModelLayer() const { return OsiModelTransportLayer; }
+
+	private:
+		Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new GtpV1Layer(data, m_DataLen, prevLayer, packet); }
 	};
 }
 
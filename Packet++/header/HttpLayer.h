@@ -70,6 +70,9 @@ namespace pcpp
 	class HttpMessage : public TextBasedProtocolMessage
 	{
 	public:
+		/** %HttpMessage instances carry ::HTTP, see Layer#LayerProtocol */
+		static const ProtocolType LayerProtocol = HTTP;
+		typedef HttpMessage LayerProtocolClass;
 
 		virtual ~HttpMessage() {}
 
@@ -124,6 +127,10 @@ namespace pcpp
 	{
 		friend class HttpRequestFirstLine;
 	public:
+		/** %HttpRequestLayer instances carry ::HTTPRequest, see Layer#LayerProtocol */
+		static const ProtocolType LayerProtocol = HTTPRequest;
+		typedef HttpRequestLayer LayerProtocolClass;
+
 		/**
 		 * HTTP request methods
 		 */
@@ -203,6 +210,8 @@ namespace pcpp
 
 	private:
 		HttpRequestFirstLine* m_FirstLine;
+
+		Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new HttpRequestLayer(data, m_DataLen, prevLayer, packet); }
 	};
 
 
@@ -230,6 +239,10 @@ namespace pcpp
 	{
 		friend class HttpResponseFirstLine;
 	public:
+		/** %HttpResponseLayer instances carry ::HTTPResponse, see Layer#LayerProtocol */
+		static const ProtocolType LayerProtocol = HTTPResponse;
+		typedef HttpResponseLayer LayerProtocolClass;
+
 		/**
 		 * Enum for HTTP response status codes
 		 */
@@ -468,6 +481,7 @@ namespace pcpp
 	private:
 		HttpResponseFirstLine* m_FirstLine;
 
+		Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new HttpResponseLayer(data, m_DataLen, prevLayer, packet); }
 	};
 
 
@@ -0,0 +1,159 @@
+#ifndef PACKETPP_IP_FRAGMENTATION
+#define PACKETPP_IP_FRAGMENTATION
+
+#include "Packet.h"
+#include "PointerVector.h"
+
+/**
+ * @file
+ * This file includes an implementation of IP fragmentation, which is the mechanism of splitting an IPv4 or IPv6 packet that is larger than
+ * the link MTU into several smaller fragments. It is the counterpart of pcpp#IPReassembly and the same pcpp#IPFragmentation instance can
+ * fragment both IPv4 and IPv6 packets. You can read more about IP fragmentation here: https://en.wikipedia.org/wiki/IP_fragmentation.<BR>
+ *
+ * The logic works as follows:
+ * - The packet is parsed only up to its first (outermost) IPv4 or IPv6 layer. Everything below it (Ethernet, VLAN, MPLS, etc.) is copied
+ *   as-is to every fragment
+ * - The IP header of each fragment is prepared once per packet: for IPv4 two header templates are built (one for the first fragment and
+ *   one for the rest, which carries only options that have the "copied" flag set as required by RFC 791). The one's complement sum of each
+ *   template is also computed once, so the checksum of each fragment is obtained by adding only the fields that change (total length and
+ *   fragment offset) instead of re-computing it over the whole header
+ * - For IPv6 a fragmentation extension header is inserted right after the unfragmentable part of the packet (the base header plus Hop-by-Hop,
+ *   Routing and the Destination Options headers that precede them), as required by RFC 8200
+ * - Each fragment is written straight into its output buffer: link-layer headers, the IP header template and a slice of the IP payload.
+ *   The original packet isn't modified in any way and isn't re-parsed or copied as a whole
+ *
+ * The user can either provide pre-allocated output buffers (see pcpp#IPFragmentation#FragmentBuffer) or let pcpp#IPFragmentation allocate
+ * exactly sized RawPacket objects
+ */
+
+/**
+ * @namespace pcpp
+ * @brief The main namespace for the PcapPlusPlus lib
+ */
+namespace pcpp
+{
+
+	/** The default MTU used by IPFragmentation if no other MTU is set */
+	#define PCPP_IP_FRAGMENTATION_DEFAULT_MTU 1500
+
+	/**
+	 * @class IPFragmentation
+	 * Contains the IP fragmentation mechanism for both IPv4 and IPv6 packets. Please refer to the documentation at the top of IPFragmentation.h
+	 * to understand how this mechanism works. The main APIs are:
+	 * - IPFragmentation#getNumOfFragments() - check whether a packet needs to be fragmented and how many fragments it'll be split into
+	 * - IPFragmentation#fragmentPacket() - split a packet into fragments, either into user-provided buffers or into newly allocated RawPacket objects
+	 */
+	class IPFragmentation
+	{
+	public:
+
+		/**
+		 * @struct FragmentBuffer
+		 * Describes a pre-allocated output buffer for a single fragment
+		 */
+		struct FragmentBuffer
+		{
+			/** A pointer to the buffer the fragment will be written to */
+			uint8_t* data;
+			/** The buffer capacity in bytes */
+			size_t capacity;
+			/** The fragment length in bytes. Set by IPFragmentation#fragmentPacket() */
+			size_t len;
+		};
+
+		/**
+		 * A c'tor for this class
+		 * @param[in] mtu The maximum size in bytes of each fragment, counted from the first byte of the IP header (link-layer headers
+		 * aren't counted). Default value is #PCPP_IP_FRAGMENTATION_DEFAULT_MTU
+		 */
+		IPFragmentation(size_t mtu = PCPP_IP_FRAGMENTATION_DEFAULT_MTU);
+
+		/**
+		 * @return The MTU fragments are created for
+		 */
+		size_t getMtu() const { return m_Mtu; }
+
+		/**
+		 * Set the maximum size in bytes of each fragment, counted from the first byte of the IP header
+		 * @param[in] mtu The MTU to set
+		 */
+		void setMtu(size_t mtu) { m_Mtu = mtu; }
+
+		/**
+		 * @return The maximum IP payload size per fragment if set by setMaxFragmentPayloadSize(), or 0 if fragment size is determined by the MTU
+		 */
+		size_t getMaxFragmentPayloadSize() const { return m_MaxFragmentPayloadSize; }
+
+		/**
+		 * Instead of an MTU, limit the number of IP payload bytes carried by each fragment (the last fragment may carry less). When set to
+		 * a non-zero value this limit is used instead of the MTU
+		 * @param[in] maxPayloadSize The maximum IP payload size per fragment. Must be a multiple of 8, otherwise it is rounded down
+		 */
+		void setMaxFragmentPayloadSize(size_t maxPayloadSize) { m_MaxFragmentPayloadSize = maxPayloadSize; }
+
+		/**
+		 * @return True if IPv4 packets with the "Don't Fragment" flag set are fragmented anyway (with the flag cleared), false otherwise
+		 */
+		bool isIgnoreDontFragment() const { return m_IgnoreDontFragment; }
+
+		/**
+		 * By default IPv4 packets that have the "Don't Fragment" flag set aren't fragmented. This method allows fragmenting them anyway,
+		 * in which case the flag is cleared in all fragments
+		 * @param[in] ignoreDontFragment True to fragment packets regardless of the "Don't Fragment" flag, false otherwise
+		 */
+		void setIgnoreDontFragment(bool ignoreDontFragment) { m_IgnoreDontFragment = ignoreDontFragment; }
+
+		/**
+		 * Set the fragment ID that will be used for the next IPv6 packet. This value is incremented for each IPv6 packet that is fragmented.
+		 * IPv4 fragments always keep the IP ID of the original packet
+		 * @param[in] fragmentId The fragment ID to set
+		 */
+		void setIPv6FragmentId(uint32_t fragmentId) { m_NextIPv6FragmentId = fragmentId; }
+
+		/**
+		 * Calculate how many fragments a packet will be split into
+		 * @param[in] packet The packet to check
+		 * @param[out] maxFragmentLen The size in bytes of the largest fragment, including link-layer headers. Output buffers of this size
+		 * are large enough for all fragments of this packet
+		 * @return The number of fragments, 0 if the packet isn't IPv4/IPv6 or is small enough and doesn't need to be fragmented, or -1 if
+		 * it can't be fragmented (for example: "Don't Fragment" flag is set or the MTU is too small)
+		 */
+		int getNumOfFragments(Packet* packet, size_t& maxFragmentLen) const;
+
+		/**
+		 * Split a packet into fragments and write them into pre-allocated buffers. No memory is allocated by this method
+		 * @param[in] packet The packet to fragment. It isn't modified in any way
+		 * @param[in,out] fragments An array of output buffers. The data of fragment i is written to fragments[i].data and its length is
+		 * set in fragments[i].len
+		 * @param[in] numOfFragmentBuffers The number of buffers in the array
+		 * @return The number of fragments written, 0 if the packet isn't IPv4/IPv6 or doesn't need to be fragmented (in this case no data
+		 * is written), or -1 if the packet can't be fragmented or if there aren't enough buffers or a buffer is too small
+		 */
+		int fragmentPacket(Packet* packet, FragmentBuffer* fragments, int numOfFragmentBuffers);
+
+		/**
+		 * Split a packet into fragments and store each fragment in a newly allocated RawPacket. Each fragment is allocated exactly in its
+		 * size and gets the timestamp and link-layer type of the original packet
+		 * @param[in] packet The packet to fragment. It isn't modified in any way
+		 * @param[out] resultFragments A vector the new fragments are appended to. The vector is responsible for freeing them
+		 * @return The number of fragments created, 0 if the packet isn't IPv4/IPv6 or doesn't need to be fragmented (in this case nothing
+		 * is added to the vector), or -1 if the packet can't be fragmented
+		 */
+		int fragmentPacket(Packet* packet, PointerVector<RawPacket>& resultFragments);
+
+	private:
+
+		struct FragmentationPlan;
+
+		size_t m_Mtu;
+		size_t m_MaxFragmentPayloadSize;
+		bool m_IgnoreDontFragment;
+		uint32_t m_NextIPv6FragmentId;
+
+		int createPlan(Packet* packet, FragmentationPlan& plan) const;
+		size_t writeFragment(const FragmentationPlan& plan, int fragIndex, uint8_t* buffer) const;
+	};
+
+} // namespace pcpp
+
+#endif // PACKETPP_IP_FRAGMENTATION
@@ -6,6 +6,7 @@
 #include "IpAddress.h"
 #include "PointerVector.h"
 #include <map>
+#include <vector>
 
 /**
  * @file
@@ -56,6 +57,7 @@ namespace pcpp
 	 * to understand how this mechanism works. The main APIs are:
 	 * - IPReassembly#processPacket() - process a fragment. This is the main method which should be called whenever a new fragment arrives.
 	 *   This method processes the fragment, runs the reassembly logic and returns the result packet when it's fully reassembled
+	 * - IPReassembly#processPackets() - process a burst of fragments, for example the packets received from a DPDK or PF_RING device in one call
 	 * - IPReassembly#getCurrentPacket() - get the reassembled data that is currently available, even if reassembly process is not yet completed
 	 * - IPReassembly#removePacket() - remove all data that is currently stored for a packet, including the reassembled data that was gathered
 	 *   so far
@@ -325,7 +327,8 @@ namespace pcpp
 		 * @param[in] maxPacketsToStore Set the capacity limit of the IP reassembly mechanism. Default capacity is #PCPP_IP_REASSEMBLY_DEFAULT_MAX_PACKETS_TO_STORE
 		 */
 		IPReassembly(OnFragmentsClean onFragmentsCleanCallback = NULL, void *callbackUserCookie = NULL, size_t maxPacketsToStore = PCPP_IP_REASSEMBLY_DEFAULT_MAX_PACKETS_TO_STORE)
-			: m_PacketLRU(maxPacketsToStore), m_OnFragmentsCleanCallback(onFragmentsCleanCallback), m_CallbackUserCookie(callbackUserCookie) {}
+			: m_PacketLRU(maxPacketsToStore), m_OnFragmentsCleanCallback(onFragmentsCleanCallback), m_CallbackUserCookie(callbackUserCookie),
+			  m_InBatch(false), m_BatchLastFragData(NULL), m_BatchLastHash(0) {}
 
 		/**
 		 * A d'tor for this class
@@ -391,6 +394,20 @@ namespace pcpp
 		 */
 		Packet* processPacket(RawPacket* fragment, ReassemblyStatus& status, ProtocolType parseUntil = UnknownProtocol, OsiModelLayer parseUntilLayer = OsiModelLayerUnknown);
 
+		/**
+		 * Process a burst of packets, for example the packets received by one call to DpdkDevice#receivePackets() or PfRingDevice#receivePackets().
+		 * The result is the same as calling processPacket() for each packet, but the fragments are grouped by the packet they belong to: the fragments of
+		 * each packet are processed one after the other in their original order, and the packet is looked up in the internal structures once per group
+		 * @param[in] fragments An array of pointers to the packets to process
+		 * @param[in] numOfFragments The number of packets in the array
+		 * @param[out] results An array of at least numOfFragments items. Each item is set to the value processPacket() returns for the packet in the same index:
+		 * the input packet if it isn't an IPv4/IPv6 fragment, a reassembled packet which the user is responsible to free, or NULL
+		 * @param[out] statuses An optional array of at least numOfFragments items. If it's not NULL each item is set to the status of the packet in the same index
+		 * @param[in] parseUntil Optional parameter. Parse the reassembled packets until you reach a certain protocol (inclusive). Please see processPacket() for more details
+		 * @param[in] parseUntilLayer Optional parameter. Parse the reassembled packets until you reach a certain layer in the OSI model (inclusive). Please see processPacket() for more details
+		 */
+		void processPackets(Packet** fragments, size_t numOfFragments, Packet** results, ReassemblyStatus* statuses = NULL, ProtocolType parseUntil = UnknownProtocol, OsiModelLayer parseUntilLayer = OsiModelLayerUnknown);
+
 		/**
 		 * Get a partially reassembled packet. This method returns all the reassembled data that was gathered so far which is obviously not
 		 * a fully reassembled packet (otherwise it would have returned by processPacket()). Notice all data is being copied so the user is
@@ -447,6 +464,10 @@ namespace pcpp
 		std::map<uint32_t, IPFragmentData*> m_FragmentMap;
 		OnFragmentsClean m_OnFragmentsCleanCallback;
 		void* m_CallbackUserCookie;
+		std::vector<std::pair<uint32_t, size_t> > m_BatchOrder;
+		bool m_InBatch;
+		IPFragmentData* m_BatchLastFragData;
+		uint32_t m_BatchLastHash;
 
 		void addNewFragment(uint32_t hash, IPFragmentData* fragData);
 		bool matchOutOfOrderFragments(IPFragmentData* fragData);
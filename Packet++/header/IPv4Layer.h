@@ -405,6 +405,10 @@ namespace pcpp
 	class IPv4Layer : public Layer
 	{
 	public:
+		/** %IPv4Layer instances carry ::IPv4, see Layer#LayerProtocol */
+		static const ProtocolType LayerProtocol = IPv4;
+		typedef IPv4Layer LayerProtocolClass;
+
 		/**
 		 * A constructor that creates the layer from an existing packet raw data
 		 * @param[in] data A pointer to the raw data (will be casted to @ref iphdr)
@@ -515,6 +519,17 @@ namespace pcpp
 		 */
 		IPv4Option getOption(IPv4OptionTypes option) const;
 
+		/**
+		 * Get several IPv4 options by type in a single pass over the options
+		 * @param[in] optionTypes An array of the IPv4 option types to retrieve
+		 * @param[in] numOfOptionTypes The number of option types in the array
+		 * @param[out] result A vector that will be filled with one IPv4Option object per option type, in the same order as
+		 * optionTypes. Each object contains the first option that matches the type, or logical NULL (IPv4Option#isNull() == true)
+		 * if no such option found
+		 * @return The number of option types that were found
+		 */
+		size_t getOptions(const IPv4OptionTypes* optionTypes, size_t numOfOptionTypes, std::vector<IPv4Option>& result) const;
+
 		/**
 		 * @return The first IPv4 option in the packet. If the current layer contains no options the returned value will contain
 		 * a logical NULL (IPv4Option#isNull() == true)
@@ -614,6 +629,8 @@ namespace pcpp
 		void adjustOptionsTrailer(size_t totalOptSize);
 		void initLayer();
 		void initLayerInPacket(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet, bool setTotalLenAsDataLen);
+
+		Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new IPv4Layer(data, m_DataLen, prevLayer, packet, false); }
 	};
 
 
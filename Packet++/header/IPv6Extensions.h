@@ -302,6 +302,16 @@ namespace pcpp
 		 */
 		IPv6Option getOption(uint8_t optionType) const;
 
+		/**
+		 * Retrieve several options by their types in a single pass over the options
+		 * @param[in] optionTypes An array of the option types to retrieve
+		 * @param[in] numOfOptionTypes The number of option types in the array
+		 * @param[out] result A vector that will be filled with one IPv6Option object per option type, in the same order as
+		 * optionTypes. Option types that aren't found will have a logical NULL object (IPv6Option#isNull() == true)
+		 * @return The number of option types that were found
+		 */
+		size_t getOptions(const uint8_t* optionTypes, size_t numOfOptionTypes, std::vector<IPv6Option>& result) const;
+
 		/**
 		 * @return An IPv6Option that wraps the first option data or logical NULL (IPv6Option#isNull() == true) if no options exist
 		 */
@@ -54,6 +54,10 @@ namespace pcpp
 	class IPv6Layer : public Layer
 	{
 	public:
+		/** %IPv6Layer instances carry ::IPv6, see Layer#LayerProtocol */
+		static const ProtocolType LayerProtocol = IPv6;
+		typedef IPv6Layer LayerProtocolClass;
+
 		/**
 		 * A constructor that creates the layer from an existing packet raw data
 		 * @param[in] data A pointer to the raw data (will be casted to @ref ip6_hdr)
@@ -184,6 +188,8 @@ namespace pcpp
 		IPv6Extension* m_FirstExtension;
 		IPv6Extension* m_LastExtension;
 		size_t m_ExtensionsLen;
+
+		Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new IPv6Layer(data, m_DataLen, prevLayer, packet); }
 	};
 
 
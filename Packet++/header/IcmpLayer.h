@@ -389,6 +389,10 @@ namespace pcpp
 		bool setIpAndL4Layers(IPv4Layer* ipLayer, Layer* l4Layer);
 
 	public:
+		/** %IcmpLayer instances carry ::ICMP, see Layer#LayerProtocol */
+		static const ProtocolType LayerProtocol = ICMP;
+		typedef IcmpLayer LayerProtocolClass;
+
 		/**
 		 * A constructor that creates the layer from an existing packet raw data
 		 * @param[in] data A pointer to the raw data (will be casted to @ref arphdr)
@@ -703,6 +707,9 @@ namespace pcpp
 		std::string toString() const;
 
 		OsiModelLayer getOsiModelLayer() const { return OsiModelNetworkLayer; }
+
+	private:
+		Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new IcmpLayer(data, m_DataLen, prevLayer, packet); }
 	};
 
 	// implementation of inline methods
@@ -170,6 +170,9 @@ protected:
 
 	size_t getHeaderSizeByVerAndType(ProtocolType igmpVer, IgmpType igmpType) const;
 public:
+	/** %IgmpLayer instances carry ::IGMP, see Layer#LayerProtocol */
+	static const ProtocolType LayerProtocol = IGMP;
+	typedef IgmpLayer LayerProtocolClass;
 
 	virtual ~IgmpLayer() {}
 
@@ -238,6 +241,10 @@ public:
 class IgmpV1Layer : public IgmpLayer
 {
 public:
+	/** %IgmpV1Layer instances carry ::IGMPv1, see Layer#LayerProtocol */
+	static const ProtocolType LayerProtocol = IGMPv1;
+	typedef IgmpV1Layer LayerProtocolClass;
+
 	 /** A constructor that creates the layer from an existing packet raw data
 	 * @param[in] data A pointer to the raw data
 	 * @param[in] dataLen Size of the data in bytes
@@ -269,6 +276,8 @@ public:
 	 */
 	void computeCalculateFields();
 
+private:
+	Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new IgmpV1Layer(data, m_DataLen, prevLayer, packet); }
 };
 
 
@@ -279,6 +288,10 @@ public:
 class IgmpV2Layer : public IgmpLayer
 {
 public:
+	/** %IgmpV2Layer instances carry ::IGMPv2, see Layer#LayerProtocol */
+	static const ProtocolType LayerProtocol = IGMPv2;
+	typedef IgmpV2Layer LayerProtocolClass;
+
 	 /** A constructor that creates the layer from an existing packet raw data
 	 * @param[in] data A pointer to the raw data
 	 * @param[in] dataLen Size of the data in bytes
@@ -309,6 +322,9 @@ public:
 	 * Calculate the IGMP checksum
 	 */
 	void computeCalculateFields();
+
+private:
+	Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new IgmpV2Layer(data, m_DataLen, prevLayer, packet); }
 };
 
 
@@ -319,6 +335,16 @@ public:
 class IgmpV3QueryLayer : public IgmpLayer
 {
 public:
+	/** %IgmpV3QueryLayer instances carry ::IGMPv3, see Layer#LayerProtocol */
+	static const ProtocolType LayerProtocol = IGMPv3;
+	typedef IgmpV3QueryLayer LayerProtocolClass;
+
+	/**
+	 * IGMPv3 queries and reports both carry ::IGMPv3, this method tells queries apart (see Layer#isInstance())
+	 * @param[in] layer An IGMPv3 layer
+	 * @return True if the layer is an IGMPv3 membership query
+	 */
+	static bool isInstance(const Layer& layer) { return static_cast<const IgmpLayer&>(layer).getType() == IgmpType_MembershipQuery; }
 
 	 /** A constructor that creates the layer from an existing packet raw data
 	 * @param[in] data A pointer to the raw data
@@ -400,6 +426,9 @@ public:
 	 * @return The message size in bytes which include the size of the basic header + the size of the source address list
 	 */
 	size_t getHeaderLen() const;
+
+private:
+	Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new IgmpV3QueryLayer(data, m_DataLen, prevLayer, packet); }
 };
 
 
@@ -413,6 +442,16 @@ private:
 	igmpv3_group_record* addGroupRecordAt(uint8_t recordType, const IPv4Address& multicastAddress, const std::vector<IPv4Address>& sourceAddresses, int offset);
 
 public:
+	/** %IgmpV3ReportLayer instances carry ::IGMPv3, see Layer#LayerProtocol */
+	static const ProtocolType LayerProtocol = IGMPv3;
+	typedef IgmpV3ReportLayer LayerProtocolClass;
+
+	/**
+	 * IGMPv3 queries and reports both carry ::IGMPv3, this method tells reports apart (see Layer#isInstance())
+	 * @param[in] layer An IGMPv3 layer
+	 * @return True if the layer is an IGMPv3 membership report
+	 */
+	static bool isInstance(const Layer& layer) { return static_cast<const IgmpLayer&>(layer).getType() != IgmpType_MembershipQuery; }
 
 	 /** A constructor that creates the layer from an existing packet raw data
 	 * @param[in] data A pointer to the raw data
@@ -507,6 +546,9 @@ public:
 	 * @return The message size in bytes which include the size of the basic header + the size of the group record list
 	 */
 	size_t getHeaderLen() const { return m_DataLen; }
+
+private:
+	Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new IgmpV3ReportLayer(data, m_DataLen, prevLayer, packet); }
 };
 
 }
@@ -126,6 +126,30 @@ namespace pcpp
 		 */
 		void copyData(uint8_t* toArr) const;
 
+		/**
+		 * The protocol (or mask of protocols) carried by the layers of this class. Every layer class in PcapPlusPlus defines its own value
+		 * (for example IPv4Layer::LayerProtocol is ::IPv4 and IgmpLayer::LayerProtocol is ::IGMP), which lets Packet match a layer class
+		 * against a layer instance by its protocol instead of using RTTI (see Packet#getLayerOfType()). The value of the base class means
+		 * any protocol. User-defined layer classes should define it as well, otherwise typed lookups fall back to dynamic_cast
+		 */
+		static const ProtocolType LayerProtocol = ~((ProtocolType)0);
+
+		/**
+		 * Every class that defines LayerProtocol or isInstance() also defines this typedef as itself. A class deriving from a concrete
+		 * layer class (for example a user class deriving from HttpRequestLayer) inherits LayerProtocol and isInstance() of its base
+		 * class, which would match instances of the base class as well. Packet notices it by this typedef naming another class and
+		 * matches such classes with dynamic_cast instead. When building without RTTI, a class deriving from a concrete layer class
+		 * must define LayerProtocol, isInstance() and this typedef to be used in typed lookups
+		 */
+		typedef Layer LayerProtocolClass;
+
+		/**
+		 * Layer classes sharing their LayerProtocol with sibling classes (for example the different SSL record types) redefine this method
+		 * to tell their instances apart. It is only called for layers that carry LayerProtocol
+		 * @return True if the layer is an instance of this class. The base class implementation always returns true
+		 */
+		static bool isInstance(const Layer& /* layer */) { return true; }
+
 
 		// implement abstract methods
 
@@ -184,6 +208,14 @@ namespace pcpp
 
 		virtual bool extendLayer(int offsetInLayer, size_t numOfBytesToExtend);
 		virtual bool shortenLayer(int offsetInLayer, size_t numOfBytesToShorten);
+
+		// used by Packet when copying a packet: creates a layer of the same type over the copied data without looking for the next
+		// layers. Layer types that return NULL make Packet parse the copied data from scratch
+		virtual Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return NULL; }
+
+		// used by Packet when the raw data is moved to another buffer with the same layout: points the layer to its data in the new
+		// buffer. Layer types that keep other pointers into their data (for example to messages they parsed) re-create them
+		virtual void rebaseData(uint8_t* data) { m_Data = data; }
 	};
 
 } // namespace pcpp
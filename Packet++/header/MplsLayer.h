@@ -32,6 +32,10 @@ namespace pcpp
 		mpls_header* getMplsHeader() const { return (mpls_header*)m_Data; }
 
 	public:
+		/** %MplsLayer instances carry ::MPLS, see Layer#LayerProtocol */
+		static const ProtocolType LayerProtocol = MPLS;
+		typedef MplsLayer LayerProtocolClass;
+
 		 /** A constructor that creates the layer from an existing packet raw data
 		 * @param[in] data A pointer to the raw data
 		 * @param[in] dataLen Size of the data in bytes
@@ -119,6 +123,9 @@ namespace pcpp
 		std::string toString() const;
 
 		OsiModelLayer getOsiModelLayer() const { return OsiModelNetworkLayer; }
+
+	private:
+		Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new MplsLayer(data, m_DataLen, prevLayer, packet); }
 	};
 
 } // namespace pcpp
@@ -32,6 +32,10 @@ namespace pcpp
 	class NullLoopbackLayer : public Layer
 	{
 	public:
+		/** %NullLoopbackLayer instances carry ::NULL_LOOPBACK, see Layer#LayerProtocol */
+		static const ProtocolType LayerProtocol = NULL_LOOPBACK;
+		typedef NullLoopbackLayer LayerProtocolClass;
+
 		 /** A constructor that creates the layer from an existing packet raw data
 		 * @param[in] data A pointer to the raw data
 		 * @param[in] dataLen Size of the data in bytes
@@ -85,6 +89,9 @@ namespace pcpp
 		std::string toString() const;
 
 		OsiModelLayer getOsiModelLayer() const { return OsiModelDataLinkLayer; }
+
+	private:
+		Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new NullLoopbackLayer(data, m_DataLen, packet); }
 	};
 
 } // namespace pcpp
@@ -51,6 +51,10 @@ namespace pcpp
 	class PPPoELayer : public Layer
 	{
 	public:
+		/** %PPPoELayer instances carry ::PPPoE, see Layer#LayerProtocol */
+		static const ProtocolType LayerProtocol = PPPoE;
+		typedef PPPoELayer LayerProtocolClass;
+
 		/**
 		 * PPPoE possible codes
 		 */
@@ -115,6 +119,9 @@ namespace pcpp
 	class PPPoESessionLayer : public PPPoELayer
 	{
 	public:
+		/** %PPPoESessionLayer instances carry ::PPPoESession, see Layer#LayerProtocol */
+		static const ProtocolType LayerProtocol = PPPoESession;
+		typedef PPPoESessionLayer LayerProtocolClass;
 
 		/**
 		 * A constructor that creates the layer from an existing packet raw data
@@ -169,6 +176,9 @@ namespace pcpp
 		virtual size_t getHeaderLen() const { return sizeof(pppoe_header) + sizeof(uint16_t); }
 
 		virtual std::string toString() const;
+
+	private:
+		Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new PPPoESessionLayer(data, m_DataLen, prevLayer, packet); }
 	};
 
 
@@ -180,6 +190,10 @@ namespace pcpp
 	class PPPoEDiscoveryLayer : public PPPoELayer
 	{
 	public:
+		/** %PPPoEDiscoveryLayer instances carry ::PPPoEDiscovery, see Layer#LayerProtocol */
+		static const ProtocolType LayerProtocol = PPPoEDiscovery;
+		typedef PPPoEDiscoveryLayer LayerProtocolClass;
+
 		/**
 		 * PPPoE tag types
 		 */
@@ -395,6 +409,8 @@ namespace pcpp
 		PPPoETag* castPtrToPPPoETag(uint8_t* ptr) const;
 
 		std::string codeToString(PPPoECode code) const;
+
+		Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new PPPoEDiscoveryLayer(data, m_DataLen, prevLayer, packet); }
 	};
 
 
@@ -7,6 +7,10 @@
 
 /// @file
 
+#if defined(__GXX_RTTI) || defined(_CPPRTTI)
+#define PCPP_HAS_RTTI
+#endif
+
 /**
  * \namespace pcpp
  * \brief The main namespace for the PcapPlusPlus lib
@@ -33,6 +37,10 @@ namespace pcpp
 		uint64_t m_ProtocolTypes;
 		size_t m_MaxPacketLen;
 		bool m_FreeRawPacket;
+		bool m_SharedRawData;
+		// the first layer of each protocol, indexed by the protocol bit. Only entries whose bit is set in m_LayerIndexMask are valid
+		Layer* m_LayerIndex[64];
+		uint64_t m_LayerIndexMask;
 
 	public:
 
@@ -90,10 +98,24 @@ namespace pcpp
 
 		/**
 		 * A copy constructor for this class. This copy constructor copies all the raw data and re-create all layers. So when the original Packet
-		 * is being freed, no data will be lost in the copied instance
+		 * is being freed, no data will be lost in the copied instance. Layers are re-created from the types and offsets of the layers of the
+		 * other packet, so the data isn't parsed again
 		 * @param[in] other The instance to copy from
 		 */
-		Packet(const Packet& other) { copyDataFrom(other); }
+		Packet(const Packet& other) { copyDataFrom(other, false); }
+
+		/**
+		 * A copy constructor that can share the raw data with the other packet instead of copying it (copy-on-write). The shared data is
+		 * copied on the first change done through this packet: adding, removing, extending or shortening layers and
+		 * computeCalculateFields() call makeWritable() automatically. Changing header fields directly (for example through
+		 * IPv4Layer#getIPv4Header()) isn't tracked, so makeWritable() must be called before such changes. As long as the data is shared
+		 * the other packet and its raw data must not be freed or changed, unless the raw data of the other packet is reference-counted
+		 * (see RawPacket#makeRawDataRefCounted()): then this packet holds a reference to it and the other packet can be freed
+		 * @param[in] other The instance to copy from
+		 * @param[in] copyOnWrite If set to true the raw data is shared until makeWritable() is called, otherwise it's copied like in the
+		 * copy constructor
+		 */
+		Packet(const Packet& other, bool copyOnWrite) { copyDataFrom(other, copyOnWrite); }
 
 		/**
 		 * Assignment operator overloading. It first frees all layers allocated by this instance (Notice: it doesn't free layers that weren't allocated by this
@@ -110,6 +132,21 @@ namespace pcpp
 		 */
 		RawPacket* getRawPacket() const { return m_RawPacket; }
 
+		/**
+		 * @return True if this packet was created with copy-on-write and shares its raw data with another packet
+		 */
+		bool isRawDataShared() const { return m_SharedRawData; }
+
+		/**
+		 * Copy the raw data of a packet that shares it with another packet (see Packet(const Packet&, bool)), so it can be changed. The
+		 * layers are moved to the copied data and the packet gets a new RawPacket instance, so pointers previously returned by
+		 * getRawPacket() or by the layers' getData() methods are no longer valid. The layer instances stay valid, but objects parsed
+		 * from their data (for example SSL handshake messages and their extensions) are re-created, so pointers to them must be fetched
+		 * again. Does nothing if the data isn't shared
+		 * @return True if the data is writable or false if it couldn't be copied
+		 */
+		bool makeWritable();
+
 		/**
 		 * Set a RawPacket and re-construct all packet layers
 		 * @param[in] rawPacket Raw packet to set
@@ -244,7 +281,10 @@ namespace pcpp
 		Layer* getLayerOfType(ProtocolType layerType, int index = 0) const;
 
 		/**
-		 * A templated method to get a layer of a certain type (protocol). If no layer of such type is found, NULL is returned
+		 * A templated method to get a layer of a certain type (protocol). If no layer of such type is found, NULL is returned.
+		 * The lookup doesn't use RTTI: the layer class is matched by its Layer#LayerProtocol, and the first layer of each protocol
+		 * is kept in an index that is updated whenever layers are parsed, added or removed, so for most layer classes the lookup
+		 * in forward order takes constant time
 		 * @param[in] reverseOrder The optional paramter that indicates that the lookup should run in reverse order, the default value is false
 		 * @return A pointer to the layer of the requested type, NULL if not found
 		 */
@@ -302,7 +342,7 @@ namespace pcpp
 		void toStringList(std::vector<std::string>& result, bool timeAsLocalTime = true) const;
 
 	private:
-		void copyDataFrom(const Packet& other);
+		void copyDataFrom(const Packet& other, bool copyOnWrite);
 
 		void destructPacketData();
 
@@ -316,25 +356,122 @@ namespace pcpp
 		std::string printPacketInfo(bool timeAsLocalTime) const;
 
 		Layer* createFirstLayer(LinkLayerType linkType);
+
+		void addLayerToIndex(Layer* layer);
+
+		template<class TLayer>
+		static bool isLayerOfClass(const Layer* layer);
+
+		static int getProtocolIndex(ProtocolType protocol);
+
+		static bool isSingleProtocol(ProtocolType protocol) { return protocol != UnknownProtocol && (protocol & (protocol - 1)) == 0; }
 	}; // class Packet
 
 
+	namespace internal
+	{
+		template<class T, class U>
+		struct IsSameClass { static const bool value = false; };
+
+		template<class T>
+		struct IsSameClass<T, T> { static const bool value = true; };
+
+		/**
+		 * True if the layer class declares its own LayerProtocol and isInstance() (see Layer#LayerProtocolClass), which means its
+		 * instances can be told apart by protocol without RTTI
+		 */
+		template<class TLayer>
+		struct HasOwnLayerProtocol
+		{
+			static const bool value = IsSameClass<TLayer, typename TLayer::LayerProtocolClass>::value && TLayer::LayerProtocol != Layer::LayerProtocol;
+		};
+
+		/**
+		 * Matches a layer instance against a layer class by the class' LayerProtocol. Classes that don't define their own LayerProtocol
+		 * are matched with dynamic_cast, which isn't available when building without RTTI
+		 */
+		template<class TLayer, bool InheritsLayerProtocol>
+		struct LayerClassMatcher
+		{
+			static bool match(const Layer* layer) { return (layer->getProtocol() & TLayer::LayerProtocol) != 0 && TLayer::isInstance(*layer); }
+		};
+
+		template<class TLayer>
+		struct LayerClassMatcher<TLayer, true>
+		{
+			static bool match(const Layer* layer)
+			{
+#ifdef PCPP_HAS_RTTI
+				return dynamic_cast<const TLayer*>(layer) != NULL;
+#else
+				// without RTTI every layer class has to define LayerProtocol
+				typedef char LayerClassMustDefineLayerProtocol[sizeof(TLayer) == 0 ? 1 : -1];
+				return sizeof(LayerClassMustDefineLayerProtocol) == 0;
+#endif
+			}
+		};
+
+		template<>
+		struct LayerClassMatcher<Layer, true>
+		{
+			static bool match(const Layer*) { return true; }
+		};
+	}
+
+
 	// implementation of inline methods
 
+	inline int Packet::getProtocolIndex(ProtocolType protocol)
+	{
+#if defined(__GNUC__)
+		return __builtin_ctzll(protocol);
+#else
+		int index = 0;
+		while ((protocol & 1) == 0)
+		{
+			protocol >>= 1;
+			index++;
+		}
+		return index;
+#endif
+	}
+
+	template<class TLayer>
+	bool Packet::isLayerOfClass(const Layer* layer)
+	{
+		return internal::LayerClassMatcher<TLayer, !internal::HasOwnLayerProtocol<TLayer>::value>::match(layer);
+	}
+
 	template<class TLayer>
 	TLayer* Packet::getLayerOfType(bool reverse) const
 	{
 		if (!reverse)
 		{
-			if (dynamic_cast<TLayer*>(getFirstLayer()) != NULL)
-				return (TLayer*)getFirstLayer();
+			Layer* firstLayer = getFirstLayer();
+			if (firstLayer == NULL)
+				return NULL;
 
-			return getNextLayerOfType<TLayer>(getFirstLayer());
+			// a class with a single protocol starts from the first layer of that protocol, which is usually the result
+			if (internal::HasOwnLayerProtocol<TLayer>::value && isSingleProtocol(TLayer::LayerProtocol))
+			{
+				if ((m_LayerIndexMask & TLayer::LayerProtocol) == 0)
+					return NULL;
+
+				firstLayer = m_LayerIndex[getProtocolIndex(TLayer::LayerProtocol)];
+			}
+
+			if (isLayerOfClass<TLayer>(firstLayer))
+				return static_cast<TLayer*>(firstLayer);
+
+			return getNextLayerOfType<TLayer>(firstLayer);
 		}
 
 		// lookup in reverse order
-		if (dynamic_cast<TLayer*>(getLastLayer()) != NULL)
-			return (TLayer*)getLastLayer();
+		if (getLastLayer() == NULL)
+			return NULL;
+
+		if (isLayerOfClass<TLayer>(getLastLayer()))
+			return static_cast<TLayer*>(getLastLayer());
 
 		return getPrevLayerOfType<TLayer>(getLastLayer());
 	}
@@ -346,12 +483,12 @@ namespace pcpp
 			return NULL;
 
 		curLayer = curLayer->getNextLayer();
-		while ((curLayer != NULL) && (dynamic_cast<TLayer*>(curLayer) == NULL))
+		while (curLayer != NULL && !isLayerOfClass<TLayer>(curLayer))
 		{
 			curLayer = curLayer->getNextLayer();
 		}
 
-		return (TLayer*)curLayer;
+		return static_cast<TLayer*>(curLayer);
 	}
 
 	template<class TLayer>
@@ -361,7 +498,7 @@ namespace pcpp
 			return NULL;
 
 		curLayer = curLayer->getPrevLayer();
-		while (curLayer != NULL && dynamic_cast<TLayer*>(curLayer) == NULL)
+		while (curLayer != NULL && !isLayerOfClass<TLayer>(curLayer))
 		{
 			curLayer = curLayer->getPrevLayer();
 		}
@@ -0,0 +1,209 @@
+#ifndef PACKETPP_PACKET_BUILDER
+#define PACKETPP_PACKET_BUILDER
+
+#include "RawPacket.h"
+#include "EthLayer.h"
+#include "VlanLayer.h"
+#include "IPv4Layer.h"
+#include "IPv6Layer.h"
+#include "TcpLayer.h"
+#include "UdpLayer.h"
+
+/**
+ * @file
+ * This file includes PacketBuilder, a class for crafting packets directly into a single buffer.<BR>
+ * Crafting a packet with the layer classes means each layer (pcpp#EthLayer, pcpp#IPv4Layer, pcpp#TcpLayer, ...) allocates its own
+ * data, then Packet#addLayer() copies it into the packet buffer (which may be reallocated as it grows) and frees the layer data.
+ * PacketBuilder writes each header in place, right after the previous one, into a buffer that is either provided by the user (for
+ * example the data area of a device buffer) or allocated once by the builder. When all headers and the payload are written,
+ * finalize() sets the length fields, the next protocol fields and the checksums in a single pass from the last layer to the first,
+ * so each checksum covers data that is already final (which is also correct for tunnels, for example IPv4 over UDP).<BR>
+ * The size of a packet is known before it's built: it's the sum of the header sizes (sizeof(pcpp#ether_header),
+ * sizeof(pcpp#iphdr), ...) and the payload length.<BR>
+ * Supported layers are Ethernet, VLAN, IPv4, IPv6, TCP, UDP and payload. Headers are written without options and extensions
+ */
+
+/**
+ * \namespace pcpp
+ * \brief The main namespace for the PcapPlusPlus lib
+ */
+namespace pcpp
+{
+
+	/**
+	 * @class PacketBuilder
+	 * Crafts a packet into a single buffer. Please refer to the documentation at the top of PacketBuilder.h to understand how it works.
+	 * A typical usage looks like this:
+	 * @code
+	 * pcpp::PacketBuilder builder(sizeof(pcpp::ether_header) + sizeof(pcpp::iphdr) + sizeof(pcpp::tcphdr) + payloadLen);
+	 * builder.addEthLayer(srcMac, dstMac);
+	 * builder.addIPv4Layer(srcIP, dstIP);
+	 * pcpp::tcphdr* tcpHeader = builder.addTcpLayer(12345, 80);
+	 * tcpHeader->synFlag = 1;
+	 * builder.addPayload(payload, payloadLen);
+	 * pcpp::RawPacket rawPacket;
+	 * builder.build(rawPacket, timestamp); // no copy, rawPacket now owns the buffer
+	 * @endcode
+	 * All add methods return a pointer to the data written in the buffer (so other fields can be set) or NULL if there isn't enough
+	 * room in the buffer or if the maximum number of layers was reached
+	 */
+	class PacketBuilder
+	{
+	public:
+
+		/** The maximum number of layers in a packet */
+		static const size_t MaxNumOfLayers = 16;
+
+		/**
+		 * A c'tor for a builder that writes into a user-provided buffer. The builder never allocates memory nor frees this buffer
+		 * @param[in] buffer The buffer to write the packet to
+		 * @param[in] bufferLen The buffer size in bytes
+		 */
+		PacketBuilder(uint8_t* buffer, size_t bufferLen);
+
+		/**
+		 * A c'tor for a builder that allocates its own buffer. The buffer is allocated once, when the first layer is added, and its
+		 * ownership moves to the RawPacket on build(). The next packet is then built into a new buffer of the same size
+		 * @param[in] bufferLen The buffer size in bytes, which is the maximum packet size this builder can create
+		 */
+		explicit PacketBuilder(size_t bufferLen);
+
+		/**
+		 * A d'tor for this class. Frees the buffer if it was allocated by the builder and wasn't moved to a RawPacket
+		 */
+		~PacketBuilder();
+
+		/**
+		 * Write an Ethernet II header. The EtherType is set by finalize() according to the next layer
+		 * @param[in] srcMac Source MAC address
+		 * @param[in] dstMac Destination MAC address
+		 * @return A pointer to the header in the buffer or NULL if it couldn't be written
+		 */
+		ether_header* addEthLayer(const MacAddress& srcMac, const MacAddress& dstMac);
+
+		/**
+		 * Write a VLAN header. The EtherType is set by finalize() according to the next layer
+		 * @param[in] vlanID VLAN ID
+		 * @param[in] cfi CFI value
+		 * @param[in] priority Priority value
+		 * @return A pointer to the header in the buffer or NULL if it couldn't be written
+		 */
+		vlan_header* addVlanLayer(uint16_t vlanID, bool cfi, uint8_t priority);
+
+		/**
+		 * Write an IPv4 header without options. The total length, protocol and checksum fields are set by finalize()
+		 * @param[in] srcIP Source IPv4 address
+		 * @param[in] dstIP Destination IPv4 address
+		 * @param[in] timeToLive The time-to-live value. Default value is 64
+		 * @return A pointer to the header in the buffer or NULL if it couldn't be written
+		 */
+		iphdr* addIPv4Layer(const IPv4Address& srcIP, const IPv4Address& dstIP, uint8_t timeToLive = 64);
+
+		/**
+		 * Write an IPv6 header without extensions. The payload length and next header fields are set by finalize()
+		 * @param[in] srcIP Source IPv6 address
+		 * @param[in] dstIP Destination IPv6 address
+		 * @param[in] hopLimit The hop limit value. Default value is 64
+		 * @return A pointer to the header in the buffer or NULL if it couldn't be written
+		 */
+		ip6_hdr* addIPv6Layer(const IPv6Address& srcIP, const IPv6Address& dstIP, uint8_t hopLimit = 64);
+
+		/**
+		 * Write a TCP header without options and without flags. The checksum is set by finalize()
+		 * @param[in] portSrc Source port
+		 * @param[in] portDst Destination port
+		 * @return A pointer to the header in the buffer or NULL if it couldn't be written
+		 */
+		tcphdr* addTcpLayer(uint16_t portSrc, uint16_t portDst);
+
+		/**
+		 * Write a UDP header. The length and checksum fields are set by finalize()
+		 * @param[in] portSrc Source port
+		 * @param[in] portDst Destination port
+		 * @return A pointer to the header in the buffer or NULL if it couldn't be written
+		 */
+		udphdr* addUdpLayer(uint16_t portSrc, uint16_t portDst);
+
+		/**
+		 * Write a payload. Payload can be added more than once, all parts are considered as a single payload
+		 * @param[in] data The payload data to copy. If NULL, the payload is zeroed so it can be written later through the returned pointer
+		 * @param[in] dataLen The payload length in bytes
+		 * @return A pointer to the payload in the buffer or NULL if it couldn't be written
+		 */
+		uint8_t* addPayload(const uint8_t* data, size_t dataLen);
+
+		/**
+		 * Set the length, next protocol and checksum fields of all layers. Should be called after the last layer was added and
+		 * whenever headers or payload are modified later. build() calls this method
+		 * @return True if the packet was finalized or false if no layer was added
+		 */
+		bool finalize();
+
+		/**
+		 * Finalize the packet and set it as the data of a RawPacket, without copying it. Can be used only if the builder allocated the
+		 * buffer. The buffer is moved to the RawPacket (so it should be a RawPacket that frees its data, like one created with the
+		 * default c'tor) and the builder is cleared for the next packet. For a user-provided buffer call finalize() instead and use the
+		 * buffer directly
+		 * @param[out] rawPacket The RawPacket to set the data to
+		 * @param[in] timestamp The packet timestamp
+		 * @return True if the packet was built or false if the buffer is user-provided or if no layer was added
+		 */
+		bool build(RawPacket& rawPacket, timeval timestamp);
+
+		/**
+		 * Remove all layers so a new packet can be built into the same buffer
+		 */
+		void clear();
+
+		/**
+		 * @return A pointer to the packet data or NULL if the builder didn't allocate a buffer yet
+		 */
+		uint8_t* getData() const { return m_Buffer; }
+
+		/**
+		 * @return The length in bytes of the data written so far
+		 */
+		size_t getDataLen() const { return m_DataLen; }
+
+		/**
+		 * @return The buffer size in bytes
+		 */
+		size_t getBufferLen() const { return m_BufferLen; }
+
+		/**
+		 * @return The number of layers added so far. Consecutive payloads are counted as one layer
+		 */
+		size_t getNumOfLayers() const { return m_NumOfLayers; }
+
+		/**
+		 * @return The link layer type of the packet: LINKTYPE_ETHERNET if it starts with an Ethernet header or LINKTYPE_RAW if it
+		 * starts with an IP header
+		 */
+		LinkLayerType getLinkLayerType() const;
+
+	private:
+
+		struct LayerInfo
+		{
+			ProtocolType protocol;
+			size_t offset;
+		};
+
+		uint8_t* m_Buffer;
+		size_t m_BufferLen;
+		bool m_OwnsBuffer;
+		size_t m_DataLen;
+		LayerInfo m_Layers[MaxNumOfLayers];
+		size_t m_NumOfLayers;
+
+		// private copy c'tor
+		PacketBuilder(const PacketBuilder& other);
+		PacketBuilder& operator=(const PacketBuilder& other);
+
+		uint8_t* addLayer(ProtocolType protocol, size_t headerLen);
+		uint16_t computeL4Checksum(size_t layerIndex, uint8_t ipProtocol) const;
+	};
+
+} // namespace pcpp
+
+#endif // PACKETPP_PACKET_BUILDER
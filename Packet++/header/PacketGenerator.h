@@ -0,0 +1,294 @@
+#ifndef PACKETPP_PACKET_GENERATOR
+#define PACKETPP_PACKET_GENERATOR
+
+#include "Packet.h"
+#include "PointerVector.h"
+#include <vector>
+
+/**
+ * @file
+ * This file includes a template-based packet generator that is meant for creating high volumes of test traffic.<BR>
+ * Building packets layer by layer (pcpp#EthLayer, pcpp#IPv4Layer, pcpp#UdpLayer, ...) and calling Packet#computeCalculateFields() is
+ * convenient for a single packet but it is way too slow for generating millions of packets per second. pcpp#PacketGenerator takes a
+ * packet that was built once and compiles it into a flat byte template plus a list of field mutators. Generating a packet is then a
+ * matter of copying the template, writing the mutated fields and patching the length fields and checksums.<BR>
+ *
+ * The logic works as follows:
+ * - The template packet is parsed once: the offsets of the outermost IPv4/IPv6 layer and of the TCP/UDP/ICMP layer right after it
+ *   (if exists) are recorded. Everything else (link-layer headers, tunnels, payload) is treated as opaque bytes
+ * - Field mutators change a 1, 2 or 4-byte big-endian field in each generated packet, either by incrementing it or by drawing a random
+ *   value in a range. There are shortcuts for common fields (IP addresses, IP ID, ports, TCP sequence and ack numbers) but any field in
+ *   the packet can be mutated by its offset
+ * - Packet sizes can be fixed (the template size), drawn uniformly from a range or drawn from a weighted list of sizes (such as IMIX).
+ *   The payload can be filled with a repeating pattern
+ * - Checksums are never computed over the whole packet: the one's complement sum of the IPv4 header and the prefix sums of the L4
+ *   segment are computed once when the generator is compiled. For each packet only the sum of the bytes changed by the mutators and the
+ *   length fields are added (RFC 1624)
+ *
+ * Generated packets can be written into user buffers (see PacketGenerator#generatePacket()), which is useful for writing directly into
+ * device buffers, or as a burst of RawPacket objects (see PacketGenerator#generateBurst()). The burst is a vector of RawPackets that
+ * is recycled between calls so no memory is allocated in steady state, and it can be sent as-is with any device that accepts a
+ * RawPacketVector, for example:
+ * - PcapLiveDevice#sendPackets(const RawPacketVector&)
+ * - RawSocketDevice#sendPackets(const RawPacketVector&)
+ * - DpdkDevice#sendPackets(RawPacketVector&, uint16_t, bool)
+ * - PcapFileWriterDevice#writePackets(const RawPacketVector&) or PcapNgFileWriterDevice#writePackets(const RawPacketVector&) for
+ *   repeatable load tests (use PacketGenerator#setSeed() to get the same traffic on every run)
+ */
+
+/**
+ * @namespace pcpp
+ * @brief The main namespace for the PcapPlusPlus lib
+ */
+namespace pcpp
+{
+
+	/**
+	 * @class PacketGenerator
+	 * A template-based packet generator. Please refer to the documentation at the top of PacketGenerator.h to understand how it works.
+	 * A typical usage looks like this:
+	 * @code
+	 * pcpp::PacketGenerator generator;
+	 * generator.setTemplate(&udpPacket);
+	 * generator.addFieldMutator(pcpp::PacketGenerator::IPv4SrcIPField, pcpp::PacketGenerator::IncrementMutator, 0x0a000001, 0x0a0000ff);
+	 * generator.addFieldMutator(pcpp::PacketGenerator::SrcPortField, pcpp::PacketGenerator::RandomMutator, 1024, 65535);
+	 * generator.setPacketSizeRange(64, 1500);
+	 * while (running)
+	 *     dev->sendPackets(generator.generateBurst(64));
+	 * @endcode
+	 */
+	class PacketGenerator
+	{
+	public:
+
+		/**
+		 * @enum MutatorType
+		 * The way a mutated field changes from one generated packet to the next
+		 */
+		enum MutatorType
+		{
+			/** The field starts at the minimum value and is incremented by a fixed step, wrapping back to the minimum after the maximum */
+			IncrementMutator,
+			/** The field gets a random value between the minimum and maximum values (inclusive) */
+			RandomMutator
+		};
+
+		/**
+		 * @enum TemplateField
+		 * Commonly mutated fields whose offset is resolved from the template packet
+		 */
+		enum TemplateField
+		{
+			/** IPv4 source address (4 bytes) */
+			IPv4SrcIPField,
+			/** IPv4 destination address (4 bytes) */
+			IPv4DstIPField,
+			/** IPv4 identification (2 bytes) */
+			IPv4IdField,
+			/** The 4 least significant bytes of the IPv6 source address */
+			IPv6SrcIPField,
+			/** The 4 least significant bytes of the IPv6 destination address */
+			IPv6DstIPField,
+			/** TCP/UDP source port (2 bytes) */
+			SrcPortField,
+			/** TCP/UDP destination port (2 bytes) */
+			DstPortField,
+			/** TCP sequence number (4 bytes) */
+			TcpSeqNumberField,
+			/** TCP acknowledgment number (4 bytes) */
+			TcpAckNumberField
+		};
+
+		/**
+		 * A c'tor for this class. A template must be set using setTemplate() before packets can be generated
+		 */
+		PacketGenerator();
+
+		/**
+		 * A d'tor for this class. Frees the template, all internal buffers and the RawPackets of the last burst
+		 */
+		~PacketGenerator();
+
+		/**
+		 * Set the packet all generated packets are based on. The packet is copied, so it can be freed or modified after this call. Its
+		 * length fields and checksums don't need to be computed as they're written for each generated packet. Setting a template clears
+		 * all previously added field mutators but keeps the packet size and payload pattern settings
+		 * @param[in] templatePacket The template packet
+		 * @return True if the template was set successfully or false if the packet is empty
+		 */
+		bool setTemplate(Packet* templatePacket);
+
+		/**
+		 * Add a mutator to one of the common fields of the template
+		 * @param[in] field The field to mutate
+		 * @param[in] type The mutator type
+		 * @param[in] minValue The minimum value of the field (in host byte order)
+		 * @param[in] maxValue The maximum value of the field (in host byte order)
+		 * @param[in] step The increment step. Relevant only for IncrementMutator. Default value is 1
+		 * @return True if the mutator was added or false if the template doesn't contain this field or if the values are out of range
+		 */
+		bool addFieldMutator(TemplateField field, MutatorType type, uint32_t minValue, uint32_t maxValue, uint32_t step = 1);
+
+		/**
+		 * Add a mutator to an arbitrary big-endian field in the template
+		 * @param[in] offset The offset of the field from the beginning of the packet
+		 * @param[in] width The field size in bytes. Can be 1, 2 or 4
+		 * @param[in] type The mutator type
+		 * @param[in] minValue The minimum value of the field (in host byte order)
+		 * @param[in] maxValue The maximum value of the field (in host byte order)
+		 * @param[in] step The increment step. Relevant only for IncrementMutator. Default value is 1
+		 * @return True if the mutator was added or false if the parameters are invalid. Please note that the field is validated against
+		 * the packet sizes and the length and checksum fields only when the generator is compiled
+		 */
+		bool addFieldMutator(size_t offset, size_t width, MutatorType type, uint32_t minValue, uint32_t maxValue, uint32_t step = 1);
+
+		/**
+		 * Remove all field mutators
+		 */
+		void clearFieldMutators();
+
+		/**
+		 * Fill the payload of all generated packets (everything after the L4 header, or after the IP header if there is no L4 layer) with
+		 * a repeating pattern instead of the template payload
+		 * @param[in] pattern The pattern to repeat. The data is copied
+		 * @param[in] patternLen The pattern length in bytes. Setting 0 restores the template payload
+		 * @return True if the pattern was set, false if the pattern is NULL while patternLen is not 0
+		 */
+		bool setPayloadPattern(const uint8_t* pattern, size_t patternLen);
+
+		/**
+		 * Draw the size of each generated packet uniformly from a range. Setting the same value for both sizes generates packets of a
+		 * fixed size. This setting replaces any size list added using addPacketSize()
+		 * @param[in] minSize The minimum packet size in bytes (including link-layer headers)
+		 * @param[in] maxSize The maximum packet size in bytes (including link-layer headers)
+		 * @return True if the range was set or false if minSize is larger than maxSize or if the range is 0
+		 */
+		bool setPacketSizeRange(size_t minSize, size_t maxSize);
+
+		/**
+		 * Add a size to a weighted list of packet sizes. The size of each generated packet is drawn from this list with probability that
+		 * is proportional to the weight, for example: 64 bytes with weight 7, 576 bytes with weight 4 and 1500 bytes with weight 1 for
+		 * simple IMIX. Calling this method replaces a size range set using setPacketSizeRange()
+		 * @param[in] size The packet size in bytes (including link-layer headers)
+		 * @param[in] weight The weight of this size. Default value is 1
+		 * @return True if the size was added or false if size or weight is 0
+		 */
+		bool addPacketSize(size_t size, uint32_t weight = 1);
+
+		/**
+		 * Go back to generating packets in the size of the template
+		 */
+		void clearPacketSizes();
+
+		/**
+		 * Set the seed of the random number generator used by RandomMutator and by random packet sizes. The same seed and settings
+		 * always generate the same traffic
+		 * @param[in] seed The seed to set
+		 */
+		void setSeed(uint32_t seed);
+
+		/**
+		 * Compile the template, the mutators, the packet sizes and the payload pattern into the internal representation used for
+		 * generating packets. There is no need to call this method explicitly as it's called by generatePacket() and generateBurst()
+		 * whenever the settings change, but it is useful for validating the settings ahead of time
+		 * @return True if compilation succeeded or false otherwise (the reason is logged)
+		 */
+		bool compile();
+
+		/**
+		 * @return The size in bytes of the largest packet this generator may create. A buffer of this size is large enough for any
+		 * generated packet
+		 */
+		size_t getMaxPacketLen() const;
+
+		/**
+		 * @return The number of packets generated so far
+		 */
+		uint64_t getNumOfGeneratedPackets() const { return m_NumOfGeneratedPackets; }
+
+		/**
+		 * Generate a single packet into a user-provided buffer
+		 * @param[in] buffer The buffer to write the packet to
+		 * @param[in] bufferLen The buffer size in bytes
+		 * @return The length of the generated packet or -1 if the generator can't be compiled or if the buffer is too small for the
+		 * chosen packet size
+		 */
+		int generatePacket(uint8_t* buffer, size_t bufferLen);
+
+		/**
+		 * Generate a burst of packets. The RawPackets and their data are owned by the generator and are reused by the next call to this
+		 * method, so they shouldn't be kept (copy them if needed). All packets in a burst get the current time as their timestamp
+		 * @param[in] count The number of packets to generate
+		 * @return A vector of the generated packets that can be sent or written to a file as-is. The vector is empty if the generator
+		 * can't be compiled
+		 */
+		PointerVector<RawPacket>& generateBurst(size_t count);
+
+	private:
+
+		struct FieldMutator
+		{
+			size_t offset;
+			size_t width;
+			MutatorType type;
+			uint32_t minValue;
+			uint32_t maxValue;
+			uint32_t step;
+			uint32_t nextValue;
+
+			// filled when compiling: which checksums cover this field and the complement of the sum of its template bytes
+			bool coveredByIPChecksum;
+			bool ipOddAligned;
+			uint16_t ipTemplateSumComplement;
+			bool coveredByL4Checksum;
+			bool l4OddAligned;
+			uint16_t l4TemplateSumComplement;
+		};
+
+		// the template and its layer offsets
+		std::vector<uint8_t> m_Template;
+		LinkLayerType m_LinkLayerType;
+		ProtocolType m_IPProtocol;
+		size_t m_IPOffset;
+		size_t m_IPHeaderLen;
+		ProtocolType m_L4Protocol;
+		size_t m_L4Offset;
+		size_t m_L4HeaderLen;
+		size_t m_PayloadOffset;
+
+		// settings
+		std::vector<FieldMutator> m_Mutators;
+		std::vector<uint8_t> m_PayloadPattern;
+		size_t m_MinSize;
+		size_t m_MaxSize;
+		std::vector<size_t> m_Sizes;
+		std::vector<uint32_t> m_CumulativeWeights;
+		uint32_t m_RandomState;
+
+		// compiled state
+		bool m_Compiled;
+		std::vector<uint8_t> m_Image;
+		uint32_t m_IPHeaderSum;
+		uint32_t m_PseudoHeaderSum;
+		std::vector<uint32_t> m_L4PrefixSums;
+		uint64_t m_NumOfGeneratedPackets;
+
+		// burst storage
+		uint8_t* m_BurstBuffer;
+		size_t m_BurstBufferLen;
+		PointerVector<RawPacket> m_Burst;
+
+		// private copy c'tor
+		PacketGenerator(const PacketGenerator& other);
+		PacketGenerator& operator=(const PacketGenerator& other);
+
+		uint32_t nextRandom();
+		size_t nextPacketSize();
+		uint32_t nextFieldValue(FieldMutator& mutator);
+		bool isOverlappingCalculatedField(size_t offset, size_t width) const;
+		size_t writePacket(uint8_t* buffer, size_t packetLen);
+	};
+
+} // namespace pcpp
+
+#endif // PACKETPP_PACKET_GENERATOR
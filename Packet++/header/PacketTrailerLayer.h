@@ -30,6 +30,10 @@ namespace pcpp
 	class PacketTrailerLayer : public Layer
 	{
 	public:
+		/** %PacketTrailerLayer instances carry ::PacketTrailer, see Layer#LayerProtocol */
+		static const ProtocolType LayerProtocol = PacketTrailer;
+		typedef PacketTrailerLayer LayerProtocolClass;
+
 		 /** A constructor that creates the layer from an existing packet raw data
 		 * @param[in] data A pointer to the raw data
 		 * @param[in] dataLen Size of the data in bytes
@@ -77,6 +81,9 @@ namespace pcpp
 		std::string toString() const;
 
 		OsiModelLayer getOsiModelLayer() const { return OsiModelDataLinkLayer; }
+
+	private:
+		Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new PacketTrailerLayer(data, m_DataLen, prevLayer, packet); }
 	};
 
 }
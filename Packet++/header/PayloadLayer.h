@@ -19,6 +19,10 @@ namespace pcpp
 	class PayloadLayer : public Layer
 	{
 	public:
+		/** %PayloadLayer instances carry ::GenericPayload, see Layer#LayerProtocol */
+		static const ProtocolType LayerProtocol = GenericPayload;
+		typedef PayloadLayer LayerProtocolClass;
+
 		 /** A constructor that creates the layer from an existing packet raw data
 		 * @param[in] data A pointer to the raw data
 		 * @param[in] dataLen Size of the data in bytes
@@ -87,6 +91,8 @@ namespace pcpp
 
 		OsiModelLayer getOsiModelLayer() const { return OsiModelApplicationLayer; }
 
+	private:
+		Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new PayloadLayer(data, m_DataLen, prevLayer, packet); }
 	};
 
 } // namespace pcpp
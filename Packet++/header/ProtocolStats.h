@@ -0,0 +1,254 @@
+#ifndef PACKETPP_PROTOCOL_STATS
+#define PACKETPP_PROTOCOL_STATS
+
+#include "Packet.h"
+#include <string>
+#include <vector>
+
+/**
+ * @file
+ * This file includes a traffic statistics engine that counts packets and bytes per protocol, per protocol path (like Wireshark's
+ * "tshark -z io,phs" protocol hierarchy) and per time bucket (like "tshark -z io,stat").<BR>
+ *
+ * The engine is meant to run on every packet of a production capture, so it does no parsing and no allocation per packet:
+ * - The protocol hierarchy is a tree of nodes preallocated in a fixed array. A packet walks down the tree along its layers, for example
+ *   eth -> ipv4 -> tcp -> http, and is counted only at the node its path ends at. Siblings are linked so finding the child of a node is a
+ *   scan of the few protocols seen under it. When the preallocated nodes run out new paths are counted at their deepest existing node
+ * - The counters of a node in the hierarchy (all packets whose path goes through it) and the counters of a protocol (all packets that
+ *   include it) are sums of path-end counters, so they're computed when they're read instead of being updated for every packet
+ * - Time buckets are a ring of fixed-size buckets. A bucket counts all the packets whose timestamp falls in it, both in total and per
+ *   protocol in an array indexed by the protocol's bit in pcpp#ProtocolType. Buckets are aligned to multiples of the bucket duration
+ *   since the epoch, so buckets of different instances line up
+ *
+ * An instance isn't thread-safe. When capturing with multiple threads use an instance per thread and merge them into one with
+ * pcpp#ProtocolStats#merge() when the stats are needed
+ */
+
+/**
+ * @namespace pcpp
+ * @brief The main namespace for the PcapPlusPlus lib
+ */
+namespace pcpp
+{
+
+	/**
+	 * The number of protocol bits that can be counted separately. Layers of protocol pcpp#UnknownProtocol are counted under this index
+	 */
+	#define PCPP_PROTOCOL_STATS_NUM_OF_PROTOCOLS 65
+	/**
+	 * @class ProtocolStats
+	 * Counts packets and bytes per protocol, per protocol path and per time bucket. Please refer to the documentation at the top of
+	 * ProtocolStats.h to understand how it works
+	 */
+	class ProtocolStats
+	{
+	public:
+
+		/**
+		 * @struct Config
+		 * The configuration of the stats engine
+		 */
+		struct Config
+		{
+			/** The duration of each time bucket in milliseconds. 0 disables the time buckets. The default is 1000 (1 second) */
+			uint32_t bucketDuration;
+			/** The number of the most recent time buckets to keep. The default is 60 */
+			uint32_t numOfBuckets;
+			/** The maximum number of nodes in the protocol hierarchy tree. The default is 1024 */
+			uint32_t maxHierarchyNodes;
+
+			/**
+			 * A c'tor that sets the default values
+			 */
+			Config() : bucketDuration(1000), numOfBuckets(60), maxHierarchyNodes(1024) {}
+		};
+
+		/**
+		 * @struct Counters
+		 * A packet counter and a byte counter
+		 */
+		struct Counters
+		{
+			/** Number of packets */
+			uint64_t packets;
+			/** Number of bytes. The whole frame length is counted for every packet */
+			uint64_t bytes;
+		};
+
+		/**
+		 * @struct HierarchyNode
+		 * A node of the protocol hierarchy as returned by getHierarchy()
+		 */
+		struct HierarchyNode
+		{
+			/** The protocol of the node */
+			ProtocolType protocol;
+			/** The depth of the node in the tree: 0 for protocols of the first layer, 1 for their children, etc. */
+			uint32_t depth;
+			/** The packets whose protocol path goes through this node */
+			Counters counters;
+		};
+
+		/**
+		 * @struct TimeBucket
+		 * The stats of a single time bucket
+		 */
+		struct TimeBucket
+		{
+			/** The start time of the bucket. The bucket counts the packets from this time up to (not including) the start of the next bucket */
+			timespec startTime;
+			/** All packets in the bucket */
+			Counters total;
+			/**
+			 * Packets in the bucket per protocol, indexed by the protocol bit (see ProtocolStats#getProtocolIndex()). A packet is counted
+			 * once per protocol even if the protocol appears in more than one layer
+			 */
+			Counters perProtocol[PCPP_PROTOCOL_STATS_NUM_OF_PROTOCOLS];
+		};
+
+		/**
+		 * A c'tor for this class. Preallocates the hierarchy nodes and the time buckets
+		 * @param[in] config The configuration of the engine
+		 */
+		ProtocolStats(const Config& config = Config());
+
+		/**
+		 * A d'tor for this class
+		 */
+		~ProtocolStats();
+
+		/**
+		 * A copy c'tor for this class
+		 * @param[in] other The instance to copy from
+		 */
+		ProtocolStats(const ProtocolStats& other);
+
+		/**
+		 * Assignment operator for this class
+		 * @param[in] other The instance to copy from
+		 * @return A reference to this instance
+		 */
+		ProtocolStats& operator=(const ProtocolStats& other);
+
+		/**
+		 * Count a packet. The packet's layers (as parsed by Packet) are its protocol path, and its raw packet timestamp determines its
+		 * time bucket. A packet older than the oldest kept bucket is counted everywhere except in the time buckets
+		 * @param[in] packet The packet to count
+		 */
+		void addPacket(const Packet& packet);
+
+		/**
+		 * Add the stats of another instance to this instance. Both instances must have the same bucket duration. The merged hierarchy is
+		 * limited by the max number of hierarchy nodes of this instance, and only the buckets that fall in the bucket window of this
+		 * instance (after it's moved forward to the newest bucket of the other instance) are merged
+		 * @param[in] other The instance to merge into this one
+		 * @return True if merged successfully, false if the bucket durations are different (an error will be printed to log)
+		 */
+		bool merge(const ProtocolStats& other);
+
+		/**
+		 * Zero all stats
+		 */
+		void clear();
+
+		/**
+		 * @return The configuration of the engine
+		 */
+		const Config& getConfig() const { return m_Config; }
+
+		/**
+		 * @return The total number of packets and bytes counted
+		 */
+		const Counters& getTotal() const { return m_Total; }
+
+		/**
+		 * Get the number of packets that include a protocol and their bytes. The counters are summed from the hierarchy so the cost is
+		 * proportional to the number of hierarchy nodes
+		 * @param[in] protocol The protocol. If it's an aggregation of protocols (such as pcpp#IP) the counters of the first protocol bit
+		 * are returned
+		 * @return The counters of the protocol. A packet is counted once even if the protocol appears in more than one layer
+		 */
+		Counters getProtocolCounters(ProtocolType protocol) const;
+
+		/**
+		 * Get the protocol hierarchy in depth-first order, where the children of every node are in the order they were first seen
+		 * @param[out] hierarchy A vector the nodes are appended to
+		 */
+		void getHierarchy(std::vector<HierarchyNode>& hierarchy) const;
+
+		/**
+		 * @return The number of packets whose protocol path was cut short because the hierarchy nodes ran out
+		 */
+		uint64_t getNumOfTruncatedPaths() const { return m_TruncatedPaths; }
+
+		/**
+		 * @return The number of time buckets currently kept. It's never more than the configured number of buckets
+		 */
+		size_t getNumOfBuckets() const;
+
+		/**
+		 * Get a time bucket
+		 * @param[in] index The index of the bucket, where 0 is the oldest kept bucket and getNumOfBuckets()-1 is the newest
+		 * @return The bucket or NULL if the index is out of range
+		 */
+		const TimeBucket* getBucket(size_t index) const;
+
+		/**
+		 * @return The number of packets that weren't counted in the time buckets because they were older than the oldest kept bucket
+		 */
+		uint64_t getNumOfLatePackets() const { return m_LatePackets; }
+
+		/**
+		 * Print the protocol hierarchy in a format similar to "tshark -z io,phs"
+		 * @return A string with a line per hierarchy node
+		 */
+		std::string hierarchyToString() const;
+
+		/**
+		 * Convert a protocol to an index in the per-protocol arrays
+		 * @param[in] protocol The protocol. If it's an aggregation of protocols the index of the lowest protocol bit is returned
+		 * @return The index of the protocol bit, or PCPP_PROTOCOL_STATS_NUM_OF_PROTOCOLS-1 for pcpp#UnknownProtocol
+		 */
+		static size_t getProtocolIndex(ProtocolType protocol);
+
+		/**
+		 * @param[in] protocol A protocol
+		 * @return A short name of the protocol, for example "eth", "ipv4" or "http.request"
+		 */
+		static std::string getProtocolName(ProtocolType protocol);
+
+	private:
+		struct Node
+		{
+			Counters counters;
+			ProtocolType protocol;
+			uint32_t parent;
+			uint32_t firstChild;
+			uint32_t lastChild;
+			uint32_t nextSibling;
+			uint32_t depth;
+		};
+
+		Config m_Config;
+		Counters m_Total;
+		Counters m_TruncatedProtocolCounters[PCPP_PROTOCOL_STATS_NUM_OF_PROTOCOLS];
+		Node* m_Nodes;
+		uint32_t m_NumOfNodes;
+		uint64_t m_TruncatedPaths;
+		TimeBucket* m_Buckets;
+		uint64_t m_OldestBucket;
+		uint64_t m_NewestBucket;
+		uint64_t m_NewestBucketStart;
+		uint64_t m_BucketDurationNsec;
+		bool m_HasBuckets;
+		uint64_t m_LatePackets;
+
+		uint32_t getChild(uint32_t parent, ProtocolType protocol);
+		TimeBucket* getBucketByNumber(uint64_t bucketNumber);
+		void copyFrom(const ProtocolStats& other);
+		void sumSubtrees(std::vector<Counters>& subtreeCounters) const;
+	};
+
+} // namespace pcpp
+
+#endif /* PACKETPP_PROTOCOL_STATS */
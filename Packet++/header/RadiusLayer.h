@@ -170,6 +170,9 @@ namespace pcpp
 		RadiusAttribute addAttrAt(const RadiusAttributeBuilder& attrBuilder, int offset);
 
 	public:
+		/** %RadiusLayer instances carry ::Radius, see Layer#LayerProtocol */
+		static const ProtocolType LayerProtocol = Radius;
+		typedef RadiusLayer LayerProtocolClass;
 
 		/**
 		 * A constructor that creates the layer from an existing packet raw data
@@ -180,7 +183,7 @@ namespace pcpp
 		 */
 		RadiusLayer(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet) :
 			Layer(data, dataLen, prevLayer, packet)
-			{ m_Protocol = Radius; }
+			{ m_Protocol = Radius; m_AttributeReader.enableRecordIndex(true); }
 
 		/**
 		 * A constructor that creates a new layer from scratch
@@ -257,6 +260,19 @@ namespace pcpp
 		 */
 		RadiusAttribute getAttribute(uint8_t attrType) const;
 
+		/**
+		 * Get several RADIUS attributes by attribute type at once. RADIUS layers keep an index of their attribute types, so
+		 * every attribute is retrieved in O(1) once the index is built (which happens in one pass over the attributes on the
+		 * first lookup)
+		 * @param[in] attrTypes An array of the RADIUS attribute types to retrieve
+		 * @param[in] numOfAttrTypes The number of attribute types in the array
+		 * @param[out] result A vector that will be filled with one RadiusAttribute object per attribute type, in the same order
+		 * as attrTypes. Each object contains the first attribute data that matches the type, or logical NULL
+		 * (RadiusAttribute#isNull() == true) if no such attribute found
+		 * @return The number of attribute types that were found
+		 */
+		size_t getAttributes(const uint8_t* attrTypes, size_t numOfAttrTypes, std::vector<RadiusAttribute>& result) const;
+
 		/**
 		 * @return The number of RADIUS attributes in the packet
 		 */
@@ -326,6 +342,9 @@ namespace pcpp
 		std::string toString() const;
 
 		OsiModelLayer getOsiModelLayer() const { return OsiModelSesionLayer; }
+
+	private:
+		Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new RadiusLayer(data, m_DataLen, prevLayer, packet); }
 	};
 
 
@@ -243,11 +243,66 @@ namespace pcpp
 	 */
 #define PCPP_MAX_PACKET_SIZE 65536
 
+	/**
+	 * @class RawPacketBufferPool
+	 * A pool of fixed-size buffers for reference-counted raw data (see RawPacket#makeRawDataRefCounted()). When the last RawPacket
+	 * that references a buffer releases it, the buffer goes back to the pool instead of being freed, so sharing packets between several
+	 * consumers doesn't allocate memory per packet once the pool is warm. Buffers can be allocated and released from any thread.<BR>
+	 * The pool must outlive all RawPacket instances that use its buffers
+	 */
+	class RawPacketBufferPool
+	{
+		friend class RawPacket;
+	public:
+		/**
+		 * A c'tor for this class. Buffers are allocated on demand, the pool doesn't pre-allocate memory
+		 * @param[in] bufferSize The size in bytes of raw data a buffer can hold. Longer raw data gets a buffer that isn't taken from the pool
+		 * @param[in] maxFreeBuffers The maximum number of released buffers the pool keeps for reuse. Buffers released when the pool
+		 * is full are freed
+		 */
+		RawPacketBufferPool(size_t bufferSize, size_t maxFreeBuffers);
+
+		/**
+		 * A d'tor for this class. Frees all buffers kept in the pool
+		 */
+		~RawPacketBufferPool();
+
+		/**
+		 * @return The size in bytes of raw data a buffer can hold
+		 */
+		size_t getBufferSize() const { return m_BufferSize; }
+
+		/**
+		 * @return The number of released buffers currently kept for reuse
+		 */
+		size_t getNumOfFreeBuffers() const { return m_NumOfFreeBuffers; }
+
+	private:
+		size_t m_BufferSize;
+		size_t m_MaxFreeBuffers;
+		size_t m_NumOfFreeBuffers;
+		void* m_FreeList;
+		volatile long m_Lock;
+
+		// private copy c'tor
+		RawPacketBufferPool(const RawPacketBufferPool& other);
+		RawPacketBufferPool& operator=(const RawPacketBufferPool& other);
+
+		uint8_t* allocateBuffer();
+		void releaseBuffer(uint8_t* buffer);
+		void lock();
+		void unlock();
+	};
+
 	/**
 	 * @class RawPacket
 	 * This class holds the packet as raw (not parsed) data. The data is held as byte array. In addition to the data itself
 	 * every instance also holds a timestamp representing the time the packet was received by the NIC.
-	 * RawPacket instance isn't read only. The user can change the packet data, add or remove data, etc.
+	 * RawPacket instance isn't read only. The user can change the packet data, add or remove data, etc.<BR>
+	 * The raw data can also be reference-counted (see makeRawDataRefCounted()): several RawPacket instances, possibly used by different
+	 * threads, then point to the same data which is freed (or returned to a RawPacketBufferPool) when the last of them is freed. Methods
+	 * of this class that change the data copy it first if it's shared with other instances. Changes made directly to the data (for
+	 * example through the layers of a Packet) aren't tracked, so consumers that share data should treat it as read-only
 	 */
 	class RawPacket
 	{
@@ -256,11 +311,16 @@ namespace pcpp
 		int m_RawDataLen;
 		int m_FrameLength;
 		timespec m_TimeStamp;
+		// applies only to raw data that isn't reference-counted, which is freed by its last reference
 		bool m_DeleteRawDataAtDestructor;
 		bool m_RawPacketSet;
+		bool m_RefCountedRawData;
 		LinkLayerType m_LinkLayerType;
 		void init(bool deleteRawDataAtDestructor = true);
 		void copyDataFrom(const RawPacket& other, bool allocateData = true);
+		static uint8_t* allocateRefCountedData(RawPacketBufferPool* pool, size_t dataLen);
+		void releaseRefCountedData();
+		void unshareRefCountedData();
 	public:
 		/**
 		 * A constructor that receives a pointer to the raw data (allocated elsewhere). This constructor is usually used when packet
@@ -309,6 +369,17 @@ namespace pcpp
 		 */
 		RawPacket(const RawPacket& other);
 
+		/**
+		 * A copy constructor that can share the raw data of the other instance instead of copying it. Sharing is possible only if the
+		 * raw data of the other instance is reference-counted (see makeRawDataRefCounted()), then no data is copied and the reference
+		 * count is incremented. This is how a single packet is handed to several consumers, each with its own RawPacket instance. The
+		 * instances can be freed in any order and from any thread
+		 * @param[in] other The instance to copy from
+		 * @param[in] shareRawData If set to true and the raw data of the other instance is reference-counted, the data is shared.
+		 * Otherwise it's copied like in the copy constructor
+		 */
+		RawPacket(const RawPacket& other, bool shareRawData);
+
 		/**
 		 * Assignment operator overload for this class. When using this operator on an already initialized RawPacket instance,
 		 * the original raw data is freed first. Then the other instance is copied to this instance, the same way the copy constructor works
@@ -404,6 +475,27 @@ namespace pcpp
 		 */
 		bool isPacketSet() const { return m_RawPacketSet; }
 
+		/**
+		 * Move the raw data to a reference-counted buffer so it can be shared with other instances using
+		 * RawPacket(const RawPacket&, bool). The data is copied once, and the previous data is freed if deleteRawDataAtDestructor was
+		 * set to 'true'. This is usually done right after a packet is captured, when the raw data still points to the capture engine's
+		 * buffer. Only instances of this class (and not derived classes like MBufRawPacket) can hold reference-counted data
+		 * @param[in] pool An optional pool to take the buffer from. If not set or if the data is longer than the pool buffer size, the
+		 * buffer is allocated on the heap
+		 * @return True if the raw data is reference-counted or false if raw data isn't set or this instance can't hold reference-counted data
+		 */
+		bool makeRawDataRefCounted(RawPacketBufferPool* pool = NULL);
+
+		/**
+		 * @return True if the raw data is reference-counted, false otherwise
+		 */
+		bool isRawDataRefCounted() const { return m_RefCountedRawData; }
+
+		/**
+		 * @return The number of RawPacket instances that share the raw data or 0 if the raw data isn't reference-counted
+		 */
+		uint32_t getRawDataRefCount() const;
+
 		/**
 		 * Clears all members of this instance, meaning setting raw data to NULL, raw data length to 0, etc. Currently raw data is always freed,
 		 * even if deleteRawDataAtDestructor was set to 'false'
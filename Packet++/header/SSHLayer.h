@@ -72,6 +72,10 @@ namespace pcpp
 	class SSHLayer : public Layer
 	{
 	public:
+		/** %SSHLayer instances carry ::SSH, see Layer#LayerProtocol */
+		static const ProtocolType LayerProtocol = SSH;
+		typedef SSHLayer LayerProtocolClass;
+
 		/**
 		 * A static method that takes raw packet data and uses the heuristics described in the 
 		 * SSHLayer.h file description to create an SSH layer instance. This method assumes the data is
@@ -147,6 +151,15 @@ namespace pcpp
 		 */
 		static SSHIdentificationMessage* tryParse(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet);
 
+		/**
+		 * All SSH messages carry ::SSH, this method tells identification messages apart (see Layer#isInstance()) using the same
+		 * heuristics as tryParse()
+		 * @param[in] layer An SSH layer
+		 * @return True if the layer is an SSH identification message
+		 */
+		static bool isInstance(const Layer& layer) { return isIdentificationData(layer.getData(), layer.getDataLen()); }
+		typedef SSHIdentificationMessage LayerProtocolClass;
+
 		// implement abstract methods
 
 		/**
@@ -163,6 +176,9 @@ namespace pcpp
 		// private c'tor, this class cannot be instanciated
 		SSHIdentificationMessage(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet) : SSHLayer(data, dataLen, prevLayer, packet) {}
 
+		static bool isIdentificationData(const uint8_t* data, size_t dataLen);
+
+		Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new SSHIdentificationMessage(data, m_DataLen, prevLayer, packet); }
 	};
 
 
@@ -252,6 +268,15 @@ namespace pcpp
 		 */
 		static SSHHandshakeMessage* tryParse(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet);
 
+		/**
+		 * All SSH messages carry ::SSH, this method tells handshake messages apart (see Layer#isInstance()) using the same
+		 * heuristics as SSHLayer#createSSHMessage()
+		 * @param[in] layer An SSH layer
+		 * @return True if the layer is an SSH handshake message (including SSHKeyExchangeInitMessage)
+		 */
+		static bool isInstance(const Layer& layer);
+		typedef SSHHandshakeMessage LayerProtocolClass;
+
 		// implement abstract methods
 
 		/**
@@ -282,6 +307,10 @@ namespace pcpp
 		SSHHandshakeMessage(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet) : SSHLayer(data, dataLen, prevLayer, packet) {}
 
 		ssh_message_base* getMsgBaseHeader() const { return (ssh_message_base*)m_Data; }
+
+		static bool isHandshakeData(const uint8_t* data, size_t dataLen);
+
+		Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new SSHHandshakeMessage(data, m_DataLen, prevLayer, packet); }
 	};
 
 
@@ -304,6 +333,17 @@ namespace pcpp
 		 */
 		SSHKeyExchangeInitMessage(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet);
 
+		/**
+		 * Tells Key Exchange Init messages apart from other SSH messages (see Layer#isInstance())
+		 * @param[in] layer An SSH layer
+		 * @return True if the layer is an SSH Key Exchange Init message
+		 */
+		static bool isInstance(const Layer& layer)
+		{
+			return SSHHandshakeMessage::isInstance(layer) && ((const ssh_message_base*)layer.getData())->messageCode == SSH_MSG_KEX_INIT;
+		}
+		typedef SSHKeyExchangeInitMessage LayerProtocolClass;
+
 		/**
 		 * Each SSH Key Exchange Init message contains a random 16-byte value generated by the sender.
 		 * This method returns a pointer to this 16-byte cookie. To get the value as a hex string
@@ -394,6 +434,8 @@ namespace pcpp
 		void parseMessageAndInitOffsets();
 
 		std::string getFieldValue(int fieldOffsetIndex);
+
+		Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new SSHKeyExchangeInitMessage(data, m_DataLen, prevLayer, packet); }
 	};
 
 
@@ -414,6 +456,14 @@ namespace pcpp
 		 * when parsing SSH messagess in SSHLayer#createSSHMessage()
 		 */
 		SSHEncryptedMessage(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet) : SSHLayer(data, dataLen, prevLayer, packet) {}
+
+		/**
+		 * An SSH message is considered encrypted if it's neither an identification message nor a handshake message (see Layer#isInstance())
+		 * @param[in] layer An SSH layer
+		 * @return True if the layer is an SSH encrypted message
+		 */
+		static bool isInstance(const Layer& layer) { return !SSHIdentificationMessage::isInstance(layer) && !SSHHandshakeMessage::isInstance(layer); }
+		typedef SSHEncryptedMessage LayerProtocolClass;
 		
 		// implement abstract methods
 
@@ -423,6 +473,9 @@ namespace pcpp
 		size_t getHeaderLen() const { return m_DataLen; }
 
 		std::string toString() const;
+
+	private:
+		Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new SSHEncryptedMessage(data, m_DataLen, prevLayer, packet); }
 	};
 
 }
@@ -181,6 +181,14 @@ public:
 	 * @return The hostname written in the extension data
 	 */
 	std::string getHostName() const;
+
+	/**
+	 * Get the hostname without copying it
+	 * @param[out] length The length of the hostname in bytes
+	 * @return A pointer to the hostname inside the extension data. It isn't NULL-terminated. If the extension is too short to contain
+	 * the hostname it claims to have NULL is returned and length is set to 0
+	 */
+	const char* getHostNameData(uint16_t& length) const;
 };
 
 
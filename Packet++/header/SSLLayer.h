@@ -171,6 +171,9 @@ namespace pcpp
 	class SSLLayer : public Layer
 	{
 	public:
+		/** %SSLLayer instances carry ::SSL, see Layer#LayerProtocol */
+		static const ProtocolType LayerProtocol = SSL;
+		typedef SSLLayer LayerProtocolClass;
 
 		/**
 		 * A static method that checks whether the port is considered as SSL/TLS
@@ -307,6 +310,14 @@ namespace pcpp
 	{
 	public:
 
+		/**
+		 * All SSL/TLS record layers carry ::SSL, this method tells handshake records apart (see Layer#isInstance())
+		 * @param[in] layer An SSL/TLS record layer
+		 * @return True if the layer is a handshake record
+		 */
+		static bool isInstance(const Layer& layer) { return static_cast<const SSLLayer&>(layer).getRecordType() == SSL_HANDSHAKE; }
+		typedef SSLHandshakeLayer LayerProtocolClass;
+
 		/**
 		 * C'tor for this class that creates the layer from an existing packet raw data
 		 * @param[in] data A pointer to the raw data
@@ -360,6 +371,12 @@ namespace pcpp
 
 	private:
 		PointerVector<SSLHandshakeMessage> m_MessageList;
+
+		void parseMessages();
+
+		Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new SSLHandshakeLayer(data, m_DataLen, prevLayer, packet); }
+		// the messages and their extensions point into the layer data, so they're parsed again from the new buffer
+		void rebaseData(uint8_t* data);
 	}; // class SSLHandshakeLayer
 
 
@@ -372,6 +389,14 @@ namespace pcpp
 	{
 	public:
 
+		/**
+		 * All SSL/TLS record layers carry ::SSL, this method tells change-cipher-spec records apart (see Layer#isInstance())
+		 * @param[in] layer An SSL/TLS record layer
+		 * @return True if the layer is a change-cipher-spec record
+		 */
+		static bool isInstance(const Layer& layer) { return static_cast<const SSLLayer&>(layer).getRecordType() == SSL_CHANGE_CIPHER_SPEC; }
+		typedef SSLChangeCipherSpecLayer LayerProtocolClass;
+
 		/**
 		 * C'tor for this class that creates the layer from an existing packet raw data
 		 * @param[in] data A pointer to the raw data
@@ -392,6 +417,9 @@ namespace pcpp
 		 * There are no calculated fields for this layer
 		 */
 		void computeCalculateFields() {}
+
+	private:
+		Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new SSLChangeCipherSpecLayer(data, m_DataLen, prevLayer, packet); }
 	}; // class SSLChangeCipherSpecLayer
 
 
@@ -404,6 +432,14 @@ namespace pcpp
 	{
 	public:
 
+		/**
+		 * All SSL/TLS record layers carry ::SSL, this method tells alert records apart (see Layer#isInstance())
+		 * @param[in] layer An SSL/TLS record layer
+		 * @return True if the layer is a alert record
+		 */
+		static bool isInstance(const Layer& layer) { return static_cast<const SSLLayer&>(layer).getRecordType() == SSL_ALERT; }
+		typedef SSLAlertLayer LayerProtocolClass;
+
 		/**
 		 * C'tor for this class that creates the layer from an existing packet raw data
 		 * @param[in] data A pointer to the raw data
@@ -434,6 +470,9 @@ namespace pcpp
 		 * There are no calculated fields for this layer
 		 */
 		void computeCalculateFields() {}
+
+	private:
+		Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new SSLAlertLayer(data, m_DataLen, prevLayer, packet); }
 	}; // class SSLAlertLayer
 
 
@@ -446,6 +485,14 @@ namespace pcpp
 	{
 	public:
 
+		/**
+		 * All SSL/TLS record layers carry ::SSL, this method tells application data records apart (see Layer#isInstance())
+		 * @param[in] layer An SSL/TLS record layer
+		 * @return True if the layer is a application data record
+		 */
+		static bool isInstance(const Layer& layer) { return static_cast<const SSLLayer&>(layer).getRecordType() == SSL_APPLICATION_DATA; }
+		typedef SSLApplicationDataLayer LayerProtocolClass;
+
 		/**
 		 * C'tor for this class that creates the layer from an existing packet raw data
 		 * @param[in] data A pointer to the raw data
@@ -477,6 +524,9 @@ namespace pcpp
 		 * There are no calculated fields for this layer
 		 */
 		void computeCalculateFields() {}
+
+	private:
+		Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new SSLApplicationDataLayer(data, m_DataLen, prevLayer, packet); }
 	}; // class SSLApplicationDataLayer
 
 
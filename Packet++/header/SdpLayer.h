@@ -59,6 +59,9 @@ namespace pcpp
 	class SdpLayer : public TextBasedProtocolMessage
 	{
 	public:
+		/** %SdpLayer instances carry ::SDP, see Layer#LayerProtocol */
+		static const ProtocolType LayerProtocol = SDP;
+		typedef SdpLayer LayerProtocolClass;
 
 		 /** A constructor that creates the layer from an existing packet raw data
 		 * @param[in] data A pointer to the raw data
@@ -163,6 +166,7 @@ namespace pcpp
 		char getHeaderFieldNameValueSeparator() const { return '='; }
 		bool spacesAllowedBetweenHeaderFieldNameAndValue() const { return false; }
 
+		Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new SdpLayer(data, m_DataLen, prevLayer, packet); }
 	};
 }
 
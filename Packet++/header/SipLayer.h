@@ -74,6 +74,9 @@ namespace pcpp
 	class SipLayer : public TextBasedProtocolMessage
 	{
 	public:
+		/** %SipLayer instances carry ::SIP, see Layer#LayerProtocol */
+		static const ProtocolType LayerProtocol = SIP;
+		typedef SipLayer LayerProtocolClass;
 
 		/**
 		 * The length of the body of many SIP response messages is determined by a SIP header field called "Content-Length". This method
@@ -147,6 +150,10 @@ namespace pcpp
 		friend class SipRequestFirstLine;
 
 	public:
+		/** %SipRequestLayer instances carry ::SIPRequest, see Layer#LayerProtocol */
+		static const ProtocolType LayerProtocol = SIPRequest;
+		typedef SipRequestLayer LayerProtocolClass;
+
 		/**
 		 * SIP request methods
 		 */
@@ -228,6 +235,8 @@ namespace pcpp
 
 	private:
 		SipRequestFirstLine* m_FirstLine;
+
+		Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new SipRequestLayer(data, m_DataLen, prevLayer, packet); }
 	};
 
 
@@ -249,6 +258,9 @@ namespace pcpp
 	{
 		friend class SipResponseFirstLine;
 	public:
+		/** %SipResponseLayer instances carry ::SIPResponse, see Layer#LayerProtocol */
+		static const ProtocolType LayerProtocol = SIPResponse;
+		typedef SipResponseLayer LayerProtocolClass;
 
 		/**
 		 * Enum for SIP response status codes. List is taken from Wikipedia: https://en.wikipedia.org/wiki/List_of_SIP_response_codes
@@ -454,6 +466,8 @@ namespace pcpp
 
 	private:
 		SipResponseFirstLine* m_FirstLine;
+
+		Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new SipResponseLayer(data, m_DataLen, prevLayer, packet); }
 	};
 
 
@@ -45,6 +45,10 @@ namespace pcpp
 	class SllLayer : public Layer
 	{
 	public:
+		/** %SllLayer instances carry ::SLL, see Layer#LayerProtocol */
+		static const ProtocolType LayerProtocol = SLL;
+		typedef SllLayer LayerProtocolClass;
+
 		/**
 		 * A constructor that creates the layer from an existing packet raw data
 		 * @param[in] data A pointer to the raw data (will be casted to ether_header)
@@ -103,6 +107,9 @@ namespace pcpp
 		std::string toString() const;
 
 		OsiModelLayer getOsiModelLayer() const { return OsiModelDataLinkLayer; }
+
+	private:
+		Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new SllLayer(data, m_DataLen, packet); }
 	};
 
 } // namespace pcpp
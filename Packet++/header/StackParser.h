@@ -0,0 +1,571 @@
+#ifndef PACKETPP_STACK_PARSER
+#define PACKETPP_STACK_PARSER
+
+#include "RawPacket.h"
+#include "EthLayer.h"
+#include "VlanLayer.h"
+#include "IPv4Layer.h"
+#include "IPv6Layer.h"
+#include "TcpLayer.h"
+#include "UdpLayer.h"
+#include "GtpLayer.h"
+#include "DnsLayer.h"
+#include "SipLayer.h"
+#include "RadiusLayer.h"
+#include "VxlanLayer.h"
+#include "EndianPortable.h"
+
+/**
+ * @file
+ * This file includes StackParser, a parser for packets whose protocol stack is known in advance, and the traits it uses.<BR>
+ * Most traffic on a given link follows a handful of protocol stacks, for example Eth/IPv4/TCP or Eth/IPv4/UDP/GTP/IPv4/TCP. The
+ * generic Packet class discovers the stack of every packet at runtime: it allocates a Layer object for each protocol and calls its
+ * virtual parseNextLayer() method which tries the possible next protocols one by one. StackParser gets the expected stack as template
+ * parameters instead, for example:
+ *
+ * @code
+ * pcpp::StackParser<pcpp::EthLayer, pcpp::VlanLayer, pcpp::IPv4Layer, pcpp::TcpLayer> parser;
+ * if (parser.parse(&rawPacket))
+ * {
+ *     pcpp::tcphdr* tcpHeader = parser.getHeader<3>();
+ *     ...
+ * }
+ * else
+ * {
+ *     // not an Eth/VLAN/IPv4/TCP packet, fall back to the generic parsing
+ *     pcpp::Packet packet(&rawPacket);
+ *     ...
+ * }
+ * @endcode
+ *
+ * The checks between each pair of protocols and the header length calculations are inlined into parse(), so parsing doesn't allocate
+ * memory or call virtual methods. A packet is accepted only if the generic parsing would create exactly these layers (the same link
+ * type check, next protocol fields, validity checks and length trimming). In ambiguous cases, for example UDP packets whose ports
+ * belong to more than one protocol, parse() returns false so the packet can be parsed by the generic path.<BR>
+ * Stacks are validated at compile time: the first layer needs a StackLayerTraits::isFirstLayer() method and each pair of consecutive
+ * layers needs a StackLayerLink specialization, so a stack like StackParser<EthLayer, TcpLayer> doesn't compile.
+ * Currently supported layers are EthLayer, VlanLayer, IPv4Layer, IPv6Layer, TcpLayer, UdpLayer and GtpV1Layer. IPv4 fragments and
+ * IPv6 packets with extension headers are never accepted
+ */
+
+/**
+ * \namespace pcpp
+ * \brief The main namespace for the PcapPlusPlus lib
+ */
+namespace pcpp
+{
+
+	/**
+	 * @struct StackParserEnd
+	 * A placeholder for the unused layer template parameters of StackParser
+	 */
+	struct StackParserEnd {};
+
+	/**
+	 * @struct StackLayerTraits
+	 * Describes how StackParser decodes the header of a layer type. Each supported layer has a specialization with a HeaderType typedef
+	 * and a getHeaderLen() method that gets the layer data and its length, validates the header and returns its length (or 0 if it's
+	 * invalid). getHeaderLen() may shorten the data length, like IPv4 does according to its total length field. Layers that can start a
+	 * packet also have an isFirstLayer() method
+	 */
+	template<typename LayerType>
+	struct StackLayerTraits;
+
+	/**
+	 * @struct StackLayerLink
+	 * Describes how StackParser checks that a layer of type LayerType follows a layer of type PrevLayerType. Each supported pair has a
+	 * specialization with an isNextLayer() method that gets the data of the previous layer and the data that follows its header
+	 */
+	template<typename PrevLayerType, typename LayerType>
+	struct StackLayerLink;
+
+
+	template<>
+	struct StackLayerTraits<EthLayer>
+	{
+		typedef ether_header HeaderType;
+
+		static bool isFirstLayer(LinkLayerType linkType, const uint8_t* data, size_t dataLen)
+		{
+			if (linkType != LINKTYPE_ETHERNET || dataLen < sizeof(ether_header))
+				return false;
+
+			// values up to 0x5dc are an IEEE 802.3 length field, see Packet::createFirstLayer()
+			uint16_t ethTypeOrLength = be16toh(((const ether_header*)data)->etherType);
+			return ethTypeOrLength > (uint16_t)0x5dc || ethTypeOrLength == 0;
+		}
+
+		static size_t getHeaderLen(const uint8_t* /* data */, size_t& dataLen)
+		{
+			return (dataLen >= sizeof(ether_header) ? sizeof(ether_header) : 0);
+		}
+	};
+
+	template<>
+	struct StackLayerTraits<VlanLayer>
+	{
+		typedef vlan_header HeaderType;
+
+		static size_t getHeaderLen(const uint8_t* /* data */, size_t& dataLen)
+		{
+			return (dataLen >= sizeof(vlan_header) ? sizeof(vlan_header) : 0);
+		}
+	};
+
+	template<>
+	struct StackLayerTraits<IPv4Layer>
+	{
+		typedef iphdr HeaderType;
+
+		static bool isFirstLayer(LinkLayerType linkType, const uint8_t* data, size_t dataLen)
+		{
+			if (linkType == LINKTYPE_IPV4)
+				return true;
+
+			return (linkType == LINKTYPE_RAW || linkType == LINKTYPE_DLT_RAW1 || linkType == LINKTYPE_DLT_RAW2) && dataLen > 0 && (data[0] & 0xf0) == 0x40;
+		}
+
+		static size_t getHeaderLen(const uint8_t* data, size_t& dataLen)
+		{
+			if (!IPv4Layer::isDataValid(data, dataLen))
+				return 0;
+
+			const iphdr* hdr = (const iphdr*)data;
+			size_t totalLen = be16toh(hdr->totalLength);
+			// a total length of 0 usually means TCP Segmentation Offload (TSO), see IPv4Layer
+			if (totalLen < dataLen && totalLen != 0)
+				dataLen = totalLen;
+
+			size_t headerLen = hdr->internetHeaderLength * 4;
+			return (headerLen <= dataLen ? headerLen : 0);
+		}
+
+		static bool isFragment(const uint8_t* data)
+		{
+			// the more fragments flag or a non-zero fragment offset
+			return (be16toh(((const iphdr*)data)->fragmentOffset) & 0x3fff) != 0;
+		}
+	};
+
+	template<>
+	struct StackLayerTraits<IPv6Layer>
+	{
+		typedef ip6_hdr HeaderType;
+
+		static bool isFirstLayer(LinkLayerType linkType, const uint8_t* data, size_t dataLen)
+		{
+			if (linkType == LINKTYPE_IPV6)
+				return true;
+
+			return (linkType == LINKTYPE_RAW || linkType == LINKTYPE_DLT_RAW1 || linkType == LINKTYPE_DLT_RAW2) && dataLen > 0 && (data[0] & 0xf0) == 0x60;
+		}
+
+		static size_t getHeaderLen(const uint8_t* data, size_t& dataLen)
+		{
+			if (!IPv6Layer::isDataValid(data, dataLen))
+				return 0;
+
+			size_t totalLen = be16toh(((const ip6_hdr*)data)->payloadLength) + sizeof(ip6_hdr);
+			if (totalLen < dataLen)
+				dataLen = totalLen;
+
+			return sizeof(ip6_hdr);
+		}
+	};
+
+	template<>
+	struct StackLayerTraits<TcpLayer>
+	{
+		typedef tcphdr HeaderType;
+
+		static size_t getHeaderLen(const uint8_t* data, size_t& dataLen)
+		{
+			if (!TcpLayer::isDataValid(data, dataLen))
+				return 0;
+
+			return ((const tcphdr*)data)->dataOffset * 4;
+		}
+	};
+
+	template<>
+	struct StackLayerTraits<UdpLayer>
+	{
+		typedef udphdr HeaderType;
+
+		static size_t getHeaderLen(const uint8_t* /* data */, size_t& dataLen)
+		{
+			return (dataLen >= sizeof(udphdr) ? sizeof(udphdr) : 0);
+		}
+	};
+
+	template<>
+	struct StackLayerTraits<GtpV1Layer>
+	{
+		typedef gtpv1_header HeaderType;
+
+		static size_t getHeaderLen(const uint8_t* data, size_t& dataLen)
+		{
+			if (dataLen < sizeof(gtpv1_header))
+				return 0;
+
+			const gtpv1_header* hdr = (const gtpv1_header*)data;
+			size_t headerLen = sizeof(gtpv1_header);
+
+			if (hdr->messageType != GtpV1_GPDU)
+			{
+				// GTP-C messages are the last layer, the message is considered part of the header
+				size_t msgLen = be16toh(hdr->messageLength);
+				return headerLen + (msgLen > dataLen - headerLen ? dataLen - headerLen : msgLen);
+			}
+
+			if (!hdr->extensionHeaderFlag && !hdr->sequenceNumberFlag && !hdr->npduNumberFlag)
+				return headerLen;
+
+			// sequence number (2 bytes), N-PDU number (1 byte) and next extension header type (1 byte)
+			headerLen += 4;
+			if (dataLen < headerLen)
+				return 0;
+
+			uint8_t nextExtType = (hdr->extensionHeaderFlag ? data[headerLen - 1] : 0);
+			while (nextExtType != 0)
+			{
+				// the first byte of an extension is its length in 4-byte units and the last byte is the next extension type
+				if (headerLen >= dataLen)
+					return 0;
+
+				size_t extLen = data[headerLen] * 4;
+				if (extLen == 0 || headerLen + extLen > dataLen)
+					return 0;
+
+				headerLen += extLen;
+				nextExtType = data[headerLen - 1];
+			}
+
+			return headerLen;
+		}
+	};
+
+
+	template<>
+	struct StackLayerLink<EthLayer, IPv4Layer>
+	{
+		static bool isNextLayer(const uint8_t* prevData, const uint8_t* /* data */, size_t /* dataLen */)
+		{
+			return be16toh(((const ether_header*)prevData)->etherType) == PCPP_ETHERTYPE_IP;
+		}
+	};
+
+	template<>
+	struct StackLayerLink<EthLayer, IPv6Layer>
+	{
+		static bool isNextLayer(const uint8_t* prevData, const uint8_t* /* data */, size_t /* dataLen */)
+		{
+			return be16toh(((const ether_header*)prevData)->etherType) == PCPP_ETHERTYPE_IPV6;
+		}
+	};
+
+	template<>
+	struct StackLayerLink<EthLayer, VlanLayer>
+	{
+		static bool isNextLayer(const uint8_t* prevData, const uint8_t* /* data */, size_t /* dataLen */)
+		{
+			return be16toh(((const ether_header*)prevData)->etherType) == PCPP_ETHERTYPE_VLAN;
+		}
+	};
+
+	template<>
+	struct StackLayerLink<VlanLayer, VlanLayer>
+	{
+		static bool isNextLayer(const uint8_t* prevData, const uint8_t* /* data */, size_t /* dataLen */)
+		{
+			return be16toh(((const vlan_header*)prevData)->etherType) == PCPP_ETHERTYPE_VLAN;
+		}
+	};
+
+	template<>
+	struct StackLayerLink<VlanLayer, IPv4Layer>
+	{
+		static bool isNextLayer(const uint8_t* prevData, const uint8_t* /* data */, size_t /* dataLen */)
+		{
+			return be16toh(((const vlan_header*)prevData)->etherType) == PCPP_ETHERTYPE_IP;
+		}
+	};
+
+	template<>
+	struct StackLayerLink<VlanLayer, IPv6Layer>
+	{
+		static bool isNextLayer(const uint8_t* prevData, const uint8_t* /* data */, size_t /* dataLen */)
+		{
+			return be16toh(((const vlan_header*)prevData)->etherType) == PCPP_ETHERTYPE_IPV6;
+		}
+	};
+
+	template<>
+	struct StackLayerLink<IPv4Layer, TcpLayer>
+	{
+		static bool isNextLayer(const uint8_t* prevData, const uint8_t* /* data */, size_t /* dataLen */)
+		{
+			return ((const iphdr*)prevData)->protocol == PACKETPP_IPPROTO_TCP && !StackLayerTraits<IPv4Layer>::isFragment(prevData);
+		}
+	};
+
+	template<>
+	struct StackLayerLink<IPv4Layer, UdpLayer>
+	{
+		static bool isNextLayer(const uint8_t* prevData, const uint8_t* /* data */, size_t /* dataLen */)
+		{
+			return ((const iphdr*)prevData)->protocol == PACKETPP_IPPROTO_UDP && !StackLayerTraits<IPv4Layer>::isFragment(prevData);
+		}
+	};
+
+	template<>
+	struct StackLayerLink<IPv6Layer, TcpLayer>
+	{
+		static bool isNextLayer(const uint8_t* prevData, const uint8_t* /* data */, size_t /* dataLen */)
+		{
+			return ((const ip6_hdr*)prevData)->nextHeader == PACKETPP_IPPROTO_TCP;
+		}
+	};
+
+	template<>
+	struct StackLayerLink<IPv6Layer, UdpLayer>
+	{
+		static bool isNextLayer(const uint8_t* prevData, const uint8_t* /* data */, size_t /* dataLen */)
+		{
+			return ((const ip6_hdr*)prevData)->nextHeader == PACKETPP_IPPROTO_UDP;
+		}
+	};
+
+	template<>
+	struct StackLayerLink<UdpLayer, GtpV1Layer>
+	{
+		static bool isNextLayer(const uint8_t* prevData, const uint8_t* data, size_t dataLen)
+		{
+			const udphdr* hdr = (const udphdr*)prevData;
+			uint16_t portDst = be16toh(hdr->portDst);
+			uint16_t portSrc = be16toh(hdr->portSrc);
+
+			if (!GtpV1Layer::isGTPv1Port(portDst) && !GtpV1Layer::isGTPv1Port(portSrc))
+				return false;
+
+			// UdpLayer::parseNextLayer() checks these protocols before GTP, leave such packets to the generic parsing
+			if (portSrc == 67 || portSrc == 68 || portDst == 67 || portDst == 68 || VxlanLayer::isVxlanPort(portDst) ||
+					DnsLayer::isDnsPort(portDst) || DnsLayer::isDnsPort(portSrc) || SipLayer::isSipPort(portDst) || SipLayer::isSipPort(portSrc) ||
+					RadiusLayer::isRadiusPort(portDst) || RadiusLayer::isRadiusPort(portSrc))
+				return false;
+
+			return GtpV1Layer::isGTPv1(data, dataLen);
+		}
+	};
+
+	template<>
+	struct StackLayerLink<GtpV1Layer, IPv4Layer>
+	{
+		static bool isNextLayer(const uint8_t* prevData, const uint8_t* data, size_t /* dataLen */)
+		{
+			return ((const gtpv1_header*)prevData)->messageType == GtpV1_GPDU && data[0] >= 0x45 && data[0] <= 0x4e;
+		}
+	};
+
+	template<>
+	struct StackLayerLink<GtpV1Layer, IPv6Layer>
+	{
+		static bool isNextLayer(const uint8_t* prevData, const uint8_t* data, size_t /* dataLen */)
+		{
+			return ((const gtpv1_header*)prevData)->messageType == GtpV1_GPDU && (data[0] & 0xf0) == 0x60;
+		}
+	};
+
+
+	namespace internal
+	{
+		template<typename LayerType>
+		struct StackParserLayerCount { enum { Value = 1 }; };
+
+		template<>
+		struct StackParserLayerCount<StackParserEnd> { enum { Value = 0 }; };
+
+		template<int N, typename L1, typename L2, typename L3, typename L4, typename L5, typename L6, typename L7, typename L8>
+		struct StackParserLayerAt
+		{
+			typedef typename StackParserLayerAt<N - 1, L2, L3, L4, L5, L6, L7, L8, StackParserEnd>::Type Type;
+		};
+
+		template<typename L1, typename L2, typename L3, typename L4, typename L5, typename L6, typename L7, typename L8>
+		struct StackParserLayerAt<0, L1, L2, L3, L4, L5, L6, L7, L8>
+		{
+			typedef L1 Type;
+		};
+
+		template<typename PrevLayerType, typename LayerType>
+		struct StackParserStep
+		{
+			static bool parse(size_t index, uint8_t** layerData, size_t* layerDataLen, size_t* headerLen)
+			{
+				uint8_t* prevData = layerData[index - 1];
+				size_t prevHeaderLen = headerLen[index - 1];
+				if (layerDataLen[index - 1] <= prevHeaderLen)
+					return false;
+
+				uint8_t* data = prevData + prevHeaderLen;
+				size_t dataLen = layerDataLen[index - 1] - prevHeaderLen;
+				if (!StackLayerLink<PrevLayerType, LayerType>::isNextLayer(prevData, data, dataLen))
+					return false;
+
+				size_t curHeaderLen = StackLayerTraits<LayerType>::getHeaderLen(data, dataLen);
+				if (curHeaderLen == 0)
+					return false;
+
+				layerData[index] = data;
+				layerDataLen[index] = dataLen;
+				headerLen[index] = curHeaderLen;
+				return true;
+			}
+		};
+
+		template<typename PrevLayerType>
+		struct StackParserStep<PrevLayerType, StackParserEnd>
+		{
+			static bool parse(size_t /* index */, uint8_t** /* layerData */, size_t* /* layerDataLen */, size_t* /* headerLen */) { return true; }
+		};
+
+	} // namespace internal
+
+
+	/**
+	 * @class StackParser
+	 * Parses packets of one known protocol stack without creating Layer objects. The layers of the stack are given as template
+	 * parameters (up to 8 layers). Please refer to the documentation at the top of StackParser.h for more details.<BR>
+	 * The parser doesn't copy the packet data, so the pointers it returns are valid as long as the raw packet data is valid. A parser
+	 * instance can be reused for many packets, each call to parse() overwrites the results of the previous one
+	 */
+	template<typename L1, typename L2 = StackParserEnd, typename L3 = StackParserEnd, typename L4 = StackParserEnd,
+			typename L5 = StackParserEnd, typename L6 = StackParserEnd, typename L7 = StackParserEnd, typename L8 = StackParserEnd>
+	class StackParser
+	{
+	public:
+
+		enum
+		{
+			/** The number of layers in the stack */
+			NumOfLayers = internal::StackParserLayerCount<L1>::Value + internal::StackParserLayerCount<L2>::Value +
+				internal::StackParserLayerCount<L3>::Value + internal::StackParserLayerCount<L4>::Value +
+				internal::StackParserLayerCount<L5>::Value + internal::StackParserLayerCount<L6>::Value +
+				internal::StackParserLayerCount<L7>::Value + internal::StackParserLayerCount<L8>::Value
+		};
+
+		/**
+		 * @struct LayerAt
+		 * The layer type and header type of the layer in index N of the stack
+		 */
+		template<int N>
+		struct LayerAt
+		{
+			/** The layer type, for example TcpLayer */
+			typedef typename internal::StackParserLayerAt<N, L1, L2, L3, L4, L5, L6, L7, L8>::Type LayerType;
+			/** The header type, for example tcphdr */
+			typedef typename StackLayerTraits<LayerType>::HeaderType HeaderType;
+		};
+
+		/**
+		 * A c'tor for this class
+		 */
+		StackParser() : m_IsParsed(false) { }
+
+		/**
+		 * Parse a raw packet
+		 * @param[in] rawPacket The raw packet to parse
+		 * @return True if the packet matches the stack, false otherwise (the packet should then be parsed with the generic Packet class)
+		 */
+		bool parse(const RawPacket* rawPacket)
+		{
+			return parse(rawPacket->getRawData(), (size_t)rawPacket->getRawDataLen(), rawPacket->getLinkLayerType());
+		}
+
+		/**
+		 * Parse raw packet data
+		 * @param[in] data A pointer to the packet data
+		 * @param[in] dataLen The packet data length
+		 * @param[in] linkType The link layer type of the packet
+		 * @return True if the packet matches the stack, false otherwise (the packet should then be parsed with the generic Packet class)
+		 */
+		bool parse(const uint8_t* data, size_t dataLen, LinkLayerType linkType)
+		{
+			m_IsParsed = false;
+
+			if (data == NULL || !StackLayerTraits<L1>::isFirstLayer(linkType, data, dataLen))
+				return false;
+
+			m_LayerData[0] = (uint8_t*)data;
+			m_HeaderLen[0] = StackLayerTraits<L1>::getHeaderLen(data, dataLen);
+			m_LayerDataLen[0] = dataLen;
+			if (m_HeaderLen[0] == 0)
+				return false;
+
+			m_IsParsed =
+				internal::StackParserStep<L1, L2>::parse(1, m_LayerData, m_LayerDataLen, m_HeaderLen) &&
+				internal::StackParserStep<L2, L3>::parse(2, m_LayerData, m_LayerDataLen, m_HeaderLen) &&
+				internal::StackParserStep<L3, L4>::parse(3, m_LayerData, m_LayerDataLen, m_HeaderLen) &&
+				internal::StackParserStep<L4, L5>::parse(4, m_LayerData, m_LayerDataLen, m_HeaderLen) &&
+				internal::StackParserStep<L5, L6>::parse(5, m_LayerData, m_LayerDataLen, m_HeaderLen) &&
+				internal::StackParserStep<L6, L7>::parse(6, m_LayerData, m_LayerDataLen, m_HeaderLen) &&
+				internal::StackParserStep<L7, L8>::parse(7, m_LayerData, m_LayerDataLen, m_HeaderLen);
+
+			return m_IsParsed;
+		}
+
+		/**
+		 * @return True if the last call to parse() succeeded, false otherwise
+		 */
+		bool isParsed() const { return m_IsParsed; }
+
+		/**
+		 * Get the header of the layer in index N of the stack, for example getHeader<2>() returns a tcphdr pointer for
+		 * StackParser<EthLayer, IPv4Layer, TcpLayer>. Notice this points directly to the packet data. Should be called only
+		 * after parse() succeeded
+		 * @return A pointer to the header
+		 */
+		template<int N>
+		typename LayerAt<N>::HeaderType* getHeader() const { return (typename LayerAt<N>::HeaderType*)m_LayerData[N]; }
+
+		/**
+		 * @param[in] index The index of the layer in the stack
+		 * @return A pointer to the data of the layer, which starts with its header. Should be called only after parse() succeeded
+		 */
+		uint8_t* getLayerData(size_t index) const { return m_LayerData[index]; }
+
+		/**
+		 * @param[in] index The index of the layer in the stack
+		 * @return The length of the layer data, meaning the length of its header and everything after it. This is the value
+		 * Layer#getDataLen() returns for the same layer. Should be called only after parse() succeeded
+		 */
+		size_t getLayerDataLen(size_t index) const { return m_LayerDataLen[index]; }
+
+		/**
+		 * @param[in] index The index of the layer in the stack
+		 * @return The header length of the layer. Should be called only after parse() succeeded
+		 */
+		size_t getHeaderLen(size_t index) const { return m_HeaderLen[index]; }
+
+		/**
+		 * @return A pointer to the data that follows the header of the last layer in the stack. Should be called only after
+		 * parse() succeeded
+		 */
+		uint8_t* getPayload() const { return m_LayerData[NumOfLayers - 1] + m_HeaderLen[NumOfLayers - 1]; }
+
+		/**
+		 * @return The length of the data that follows the header of the last layer in the stack. Should be called only after
+		 * parse() succeeded
+		 */
+		size_t getPayloadLen() const { return m_LayerDataLen[NumOfLayers - 1] - m_HeaderLen[NumOfLayers - 1]; }
+
+	private:
+		uint8_t* m_LayerData[NumOfLayers];
+		size_t m_LayerDataLen[NumOfLayers];
+		size_t m_HeaderLen[NumOfLayers];
+		bool m_IsParsed;
+	};
+
+} // namespace pcpp
+
+#endif /* PACKETPP_STACK_PARSER */
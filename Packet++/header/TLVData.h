@@ -4,6 +4,7 @@
 #include "Layer.h"
 #include "IpAddress.h"
 #include <string.h>
+#include <vector>
 
 /// @file
 
@@ -191,33 +192,82 @@ namespace pcpp
 	/**
 	 * @class TLVRecordReader
 	 * A class for reading TLV records data out of a byte stream. This class contains helper methods for retrieving and
-	 * counting TLV records. This is a template class that expects template argument class derived from TLVRecord.
+	 * counting TLV records. This is a template class that expects template argument class derived from TLVRecord.<BR>
+	 * By default getTLVRecord() walks over the records until it finds the requested type. For protocols with many records
+	 * that are looked up repeatedly (such as DHCP options or RADIUS attributes) the reader can keep an index of record
+	 * types (see enableRecordIndex()), which is built in one pass on the first lookup and makes all consequent lookups O(1)
 	 */
 	template<typename TLVRecordType>
 	class TLVRecordReader
 	{
 	private:
 		mutable size_t m_RecordCount;
+		mutable uint16_t* m_RecordIndex;
+		mutable size_t m_IndexedDataLen;
+		bool m_RecordIndexEnabled;
+
+		static const size_t IndexSize = 256;
+
+		bool buildRecordIndex(uint8_t* tlvDataBasePtr, size_t tlvDataLen) const
+		{
+			if (m_RecordIndex == NULL)
+				m_RecordIndex = new uint16_t[IndexSize];
+
+			// each entry holds the offset of the first record of a type plus 1, or 0 if there is no record of this type
+			memset(m_RecordIndex, 0, IndexSize * sizeof(uint16_t));
+			m_IndexedDataLen = (size_t)-1;
+
+			TLVRecordType curRec = getFirstTLVRecord(tlvDataBasePtr, tlvDataLen);
+			while (!curRec.isNull())
+			{
+				size_t offset = curRec.getRecordBasePtr() - tlvDataBasePtr;
+				if (offset >= 0xffff)
+					return false;
+
+				if (m_RecordIndex[curRec.getType()] == 0)
+					m_RecordIndex[curRec.getType()] = (uint16_t)(offset + 1);
+
+				curRec = getNextTLVRecord(curRec, tlvDataBasePtr, tlvDataLen);
+			}
+
+			m_IndexedDataLen = tlvDataLen;
+			return true;
+		}
+
+		bool isRecordIndexUsable(uint8_t* tlvDataBasePtr, size_t tlvDataLen) const
+		{
+			if (!m_RecordIndexEnabled)
+				return false;
+
+			if (m_RecordIndex != NULL && m_IndexedDataLen == tlvDataLen)
+				return true;
+
+			return buildRecordIndex(tlvDataBasePtr, tlvDataLen);
+		}
 
 	public:
 
 		/**
 		 * A default c'tor for this class
 		 */
-		TLVRecordReader() { m_RecordCount = (size_t)-1; }
+		TLVRecordReader() { m_RecordCount = (size_t)-1; m_RecordIndex = NULL; m_IndexedDataLen = (size_t)-1; m_RecordIndexEnabled = false; }
 
 		/**
-		 * A default copy c'tor for this class
+		 * A default copy c'tor for this class. The record index isn't copied, it will be rebuilt on the first lookup if
+		 * it's enabled
 		 */
 		TLVRecordReader(const TLVRecordReader& other)
 		{
 			m_RecordCount = other.m_RecordCount;
+			m_RecordIndex = NULL;
+			m_IndexedDataLen = (size_t)-1;
+			m_RecordIndexEnabled = other.m_RecordIndexEnabled;
 		}
 
 		/**
-		 * A d'tor for this class which currently does nothing
+		 * A d'tor for this class which frees the record index if it was built
 		 */
-		virtual ~TLVRecordReader() { }
+		virtual ~TLVRecordReader() { delete [] m_RecordIndex; }
 
 		/**
 		 * Overload of the assignment operator for this class
@@ -226,9 +276,29 @@ namespace pcpp
 		TLVRecordReader& operator=(const TLVRecordReader& other)
 		{
 			m_RecordCount = other.m_RecordCount;
+			m_IndexedDataLen = (size_t)-1;
+			m_RecordIndexEnabled = other.m_RecordIndexEnabled;
 			return *this;
 		}
 
+		/**
+		 * Enable or disable the record type index. When enabled, the first call to getTLVRecord() or getTLVRecords() goes
+		 * over all records once and stores the offset of the first record of each type, so consequent lookups don't need
+		 * to walk over the records. The index is invalidated when changeTLVRecordCount() is called or when the TLV data
+		 * length changes
+		 * @param[in] enable True to enable the index, false to disable it
+		 */
+		void enableRecordIndex(bool enable)
+		{
+			m_RecordIndexEnabled = enable;
+			m_IndexedDataLen = (size_t)-1;
+		}
+
+		/**
+		 * @return True if the record type index is enabled, false otherwise
+		 */
+		bool isRecordIndexEnabled() const { return m_RecordIndexEnabled; }
+
 		/**
 		 * Get the first TLV record out of a byte stream
 		 * @param[in] tlvDataBasePtr A pointer to the TLV data byte stream
@@ -281,7 +351,9 @@ namespace pcpp
 		}
 
 		/**
-		 * Search for the first TLV record that corresponds to a given record type (the 'T' in __Type__-Length-Value)
+		 * Search for the first TLV record that corresponds to a given record type (the 'T' in __Type__-Length-Value).
+		 * If the record type index is enabled the record is taken from the index (which is built on the first call),
+		 * otherwise the records are searched one by one
 		 * @param[in] recordType The record type to search for
 		 * @param[in] tlvDataBasePtr A pointer to the TLV data byte stream
 		 * @param[in] tlvDataLen The TLV data byte stream length
@@ -290,6 +362,13 @@ namespace pcpp
 		 */
 		TLVRecordType getTLVRecord(uint8_t recordType, uint8_t* tlvDataBasePtr, size_t tlvDataLen) const
 		{
+			if (isRecordIndexUsable(tlvDataBasePtr, tlvDataLen))
+			{
+				uint16_t offset = m_RecordIndex[recordType];
+				TLVRecordType resRec(offset == 0 ? (uint8_t*)NULL : tlvDataBasePtr + offset - 1); // for NRVO optimization
+				return resRec;
+			}
+
 			TLVRecordType curRec = getFirstTLVRecord(tlvDataBasePtr, tlvDataLen);
 			while (!curRec.isNull())
 			{
@@ -303,6 +382,73 @@ namespace pcpp
 			return curRec; // for NRVO optimization
 		}
 
+		/**
+		 * Search for the first TLV records of several record types at once. If the record type index is enabled each
+		 * record is taken from the index, otherwise all record types are searched in a single pass over the records
+		 * @param[in] recordTypes An array of the record types to search for. Its element type can be any type that
+		 * converts to uint8_t, such as a protocol's record type enum
+		 * @param[in] numOfRecordTypes The number of record types in the array
+		 * @param[out] results A vector that will be cleared and filled with one TLVRecordType instance per record type,
+		 * in the same order as recordTypes. Record types that weren't found will have a logical NULL instance
+		 * @param[in] tlvDataBasePtr A pointer to the TLV data byte stream
+		 * @param[in] tlvDataLen The TLV data byte stream length
+		 * @return The number of record types that were found
+		 */
+		template<typename RecordTypeEnum>
+		size_t getTLVRecords(const RecordTypeEnum* recordTypes, size_t numOfRecordTypes, std::vector<TLVRecordType>& results,
+				uint8_t* tlvDataBasePtr, size_t tlvDataLen) const
+		{
+			results.clear();
+			results.resize(numOfRecordTypes, TLVRecordType(NULL));
+			size_t numOfFoundRecords = 0;
+
+			if (isRecordIndexUsable(tlvDataBasePtr, tlvDataLen))
+			{
+				for (size_t i = 0; i < numOfRecordTypes; i++)
+				{
+					uint16_t offset = m_RecordIndex[(uint8_t)recordTypes[i]];
+					if (offset == 0)
+						continue;
+
+					results[i].assign(tlvDataBasePtr + offset - 1);
+					numOfFoundRecords++;
+				}
+
+				return numOfFoundRecords;
+			}
+
+			uint32_t requestedTypes[IndexSize / 32];
+			memset(requestedTypes, 0, sizeof(requestedTypes));
+			for (size_t i = 0; i < numOfRecordTypes; i++)
+			{
+				uint8_t recordType = (uint8_t)recordTypes[i];
+				requestedTypes[recordType / 32] |= (1U << (recordType % 32));
+			}
+
+			TLVRecordType curRec = getFirstTLVRecord(tlvDataBasePtr, tlvDataLen);
+			while (!curRec.isNull() && numOfFoundRecords < numOfRecordTypes)
+			{
+				uint8_t recordType = curRec.getType();
+				if (requestedTypes[recordType / 32] & (1U << (recordType % 32)))
+				{
+					// only the first record of each type is returned
+					requestedTypes[recordType / 32] &= ~(1U << (recordType % 32));
+					for (size_t i = 0; i < numOfRecordTypes; i++)
+					{
+						if ((uint8_t)recordTypes[i] == recordType)
+						{
+							results[i] = curRec;
+							numOfFoundRecords++;
+						}
+					}
+				}
+
+				curRec = getNextTLVRecord(curRec, tlvDataBasePtr, tlvDataLen);
+			}
+
+			return numOfFoundRecords;
+		}
+
 		/**
 		 * Get the TLV record count in a given TLV data byte stream. For efficiency purposes the count is being cached
 		 * so only the first call to this method will go over all the TLV records, while all consequent calls will return
@@ -332,10 +478,15 @@ namespace pcpp
 		 * As described in getTLVRecordCount(), the TLV record count is being cached for efficiency purposes. So if the
 		 * number of TLV records change, it's the user's responsibility to call this method with the number of TLV records
 		 * being added or removed. If records were added the change should be a positive number, or a negative number
-		 * if records were removed
+		 * if records were removed. This method also invalidates the record type index
 		 * @param[in] changedBy Number of records that were added or removed
 		 */
-		void changeTLVRecordCount(int changedBy) { if (m_RecordCount != (size_t)-1) m_RecordCount += changedBy; }
+		void changeTLVRecordCount(int changedBy)
+		{
+			m_IndexedDataLen = (size_t)-1;
+			if (m_RecordCount != (size_t)-1)
+				m_RecordCount += changedBy;
+		}
 	};
 
 
@@ -327,6 +327,10 @@ namespace pcpp
 	class TcpLayer : public Layer
 	{
 	public:
+		/** %TcpLayer instances carry ::TCP, see Layer#LayerProtocol */
+		static const ProtocolType LayerProtocol = TCP;
+		typedef TcpLayer LayerProtocolClass;
+
 		/**
 		 * A constructor that creates the layer from an existing packet raw data
 		 * @param[in] data A pointer to the raw data (will be casted to @ref tcphdr)
@@ -374,6 +378,17 @@ namespace pcpp
 		 */
 		TcpOption getTcpOption(TcpOptionType option) const;
 
+		/**
+		 * Get several TCP options by type in a single pass over the options
+		 * @param[in] optionTypes An array of the TCP option types to retrieve
+		 * @param[in] numOfOptionTypes The number of option types in the array
+		 * @param[out] result A vector that will be filled with one TcpOption object per option type, in the same order as
+		 * optionTypes. Each object contains the first option that matches the type, or logical NULL (TcpOption#isNull() == true)
+		 * if no such option found
+		 * @return The number of option types that were found
+		 */
+		size_t getTcpOptions(const TcpOptionType* optionTypes, size_t numOfOptionTypes, std::vector<TcpOption>& result) const;
+
 		/**
 		 * @return The first TCP option in the packet. If the current layer contains no options the returned value will contain
 		 * a logical NULL (TcpOption#isNull() == true)
@@ -476,6 +491,8 @@ namespace pcpp
 		TcpOption addTcpOptionAt(const TcpOptionBuilder& optionBuilder, int offset);
 		void adjustTcpOptionTrailer(size_t totalOptSize);
 		void copyLayerData(const TcpLayer& other);
+
+		Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new TcpLayer(data, m_DataLen, prevLayer, packet); }
 	};
 
 
@@ -6,6 +6,7 @@
 #include "PointerVector.h"
 #include <map>
 #include <list>
+#include <vector>
 #include <time.h>
 
 
@@ -21,6 +22,7 @@
  * - Support missing TCP data
  * - TCP connections can end "naturally" (by FIN/RST packets) or manually by the user
  * - Support callbacks for new TCP data, connection start and connection end
+ * - Optionally collect the data of each side of a connection into a contiguous stream buffer (pcpp#TcpStreamBuffer)
  *
  * __Logic Description:__
  * - The user creates an instance of the pcpp#TcpReassembly class
@@ -44,6 +46,7 @@
  * __Basic Usage and APIs:__
  * - pcpp#TcpReassembly c'tor - Create an instance, provide the callbacks and the user cookie to the instance
  * - pcpp#TcpReassembly#reassemblePacket() - Feed pcpp#TcpReassembly instance with packets
+ * - pcpp#TcpReassembly#reassemblePackets() - Feed pcpp#TcpReassembly instance with a burst of packets
  * - pcpp#TcpReassembly#closeConnection() - Manually close a connection by a flow key
  * - pcpp#TcpReassembly#closeAllConnections() - Manually close all currently opened connections
  * - pcpp#TcpReassembly#OnTcpMessageReady callback - Invoked when new data arrives on a certain connection. Contains the new data as well as connection data (5-tuple, flow key)
@@ -62,6 +65,17 @@
  * - pcpp#TcpReassemblyConfiguration#closedConnectionDelay - the value of delay expressed in seconds. The minimum value is 1
  * - pcpp#TcpReassemblyConfiguration#maxNumToClean - to avoid performance overhead when the cleanup is being performed, this parameter is used. It defines the maximum number of items to be removed per one call of pcpp#TcpReassembly#purgeClosedConnections
  * - pcpp#TcpReassemblyConfiguration#maxOutOfOrderFragments - the maximum number of unmatched fragments to keep per flow before missed fragments are considered lost. A value of 0 means unlimited
+ * - pcpp#TcpReassemblyConfiguration#useStreamBuffers - if this member is set to true the data of each side of a connection is also collected into a pcpp#TcpStreamBuffer
+ * - pcpp#TcpReassemblyConfiguration#maxStreamBufferSize - the maximum number of unconsumed bytes each stream buffer holds. A value of 0 means unlimited
+ *
+ * __Stream buffers:__
+ * Protocol parsers usually need a whole message (an HTTP header, a TLS record, etc.) while pcpp#TcpReassembly#OnTcpMessageReady is invoked with one piece of data per packet.
+ * When stream buffers are used, each piece of data is also appended to the pcpp#TcpStreamBuffer of its side. A parser can then look at the contiguous data using
+ * pcpp#TcpStreamBuffer#peek() and remove what it parsed using pcpp#TcpStreamBuffer#consume(), either in the callback (the buffer is available through
+ * pcpp#TcpStreamData#getStreamBuffer()) or later on using pcpp#TcpReassembly#getStreamBuffer(). Data that isn't consumed stays in the buffer until the connection is purged.
+ * Data that arrives after missing bytes isn't joined to the data before them: the buffer records a gap and peek() and getData() stop at it. A parser that can't find
+ * a complete message before the gap calls pcpp#TcpStreamBuffer#skipGap() to discard it and continue with the data after the gap. When a buffer holds more than
+ * pcpp#TcpReassemblyConfiguration#maxStreamBufferSize unconsumed bytes it's marked as overflowed and the rest of the data of this side isn't appended to it
  *
  */
 
@@ -115,6 +129,103 @@ struct ConnectionData
 class TcpReassembly;
 
 
+/**
+ * @class TcpStreamBuffer
+ * The reassembled data of one side of a TCP connection, kept contiguous until the user consumes it. Stream buffers are created by pcpp#TcpReassembly
+ * when pcpp#TcpReassemblyConfiguration#useStreamBuffers is set. Each piece of data is copied once into the buffer, and the pointers returned by peek() and getData()
+ * point into the buffer and stay valid until more data is appended to it (consuming data doesn't move the rest of it). That's the next call to
+ * pcpp#TcpReassembly#reassemblePacket(), or within a burst passed to pcpp#TcpReassembly#reassemblePackets() it can be the next packet of the same connection.
+ * Missing data isn't written to the buffer, it's counted by getMissingByteCount() and the position of the data that came after it is recorded as a gap.
+ * getDataLength(), getData() and peek() only cover the data up to the next gap, so bytes from both sides of a gap are never seen as contiguous.
+ * If the unconsumed data exceeds the maximum size the buffer is marked as overflowed and all the data that comes after that is dropped
+ */
+class TcpStreamBuffer
+{
+	friend class TcpReassembly;
+
+public:
+	/**
+	 * A c'tor for this class that creates an empty buffer
+	 * @param[in] maxSize The maximum number of unconsumed bytes the buffer holds. Once data doesn't fit the buffer overflows and the rest of the data is dropped.
+	 * The default is 0 which means unlimited
+	 */
+	TcpStreamBuffer(size_t maxSize = 0) : m_Offset(0), m_MaxSize(maxSize), m_ConsumedBytes(0), m_MissingBytes(0), m_DroppedBytes(0), m_Overflowed(false) {}
+
+	/**
+	 * @return The number of contiguous bytes in the buffer that weren't consumed yet, up to the next gap
+	 */
+	size_t getDataLength() const { return (m_Gaps.empty() ? m_Data.size() : m_Gaps.front()) - m_Offset; }
+
+	/**
+	 * @return A pointer to the first byte that wasn't consumed yet, or NULL if the buffer is empty or the next gap was reached
+	 */
+	const uint8_t* getData() const { return (getDataLength() > 0 ? &m_Data[m_Offset] : NULL); }
+
+	/**
+	 * Look at the next bytes of the stream without consuming them
+	 * @param[in] numOfBytes The number of bytes to look at
+	 * @return A pointer to the first byte that wasn't consumed yet, or NULL if the buffer holds less than numOfBytes bytes before the next gap
+	 */
+	const uint8_t* peek(size_t numOfBytes) const;
+
+	/**
+	 * Remove bytes from the beginning of the buffer, usually after they were parsed. Bytes after the next gap aren't removed
+	 * @param[in] numOfBytes The number of bytes to remove
+	 * @return The number of bytes removed, which is lower than numOfBytes if the buffer holds less than numOfBytes bytes before the next gap
+	 */
+	size_t consume(size_t numOfBytes);
+
+	/**
+	 * @return True if some of the unconsumed data came after missing data, meaning getData() stops at a gap
+	 */
+	bool hasGap() const { return !m_Gaps.empty(); }
+
+	/**
+	 * Discard the unconsumed bytes before the next gap, usually because they don't contain a complete message, so the data after the gap can be parsed.
+	 * The discarded bytes are counted as consumed
+	 * @return The number of bytes discarded, or 0 if there is no gap in the buffer
+	 */
+	size_t skipGap();
+
+	/**
+	 * @return True if the buffer held more than its maximum size of unconsumed data. From that point on the data of this side is dropped
+	 */
+	bool isOverflowed() const { return m_Overflowed; }
+
+	/**
+	 * @return The number of bytes consumed or skipped since the connection started, which is also the position of getData() in the stream (not counting missing and dropped bytes)
+	 */
+	uint64_t getConsumedByteCount() const { return m_ConsumedBytes; }
+
+	/**
+	 * @return The number of bytes of this side of the connection that were missing due to packet loss
+	 */
+	size_t getMissingByteCount() const { return m_MissingBytes; }
+
+	/**
+	 * @return The number of bytes that were dropped because the buffer held more than its maximum size of unconsumed data, including all the data after it overflowed
+	 */
+	size_t getDroppedByteCount() const { return m_DroppedBytes; }
+
+	/**
+	 * @return The maximum number of unconsumed bytes the buffer holds, or 0 if it's unlimited
+	 */
+	size_t getMaxSize() const { return m_MaxSize; }
+
+private:
+	std::vector<uint8_t> m_Data;
+	size_t m_Offset;
+	size_t m_MaxSize;
+	uint64_t m_ConsumedBytes;
+	size_t m_MissingBytes;
+	size_t m_DroppedBytes;
+	std::vector<size_t> m_Gaps;
+	bool m_Overflowed;
+
+	bool append(const uint8_t* data, size_t dataLen, bool afterGap);
+};
+
+
 /**
  * @class TcpStreamData
  * When following a TCP connection each packet may contain a piece of the data transferred between the client and the server. This class represents these pieces: each instance of it
@@ -129,9 +240,10 @@ public:
 	 * @param[in] tcpDataLength The length of the buffer
 	 * @param[in] missingBytes The number of missing bytes due to packet loss.
 	 * @param[in] connData TCP connection information for this TCP data
+	 * @param[in] streamBuffer The stream buffer of the side this data belongs to, or NULL if stream buffers aren't used. The default is NULL
 	 */
-	TcpStreamData(const uint8_t* tcpData, size_t tcpDataLength, size_t missingBytes, const ConnectionData& connData)
-		: m_Data(tcpData), m_DataLen(tcpDataLength), m_MissingBytes(missingBytes), m_Connection(connData)
+	TcpStreamData(const uint8_t* tcpData, size_t tcpDataLength, size_t missingBytes, const ConnectionData& connData, TcpStreamBuffer* streamBuffer = NULL)
+		: m_Data(tcpData), m_DataLen(tcpDataLength), m_MissingBytes(missingBytes), m_Connection(connData), m_StreamBuffer(streamBuffer)
 	{
 	}
 
@@ -165,11 +277,18 @@ public:
 	 */
 	const ConnectionData& getConnectionData() const { return m_Connection; }
 
+	/**
+	 * A getter for the stream buffer of the side this data belongs to. The data of this instance was already appended to it (unless it was dropped because the buffer is full)
+	 * @return A pointer to the stream buffer, or NULL if stream buffers aren't used
+	 */
+	TcpStreamBuffer* getStreamBuffer() const { return m_StreamBuffer; }
+
 private:
 	const uint8_t* m_Data;
 	size_t m_DataLen;
 	size_t m_MissingBytes;
 	const ConnectionData& m_Connection;
+	TcpStreamBuffer* m_StreamBuffer;
 };
 
 
@@ -197,15 +316,28 @@ struct TcpReassemblyConfiguration
 	 */
 	uint32_t maxOutOfOrderFragments;
 
+	/** The flag indicating whether to collect the data of each side of a connection into a TcpStreamBuffer */
+	bool useStreamBuffers;
+
+	/** The maximum number of unconsumed bytes each TcpStreamBuffer holds. Once data doesn't fit the buffer overflows and the rest of the data of its side is dropped.
+	 * If the value is 0 the buffers are unlimited.
+	 * This parameter is only relevant if useStreamBuffers is equal to true.
+	 */
+	uint32_t maxStreamBufferSize;
+
 	/**
 	 * A c'tor for this struct
 	 * @param[in] removeConnInfo The flag indicating whether to remove the connection data after a connection is closed. The default is true
 	 * @param[in] closedConnectionDelay How long the closed connections will not be cleaned up. The value is expressed in seconds. If it's set to 0 the default value will be used. The default is 5.
 	 * @param[in] maxNumToClean The maximum number of items to be cleaned up per one call of purgeClosedConnections. If it's set to 0 the default value will be used. The default is 30.
 	 * @param[in] maxOutOfOrderFragments The maximum number of unmatched fragments to keep per flow before missed fragments are considered lost. The default is unlimited.
+	 * @param[in] useStreamBuffers The flag indicating whether to collect the data of each side of a connection into a TcpStreamBuffer. The default is false
+	 * @param[in] maxStreamBufferSize The maximum number of unconsumed bytes each TcpStreamBuffer holds. The default is unlimited.
 	 */
-	TcpReassemblyConfiguration(bool removeConnInfo = true, uint32_t closedConnectionDelay = 5, uint32_t maxNumToClean = 30, uint32_t maxOutOfOrderFragments = 0) :
-		removeConnInfo(removeConnInfo), closedConnectionDelay(closedConnectionDelay), maxNumToClean(maxNumToClean), maxOutOfOrderFragments(maxOutOfOrderFragments)
+	TcpReassemblyConfiguration(bool removeConnInfo = true, uint32_t closedConnectionDelay = 5, uint32_t maxNumToClean = 30, uint32_t maxOutOfOrderFragments = 0,
+		bool useStreamBuffers = false, uint32_t maxStreamBufferSize = 0) :
+		removeConnInfo(removeConnInfo), closedConnectionDelay(closedConnectionDelay), maxNumToClean(maxNumToClean), maxOutOfOrderFragments(maxOutOfOrderFragments),
+		useStreamBuffers(useStreamBuffers), maxStreamBufferSize(maxStreamBufferSize)
 	{
 	}
 };
@@ -349,6 +481,25 @@ public:
 	 */
 	ReassemblyStatus reassemblePacket(RawPacket* tcpRawData);
 
+	/**
+	 * Process a burst of packets, for example the packets received by one call to DpdkDevice#receivePackets() or PfRingDevice#receivePackets().
+	 * The result is the same as calling reassemblePacket() for each packet, except for these differences which make a burst cheaper to process:
+	 * - The packets are grouped by connection. The packets of each connection are processed in their original order and the connection is looked up once
+	 *   per group. Callbacks of different connections may therefore be invoked in a different order than their packets appear in the burst
+	 * - In-order data of the same side of a connection is delivered in one TcpReassembly#OnTcpMessageReady call instead of one call per packet.
+	 *   Data that follows missing data is still delivered in a separate call
+	 * - Closed connections are purged (if configured) once per burst instead of once per packet
+	 * - When stream buffers are used, the data of a combined TcpReassembly#OnTcpMessageReady call points into the stream buffer instead of being copied again.
+	 *   More data may be appended to the same buffer later in the burst (for example if the other side of the connection sends data in between), and an append
+	 *   may move the buffer. Pointers returned by TcpStreamData#getData(), TcpStreamBuffer#peek() or TcpStreamBuffer#getData() inside a callback must therefore
+	 *   not be kept after the callback returns
+	 * @param[in] packets An array of pointers to the packets to process
+	 * @param[in] numOfPackets The number of packets in the array
+	 * @param[out] statuses An optional array of at least numOfPackets items. If it's not NULL each item is set to the status of the packet in the same index,
+	 * as it would be returned from reassemblePacket()
+	 */
+	void reassemblePackets(Packet** packets, size_t numOfPackets, ReassemblyStatus* statuses = NULL);
+
 	/**
 	 * Close a connection manually. If the connection doesn't exist or already closed an error log is printed. This method will cause the TcpReassembly#OnTcpConnectionEnd to be invoked with
 	 * a reason of TcpReassembly#TcpReassemblyConnectionClosedManually
@@ -382,6 +533,15 @@ public:
 	 */
 	uint32_t purgeClosedConnections(uint32_t maxNumToClean = 0);
 
+	/**
+	 * Get the stream buffer of one side of a connection. The buffer is available until the connection is purged, so data left in it can also be read
+	 * after the connection was closed
+	 * @param[in] flowKey A 4-byte hash key representing the connection. Can be taken from a ConnectionData instance
+	 * @param[in] side The side of the connection (0 or 1, as in TcpReassembly#OnTcpMessageReady)
+	 * @return A pointer to the stream buffer, or NULL if stream buffers aren't used, the connection isn't managed by this instance or this side wasn't seen yet
+	 */
+	TcpStreamBuffer* getStreamBuffer(uint32_t flowKey, int8_t side);
+
 private:
 	struct TcpFragment
 	{
@@ -400,6 +560,7 @@ private:
 		uint32_t sequence;
 		PointerVector<TcpFragment> tcpFragmentList;
 		bool gotFinOrRst;
+		TcpStreamBuffer streamBuffer;
 
 		TcpOneSideData() : srcPort(0), sequence(0), gotFinOrRst(false) {}
 	};
@@ -429,7 +590,24 @@ private:
 	uint32_t m_ClosedConnectionDelay;
 	uint32_t m_MaxNumToClean;
 	size_t m_MaxOutOfOrderFragments;
+	bool m_UseStreamBuffers;
+	size_t m_MaxStreamBufferSize;
 	time_t m_PurgeTimepoint;
+	std::vector<std::pair<uint32_t, size_t> > m_BatchOrder;
+	bool m_InBatch;
+	TcpReassemblyData* m_BatchLastConnection;
+	TcpReassemblyData* m_PendingMessageConnection;
+	int8_t m_PendingMessageSide;
+	std::vector<uint8_t> m_PendingMessageData;
+	size_t m_PendingMessageLength;
+
+	ReassemblyStatus reassemblePacketInternal(Packet& tcpData, const uint32_t* precomputedFlowKey);
+
+	void purgeClosedConnectionsIfNeeded();
+
+	void flushPendingMessage();
+
+	void handleNewData(TcpReassemblyData* tcpReassemblyData, int8_t sideIndex, const uint8_t* data, size_t dataLen, uint32_t missingDataLen);
 
 	void checkOutOfOrderFragments(TcpReassemblyData* tcpReassemblyData, int8_t sideIndex, bool cleanWholeFragList);
 
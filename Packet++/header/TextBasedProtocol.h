@@ -65,6 +65,14 @@ public:
 	 */
 	std::string getFieldValue() const;
 
+	/**
+	 * Get the field value without copying it. This is useful for code that runs on every packet and only needs to compare or hash the value
+	 * @param[out] valueLength The length of the value in bytes
+	 * @return A pointer to the value inside the packet data (or inside the field's own data if the field isn't attached to a message).
+	 * The value isn't NULL-terminated. If the field has no value NULL is returned and valueLength is set to 0
+	 */
+	const char* getFieldValueData(size_t& valueLength) const;
+
 	/**
 	 * A setter for field value
 	 * @param[in] newValue The new value to set to the field. Old value will be deleted
@@ -114,6 +122,10 @@ class TextBasedProtocolMessage : public Layer
 {
 	friend class HeaderField;
 public:
+	/** %TextBasedProtocolMessage instances carry ::HTTP | ::SIP | ::SDP, see Layer#LayerProtocol */
+	static const ProtocolType LayerProtocol = HTTP | SIP | SDP;
+	typedef TextBasedProtocolMessage LayerProtocolClass;
+
 	~TextBasedProtocolMessage();
 
 	/**
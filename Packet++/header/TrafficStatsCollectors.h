@@ -0,0 +1,394 @@
+#ifndef PACKETPP_TRAFFIC_STATS_COLLECTORS
+#define PACKETPP_TRAFFIC_STATS_COLLECTORS
+
+#include "Packet.h"
+#include "HttpLayer.h"
+#include "StringCounterTable.h"
+#include <map>
+#include <vector>
+
+/**
+ * @file
+ * This file includes HTTP and SSL/TLS traffic statistics collectors, library versions of the collectors of the HttpAnalyzer and
+ * SSLAnalyzer examples that are meant to keep up with multi-10G links:
+ * - Run one collector per capture core (per DpdkDevice/PfRingDevice RX queue or per worker thread). With symmetric RSS all packets of a
+ *   flow arrive at the same core, so every collector sees whole flows and no locking is needed
+ * - Strings seen in traffic (hostnames, content types, server names) are counted in pcpp#StringCounterTable instances straight from the
+ *   packet data, so collecting a packet doesn't allocate memory. Numeric keys (HTTP methods and status codes) are counted in arrays
+ * - Flow state is kept in an open-addressing hash table keyed by pcpp#hash5Tuple(). Flows are removed when they're closed (RST or FIN
+ *   in both directions) and the number of tracked flows is capped, so memory doesn't grow with the number of flows seen
+ * - Periodically (for example once a second) each collector's stats are flushed into an aggregate with flushStats(), which adds the
+ *   stats collected since the last flush and zeroes them. Merging the per-core aggregates gives the stats of the whole link.
+ *   Collectors aren't thread-safe, so the flush must be done by the collector's thread (or while it's not collecting). Rates can be
+ *   computed by the caller from the difference between consecutive aggregates
+ */
+
+/**
+ * @namespace pcpp
+ * @brief The main namespace for the PcapPlusPlus lib
+ */
+namespace pcpp
+{
+
+	/**
+	 * The default max number of flows tracked by a single collector
+	 */
+	#define PCPP_TRAFFIC_STATS_DEFAULT_MAX_FLOWS (1 << 20)
+
+	namespace internal
+	{
+		/**
+		 * @class TrafficStatsFlowTable
+		 * An open-addressing hash table (linear probing, backward-shift deletion) that maps a flow key to the flow state of a
+		 * traffic stats collector. It grows by doubling until it holds the max number of flows. For internal use only
+		 */
+		template<typename TFlowData>
+		class TrafficStatsFlowTable
+		{
+		public:
+			TrafficStatsFlowTable(size_t maxFlows) : m_MaxFlows(maxFlows), m_NumOfFlows(0) { m_Slots.resize(1024); }
+
+			TFlowData* find(uint32_t key)
+			{
+				size_t mask = m_Slots.size() - 1;
+				for (size_t index = key & mask; m_Slots[index].used; index = (index + 1) & mask)
+				{
+					if (m_Slots[index].key == key)
+						return &m_Slots[index].data;
+				}
+
+				return NULL;
+			}
+
+			TFlowData* insert(uint32_t key)
+			{
+				if (m_MaxFlows != 0 && m_NumOfFlows >= m_MaxFlows)
+					return NULL;
+
+				// keep the load factor under 1/2
+				if ((m_NumOfFlows + 1) * 2 > m_Slots.size())
+					grow();
+
+				size_t mask = m_Slots.size() - 1;
+				size_t index = key & mask;
+				while (m_Slots[index].used)
+					index = (index + 1) & mask;
+
+				m_Slots[index].used = true;
+				m_Slots[index].key = key;
+				m_Slots[index].data = TFlowData();
+				m_NumOfFlows++;
+				return &m_Slots[index].data;
+			}
+
+			void remove(uint32_t key)
+			{
+				size_t mask = m_Slots.size() - 1;
+				size_t index = key & mask;
+				while (m_Slots[index].used && m_Slots[index].key != key)
+					index = (index + 1) & mask;
+
+				if (!m_Slots[index].used)
+					return;
+
+				// move back entries that were displaced past the removed slot so no probe sequence is cut
+				size_t next = (index + 1) & mask;
+				while (m_Slots[next].used)
+				{
+					size_t home = m_Slots[next].key & mask;
+					if (((next - home) & mask) >= ((next - index) & mask))
+					{
+						m_Slots[index] = m_Slots[next];
+						index = next;
+					}
+					next = (next + 1) & mask;
+				}
+
+				m_Slots[index].used = false;
+				m_NumOfFlows--;
+			}
+
+			size_t size() const { return m_NumOfFlows; }
+
+			void clear()
+			{
+				m_Slots.clear();
+				m_Slots.resize(1024);
+				m_NumOfFlows = 0;
+			}
+
+		private:
+			struct Slot
+			{
+				uint32_t key;
+				bool used;
+				TFlowData data;
+
+				Slot() : key(0), used(false) {}
+			};
+
+			std::vector<Slot> m_Slots;
+			size_t m_MaxFlows;
+			size_t m_NumOfFlows;
+
+			void grow()
+			{
+				std::vector<Slot> oldSlots;
+				oldSlots.swap(m_Slots);
+				m_Slots.resize(oldSlots.size() * 2);
+				size_t mask = m_Slots.size() - 1;
+				for (size_t i = 0; i < oldSlots.size(); i++)
+				{
+					if (!oldSlots[i].used)
+						continue;
+
+					size_t index = oldSlots[i].key & mask;
+					while (m_Slots[index].used)
+						index = (index + 1) & mask;
+					m_Slots[index] = oldSlots[i];
+				}
+			}
+		};
+	} // namespace internal
+
+
+	/**
+	 * @struct HttpTrafficStats
+	 * HTTP traffic stats, as collected by HttpTrafficStatsCollector
+	 */
+	struct HttpTrafficStats
+	{
+		/** The number of HTTP packets (TCP packets to or from the HTTP port) */
+		uint64_t numOfPackets;
+		/** The total TCP payload size of HTTP packets in bytes */
+		uint64_t payloadBytes;
+		/** The number of HTTP flows */
+		uint64_t numOfFlows;
+		/** The number of flows with at least one HTTP pipelining transaction */
+		uint64_t numOfPipeliningFlows;
+		/** The number of HTTP transactions (a request and its response) */
+		uint64_t numOfTransactions;
+		/** The number of packets that weren't tracked in the flow table because it was full */
+		uint64_t numOfUntrackedPackets;
+
+		/** The number of HTTP requests */
+		uint64_t numOfRequests;
+		/** The total size of HTTP request headers in bytes */
+		uint64_t requestHeaderBytes;
+		/** The number of requests per HTTP method, indexed by pcpp#HttpRequestLayer#HttpMethod */
+		uint64_t methodCount[HttpRequestLayer::HttpMethodUnknown + 1];
+		/** The number of requests per value of the "Host" field */
+		StringCounterTable hostnameCount;
+
+		/** The number of HTTP responses */
+		uint64_t numOfResponses;
+		/** The total size of HTTP response headers in bytes */
+		uint64_t responseHeaderBytes;
+		/** The number of responses with a "Content-Length" field */
+		uint64_t numOfResponsesWithContentLength;
+		/** The sum of "Content-Length" values of responses */
+		uint64_t totalContentLength;
+		/** The number of responses per status code, indexed by the code as a number (for example 200). Other codes are counted at 0 */
+		uint64_t statusCodeCount[600];
+		/** The number of responses per value of the "Content-Type" field without parameters (for example "text/html") */
+		StringCounterTable contentTypeCount;
+
+		/**
+		 * A c'tor that zeroes all stats
+		 */
+		HttpTrafficStats() { clear(); }
+
+		/**
+		 * Zero all stats
+		 */
+		void clear();
+
+		/**
+		 * Add the stats of another instance to this instance
+		 * @param[in] other The stats to add
+		 */
+		void merge(const HttpTrafficStats& other);
+	};
+
+
+	/**
+	 * @class HttpTrafficStatsCollector
+	 * Collects HTTP traffic stats of the packets it's given. Please refer to the documentation at the top of TrafficStatsCollectors.h to
+	 * understand how to use it with multiple capture cores
+	 */
+	class HttpTrafficStatsCollector
+	{
+	public:
+
+		/**
+		 * A c'tor for this class
+		 * @param[in] httpPort The TCP port of HTTP servers. The default is 80
+		 * @param[in] maxFlows The max number of flows to track at the same time. 0 means no limit.
+		 * The default is PCPP_TRAFFIC_STATS_DEFAULT_MAX_FLOWS
+		 */
+		HttpTrafficStatsCollector(uint16_t httpPort = 80, size_t maxFlows = PCPP_TRAFFIC_STATS_DEFAULT_MAX_FLOWS);
+
+		/**
+		 * Collect the stats of a packet. Packets that aren't TCP packets to or from the HTTP port are ignored
+		 * @param[in] packet The packet
+		 */
+		void collectStats(Packet& packet);
+
+		/**
+		 * @return The stats collected since the collector was created, cleared or last flushed
+		 */
+		const HttpTrafficStats& getStats() const { return m_Stats; }
+
+		/**
+		 * Add the stats collected since the last flush to an aggregate and zero them. The flow state is kept
+		 * @param[in,out] aggregate The stats to add to
+		 */
+		void flushStats(HttpTrafficStats& aggregate);
+
+		/**
+		 * @return The number of flows currently tracked
+		 */
+		size_t getNumOfTrackedFlows() const { return m_FlowTable.size(); }
+
+		/**
+		 * Zero the stats and forget all flows
+		 */
+		void clear();
+
+	private:
+		struct FlowData
+		{
+			int numOfOpenTransactions;
+			ProtocolType lastSeenMessage;
+			bool pipeliningFlow;
+			uint8_t finMask;
+			uint32_t curSeqNumberRequests;
+			uint32_t curSeqNumberResponses;
+
+			FlowData() : numOfOpenTransactions(0), lastSeenMessage(UnknownProtocol), pipeliningFlow(false), finMask(0), curSeqNumberRequests(0), curSeqNumberResponses(0) {}
+		};
+
+		HttpTrafficStats m_Stats;
+		internal::TrafficStatsFlowTable<FlowData> m_FlowTable;
+		uint16_t m_HttpPort;
+
+		void collectMessageStats(FlowData* flowData, HttpMessage* message, uint32_t seqNumber);
+		void collectRequestStats(HttpRequestLayer* request);
+		void collectResponseStats(HttpResponseLayer* response);
+	};
+
+
+	/**
+	 * @struct SSLTrafficStats
+	 * SSL/TLS traffic stats, as collected by SSLTrafficStatsCollector
+	 */
+	struct SSLTrafficStats
+	{
+		/** The number of SSL/TLS packets */
+		uint64_t numOfPackets;
+		/** The total TCP payload size of SSL/TLS packets in bytes */
+		uint64_t payloadBytes;
+		/** The number of SSL/TLS flows */
+		uint64_t numOfFlows;
+		/** The number of flows whose handshake was completed (an application data record was seen) */
+		uint64_t numOfHandshakeCompleteFlows;
+		/** The number of flows with at least one alert record */
+		uint64_t numOfFlowsWithAlerts;
+		/** The number of packets that weren't tracked in the flow table because it was full */
+		uint64_t numOfUntrackedPackets;
+		/** The number of flows per server port */
+		std::map<uint16_t, uint64_t> portCount;
+		/** The number of server-hello messages per handshake version (as returned by pcpp#SSLVersion#asUInt()) */
+		std::map<uint16_t, uint64_t> versionCount;
+
+		/** The number of client-hello messages */
+		uint64_t numOfClientHellos;
+		/** The number of client-hello messages per server name (SNI) */
+		StringCounterTable serverNameCount;
+
+		/** The number of server-hello messages */
+		uint64_t numOfServerHellos;
+		/**
+		 * The number of server-hello messages per cipher suite ID. The cipher suite can be retrieved with
+		 * pcpp#SSLCipherSuite#getCipherSuiteByID()
+		 */
+		std::map<uint16_t, uint64_t> cipherSuiteCount;
+
+		/**
+		 * A c'tor that zeroes all stats
+		 */
+		SSLTrafficStats() { clear(); }
+
+		/**
+		 * Zero all stats
+		 */
+		void clear();
+
+		/**
+		 * Add the stats of another instance to this instance
+		 * @param[in] other The stats to add
+		 */
+		void merge(const SSLTrafficStats& other);
+	};
+
+
+	/**
+	 * @class SSLTrafficStatsCollector
+	 * Collects SSL/TLS traffic stats of the packets it's given. Please refer to the documentation at the top of TrafficStatsCollectors.h
+	 * to understand how to use it with multiple capture cores
+	 */
+	class SSLTrafficStatsCollector
+	{
+	public:
+
+		/**
+		 * A c'tor for this class
+		 * @param[in] maxFlows The max number of flows to track at the same time. 0 means no limit.
+		 * The default is PCPP_TRAFFIC_STATS_DEFAULT_MAX_FLOWS
+		 */
+		SSLTrafficStatsCollector(size_t maxFlows = PCPP_TRAFFIC_STATS_DEFAULT_MAX_FLOWS);
+
+		/**
+		 * Collect the stats of a packet. Packets that aren't SSL/TLS packets are ignored
+		 * @param[in] packet The packet
+		 */
+		void collectStats(Packet& packet);
+
+		/**
+		 * @return The stats collected since the collector was created, cleared or last flushed
+		 */
+		const SSLTrafficStats& getStats() const { return m_Stats; }
+
+		/**
+		 * Add the stats collected since the last flush to an aggregate and zero them. The flow state is kept
+		 * @param[in,out] aggregate The stats to add to
+		 */
+		void flushStats(SSLTrafficStats& aggregate);
+
+		/**
+		 * @return The number of flows currently tracked
+		 */
+		size_t getNumOfTrackedFlows() const { return m_FlowTable.size(); }
+
+		/**
+		 * Zero the stats and forget all flows
+		 */
+		void clear();
+
+	private:
+		struct FlowData
+		{
+			bool seenAppData;
+			bool seenAlert;
+			uint8_t finMask;
+
+			FlowData() : seenAppData(false), seenAlert(false), finMask(0) {}
+		};
+
+		SSLTrafficStats m_Stats;
+		internal::TrafficStatsFlowTable<FlowData> m_FlowTable;
+	};
+
+} // namespace pcpp
+
+#endif /* PACKETPP_TRAFFIC_STATS_COLLECTORS */
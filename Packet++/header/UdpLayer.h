@@ -37,6 +37,10 @@ namespace pcpp
 	class UdpLayer : public Layer
 	{
 	public:
+		/** %UdpLayer instances carry ::UDP, see Layer#LayerProtocol */
+		static const ProtocolType LayerProtocol = UDP;
+		typedef UdpLayer LayerProtocolClass;
+
 		/**
 		 * A constructor that creates the layer from an existing packet raw data
 		 * @param[in] data A pointer to the raw data (will be casted to @ref udphdr)
@@ -87,6 +91,9 @@ namespace pcpp
 		std::string toString() const;
 
 		OsiModelLayer getOsiModelLayer() const { return OsiModelTransportLayer; }
+
+	private:
+		Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new UdpLayer(data, m_DataLen, prevLayer, packet); }
 	};
 
 } // namespace pcpp
@@ -42,6 +42,10 @@ namespace pcpp
 	class VlanLayer : public Layer
 	{
 	public:
+		/** %VlanLayer instances carry ::VLAN, see Layer#LayerProtocol */
+		static const ProtocolType LayerProtocol = VLAN;
+		typedef VlanLayer LayerProtocolClass;
+
 		 /** A constructor that creates the layer from an existing packet raw data
 		 * @param[in] data A pointer to the raw data
 		 * @param[in] dataLen Size of the data in bytes
@@ -129,6 +133,9 @@ namespace pcpp
 		std::string toString() const;
 
 		OsiModelLayer getOsiModelLayer() const { return OsiModelDataLinkLayer; }
+
+	private:
+		Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new VlanLayer(data, m_DataLen, prevLayer, packet); }
 	};
 
 } // namespace pcpp
@@ -0,0 +1,436 @@
+#ifndef PACKETPP_VOIP_CALL_TRACKER
+#define PACKETPP_VOIP_CALL_TRACKER
+
+#include "Packet.h"
+#include "IpAddress.h"
+#include <map>
+#include <vector>
+#include <string>
+
+/**
+ * @file
+ * This file includes a VoIP call tracking engine that correlates SIP signalling with the RTP media streams of each call and measures
+ * the quality of these streams.<BR>
+ *
+ * The logic works as follows:
+ * - SIP dialogs are tracked by their Call-ID. An INVITE request opens a new call; provisional, final and BYE/CANCEL messages move it
+ *   through its states (see pcpp#VoipCall#CallState). A call ends when it's hung up (BYE), cancelled (CANCEL), rejected (a final response
+ *   of 300 or above to the INVITE) or when it's purged for being idle. Ended calls are reported to the user through a callback and freed
+ * - The SDP body of SIP messages is scanned for media descriptions: every 'm=' line together with its 'c=' line (either the media-level
+ *   or the session-level one) describes an endpoint (IP address + UDP port) where one of the parties expects to receive media. The clock
+ *   rate of the stream is taken from the matching 'a=rtpmap' attribute
+ * - Learned media endpoints are stored in a hash table that is keyed by the destination IP address and port, so matching a UDP packet to
+ *   its stream costs a single hash computation and (usually) a single comparison, regardless of the number of tracked calls. SIP messages
+ *   are much rarer than RTP packets, so the per-dialog lookup by Call-ID uses an ordinary map
+ * - Each RTP packet updates the statistics of its stream: packet and byte counters, sequence number tracking (including wrap-around) to
+ *   find lost packets, sequence gaps and out-of-order packets, and the interarrival jitter as defined in RFC 3550 section 6.4.1
+ *
+ * Note that only packets with both a SIP layer and a Call-ID header are treated as signalling, so SIP must be parsed by Packet++
+ * (by default it's detected on UDP/TCP ports 5060 and 5061)
+ */
+
+/**
+ * @namespace pcpp
+ * @brief The main namespace for the PcapPlusPlus lib
+ */
+namespace pcpp
+{
+
+	class VoipCall;
+	class VoipCallTracker;
+
+	/**
+	 * @class RtpStream
+	 * Represents a unidirectional RTP stream towards a media endpoint learned from SDP, and holds its quality metrics. Instances of this
+	 * class are created and owned by pcpp#VoipCall and cannot be created or copied by the user
+	 */
+	class RtpStream
+	{
+		friend class VoipCall;
+		friend class VoipCallTracker;
+	public:
+
+		/**
+		 * @return The IP address the stream is sent to
+		 */
+		const IPAddress& getDstIP() const { return m_DstIP; }
+
+		/**
+		 * @return The UDP port the stream is sent to
+		 */
+		uint16_t getDstPort() const { return m_DstPort; }
+
+		/**
+		 * @return The media type as it appears in the SDP 'm=' line, for example: "audio" or "video"
+		 */
+		const std::string& getMediaType() const { return m_MediaType; }
+
+		/**
+		 * @return The RTP clock rate of the stream in Hz
+		 */
+		uint32_t getClockRate() const { return m_ClockRate; }
+
+		/**
+		 * @return True if the endpoint of this stream was announced by the caller (so the stream flows from the callee to the caller),
+		 * false if it was announced by the callee
+		 */
+		bool isTowardsCaller() const { return m_TowardsCaller; }
+
+		/**
+		 * @return The synchronization source (SSRC) of the latest RTP packet, or 0 if no RTP packets were seen yet
+		 */
+		uint32_t getSsrc() const { return m_Ssrc; }
+
+		/**
+		 * @return The payload type of the latest RTP packet
+		 */
+		uint8_t getPayloadType() const { return m_PayloadType; }
+
+		/**
+		 * @return The number of RTP packets received
+		 */
+		uint64_t getNumOfPackets() const { return m_NumOfPackets; }
+
+		/**
+		 * @return The number of RTP bytes (RTP header and payload) received
+		 */
+		uint64_t getNumOfBytes() const { return m_NumOfBytes; }
+
+		/**
+		 * @return The number of lost packets: the number of packets expected according to the sequence numbers minus the number of
+		 * packets received. Late packets reduce this number, and it never goes below 0
+		 */
+		uint64_t getNumOfLostPackets() const;
+
+		/**
+		 * @return The number of times the sequence number jumped forward by more than one, i.e the number of bursts of lost packets
+		 */
+		uint64_t getNumOfSequenceGaps() const { return m_NumOfSequenceGaps; }
+
+		/**
+		 * @return The number of packets that arrived with a sequence number lower than or equal to the highest one seen so far (late
+		 * or duplicate packets)
+		 */
+		uint64_t getNumOfOutOfOrderPackets() const { return m_NumOfOutOfOrderPackets; }
+
+		/**
+		 * @return The number of times the SSRC of the stream changed
+		 */
+		uint32_t getNumOfSsrcChanges() const { return m_NumOfSsrcChanges; }
+
+		/**
+		 * @return The current interarrival jitter (RFC 3550) in milliseconds
+		 */
+		double getJitterMsec() const { return m_Jitter * 1000.0 / m_ClockRate; }
+
+		/**
+		 * @return The highest interarrival jitter (RFC 3550) measured along the stream in milliseconds
+		 */
+		double getMaxJitterMsec() const { return m_MaxJitter * 1000.0 / m_ClockRate; }
+
+		/**
+		 * @return The capture time of the first RTP packet of the stream. Zero if no RTP packets were seen yet
+		 */
+		timespec getFirstPacketTime() const { return m_FirstPacketTime; }
+
+		/**
+		 * @return The capture time of the last RTP packet of the stream. Zero if no RTP packets were seen yet
+		 */
+		timespec getLastPacketTime() const { return m_LastPacketTime; }
+
+		/**
+		 * @return The call this stream belongs to
+		 */
+		const VoipCall* getCall() const { return m_Call; }
+
+	private:
+
+		IPAddress m_DstIP;
+		uint16_t m_DstPort;
+		std::string m_MediaType;
+		uint32_t m_ClockRate;
+		bool m_TowardsCaller;
+
+		// RTP sequence and jitter tracking
+		bool m_Initialized;
+		uint32_t m_Ssrc;
+		uint8_t m_PayloadType;
+		uint16_t m_BaseSeq;
+		uint16_t m_MaxSeq;
+		uint32_t m_Cycles;
+		uint64_t m_ReceivedSinceSsrcChange;
+		uint64_t m_LostBeforeSsrcChange;
+		uint32_t m_LastTransit;
+		double m_Jitter;
+		double m_MaxJitter;
+
+		uint64_t m_NumOfPackets;
+		uint64_t m_NumOfBytes;
+		uint64_t m_NumOfSequenceGaps;
+		uint64_t m_NumOfOutOfOrderPackets;
+		uint32_t m_NumOfSsrcChanges;
+		timespec m_FirstPacketTime;
+		timespec m_LastPacketTime;
+
+		// media endpoint hash table data
+		VoipCall* m_Call;
+		RtpStream* m_NextInBucket;
+		uint32_t m_Hash;
+		uint8_t m_KeyAddr[16];
+		uint8_t m_KeyAddrLen;
+		bool m_IsInTable;
+
+		RtpStream(VoipCall* call, const IPAddress& dstIP, uint16_t dstPort, const std::string& mediaType, uint32_t clockRate, bool towardsCaller);
+
+		// private copy c'tor and assignment operator
+		RtpStream(const RtpStream& other);
+		RtpStream& operator=(const RtpStream& other);
+
+		void processRtpPacket(const uint8_t* data, size_t dataLen, const timespec& arrivalTime);
+	};
+
+
+	/**
+	 * @class VoipCall
+	 * Represents a single call (SIP dialog) tracked by pcpp#VoipCallTracker, and holds its RTP streams. Instances of this class are created
+	 * and owned by pcpp#VoipCallTracker and cannot be created or copied by the user
+	 */
+	class VoipCall
+	{
+		friend class VoipCallTracker;
+	public:
+
+		/**
+		 * @enum CallState
+		 * The state of a call
+		 */
+		enum CallState
+		{
+			/** An INVITE was sent and no provisional response (other than 100 Trying) was received yet */
+			CallStateInviting,
+			/** The callee is alerting (a 18x provisional response was received) */
+			CallStateRinging,
+			/** The call was answered (a 2xx response to the INVITE was received) */
+			CallStateEstablished,
+			/** The call was hung up by a BYE request */
+			CallStateTerminated,
+			/** The call was cancelled by a CANCEL request before it was answered */
+			CallStateCancelled,
+			/** The call was rejected or failed (a final response of 300 or above to the INVITE was received) */
+			CallStateFailed,
+			/** The call was purged by VoipCallTracker#purgeIdleCalls() or VoipCallTracker#endAllCalls() */
+			CallStateTimedOut
+		};
+
+		~VoipCall();
+
+		/**
+		 * @return The value of the Call-ID header of the dialog
+		 */
+		const std::string& getCallId() const { return m_CallId; }
+
+		/**
+		 * @return The value of the From header of the INVITE request
+		 */
+		const std::string& getFrom() const { return m_From; }
+
+		/**
+		 * @return The value of the To header of the INVITE request
+		 */
+		const std::string& getTo() const { return m_To; }
+
+		/**
+		 * @return The current call state
+		 */
+		CallState getState() const { return m_State; }
+
+		/**
+		 * @return The capture time of the INVITE request
+		 */
+		timespec getStartTime() const { return m_StartTime; }
+
+		/**
+		 * @return The capture time of the 2xx response to the INVITE. Zero if the call wasn't answered
+		 */
+		timespec getAnswerTime() const { return m_AnswerTime; }
+
+		/**
+		 * @return The capture time of the message that ended the call. Zero if the call didn't end yet
+		 */
+		timespec getEndTime() const { return m_EndTime; }
+
+		/**
+		 * @return The capture time of the last SIP message or RTP packet of this call
+		 */
+		timespec getLastActivityTime() const { return m_LastActivityTime; }
+
+		/**
+		 * @return The number of RTP streams learned for this call
+		 */
+		size_t getNumOfStreams() const { return m_Streams.size(); }
+
+		/**
+		 * Get an RTP stream by index
+		 * @param[in] index The stream index
+		 * @return A pointer to the stream or NULL if index is out of bounds
+		 */
+		const RtpStream* getStream(size_t index) const { return (index < m_Streams.size() ? m_Streams[index] : NULL); }
+
+	private:
+
+		std::string m_CallId;
+		std::string m_From;
+		std::string m_To;
+		CallState m_State;
+		timespec m_StartTime;
+		timespec m_AnswerTime;
+		timespec m_EndTime;
+		timespec m_LastActivityTime;
+		std::vector<RtpStream*> m_Streams;
+
+		VoipCall(const std::string& callId, const std::string& from, const std::string& to, const timespec& startTime);
+
+		// private copy c'tor and assignment operator
+		VoipCall(const VoipCall& other);
+		VoipCall& operator=(const VoipCall& other);
+	};
+
+
+	/**
+	 * @class VoipCallTracker
+	 * Tracks SIP calls and the quality of their RTP streams. Please refer to the documentation at the top of VoipCallTracker.h to understand
+	 * how this mechanism works. The main APIs are:
+	 * - VoipCallTracker#processPacket() - feed a packet (SIP, RTP or any other) into the tracker
+	 * - VoipCallTracker#getCall() / VoipCallTracker#getCalls() / VoipCallTracker#findStream() - query the calls currently tracked
+	 * - VoipCallTracker#purgeIdleCalls() - end calls whose signalling was missed or that stopped sending media
+	 *
+	 * Whenever a call ends the OnCallEnd callback is invoked with the final state of the call and its streams, and right after that the
+	 * call is freed
+	 */
+	class VoipCallTracker
+	{
+	public:
+
+		/**
+		 * @enum ProcessResult
+		 * The result of processing a single packet
+		 */
+		enum ProcessResult
+		{
+			/** The packet is a SIP message */
+			SipPacketProcessed,
+			/** The packet is an RTP packet that belongs to a tracked stream */
+			RtpPacketProcessed,
+			/** The packet isn't SIP and isn't sent to any tracked media endpoint */
+			PacketNotTracked
+		};
+
+		/**
+		 * @typedef OnCallEnd
+		 * A callback invoked when a call ends, right before it is freed
+		 * @param[in] call The call that ended
+		 * @param[in] userCookie A pointer to the cookie provided by the user in VoipCallTracker c'tor (or NULL if no cookie provided)
+		 */
+		typedef void (*OnCallEnd)(const VoipCall* call, void* userCookie);
+
+		/** The default maximum number of concurrently tracked calls */
+		static const size_t DefaultMaxNumOfCalls = 100000;
+
+		/**
+		 * A c'tor for this class
+		 * @param[in] onCallEnd The callback to invoke when a call ends. Default is NULL (no callback)
+		 * @param[in] userCookie A pointer to an object provided by the user that will be passed to the callback. Default is NULL
+		 * @param[in] maxNumOfCalls The maximum number of concurrently tracked calls. INVITEs for new calls beyond this number are ignored.
+		 * Default is 100,000
+		 */
+		VoipCallTracker(OnCallEnd onCallEnd = NULL, void* userCookie = NULL, size_t maxNumOfCalls = DefaultMaxNumOfCalls);
+
+		/**
+		 * A d'tor for this class. Frees all tracked calls without invoking the callback
+		 */
+		~VoipCallTracker();
+
+		/**
+		 * Process a packet: if it's a SIP message it updates the call it belongs to (and may start or end a call), if it's a UDP packet sent
+		 * to a tracked media endpoint it's parsed as RTP and updates the stream statistics. Any other packet is ignored
+		 * @param[in] packet The packet to process
+		 * @return The processing result
+		 */
+		ProcessResult processPacket(Packet* packet);
+
+		/**
+		 * Find a call by its Call-ID
+		 * @param[in] callId The Call-ID to look for
+		 * @return A pointer to the call or NULL if no such call is tracked
+		 */
+		const VoipCall* getCall(const std::string& callId) const;
+
+		/**
+		 * Get all calls currently tracked
+		 * @param[out] calls A vector the calls are appended to
+		 */
+		void getCalls(std::vector<const VoipCall*>& calls) const;
+
+		/**
+		 * @return The number of calls currently tracked
+		 */
+		size_t getNumOfCalls() const { return m_CallMap.size(); }
+
+		/**
+		 * @return The number of media endpoints currently tracked
+		 */
+		size_t getNumOfMediaEndpoints() const { return m_NumOfEndpoints; }
+
+		/**
+		 * Find the RTP stream sent to a certain media endpoint
+		 * @param[in] dstIP The endpoint IP address
+		 * @param[in] dstPort The endpoint UDP port
+		 * @return A pointer to the stream or NULL if this endpoint isn't tracked
+		 */
+		const RtpStream* findStream(const IPAddress& dstIP, uint16_t dstPort) const;
+
+		/**
+		 * End all calls that had no SIP message or RTP packet since a certain time. The state of these calls is set to
+		 * VoipCall#CallStateTimedOut and the OnCallEnd callback is invoked for each of them
+		 * @param[in] lastActivityThreshold Calls whose last activity time is earlier than this time are ended. Usually it's the current
+		 * capture time minus some timeout
+		 * @return The number of calls that were ended
+		 */
+		size_t purgeIdleCalls(const timespec& lastActivityThreshold);
+
+		/**
+		 * End all tracked calls, for example: at the end of a capture file. The state of these calls is set to VoipCall#CallStateTimedOut
+		 * and the OnCallEnd callback is invoked for each of them
+		 */
+		void endAllCalls();
+
+	private:
+
+		typedef std::map<std::string, VoipCall*> CallMap;
+
+		CallMap m_CallMap;
+		size_t m_MaxNumOfCalls;
+		OnCallEnd m_OnCallEnd;
+		void* m_CallbackUserCookie;
+
+		std::vector<RtpStream*> m_EndpointTable;
+		size_t m_NumOfEndpoints;
+
+		// private copy c'tor and assignment operator
+		VoipCallTracker(const VoipCallTracker& other);
+		VoipCallTracker& operator=(const VoipCallTracker& other);
+
+		void processSipMessage(Packet* packet, const timespec& timestamp);
+		void learnMediaEndpoints(VoipCall* call, Packet* packet, bool announcedByCaller);
+		void addStream(VoipCall* call, const IPAddress& dstIP, uint16_t dstPort, const std::string& mediaType, uint32_t clockRate, bool towardsCaller);
+		void endCall(CallMap::iterator iter, VoipCall::CallState state, const timespec& endTime);
+
+		RtpStream* lookupEndpoint(const uint8_t* addr, uint8_t addrLen, uint16_t port, uint32_t hash) const;
+		void insertEndpoint(RtpStream* stream);
+		void removeEndpoint(RtpStream* stream);
+		void growEndpointTable();
+	};
+
+} // namespace pcpp
+
+#endif // PACKETPP_VOIP_CALL_TRACKER
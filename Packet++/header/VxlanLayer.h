@@ -73,6 +73,10 @@ namespace pcpp
 	class VxlanLayer : public Layer
 	{
 	public:
+		/** %VxlanLayer instances carry ::VXLAN, see Layer#LayerProtocol */
+		static const ProtocolType LayerProtocol = VXLAN;
+		typedef VxlanLayer LayerProtocolClass;
+
 		 /** A constructor that creates the layer from an existing packet raw data
 		 * @param[in] data A pointer to the raw data
 		 * @param[in] dataLen Size of the data in bytes
@@ -138,6 +142,8 @@ namespace pcpp
 
 		OsiModelLayer getOsiModelLayer() const { return OsiModelDataLinkLayer; }
 
+	private:
+		Layer* cloneToPacket(uint8_t* data, Layer* prevLayer, Packet* packet) const { return new VxlanLayer(data, m_DataLen, prevLayer, packet); }
 	};
 
 }
@@ -41,7 +41,8 @@ DhcpOption DhcpOptionBuilder::build() const
 
 DhcpLayer::DhcpLayer(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet) : Layer(data, dataLen, prevLayer, packet)
 {
-	 m_Protocol = DHCP;
+	m_Protocol = DHCP;
+	m_OptionReader.enableRecordIndex(true);
 }
 
 void DhcpLayer::initDhcpLayer(size_t numOfBytesToAllocate)
@@ -50,6 +51,7 @@ void DhcpLayer::initDhcpLayer(size_t numOfBytesToAllocate)
 	m_Data = new uint8_t[numOfBytesToAllocate];
 	memset(m_Data, 0, numOfBytesToAllocate);
 	m_Protocol = DHCP;
+	m_OptionReader.enableRecordIndex(true);
 }
 
 DhcpLayer::DhcpLayer() : Layer()
@@ -204,6 +206,11 @@ DhcpOption DhcpLayer::getOptionData(DhcpOptionTypes option) const
 	return m_OptionReader.getTLVRecord((uint8_t)option, getOptionsBasePtr(), getHeaderLen() - sizeof(dhcp_header));
 }
 
+size_t DhcpLayer::getOptionsData(const DhcpOptionTypes* optionTypes, size_t numOfOptionTypes, std::vector<DhcpOption>& result) const
+{
+	return m_OptionReader.getTLVRecords(optionTypes, numOfOptionTypes, result, getOptionsBasePtr(), getHeaderLen() - sizeof(dhcp_header));
+}
+
 DhcpOption DhcpLayer::getFirstOptionData() const
 {
 	return m_OptionReader.getFirstTLVRecord(getOptionsBasePtr(), getHeaderLen() - sizeof(dhcp_header));
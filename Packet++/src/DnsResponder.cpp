@@ -0,0 +1,441 @@
+#define LOG_MODULE PacketLogModuleDnsResponder
+
+#include "DnsResponder.h"
+#include "EthLayer.h"
+#include "VlanLayer.h"
+#include "IPv4Layer.h"
+#include "IPv6Layer.h"
+#include "UdpLayer.h"
+#include "DnsLayer.h"
+#include "StringCounterTable.h"
+#include "Logger.h"
+#include "SystemUtils.h"
+#include <string.h>
+
+namespace pcpp
+{
+
+#define PCPP_DNS_RESPONDER_MAX_NAME_LEN 255
+#define PCPP_DNS_RESPONDER_MAX_UDP_DNS_LEN 512
+// a compression pointer to the question name, which always starts right after the DNS header
+#define PCPP_DNS_RESPONDER_QUESTION_NAME_POINTER 0xc00c
+#define PCPP_DNS_RESPONDER_NAME_ERROR 3
+
+// the one's complement sum of data as 16-bit big-endian words, where the first byte is the high byte of a word
+static uint16_t onesComplementSum(const uint8_t* data, size_t dataLen)
+{
+	uint32_t sum = 0;
+	size_t i = 0;
+	for (; i + 1 < dataLen; i += 2)
+		sum += (uint32_t)((data[i] << 8) | data[i + 1]);
+	if (i < dataLen)
+		sum += (uint32_t)(data[i] << 8);
+
+	while (sum >> 16)
+		sum = (sum & 0xffff) + (sum >> 16);
+	return (uint16_t)sum;
+}
+
+// the one's complement sum of data that starts at an even or odd offset of the checksummed data. Starting at an odd offset swaps the
+// bytes of every word, which swaps the bytes of the sum
+static uint16_t onesComplementSumAt(const uint8_t* data, size_t dataLen, bool oddOffset)
+{
+	uint16_t sum = onesComplementSum(data, dataLen);
+	return (oddOffset ? (uint16_t)((sum << 8) | (sum >> 8)) : sum);
+}
+
+// incremental checksum update as described in RFC 1624: HC' = ~(~HC + ~m + m')
+static uint16_t updateChecksum(uint16_t checksum, uint16_t removedSum, uint16_t addedSum)
+{
+	uint32_t sum = (uint16_t)~checksum;
+	sum += (uint16_t)~removedSum;
+	sum += addedSum;
+	while (sum >> 16)
+		sum = (sum & 0xffff) + (sum >> 16);
+	return (uint16_t)~sum;
+}
+
+static uint16_t addSums(uint16_t first, uint16_t second)
+{
+	uint32_t sum = (uint32_t)first + second;
+	return (uint16_t)((sum & 0xffff) + (sum >> 16));
+}
+
+// names are compared in ASCII lowercase (RFC 4343), independent of the locale
+static inline uint8_t asciiToLower(uint8_t c)
+{
+	return ((c >= 'A' && c <= 'Z') ? (uint8_t)(c + ('a' - 'A')) : c);
+}
+
+// convert a name like "www.example.com" to lowercase DNS wire format. Returns false if the name is invalid
+static bool encodeName(const std::string& name, std::string& encodedName)
+{
+	encodedName.clear();
+	size_t labelStart = 0;
+	while (labelStart < name.length())
+	{
+		size_t labelEnd = name.find('.', labelStart);
+		if (labelEnd == std::string::npos)
+			labelEnd = name.length();
+
+		size_t labelLen = labelEnd - labelStart;
+		if (labelLen == 0 || labelLen > 63)
+			return false;
+
+		encodedName.push_back((char)labelLen);
+		for (size_t i = labelStart; i < labelEnd; i++)
+			encodedName.push_back((char)asciiToLower((uint8_t)name[i]));
+
+		labelStart = labelEnd + 1;
+	}
+
+	encodedName.push_back('\0');
+	return encodedName.length() <= PCPP_DNS_RESPONDER_MAX_NAME_LEN;
+}
+
+static uint32_t answerSetHash(uint32_t nameHash, uint16_t dnsType)
+{
+	return nameHash ^ ((uint32_t)dnsType * 0x9e3779b1U);
+}
+
+DnsResponder::DnsResponder(bool authoritative, uint16_t dnsPort) :
+		m_NumOfRecords(0), m_Authoritative(authoritative), m_NameErrorForUnknownNames(false), m_DnsPort(dnsPort)
+{
+	encodeName("*", m_WildcardName);
+	m_WildcardHash = PrehashedString::hashString(m_WildcardName.c_str(), m_WildcardName.length());
+	rebuildIndex(64);
+}
+
+void DnsResponder::clear()
+{
+	m_AnswerSets.clear();
+	m_NumOfRecords = 0;
+	rebuildIndex(64);
+}
+
+void DnsResponder::rebuildIndex(size_t capacity)
+{
+	m_Index.assign(capacity, -1);
+	size_t mask = capacity - 1;
+	for (size_t i = 0; i < m_AnswerSets.size(); i++)
+	{
+		size_t slot = answerSetHash(m_AnswerSets[i].nameHash, m_AnswerSets[i].dnsType) & mask;
+		while (m_Index[slot] != -1)
+			slot = (slot + 1) & mask;
+		m_Index[slot] = (int)i;
+	}
+}
+
+const DnsResponder::AnswerSet* DnsResponder::findAnswerSet(const uint8_t* name, size_t nameLen, uint32_t nameHash, uint16_t dnsType) const
+{
+	size_t mask = m_Index.size() - 1;
+	for (size_t slot = answerSetHash(nameHash, dnsType) & mask; m_Index[slot] != -1; slot = (slot + 1) & mask)
+	{
+		const AnswerSet& answerSet = m_AnswerSets[m_Index[slot]];
+		if (answerSet.nameHash == nameHash && answerSet.dnsType == dnsType && answerSet.name.length() == nameLen &&
+				memcmp(answerSet.name.c_str(), name, nameLen) == 0)
+			return &answerSet;
+	}
+
+	return NULL;
+}
+
+bool DnsResponder::addRecord(const std::string& name, DnsType dnsType, uint32_t ttl, const uint8_t* data, size_t dataLen)
+{
+	std::string encodedName;
+	if (!encodeName(name, encodedName))
+	{
+		LOG_ERROR("Invalid record name '%s'", name.c_str());
+		return false;
+	}
+
+	// name pointer, type, class, TTL, data length
+	const size_t recordHeaderLen = 2 + 2 + 2 + 4 + 2;
+	if (dataLen > 0xffff || recordHeaderLen + dataLen > PCPP_DNS_RESPONDER_MAX_UDP_DNS_LEN)
+	{
+		LOG_ERROR("Record data of '%s' is too long (%d bytes)", name.c_str(), (int)dataLen);
+		return false;
+	}
+
+	uint32_t nameHash = PrehashedString::hashString(encodedName.c_str(), encodedName.length());
+	AnswerSet* answerSet = (AnswerSet*)findAnswerSet((const uint8_t*)encodedName.c_str(), encodedName.length(), nameHash, (uint16_t)dnsType);
+	if (answerSet == NULL)
+	{
+		// keep the load factor of the index under 1/2
+		if ((m_AnswerSets.size() + 1) * 2 > m_Index.size())
+			rebuildIndex(m_Index.size() * 2);
+
+		m_AnswerSets.push_back(AnswerSet());
+		answerSet = &m_AnswerSets.back();
+		answerSet->name = encodedName;
+		answerSet->nameHash = nameHash;
+		answerSet->dnsType = (uint16_t)dnsType;
+		answerSet->numOfAnswers = 0;
+		answerSet->checksumSum = 0;
+
+		size_t mask = m_Index.size() - 1;
+		size_t slot = answerSetHash(nameHash, (uint16_t)dnsType) & mask;
+		while (m_Index[slot] != -1)
+			slot = (slot + 1) & mask;
+		m_Index[slot] = (int)(m_AnswerSets.size() - 1);
+	}
+
+	uint8_t recordHeader[recordHeaderLen];
+	uint16_t namePointer = hostToNet16(PCPP_DNS_RESPONDER_QUESTION_NAME_POINTER);
+	uint16_t netType = hostToNet16((uint16_t)dnsType);
+	uint16_t netClass = hostToNet16((uint16_t)DNS_CLASS_IN);
+	uint32_t netTtl = hostToNet32(ttl);
+	uint16_t netDataLen = hostToNet16((uint16_t)dataLen);
+	memcpy(recordHeader, &namePointer, 2);
+	memcpy(recordHeader + 2, &netType, 2);
+	memcpy(recordHeader + 4, &netClass, 2);
+	memcpy(recordHeader + 6, &netTtl, 4);
+	memcpy(recordHeader + 10, &netDataLen, 2);
+
+	answerSet->answers.insert(answerSet->answers.end(), recordHeader, recordHeader + recordHeaderLen);
+	answerSet->answers.insert(answerSet->answers.end(), data, data + dataLen);
+	answerSet->numOfAnswers++;
+	answerSet->checksumSum = onesComplementSum(&answerSet->answers[0], answerSet->answers.size());
+	m_NumOfRecords++;
+
+	return true;
+}
+
+bool DnsResponder::addARecord(const std::string& name, uint32_t ttl, const IPv4Address& address)
+{
+	return addRecord(name, DNS_TYPE_A, ttl, address.toBytes(), 4);
+}
+
+bool DnsResponder::addAAAARecord(const std::string& name, uint32_t ttl, const IPv6Address& address)
+{
+	return addRecord(name, DNS_TYPE_AAAA, ttl, address.toBytes(), 16);
+}
+
+bool DnsResponder::addNameRecord(const std::string& name, DnsType dnsType, uint32_t ttl, const std::string& targetName)
+{
+	std::string encodedTarget;
+	if (!encodeName(targetName, encodedTarget))
+	{
+		LOG_ERROR("Invalid target name '%s'", targetName.c_str());
+		return false;
+	}
+
+	return addRecord(name, dnsType, ttl, (const uint8_t*)encodedTarget.c_str(), encodedTarget.length());
+}
+
+DnsResponder::ResponseResult DnsResponder::createResponse(RawPacket& rawPacket, size_t bufferCapacity) const
+{
+	if (rawPacket.getLinkLayerType() != LINKTYPE_ETHERNET)
+		return NotSupportedQuery;
+
+	uint8_t* data = (uint8_t*)rawPacket.getRawData();
+	size_t rawDataLen = (size_t)rawPacket.getRawDataLen();
+
+	// Ethernet and VLAN tags
+
+	if (rawDataLen < sizeof(ether_header))
+		return NotSupportedQuery;
+
+	size_t offset = sizeof(ether_header);
+	uint16_t etherType = netToHost16(((ether_header*)data)->etherType);
+	while (etherType == PCPP_ETHERTYPE_VLAN)
+	{
+		if (offset + sizeof(vlan_header) > rawDataLen)
+			return NotSupportedQuery;
+
+		etherType = netToHost16(((vlan_header*)(data + offset))->etherType);
+		offset += sizeof(vlan_header);
+	}
+
+	// IPv4 or IPv6
+
+	iphdr* ipv4Header = NULL;
+	ip6_hdr* ipv6Header = NULL;
+	size_t ipHeaderLen = 0;
+	if (etherType == PCPP_ETHERTYPE_IP)
+	{
+		if (offset + sizeof(iphdr) > rawDataLen)
+			return NotSupportedQuery;
+
+		ipv4Header = (iphdr*)(data + offset);
+		ipHeaderLen = ipv4Header->internetHeaderLength * 4;
+		if (ipv4Header->ipVersion != 4 || ipHeaderLen < sizeof(iphdr) || ipv4Header->protocol != PACKETPP_IPPROTO_UDP ||
+				(netToHost16(ipv4Header->fragmentOffset) & 0x3fff) != 0 || offset + netToHost16(ipv4Header->totalLength) > rawDataLen)
+			return NotSupportedQuery;
+	}
+	else if (etherType == PCPP_ETHERTYPE_IPV6)
+	{
+		if (offset + sizeof(ip6_hdr) > rawDataLen)
+			return NotSupportedQuery;
+
+		ipv6Header = (ip6_hdr*)(data + offset);
+		ipHeaderLen = sizeof(ip6_hdr);
+		if (ipv6Header->ipVersion != 6 || ipv6Header->nextHeader != PACKETPP_IPPROTO_UDP ||
+				offset + ipHeaderLen + netToHost16(ipv6Header->payloadLength) > rawDataLen)
+			return NotSupportedQuery;
+	}
+	else
+		return NotSupportedQuery;
+
+	offset += ipHeaderLen;
+
+	// UDP
+
+	if (offset + sizeof(udphdr) > rawDataLen)
+		return NotSupportedQuery;
+
+	udphdr* udpHeader = (udphdr*)(data + offset);
+	size_t udpLen = netToHost16(udpHeader->length);
+	if (netToHost16(udpHeader->portDst) != m_DnsPort || udpLen < sizeof(udphdr) + sizeof(dnshdr) || offset + udpLen > rawDataLen)
+		return NotSupportedQuery;
+
+	offset += sizeof(udphdr);
+
+	// DNS header: a standard query with one question
+
+	dnshdr* dnsHeader = (dnshdr*)(data + offset);
+	if (dnsHeader->queryOrResponse != 0 || dnsHeader->opcode != 0 || dnsHeader->numberOfQuestions != hostToNet16(1) ||
+			dnsHeader->numberOfAnswers != 0 || dnsHeader->numberOfAuthority != 0)
+		return NotSupportedQuery;
+
+	size_t dnsOffset = offset;
+	size_t dnsLen = udpLen - sizeof(udphdr);
+
+	// the question: parse the name and convert it to lowercase to look it up
+
+	uint8_t lowercaseName[PCPP_DNS_RESPONDER_MAX_NAME_LEN];
+	size_t nameLen = 0;
+	size_t nameOffset = sizeof(dnshdr);
+	while (true)
+	{
+		if (nameOffset >= dnsLen)
+			return NotSupportedQuery;
+
+		uint8_t labelLen = data[dnsOffset + nameOffset];
+		// compression pointers aren't expected in the question of a query
+		if ((labelLen & 0xc0) != 0 || nameLen + 1 + labelLen > PCPP_DNS_RESPONDER_MAX_NAME_LEN || nameOffset + 1 + labelLen > dnsLen)
+			return NotSupportedQuery;
+
+		lowercaseName[nameLen++] = labelLen;
+		nameOffset++;
+		if (labelLen == 0)
+			break;
+
+		for (uint8_t i = 0; i < labelLen; i++)
+			lowercaseName[nameLen++] = asciiToLower(data[dnsOffset + nameOffset + i]);
+		nameOffset += labelLen;
+	}
+
+	size_t questionEnd = nameOffset + 2 * sizeof(uint16_t);
+	if (questionEnd > dnsLen)
+		return NotSupportedQuery;
+
+	uint16_t dnsType = netToHost16(*(uint16_t*)(data + dnsOffset + nameOffset));
+	uint16_t dnsClass = netToHost16(*(uint16_t*)(data + dnsOffset + nameOffset + sizeof(uint16_t)));
+	if (dnsClass != DNS_CLASS_IN)
+		return NotSupportedQuery;
+
+	const AnswerSet* answerSet = findAnswerSet(lowercaseName, nameLen, PrehashedString::hashString((const char*)lowercaseName, nameLen), dnsType);
+	if (answerSet == NULL)
+		answerSet = findAnswerSet((const uint8_t*)m_WildcardName.c_str(), m_WildcardName.length(), m_WildcardHash, dnsType);
+	if (answerSet == NULL && !m_NameErrorForUnknownNames)
+		return NoMatchingRecords;
+
+	size_t answersLen = (answerSet != NULL ? answerSet->answers.size() : 0);
+	size_t newDnsLen = questionEnd + answersLen;
+	if (newDnsLen > PCPP_DNS_RESPONDER_MAX_UDP_DNS_LEN)
+		return ResponseTooLarge;
+
+	// from here on the packet is changed
+
+	size_t newUdpLen = sizeof(udphdr) + newDnsLen;
+	uint16_t udpChecksum = netToHost16(udpHeader->headerChecksum);
+	// the UDP checksum covers the UDP length twice: in the pseudo header and in the UDP header
+	uint16_t udpRemovedSum = addSums((uint16_t)udpLen, (uint16_t)udpLen);
+	uint16_t udpAddedSum = addSums((uint16_t)newUdpLen, (uint16_t)newUdpLen);
+	udpRemovedSum = addSums(udpRemovedSum, onesComplementSum((uint8_t*)dnsHeader, sizeof(dnshdr)));
+	// the question ends at an odd offset of the UDP data if the name length is odd
+	bool questionEndOdd = ((sizeof(udphdr) + questionEnd) % 2) != 0;
+	udpRemovedSum = addSums(udpRemovedSum, onesComplementSumAt(data + dnsOffset + questionEnd, dnsLen - questionEnd, questionEndOdd));
+
+	// swap the addresses and the ports. The checksums don't change since they're sums of the same words in a different order
+
+	ether_header* ethHeader = (ether_header*)data;
+	uint8_t macAddress[6];
+	memcpy(macAddress, ethHeader->srcMac, sizeof(macAddress));
+	memcpy(ethHeader->srcMac, ethHeader->dstMac, sizeof(macAddress));
+	memcpy(ethHeader->dstMac, macAddress, sizeof(macAddress));
+
+	if (ipv4Header != NULL)
+	{
+		uint32_t ipAddress = ipv4Header->ipSrc;
+		ipv4Header->ipSrc = ipv4Header->ipDst;
+		ipv4Header->ipDst = ipAddress;
+
+		size_t totalLen = netToHost16(ipv4Header->totalLength);
+		size_t newTotalLen = ipHeaderLen + newUdpLen;
+		ipv4Header->totalLength = hostToNet16((uint16_t)newTotalLen);
+		ipv4Header->headerChecksum = hostToNet16(updateChecksum(netToHost16(ipv4Header->headerChecksum), (uint16_t)totalLen, (uint16_t)newTotalLen));
+	}
+	else
+	{
+		uint8_t ipAddress[16];
+		memcpy(ipAddress, ipv6Header->ipSrc, sizeof(ipAddress));
+		memcpy(ipv6Header->ipSrc, ipv6Header->ipDst, sizeof(ipAddress));
+		memcpy(ipv6Header->ipDst, ipAddress, sizeof(ipAddress));
+		ipv6Header->payloadLength = hostToNet16((uint16_t)newUdpLen);
+	}
+
+	uint16_t port = udpHeader->portSrc;
+	udpHeader->portSrc = udpHeader->portDst;
+	udpHeader->portDst = port;
+	udpHeader->length = hostToNet16((uint16_t)newUdpLen);
+
+	// the DNS header: keep the transaction ID and the recursion desired flag
+
+	dnsHeader->queryOrResponse = 1;
+	dnsHeader->authoritativeAnswer = (m_Authoritative ? 1 : 0);
+	dnsHeader->truncation = 0;
+	dnsHeader->recursionAvailable = 0;
+	dnsHeader->zero = 0;
+	dnsHeader->authenticData = 0;
+	dnsHeader->checkingDisabled = 0;
+	dnsHeader->responseCode = (answerSet != NULL ? 0 : PCPP_DNS_RESPONDER_NAME_ERROR);
+	dnsHeader->numberOfAnswers = hostToNet16(answerSet != NULL ? answerSet->numOfAnswers : 0);
+	dnsHeader->numberOfAdditional = 0;
+	udpAddedSum = addSums(udpAddedSum, onesComplementSum((uint8_t*)dnsHeader, sizeof(dnshdr)));
+
+	if (answerSet != NULL)
+		udpAddedSum = addSums(udpAddedSum, questionEndOdd ? (uint16_t)((answerSet->checksumSum << 8) | (answerSet->checksumSum >> 8)) : answerSet->checksumSum);
+
+	// a zero UDP checksum over IPv4 means no checksum
+	if (udpChecksum != 0 || ipv6Header != NULL)
+	{
+		uint16_t newUdpChecksum = updateChecksum(udpChecksum, udpRemovedSum, udpAddedSum);
+		udpHeader->headerChecksum = hostToNet16(newUdpChecksum == 0 ? 0xffff : newUdpChecksum);
+	}
+
+	// cut the packet after the question (this also removes Ethernet padding) and append the answers
+
+	size_t cutOffset = dnsOffset + questionEnd;
+	if (cutOffset < rawDataLen && !rawPacket.removeData((int)cutOffset, rawDataLen - cutOffset))
+		return BufferError;
+
+	if (answerSet != NULL)
+	{
+		if (cutOffset + answersLen > rawDataLen && cutOffset + answersLen > bufferCapacity)
+		{
+			if (!rawPacket.reallocateData(cutOffset + answersLen))
+			{
+				LOG_ERROR("Couldn't extend the packet buffer to %d bytes", (int)(cutOffset + answersLen));
+				return BufferError;
+			}
+		}
+
+		rawPacket.appendData(&answerSet->answers[0], answersLen);
+	}
+
+	return (answerSet != NULL ? ResponseCreated : NameErrorResponseCreated);
+}
+
+} // namespace pcpp
@@ -17,7 +17,7 @@ EthDot3Layer::EthDot3Layer(const MacAddress& sourceMac, const MacAddress& destMa
 	destMac.copyTo(ethHdr->dstMac);
 	sourceMac.copyTo(ethHdr->srcMac);
 	ethHdr->length = be16toh(length);
-	m_Protocol = Ethernet;
+	m_Protocol = EthernetDot3;
 }
 
 void EthDot3Layer::parseNextLayer()
@@ -0,0 +1,432 @@
+#define LOG_MODULE PacketLogModuleIPFragmentation
+
+#include "IPFragmentation.h"
+#include "IPv4Layer.h"
+#include "IPv6Layer.h"
+#include "IPv6Extensions.h"
+#include "Logger.h"
+#include <string.h>
+#include "EndianPortable.h"
+#ifdef _MSC_VER
+#include "SystemUtils.h"
+#endif
+
+namespace pcpp
+{
+
+#define PCPP_IPV4_MAX_HEADER_LEN 60
+#define PCPP_IPV4_FRAG_MORE_FRAGMENTS 0x2000
+#define PCPP_IPV4_FRAG_DONT_FRAGMENT  0x4000
+#define PCPP_IPV4_FRAG_OFFSET_MASK    0x1fff
+#define PCPP_IPV4_OPT_COPIED_FLAG     0x80
+
+struct IPFragmentation::FragmentationPlan
+{
+	ProtocolType ipProtocol;
+
+	const uint8_t* linkLayerData;
+	size_t linkLayerLen;
+
+	const uint8_t* payload;
+	size_t payloadLen;
+	size_t firstChunkSize;
+	size_t chunkSize;
+	int numOfFragments;
+
+	// offset (in bytes) of the original packet in case it's already an IPv4 fragment, and whether it had "more fragments" flag set
+	size_t baseOffset;
+	bool moreFragmentsAfterLast;
+
+	// IPv4: header templates for the first fragment and for the rest of the fragments, and the one's complement sum of each
+	uint8_t firstHeader[PCPP_IPV4_MAX_HEADER_LEN];
+	size_t firstHeaderLen;
+	uint32_t firstHeaderSum;
+	uint8_t otherHeader[PCPP_IPV4_MAX_HEADER_LEN];
+	size_t otherHeaderLen;
+	uint32_t otherHeaderSum;
+
+	// IPv6: the unfragmentable part is copied from the original packet and the next header field of its last header is patched
+	const uint8_t* unfragmentablePart;
+	size_t unfragmentablePartLen;
+	size_t nextHeaderFieldOffset;
+	uint8_t originalNextHeader;
+	uint32_t fragmentId;
+
+	size_t getFragmentPayloadOffset(int fragIndex) const
+	{
+		return (fragIndex == 0 ? 0 : firstChunkSize + (fragIndex - 1) * chunkSize);
+	}
+
+	size_t getFragmentPayloadLen(int fragIndex) const
+	{
+		size_t offset = getFragmentPayloadOffset(fragIndex);
+		size_t maxLen = (fragIndex == 0 ? firstChunkSize : chunkSize);
+		return (payloadLen - offset < maxLen ? payloadLen - offset : maxLen);
+	}
+
+	size_t getFragmentLen(int fragIndex) const
+	{
+		size_t headerLen;
+		if (ipProtocol == IPv4)
+			headerLen = (fragIndex == 0 ? firstHeaderLen : otherHeaderLen);
+		else
+			headerLen = unfragmentablePartLen + sizeof(IPv6FragmentationHeader::ipv6_frag_header);
+
+		return linkLayerLen + headerLen + getFragmentPayloadLen(fragIndex);
+	}
+};
+
+
+// sums 16-bit words (in host byte order) of a buffer whose length is even, without folding or inverting the result
+static uint32_t sumHeaderWords(const uint8_t* data, size_t len)
+{
+	uint32_t sum = 0;
+	for (size_t i = 0; i + 1 < len; i += 2)
+		sum += ((uint32_t)data[i] << 8) | data[i+1];
+
+	return sum;
+}
+
+static uint16_t foldChecksum(uint32_t sum)
+{
+	while (sum >> 16)
+		sum = (sum & 0xffff) + (sum >> 16);
+
+	return (uint16_t)~sum;
+}
+
+static size_t roundDownTo8(size_t value)
+{
+	return value & ~((size_t)7);
+}
+
+
+IPFragmentation::IPFragmentation(size_t mtu) :
+	m_Mtu(mtu), m_MaxFragmentPayloadSize(0), m_IgnoreDontFragment(false)
+{
+	// start IPv6 fragment IDs from a value that is hard to predict
+	timeval time;
+	gettimeofday(&time, NULL);
+	m_NextIPv6FragmentId = (uint32_t)time.tv_sec ^ ((uint32_t)time.tv_usec << 12);
+}
+
+int IPFragmentation::createPlan(Packet* packet, FragmentationPlan& plan) const
+{
+	// find the first (outermost) IP layer
+	Layer* ipLayer = packet->getFirstLayer();
+	while (ipLayer != NULL && ipLayer->getProtocol() != IPv4 && ipLayer->getProtocol() != IPv6)
+		ipLayer = ipLayer->getNextLayer();
+
+	if (ipLayer == NULL)
+		return 0;
+
+	const uint8_t* ipData = ipLayer->getData();
+	plan.ipProtocol = ipLayer->getProtocol();
+	plan.linkLayerData = packet->getRawPacketReadOnly()->getRawData();
+	plan.linkLayerLen = (size_t)(ipData - plan.linkLayerData);
+
+	size_t headerLen = 0;
+	size_t ipLen = 0;
+
+	if (plan.ipProtocol == IPv4)
+	{
+		const iphdr* ipHdr = (const iphdr*)ipData;
+		headerLen = ipHdr->internetHeaderLength * 4;
+		if (headerLen < sizeof(iphdr) || headerLen > ipLayer->getDataLen())
+		{
+			LOG_ERROR("IPv4 header length of %d bytes is invalid, cannot fragment the packet", (int)headerLen);
+			return -1;
+		}
+
+		ipLen = be16toh(ipHdr->totalLength);
+		// total length may be 0 or wrong (TSO, truncated packets): use the data that is actually available
+		if (ipLen < headerLen || ipLen > ipLayer->getDataLen())
+			ipLen = ipLayer->getDataLen();
+
+		uint16_t fragField = be16toh(ipHdr->fragmentOffset);
+		if ((fragField & PCPP_IPV4_FRAG_DONT_FRAGMENT) != 0 && !m_IgnoreDontFragment)
+		{
+			LOG_DEBUG("Packet has the \"Don't Fragment\" flag set, not fragmenting it");
+			return -1;
+		}
+
+		plan.baseOffset = (size_t)(fragField & PCPP_IPV4_FRAG_OFFSET_MASK) * 8;
+		plan.moreFragmentsAfterLast = ((fragField & PCPP_IPV4_FRAG_MORE_FRAGMENTS) != 0);
+
+		// build the header of the first fragment: the original header with total length, flags, fragment offset and checksum zeroed
+		memcpy(plan.firstHeader, ipData, headerLen);
+		plan.firstHeaderLen = headerLen;
+		iphdr* firstHdr = (iphdr*)plan.firstHeader;
+		firstHdr->totalLength = 0;
+		firstHdr->fragmentOffset = 0;
+		firstHdr->headerChecksum = 0;
+
+		// build the header of the other fragments: same as the first but with only the options that have the "copied" flag set
+		memcpy(plan.otherHeader, plan.firstHeader, sizeof(iphdr));
+		size_t otherLen = sizeof(iphdr);
+		size_t optOffset = sizeof(iphdr);
+		while (optOffset < headerLen)
+		{
+			uint8_t optType = ipData[optOffset];
+			if (optType == (uint8_t)IPV4OPT_EndOfOptionsList)
+				break;
+
+			if (optType == (uint8_t)IPV4OPT_NOP)
+			{
+				optOffset++;
+				continue;
+			}
+
+			if (optOffset + 1 >= headerLen || ipData[optOffset+1] < 2 || optOffset + ipData[optOffset+1] > headerLen)
+				break;
+
+			uint8_t optLen = ipData[optOffset+1];
+			if ((optType & PCPP_IPV4_OPT_COPIED_FLAG) != 0)
+			{
+				memcpy(plan.otherHeader + otherLen, ipData + optOffset, optLen);
+				otherLen += optLen;
+			}
+
+			optOffset += optLen;
+		}
+
+		// pad options with zeros (end of options list) to a multiple of 4 bytes
+		while (otherLen % 4 != 0)
+			plan.otherHeader[otherLen++] = 0;
+
+		plan.otherHeaderLen = otherLen;
+		((iphdr*)plan.otherHeader)->internetHeaderLength = (uint8_t)(otherLen / 4);
+
+		plan.firstHeaderSum = sumHeaderWords(plan.firstHeader, plan.firstHeaderLen);
+		plan.otherHeaderSum = sumHeaderWords(plan.otherHeader, plan.otherHeaderLen);
+	}
+	else // IPv6
+	{
+		const ip6_hdr* ipHdr = (const ip6_hdr*)ipData;
+		ipLen = sizeof(ip6_hdr) + be16toh(ipHdr->payloadLength);
+		// payload length may be 0 (jumbogram, TSO) or wrong: use the data that is actually available
+		if (ipLen == sizeof(ip6_hdr) || ipLen > ipLayer->getDataLen())
+			ipLen = ipLayer->getDataLen();
+
+		// find the end of the unfragmentable part: the base header followed by Hop-by-Hop, Routing and the Destination Options
+		// headers that precede a Routing header
+		headerLen = sizeof(ip6_hdr);
+		plan.nextHeaderFieldOffset = (size_t)((const uint8_t*)&ipHdr->nextHeader - ipData);
+		uint8_t nextHeader = ipHdr->nextHeader;
+		size_t curOffset = sizeof(ip6_hdr);
+		while ((nextHeader == IPv6Extension::IPv6HopByHop || nextHeader == IPv6Extension::IPv6Routing || nextHeader == IPv6Extension::IPv6Destination)
+				&& curOffset + 2 <= ipLen)
+		{
+			size_t extLen = 8 * ((size_t)ipData[curOffset+1] + 1);
+			if (curOffset + extLen > ipLen)
+				break;
+
+			if (nextHeader != IPv6Extension::IPv6Destination)
+			{
+				headerLen = curOffset + extLen;
+				plan.nextHeaderFieldOffset = curOffset;
+			}
+
+			nextHeader = ipData[curOffset];
+			curOffset += extLen;
+		}
+
+		plan.originalNextHeader = ipData[plan.nextHeaderFieldOffset];
+		if (plan.originalNextHeader == IPv6Extension::IPv6Fragmentation)
+		{
+			LOG_ERROR("Packet is already an IPv6 fragment, cannot fragment it again");
+			return -1;
+		}
+
+		plan.unfragmentablePart = ipData;
+		plan.unfragmentablePartLen = headerLen;
+		plan.baseOffset = 0;
+		plan.moreFragmentsAfterLast = false;
+		plan.fragmentId = m_NextIPv6FragmentId;
+	}
+
+	plan.payload = ipData + headerLen;
+	plan.payloadLen = ipLen - headerLen;
+
+	// check if fragmentation is needed at all and calculate the payload size carried by each fragment
+	if (m_MaxFragmentPayloadSize > 0)
+	{
+		if (plan.payloadLen <= m_MaxFragmentPayloadSize)
+			return 0;
+
+		plan.firstChunkSize = roundDownTo8(m_MaxFragmentPayloadSize);
+		plan.chunkSize = plan.firstChunkSize;
+	}
+	else
+	{
+		if (ipLen <= m_Mtu)
+			return 0;
+
+		if (plan.ipProtocol == IPv4)
+		{
+			plan.firstChunkSize = (m_Mtu > plan.firstHeaderLen ? roundDownTo8(m_Mtu - plan.firstHeaderLen) : 0);
+			plan.chunkSize = (m_Mtu > plan.otherHeaderLen ? roundDownTo8(m_Mtu - plan.otherHeaderLen) : 0);
+		}
+		else
+		{
+			size_t fragHeadersLen = plan.unfragmentablePartLen + sizeof(IPv6FragmentationHeader::ipv6_frag_header);
+			plan.firstChunkSize = (m_Mtu > fragHeadersLen ? roundDownTo8(m_Mtu - fragHeadersLen) : 0);
+			plan.chunkSize = plan.firstChunkSize;
+		}
+	}
+
+	if (plan.firstChunkSize == 0 || plan.chunkSize == 0)
+	{
+		LOG_ERROR("MTU of %d bytes is too small to fragment the packet", (int)m_Mtu);
+		return -1;
+	}
+
+	if (plan.baseOffset + plan.payloadLen > (size_t)PCPP_IPV4_FRAG_OFFSET_MASK * 8 + 8)
+	{
+		LOG_ERROR("Fragment offset exceeds the maximum value");
+		return -1;
+	}
+
+	plan.numOfFragments = 1;
+	if (plan.payloadLen > plan.firstChunkSize)
+		plan.numOfFragments += (int)((plan.payloadLen - plan.firstChunkSize + plan.chunkSize - 1) / plan.chunkSize);
+
+	return plan.numOfFragments;
+}
+
+size_t IPFragmentation::writeFragment(const FragmentationPlan& plan, int fragIndex, uint8_t* buffer) const
+{
+	size_t payloadOffset = plan.getFragmentPayloadOffset(fragIndex);
+	size_t payloadLen = plan.getFragmentPayloadLen(fragIndex);
+	bool moreFragments = (fragIndex < plan.numOfFragments - 1 || plan.moreFragmentsAfterLast);
+
+	// link-layer headers are copied as-is
+	memcpy(buffer, plan.linkLayerData, plan.linkLayerLen);
+	uint8_t* ipData = buffer + plan.linkLayerLen;
+	size_t headerLen = 0;
+
+	if (plan.ipProtocol == IPv4)
+	{
+		headerLen = (fragIndex == 0 ? plan.firstHeaderLen : plan.otherHeaderLen);
+		memcpy(ipData, (fragIndex == 0 ? plan.firstHeader : plan.otherHeader), headerLen);
+
+		uint16_t totalLength = (uint16_t)(headerLen + payloadLen);
+		uint16_t fragField = (uint16_t)((plan.baseOffset + payloadOffset) / 8);
+		if (moreFragments)
+			fragField |= PCPP_IPV4_FRAG_MORE_FRAGMENTS;
+
+		// only the fields that differ from the template are added to its pre-computed sum
+		uint32_t sum = (fragIndex == 0 ? plan.firstHeaderSum : plan.otherHeaderSum) + totalLength + fragField;
+
+		iphdr* ipHdr = (iphdr*)ipData;
+		ipHdr->totalLength = htobe16(totalLength);
+		ipHdr->fragmentOffset = htobe16(fragField);
+		ipHdr->headerChecksum = htobe16(foldChecksum(sum));
+	}
+	else // IPv6
+	{
+		memcpy(ipData, plan.unfragmentablePart, plan.unfragmentablePartLen);
+		ipData[plan.nextHeaderFieldOffset] = (uint8_t)IPv6Extension::IPv6Fragmentation;
+
+		IPv6FragmentationHeader::ipv6_frag_header* fragHdr = (IPv6FragmentationHeader::ipv6_frag_header*)(ipData + plan.unfragmentablePartLen);
+		fragHdr->nextHeader = plan.originalNextHeader;
+		fragHdr->headerLen = 0;
+		fragHdr->fragOffsetAndFlags = htobe16((uint16_t)(payloadOffset | (moreFragments ? 1 : 0)));
+		fragHdr->id = htobe32(plan.fragmentId);
+
+		headerLen = plan.unfragmentablePartLen + sizeof(IPv6FragmentationHeader::ipv6_frag_header);
+		((ip6_hdr*)ipData)->payloadLength = htobe16((uint16_t)(headerLen - sizeof(ip6_hdr) + payloadLen));
+	}
+
+	memcpy(ipData + headerLen, plan.payload + payloadOffset, payloadLen);
+
+	return plan.linkLayerLen + headerLen + payloadLen;
+}
+
+int IPFragmentation::getNumOfFragments(Packet* packet, size_t& maxFragmentLen) const
+{
+	maxFragmentLen = 0;
+
+	if (packet == NULL)
+		return 0;
+
+	FragmentationPlan plan;
+	int numOfFragments = createPlan(packet, plan);
+	if (numOfFragments <= 0)
+		return numOfFragments;
+
+	maxFragmentLen = plan.getFragmentLen(0);
+	if (numOfFragments > 1 && plan.getFragmentLen(1) > maxFragmentLen)
+		maxFragmentLen = plan.getFragmentLen(1);
+
+	return numOfFragments;
+}
+
+int IPFragmentation::fragmentPacket(Packet* packet, FragmentBuffer* fragments, int numOfFragmentBuffers)
+{
+	if (packet == NULL || fragments == NULL)
+	{
+		LOG_ERROR("Packet or fragment buffers are NULL");
+		return -1;
+	}
+
+	FragmentationPlan plan;
+	int numOfFragments = createPlan(packet, plan);
+	if (numOfFragments <= 0)
+		return numOfFragments;
+
+	if (numOfFragments > numOfFragmentBuffers)
+	{
+		LOG_ERROR("Packet requires %d fragments but only %d buffers were provided", numOfFragments, numOfFragmentBuffers);
+		return -1;
+	}
+
+	for (int i = 0; i < numOfFragments; i++)
+	{
+		if (fragments[i].data == NULL || fragments[i].capacity < plan.getFragmentLen(i))
+		{
+			LOG_ERROR("Buffer #%d is too small for fragment of %d bytes", i, (int)plan.getFragmentLen(i));
+			return -1;
+		}
+	}
+
+	for (int i = 0; i < numOfFragments; i++)
+		fragments[i].len = writeFragment(plan, i, fragments[i].data);
+
+	if (plan.ipProtocol == IPv6)
+		m_NextIPv6FragmentId++;
+
+	return numOfFragments;
+}
+
+int IPFragmentation::fragmentPacket(Packet* packet, PointerVector<RawPacket>& resultFragments)
+{
+	if (packet == NULL)
+	{
+		LOG_ERROR("Packet is NULL");
+		return -1;
+	}
+
+	FragmentationPlan plan;
+	int numOfFragments = createPlan(packet, plan);
+	if (numOfFragments <= 0)
+		return numOfFragments;
+
+	RawPacket* rawPacket = packet->getRawPacketReadOnly();
+	timespec timestamp = rawPacket->getPacketTimeStamp();
+
+	for (int i = 0; i < numOfFragments; i++)
+	{
+		size_t fragLen = plan.getFragmentLen(i);
+		uint8_t* fragData = new uint8_t[fragLen];
+		writeFragment(plan, i, fragData);
+		resultFragments.pushBack(new RawPacket(fragData, (int)fragLen, timestamp, true, rawPacket->getLinkLayerType()));
+	}
+
+	if (plan.ipProtocol == IPv6)
+		m_NextIPv6FragmentId++;
+
+	return numOfFragments;
+}
+
+} // namespace pcpp
@@ -6,6 +6,7 @@
 #include "PacketUtils.h"
 #include "Logger.h"
 #include <string.h>
+#include <algorithm>
 #include "EndianPortable.h"
 
 namespace pcpp
@@ -309,11 +310,27 @@ Packet* IPReassembly::processPacket(Packet* fragment, ReassemblyStatus& status,
 
 	IPFragmentData* fragData = NULL;
 
-	// check whether this packet already exists in the map
-	std::map<uint32_t, IPFragmentData*>::iterator iter = m_FragmentMap.find(hash);
+	// in a burst the previous fragment usually belongs to the same packet. It was already looked up and marked as used
+	if (m_InBatch && m_BatchLastFragData != NULL && m_BatchLastHash == hash)
+	{
+		fragData = m_BatchLastFragData;
+	}
+	else
+	{
+		// check whether this packet already exists in the map
+		std::map<uint32_t, IPFragmentData*>::iterator iter = m_FragmentMap.find(hash);
+		if (iter != m_FragmentMap.end())
+		{
+			// get the IPFragmentData object
+			fragData = iter->second;
+
+			// mark this packet as used
+			m_PacketLRU.put(hash, NULL);
+		}
+	}
 
 	// this is the first fragment seen for this packet
-	if (iter == m_FragmentMap.end())
+	if (fragData == NULL)
 	{
 		LOG_DEBUG("Got new packet with FragID=0x%X, allocating place in map", fragWrapper->getFragmentId());
 
@@ -323,13 +340,11 @@ Packet* IPReassembly::processPacket(Packet* fragment, ReassemblyStatus& status,
 		// add the new fragment to the map
 		addNewFragment(hash, fragData);
 	}
-	else // packet was seen before
-	{
-		// get the IPFragmentData object
-		fragData = iter->second;
 
-		// mark this packet as used
-		m_PacketLRU.put(hash, NULL);
+	if (m_InBatch)
+	{
+		m_BatchLastFragData = fragData;
+		m_BatchLastHash = hash;
 	}
 
 	bool gotLastFragment = false;
@@ -462,8 +477,9 @@ Packet* IPReassembly::processPacket(Packet* fragment, ReassemblyStatus& status,
 
 		// delete the IPFragmentData object and remove it from the map
 		delete fragData;
-		m_FragmentMap.erase(iter);
+		m_FragmentMap.erase(hash);
 		m_PacketLRU.eraseElement(hash);
+		m_BatchLastFragData = NULL;
 		status = REASSEMBLED;
 		return reassembledPacket;
 	}
@@ -485,6 +501,56 @@ Packet* IPReassembly::processPacket(RawPacket* fragment, ReassemblyStatus& statu
 	return result;
 }
 
+void IPReassembly::processPackets(Packet** fragments, size_t numOfFragments, Packet** results, ReassemblyStatus* statuses, ProtocolType parseUntil, OsiModelLayer parseUntilLayer)
+{
+	ReassemblyStatus status;
+
+	// non-fragments are returned as is, fragments are sorted by the packet they belong to. Fragments of the same packet keep their order
+	// because the index is the second sort key
+	m_BatchOrder.clear();
+	for (size_t i = 0; i < numOfFragments; i++)
+	{
+		uint32_t hash = 0;
+		if (fragments[i]->isPacketOfType(IPv4))
+		{
+			IPv4FragmentWrapper ipv4Wrapper(fragments[i]);
+			if (ipv4Wrapper.isFragment())
+				hash = ipv4Wrapper.hashPacket();
+		}
+		else if (fragments[i]->isPacketOfType(IPv6))
+		{
+			IPv6FragmentWrapper ipv6Wrapper(fragments[i]);
+			if (ipv6Wrapper.isFragment())
+				hash = ipv6Wrapper.hashPacket();
+		}
+
+		if (hash == 0)
+		{
+			results[i] = processPacket(fragments[i], status, parseUntil, parseUntilLayer);
+			if (statuses != NULL)
+				statuses[i] = status;
+			continue;
+		}
+
+		m_BatchOrder.push_back(std::make_pair(hash, i));
+	}
+
+	std::sort(m_BatchOrder.begin(), m_BatchOrder.end());
+
+	m_InBatch = true;
+	m_BatchLastFragData = NULL;
+	for (size_t i = 0; i < m_BatchOrder.size(); i++)
+	{
+		size_t fragmentIndex = m_BatchOrder[i].second;
+		results[fragmentIndex] = processPacket(fragments[fragmentIndex], status, parseUntil, parseUntilLayer);
+		if (statuses != NULL)
+			statuses[fragmentIndex] = status;
+	}
+
+	m_InBatch = false;
+	m_BatchLastFragData = NULL;
+}
+
 Packet* IPReassembly::getCurrentPacket(const PacketKey& key)
 {
 	// create a hash out of the packet key
@@ -554,6 +620,8 @@ void IPReassembly::removePacket(const PacketKey& key)
 	if (iter != m_FragmentMap.end())
 	{
 		// free all data saved in the map
+		if (iter->second == m_BatchLastFragData)
+			m_BatchLastFragData = NULL;
 		delete iter->second;
 		m_FragmentMap.erase(iter);
 
@@ -578,6 +646,8 @@ void IPReassembly::addNewFragment(uint32_t hash, IPFragmentData* fragData)
 			key = dataRemoved->packetKey->clone();
 
 		LOG_DEBUG("Reached maximum packet capacity, removing data for FragID=0x%X", dataRemoved->fragmentID);
+		if (dataRemoved == m_BatchLastFragData)
+			m_BatchLastFragData = NULL;
 		delete dataRemoved;
 		m_FragmentMap.erase(iter);
 
@@ -402,6 +402,11 @@ IPv4Option IPv4Layer::getOption(IPv4OptionTypes option) const
 	return m_OptionReader.getTLVRecord((uint8_t)option, getOptionsBasePtr(), getHeaderLen() - sizeof(iphdr));
 }
 
+size_t IPv4Layer::getOptions(const IPv4OptionTypes* optionTypes, size_t numOfOptionTypes, std::vector<IPv4Option>& result) const
+{
+	return m_OptionReader.getTLVRecords(optionTypes, numOfOptionTypes, result, getOptionsBasePtr(), getHeaderLen() - sizeof(iphdr));
+}
+
 IPv4Option IPv4Layer::getFirstOption() const
 {
 	return m_OptionReader.getFirstTLVRecord(getOptionsBasePtr(), getHeaderLen() - sizeof(iphdr));
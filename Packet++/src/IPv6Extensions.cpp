@@ -126,6 +126,11 @@ IPv6TLVOptionHeader::IPv6Option IPv6TLVOptionHeader::getOption(uint8_t optionTyp
 	return m_OptionReader.getTLVRecord(optionType, getDataPtr() + sizeof(ipv6_ext_base_header), getExtensionLen() - sizeof(ipv6_ext_base_header));
 }
 
+size_t IPv6TLVOptionHeader::getOptions(const uint8_t* optionTypes, size_t numOfOptionTypes, std::vector<IPv6Option>& result) const
+{
+	return m_OptionReader.getTLVRecords(optionTypes, numOfOptionTypes, result, getDataPtr() + sizeof(ipv6_ext_base_header), getExtensionLen() - sizeof(ipv6_ext_base_header));
+}
+
 IPv6TLVOptionHeader::IPv6Option IPv6TLVOptionHeader::getFirstOption() const
 {
 	return m_OptionReader.getFirstTLVRecord(getDataPtr() + sizeof(ipv6_ext_base_header), getExtensionLen() - sizeof(ipv6_ext_base_header));
@@ -12,7 +12,6 @@
 #include "Logger.h"
 #include "EndianPortable.h"
 #include <string.h>
-#include <typeinfo>
 #include <sstream>
 #ifdef _MSC_VER
 #include <time.h>
@@ -29,7 +28,9 @@ Packet::Packet(size_t maxPacketLen) :
 	m_LastLayer(NULL),
 	m_ProtocolTypes(UnknownProtocol),
 	m_MaxPacketLen(maxPacketLen),
-	m_FreeRawPacket(true)
+	m_FreeRawPacket(true),
+	m_SharedRawData(false),
+	m_LayerIndexMask(0)
 {
 	timeval time;
 	gettimeofday(&time, NULL);
@@ -45,8 +46,10 @@ void Packet::setRawPacket(RawPacket* rawPacket, bool freeRawPacket, ProtocolType
 	m_FirstLayer = NULL;
 	m_LastLayer = NULL;
 	m_ProtocolTypes = UnknownProtocol;
+	m_LayerIndexMask = 0;
 	m_MaxPacketLen = rawPacket->getRawDataLen();
 	m_FreeRawPacket = freeRawPacket;
+	m_SharedRawData = false;
 	m_RawPacket = rawPacket;
 	if (m_RawPacket == NULL)
 		return;
@@ -60,6 +63,7 @@ void Packet::setRawPacket(RawPacket* rawPacket, bool freeRawPacket, ProtocolType
 	while (curLayer != NULL && (curLayer->getProtocol() & parseUntil) == 0 && curLayer->getOsiModelLayer() <= parseUntilLayer)
 	{
 		m_ProtocolTypes |= curLayer->getProtocol();
+		addLayerToIndex(curLayer);
 		curLayer->parseNextLayer();
 		curLayer->m_IsAllocatedInPacket = true;
 		curLayer = curLayer->getNextLayer();
@@ -70,6 +74,7 @@ void Packet::setRawPacket(RawPacket* rawPacket, bool freeRawPacket, ProtocolType
 	if (curLayer != NULL && (curLayer->getProtocol() & parseUntil) != 0)
 	{
 		m_ProtocolTypes |= curLayer->getProtocol();
+		addLayerToIndex(curLayer);
 		curLayer->m_IsAllocatedInPacket = true;
 	}
 
@@ -97,6 +102,7 @@ void Packet::setRawPacket(RawPacket* rawPacket, bool freeRawPacket, ProtocolType
 			m_LastLayer->setNextLayer(trailerLayer);
 			m_LastLayer = trailerLayer;
 			m_ProtocolTypes |= trailerLayer->getProtocol();
+			addLayerToIndex(trailerLayer);
 		}
 	}
 }
@@ -144,24 +150,94 @@ void Packet::destructPacketData()
 
 Packet& Packet::operator=(const Packet& other)
 {
+	if (this == &other)
+		return *this;
+
 	destructPacketData();
 
-	copyDataFrom(other);
+	copyDataFrom(other, false);
 
 	return *this;
 }
 
-void Packet::copyDataFrom(const Packet& other)
+void Packet::copyDataFrom(const Packet& other, bool copyOnWrite)
 {
-	m_RawPacket = new RawPacket(*(other.m_RawPacket));
-	m_FreeRawPacket = true;
-	m_MaxPacketLen = other.m_MaxPacketLen;
+	m_FirstLayer = NULL;
+	m_LastLayer = NULL;
 	m_ProtocolTypes = other.m_ProtocolTypes;
+	m_LayerIndexMask = 0;
+	m_FreeRawPacket = true;
+	m_SharedRawData = false;
+	if (other.m_RawPacket == NULL)
+	{
+		m_RawPacket = NULL;
+		m_MaxPacketLen = 0;
+		return;
+	}
+
+	const RawPacket* otherRawPacket = other.m_RawPacket;
+	if (copyOnWrite && otherRawPacket->isRawDataRefCounted())
+	{
+		m_RawPacket = new RawPacket(*otherRawPacket, true);
+		m_SharedRawData = true;
+	}
+	else if (copyOnWrite)
+	{
+		// a RawPacket that points to the other packet's data and doesn't free it
+		m_RawPacket = new RawPacket(otherRawPacket->getRawData(), otherRawPacket->getRawDataLen(), otherRawPacket->getPacketTimeStamp(), false, otherRawPacket->getLinkLayerType());
+		m_RawPacket->setRawData(otherRawPacket->getRawData(), otherRawPacket->getRawDataLen(), otherRawPacket->getPacketTimeStamp(), otherRawPacket->getLinkLayerType(), otherRawPacket->getFrameLength());
+		m_SharedRawData = true;
+	}
+	else
+	{
+		m_RawPacket = new RawPacket(*otherRawPacket);
+	}
+
+	// the copied buffer is exactly as long as the data, so any growth reallocates it
+	m_MaxPacketLen = m_RawPacket->getRawDataLen();
+
+	// re-create the layers of the other packet over the copied data, in the same offsets and with the same types
+	const uint8_t* otherData = otherRawPacket->getRawData();
+	uint8_t* data = (uint8_t*)m_RawPacket->getRawData();
+	bool allLayersCopied = true;
+	for (Layer* otherLayer = other.m_FirstLayer; otherLayer != NULL; otherLayer = otherLayer->getNextLayer())
+	{
+		Layer* newLayer = otherLayer->cloneToPacket(data + (otherLayer->m_Data - otherData), m_LastLayer, this);
+		if (newLayer == NULL)
+		{
+			LOG_DEBUG("Layer '%s' can't be copied, parsing the packet from scratch", otherLayer->toString().c_str());
+			allLayersCopied = false;
+			break;
+		}
+
+		newLayer->m_IsAllocatedInPacket = true;
+		if (m_LastLayer == NULL)
+			m_FirstLayer = newLayer;
+		else
+			m_LastLayer->setNextLayer(newLayer);
+		m_LastLayer = newLayer;
+		addLayerToIndex(newLayer);
+	}
+
+	if (allLayersCopied)
+		return;
+
+	// one of the layers doesn't support copying, so parse the whole packet
+	Layer* curLayer = m_FirstLayer;
+	while (curLayer != NULL)
+	{
+		Layer* nextLayer = curLayer->getNextLayer();
+		delete curLayer;
+		curLayer = nextLayer;
+	}
+
+	m_LayerIndexMask = 0;
 	m_FirstLayer = createFirstLayer(m_RawPacket->getLinkLayerType());
 	m_LastLayer = m_FirstLayer;
-	Layer* curLayer = m_FirstLayer;
+	curLayer = m_FirstLayer;
 	while (curLayer != NULL)
 	{
+		addLayerToIndex(curLayer);
 		curLayer->parseNextLayer();
 		curLayer->m_IsAllocatedInPacket = true;
 		curLayer = curLayer->getNextLayer();
@@ -170,6 +246,34 @@ void Packet::copyDataFrom(const Packet& other)
 	}
 }
 
+bool Packet::makeWritable()
+{
+	if (!m_SharedRawData)
+		return true;
+
+	// copying the RawPacket copies its data into a buffer the new instance owns
+	RawPacket* newRawPacket = new RawPacket(*m_RawPacket);
+	if (newRawPacket->getRawData() == NULL)
+	{
+		LOG_ERROR("Couldn't copy the shared packet data");
+		delete newRawPacket;
+		return false;
+	}
+
+	const uint8_t* oldData = m_RawPacket->getRawData();
+	uint8_t* newData = (uint8_t*)newRawPacket->getRawData();
+	for (Layer* curLayer = m_FirstLayer; curLayer != NULL; curLayer = curLayer->getNextLayer())
+		curLayer->rebaseData(newData + (curLayer->m_Data - oldData));
+
+	if (m_FreeRawPacket)
+		delete m_RawPacket;
+
+	m_RawPacket = newRawPacket;
+	m_FreeRawPacket = true;
+	m_SharedRawData = false;
+	return true;
+}
+
 void Packet::reallocateRawData(size_t newSize)
 {
 	LOG_DEBUG("Allocating packet to new size: %d", (int)newSize);
@@ -190,8 +294,9 @@ void Packet::reallocateRawData(size_t newSize)
 	Layer* curLayer = m_FirstLayer;
 	while (curLayer != NULL)
 	{
-		LOG_DEBUG("Setting new data pointer to layer '%s'", typeid(curLayer).name());
-		curLayer->m_Data = (uint8_t*)dataPtr;
+		// the old data was already freed so nothing that reads the layer data can be logged here
+		LOG_DEBUG("Setting new data pointer to layer of protocol 0x%llX", (unsigned long long)curLayer->getProtocol());
+		curLayer->rebaseData((uint8_t*)dataPtr);
 		dataPtr += curLayer->getHeaderLen();
 		curLayer = curLayer->getNextLayer();
 	}
@@ -217,6 +322,9 @@ bool Packet::insertLayer(Layer* prevLayer, Layer* newLayer, bool ownInPacket)
 		return false;
 	}
 
+	if (!makeWritable())
+		return false;
+
 	size_t newLayerHeaderLen = newLayer->getHeaderLen();
 	if (m_RawPacket->getRawDataLen() + newLayerHeaderLen > m_MaxPacketLen)
 	{
@@ -274,10 +382,15 @@ bool Packet::insertLayer(Layer* prevLayer, Layer* newLayer, bool ownInPacket)
 	if (m_LastLayer != NULL && m_LastLayer->getProtocol() == PacketTrailer)
 		packetTrailerLen = m_LastLayer->getDataLen();
 
+	// layers order has changed, the layer index is re-built while going over the layers
+	m_LayerIndexMask = 0;
+
 	// go over all layers from the first layer to the last layer and set the data ptr and data length for each one
 	Layer* curLayer = m_FirstLayer;
 	while (curLayer != NULL)
 	{
+		addLayerToIndex(curLayer);
+
 		// set data ptr to layer
 		curLayer->m_Data = (uint8_t*)dataPtr;
 
@@ -398,6 +511,9 @@ bool Packet::removeLayer(Layer* layer, bool tryToDelete)
 		return false;
 	}
 
+	if (!makeWritable())
+		return false;
+
 	// before removing the layer's data, copy it so it can be later assigned as the removed layer's data
 	size_t headerLen = layer->getHeaderLen();
 	size_t layerOldDataSize = headerLen;
@@ -444,9 +560,14 @@ bool Packet::removeLayer(Layer* layer, bool tryToDelete)
 	// a flag to be set if there is another layer in this packet with the same protocol
 	bool anotherLayerWithSameProtocolExists = false;
 
+	// layers order has changed, the layer index is re-built while going over the layers
+	m_LayerIndexMask = 0;
+
 	// go over all layers from the first layer to the last layer and set the data ptr and data length for each one
 	while (curLayer != NULL)
 	{
+		addLayerToIndex(curLayer);
+
 		// set data ptr to layer
 		curLayer->m_Data = (uint8_t*)dataPtr;
 
@@ -494,6 +615,16 @@ bool Packet::removeLayer(Layer* layer, bool tryToDelete)
 Layer* Packet::getLayerOfType(ProtocolType layerType, int index) const
 {
 	Layer* curLayer = getFirstLayer();
+
+	// layers before the first layer of this protocol can be skipped
+	if (isSingleProtocol(layerType))
+	{
+		if ((m_LayerIndexMask & layerType) == 0)
+			return NULL;
+
+		curLayer = m_LayerIndex[getProtocolIndex(layerType)];
+	}
+
 	int curIndex = 0;
 	while (curLayer != NULL)
 	{
@@ -525,6 +656,9 @@ bool Packet::extendLayer(Layer* layer, int offsetInLayer, size_t numOfBytesToExt
 		return false;
 	}
 
+	if (!makeWritable())
+		return false;
+
 	if (m_RawPacket->getRawDataLen() + numOfBytesToExtend > m_MaxPacketLen)
 	{
 		// reallocate to maximum value of: twice the max size of the packet or max size + new required length
@@ -585,6 +719,9 @@ bool Packet::shortenLayer(Layer* layer, int offsetInLayer, size_t numOfBytesToSh
 		return false;
 	}
 
+	if (!makeWritable())
+		return false;
+
 	// remove data from raw packet
 	int indexOfDataToRemove = layer->m_Data + offsetInLayer - m_RawPacket->getRawData();
 	if (!m_RawPacket->removeData(indexOfDataToRemove, numOfBytesToShorten))
@@ -625,6 +762,9 @@ void Packet::computeCalculateFields()
 {
 	// calculated fields should be calculated from top layer to bottom layer
 
+	if (!makeWritable())
+		return;
+
 	Layer* curLayer = m_LastLayer;
 	while (curLayer != NULL)
 	{
@@ -676,6 +816,19 @@ std::string Packet::printPacketInfo(bool timeAsLocalTime) const
 	return "Packet length: " + dataLenStream.str() + " [Bytes], Arrival time: " + std::string(buf);
 }
 
+void Packet::addLayerToIndex(Layer* layer)
+{
+	// only the first layer of each protocol is kept in the index
+	ProtocolType newProtocols = layer->getProtocol() & ~m_LayerIndexMask;
+	while (newProtocols != UnknownProtocol)
+	{
+		m_LayerIndex[getProtocolIndex(newProtocols)] = layer;
+		newProtocols &= newProtocols - 1;
+	}
+
+	m_LayerIndexMask |= layer->getProtocol();
+}
+
 Layer* Packet::createFirstLayer(LinkLayerType linkType)
 {
 	size_t rawDataLen = (size_t)m_RawPacket->getRawDataLen();
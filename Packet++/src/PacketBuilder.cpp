@@ -0,0 +1,339 @@
+#define LOG_MODULE PacketLogModulePacketBuilder
+
+#include "PacketBuilder.h"
+#include "PacketUtils.h"
+#include "Logger.h"
+#include <string.h>
+#include "EndianPortable.h"
+
+namespace pcpp
+{
+
+const size_t PacketBuilder::MaxNumOfLayers;
+
+PacketBuilder::PacketBuilder(uint8_t* buffer, size_t bufferLen) :
+	m_Buffer(buffer), m_BufferLen(bufferLen), m_OwnsBuffer(false), m_DataLen(0), m_NumOfLayers(0)
+{
+	if (m_Buffer == NULL)
+		m_BufferLen = 0;
+}
+
+PacketBuilder::PacketBuilder(size_t bufferLen) :
+	m_Buffer(NULL), m_BufferLen(bufferLen), m_OwnsBuffer(true), m_DataLen(0), m_NumOfLayers(0)
+{
+}
+
+PacketBuilder::~PacketBuilder()
+{
+	if (m_OwnsBuffer && m_Buffer != NULL)
+		delete [] m_Buffer;
+}
+
+void PacketBuilder::clear()
+{
+	m_DataLen = 0;
+	m_NumOfLayers = 0;
+}
+
+uint8_t* PacketBuilder::addLayer(ProtocolType protocol, size_t headerLen)
+{
+	if (m_NumOfLayers >= MaxNumOfLayers)
+	{
+		LOG_ERROR("Cannot add layer, packet already has %d layers", (int)MaxNumOfLayers);
+		return NULL;
+	}
+
+	if (headerLen > m_BufferLen - m_DataLen)
+	{
+		LOG_ERROR("Cannot add layer of %d bytes, only %d bytes are left in the buffer", (int)headerLen, (int)(m_BufferLen - m_DataLen));
+		return NULL;
+	}
+
+	// an owned buffer is allocated on first use, so a builder whose buffer was moved to a RawPacket allocates a new one
+	if (m_Buffer == NULL)
+		m_Buffer = new uint8_t[m_BufferLen];
+
+	uint8_t* header = m_Buffer + m_DataLen;
+	memset(header, 0, headerLen);
+
+	m_Layers[m_NumOfLayers].protocol = protocol;
+	m_Layers[m_NumOfLayers].offset = m_DataLen;
+	m_NumOfLayers++;
+	m_DataLen += headerLen;
+	return header;
+}
+
+ether_header* PacketBuilder::addEthLayer(const MacAddress& srcMac, const MacAddress& dstMac)
+{
+	ether_header* ethHeader = (ether_header*)addLayer(Ethernet, sizeof(ether_header));
+	if (ethHeader == NULL)
+		return NULL;
+
+	srcMac.copyTo(ethHeader->srcMac);
+	dstMac.copyTo(ethHeader->dstMac);
+	return ethHeader;
+}
+
+vlan_header* PacketBuilder::addVlanLayer(uint16_t vlanID, bool cfi, uint8_t priority)
+{
+	vlan_header* vlanHeader = (vlan_header*)addLayer(VLAN, sizeof(vlan_header));
+	if (vlanHeader == NULL)
+		return NULL;
+
+	vlanHeader->vlan = htobe16(((priority & 7) << 13) | ((cfi & 1) << 12) | (vlanID & 0xFFF));
+	return vlanHeader;
+}
+
+iphdr* PacketBuilder::addIPv4Layer(const IPv4Address& srcIP, const IPv4Address& dstIP, uint8_t timeToLive)
+{
+	iphdr* ipHeader = (iphdr*)addLayer(IPv4, sizeof(iphdr));
+	if (ipHeader == NULL)
+		return NULL;
+
+	ipHeader->ipVersion = 4;
+	ipHeader->internetHeaderLength = sizeof(iphdr) / 4;
+	ipHeader->timeToLive = timeToLive;
+	ipHeader->ipSrc = srcIP.toInt();
+	ipHeader->ipDst = dstIP.toInt();
+	return ipHeader;
+}
+
+ip6_hdr* PacketBuilder::addIPv6Layer(const IPv6Address& srcIP, const IPv6Address& dstIP, uint8_t hopLimit)
+{
+	ip6_hdr* ipHeader = (ip6_hdr*)addLayer(IPv6, sizeof(ip6_hdr));
+	if (ipHeader == NULL)
+		return NULL;
+
+	ipHeader->ipVersion = 6;
+	ipHeader->hopLimit = hopLimit;
+	srcIP.copyTo(ipHeader->ipSrc);
+	dstIP.copyTo(ipHeader->ipDst);
+	return ipHeader;
+}
+
+tcphdr* PacketBuilder::addTcpLayer(uint16_t portSrc, uint16_t portDst)
+{
+	tcphdr* tcpHeader = (tcphdr*)addLayer(TCP, sizeof(tcphdr));
+	if (tcpHeader == NULL)
+		return NULL;
+
+	tcpHeader->portSrc = htobe16(portSrc);
+	tcpHeader->portDst = htobe16(portDst);
+	tcpHeader->dataOffset = sizeof(tcphdr) / 4;
+	return tcpHeader;
+}
+
+udphdr* PacketBuilder::addUdpLayer(uint16_t portSrc, uint16_t portDst)
+{
+	udphdr* udpHeader = (udphdr*)addLayer(UDP, sizeof(udphdr));
+	if (udpHeader == NULL)
+		return NULL;
+
+	udpHeader->portSrc = htobe16(portSrc);
+	udpHeader->portDst = htobe16(portDst);
+	return udpHeader;
+}
+
+uint8_t* PacketBuilder::addPayload(const uint8_t* data, size_t dataLen)
+{
+	uint8_t* payload = NULL;
+
+	// consecutive payloads are merged into one layer
+	if (m_NumOfLayers > 0 && m_Layers[m_NumOfLayers - 1].protocol == GenericPayload)
+	{
+		if (dataLen > m_BufferLen - m_DataLen)
+		{
+			LOG_ERROR("Cannot add payload of %d bytes, only %d bytes are left in the buffer", (int)dataLen, (int)(m_BufferLen - m_DataLen));
+			return NULL;
+		}
+
+		payload = m_Buffer + m_DataLen;
+		memset(payload, 0, dataLen);
+		m_DataLen += dataLen;
+	}
+	else
+	{
+		payload = addLayer(GenericPayload, dataLen);
+		if (payload == NULL)
+			return NULL;
+	}
+
+	if (data != NULL)
+		memcpy(payload, data, dataLen);
+
+	return payload;
+}
+
+uint16_t PacketBuilder::computeL4Checksum(size_t layerIndex, uint8_t ipProtocol) const
+{
+	uint8_t* l4Data = m_Buffer + m_Layers[layerIndex].offset;
+	size_t l4Len = m_DataLen - m_Layers[layerIndex].offset;
+
+	// the pseudo header is built in network byte order, like the rest of the checksummed data
+	uint8_t pseudoHeader[40];
+	size_t pseudoHeaderLen = 0;
+	if (layerIndex > 0 && m_Layers[layerIndex - 1].protocol == IPv4)
+	{
+		iphdr* ipHeader = (iphdr*)(m_Buffer + m_Layers[layerIndex - 1].offset);
+		memcpy(pseudoHeader, &ipHeader->ipSrc, 4);
+		memcpy(pseudoHeader + 4, &ipHeader->ipDst, 4);
+		pseudoHeader[8] = 0;
+		pseudoHeader[9] = ipProtocol;
+		uint16_t len = htobe16((uint16_t)l4Len);
+		memcpy(pseudoHeader + 10, &len, 2);
+		pseudoHeaderLen = 12;
+	}
+	else if (layerIndex > 0 && m_Layers[layerIndex - 1].protocol == IPv6)
+	{
+		ip6_hdr* ipHeader = (ip6_hdr*)(m_Buffer + m_Layers[layerIndex - 1].offset);
+		memcpy(pseudoHeader, ipHeader->ipSrc, 16);
+		memcpy(pseudoHeader + 16, ipHeader->ipDst, 16);
+		uint32_t len = htobe32((uint32_t)l4Len);
+		memcpy(pseudoHeader + 32, &len, 4);
+		pseudoHeader[36] = 0;
+		pseudoHeader[37] = 0;
+		pseudoHeader[38] = 0;
+		pseudoHeader[39] = ipProtocol;
+		pseudoHeaderLen = 40;
+	}
+	else
+	{
+		// TCP or UDP without an IP layer, keep the checksum as 0
+		return 0;
+	}
+
+	ScalarBuffer<uint16_t> vec[2];
+	vec[0].buffer = (uint16_t*)l4Data;
+	vec[0].len = l4Len;
+	vec[1].buffer = (uint16_t*)pseudoHeader;
+	vec[1].len = pseudoHeaderLen;
+	return computeChecksum(vec, 2);
+}
+
+bool PacketBuilder::finalize()
+{
+	if (m_NumOfLayers == 0)
+	{
+		LOG_ERROR("Cannot finalize an empty packet");
+		return false;
+	}
+
+	// go from the last layer to the first so every checksum is computed over data that is already final
+	for (int i = (int)m_NumOfLayers - 1; i >= 0; i--)
+	{
+		uint8_t* layerData = m_Buffer + m_Layers[i].offset;
+		size_t layerLen = m_DataLen - m_Layers[i].offset;
+		ProtocolType nextProtocol = ((size_t)i + 1 < m_NumOfLayers ? m_Layers[i + 1].protocol : UnknownProtocol);
+
+		switch (m_Layers[i].protocol)
+		{
+		case Ethernet:
+		case VLAN:
+		{
+			uint16_t etherType = 0;
+			if (nextProtocol == IPv4)
+				etherType = PCPP_ETHERTYPE_IP;
+			else if (nextProtocol == IPv6)
+				etherType = PCPP_ETHERTYPE_IPV6;
+			else if (nextProtocol == VLAN)
+				etherType = PCPP_ETHERTYPE_VLAN;
+
+			if (etherType == 0)
+				break;
+
+			if (m_Layers[i].protocol == Ethernet)
+				((ether_header*)layerData)->etherType = htobe16(etherType);
+			else
+				((vlan_header*)layerData)->etherType = htobe16(etherType);
+			break;
+		}
+
+		case IPv4:
+		{
+			iphdr* ipHeader = (iphdr*)layerData;
+			ipHeader->totalLength = htobe16((uint16_t)layerLen);
+			if (nextProtocol == TCP)
+				ipHeader->protocol = PACKETPP_IPPROTO_TCP;
+			else if (nextProtocol == UDP)
+				ipHeader->protocol = PACKETPP_IPPROTO_UDP;
+			else if (nextProtocol == IPv4)
+				ipHeader->protocol = PACKETPP_IPPROTO_IPIP;
+			else if (nextProtocol == IPv6)
+				ipHeader->protocol = PACKETPP_IPPROTO_IPV6;
+
+			ipHeader->headerChecksum = 0;
+			ScalarBuffer<uint16_t> scalar = { (uint16_t*)ipHeader, sizeof(iphdr) };
+			ipHeader->headerChecksum = htobe16(computeChecksum(&scalar, 1));
+			break;
+		}
+
+		case IPv6:
+		{
+			ip6_hdr* ipHeader = (ip6_hdr*)layerData;
+			ipHeader->payloadLength = htobe16((uint16_t)(layerLen - sizeof(ip6_hdr)));
+			if (nextProtocol == TCP)
+				ipHeader->nextHeader = PACKETPP_IPPROTO_TCP;
+			else if (nextProtocol == UDP)
+				ipHeader->nextHeader = PACKETPP_IPPROTO_UDP;
+			else if (nextProtocol == IPv4)
+				ipHeader->nextHeader = PACKETPP_IPPROTO_IPIP;
+			else if (nextProtocol == IPv6)
+				ipHeader->nextHeader = PACKETPP_IPPROTO_IPV6;
+			break;
+		}
+
+		case TCP:
+		{
+			tcphdr* tcpHeader = (tcphdr*)layerData;
+			tcpHeader->headerChecksum = 0;
+			tcpHeader->headerChecksum = htobe16(computeL4Checksum(i, PACKETPP_IPPROTO_TCP));
+			break;
+		}
+
+		case UDP:
+		{
+			udphdr* udpHeader = (udphdr*)layerData;
+			udpHeader->length = htobe16((uint16_t)layerLen);
+			udpHeader->headerChecksum = 0;
+			uint16_t checksum = computeL4Checksum(i, PACKETPP_IPPROTO_UDP);
+			// a computed checksum of 0 is sent as 0xffff because 0 means "no checksum" in UDP
+			udpHeader->headerChecksum = htobe16(checksum == 0 ? 0xffff : checksum);
+			break;
+		}
+
+		default:
+			break;
+		}
+	}
+
+	return true;
+}
+
+bool PacketBuilder::build(RawPacket& rawPacket, timeval timestamp)
+{
+	if (!m_OwnsBuffer)
+	{
+		LOG_ERROR("Cannot move a user-provided buffer to a RawPacket, please use finalize() and the buffer instead");
+		return false;
+	}
+
+	if (!finalize())
+		return false;
+
+	rawPacket.setRawData(m_Buffer, (int)m_DataLen, timestamp, getLinkLayerType());
+
+	// the RawPacket owns the buffer now, the next packet will be built into a new buffer
+	m_Buffer = NULL;
+	clear();
+	return true;
+}
+
+LinkLayerType PacketBuilder::getLinkLayerType() const
+{
+	if (m_NumOfLayers > 0 && (m_Layers[0].protocol == IPv4 || m_Layers[0].protocol == IPv6))
+		return LINKTYPE_RAW;
+
+	return LINKTYPE_ETHERNET;
+}
+
+} // namespace pcpp
@@ -0,0 +1,661 @@
+#define LOG_MODULE PacketLogModulePacketGenerator
+
+#include "PacketGenerator.h"
+#include "IPv4Layer.h"
+#include "IPv6Layer.h"
+#include "TcpLayer.h"
+#include "UdpLayer.h"
+#include "IcmpLayer.h"
+#include "Logger.h"
+#include <string.h>
+#include <algorithm>
+#include "EndianPortable.h"
+#ifdef _MSC_VER
+#include "SystemUtils.h"
+#endif
+
+namespace pcpp
+{
+
+#define PCPP_PACKET_GENERATOR_DEFAULT_SEED 0x9e3779b9
+
+// adds the bytes of a buffer to a one's complement sum as 16-bit big-endian words. If oddAligned is true the buffer starts at an odd
+// offset of the checksummed data, so its first byte is the low byte of a word
+static uint32_t sumBytes(const uint8_t* data, size_t len, bool oddAligned)
+{
+	uint32_t sum = 0;
+	for (size_t i = 0; i < len; i++)
+	{
+		bool highByte = (((i & 1) == 0) != oddAligned);
+		sum += (highByte ? ((uint32_t)data[i] << 8) : (uint32_t)data[i]);
+	}
+
+	return sum;
+}
+
+static uint16_t foldSum(uint32_t sum)
+{
+	while (sum >> 16)
+		sum = (sum & 0xffff) + (sum >> 16);
+
+	return (uint16_t)sum;
+}
+
+static void writeBigEndian(uint8_t* dest, uint32_t value, size_t width)
+{
+	for (size_t i = width; i > 0; i--)
+	{
+		dest[i - 1] = (uint8_t)(value & 0xff);
+		value >>= 8;
+	}
+}
+
+static bool isRangeOverlapping(size_t offset1, size_t len1, size_t offset2, size_t len2)
+{
+	return offset1 < offset2 + len2 && offset2 < offset1 + len1;
+}
+
+
+PacketGenerator::PacketGenerator() :
+	m_LinkLayerType(LINKTYPE_ETHERNET), m_IPProtocol(UnknownProtocol), m_IPOffset(0), m_IPHeaderLen(0),
+	m_L4Protocol(UnknownProtocol), m_L4Offset(0), m_L4HeaderLen(0), m_PayloadOffset(0),
+	m_MinSize(0), m_MaxSize(0), m_RandomState(PCPP_PACKET_GENERATOR_DEFAULT_SEED),
+	m_Compiled(false), m_IPHeaderSum(0), m_PseudoHeaderSum(0), m_NumOfGeneratedPackets(0),
+	m_BurstBuffer(NULL), m_BurstBufferLen(0)
+{
+}
+
+PacketGenerator::~PacketGenerator()
+{
+	// the burst packets point into m_BurstBuffer and don't own their data, so they can be freed before the buffer
+	m_Burst.clear();
+	delete [] m_BurstBuffer;
+}
+
+bool PacketGenerator::setTemplate(Packet* templatePacket)
+{
+	if (templatePacket == NULL || templatePacket->getRawPacketReadOnly()->getRawDataLen() <= 0)
+	{
+		LOG_ERROR("Template packet is empty");
+		return false;
+	}
+
+	const RawPacket* rawPacket = templatePacket->getRawPacketReadOnly();
+	const uint8_t* rawData = rawPacket->getRawData();
+	m_Template.assign(rawData, rawData + rawPacket->getRawDataLen());
+	m_LinkLayerType = rawPacket->getLinkLayerType();
+
+	m_IPProtocol = UnknownProtocol;
+	m_IPOffset = m_IPHeaderLen = 0;
+	m_L4Protocol = UnknownProtocol;
+	m_L4Offset = m_L4HeaderLen = 0;
+	m_PayloadOffset = m_Template.size();
+
+	// find the outermost IP layer and the L4 layer right after it
+	for (Layer* curLayer = templatePacket->getFirstLayer(); curLayer != NULL; curLayer = curLayer->getNextLayer())
+	{
+		ProtocolType protocol = curLayer->getProtocol();
+		if (protocol != IPv4 && protocol != IPv6)
+			continue;
+
+		m_IPProtocol = protocol;
+		m_IPOffset = curLayer->getData() - rawData;
+		m_IPHeaderLen = curLayer->getHeaderLen();
+		m_PayloadOffset = m_IPOffset + m_IPHeaderLen;
+
+		Layer* l4Layer = curLayer->getNextLayer();
+		if (l4Layer != NULL)
+		{
+			ProtocolType l4Protocol = l4Layer->getProtocol();
+			if (l4Protocol == TCP || l4Protocol == UDP || (l4Protocol == ICMP && protocol == IPv4))
+			{
+				m_L4Protocol = l4Protocol;
+				m_L4Offset = l4Layer->getData() - rawData;
+				m_L4HeaderLen = (l4Protocol == ICMP ? sizeof(icmphdr) : l4Layer->getHeaderLen());
+				m_PayloadOffset = m_L4Offset + m_L4HeaderLen;
+			}
+		}
+
+		break;
+	}
+
+	if (m_PayloadOffset > m_Template.size())
+		m_PayloadOffset = m_Template.size();
+
+	m_Mutators.clear();
+	m_Compiled = false;
+	return true;
+}
+
+bool PacketGenerator::addFieldMutator(TemplateField field, MutatorType type, uint32_t minValue, uint32_t maxValue, uint32_t step)
+{
+	size_t offset = 0;
+	size_t width = 0;
+
+	switch (field)
+	{
+	case IPv4SrcIPField:
+	case IPv4DstIPField:
+	case IPv4IdField:
+		if (m_IPProtocol != IPv4)
+			break;
+		offset = m_IPOffset + (field == IPv4IdField ? 4 : (field == IPv4SrcIPField ? 12 : 16));
+		width = (field == IPv4IdField ? 2 : 4);
+		break;
+	case IPv6SrcIPField:
+	case IPv6DstIPField:
+		if (m_IPProtocol != IPv6)
+			break;
+		offset = m_IPOffset + (field == IPv6SrcIPField ? 20 : 36);
+		width = 4;
+		break;
+	case SrcPortField:
+	case DstPortField:
+		if (m_L4Protocol != TCP && m_L4Protocol != UDP)
+			break;
+		offset = m_L4Offset + (field == SrcPortField ? 0 : 2);
+		width = 2;
+		break;
+	case TcpSeqNumberField:
+	case TcpAckNumberField:
+		if (m_L4Protocol != TCP)
+			break;
+		offset = m_L4Offset + (field == TcpSeqNumberField ? 4 : 8);
+		width = 4;
+		break;
+	}
+
+	if (width == 0)
+	{
+		LOG_ERROR("Template packet doesn't contain the requested field");
+		return false;
+	}
+
+	return addFieldMutator(offset, width, type, minValue, maxValue, step);
+}
+
+bool PacketGenerator::addFieldMutator(size_t offset, size_t width, MutatorType type, uint32_t minValue, uint32_t maxValue, uint32_t step)
+{
+	if (m_Template.empty())
+	{
+		LOG_ERROR("Template wasn't set");
+		return false;
+	}
+
+	if (width != 1 && width != 2 && width != 4)
+	{
+		LOG_ERROR("Field width must be 1, 2 or 4 bytes");
+		return false;
+	}
+
+	uint32_t maxFieldValue = (width == 4 ? 0xffffffff : ((uint32_t)1 << (width * 8)) - 1);
+	if (minValue > maxValue || maxValue > maxFieldValue)
+	{
+		LOG_ERROR("Illegal value range [%u, %u] for a field of %d bytes", minValue, maxValue, (int)width);
+		return false;
+	}
+
+	if (type == IncrementMutator && step == 0)
+	{
+		LOG_ERROR("Increment step must be positive");
+		return false;
+	}
+
+	FieldMutator mutator;
+	memset(&mutator, 0, sizeof(mutator));
+	mutator.offset = offset;
+	mutator.width = width;
+	mutator.type = type;
+	mutator.minValue = minValue;
+	mutator.maxValue = maxValue;
+	mutator.step = step;
+	mutator.nextValue = minValue;
+	m_Mutators.push_back(mutator);
+
+	m_Compiled = false;
+	return true;
+}
+
+void PacketGenerator::clearFieldMutators()
+{
+	m_Mutators.clear();
+	m_Compiled = false;
+}
+
+bool PacketGenerator::setPayloadPattern(const uint8_t* pattern, size_t patternLen)
+{
+	if (pattern == NULL && patternLen > 0)
+	{
+		LOG_ERROR("Payload pattern is NULL");
+		return false;
+	}
+
+	if (patternLen == 0)
+		m_PayloadPattern.clear();
+	else
+		m_PayloadPattern.assign(pattern, pattern + patternLen);
+
+	m_Compiled = false;
+	return true;
+}
+
+bool PacketGenerator::setPacketSizeRange(size_t minSize, size_t maxSize)
+{
+	if (minSize == 0 || minSize > maxSize)
+	{
+		LOG_ERROR("Illegal packet size range [%d, %d]", (int)minSize, (int)maxSize);
+		return false;
+	}
+
+	m_Sizes.clear();
+	m_CumulativeWeights.clear();
+	m_MinSize = minSize;
+	m_MaxSize = maxSize;
+	m_Compiled = false;
+	return true;
+}
+
+bool PacketGenerator::addPacketSize(size_t size, uint32_t weight)
+{
+	if (size == 0 || weight == 0)
+	{
+		LOG_ERROR("Packet size and weight must be positive");
+		return false;
+	}
+
+	uint32_t totalWeight = (m_CumulativeWeights.empty() ? 0 : m_CumulativeWeights.back());
+	if (totalWeight + weight < totalWeight)
+	{
+		LOG_ERROR("Total weight of packet sizes is too large");
+		return false;
+	}
+
+	if (m_Sizes.empty())
+	{
+		m_MinSize = size;
+		m_MaxSize = size;
+	}
+	else
+	{
+		m_MinSize = std::min(m_MinSize, size);
+		m_MaxSize = std::max(m_MaxSize, size);
+	}
+
+	m_Sizes.push_back(size);
+	m_CumulativeWeights.push_back(totalWeight + weight);
+	m_Compiled = false;
+	return true;
+}
+
+void PacketGenerator::clearPacketSizes()
+{
+	m_Sizes.clear();
+	m_CumulativeWeights.clear();
+	m_MinSize = 0;
+	m_MaxSize = 0;
+	m_Compiled = false;
+}
+
+void PacketGenerator::setSeed(uint32_t seed)
+{
+	// xorshift can't recover from a zero state
+	m_RandomState = (seed == 0 ? PCPP_PACKET_GENERATOR_DEFAULT_SEED : seed);
+	for (std::vector<FieldMutator>::iterator iter = m_Mutators.begin(); iter != m_Mutators.end(); iter++)
+		iter->nextValue = iter->minValue;
+}
+
+size_t PacketGenerator::getMaxPacketLen() const
+{
+	if (m_MaxSize == 0)
+		return m_Template.size();
+
+	return m_MaxSize;
+}
+
+bool PacketGenerator::isOverlappingCalculatedField(size_t offset, size_t width) const
+{
+	if (m_IPProtocol == IPv4)
+	{
+		// total length and header checksum
+		if (isRangeOverlapping(offset, width, m_IPOffset + 2, 2) || isRangeOverlapping(offset, width, m_IPOffset + 10, 2))
+			return true;
+	}
+	else if (m_IPProtocol == IPv6)
+	{
+		// payload length
+		if (isRangeOverlapping(offset, width, m_IPOffset + 4, 2))
+			return true;
+	}
+
+	switch (m_L4Protocol)
+	{
+	case TCP:
+		return isRangeOverlapping(offset, width, m_L4Offset + 16, 2);
+	case UDP:
+		// length and checksum
+		return isRangeOverlapping(offset, width, m_L4Offset + 4, 4);
+	case ICMP:
+		return isRangeOverlapping(offset, width, m_L4Offset + 2, 2);
+	default:
+		return false;
+	}
+}
+
+bool PacketGenerator::compile()
+{
+	if (m_Compiled)
+		return true;
+
+	if (m_Template.empty())
+	{
+		LOG_ERROR("Template wasn't set");
+		return false;
+	}
+
+	size_t minSize = (m_MinSize == 0 ? m_Template.size() : m_MinSize);
+	size_t maxSize = getMaxPacketLen();
+
+	if (minSize < m_PayloadOffset)
+	{
+		LOG_ERROR("Minimum packet size %d is smaller than the template headers (%d bytes)", (int)minSize, (int)m_PayloadOffset);
+		return false;
+	}
+
+	if (m_IPProtocol == IPv4 && maxSize - m_IPOffset > 0xffff)
+	{
+		LOG_ERROR("Maximum packet size %d exceeds the maximum IPv4 length", (int)maxSize);
+		return false;
+	}
+
+	if (m_IPProtocol == IPv6 && maxSize - m_IPOffset - sizeof(ip6_hdr) > 0xffff)
+	{
+		LOG_ERROR("Maximum packet size %d exceeds the maximum IPv6 payload length", (int)maxSize);
+		return false;
+	}
+
+	for (std::vector<FieldMutator>::iterator iter = m_Mutators.begin(); iter != m_Mutators.end(); iter++)
+	{
+		if (iter->offset + iter->width > minSize)
+		{
+			LOG_ERROR("Mutated field at offset %d exceeds the minimum packet size %d", (int)iter->offset, (int)minSize);
+			return false;
+		}
+
+		if (isOverlappingCalculatedField(iter->offset, iter->width))
+		{
+			LOG_ERROR("Mutated field at offset %d overlaps a length or checksum field", (int)iter->offset);
+			return false;
+		}
+	}
+
+	// build the image all packets are copied from: the template followed by the payload pattern (or zeros) up to the maximum size
+	m_Image.assign(maxSize, 0);
+	memcpy(&m_Image[0], &m_Template[0], std::min(maxSize, m_Template.size()));
+	if (!m_PayloadPattern.empty())
+	{
+		for (size_t i = m_PayloadOffset; i < maxSize; i++)
+			m_Image[i] = m_PayloadPattern[(i - m_PayloadOffset) % m_PayloadPattern.size()];
+	}
+
+	// zero the fields that are written per packet so they don't take part in the precomputed sums
+	uint8_t* ipHeader = &m_Image[m_IPOffset];
+	m_IPHeaderSum = 0;
+	m_PseudoHeaderSum = 0;
+	if (m_IPProtocol == IPv4)
+	{
+		iphdr* ipv4Header = (iphdr*)ipHeader;
+		ipv4Header->totalLength = 0;
+		ipv4Header->headerChecksum = 0;
+		m_IPHeaderSum = sumBytes(ipHeader, m_IPHeaderLen, false);
+		m_PseudoHeaderSum = sumBytes((uint8_t*)&ipv4Header->ipSrc, 8, false);
+	}
+	else if (m_IPProtocol == IPv6)
+	{
+		ip6_hdr* ipv6Header = (ip6_hdr*)ipHeader;
+		ipv6Header->payloadLength = 0;
+		m_PseudoHeaderSum = sumBytes(ipv6Header->ipSrc, 32, false);
+	}
+
+	m_L4PrefixSums.clear();
+	if (m_L4Protocol != UnknownProtocol)
+	{
+		uint8_t* l4Header = &m_Image[m_L4Offset];
+		if (m_L4Protocol == TCP)
+		{
+			((tcphdr*)l4Header)->headerChecksum = 0;
+			m_PseudoHeaderSum += PACKETPP_IPPROTO_TCP;
+		}
+		else if (m_L4Protocol == UDP)
+		{
+			((udphdr*)l4Header)->length = 0;
+			((udphdr*)l4Header)->headerChecksum = 0;
+			m_PseudoHeaderSum += PACKETPP_IPPROTO_UDP;
+		}
+		else // ICMP has no pseudo header
+		{
+			((icmphdr*)l4Header)->checksum = 0;
+			m_PseudoHeaderSum = 0;
+		}
+
+		// m_L4PrefixSums[i] is the sum of the first i 16-bit words of the L4 segment
+		size_t numOfWords = (maxSize - m_L4Offset) / 2;
+		m_L4PrefixSums.resize(numOfWords + 1);
+		uint32_t sum = 0;
+		m_L4PrefixSums[0] = 0;
+		for (size_t i = 0; i < numOfWords; i++)
+		{
+			sum = foldSum(sum + ((uint32_t)l4Header[2*i] << 8) + l4Header[2*i + 1]);
+			m_L4PrefixSums[i + 1] = sum;
+		}
+	}
+
+	// find which checksums cover each mutated field and precompute the complement of the template bytes, so the checksum delta of
+	// a mutated value is simply the sum of its bytes plus this complement
+	for (std::vector<FieldMutator>::iterator iter = m_Mutators.begin(); iter != m_Mutators.end(); iter++)
+	{
+		const uint8_t* templateBytes = &m_Image[iter->offset];
+
+		iter->coveredByIPChecksum = (m_IPProtocol == IPv4 && iter->offset >= m_IPOffset && iter->offset < m_IPOffset + m_IPHeaderLen);
+		iter->ipOddAligned = (((iter->offset - m_IPOffset) & 1) != 0);
+		if (iter->coveredByIPChecksum)
+			iter->ipTemplateSumComplement = ~foldSum(sumBytes(templateBytes, iter->width, iter->ipOddAligned));
+
+		iter->coveredByL4Checksum = false;
+		if (m_L4Protocol != UnknownProtocol)
+		{
+			if (iter->offset >= m_L4Offset)
+			{
+				iter->coveredByL4Checksum = true;
+				iter->l4OddAligned = (((iter->offset - m_L4Offset) & 1) != 0);
+			}
+			else if (m_L4Protocol != ICMP)
+			{
+				// IP addresses are part of the pseudo header
+				size_t addressesOffset = m_IPOffset + (m_IPProtocol == IPv4 ? 12 : 8);
+				size_t addressesLen = (m_IPProtocol == IPv4 ? 8 : 32);
+				iter->coveredByL4Checksum = isRangeOverlapping(iter->offset, iter->width, addressesOffset, addressesLen);
+				iter->l4OddAligned = (((iter->offset - m_IPOffset) & 1) != 0);
+			}
+
+			if (iter->coveredByL4Checksum)
+				iter->l4TemplateSumComplement = ~foldSum(sumBytes(templateBytes, iter->width, iter->l4OddAligned));
+		}
+
+		iter->nextValue = iter->minValue;
+	}
+
+	m_Compiled = true;
+	return true;
+}
+
+uint32_t PacketGenerator::nextRandom()
+{
+	// xorshift32
+	uint32_t x = m_RandomState;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	m_RandomState = x;
+	return x;
+}
+
+size_t PacketGenerator::nextPacketSize()
+{
+	if (m_MaxSize == 0)
+		return m_Template.size();
+
+	if (m_Sizes.empty())
+	{
+		if (m_MinSize == m_MaxSize)
+			return m_MinSize;
+
+		return m_MinSize + nextRandom() % (m_MaxSize - m_MinSize + 1);
+	}
+
+	if (m_Sizes.size() == 1)
+		return m_Sizes[0];
+
+	uint32_t value = nextRandom() % m_CumulativeWeights.back();
+	size_t index = std::upper_bound(m_CumulativeWeights.begin(), m_CumulativeWeights.end(), value) - m_CumulativeWeights.begin();
+	return m_Sizes[index];
+}
+
+uint32_t PacketGenerator::nextFieldValue(FieldMutator& mutator)
+{
+	if (mutator.type == RandomMutator)
+	{
+		uint32_t range = mutator.maxValue - mutator.minValue;
+		if (range == 0xffffffff)
+			return nextRandom();
+
+		return mutator.minValue + nextRandom() % (range + 1);
+	}
+
+	uint32_t value = mutator.nextValue;
+	if (mutator.maxValue - value < mutator.step)
+		mutator.nextValue = mutator.minValue;
+	else
+		mutator.nextValue = value + mutator.step;
+
+	return value;
+}
+
+size_t PacketGenerator::writePacket(uint8_t* buffer, size_t packetLen)
+{
+	memcpy(buffer, &m_Image[0], packetLen);
+
+	uint32_t ipDelta = 0;
+	uint32_t l4Delta = 0;
+	for (std::vector<FieldMutator>::iterator iter = m_Mutators.begin(); iter != m_Mutators.end(); iter++)
+	{
+		uint8_t* field = buffer + iter->offset;
+		writeBigEndian(field, nextFieldValue(*iter), iter->width);
+
+		if (iter->coveredByIPChecksum)
+			ipDelta += sumBytes(field, iter->width, iter->ipOddAligned) + iter->ipTemplateSumComplement;
+		if (iter->coveredByL4Checksum)
+			l4Delta += sumBytes(field, iter->width, iter->l4OddAligned) + iter->l4TemplateSumComplement;
+	}
+
+	if (m_IPProtocol == IPv4)
+	{
+		iphdr* ipv4Header = (iphdr*)(buffer + m_IPOffset);
+		uint16_t totalLength = (uint16_t)(packetLen - m_IPOffset);
+		ipv4Header->totalLength = htobe16(totalLength);
+		ipv4Header->headerChecksum = htobe16((uint16_t)~foldSum(m_IPHeaderSum + totalLength + ipDelta));
+	}
+	else if (m_IPProtocol == IPv6)
+	{
+		ip6_hdr* ipv6Header = (ip6_hdr*)(buffer + m_IPOffset);
+		ipv6Header->payloadLength = htobe16((uint16_t)(packetLen - m_IPOffset - sizeof(ip6_hdr)));
+	}
+
+	if (m_L4Protocol != UnknownProtocol)
+	{
+		size_t l4Len = packetLen - m_L4Offset;
+		uint32_t sum = m_L4PrefixSums[l4Len / 2] + l4Delta;
+		if (l4Len & 1)
+			sum += (uint32_t)m_Image[m_L4Offset + l4Len - 1] << 8;
+
+		uint8_t* l4Header = buffer + m_L4Offset;
+		if (m_L4Protocol == ICMP)
+		{
+			((icmphdr*)l4Header)->checksum = htobe16((uint16_t)~foldSum(sum));
+		}
+		else
+		{
+			// the pseudo header contains the L4 length
+			sum += m_PseudoHeaderSum + (uint32_t)l4Len;
+			if (m_L4Protocol == TCP)
+			{
+				((tcphdr*)l4Header)->headerChecksum = htobe16((uint16_t)~foldSum(sum));
+			}
+			else // UDP
+			{
+				// the length field in the UDP header is also part of the sum
+				sum += (uint32_t)l4Len;
+				uint16_t checksum = (uint16_t)~foldSum(sum);
+				udphdr* udpHeader = (udphdr*)l4Header;
+				udpHeader->length = htobe16((uint16_t)l4Len);
+				udpHeader->headerChecksum = htobe16(checksum == 0 ? 0xffff : checksum);
+			}
+		}
+	}
+
+	m_NumOfGeneratedPackets++;
+	return packetLen;
+}
+
+int PacketGenerator::generatePacket(uint8_t* buffer, size_t bufferLen)
+{
+	if (!compile())
+		return -1;
+
+	size_t packetLen = nextPacketSize();
+	if (bufferLen < packetLen)
+	{
+		LOG_ERROR("Buffer of %d bytes is too small for a packet of %d bytes", (int)bufferLen, (int)packetLen);
+		return -1;
+	}
+
+	return (int)writePacket(buffer, packetLen);
+}
+
+PointerVector<RawPacket>& PacketGenerator::generateBurst(size_t count)
+{
+	if (!compile())
+	{
+		m_Burst.clear();
+		return m_Burst;
+	}
+
+	size_t maxPacketLen = getMaxPacketLen();
+	if (m_BurstBufferLen < count * maxPacketLen)
+	{
+		// the burst packets don't own their data, so they must be re-pointed to the new buffer before the old one is freed
+		m_Burst.clear();
+		delete [] m_BurstBuffer;
+		m_BurstBufferLen = count * maxPacketLen;
+		m_BurstBuffer = new uint8_t[m_BurstBufferLen];
+	}
+
+	while (m_Burst.size() > count)
+		m_Burst.erase(m_Burst.end() - 1);
+
+	timeval now;
+	gettimeofday(&now, NULL);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		uint8_t* data = m_BurstBuffer + i * maxPacketLen;
+		int packetLen = (int)writePacket(data, nextPacketSize());
+		if (i < m_Burst.size())
+			m_Burst.at((int)i)->setRawData(data, packetLen, now, m_LinkLayerType);
+		else
+			m_Burst.pushBack(new RawPacket(data, packetLen, now, false, m_LinkLayerType));
+	}
+
+	return m_Burst;
+}
+
+} // namespace pcpp
@@ -138,7 +138,7 @@ uint32_t hash5Tuple(Packet* packet, bool const& directionUnique)
 	else
 	{
 		IPv6Layer* ipv6Layer = packet->getLayerOfType<IPv6Layer>();
-		if (portSrc == portDst && (uint64_t)ipv6Layer->getIPv6Header()->ipDst < (uint64_t)ipv6Layer->getIPv6Header()->ipSrc)
+		if (portSrc == portDst && memcmp(ipv6Layer->getIPv6Header()->ipDst, ipv6Layer->getIPv6Header()->ipSrc, 16) < 0)
 			srcPosition = 1;
 
 		vec[2 + srcPosition].buffer = ipv6Layer->getIPv6Header()->ipSrc;
@@ -176,8 +176,7 @@ uint32_t hash2Tuple(Packet* packet)
 	{
 		IPv6Layer* ipv6Layer = packet->getLayerOfType<IPv6Layer>();
 		int srcPosition = 0;
-		if ((uint64_t)ipv6Layer->getIPv6Header()->ipDst < (uint64_t)ipv6Layer->getIPv6Header()->ipSrc
-				&& (uint64_t)(ipv6Layer->getIPv6Header()->ipDst+8) < (uint64_t)(ipv6Layer->getIPv6Header()->ipSrc+8))
+		if (memcmp(ipv6Layer->getIPv6Header()->ipDst, ipv6Layer->getIPv6Header()->ipSrc, 16) < 0)
 			srcPosition = 1;
 
 		vec[0 + srcPosition].buffer = ipv6Layer->getIPv6Header()->ipSrc;
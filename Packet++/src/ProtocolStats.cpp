@@ -0,0 +1,471 @@
+#define LOG_MODULE PacketLogModuleProtocolStats
+
+#include "ProtocolStats.h"
+#include "Logger.h"
+#include <string.h>
+#include <sstream>
+#include <iomanip>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace pcpp
+{
+
+#define PCPP_PROTOCOL_STATS_UNKNOWN_INDEX (PCPP_PROTOCOL_STATS_NUM_OF_PROTOCOLS - 1)
+#define PCPP_PROTOCOL_STATS_NO_NODE 0xffffffff
+#define PCPP_PROTOCOL_STATS_NAME_WIDTH 40
+
+static const char* ProtocolNames[] =
+{
+	"eth", "ipv4", "ipv6", "tcp", "udp", "http.request", "http.response", "arp",
+	"vlan", "icmp", "pppoes", "pppoed", "dns", "mpls", "grev0", "grev1",
+	"ppp", "ssl", "sll", "dhcp", "null", "igmpv1", "igmpv2", "igmpv3",
+	"data", "vxlan", "sip.request", "sip.response", "sdp", "trailer", "radius", "gtpv1",
+	"eth.dot3", "bgp", "ssh"
+};
+
+static inline size_t lowestBitIndex(uint64_t value)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	if (_BitScanForward(&index, (unsigned long)(value & 0xffffffff)))
+		return index;
+	_BitScanForward(&index, (unsigned long)(value >> 32));
+	return index + 32;
+#else
+	return __builtin_ctzll(value);
+#endif
+}
+
+static inline void addCounters(ProtocolStats::Counters& counters, uint64_t packets, uint64_t bytes)
+{
+	counters.packets += packets;
+	counters.bytes += bytes;
+}
+
+size_t ProtocolStats::getProtocolIndex(ProtocolType protocol)
+{
+	if (protocol == UnknownProtocol)
+		return PCPP_PROTOCOL_STATS_UNKNOWN_INDEX;
+
+	return lowestBitIndex(protocol);
+}
+
+std::string ProtocolStats::getProtocolName(ProtocolType protocol)
+{
+	size_t index = getProtocolIndex(protocol);
+	if (index < sizeof(ProtocolNames) / sizeof(ProtocolNames[0]))
+		return ProtocolNames[index];
+
+	if (index == PCPP_PROTOCOL_STATS_UNKNOWN_INDEX)
+		return "unknown";
+
+	std::ostringstream stream;
+	stream << "proto" << index;
+	return stream.str();
+}
+
+ProtocolStats::ProtocolStats(const Config& config) : m_Config(config)
+{
+	if (m_Config.maxHierarchyNodes == 0)
+		m_Config.maxHierarchyNodes = 1;
+	if (m_Config.bucketDuration == 0)
+		m_Config.numOfBuckets = 0;
+	m_BucketDurationNsec = (uint64_t)m_Config.bucketDuration * 1000000;
+
+	// node #0 is the root of the tree, it counts all packets
+	m_Nodes = new Node[m_Config.maxHierarchyNodes + 1];
+	m_Buckets = (m_Config.numOfBuckets > 0 ? new TimeBucket[m_Config.numOfBuckets] : NULL);
+	clear();
+}
+
+ProtocolStats::~ProtocolStats()
+{
+	delete [] m_Nodes;
+	delete [] m_Buckets;
+}
+
+ProtocolStats::ProtocolStats(const ProtocolStats& other) : m_Nodes(NULL), m_Buckets(NULL)
+{
+	copyFrom(other);
+}
+
+ProtocolStats& ProtocolStats::operator=(const ProtocolStats& other)
+{
+	if (this == &other)
+		return *this;
+
+	delete [] m_Nodes;
+	delete [] m_Buckets;
+	copyFrom(other);
+	return *this;
+}
+
+void ProtocolStats::copyFrom(const ProtocolStats& other)
+{
+	m_Config = other.m_Config;
+	m_Total = other.m_Total;
+	memcpy(m_TruncatedProtocolCounters, other.m_TruncatedProtocolCounters, sizeof(m_TruncatedProtocolCounters));
+	m_Nodes = new Node[m_Config.maxHierarchyNodes + 1];
+	memcpy(m_Nodes, other.m_Nodes, sizeof(Node) * other.m_NumOfNodes);
+	m_NumOfNodes = other.m_NumOfNodes;
+	m_TruncatedPaths = other.m_TruncatedPaths;
+	m_Buckets = NULL;
+	if (m_Config.numOfBuckets > 0)
+	{
+		m_Buckets = new TimeBucket[m_Config.numOfBuckets];
+		memcpy(m_Buckets, other.m_Buckets, sizeof(TimeBucket) * m_Config.numOfBuckets);
+	}
+	m_OldestBucket = other.m_OldestBucket;
+	m_NewestBucket = other.m_NewestBucket;
+	m_NewestBucketStart = other.m_NewestBucketStart;
+	m_BucketDurationNsec = other.m_BucketDurationNsec;
+	m_HasBuckets = other.m_HasBuckets;
+	m_LatePackets = other.m_LatePackets;
+}
+
+void ProtocolStats::clear()
+{
+	memset(&m_Total, 0, sizeof(m_Total));
+	memset(m_TruncatedProtocolCounters, 0, sizeof(m_TruncatedProtocolCounters));
+
+	memset(&m_Nodes[0], 0, sizeof(Node));
+	m_Nodes[0].parent = PCPP_PROTOCOL_STATS_NO_NODE;
+	m_NumOfNodes = 1;
+	m_TruncatedPaths = 0;
+
+	m_OldestBucket = 0;
+	m_NewestBucket = 0;
+	m_NewestBucketStart = 0;
+	m_HasBuckets = false;
+	m_LatePackets = 0;
+}
+
+uint32_t ProtocolStats::getChild(uint32_t parent, ProtocolType protocol)
+{
+	Node& parentNode = m_Nodes[parent];
+	for (uint32_t child = parentNode.firstChild; child != 0; child = m_Nodes[child].nextSibling)
+	{
+		if (m_Nodes[child].protocol == protocol)
+			return child;
+	}
+
+	if (m_NumOfNodes > m_Config.maxHierarchyNodes)
+		return 0;
+
+	uint32_t newChild = m_NumOfNodes++;
+	Node& newNode = m_Nodes[newChild];
+	memset(&newNode, 0, sizeof(Node));
+	newNode.protocol = protocol;
+	newNode.parent = parent;
+	newNode.depth = (parent == 0 ? 0 : parentNode.depth + 1);
+
+	if (parentNode.lastChild == 0)
+		parentNode.firstChild = newChild;
+	else
+		m_Nodes[parentNode.lastChild].nextSibling = newChild;
+	parentNode.lastChild = newChild;
+
+	return newChild;
+}
+
+ProtocolStats::TimeBucket* ProtocolStats::getBucketByNumber(uint64_t bucketNumber)
+{
+	if (m_HasBuckets && bucketNumber < m_OldestBucket)
+		return NULL;
+
+	if (!m_HasBuckets || bucketNumber > m_NewestBucket)
+	{
+		// reset the buckets the window moves over. If it moves by more than the whole ring only the last buckets are reset
+		uint64_t firstToReset = (m_HasBuckets ? m_NewestBucket + 1 : bucketNumber);
+		if (bucketNumber - firstToReset >= m_Config.numOfBuckets)
+			firstToReset = bucketNumber - m_Config.numOfBuckets + 1;
+
+		for (uint64_t curBucket = firstToReset; curBucket <= bucketNumber; curBucket++)
+		{
+			TimeBucket& bucket = m_Buckets[curBucket % m_Config.numOfBuckets];
+			memset(&bucket, 0, sizeof(TimeBucket));
+			bucket.startTime.tv_sec = (time_t)(curBucket * m_BucketDurationNsec / 1000000000);
+			bucket.startTime.tv_nsec = (long)(curBucket * m_BucketDurationNsec % 1000000000);
+		}
+
+		if (!m_HasBuckets)
+			m_OldestBucket = bucketNumber;
+		else if (bucketNumber - m_OldestBucket >= m_Config.numOfBuckets)
+			m_OldestBucket = bucketNumber - m_Config.numOfBuckets + 1;
+
+		m_NewestBucket = bucketNumber;
+		m_NewestBucketStart = bucketNumber * m_BucketDurationNsec;
+		m_HasBuckets = true;
+	}
+
+	return &m_Buckets[bucketNumber % m_Config.numOfBuckets];
+}
+
+void ProtocolStats::addPacket(const Packet& packet)
+{
+	RawPacket* rawPacket = packet.getRawPacketReadOnly();
+	if (rawPacket == NULL)
+		return;
+
+	uint64_t bytes = (uint64_t)rawPacket->getFrameLength();
+	addCounters(m_Total, 1, bytes);
+
+	// walk down the hierarchy along the layers and collect the protocols of the packet. The packet is counted only at the node its path
+	// ends at, the counters of the nodes above it are summed when they're read
+	uint64_t protocolBits = 0;
+	bool hasUnknownProtocol = false;
+	uint64_t pathProtocolBits = 0;
+	bool pathHasUnknownProtocol = false;
+	bool isTruncated = false;
+	uint32_t curNode = 0;
+	const Node* nodes = m_Nodes;
+	for (Layer* curLayer = packet.getFirstLayer(); curLayer != NULL; curLayer = curLayer->getNextLayer())
+	{
+		ProtocolType protocol = curLayer->getProtocol();
+		if (!isTruncated)
+		{
+			// look for an existing child here, getChild() is called only to add a new one
+			uint32_t child = nodes[curNode].firstChild;
+			while (child != 0 && nodes[child].protocol != protocol)
+				child = nodes[child].nextSibling;
+			if (child == 0)
+				child = getChild(curNode, protocol);
+
+			if (child == 0)
+			{
+				isTruncated = true;
+				pathProtocolBits = protocolBits;
+				pathHasUnknownProtocol = hasUnknownProtocol;
+			}
+			else
+				curNode = child;
+		}
+
+		if (protocol == UnknownProtocol)
+			hasUnknownProtocol = true;
+		else
+			protocolBits |= ((uint64_t)1 << lowestBitIndex(protocol));
+	}
+
+	// the protocols of a truncated path that aren't on its counted part can't be summed from the hierarchy, so they're counted separately
+	if (isTruncated)
+	{
+		m_TruncatedPaths++;
+		for (uint64_t bits = protocolBits & ~pathProtocolBits; bits != 0; bits &= (bits - 1))
+			addCounters(m_TruncatedProtocolCounters[lowestBitIndex(bits)], 1, bytes);
+		if (hasUnknownProtocol && !pathHasUnknownProtocol)
+			addCounters(m_TruncatedProtocolCounters[PCPP_PROTOCOL_STATS_UNKNOWN_INDEX], 1, bytes);
+	}
+
+	addCounters(m_Nodes[curNode].counters, 1, bytes);
+
+	if (m_Config.numOfBuckets == 0)
+		return;
+
+	timespec ts = rawPacket->getPacketTimeStamp();
+	uint64_t tsNsec = (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+	TimeBucket* bucket;
+	// most packets fall in the newest bucket, so check it before paying for the division
+	if (m_HasBuckets && tsNsec >= m_NewestBucketStart && tsNsec - m_NewestBucketStart < m_BucketDurationNsec)
+		bucket = &m_Buckets[m_NewestBucket % m_Config.numOfBuckets];
+	else
+		bucket = getBucketByNumber(tsNsec / m_BucketDurationNsec);
+
+	if (bucket == NULL)
+	{
+		m_LatePackets++;
+		return;
+	}
+
+	addCounters(bucket->total, 1, bytes);
+	for (uint64_t bits = protocolBits; bits != 0; bits &= (bits - 1))
+		addCounters(bucket->perProtocol[lowestBitIndex(bits)], 1, bytes);
+	if (hasUnknownProtocol)
+		addCounters(bucket->perProtocol[PCPP_PROTOCOL_STATS_UNKNOWN_INDEX], 1, bytes);
+}
+
+void ProtocolStats::sumSubtrees(std::vector<Counters>& subtreeCounters) const
+{
+	subtreeCounters.resize(m_NumOfNodes);
+	for (uint32_t i = 0; i < m_NumOfNodes; i++)
+		subtreeCounters[i] = m_Nodes[i].counters;
+
+	// a child always has a higher index than its parent, so going over the nodes backwards sums every subtree before it's added to its parent
+	for (uint32_t i = m_NumOfNodes - 1; i > 0; i--)
+		addCounters(subtreeCounters[m_Nodes[i].parent], subtreeCounters[i].packets, subtreeCounters[i].bytes);
+}
+
+ProtocolStats::Counters ProtocolStats::getProtocolCounters(ProtocolType protocol) const
+{
+	size_t index = getProtocolIndex(protocol);
+	Counters result = m_TruncatedProtocolCounters[index];
+
+	std::vector<Counters> subtreeCounters;
+	sumSubtrees(subtreeCounters);
+
+	// every packet under the topmost nodes of the protocol includes it. Nodes of the protocol below them are the same packets again
+	for (uint32_t i = 1; i < m_NumOfNodes; i++)
+	{
+		if (getProtocolIndex(m_Nodes[i].protocol) != index)
+			continue;
+
+		bool isTopmost = true;
+		for (uint32_t ancestor = m_Nodes[i].parent; ancestor != 0; ancestor = m_Nodes[ancestor].parent)
+		{
+			if (getProtocolIndex(m_Nodes[ancestor].protocol) == index)
+			{
+				isTopmost = false;
+				break;
+			}
+		}
+
+		if (isTopmost)
+			addCounters(result, subtreeCounters[i].packets, subtreeCounters[i].bytes);
+	}
+
+	return result;
+}
+
+bool ProtocolStats::merge(const ProtocolStats& other)
+{
+	if (m_Config.bucketDuration != other.m_Config.bucketDuration)
+	{
+		LOG_ERROR("Cannot merge stats with a different bucket duration (%u msec vs %u msec)", m_Config.bucketDuration, other.m_Config.bucketDuration);
+		return false;
+	}
+
+	if (this == &other)
+	{
+		ProtocolStats copy(other);
+		return merge(copy);
+	}
+
+	addCounters(m_Total, other.m_Total.packets, other.m_Total.bytes);
+	for (size_t i = 0; i < PCPP_PROTOCOL_STATS_NUM_OF_PROTOCOLS; i++)
+		addCounters(m_TruncatedProtocolCounters[i], other.m_TruncatedProtocolCounters[i].packets, other.m_TruncatedProtocolCounters[i].bytes);
+
+	// a parent node is always created before its children, so mapping the nodes in index order maps every parent before its children.
+	// A node that can't be added to this hierarchy is counted at the deepest node of its path that could, like addPacket() does
+	std::vector<uint32_t> nodeMapping(other.m_NumOfNodes, 0);
+	std::vector<bool> isTruncated(other.m_NumOfNodes, false);
+	addCounters(m_Nodes[0].counters, other.m_Nodes[0].counters.packets, other.m_Nodes[0].counters.bytes);
+	for (uint32_t i = 1; i < other.m_NumOfNodes; i++)
+	{
+		const Node& otherNode = other.m_Nodes[i];
+		uint32_t parent = nodeMapping[otherNode.parent];
+		uint32_t child = (isTruncated[otherNode.parent] ? 0 : getChild(parent, otherNode.protocol));
+		if (child != 0)
+		{
+			nodeMapping[i] = child;
+			addCounters(m_Nodes[child].counters, otherNode.counters.packets, otherNode.counters.bytes);
+			continue;
+		}
+
+		nodeMapping[i] = parent;
+		isTruncated[i] = true;
+		if (otherNode.counters.packets == 0)
+			continue;
+
+		addCounters(m_Nodes[parent].counters, otherNode.counters.packets, otherNode.counters.bytes);
+		m_TruncatedPaths += otherNode.counters.packets;
+
+		bool otherPathProtocols[PCPP_PROTOCOL_STATS_NUM_OF_PROTOCOLS] = { false };
+		for (uint32_t node = i; node != 0; node = other.m_Nodes[node].parent)
+			otherPathProtocols[getProtocolIndex(other.m_Nodes[node].protocol)] = true;
+		for (uint32_t node = parent; node != 0; node = m_Nodes[node].parent)
+			otherPathProtocols[getProtocolIndex(m_Nodes[node].protocol)] = false;
+		for (size_t index = 0; index < PCPP_PROTOCOL_STATS_NUM_OF_PROTOCOLS; index++)
+		{
+			if (otherPathProtocols[index])
+				addCounters(m_TruncatedProtocolCounters[index], otherNode.counters.packets, otherNode.counters.bytes);
+		}
+	}
+	m_TruncatedPaths += other.m_TruncatedPaths;
+
+	m_LatePackets += other.m_LatePackets;
+	if (m_Config.numOfBuckets > 0 && other.m_HasBuckets)
+	{
+		for (uint64_t bucketNumber = other.m_OldestBucket; bucketNumber <= other.m_NewestBucket; bucketNumber++)
+		{
+			const TimeBucket& otherBucket = other.m_Buckets[bucketNumber % other.m_Config.numOfBuckets];
+			TimeBucket* bucket = getBucketByNumber(bucketNumber);
+			if (bucket == NULL)
+			{
+				m_LatePackets += otherBucket.total.packets;
+				continue;
+			}
+
+			addCounters(bucket->total, otherBucket.total.packets, otherBucket.total.bytes);
+			for (size_t i = 0; i < PCPP_PROTOCOL_STATS_NUM_OF_PROTOCOLS; i++)
+				addCounters(bucket->perProtocol[i], otherBucket.perProtocol[i].packets, otherBucket.perProtocol[i].bytes);
+		}
+	}
+
+	return true;
+}
+
+void ProtocolStats::getHierarchy(std::vector<HierarchyNode>& hierarchy) const
+{
+	std::vector<Counters> subtreeCounters;
+	sumSubtrees(subtreeCounters);
+
+	// iterative depth-first walk: go to the first child, otherwise to the next sibling of the node or of its closest ancestor
+	uint32_t curNode = m_Nodes[0].firstChild;
+	while (curNode != 0)
+	{
+		const Node& node = m_Nodes[curNode];
+		HierarchyNode hierarchyNode;
+		hierarchyNode.protocol = node.protocol;
+		hierarchyNode.depth = node.depth;
+		hierarchyNode.counters = subtreeCounters[curNode];
+		hierarchy.push_back(hierarchyNode);
+
+		if (node.firstChild != 0)
+		{
+			curNode = node.firstChild;
+			continue;
+		}
+
+		while (curNode != 0 && m_Nodes[curNode].nextSibling == 0)
+			curNode = m_Nodes[curNode].parent;
+
+		if (curNode != 0)
+			curNode = m_Nodes[curNode].nextSibling;
+	}
+}
+
+size_t ProtocolStats::getNumOfBuckets() const
+{
+	if (!m_HasBuckets)
+		return 0;
+
+	return (size_t)(m_NewestBucket - m_OldestBucket + 1);
+}
+
+const ProtocolStats::TimeBucket* ProtocolStats::getBucket(size_t index) const
+{
+	if (index >= getNumOfBuckets())
+		return NULL;
+
+	return &m_Buckets[(m_OldestBucket + index) % m_Config.numOfBuckets];
+}
+
+std::string ProtocolStats::hierarchyToString() const
+{
+	std::vector<HierarchyNode> hierarchy;
+	getHierarchy(hierarchy);
+
+	std::ostringstream stream;
+	for (std::vector<HierarchyNode>::const_iterator iter = hierarchy.begin(); iter != hierarchy.end(); iter++)
+	{
+		std::string name = std::string(iter->depth * 2, ' ') + getProtocolName(iter->protocol);
+		stream << std::left << std::setw(PCPP_PROTOCOL_STATS_NAME_WIDTH) << name
+				<< " frames:" << iter->counters.packets << " bytes:" << iter->counters.bytes << std::endl;
+	}
+
+	return stream.str();
+}
+
+} // namespace pcpp
@@ -29,6 +29,7 @@ RadiusLayer::RadiusLayer(uint8_t code, uint8_t id, const uint8_t* authenticator,
 	m_Data = new uint8_t[m_DataLen];
 	memset(m_Data, 0, m_DataLen);
 	m_Protocol = Radius;
+	m_AttributeReader.enableRecordIndex(true);
 
 	radius_header* hdr = getRadiusHeader();
 	hdr->code = code;
@@ -47,6 +48,7 @@ RadiusLayer::RadiusLayer(uint8_t code, uint8_t id, const std::string authenticat
 	m_Data = new uint8_t[m_DataLen];
 	memset(m_Data, 0, m_DataLen);
 	m_Protocol = Radius;
+	m_AttributeReader.enableRecordIndex(true);
 
 	radius_header* hdr = getRadiusHeader();
 	hdr->code = code;
@@ -174,6 +176,11 @@ RadiusAttribute RadiusLayer::getAttribute(uint8_t attributeType) const
 	return m_AttributeReader.getTLVRecord(attributeType, getAttributesBasePtr(), getHeaderLen() - sizeof(radius_header));
 }
 
+size_t RadiusLayer::getAttributes(const uint8_t* attrTypes, size_t numOfAttrTypes, std::vector<RadiusAttribute>& result) const
+{
+	return m_AttributeReader.getTLVRecords(attrTypes, numOfAttrTypes, result, getAttributesBasePtr(), getHeaderLen() - sizeof(radius_header));
+}
+
 size_t RadiusLayer::getAttributeCount() const
 {
 	return m_AttributeReader.getTLVRecordCount(getAttributesBasePtr(), getHeaderLen() - sizeof(radius_header));
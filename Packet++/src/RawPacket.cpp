@@ -8,6 +8,115 @@
 namespace pcpp
 {
 
+// the reference count is changed by the threads that share the data and the pool free list is used by the threads that release it
+
+#if defined(_MSC_VER)
+
+static inline uint32_t atomicLoadAcquire(const volatile uint32_t* value) { uint32_t result = *value; _ReadWriteBarrier(); return result; }
+static inline void atomicIncrement(volatile uint32_t* value) { InterlockedIncrement((volatile LONG*)value); }
+static inline uint32_t atomicDecrement(volatile uint32_t* value) { return (uint32_t)InterlockedDecrement((volatile LONG*)value); }
+static inline bool atomicTryLock(volatile long* lock) { return InterlockedExchange(lock, 1) == 0; }
+static inline void atomicUnlock(volatile long* lock) { InterlockedExchange(lock, 0); }
+
+#else
+
+static inline uint32_t atomicLoadAcquire(const volatile uint32_t* value) { return __atomic_load_n(value, __ATOMIC_ACQUIRE); }
+static inline void atomicIncrement(volatile uint32_t* value) { __atomic_add_fetch(value, 1, __ATOMIC_RELAXED); }
+static inline uint32_t atomicDecrement(volatile uint32_t* value) { return __atomic_sub_fetch(value, 1, __ATOMIC_ACQ_REL); }
+static inline bool atomicTryLock(volatile long* lock) { return __atomic_exchange_n(lock, 1, __ATOMIC_ACQUIRE) == 0; }
+static inline void atomicUnlock(volatile long* lock) { __atomic_store_n(lock, 0, __ATOMIC_RELEASE); }
+
+#endif
+
+// reference-counted raw data is preceded by this header, in the headroom of the buffer
+struct RefCountedDataHeader
+{
+	volatile uint32_t refCount;
+	// the raw data capacity of the buffer
+	uint32_t bufferSize;
+	// the pool to return the buffer to or NULL if it was allocated on the heap
+	RawPacketBufferPool* pool;
+	// the next free buffer while the buffer is kept in the pool
+	RefCountedDataHeader* next;
+};
+
+// the headroom is rounded up so the raw data keeps the alignment of the allocation
+static const size_t RefCountedDataHeadroom = (sizeof(RefCountedDataHeader) + 15) & ~((size_t)15);
+
+static inline RefCountedDataHeader* getRefCountedDataHeader(const uint8_t* rawData)
+{
+	return (RefCountedDataHeader*)(rawData - RefCountedDataHeadroom);
+}
+
+
+RawPacketBufferPool::RawPacketBufferPool(size_t bufferSize, size_t maxFreeBuffers)
+{
+	m_BufferSize = bufferSize;
+	m_MaxFreeBuffers = maxFreeBuffers;
+	m_NumOfFreeBuffers = 0;
+	m_FreeList = NULL;
+	m_Lock = 0;
+}
+
+RawPacketBufferPool::~RawPacketBufferPool()
+{
+	RefCountedDataHeader* header = (RefCountedDataHeader*)m_FreeList;
+	while (header != NULL)
+	{
+		RefCountedDataHeader* next = header->next;
+		delete [] (uint8_t*)header;
+		header = next;
+	}
+}
+
+void RawPacketBufferPool::lock()
+{
+	// buffers are taken and returned in a few instructions so spinning is cheaper than a mutex
+	while (!atomicTryLock(&m_Lock))
+	{
+	}
+}
+
+void RawPacketBufferPool::unlock()
+{
+	atomicUnlock(&m_Lock);
+}
+
+uint8_t* RawPacketBufferPool::allocateBuffer()
+{
+	lock();
+	RefCountedDataHeader* header = (RefCountedDataHeader*)m_FreeList;
+	if (header != NULL)
+	{
+		m_FreeList = header->next;
+		m_NumOfFreeBuffers--;
+	}
+	unlock();
+
+	if (header != NULL)
+		return (uint8_t*)header;
+
+	return new uint8_t[RefCountedDataHeadroom + m_BufferSize];
+}
+
+void RawPacketBufferPool::releaseBuffer(uint8_t* buffer)
+{
+	RefCountedDataHeader* header = (RefCountedDataHeader*)buffer;
+	lock();
+	bool keepBuffer = (m_NumOfFreeBuffers < m_MaxFreeBuffers);
+	if (keepBuffer)
+	{
+		header->next = (RefCountedDataHeader*)m_FreeList;
+		m_FreeList = header;
+		m_NumOfFreeBuffers++;
+	}
+	unlock();
+
+	if (!keepBuffer)
+		delete [] buffer;
+}
+
+
 void RawPacket::init(bool deleteRawDataAtDestructor)
 {
 	m_RawData = 0;
@@ -15,6 +124,7 @@ void RawPacket::init(bool deleteRawDataAtDestructor)
 	m_FrameLength = 0;
 	m_DeleteRawDataAtDestructor = deleteRawDataAtDestructor;
 	m_RawPacketSet = false;
+	m_RefCountedRawData = false;
 	m_LinkLayerType = LINKTYPE_ETHERNET;
 }
 
@@ -39,7 +149,11 @@ RawPacket::RawPacket()
 
 RawPacket::~RawPacket()
 {
-	if (m_DeleteRawDataAtDestructor)
+	if (m_RefCountedRawData)
+	{
+		releaseRefCountedData();
+	}
+	else if (m_DeleteRawDataAtDestructor)
 	{
 		delete[] m_RawData;
 	}
@@ -47,15 +161,37 @@ RawPacket::~RawPacket()
 
 RawPacket::RawPacket(const RawPacket& other)
 {
-	m_RawData = NULL;
+	init();
 	copyDataFrom(other, true);
 }
 
+RawPacket::RawPacket(const RawPacket& other, bool shareRawData)
+{
+	init();
+	if (!shareRawData || !other.m_RefCountedRawData)
+	{
+		copyDataFrom(other, true);
+		return;
+	}
+
+	// the other instance holds a reference, so the data can't be freed while the count is incremented
+	atomicIncrement(&getRefCountedDataHeader(other.m_RawData)->refCount);
+	m_RawData = other.m_RawData;
+	m_RawDataLen = other.m_RawDataLen;
+	m_FrameLength = other.m_FrameLength;
+	m_TimeStamp = other.m_TimeStamp;
+	m_LinkLayerType = other.m_LinkLayerType;
+	m_RefCountedRawData = true;
+	m_RawPacketSet = true;
+}
+
 RawPacket& RawPacket::operator=(const RawPacket& other)
 {
 	if (this != &other)
 	{
-		if (m_RawData != NULL)
+		if (m_RefCountedRawData)
+			releaseRefCountedData();
+		else if (m_RawData != NULL)
 			delete [] m_RawData;
 
 		m_RawPacketSet = false;
@@ -99,7 +235,11 @@ bool RawPacket::setRawData(const uint8_t* pRawData, int rawDataLen, timespec tim
 	if(frameLength == -1)
 		frameLength = rawDataLen;
 	m_FrameLength = frameLength;
-	if (m_RawData != 0 && m_DeleteRawDataAtDestructor)
+	if (m_RefCountedRawData)
+	{
+		releaseRefCountedData();
+	}
+	else if (m_RawData != 0 && m_DeleteRawDataAtDestructor)
 	{
 		delete[] m_RawData;
 	}
@@ -114,7 +254,9 @@ bool RawPacket::setRawData(const uint8_t* pRawData, int rawDataLen, timespec tim
 
 void RawPacket::clear()
 {
-	if (m_RawData != 0)
+	if (m_RefCountedRawData)
+		releaseRefCountedData();
+	else if (m_RawData != 0)
 		delete[] m_RawData;
 
 	m_RawData = 0;
@@ -125,6 +267,7 @@ void RawPacket::clear()
 
 void RawPacket::appendData(const uint8_t* dataToAppend, size_t dataToAppendLen)
 {
+	unshareRefCountedData();
 	memcpy((uint8_t*)m_RawData + m_RawDataLen, dataToAppend, dataToAppendLen);
 	m_RawDataLen += dataToAppendLen;
 	m_FrameLength = m_RawDataLen;
@@ -134,6 +277,7 @@ void RawPacket::insertData(int atIndex, const uint8_t* dataToInsert, size_t data
 {
 	// memmove copies data as if there was an intermediate buffer inbetween - so it allows for copying processes on overlapping src/dest ptrs
 	// if insertData is called with atIndex == m_RawDataLen, then no data is being moved. The data of the raw packet is still extended by dataToInsertLen
+	unshareRefCountedData();
 	memmove((uint8_t*)m_RawData + atIndex + dataToInsertLen, (uint8_t*)m_RawData + atIndex, m_RawDataLen - atIndex);
 
 	if (dataToInsert != NULL)
@@ -157,6 +301,19 @@ bool RawPacket::reallocateData(size_t newBufferLength)
 		return false;
 	}
 
+	if (m_RefCountedRawData)
+	{
+		// the new buffer is reference-counted as well and isn't shared yet
+		RawPacketBufferPool* pool = getRefCountedDataHeader(m_RawData)->pool;
+		uint8_t* newRefCountedBuffer = allocateRefCountedData(pool, newBufferLength);
+		memset(newRefCountedBuffer, 0, newBufferLength);
+		memcpy(newRefCountedBuffer, m_RawData, m_RawDataLen);
+		releaseRefCountedData();
+		m_RawData = newRefCountedBuffer;
+		m_RefCountedRawData = true;
+		return true;
+	}
+
 	uint8_t* newBuffer = new uint8_t[newBufferLength];
 	memset(newBuffer, 0, newBufferLength);
 	memcpy(newBuffer, m_RawData, m_RawDataLen);
@@ -177,6 +334,8 @@ bool RawPacket::removeData(int atIndex, size_t numOfBytesToRemove)
 		return false;
 	}
 
+	unshareRefCountedData();
+
 	// only move data if we are removing data somewhere in the layer, not at the end of the last layer
 	// this is so that resizing of the last layer can occur fast by just reducing the fictional length of the packet (m_RawDataLen) by the given amount
 	if((atIndex + (int)numOfBytesToRemove) != m_RawDataLen)
@@ -188,6 +347,95 @@ bool RawPacket::removeData(int atIndex, size_t numOfBytesToRemove)
 	return true;
 }
 
+bool RawPacket::makeRawDataRefCounted(RawPacketBufferPool* pool)
+{
+	if (m_RefCountedRawData)
+		return true;
+
+	if (!m_RawPacketSet)
+	{
+		LOG_ERROR("Raw data isn't set");
+		return false;
+	}
+
+	if (getObjectType() != 0)
+	{
+		LOG_ERROR("Only RawPacket instances can hold reference-counted raw data");
+		return false;
+	}
+
+	uint8_t* newData = allocateRefCountedData(pool, m_RawDataLen);
+	memcpy(newData, m_RawData, m_RawDataLen);
+	if (m_DeleteRawDataAtDestructor)
+		delete [] m_RawData;
+
+	// m_DeleteRawDataAtDestructor is kept as is: it applies again to raw data set after the reference-counted data is released
+	m_RawData = newData;
+	m_RefCountedRawData = true;
+	return true;
+}
+
+uint32_t RawPacket::getRawDataRefCount() const
+{
+	if (!m_RefCountedRawData)
+		return 0;
+
+	return atomicLoadAcquire(&getRefCountedDataHeader(m_RawData)->refCount);
+}
+
+uint8_t* RawPacket::allocateRefCountedData(RawPacketBufferPool* pool, size_t dataLen)
+{
+	uint8_t* buffer;
+	size_t bufferSize;
+	if (pool != NULL && dataLen <= pool->getBufferSize())
+	{
+		buffer = pool->allocateBuffer();
+		bufferSize = pool->getBufferSize();
+	}
+	else
+	{
+		buffer = new uint8_t[RefCountedDataHeadroom + dataLen];
+		bufferSize = dataLen;
+		pool = NULL;
+	}
+
+	RefCountedDataHeader* header = (RefCountedDataHeader*)buffer;
+	header->refCount = 1;
+	header->bufferSize = (uint32_t)bufferSize;
+	header->pool = pool;
+	header->next = NULL;
+	return buffer + RefCountedDataHeadroom;
+}
+
+void RawPacket::releaseRefCountedData()
+{
+	RefCountedDataHeader* header = getRefCountedDataHeader(m_RawData);
+	if (atomicDecrement(&header->refCount) == 0)
+	{
+		if (header->pool != NULL)
+			header->pool->releaseBuffer((uint8_t*)header);
+		else
+			delete [] (uint8_t*)header;
+	}
+
+	m_RawData = NULL;
+	m_RefCountedRawData = false;
+}
+
+void RawPacket::unshareRefCountedData()
+{
+	// if this instance holds the only reference no other instance can take a new one, so the data can be changed in place
+	if (!m_RefCountedRawData || atomicLoadAcquire(&getRefCountedDataHeader(m_RawData)->refCount) == 1)
+		return;
+
+	RefCountedDataHeader* header = getRefCountedDataHeader(m_RawData);
+	uint8_t* newData = allocateRefCountedData(header->pool, header->bufferSize);
+	memcpy(newData, m_RawData, m_RawDataLen);
+	releaseRefCountedData();
+	m_RawData = newData;
+	m_RefCountedRawData = true;
+}
+
 bool RawPacket::setPacketTimeStamp(timeval timestamp)
 {
 	timespec nsec_time;
@@ -42,14 +42,19 @@ void SSHLayer::parseNextLayer()
 // SSHIdentificationMessage methods
 // --------------------------------
 
-SSHIdentificationMessage* SSHIdentificationMessage::tryParse(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet)
+bool SSHIdentificationMessage::isIdentificationData(const uint8_t* data, size_t dataLen)
 {
 	// Payload must be at least as long as the string "SSH-"
 	if (dataLen < 5)
-		return NULL;
+		return false;
 
 	// Payload must begin with "SSH-" and end with "\n"
-	if (data[0] == 0x53 && data[1] == 0x53 && data[2] == 0x48 && data[3] == 0x2d && data[dataLen - 1] == 0x0a)
+	return data[0] == 0x53 && data[1] == 0x53 && data[2] == 0x48 && data[3] == 0x2d && data[dataLen - 1] == 0x0a;
+}
+
+SSHIdentificationMessage* SSHIdentificationMessage::tryParse(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet)
+{
+	if (isIdentificationData(data, dataLen))
 		return new SSHIdentificationMessage(data, dataLen, prevLayer, packet);
 
 	return NULL;
@@ -130,27 +135,27 @@ std::string SSHHandshakeMessage::toString() const
 	return std::string(SSH_LAYER_BASE_STRING) + ", " + "Handshake Message: " + getMessageTypeStr();
 }
 
-SSHHandshakeMessage* SSHHandshakeMessage::tryParse(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet)
+bool SSHHandshakeMessage::isHandshakeData(const uint8_t* data, size_t dataLen)
 {
 	if (dataLen < sizeof(SSHHandshakeMessage::ssh_message_base))
 	{
 		LOG_DEBUG("Data length is smaller than the minimum size of an SSH handshake message. It's probably not an SSH hanshake message");
-		return NULL;
+		return false;
 	}
 
-	SSHHandshakeMessage::ssh_message_base* msgBase = (SSHHandshakeMessage::ssh_message_base*)data;
+	const SSHHandshakeMessage::ssh_message_base* msgBase = (const SSHHandshakeMessage::ssh_message_base*)data;
 
 	uint32_t msgLength = be32toh(msgBase->packetLength);
 	if (msgLength + sizeof(uint32_t) > dataLen)
 	{
 		LOG_DEBUG("Message size is larger than layer size. It's probably not an SSH hanshake message");
-		return NULL;
+		return false;
 	}
 
 	if (msgBase->paddingLength > msgLength)
 	{
 		LOG_DEBUG("Message padding is larger than message size. It's probably not an SSH hanshake message");
-		return NULL;
+		return false;
 	}
 
 	if (msgBase->messageCode != 20 &&
@@ -158,9 +163,24 @@ SSHHandshakeMessage* SSHHandshakeMessage::tryParse(uint8_t* data, size_t dataLen
 		(msgBase->messageCode < 30 || msgBase->messageCode > 49))
 		{
 			LOG_DEBUG("Unknown message type %d. It's probably not an SSH hanshake message", (int)msgBase->messageCode);
-			return NULL;
+			return false;
 		}
 
+	return true;
+}
+
+bool SSHHandshakeMessage::isInstance(const Layer& layer)
+{
+	// SSHLayer#createSSHMessage() checks for an identification message first
+	return !SSHIdentificationMessage::isInstance(layer) && isHandshakeData(layer.getData(), layer.getDataLen());
+}
+
+SSHHandshakeMessage* SSHHandshakeMessage::tryParse(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet)
+{
+	if (!isHandshakeData(data, dataLen))
+		return NULL;
+
+	SSHHandshakeMessage::ssh_message_base* msgBase = (SSHHandshakeMessage::ssh_message_base*)data;
 	switch (msgBase->messageCode)
 	{
 	case SSHHandshakeMessage::SSH_MSG_KEX_INIT:
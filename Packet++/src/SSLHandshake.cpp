@@ -1113,6 +1113,22 @@ std::string SSLServerNameIndicationExtension::getHostName() const
 	return res;
 }
 
+const char* SSLServerNameIndicationExtension::getHostNameData(uint16_t& length) const
+{
+	length = 0;
+	size_t hostNameOffset = sizeof(uint16_t) + sizeof(uint8_t) + sizeof(uint16_t);
+	if (getLength() < hostNameOffset)
+		return NULL;
+
+	uint8_t* hostNameLengthPos = getData() + sizeof(uint16_t) + sizeof(uint8_t);
+	uint16_t hostNameLength = be16toh(*(uint16_t*)hostNameLengthPos);
+	if (hostNameOffset + hostNameLength > getLength())
+		return NULL;
+
+	length = hostNameLength;
+	return (const char*)(hostNameLengthPos + sizeof(uint16_t));
+}
+
 
 // -------------------------------------
 // SSLSupportedVersionsExtension methods
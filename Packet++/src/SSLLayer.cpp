@@ -123,6 +123,11 @@ std::string SSLHandshakeLayer::toString() const
 
 SSLHandshakeLayer::SSLHandshakeLayer(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet)
 	: SSLLayer(data, dataLen, prevLayer, packet)
+{
+	parseMessages();
+}
+
+void SSLHandshakeLayer::parseMessages()
 {
 	uint8_t* curPos = m_Data + sizeof(ssl_tls_record_layer);
 	size_t recordDataLen = be16toh(getRecordLayer()->length);
@@ -142,6 +147,13 @@ SSLHandshakeLayer::SSLHandshakeLayer(uint8_t* data, size_t dataLen, Layer* prevL
 	}
 }
 
+void SSLHandshakeLayer::rebaseData(uint8_t* data)
+{
+	m_Data = data;
+	m_MessageList.clear();
+	parseMessages();
+}
+
 SSLHandshakeMessage* SSLHandshakeLayer::getHandshakeMessageAt(int index) const
 {
 	if (index < 0 || index >= (int)(m_MessageList.size()))
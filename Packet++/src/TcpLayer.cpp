@@ -78,6 +78,11 @@ TcpOption TcpLayer::getTcpOption(TcpOptionType option) const
 	return m_OptionReader.getTLVRecord((uint8_t)option, getOptionsBasePtr(), getHeaderLen() - sizeof(tcphdr));
 }
 
+size_t TcpLayer::getTcpOptions(const TcpOptionType* optionTypes, size_t numOfOptionTypes, std::vector<TcpOption>& result) const
+{
+	return m_OptionReader.getTLVRecords(optionTypes, numOfOptionTypes, result, getOptionsBasePtr(), getHeaderLen() - sizeof(tcphdr));
+}
+
 TcpOption TcpLayer::getFirstTcpOption() const
 {
 	return m_OptionReader.getFirstTLVRecord(getOptionsBasePtr(), getHeaderLen() - sizeof(tcphdr));
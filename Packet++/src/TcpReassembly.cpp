@@ -8,6 +8,7 @@
 #include "Logger.h"
 #include <sstream>
 #include <vector>
+#include <algorithm>
 #include "EndianPortable.h"
 #include "TimespecTimeval.h"
 #ifdef _MSC_VER
@@ -32,6 +33,78 @@ static timeval timespecToTimeval(const timespec& in)
 }
 
 
+const uint8_t* TcpStreamBuffer::peek(size_t numOfBytes) const
+{
+	if (numOfBytes == 0 || numOfBytes > getDataLength())
+		return NULL;
+
+	return &m_Data[m_Offset];
+}
+
+size_t TcpStreamBuffer::consume(size_t numOfBytes)
+{
+	if (numOfBytes > getDataLength())
+		numOfBytes = getDataLength();
+
+	m_Offset += numOfBytes;
+	m_ConsumedBytes += numOfBytes;
+
+	// once everything before a gap was consumed there's nothing left to separate from the data after it
+	if (!m_Gaps.empty() && m_Gaps.front() == m_Offset)
+		m_Gaps.erase(m_Gaps.begin());
+
+	// the memory is kept for the next data. A gap always has data after it, so the buffer can't be empty while gaps are recorded
+	if (m_Offset == m_Data.size())
+	{
+		m_Data.clear();
+		m_Offset = 0;
+	}
+
+	return numOfBytes;
+}
+
+size_t TcpStreamBuffer::skipGap()
+{
+	if (m_Gaps.empty())
+		return 0;
+
+	size_t skippedBytes = m_Gaps.front() - m_Offset;
+	m_Offset = m_Gaps.front();
+	m_ConsumedBytes += skippedBytes;
+	m_Gaps.erase(m_Gaps.begin());
+	return skippedBytes;
+}
+
+bool TcpStreamBuffer::append(const uint8_t* data, size_t dataLen, bool afterGap)
+{
+	if (m_Overflowed || (m_MaxSize > 0 && m_Data.size() - m_Offset + dataLen > m_MaxSize))
+	{
+		m_Overflowed = true;
+		m_DroppedBytes += dataLen;
+		return false;
+	}
+
+	if (dataLen == 0)
+		return true;
+
+	// once most of the buffer was consumed move the rest to its beginning, so the buffer doesn't grow with the stream
+	if (m_Offset > 0 && m_Offset >= m_Data.size() / 2)
+	{
+		m_Data.erase(m_Data.begin(), m_Data.begin() + m_Offset);
+		for (std::vector<size_t>::iterator iter = m_Gaps.begin(); iter != m_Gaps.end(); iter++)
+			*iter -= m_Offset;
+		m_Offset = 0;
+	}
+
+	// data after missing bytes isn't contiguous with the unconsumed data before them. If everything before the gap was consumed there's nothing to separate
+	if (afterGap && m_Data.size() > m_Offset)
+		m_Gaps.push_back(m_Data.size());
+
+	m_Data.insert(m_Data.end(), data, data + dataLen);
+	return true;
+}
+
+
 TcpReassembly::TcpReassembly(OnTcpMessageReady onMessageReadyCallback, void* userCookie, OnTcpConnectionStart onConnectionStartCallback, OnTcpConnectionEnd onConnectionEndCallback, const TcpReassemblyConfiguration &config)
 {
 	m_OnMessageReadyCallback = onMessageReadyCallback;
@@ -42,11 +115,49 @@ TcpReassembly::TcpReassembly(OnTcpMessageReady onMessageReadyCallback, void* use
 	m_RemoveConnInfo = config.removeConnInfo;
 	m_MaxNumToClean = (config.removeConnInfo == true && config.maxNumToClean == 0) ? 30 : config.maxNumToClean;
 	m_MaxOutOfOrderFragments = config.maxOutOfOrderFragments;
+	m_UseStreamBuffers = config.useStreamBuffers;
+	m_MaxStreamBufferSize = config.maxStreamBufferSize;
 	m_PurgeTimepoint = time(NULL) + PURGE_FREQ_SECS;
+	m_InBatch = false;
+	m_BatchLastConnection = NULL;
+	m_PendingMessageConnection = NULL;
+	m_PendingMessageSide = -1;
+	m_PendingMessageLength = 0;
 }
 
 
 TcpReassembly::ReassemblyStatus TcpReassembly::reassemblePacket(Packet& tcpData)
+{
+	purgeClosedConnectionsIfNeeded();
+	return reassemblePacketInternal(tcpData, NULL);
+}
+
+void TcpReassembly::reassemblePackets(Packet** packets, size_t numOfPackets, ReassemblyStatus* statuses)
+{
+	purgeClosedConnectionsIfNeeded();
+
+	// sort the packets by connection. Packets of the same connection keep their order because the index is the second sort key
+	m_BatchOrder.clear();
+	for (size_t i = 0; i < numOfPackets; i++)
+		m_BatchOrder.push_back(std::make_pair(hash5Tuple(packets[i]), i));
+	std::sort(m_BatchOrder.begin(), m_BatchOrder.end());
+
+	m_InBatch = true;
+	m_BatchLastConnection = NULL;
+	for (size_t i = 0; i < m_BatchOrder.size(); i++)
+	{
+		size_t packetIndex = m_BatchOrder[i].second;
+		ReassemblyStatus status = reassemblePacketInternal(*packets[packetIndex], &m_BatchOrder[i].first);
+		if (statuses != NULL)
+			statuses[packetIndex] = status;
+	}
+
+	flushPendingMessage();
+	m_InBatch = false;
+	m_BatchLastConnection = NULL;
+}
+
+void TcpReassembly::purgeClosedConnectionsIfNeeded()
 {
 	// automatic cleanup
 	if (m_RemoveConnInfo == true)
@@ -57,7 +168,10 @@ TcpReassembly::ReassemblyStatus TcpReassembly::reassemblePacket(Packet& tcpData)
 			m_PurgeTimepoint = time(NULL) + PURGE_FREQ_SECS;
 		}
 	}
+}
 
+TcpReassembly::ReassemblyStatus TcpReassembly::reassemblePacketInternal(Packet& tcpData, const uint32_t* precomputedFlowKey)
+{
 
 	// calculate packet's source and dest IP address
 	IPAddress srcIP, dstIP;
@@ -127,12 +241,21 @@ TcpReassembly::ReassemblyStatus TcpReassembly::reassemblePacket(Packet& tcpData)
 	TcpReassemblyData* tcpReassemblyData = NULL;
 
 	// calculate flow key for this packet
-	uint32_t flowKey = hash5Tuple(&tcpData);
+	uint32_t flowKey = (precomputedFlowKey != NULL ? *precomputedFlowKey : hash5Tuple(&tcpData));
 
-	// find the connection in the connection map
-	ConnectionList::iterator iter = m_ConnectionList.find(flowKey);
+	// find the connection in the connection map. In a burst the previous packet usually belongs to the same connection
+	if (m_InBatch && m_BatchLastConnection != NULL && m_BatchLastConnection->connData.flowKey == flowKey)
+	{
+		tcpReassemblyData = m_BatchLastConnection;
+	}
+	else
+	{
+		ConnectionList::iterator iter = m_ConnectionList.find(flowKey);
+		if (iter != m_ConnectionList.end())
+			tcpReassemblyData = &iter->second;
+	}
 
-	if (iter == m_ConnectionList.end())
+	if (tcpReassemblyData == NULL)
 	{
 		// if it's a packet of a new connection, create a TcpReassemblyData object and add it to the active connection list
 		std::pair<ConnectionList::iterator, bool> pair = m_ConnectionList.insert(std::make_pair(flowKey, TcpReassemblyData()));
@@ -146,21 +269,28 @@ TcpReassembly::ReassemblyStatus TcpReassembly::reassemblePacket(Packet& tcpData)
 		tcpReassemblyData->connData.setStartTime(ts);
 
 		m_ConnectionInfo[flowKey] = tcpReassemblyData->connData;
+		if (m_InBatch)
+			m_BatchLastConnection = tcpReassemblyData;
 
 		// fire connection start callback
 		if (m_OnConnStart != NULL)
+		{
+			flushPendingMessage();
 			m_OnConnStart(tcpReassemblyData->connData, m_UserCookie);
+		}
 	}
 	else // connection already exists
 	{
+		if (m_InBatch)
+			m_BatchLastConnection = tcpReassemblyData;
+
 		// if this packet belongs to a connection that was already closed (for example: data packet that comes after FIN), ignore it.
-		if (iter->second.closed)
+		if (tcpReassemblyData->closed)
 		{
 			LOG_DEBUG("Ignoring packet of already closed flow [0x%X]", flowKey);
 			return Ignore_PacketOfClosedFlow;
 		}
 
-		tcpReassemblyData = &iter->second;
 		timeval currTime = timespecToTimeval(tcpData.getRawPacket()->getPacketTimeStamp());
 
 		if (currTime.tv_sec > tcpReassemblyData->connData.endTime.tv_sec)
@@ -191,6 +321,7 @@ TcpReassembly::ReassemblyStatus TcpReassembly::reassemblePacket(Packet& tcpData)
 		sideIndex = 0;
 		tcpReassemblyData->twoSides[sideIndex].srcIP = srcIP;
 		tcpReassemblyData->twoSides[sideIndex].srcPort = srcPort;
+		tcpReassemblyData->twoSides[sideIndex].streamBuffer.m_MaxSize = m_MaxStreamBufferSize;
 		tcpReassemblyData->numOfSides++;
 		first = true;
 	}
@@ -209,6 +340,7 @@ TcpReassembly::ReassemblyStatus TcpReassembly::reassemblePacket(Packet& tcpData)
 			sideIndex = 1;
 			tcpReassemblyData->twoSides[sideIndex].srcIP = srcIP;
 			tcpReassemblyData->twoSides[sideIndex].srcPort = srcPort;
+			tcpReassemblyData->twoSides[sideIndex].streamBuffer.m_MaxSize = m_MaxStreamBufferSize;
 			tcpReassemblyData->numOfSides++;
 			first = true;
 		}
@@ -288,11 +420,8 @@ TcpReassembly::ReassemblyStatus TcpReassembly::reassemblePacket(Packet& tcpData)
 			tcpReassemblyData->twoSides[sideIndex].sequence++;
 
 		// send data to the callback
-		if (tcpPayloadSize != 0 && m_OnMessageReadyCallback != NULL)
-		{
-			TcpStreamData streamData(tcpLayer->getLayerPayload(), tcpPayloadSize, 0, tcpReassemblyData->connData);
-			m_OnMessageReadyCallback(sideIndex, streamData, m_UserCookie);
-		}
+		if (tcpPayloadSize != 0)
+			handleNewData(tcpReassemblyData, sideIndex, tcpLayer->getLayerPayload(), tcpPayloadSize, 0);
 		status = TcpMessageHandled;
 
 		// handle case where this packet is FIN or RST (although it's unlikely)
@@ -323,11 +452,7 @@ TcpReassembly::ReassemblyStatus TcpReassembly::reassemblePacket(Packet& tcpData)
 			tcpReassemblyData->twoSides[sideIndex].sequence += tcpPayloadSize - newLength;
 
 			// send only the new data to the callback
-			if (m_OnMessageReadyCallback != NULL)
-			{
-				TcpStreamData streamData(tcpLayer->getLayerPayload() + newLength, tcpPayloadSize - newLength, 0, tcpReassemblyData->connData);
-				m_OnMessageReadyCallback(sideIndex, streamData, m_UserCookie);
-			}
+			handleNewData(tcpReassemblyData, sideIndex, tcpLayer->getLayerPayload() + newLength, tcpPayloadSize - newLength, 0);
 			status = TcpMessageHandled;
 		}
 		else {
@@ -374,11 +499,7 @@ TcpReassembly::ReassemblyStatus TcpReassembly::reassemblePacket(Packet& tcpData)
 			tcpReassemblyData->twoSides[sideIndex].sequence++;
 
 		// send the data to the callback
-		if (m_OnMessageReadyCallback != NULL)
-		{
-			TcpStreamData streamData(tcpLayer->getLayerPayload(), tcpPayloadSize, 0, tcpReassemblyData->connData);
-			m_OnMessageReadyCallback(sideIndex, streamData, m_UserCookie);
-		}
+		handleNewData(tcpReassemblyData, sideIndex, tcpLayer->getLayerPayload(), tcpPayloadSize, 0);
 		status = TcpMessageHandled;
 
 		// now that we've seen new data, go over the list of out-of-order packets and see if one or more of them fits now
@@ -456,6 +577,102 @@ static std::string prepareMissingDataMessage(uint32_t missingDataLen)
 	return missingDataTextStream.str();
 }
 
+void TcpReassembly::handleNewData(TcpReassemblyData* tcpReassemblyData, int8_t sideIndex, const uint8_t* data, size_t dataLen, uint32_t missingDataLen)
+{
+	// data that follows missing data is delivered separately, so the data collected before it is delivered first. This is done before the new data
+	// is appended to the stream buffer because the collected data is read from the end of the buffer
+	if (missingDataLen > 0)
+		flushPendingMessage();
+
+	TcpStreamBuffer* streamBuffer = NULL;
+	bool appendedToStreamBuffer = false;
+	if (m_UseStreamBuffers)
+	{
+		streamBuffer = &tcpReassemblyData->twoSides[sideIndex].streamBuffer;
+		streamBuffer->m_MissingBytes += missingDataLen;
+		appendedToStreamBuffer = streamBuffer->append(data, dataLen, missingDataLen > 0);
+		if (!appendedToStreamBuffer)
+			LOG_DEBUG("Stream buffer of side %d overflowed, dropping %d bytes", sideIndex, (int)dataLen);
+	}
+
+	if (m_OnMessageReadyCallback == NULL)
+		return;
+
+	// in a burst, in-order data of the same side is collected and delivered in one callback. When stream buffers are used the data is already
+	// in the buffer so only its length is collected, unless it was dropped from the buffer
+	if (m_InBatch && missingDataLen == 0 && (streamBuffer == NULL || appendedToStreamBuffer))
+	{
+		if (m_PendingMessageConnection != tcpReassemblyData || m_PendingMessageSide != sideIndex)
+			flushPendingMessage();
+
+		m_PendingMessageConnection = tcpReassemblyData;
+		m_PendingMessageSide = sideIndex;
+		if (streamBuffer != NULL)
+			m_PendingMessageLength += dataLen;
+		else
+			m_PendingMessageData.insert(m_PendingMessageData.end(), data, data + dataLen);
+		return;
+	}
+
+	// data collected before must be delivered before this data
+	flushPendingMessage();
+
+	if (missingDataLen == 0)
+	{
+		TcpStreamData streamData(data, dataLen, 0, tcpReassemblyData->connData, streamBuffer);
+		m_OnMessageReadyCallback(sideIndex, streamData, m_UserCookie);
+		return;
+	}
+
+	// prepare missing data text
+	std::string missingDataTextStr = prepareMissingDataMessage(missingDataLen);
+
+	// add missing data text to the data that will be sent to the callback. This means that the data will look something like:
+	// "[xx bytes missing]<original_data>"
+	std::vector<uint8_t> dataWithMissingDataText;
+	dataWithMissingDataText.reserve(missingDataTextStr.length() + dataLen);
+	dataWithMissingDataText.insert(dataWithMissingDataText.end(), missingDataTextStr.begin(), missingDataTextStr.end());
+	dataWithMissingDataText.insert(dataWithMissingDataText.end(), data, data + dataLen);
+
+	TcpStreamData streamData(&dataWithMissingDataText[0], dataWithMissingDataText.size(), missingDataLen, tcpReassemblyData->connData, streamBuffer);
+	m_OnMessageReadyCallback(sideIndex, streamData, m_UserCookie);
+}
+
+void TcpReassembly::flushPendingMessage()
+{
+	if (m_PendingMessageConnection == NULL)
+		return;
+
+	TcpReassemblyData* tcpReassemblyData = m_PendingMessageConnection;
+	m_PendingMessageConnection = NULL;
+
+	// the collected data is the last data appended to the stream buffer, nothing was appended to it since then
+	if (m_UseStreamBuffers)
+	{
+		TcpStreamBuffer* streamBuffer = &tcpReassemblyData->twoSides[m_PendingMessageSide].streamBuffer;
+		size_t dataLen = m_PendingMessageLength;
+		m_PendingMessageLength = 0;
+		const uint8_t* data = (dataLen > 0 ? &streamBuffer->m_Data[streamBuffer->m_Data.size() - dataLen] : NULL);
+		TcpStreamData streamData(data, dataLen, 0, tcpReassemblyData->connData, streamBuffer);
+		m_OnMessageReadyCallback(m_PendingMessageSide, streamData, m_UserCookie);
+		return;
+	}
+
+	// the callback may cause more data to be collected (for example by closing a connection), so the data is moved out of the member first
+	std::vector<uint8_t> data;
+	data.swap(m_PendingMessageData);
+
+	TcpStreamData streamData((data.empty() ? NULL : &data[0]), data.size(), 0, tcpReassemblyData->connData, NULL);
+	m_OnMessageReadyCallback(m_PendingMessageSide, streamData, m_UserCookie);
+
+	// keep the allocated memory for the next time
+	if (m_PendingMessageData.empty())
+	{
+		data.clear();
+		data.swap(m_PendingMessageData);
+	}
+}
+
 void TcpReassembly::handleFinOrRst(TcpReassemblyData* tcpReassemblyData, int8_t sideIndex, uint32_t flowKey)
 {
 	// if this side already saw a FIN or RST packet, do nothing and return
@@ -507,12 +724,7 @@ void TcpReassembly::checkOutOfOrderFragments(TcpReassemblyData* tcpReassemblyDat
 						LOG_DEBUG("Found an out-of-order packet matching to the current sequence with size %d on side %d. Pulling it out of the list and sending the data to the callback", (int)curTcpFrag->dataLength, sideIndex);
 
 						// send new data to callback
-
-						if (m_OnMessageReadyCallback != NULL)
-						{
-							TcpStreamData streamData(curTcpFrag->data, curTcpFrag->dataLength, 0, tcpReassemblyData->connData);
-							m_OnMessageReadyCallback(sideIndex, streamData, m_UserCookie);
-						}
+						handleNewData(tcpReassemblyData, sideIndex, curTcpFrag->data, curTcpFrag->dataLength, 0);
 					}
 
 
@@ -543,11 +755,7 @@ void TcpReassembly::checkOutOfOrderFragments(TcpReassemblyData* tcpReassemblyDat
 						tcpReassemblyData->twoSides[sideIndex].sequence += curTcpFrag->dataLength - newLength;
 
 						// send only the new data to the callback
-						if (m_OnMessageReadyCallback != NULL)
-						{
-							TcpStreamData streamData(curTcpFrag->data + newLength, curTcpFrag->dataLength - newLength, 0, tcpReassemblyData->connData);
-							m_OnMessageReadyCallback(sideIndex, streamData, m_UserCookie);
-						}
+						handleNewData(tcpReassemblyData, sideIndex, curTcpFrag->data + newLength, curTcpFrag->dataLength - newLength, 0);
 
 						foundSomething = true;
 					}
@@ -618,25 +826,8 @@ void TcpReassembly::checkOutOfOrderFragments(TcpReassemblyData* tcpReassemblyDat
 			if (curTcpFrag->data != NULL)
 			{
 				// send new data to callback
-				if (m_OnMessageReadyCallback != NULL)
-				{
-					// prepare missing data text
-					std::string missingDataTextStr = prepareMissingDataMessage(missingDataLen);
-
-					// add missing data text to the data that will be sent to the callback. This means that the data will look something like:
-					// "[xx bytes missing]<original_data>"
-					std::vector<uint8_t> dataWithMissingDataText;
-					dataWithMissingDataText.reserve(missingDataTextStr.length() + curTcpFrag->dataLength);
-					dataWithMissingDataText.insert(dataWithMissingDataText.end(), missingDataTextStr.begin(), missingDataTextStr.end());
-					dataWithMissingDataText.insert(dataWithMissingDataText.end(), curTcpFrag->data, curTcpFrag->data + curTcpFrag->dataLength);
-
-					//TcpStreamData streamData(curTcpFrag->data, curTcpFrag->dataLength, tcpReassemblyData->connData);
-					TcpStreamData streamData(&dataWithMissingDataText[0], dataWithMissingDataText.size(), missingDataLen, tcpReassemblyData->connData);
-					m_OnMessageReadyCallback(sideIndex, streamData, m_UserCookie);
-
-					LOG_DEBUG("Found missing data on side %d: %d byte are missing. Sending the closest fragment which is in size %d + missing text message which size is %d",
-						sideIndex, missingDataLen, (int)curTcpFrag->dataLength, (int)missingDataTextStr.length());
-				}
+				LOG_DEBUG("Found missing data on side %d: %d byte are missing. Sending the closest fragment which is in size %d", sideIndex, missingDataLen, (int)curTcpFrag->dataLength);
+				handleNewData(tcpReassemblyData, sideIndex, curTcpFrag->data, curTcpFrag->dataLength, missingDataLen);
 			}
 
 			// remove fragment from list
@@ -679,6 +870,9 @@ void TcpReassembly::closeConnectionInternal(uint32_t flowKey, ConnectionEndReaso
 	LOG_DEBUG("Calling checkOutOfOrderFragments on side 1");
 	checkOutOfOrderFragments(&tcpReassemblyData, 1, true);
 
+	// data collected in a burst is delivered before the connection ends
+	flushPendingMessage();
+
 	if (m_OnConnEnd != NULL)
 		m_OnConnEnd(tcpReassemblyData.connData, reason, m_UserCookie);
 
@@ -709,6 +903,9 @@ void TcpReassembly::closeAllConnections()
 		LOG_DEBUG("Calling checkOutOfOrderFragments on side 1");
 		checkOutOfOrderFragments(&tcpReassemblyData, 1, true);
 
+		// data collected in a burst is delivered before the connection ends
+		flushPendingMessage();
+
 		if (m_OnConnEnd != NULL)
 			m_OnConnEnd(tcpReassemblyData.connData, TcpReassemblyConnectionClosedManually, m_UserCookie);
 
@@ -740,6 +937,18 @@ void TcpReassembly::insertIntoCleanupList(uint32_t flowKey)
 	keysList.push_front(flowKey);
 }
 
+TcpStreamBuffer* TcpReassembly::getStreamBuffer(uint32_t flowKey, int8_t side)
+{
+	if (!m_UseStreamBuffers || side < 0 || side > 1)
+		return NULL;
+
+	ConnectionList::iterator iter = m_ConnectionList.find(flowKey);
+	if (iter == m_ConnectionList.end() || side >= iter->second.numOfSides)
+		return NULL;
+
+	return &iter->second.twoSides[side].streamBuffer;
+}
+
 uint32_t TcpReassembly::purgeClosedConnections(uint32_t maxNumToClean)
 {
 	uint32_t count = 0;
@@ -747,6 +956,9 @@ uint32_t TcpReassembly::purgeClosedConnections(uint32_t maxNumToClean)
 	if (maxNumToClean == 0)
 		maxNumToClean = m_MaxNumToClean;
 
+	// the connection of the previous packet in a burst may be removed
+	m_BatchLastConnection = NULL;
+
 	CleanupList::iterator iterTime = m_CleanupList.begin(), iterTimeEnd = m_CleanupList.upper_bound(time(NULL));
 	while (iterTime != iterTimeEnd && count < maxNumToClean)
 	{
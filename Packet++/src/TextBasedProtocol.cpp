@@ -621,6 +621,18 @@ std::string HeaderField::getFieldValue() const
 	return result;
 }
 
+const char* HeaderField::getFieldValueData(size_t& valueLength) const
+{
+	if (m_ValueOffsetInMessage == -1)
+	{
+		valueLength = 0;
+		return NULL;
+	}
+
+	valueLength = m_FieldValueSize;
+	return (const char*)(((HeaderField*)this)->getData() + m_ValueOffsetInMessage);
+}
+
 bool HeaderField::setFieldValue(std::string newValue)
 {
 	// Field isn't linked with any message yet
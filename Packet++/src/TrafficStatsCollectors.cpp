@@ -0,0 +1,400 @@
+#include "TrafficStatsCollectors.h"
+#include "TcpLayer.h"
+#include "SSLLayer.h"
+#include "PacketUtils.h"
+#include "SystemUtils.h"
+#include <string.h>
+
+namespace pcpp
+{
+
+#define PCPP_TRAFFIC_STATS_CLIENT_FIN 0x1
+#define PCPP_TRAFFIC_STATS_SERVER_FIN 0x2
+
+static void mergeCountMaps(std::map<uint16_t, uint64_t>& to, const std::map<uint16_t, uint64_t>& from)
+{
+	for (std::map<uint16_t, uint64_t>::const_iterator iter = from.begin(); iter != from.end(); iter++)
+		to[iter->first] += iter->second;
+}
+
+// returns true if the flow is closed after this packet, meaning a RST was seen or FIN was seen in both directions
+static bool updateFinMask(uint8_t& finMask, const tcphdr* tcpHeader, bool fromClient)
+{
+	if (tcpHeader->rstFlag)
+		return true;
+
+	if (tcpHeader->finFlag)
+		finMask |= (fromClient ? PCPP_TRAFFIC_STATS_CLIENT_FIN : PCPP_TRAFFIC_STATS_SERVER_FIN);
+
+	return finMask == (PCPP_TRAFFIC_STATS_CLIENT_FIN | PCPP_TRAFFIC_STATS_SERVER_FIN);
+}
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// HttpTrafficStats + HttpTrafficStatsCollector
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+void HttpTrafficStats::clear()
+{
+	numOfPackets = 0;
+	payloadBytes = 0;
+	numOfFlows = 0;
+	numOfPipeliningFlows = 0;
+	numOfTransactions = 0;
+	numOfUntrackedPackets = 0;
+	numOfRequests = 0;
+	requestHeaderBytes = 0;
+	memset(methodCount, 0, sizeof(methodCount));
+	hostnameCount.clear();
+	numOfResponses = 0;
+	responseHeaderBytes = 0;
+	numOfResponsesWithContentLength = 0;
+	totalContentLength = 0;
+	memset(statusCodeCount, 0, sizeof(statusCodeCount));
+	contentTypeCount.clear();
+}
+
+void HttpTrafficStats::merge(const HttpTrafficStats& other)
+{
+	numOfPackets += other.numOfPackets;
+	payloadBytes += other.payloadBytes;
+	numOfFlows += other.numOfFlows;
+	numOfPipeliningFlows += other.numOfPipeliningFlows;
+	numOfTransactions += other.numOfTransactions;
+	numOfUntrackedPackets += other.numOfUntrackedPackets;
+	numOfRequests += other.numOfRequests;
+	requestHeaderBytes += other.requestHeaderBytes;
+	for (size_t i = 0; i < sizeof(methodCount) / sizeof(methodCount[0]); i++)
+		methodCount[i] += other.methodCount[i];
+	hostnameCount.merge(other.hostnameCount);
+	numOfResponses += other.numOfResponses;
+	responseHeaderBytes += other.responseHeaderBytes;
+	numOfResponsesWithContentLength += other.numOfResponsesWithContentLength;
+	totalContentLength += other.totalContentLength;
+	for (size_t i = 0; i < sizeof(statusCodeCount) / sizeof(statusCodeCount[0]); i++)
+		statusCodeCount[i] += other.statusCodeCount[i];
+	contentTypeCount.merge(other.contentTypeCount);
+}
+
+HttpTrafficStatsCollector::HttpTrafficStatsCollector(uint16_t httpPort, size_t maxFlows) : m_FlowTable(maxFlows), m_HttpPort(httpPort)
+{
+}
+
+void HttpTrafficStatsCollector::collectStats(Packet& packet)
+{
+	TcpLayer* tcpLayer = packet.getLayerOfType<TcpLayer>();
+	if (tcpLayer == NULL)
+		return;
+
+	tcphdr* tcpHeader = tcpLayer->getTcpHeader();
+	bool fromClient = (netToHost16(tcpHeader->portDst) == m_HttpPort);
+	if (!fromClient && netToHost16(tcpHeader->portSrc) != m_HttpPort)
+		return;
+
+	size_t payloadSize = tcpLayer->getLayerPayloadSize();
+	m_Stats.numOfPackets++;
+	m_Stats.payloadBytes += payloadSize;
+
+	uint32_t flowKey = hash5Tuple(&packet);
+	FlowData* flowData = m_FlowTable.find(flowKey);
+	if (flowData == NULL)
+	{
+		// a packet without data that isn't a SYN (like the last ACK of a closed flow) doesn't open a flow
+		if (payloadSize == 0 && !tcpHeader->synFlag)
+			return;
+
+		flowData = m_FlowTable.insert(flowKey);
+		if (flowData == NULL)
+		{
+			m_Stats.numOfUntrackedPackets++;
+			return;
+		}
+
+		m_Stats.numOfFlows++;
+	}
+
+	uint32_t seqNumber = netToHost32(tcpHeader->sequenceNumber);
+	HttpRequestLayer* request = NULL;
+	HttpResponseLayer* response = NULL;
+	if ((request = packet.getLayerOfType<HttpRequestLayer>()) != NULL)
+	{
+		collectMessageStats(flowData, request, seqNumber);
+		collectRequestStats(request);
+	}
+	else if ((response = packet.getLayerOfType<HttpResponseLayer>()) != NULL)
+	{
+		collectMessageStats(flowData, response, seqNumber);
+		collectResponseStats(response);
+	}
+
+	if (updateFinMask(flowData->finMask, tcpHeader, fromClient))
+		m_FlowTable.remove(flowKey);
+}
+
+void HttpTrafficStatsCollector::collectMessageStats(FlowData* flowData, HttpMessage* message, uint32_t seqNumber)
+{
+	// a negative number of open transactions means the flow state is broken
+	if (flowData->numOfOpenTransactions < 0)
+		return;
+
+	if (message->getProtocol() == HTTPRequest)
+	{
+		// a sequence number that isn't newer than the last one seen is a retransmission
+		if (flowData->curSeqNumberRequests >= seqNumber)
+			return;
+
+		flowData->numOfOpenTransactions++;
+
+		// a request that follows a request means HTTP pipelining
+		if (!flowData->pipeliningFlow && flowData->lastSeenMessage == HTTPRequest)
+		{
+			flowData->pipeliningFlow = true;
+			m_Stats.numOfPipeliningFlows++;
+		}
+
+		flowData->lastSeenMessage = HTTPRequest;
+		flowData->curSeqNumberRequests = seqNumber;
+	}
+	else
+	{
+		if (flowData->curSeqNumberResponses >= seqNumber)
+			return;
+
+		flowData->numOfOpenTransactions--;
+
+		if (!flowData->pipeliningFlow && flowData->lastSeenMessage == HTTPResponse)
+		{
+			flowData->pipeliningFlow = true;
+			m_Stats.numOfPipeliningFlows++;
+		}
+
+		flowData->lastSeenMessage = HTTPResponse;
+
+		// a response that closes an open request completes a transaction
+		if (flowData->numOfOpenTransactions >= 0)
+			m_Stats.numOfTransactions++;
+
+		flowData->curSeqNumberResponses = seqNumber;
+	}
+}
+
+void HttpTrafficStatsCollector::collectRequestStats(HttpRequestLayer* request)
+{
+	m_Stats.numOfRequests++;
+	m_Stats.requestHeaderBytes += request->getHeaderLen();
+	m_Stats.methodCount[request->getFirstLine()->getMethod()]++;
+
+	HeaderField* hostField = request->getFieldByName(PCPP_HTTP_HOST_FIELD);
+	if (hostField != NULL)
+	{
+		size_t hostLength = 0;
+		const char* host = hostField->getFieldValueData(hostLength);
+		if (host != NULL)
+			m_Stats.hostnameCount.increment(host, hostLength);
+	}
+}
+
+void HttpTrafficStatsCollector::collectResponseStats(HttpResponseLayer* response)
+{
+	m_Stats.numOfResponses++;
+	m_Stats.responseHeaderBytes += response->getHeaderLen();
+
+	int statusCode = response->getFirstLine()->getStatusCodeAsInt();
+	if (statusCode < 0 || statusCode >= (int)(sizeof(m_Stats.statusCodeCount) / sizeof(m_Stats.statusCodeCount[0])))
+		statusCode = 0;
+	m_Stats.statusCodeCount[statusCode]++;
+
+	HeaderField* contentLengthField = response->getFieldByName(PCPP_HTTP_CONTENT_LENGTH_FIELD);
+	if (contentLengthField != NULL)
+	{
+		size_t valueLength = 0;
+		const char* value = contentLengthField->getFieldValueData(valueLength);
+		uint64_t contentLength = 0;
+		for (size_t i = 0; i < valueLength && value[i] >= '0' && value[i] <= '9'; i++)
+			contentLength = contentLength * 10 + (value[i] - '0');
+
+		m_Stats.numOfResponsesWithContentLength++;
+		m_Stats.totalContentLength += contentLength;
+	}
+
+	HeaderField* contentTypeField = response->getFieldByName(PCPP_HTTP_CONTENT_TYPE_FIELD);
+	if (contentTypeField != NULL)
+	{
+		size_t valueLength = 0;
+		const char* value = contentTypeField->getFieldValueData(valueLength);
+		if (value != NULL)
+		{
+			// drop parameters such as the charset, for example: "application/javascript; charset=UTF-8"
+			const char* paramStart = (const char*)memchr(value, ';', valueLength);
+			if (paramStart != NULL)
+				valueLength = paramStart - value;
+
+			m_Stats.contentTypeCount.increment(value, valueLength);
+		}
+	}
+}
+
+void HttpTrafficStatsCollector::flushStats(HttpTrafficStats& aggregate)
+{
+	aggregate.merge(m_Stats);
+	m_Stats.clear();
+}
+
+void HttpTrafficStatsCollector::clear()
+{
+	m_Stats.clear();
+	m_FlowTable.clear();
+}
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// SSLTrafficStats + SSLTrafficStatsCollector
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+void SSLTrafficStats::clear()
+{
+	numOfPackets = 0;
+	payloadBytes = 0;
+	numOfFlows = 0;
+	numOfHandshakeCompleteFlows = 0;
+	numOfFlowsWithAlerts = 0;
+	numOfUntrackedPackets = 0;
+	portCount.clear();
+	versionCount.clear();
+	numOfClientHellos = 0;
+	serverNameCount.clear();
+	numOfServerHellos = 0;
+	cipherSuiteCount.clear();
+}
+
+void SSLTrafficStats::merge(const SSLTrafficStats& other)
+{
+	numOfPackets += other.numOfPackets;
+	payloadBytes += other.payloadBytes;
+	numOfFlows += other.numOfFlows;
+	numOfHandshakeCompleteFlows += other.numOfHandshakeCompleteFlows;
+	numOfFlowsWithAlerts += other.numOfFlowsWithAlerts;
+	numOfUntrackedPackets += other.numOfUntrackedPackets;
+	mergeCountMaps(portCount, other.portCount);
+	mergeCountMaps(versionCount, other.versionCount);
+	numOfClientHellos += other.numOfClientHellos;
+	serverNameCount.merge(other.serverNameCount);
+	numOfServerHellos += other.numOfServerHellos;
+	mergeCountMaps(cipherSuiteCount, other.cipherSuiteCount);
+}
+
+SSLTrafficStatsCollector::SSLTrafficStatsCollector(size_t maxFlows) : m_FlowTable(maxFlows)
+{
+}
+
+void SSLTrafficStatsCollector::collectStats(Packet& packet)
+{
+	TcpLayer* tcpLayer = packet.getLayerOfType<TcpLayer>();
+	if (tcpLayer == NULL)
+		return;
+
+	tcphdr* tcpHeader = tcpLayer->getTcpHeader();
+	uint16_t dstPort = netToHost16(tcpHeader->portDst);
+	uint16_t srcPort = netToHost16(tcpHeader->portSrc);
+	bool fromClient = !SSLLayer::isSSLPort(srcPort);
+
+	SSLLayer* sslLayer = packet.getLayerOfType<SSLLayer>();
+	if (sslLayer == NULL)
+	{
+		// packets without SSL/TLS records aren't counted, but a FIN or RST still closes a tracked flow
+		if (tcpHeader->finFlag || tcpHeader->rstFlag)
+		{
+			uint32_t flowKey = hash5Tuple(&packet);
+			FlowData* flowData = m_FlowTable.find(flowKey);
+			if (flowData != NULL && updateFinMask(flowData->finMask, tcpHeader, fromClient))
+				m_FlowTable.remove(flowKey);
+		}
+
+		return;
+	}
+
+	m_Stats.numOfPackets++;
+	m_Stats.payloadBytes += tcpLayer->getLayerPayloadSize();
+
+	uint32_t flowKey = hash5Tuple(&packet);
+	FlowData* flowData = m_FlowTable.find(flowKey);
+	if (flowData == NULL)
+	{
+		flowData = m_FlowTable.insert(flowKey);
+		if (flowData == NULL)
+		{
+			m_Stats.numOfUntrackedPackets++;
+			return;
+		}
+
+		m_Stats.numOfFlows++;
+		m_Stats.portCount[fromClient ? dstPort : srcPort]++;
+	}
+
+	for (; sslLayer != NULL; sslLayer = packet.getNextLayerOfType<SSLLayer>(sslLayer))
+	{
+		SSLRecordType recordType = sslLayer->getRecordType();
+		if (recordType == SSL_ALERT)
+		{
+			if (!flowData->seenAlert)
+			{
+				flowData->seenAlert = true;
+				m_Stats.numOfFlowsWithAlerts++;
+			}
+		}
+		else if (recordType == SSL_APPLICATION_DATA)
+		{
+			// the first application data record of a flow means the handshake was completed
+			if (!flowData->seenAppData)
+			{
+				flowData->seenAppData = true;
+				m_Stats.numOfHandshakeCompleteFlows++;
+			}
+		}
+		else if (recordType == SSL_HANDSHAKE)
+		{
+			SSLHandshakeLayer* handshakeLayer = static_cast<SSLHandshakeLayer*>(sslLayer);
+
+			SSLClientHelloMessage* clientHello = handshakeLayer->getHandshakeMessageOfType<SSLClientHelloMessage>();
+			if (clientHello != NULL)
+			{
+				m_Stats.numOfClientHellos++;
+				SSLServerNameIndicationExtension* sniExt = clientHello->getExtensionOfType<SSLServerNameIndicationExtension>();
+				if (sniExt != NULL)
+				{
+					uint16_t hostNameLength = 0;
+					const char* hostName = sniExt->getHostNameData(hostNameLength);
+					if (hostName != NULL)
+						m_Stats.serverNameCount.increment(hostName, hostNameLength);
+				}
+			}
+
+			SSLServerHelloMessage* serverHello = handshakeLayer->getHandshakeMessageOfType<SSLServerHelloMessage>();
+			if (serverHello != NULL)
+			{
+				m_Stats.numOfServerHellos++;
+				m_Stats.versionCount[serverHello->getHandshakeVersion().asUInt()]++;
+				SSLCipherSuite* cipherSuite = serverHello->getCipherSuite();
+				if (cipherSuite != NULL)
+					m_Stats.cipherSuiteCount[cipherSuite->getID()]++;
+			}
+		}
+	}
+
+	if (updateFinMask(flowData->finMask, tcpHeader, fromClient))
+		m_FlowTable.remove(flowKey);
+}
+
+void SSLTrafficStatsCollector::flushStats(SSLTrafficStats& aggregate)
+{
+	aggregate.merge(m_Stats);
+	m_Stats.clear();
+}
+
+void SSLTrafficStatsCollector::clear()
+{
+	m_Stats.clear();
+	m_FlowTable.clear();
+}
+
+} // namespace pcpp
@@ -0,0 +1,602 @@
+#define LOG_MODULE PacketLogModuleVoipCallTracker
+
+#include "VoipCallTracker.h"
+#include "SipLayer.h"
+#include "SdpLayer.h"
+#include "UdpLayer.h"
+#include "IPv4Layer.h"
+#include "IPv6Layer.h"
+#include "Logger.h"
+#include <string.h>
+#include <stdlib.h>
+#include <sstream>
+#include "EndianPortable.h"
+
+namespace pcpp
+{
+
+#define PCPP_RTP_HEADER_LEN 12
+#define PCPP_RTP_VERSION 2
+#define PCPP_RTP_DEFAULT_AUDIO_CLOCK_RATE 8000
+#define PCPP_RTP_DEFAULT_VIDEO_CLOCK_RATE 90000
+#define PCPP_VOIP_INITIAL_ENDPOINT_TABLE_SIZE 1024
+
+// compact forms of SIP header names (RFC 3261 section 7.3.3)
+#define PCPP_SIP_CALL_ID_FIELD_COMPACT "i"
+#define PCPP_SIP_FROM_FIELD_COMPACT    "f"
+#define PCPP_SIP_TO_FIELD_COMPACT      "t"
+
+static uint32_t hashMediaEndpoint(const uint8_t* addr, uint8_t addrLen, uint16_t port)
+{
+	// FNV-1a over the address bytes and the port
+	uint32_t hash = 2166136261U;
+	for (uint8_t i = 0; i < addrLen; i++)
+	{
+		hash ^= addr[i];
+		hash *= 16777619U;
+	}
+
+	hash ^= (port & 0xff);
+	hash *= 16777619U;
+	hash ^= (port >> 8);
+	hash *= 16777619U;
+	return hash;
+}
+
+static void getAddressBytes(const IPAddress& addr, const uint8_t*& bytes, uint8_t& len)
+{
+	if (addr.isIPv4())
+	{
+		bytes = addr.getIPv4().toBytes();
+		len = 4;
+	}
+	else
+	{
+		bytes = addr.getIPv6().toBytes();
+		len = 16;
+	}
+}
+
+static bool isTimeEarlier(const timespec& a, const timespec& b)
+{
+	return a.tv_sec < b.tv_sec || (a.tv_sec == b.tv_sec && a.tv_nsec < b.tv_nsec);
+}
+
+static std::string getSipFieldValue(const SipLayer* sipLayer, const char* fieldName, const char* compactFieldName)
+{
+	HeaderField* field = sipLayer->getFieldByName(fieldName);
+	if (field == NULL)
+		field = sipLayer->getFieldByName(compactFieldName);
+
+	return (field != NULL ? field->getFieldValue() : "");
+}
+
+// parse an SDP connection field value ("IN IP4 1.2.3.4" or "IN IP6 ::1", possibly with a "/ttl" suffix for multicast addresses)
+static IPAddress parseSdpConnection(const std::string& connection)
+{
+	std::istringstream stream(connection);
+	std::string netType, addrType, addr;
+	stream >> netType >> addrType >> addr;
+	if (netType != "IN" || (addrType != "IP4" && addrType != "IP6"))
+		return IPAddress();
+
+	size_t slashPos = addr.find('/');
+	if (slashPos != std::string::npos)
+		addr.erase(slashPos);
+
+	IPAddress result(addr);
+	if (!result.isValid())
+		return IPAddress();
+
+	return result;
+}
+
+
+// ~~~~~~~~~~~~~~~~~
+// RtpStream methods
+// ~~~~~~~~~~~~~~~~~
+
+RtpStream::RtpStream(VoipCall* call, const IPAddress& dstIP, uint16_t dstPort, const std::string& mediaType, uint32_t clockRate, bool towardsCaller) :
+	m_DstIP(dstIP), m_DstPort(dstPort), m_MediaType(mediaType), m_ClockRate(clockRate), m_TowardsCaller(towardsCaller),
+	m_Initialized(false), m_Ssrc(0), m_PayloadType(0), m_BaseSeq(0), m_MaxSeq(0), m_Cycles(0), m_ReceivedSinceSsrcChange(0),
+	m_LostBeforeSsrcChange(0), m_LastTransit(0), m_Jitter(0), m_MaxJitter(0), m_NumOfPackets(0), m_NumOfBytes(0), m_NumOfSequenceGaps(0),
+	m_NumOfOutOfOrderPackets(0), m_NumOfSsrcChanges(0), m_Call(call), m_NextInBucket(NULL), m_IsInTable(false)
+{
+	m_FirstPacketTime.tv_sec = 0;
+	m_FirstPacketTime.tv_nsec = 0;
+	m_LastPacketTime = m_FirstPacketTime;
+
+	const uint8_t* addrBytes;
+	getAddressBytes(dstIP, addrBytes, m_KeyAddrLen);
+	memset(m_KeyAddr, 0, sizeof(m_KeyAddr));
+	memcpy(m_KeyAddr, addrBytes, m_KeyAddrLen);
+	m_Hash = hashMediaEndpoint(m_KeyAddr, m_KeyAddrLen, m_DstPort);
+}
+
+uint64_t RtpStream::getNumOfLostPackets() const
+{
+	if (!m_Initialized)
+		return m_LostBeforeSsrcChange;
+
+	uint64_t expected = (uint64_t)m_Cycles + m_MaxSeq - m_BaseSeq + 1;
+	uint64_t lost = (expected > m_ReceivedSinceSsrcChange ? expected - m_ReceivedSinceSsrcChange : 0);
+	return m_LostBeforeSsrcChange + lost;
+}
+
+void RtpStream::processRtpPacket(const uint8_t* data, size_t dataLen, const timespec& arrivalTime)
+{
+	uint16_t seq = be16toh(*(uint16_t*)(data + 2));
+	uint32_t rtpTimestamp = be32toh(*(uint32_t*)(data + 4));
+	uint32_t ssrc = be32toh(*(uint32_t*)(data + 8));
+
+	// the arrival time in RTP timestamp units. Only differences between arrival times matter, so it can wrap around freely
+	uint32_t arrival = (uint32_t)((uint64_t)arrivalTime.tv_sec * m_ClockRate + (uint64_t)arrivalTime.tv_nsec * m_ClockRate / 1000000000ULL);
+	uint32_t transit = arrival - rtpTimestamp;
+
+	if (!m_Initialized || ssrc != m_Ssrc)
+	{
+		if (m_Initialized)
+		{
+			m_LostBeforeSsrcChange = getNumOfLostPackets();
+			m_NumOfSsrcChanges++;
+		}
+
+		m_Initialized = true;
+		m_Ssrc = ssrc;
+		m_BaseSeq = seq;
+		m_MaxSeq = seq;
+		m_Cycles = 0;
+		m_ReceivedSinceSsrcChange = 0;
+		m_LastTransit = transit;
+	}
+	else
+	{
+		uint16_t delta = seq - m_MaxSeq;
+		if (delta != 0 && delta < 0x8000)
+		{
+			if (seq < m_MaxSeq)
+				m_Cycles += 65536;
+
+			if (delta > 1)
+				m_NumOfSequenceGaps++;
+
+			m_MaxSeq = seq;
+		}
+		else
+		{
+			m_NumOfOutOfOrderPackets++;
+		}
+
+		// interarrival jitter as defined in RFC 3550 section 6.4.1
+		int32_t d = (int32_t)(transit - m_LastTransit);
+		m_LastTransit = transit;
+		if (d < 0)
+			d = -d;
+		m_Jitter += ((double)d - m_Jitter) / 16.0;
+		if (m_Jitter > m_MaxJitter)
+			m_MaxJitter = m_Jitter;
+	}
+
+	m_PayloadType = data[1] & 0x7f;
+	m_ReceivedSinceSsrcChange++;
+	m_NumOfPackets++;
+	m_NumOfBytes += dataLen;
+
+	if (m_NumOfPackets == 1)
+		m_FirstPacketTime = arrivalTime;
+	m_LastPacketTime = arrivalTime;
+}
+
+
+// ~~~~~~~~~~~~~~~~
+// VoipCall methods
+// ~~~~~~~~~~~~~~~~
+
+VoipCall::VoipCall(const std::string& callId, const std::string& from, const std::string& to, const timespec& startTime) :
+	m_CallId(callId), m_From(from), m_To(to), m_State(CallStateInviting), m_StartTime(startTime), m_LastActivityTime(startTime)
+{
+	m_AnswerTime.tv_sec = 0;
+	m_AnswerTime.tv_nsec = 0;
+	m_EndTime = m_AnswerTime;
+}
+
+VoipCall::~VoipCall()
+{
+	for (std::vector<RtpStream*>::iterator iter = m_Streams.begin(); iter != m_Streams.end(); iter++)
+		delete *iter;
+}
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~
+// VoipCallTracker methods
+// ~~~~~~~~~~~~~~~~~~~~~~~
+
+VoipCallTracker::VoipCallTracker(OnCallEnd onCallEnd, void* userCookie, size_t maxNumOfCalls) :
+	m_MaxNumOfCalls(maxNumOfCalls), m_OnCallEnd(onCallEnd), m_CallbackUserCookie(userCookie),
+	m_EndpointTable(PCPP_VOIP_INITIAL_ENDPOINT_TABLE_SIZE, (RtpStream*)NULL), m_NumOfEndpoints(0)
+{
+}
+
+VoipCallTracker::~VoipCallTracker()
+{
+	for (CallMap::iterator iter = m_CallMap.begin(); iter != m_CallMap.end(); iter++)
+		delete iter->second;
+}
+
+VoipCallTracker::ProcessResult VoipCallTracker::processPacket(Packet* packet)
+{
+	if (packet == NULL)
+		return PacketNotTracked;
+
+	timespec timestamp = packet->getRawPacketReadOnly()->getPacketTimeStamp();
+
+	if (packet->isPacketOfType(SIP))
+	{
+		processSipMessage(packet, timestamp);
+		return SipPacketProcessed;
+	}
+
+	if (m_NumOfEndpoints == 0)
+		return PacketNotTracked;
+
+	UdpLayer* udpLayer = packet->getLayerOfType<UdpLayer>();
+	if (udpLayer == NULL)
+		return PacketNotTracked;
+
+	const uint8_t* addr;
+	uint8_t addrLen;
+	IPv4Layer* ipv4Layer = packet->getPrevLayerOfType<IPv4Layer>(udpLayer);
+	if (ipv4Layer != NULL)
+	{
+		addr = (const uint8_t*)&ipv4Layer->getIPv4Header()->ipDst;
+		addrLen = 4;
+	}
+	else
+	{
+		IPv6Layer* ipv6Layer = packet->getPrevLayerOfType<IPv6Layer>(udpLayer);
+		if (ipv6Layer == NULL)
+			return PacketNotTracked;
+		addr = ipv6Layer->getIPv6Header()->ipDst;
+		addrLen = 16;
+	}
+
+	uint16_t dstPort = be16toh(udpLayer->getUdpHeader()->portDst);
+	RtpStream* stream = lookupEndpoint(addr, addrLen, dstPort, hashMediaEndpoint(addr, addrLen, dstPort));
+	if (stream == NULL)
+		return PacketNotTracked;
+
+	const uint8_t* rtpData = udpLayer->getLayerPayload();
+	size_t rtpDataLen = udpLayer->getLayerPayloadSize();
+
+	// RTCP packets multiplexed on the RTP port (RFC 5761) have packet types 200-204, which fall in payload type range 72-76
+	if (rtpDataLen < PCPP_RTP_HEADER_LEN || (rtpData[0] >> 6) != PCPP_RTP_VERSION || ((rtpData[1] & 0x7f) >= 72 && (rtpData[1] & 0x7f) <= 76))
+		return PacketNotTracked;
+
+	stream->processRtpPacket(rtpData, rtpDataLen, timestamp);
+	stream->m_Call->m_LastActivityTime = timestamp;
+	return RtpPacketProcessed;
+}
+
+void VoipCallTracker::processSipMessage(Packet* packet, const timespec& timestamp)
+{
+	SipLayer* sipLayer = packet->getLayerOfType<SipLayer>();
+	if (sipLayer == NULL)
+		return;
+
+	std::string callId = getSipFieldValue(sipLayer, PCPP_SIP_CALL_ID_FIELD, PCPP_SIP_CALL_ID_FIELD_COMPACT);
+	if (callId.empty())
+	{
+		LOG_DEBUG("SIP message without Call-ID, ignoring");
+		return;
+	}
+
+	CallMap::iterator iter = m_CallMap.find(callId);
+
+	if (sipLayer->getProtocol() == SIPRequest)
+	{
+		SipRequestLayer::SipMethod method = ((SipRequestLayer*)sipLayer)->getFirstLine()->getMethod();
+
+		if (iter == m_CallMap.end())
+		{
+			if (method != SipRequestLayer::SipINVITE)
+				return;
+
+			if (m_CallMap.size() >= m_MaxNumOfCalls)
+			{
+				LOG_DEBUG("Reached the maximum number of tracked calls (%d), ignoring call '%s'", (int)m_MaxNumOfCalls, callId.c_str());
+				return;
+			}
+
+			VoipCall* newCall = new VoipCall(callId,
+					getSipFieldValue(sipLayer, PCPP_SIP_FROM_FIELD, PCPP_SIP_FROM_FIELD_COMPACT),
+					getSipFieldValue(sipLayer, PCPP_SIP_TO_FIELD, PCPP_SIP_TO_FIELD_COMPACT),
+					timestamp);
+			iter = m_CallMap.insert(std::pair<std::string, VoipCall*>(callId, newCall)).first;
+			LOG_DEBUG("New call '%s'", callId.c_str());
+		}
+
+		VoipCall* call = iter->second;
+		call->m_LastActivityTime = timestamp;
+
+		if (method == SipRequestLayer::SipBYE)
+		{
+			endCall(iter, VoipCall::CallStateTerminated, timestamp);
+			return;
+		}
+
+		if (method == SipRequestLayer::SipCANCEL)
+		{
+			endCall(iter, VoipCall::CallStateCancelled, timestamp);
+			return;
+		}
+
+		// requests carrying SDP (INVITE, re-INVITE, ACK in late offer, UPDATE) are sent by the caller
+		learnMediaEndpoints(call, packet, true);
+		return;
+	}
+
+	// SIP response
+	if (iter == m_CallMap.end())
+		return;
+
+	VoipCall* call = iter->second;
+	call->m_LastActivityTime = timestamp;
+
+	std::string cseq = getSipFieldValue(sipLayer, PCPP_SIP_CSEQ_FIELD, PCPP_SIP_CSEQ_FIELD);
+	bool isInviteResponse = (cseq.find("INVITE") != std::string::npos);
+	int statusCode = ((SipResponseLayer*)sipLayer)->getFirstLine()->getStatusCodeAsInt();
+
+	if (isInviteResponse && (call->m_State == VoipCall::CallStateInviting || call->m_State == VoipCall::CallStateRinging))
+	{
+		if (statusCode >= 300)
+		{
+			endCall(iter, VoipCall::CallStateFailed, timestamp);
+			return;
+		}
+
+		if (statusCode >= 200)
+		{
+			call->m_State = VoipCall::CallStateEstablished;
+			call->m_AnswerTime = timestamp;
+		}
+		else if (statusCode >= 180)
+			call->m_State = VoipCall::CallStateRinging;
+	}
+
+	learnMediaEndpoints(call, packet, false);
+}
+
+void VoipCallTracker::learnMediaEndpoints(VoipCall* call, Packet* packet, bool announcedByCaller)
+{
+	SdpLayer* sdpLayer = packet->getLayerOfType<SdpLayer>();
+	if (sdpLayer == NULL)
+		return;
+
+	// walk the SDP fields in order: a 'c=' field before the first 'm=' field applies to all media, a 'c=' field after an 'm=' field
+	// applies only to that media
+	std::string sessionConnection;
+	std::string mediaConnection;
+	std::string mediaType;
+	std::string mediaFormat;
+	uint16_t mediaPort = 0;
+	uint32_t clockRate = 0;
+	bool inMediaSection = false;
+
+	for (HeaderField* field = sdpLayer->getFirstField(); ; field = sdpLayer->getNextField(field))
+	{
+		std::string fieldName = (field != NULL ? field->getFieldName() : "");
+
+		if (field == NULL || fieldName == PCPP_SDP_MEDIA_NAME_FIELD)
+		{
+			// flush the previous media section
+			if (inMediaSection && mediaPort != 0)
+			{
+				IPAddress addr = parseSdpConnection(mediaConnection.empty() ? sessionConnection : mediaConnection);
+				if (addr.isValid())
+				{
+					if (clockRate == 0)
+						clockRate = (mediaType == "video" ? PCPP_RTP_DEFAULT_VIDEO_CLOCK_RATE : PCPP_RTP_DEFAULT_AUDIO_CLOCK_RATE);
+					addStream(call, addr, mediaPort, mediaType, clockRate, announcedByCaller);
+				}
+			}
+
+			if (field == NULL)
+				break;
+
+			// m=<media> <port> <proto> <fmt> ...
+			std::istringstream stream(field->getFieldValue());
+			std::string portStr;
+			mediaType.clear();
+			mediaFormat.clear();
+			stream >> mediaType >> portStr;
+			std::string proto;
+			stream >> proto >> mediaFormat;
+			mediaPort = (uint16_t)atoi(portStr.c_str());
+			mediaConnection.clear();
+			clockRate = 0;
+			inMediaSection = true;
+		}
+		else if (fieldName == PCPP_SDP_CONNECTION_INFO_FIELD)
+		{
+			if (inMediaSection)
+				mediaConnection = field->getFieldValue();
+			else
+				sessionConnection = field->getFieldValue();
+		}
+		else if (fieldName == PCPP_SDP_MEDIA_ATTRIBUTE_FIELD && inMediaSection && clockRate == 0)
+		{
+			// a=rtpmap:<payload type> <encoding name>/<clock rate>[/<encoding parameters>] of the first (preferred) format
+			std::string value = field->getFieldValue();
+			std::string prefix = "rtpmap:" + mediaFormat + " ";
+			if (!mediaFormat.empty() && value.compare(0, prefix.length(), prefix) == 0)
+			{
+				size_t slashPos = value.find('/', prefix.length());
+				if (slashPos != std::string::npos)
+					clockRate = (uint32_t)atoi(value.c_str() + slashPos + 1);
+			}
+		}
+	}
+}
+
+void VoipCallTracker::addStream(VoipCall* call, const IPAddress& dstIP, uint16_t dstPort, const std::string& mediaType, uint32_t clockRate, bool towardsCaller)
+{
+	const uint8_t* addr;
+	uint8_t addrLen;
+	getAddressBytes(dstIP, addr, addrLen);
+	RtpStream* existing = lookupEndpoint(addr, addrLen, dstPort, hashMediaEndpoint(addr, addrLen, dstPort));
+
+	if (existing != NULL)
+	{
+		if (existing->m_Call == call)
+		{
+			// the endpoint was announced again (for example: in a re-INVITE or in a retransmission), keep its statistics
+			existing->m_MediaType = mediaType;
+			existing->m_ClockRate = clockRate;
+			return;
+		}
+
+		// the endpoint was reused by a new call while the old one is still tracked, the old call won't get media on it anymore
+		LOG_DEBUG("Media endpoint %s:%d moved from call '%s' to call '%s'", dstIP.toString().c_str(), dstPort,
+				existing->m_Call->m_CallId.c_str(), call->m_CallId.c_str());
+		removeEndpoint(existing);
+	}
+
+	RtpStream* stream = new RtpStream(call, dstIP, dstPort, mediaType, clockRate, towardsCaller);
+	call->m_Streams.push_back(stream);
+	insertEndpoint(stream);
+}
+
+void VoipCallTracker::endCall(CallMap::iterator iter, VoipCall::CallState state, const timespec& endTime)
+{
+	VoipCall* call = iter->second;
+	call->m_State = state;
+	call->m_EndTime = endTime;
+
+	for (std::vector<RtpStream*>::iterator streamIter = call->m_Streams.begin(); streamIter != call->m_Streams.end(); streamIter++)
+		removeEndpoint(*streamIter);
+
+	LOG_DEBUG("Call '%s' ended with state %d", call->m_CallId.c_str(), (int)state);
+
+	if (m_OnCallEnd != NULL)
+		m_OnCallEnd(call, m_CallbackUserCookie);
+
+	m_CallMap.erase(iter);
+	delete call;
+}
+
+const VoipCall* VoipCallTracker::getCall(const std::string& callId) const
+{
+	CallMap::const_iterator iter = m_CallMap.find(callId);
+	if (iter == m_CallMap.end())
+		return NULL;
+
+	return iter->second;
+}
+
+void VoipCallTracker::getCalls(std::vector<const VoipCall*>& calls) const
+{
+	for (CallMap::const_iterator iter = m_CallMap.begin(); iter != m_CallMap.end(); iter++)
+		calls.push_back(iter->second);
+}
+
+const RtpStream* VoipCallTracker::findStream(const IPAddress& dstIP, uint16_t dstPort) const
+{
+	const uint8_t* addr;
+	uint8_t addrLen;
+	getAddressBytes(dstIP, addr, addrLen);
+	return lookupEndpoint(addr, addrLen, dstPort, hashMediaEndpoint(addr, addrLen, dstPort));
+}
+
+size_t VoipCallTracker::purgeIdleCalls(const timespec& lastActivityThreshold)
+{
+	size_t numOfPurgedCalls = 0;
+	CallMap::iterator iter = m_CallMap.begin();
+	while (iter != m_CallMap.end())
+	{
+		CallMap::iterator curIter = iter++;
+		if (isTimeEarlier(curIter->second->m_LastActivityTime, lastActivityThreshold))
+		{
+			endCall(curIter, VoipCall::CallStateTimedOut, curIter->second->m_LastActivityTime);
+			numOfPurgedCalls++;
+		}
+	}
+
+	return numOfPurgedCalls;
+}
+
+void VoipCallTracker::endAllCalls()
+{
+	while (!m_CallMap.empty())
+		endCall(m_CallMap.begin(), VoipCall::CallStateTimedOut, m_CallMap.begin()->second->m_LastActivityTime);
+}
+
+RtpStream* VoipCallTracker::lookupEndpoint(const uint8_t* addr, uint8_t addrLen, uint16_t port, uint32_t hash) const
+{
+	RtpStream* stream = m_EndpointTable[hash & (m_EndpointTable.size() - 1)];
+	while (stream != NULL)
+	{
+		if (stream->m_Hash == hash && stream->m_DstPort == port && stream->m_KeyAddrLen == addrLen && memcmp(stream->m_KeyAddr, addr, addrLen) == 0)
+			return stream;
+
+		stream = stream->m_NextInBucket;
+	}
+
+	return NULL;
+}
+
+void VoipCallTracker::insertEndpoint(RtpStream* stream)
+{
+	if (m_NumOfEndpoints >= m_EndpointTable.size())
+		growEndpointTable();
+
+	RtpStream*& bucket = m_EndpointTable[stream->m_Hash & (m_EndpointTable.size() - 1)];
+	stream->m_NextInBucket = bucket;
+	bucket = stream;
+	stream->m_IsInTable = true;
+	m_NumOfEndpoints++;
+}
+
+void VoipCallTracker::removeEndpoint(RtpStream* stream)
+{
+	if (!stream->m_IsInTable)
+		return;
+
+	RtpStream** curPtr = &m_EndpointTable[stream->m_Hash & (m_EndpointTable.size() - 1)];
+	while (*curPtr != NULL)
+	{
+		if (*curPtr == stream)
+		{
+			*curPtr = stream->m_NextInBucket;
+			break;
+		}
+
+		curPtr = &((*curPtr)->m_NextInBucket);
+	}
+
+	stream->m_NextInBucket = NULL;
+	stream->m_IsInTable = false;
+	m_NumOfEndpoints--;
+}
+
+void VoipCallTracker::growEndpointTable()
+{
+	std::vector<RtpStream*> newTable(m_EndpointTable.size() * 2, (RtpStream*)NULL);
+	size_t mask = newTable.size() - 1;
+
+	for (std::vector<RtpStream*>::iterator iter = m_EndpointTable.begin(); iter != m_EndpointTable.end(); iter++)
+	{
+		RtpStream* stream = *iter;
+		while (stream != NULL)
+		{
+			RtpStream* next = stream->m_NextInBucket;
+			RtpStream*& bucket = newTable[stream->m_Hash & mask];
+			stream->m_NextInBucket = bucket;
+			bucket = stream;
+			stream = next;
+		}
+	}
+
+	m_EndpointTable.swap(newTable);
+}
+
+} // namespace pcpp
@@ -0,0 +1,324 @@
+#ifndef PCAPPP_ASYNC_FILE_DEVICE
+#define PCAPPP_ASYNC_FILE_DEVICE
+
+#include "PcapFileDevice.h"
+#include "PcapFilter.h"
+#include <vector>
+
+/**
+ * @file
+ * This file provides pcap and pcap-ng file readers and writers which do their own I/O instead of going through libpcap/LightPcapNg and stdio.
+ * The file is read and written in large chunks with several chunks in flight at the same time, so parsing and writing packets overlap with
+ * the disk I/O:
+ * - The reader keeps AsyncFileConfiguration#queueDepth chunks of the file read ahead. When a chunk is fully parsed it's immediately resubmitted
+ *   to read the next unread chunk of the file
+ * - The writer copies packets into a chunk and when the chunk is full it's submitted for writing and the writer moves on to the next chunk.
+ *   It waits only when all chunks are still being written
+ *
+ * On Linux the I/O is done with io_uring using buffers registered with the kernel, so a single thread can keep several NVMe drives busy by
+ * driving a few devices. When io_uring isn't available (older kernels, kernels where io_uring is disabled, or other platforms) the devices fall
+ * back to synchronous pread()/pwrite() of the same large chunks. Optionally files can be opened with O_DIRECT to bypass the page cache.<BR>
+ * The devices aren't supported on Windows
+ */
+
+/**
+* \namespace pcpp
+* \brief The main namespace for the PcapPlusPlus lib
+*/
+namespace pcpp
+{
+
+	class AsyncFileIO;
+
+	/**
+	 * @enum CaptureFileFormat
+	 * The format of a capture file
+	 */
+	enum CaptureFileFormat
+	{
+		/** A libpcap (.pcap) file */
+		CaptureFilePcap,
+		/** A pcap-ng (.pcapng) file */
+		CaptureFilePcapNg
+	};
+
+	/**
+	 * @struct AsyncFileConfiguration
+	 * The I/O configuration of AsyncPcapFileReaderDevice and AsyncPcapFileWriterDevice
+	 */
+	struct AsyncFileConfiguration
+	{
+		/**
+		 * @enum Backend
+		 * The I/O mechanism to use
+		 */
+		enum Backend
+		{
+			/** Use io_uring if available and fall back to pread()/pwrite() otherwise */
+			BackendAuto,
+			/** Use io_uring only. Opening the device fails if io_uring isn't available */
+			BackendIoUring,
+			/** Use synchronous pread()/pwrite() */
+			BackendPosix
+		};
+
+		/** The I/O backend. The default is BackendAuto */
+		Backend backend;
+
+		/** The size in bytes of each chunk read or written at once. It's rounded up to a multiple of 4096. The default is 1MB */
+		uint32_t chunkSize;
+
+		/** The number of chunks in flight. The default is 8 */
+		uint16_t queueDepth;
+
+		/**
+		 * Open the file with O_DIRECT to bypass the page cache. If the file system doesn't support O_DIRECT the file is opened without it.
+		 * Ignored when a writer is opened in append mode. The default is false
+		 */
+		bool directIO;
+
+		/**
+		 * A c'tor that sets the default values
+		 */
+		AsyncFileConfiguration() : backend(BackendAuto), chunkSize(1024 * 1024), queueDepth(8), directIO(false) {}
+	};
+
+
+	/**
+	 * @class AsyncPcapFileReaderDevice
+	 * A reader for pcap and pcap-ng files that reads ahead large chunks of the file asynchronously. The file format is detected by the file
+	 * content rather than by its extension. For pcap-ng files Enhanced Packet Blocks and Simple Packet Blocks are read and all other blocks
+	 * are skipped
+	 */
+	class AsyncPcapFileReaderDevice : public IFileReaderDevice
+	{
+	public:
+
+		/**
+		 * A constructor for this class that gets the full path of the file to open. Notice that after calling this constructor the file
+		 * isn't opened yet, so reading packets will fail. For opening the file call open()
+		 * @param[in] fileName The full path of the file to read
+		 * @param[in] config The I/O configuration
+		 */
+		AsyncPcapFileReaderDevice(const char* fileName, const AsyncFileConfiguration& config = AsyncFileConfiguration());
+
+		/**
+		 * A destructor for this class
+		 */
+		virtual ~AsyncPcapFileReaderDevice();
+
+		/**
+		 * @return The format of the file. Relevant only when the file is opened
+		 */
+		CaptureFileFormat getFileFormat() const { return m_FileFormat; }
+
+		/**
+		 * @return The link layer type of the file. For pcap-ng files it's the link layer type of the first interface
+		 */
+		LinkLayerType getLinkLayerType() const { return m_LinkLayerType; }
+
+		/**
+		 * @return True if the file is read with io_uring, false if it's read with pread()
+		 */
+		bool isUsingIoUring() const;
+
+		//overridden methods
+
+		/**
+		 * Read the next packet from the file. Before using this method please verify the file is opened using open()
+		 * @param[out] rawPacket A reference for an empty RawPacket where the packet will be written
+		 * @return True if a packet was read successfully. False will be returned if the file isn't opened (also, an error log will be printed),
+		 * if reached end-of-file or if the file is corrupted (an error log will be printed)
+		 */
+		bool getNextPacket(RawPacket& rawPacket);
+
+		/**
+		 * Open the file and start reading ahead
+		 * @return True if file was opened successfully or if file is already opened. False if opening the file failed or if the file isn't
+		 * a pcap or pcap-ng file
+		 */
+		bool open();
+
+		/**
+		 * Close the file. Reads that are still in flight are waited for
+		 */
+		void close();
+
+		/**
+		 * Get statistics of packets read so far. In the PcapStats struct, packetsRecv is the number of packets read and packetsDrop is the
+		 * number of packets that didn't match the filter
+		 * @param[out] stats The stats struct where stats are returned
+		 */
+		void getStatistics(PcapStats& stats) const;
+
+		/**
+		 * Set a filter for the reader. Only packets that match the filter will be read
+		 * @param[in] filterAsString The filter in Berkeley Packet Filter (BPF) syntax (http://biot.com/capstats/bpf.html)
+		 * @return True if the filter was set successfully, false otherwise
+		 */
+		bool setFilter(std::string filterAsString);
+
+	private:
+		struct PcapNgInterface
+		{
+			LinkLayerType linkType;
+			uint32_t snapLen;
+			uint64_t unitsPerSecond;
+		};
+
+		AsyncFileConfiguration m_Config;
+		AsyncFileIO* m_IO;
+		CaptureFileFormat m_FileFormat;
+		LinkLayerType m_LinkLayerType;
+		bool m_SwapBytes;
+		bool m_NanosecondPrecision;
+		std::vector<PcapNgInterface> m_PcapNgInterfaces;
+		BpfFilterWrapper m_BpfWrapper;
+
+		uint64_t m_FileSize;
+		uint64_t m_NextReadOffset;
+		uint16_t m_CurChunk;
+		uint32_t m_CurChunkPos;
+		uint32_t m_CurChunkLen;
+
+		// private copy c'tor
+		AsyncPcapFileReaderDevice(const AsyncPcapFileReaderDevice& other);
+		AsyncPcapFileReaderDevice& operator=(const AsyncPcapFileReaderDevice& other);
+
+		uint32_t swap32(uint32_t value) const;
+		uint16_t swap16(uint16_t value) const;
+		bool nextChunk();
+		bool hasMoreData();
+		bool readBytes(void* dest, uint32_t len);
+		bool skipBytes(uint64_t len);
+		bool readPcapNgSectionHeader(uint32_t bodyLen);
+		bool readPcapNgInterface(uint32_t bodyLen);
+		bool readNextPcapPacket(RawPacket& rawPacket);
+		bool readNextPcapNgPacket(RawPacket& rawPacket);
+	};
+
+
+	/**
+	 * @class AsyncPcapFileWriterDevice
+	 * A writer for pcap and pcap-ng files that copies packets into large chunks and writes full chunks asynchronously. Packets written to the
+	 * device reach the file only when their chunk is full, when flush() is called or when the device is closed. Pcap files are written with
+	 * microsecond timestamps and pcap-ng files with nanosecond timestamps (when appending, the resolution of the existing file is kept)
+	 */
+	class AsyncPcapFileWriterDevice : public IFileWriterDevice
+	{
+	public:
+
+		/**
+		 * A constructor for this class that gets the full path of the file to open for writing or create. Notice that after calling this
+		 * constructor the file isn't opened yet, so writing packets will fail. For opening the file call open()
+		 * @param[in] fileName The full path of the file
+		 * @param[in] linkLayerType The link layer type all packet in this file will be based on. The default is Ethernet
+		 * @param[in] fileFormat The file format. The default is pcap
+		 * @param[in] config The I/O configuration
+		 */
+		AsyncPcapFileWriterDevice(const char* fileName, LinkLayerType linkLayerType = LINKTYPE_ETHERNET, CaptureFileFormat fileFormat = CaptureFilePcap,
+				const AsyncFileConfiguration& config = AsyncFileConfiguration());
+
+		/**
+		 * A destructor for this class. Closes the file if it's opened
+		 */
+		virtual ~AsyncPcapFileWriterDevice();
+
+		/**
+		 * @return The format of the file
+		 */
+		CaptureFileFormat getFileFormat() const { return m_FileFormat; }
+
+		/**
+		 * @return True if the file is written with io_uring, false if it's written with pwrite()
+		 */
+		bool isUsingIoUring() const;
+
+		/**
+		 * @return The size of the file including the packets which weren't written to the file yet
+		 */
+		uint64_t getBytesWritten() const { return m_FileOffset + m_CurChunkPos; }
+
+		/**
+		 * Reserve disk space for the file with fallocate() so that writing doesn't need to allocate blocks and the file is less fragmented.
+		 * The file size isn't changed, and space that isn't used is released when the file is closed. Supported only on Linux and only when
+		 * the file system supports it. Must be called after open()
+		 * @param[in] size The number of bytes to reserve from the beginning of the file
+		 * @return True if the space was reserved, false otherwise
+		 */
+		bool preallocate(uint64_t size);
+
+		/**
+		 * Write a RawPacket to the file. Before using this method please verify the file is opened using open(). This method won't change the
+		 * written packet
+		 * @param[in] packet A reference for an existing RawPcket to write to the file
+		 * @return True if a packet was written successfully. False will be returned if the file isn't opened, if the packet link layer type
+		 * is different than the one defined for the file or if writing a previous chunk to the file failed (in all cases, an error will be
+		 * printed to log)
+		 */
+		bool writePacket(RawPacket const& packet);
+
+		/**
+		 * Write multiple RawPacket to the file. Before using this method please verify the file is opened using open()
+		 * @param[in] packets A reference for an existing RawPcketVector, all of its packets will be written to the file
+		 * @return True if all packets were written successfully to the file, false otherwise
+		 */
+		bool writePackets(const RawPacketVector& packets);
+
+		/**
+		 * Open the file in a write mode. If file doesn't exist, it will be created. If it does exist it will be overwritten
+		 * @return True if file was opened/created successfully or if file is already opened. False if opening the file failed for some reason
+		 * (an error will be printed to log)
+		 */
+		bool open();
+
+		/**
+		 * Same as open(), but enables to open the file in append mode in which packets will be appended to the file instead of overwriting
+		 * its current content. In append mode the file must exist, must be in the format given in the c'tor, its link layer type must be
+		 * the one given in the c'tor and (for pcap-ng files) it must have the byte order of this machine
+		 * @param[in] appendMode A boolean indicating whether to open the file in append mode or not
+		 * @return True of managed to open the file successfully, false otherwise
+		 */
+		bool open(bool appendMode);
+
+		/**
+		 * Write the packets that are still in the current chunk and wait until all chunks are written to the file
+		 * @return True if all chunks were written successfully, false otherwise
+		 */
+		bool flush();
+
+		/**
+		 * Flush and close the file
+		 */
+		void close();
+
+		/**
+		 * Get statistics of packets written so far
+		 * @param[out] stats The stats struct where stats are returned
+		 */
+		void getStatistics(PcapStats& stats) const;
+
+	private:
+		AsyncFileConfiguration m_Config;
+		AsyncFileIO* m_IO;
+		LinkLayerType m_LinkLayerType;
+		CaptureFileFormat m_FileFormat;
+		uint64_t m_TimestampUnitsPerSecond;
+		uint64_t m_FileOffset;
+		uint16_t m_CurChunk;
+		uint32_t m_CurChunkPos;
+		bool m_WriteError;
+
+		// private copy c'tor
+		AsyncPcapFileWriterDevice(const AsyncPcapFileWriterDevice& other);
+		AsyncPcapFileWriterDevice& operator=(const AsyncPcapFileWriterDevice& other);
+
+		bool checkAppendedFile(uint64_t fileSize);
+		bool writeFileHeader();
+		bool writeBytes(const void* data, uint32_t len);
+		bool submitCurrentChunk();
+	};
+
+} // namespace pcpp
+
+#endif /* PCAPPP_ASYNC_FILE_DEVICE */
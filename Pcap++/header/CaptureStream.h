@@ -0,0 +1,344 @@
+#ifndef PCAPPP_CAPTURE_STREAM
+#define PCAPPP_CAPTURE_STREAM
+
+#include "PcapDevice.h"
+#include "IpAddress.h"
+#include "RawPacket.h"
+
+/**
+ * @file
+ * This file includes a lightweight capture streaming protocol that lets one machine capture packets with any Pcap++ device and another
+ * machine receive them over TCP. It's an alternative to rpcapd/pcpp#PcapRemoteDevice that doesn't depend on WinPcap/Npcap remote capture
+ * and works with plain libpcap on every platform.<BR>
+ * The protocol has 2 sides:
+ * - pcpp#CaptureStreamServer - listens for a client and streams to it the packets it's fed with. The server doesn't capture packets by
+ *   itself, the user feeds it from any device: a live device (for example by passing CaptureStreamServer#onPacketArrives as the capture
+ *   callback of pcpp#PcapLiveDevice), a file (CaptureStreamServer#streamFile()), a DPDK or PF_RING device, etc.
+ * - pcpp#CaptureStreamClientDevice - a pcpp#IPcapDevice that connects to the server and receives packets in batches into RawPacketVector
+ *
+ * How it works:
+ * - Packets are sent in batches: the server accumulates packets until the batch reaches a maximum number of packets or bytes, or until
+ *   a batch timeout expires, and sends the whole batch as a single message. Each packet in the batch carries its timestamp (in nanosecond
+ *   resolution), captured length and original length
+ * - If both sides support it (PcapPlusPlus was built with zstd, see the --use-zstd configuration flag) and the client asks for it, batches
+ *   are compressed with zstd. A batch that doesn't shrink is sent uncompressed
+ * - Flow control is credit based: the client announces how many batches it's willing to receive ahead (its window) and grants another
+ *   credit each time it consumes a batch. The server never sends a batch without a credit; batches wait in a bounded queue, and when the
+ *   queue is full new packets are either dropped (the default, so a slow client never stalls the capture) or the producer is blocked
+ *   (useful when streaming files). The number of dropped packets is reported to the client
+ * - The client can set a BPF filter that the server applies before batching, so filtered-out packets never cross the network
+ *
+ * All protocol fields are in network byte order. Each message starts with a 12-byte header: magic (4 bytes, "PCST"), protocol version
+ * (1 byte), message type (1 byte), flags (2 bytes) and payload length (4 bytes)
+ */
+
+/**
+* \namespace pcpp
+* \brief The main namespace for the PcapPlusPlus lib
+*/
+namespace pcpp
+{
+
+	/** The default TCP port of the capture stream protocol */
+	#define PCPP_CAPTURE_STREAM_DEFAULT_PORT 2003
+
+	class PcapLiveDevice;
+	class IFileReaderDevice;
+	class CaptureStreamClientDevice;
+	struct CaptureStreamServerData;
+	struct CaptureStreamClientData;
+
+	/**
+	 * @class CaptureStreamServer
+	 * The server side of the capture stream protocol. Please refer to the documentation at the top of CaptureStream.h to understand how
+	 * it works. The server serves a single client at a time; when a client disconnects the server waits for the next one.<BR>
+	 * sendPacket() and sendPackets() are thread-safe and can be called from several capture threads at the same time. The network work
+	 * (accepting clients, compressing and sending batches, handling flow control messages) is done in a worker thread
+	 */
+	class CaptureStreamServer
+	{
+	public:
+
+		/**
+		 * @struct Config
+		 * The server configuration
+		 */
+		struct Config
+		{
+			/** Maximum number of packets in a batch. Default is 1024 */
+			uint32_t maxBatchPackets;
+			/** Maximum size of a batch in bytes (before compression). Default is 1MB */
+			uint32_t maxBatchBytes;
+			/** A partial batch is sent after it waited this many milliseconds. Default is 10 */
+			uint32_t batchTimeoutMsec;
+			/** Maximum number of batches waiting for the client. Default is 64 */
+			uint32_t maxQueuedBatches;
+			/** If true, sendPacket() blocks when the queue is full instead of dropping the packet. Default is false */
+			bool blockWhenQueueFull;
+			/** zstd compression level used when the client asks for compression. Default is 1 */
+			int compressionLevel;
+
+			/**
+			 * A c'tor that sets all default values
+			 */
+			Config() : maxBatchPackets(1024), maxBatchBytes(1024*1024), batchTimeoutMsec(10), maxQueuedBatches(64), blockWhenQueueFull(false), compressionLevel(1) {}
+		};
+
+		/**
+		 * @struct Stats
+		 * Server statistics
+		 */
+		struct Stats
+		{
+			/** Number of packets sent to clients */
+			uint64_t packetsSent;
+			/** Number of packets dropped because the queue was full */
+			uint64_t packetsDropped;
+			/** Number of packets that didn't match the client filter */
+			uint64_t packetsFiltered;
+			/** Number of batches sent to clients */
+			uint64_t batchesSent;
+			/** Number of bytes sent to clients (including protocol headers) */
+			uint64_t bytesSent;
+			/** Number of batch bytes before compression */
+			uint64_t uncompressedBytes;
+			/** Number of clients that connected since the server started */
+			uint32_t numOfClients;
+		};
+
+		/**
+		 * A c'tor for this class. It doesn't start the server, please call start()
+		 * @param[in] listenAddress The IPv4 address to listen on
+		 * @param[in] port The TCP port to listen on. If 0, a port is chosen by the OS and can be retrieved by getPort() after start()
+		 * @param[in] linkType The link layer type of the packets the server is going to be fed with. Default is LINKTYPE_ETHERNET
+		 * @param[in] config The server configuration
+		 */
+		CaptureStreamServer(const IPv4Address& listenAddress, uint16_t port = PCPP_CAPTURE_STREAM_DEFAULT_PORT, LinkLayerType linkType = LINKTYPE_ETHERNET, const Config& config = Config());
+
+		/**
+		 * A d'tor for this class. Stops the server if it's running
+		 */
+		~CaptureStreamServer();
+
+		/**
+		 * Start listening and start the worker thread
+		 * @return True if the server started successfully, false otherwise
+		 */
+		bool start();
+
+		/**
+		 * Send whatever is waiting to the current client (as long as it has credits), tell it the stream ended, and stop the server
+		 */
+		void stop();
+
+		/**
+		 * @return True if the server is running
+		 */
+		bool isRunning() const;
+
+		/**
+		 * @return True if a client is currently connected
+		 */
+		bool isClientConnected() const;
+
+		/**
+		 * @return The TCP port the server listens on
+		 */
+		uint16_t getPort() const { return m_Port; }
+
+		/**
+		 * Add a packet to the stream. The packet data is copied so the packet can be freed or reused right after this method returns.
+		 * Packets that arrive when no client is connected are queued (up to the queue limit) and sent once a client connects
+		 * @param[in] rawPacket The packet to send
+		 * @return True if the packet was added to the stream or filtered out by the client filter, false if it was dropped because the
+		 * queue is full or the server isn't running
+		 */
+		bool sendPacket(const RawPacket& rawPacket);
+
+		/**
+		 * Add several packets to the stream. See sendPacket()
+		 * @param[in] packets The packets to send
+		 * @return The number of packets that weren't dropped
+		 */
+		int sendPackets(const RawPacketVector& packets);
+
+		/**
+		 * Close the current partial batch so it's sent without waiting for the batch timeout
+		 */
+		void flush();
+
+		/**
+		 * Stream all packets of an opened file reader device. The producer is blocked (rather than packets being dropped) when the queue
+		 * is full, regardless of Config#blockWhenQueueFull
+		 * @param[in] reader An opened file reader device
+		 * @return The number of packets streamed or -1 if the server isn't running
+		 */
+		int streamFile(IFileReaderDevice& reader);
+
+		/**
+		 * A capture callback that can be passed to PcapLiveDevice#startCapture() to stream a live device, with a pointer to the server as
+		 * the user cookie
+		 * @param[in] packet The captured packet
+		 * @param[in] device The live device
+		 * @param[in] userCookie A pointer to a CaptureStreamServer instance
+		 */
+		static void onPacketArrives(RawPacket* packet, PcapLiveDevice* device, void* userCookie);
+
+		/**
+		 * Get the server statistics
+		 * @param[out] stats The object to fill
+		 */
+		void getStats(Stats& stats) const;
+
+	private:
+
+		IPv4Address m_ListenAddress;
+		uint16_t m_Port;
+		LinkLayerType m_LinkType;
+		Config m_Config;
+		CaptureStreamServerData* m_Data;
+
+		// private copy c'tor and assignment operator
+		CaptureStreamServer(const CaptureStreamServer& other);
+		CaptureStreamServer& operator=(const CaptureStreamServer& other);
+
+		bool addPacket(const RawPacket& rawPacket, bool block);
+		static void* workerThreadMain(void* ptr);
+	};
+
+
+	/**
+	 * @typedef OnCaptureStreamBatchArrives
+	 * A callback invoked by CaptureStreamClientDevice capture thread on every batch received
+	 * @param[in] packets The packets of the batch. The vector and the packets are freed after the callback returns, unless the user
+	 * detaches them
+	 * @param[in] device The device that received the batch
+	 * @param[in] userCookie The user cookie provided in CaptureStreamClientDevice#startCapture()
+	 */
+	typedef void (*OnCaptureStreamBatchArrives)(RawPacketVector& packets, CaptureStreamClientDevice* device, void* userCookie);
+
+	/**
+	 * @class CaptureStreamClientDevice
+	 * The client side of the capture stream protocol. Please refer to the documentation at the top of CaptureStream.h to understand how
+	 * it works. Packets can be received either synchronously with getNextBatch() or in a background thread with startCapture()
+	 */
+	class CaptureStreamClientDevice : public IPcapDevice
+	{
+	public:
+
+		/**
+		 * A c'tor for this class. It doesn't connect to the server, please call open()
+		 * @param[in] serverAddress The server IPv4 address
+		 * @param[in] port The server TCP port
+		 * @param[in] useCompression Ask the server to compress batches. If the server doesn't support compression batches are sent
+		 * uncompressed. Default is false
+		 * @param[in] windowSize The number of batches the server may send ahead before this client consumes them. Default is 8
+		 */
+		CaptureStreamClientDevice(const IPv4Address& serverAddress, uint16_t port = PCPP_CAPTURE_STREAM_DEFAULT_PORT, bool useCompression = false, uint32_t windowSize = 8);
+
+		/**
+		 * A d'tor for this class. Closes the device if it's open
+		 */
+		~CaptureStreamClientDevice();
+
+		/**
+		 * Receive the next batch. The received packets are appended to the vector and a flow control credit is sent back to the server.
+		 * Shouldn't be called while a capture thread started by startCapture() is running
+		 * @param[out] packets The vector the packets are appended to
+		 * @param[in] timeoutMsec Maximum time to wait for a batch in milliseconds. A negative value means waiting forever. Default is -1
+		 * @return The number of packets received, 0 if the timeout expired, or -1 if the server ended the stream or an error occurred
+		 */
+		int getNextBatch(RawPacketVector& packets, int timeoutMsec = -1);
+
+		/**
+		 * Start receiving batches in a background thread. The callback is invoked for every batch received
+		 * @param[in] onBatchArrives The callback to invoke
+		 * @param[in] userCookie A pointer to an object that will be passed to the callback
+		 * @return True if the capture thread started, false otherwise
+		 */
+		bool startCapture(OnCaptureStreamBatchArrives onBatchArrives, void* userCookie);
+
+		/**
+		 * Stop the capture thread started by startCapture()
+		 */
+		void stopCapture();
+
+		/**
+		 * @return True if the capture thread is running
+		 */
+		bool captureActive() const;
+
+		/**
+		 * @return True if the stream ended: the server stopped or the connection was closed
+		 */
+		bool isStreamEnded() const;
+
+		/**
+		 * @return The link layer type of the streamed packets, as announced by the server
+		 */
+		LinkLayerType getLinkType() const { return m_LinkType; }
+
+		/**
+		 * @return True if the server agreed to compress batches
+		 */
+		bool isCompressionEnabled() const { return m_CompressionEnabled; }
+
+		// implement abstract methods
+
+		/**
+		 * Connect to the server and negotiate the stream parameters
+		 * @return True if the connection succeeded, false otherwise
+		 */
+		bool open();
+
+		/**
+		 * Stop capturing if needed and disconnect from the server
+		 */
+		void close();
+
+		/**
+		 * Get statistics: packetsRecv is the number of packets received by this client and packetsDrop is the number of packets the
+		 * server dropped because its queue was full
+		 * @param[out] stats An object containing the stats
+		 */
+		void getStatistics(IPcapDevice::PcapStats& stats) const;
+
+		using IPcapDevice::setFilter;
+
+		/**
+		 * Set a BPF filter that is applied by the server. The filter is verified locally before it's sent. Packets already queued in the
+		 * server aren't affected
+		 * @param[in] filterAsString The filter in Berkeley Packet Filter (BPF) syntax (http://biot.com/capstats/bpf.html)
+		 * @return True if the filter is valid and was sent to the server, false otherwise
+		 */
+		bool setFilter(std::string filterAsString);
+
+		/**
+		 * Clear the filter on the server side
+		 * @return True if the request was sent to the server, false otherwise
+		 */
+		bool clearFilter();
+
+	private:
+
+		IPv4Address m_ServerAddress;
+		uint16_t m_Port;
+		bool m_UseCompression;
+		bool m_CompressionEnabled;
+		uint32_t m_WindowSize;
+		LinkLayerType m_LinkType;
+		uint64_t m_PacketsReceived;
+		uint64_t m_PacketsDroppedByServer;
+		CaptureStreamClientData* m_Data;
+
+		// private copy c'tor and assignment operator
+		CaptureStreamClientDevice(const CaptureStreamClientDevice& other);
+		CaptureStreamClientDevice& operator=(const CaptureStreamClientDevice& other);
+
+		bool sendFilter(const std::string& filterAsString);
+		static void* captureThreadMain(void* ptr);
+	};
+
+} // namespace pcpp
+
+#endif // PCAPPP_CAPTURE_STREAM
@@ -7,6 +7,7 @@
 #include "SystemUtils.h"
 #include "Device.h"
 #include "MBufRawPacket.h"
+#include "PollingPolicy.h"
 
 /**
  * @file
@@ -261,6 +262,13 @@ namespace pcpp
 			 */
 			uint64_t rssHashFunction;
 
+			/**
+			 * The polling policy of the capture threads, see PollingPolicy.h. The default is busy spin. Please note that
+			 * PollingModeInterrupt requires a PMD that supports RX interrupts and a kernel driver that delivers them (such as vfio-pci).
+			 * If the RX interrupt can't be registered when capture starts the capture thread falls back to PollingModeBackoff
+			 */
+			PollingPolicy pollingPolicy;
+
 			/**
 			 * A c'tor for this struct
 			 * @param[in] receiveDescriptorsNumber An optional parameter for defining the number of RX descriptors that will be allocated for each RX queue.
@@ -273,13 +281,15 @@ namespace pcpp
 			 * @param[in] rssKey A pointer to an array holding the RSS key to use for hashing specific header of received packets. If not
 			 * specified, there is a default key defined inside DpdkDevice
 			 * @param[in] rssKeyLength The length in bytes of the array pointed by rssKey. Default value is the length of default rssKey
+			 * @param[in] pollingPolicy The polling policy of the capture threads. Default is busy spin
 			 */
 			DpdkDeviceConfiguration(uint16_t receiveDescriptorsNumber = 128,
 					uint16_t transmitDescriptorsNumber = 512,
 					uint16_t flushTxBufferTimeout = 100,
 					uint64_t rssHashFunction = RSS_IPV4 | RSS_IPV6,
 					uint8_t* rssKey = DpdkDevice::m_RSSKey,
-					uint8_t rssKeyLength = 40)
+					uint8_t rssKeyLength = 40,
+					PollingPolicy pollingPolicy = PollingPolicy())
 			{
 				this->receiveDescriptorsNumber = receiveDescriptorsNumber;
 				this->transmitDescriptorsNumber = transmitDescriptorsNumber;
@@ -287,6 +297,7 @@ namespace pcpp
 				this->rssKey = rssKey;
 				this->rssKeyLength = rssKeyLength;
 				this->rssHashFunction = rssHashFunction;
+				this->pollingPolicy = pollingPolicy;
 			}
 		};
 
@@ -657,7 +668,7 @@ namespace pcpp
 		 * available to DPDK, there are not enough opened RX queues to match all cores in the core-mask, or if thread invocation failed. In
 		 * all of these cases an appropriate error message will be printed
 		 */
-		bool startCaptureMultiThreads(OnDpdkPacketsArriveCallback onPacketsArrive, void* onPacketsArriveUserCookie, CoreMask coreMask);
+		bool startCaptureMultiThreads(OnDpdkPacketsArriveCallback onPacketsArrive, void* onPacketsArriveUserCookie, const CoreMask& coreMask);
 
 		/**
 		 * If device is in capture mode started by invoking startCaptureSingleThread() or startCaptureMultiThreads(), this method
@@ -686,6 +697,21 @@ namespace pcpp
 		 */
 		void clearStatistics();
 
+		/**
+		 * Get the polling stats of the capture thread running on a certain core, which describe how this thread spends its time (see
+		 * PollingPolicy.h). The stats are zeroed whenever capture starts
+		 * @param[in] coreId The core ID of the capture thread
+		 * @param[out] stats A reference to a PollingStats object where stats will be written into. If no capture thread runs on this core
+		 * all counters are zero
+		 */
+		void getPollingStats(uint32_t coreId, PollingStats& stats) const;
+
+		/**
+		 * Get the sum of the polling stats of all capture threads of this device
+		 * @param[out] stats A reference to a PollingStats object where stats will be written into
+		 */
+		void getPollingStats(PollingStats& stats) const;
+
 		/**
 		 * DPDK supports an option to buffer TX packets and send them only when reaching a certain threshold. This method enables
 		 * the user to flush a TX buffer for certain TX queue and send the packets stored in it (you can read about it here:
@@ -743,6 +769,7 @@ namespace pcpp
 		{
 			int RxQueueId;
 			bool IsCoreInUse;
+			PollingController Poller;
 
 			void clear() { RxQueueId = -1; IsCoreInUse = false; }
 
@@ -757,9 +784,10 @@ namespace pcpp
 		bool startDevice();
 
 		static int dpdkCaptureThreadMain(void* ptr);
+		bool waitForRxInterrupt(uint16_t rxQueueId, uint32_t timeoutMsec);
 
 		void clearCoreConfiguration();
-		bool initCoreConfigurationByCoreMask(CoreMask coreMask);
+		bool initCoreConfigurationByCoreMask(const CoreMask& coreMask);
 		int getCoresInUseCount() const;
 
 		void setDeviceInfo();
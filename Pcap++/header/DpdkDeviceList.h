@@ -124,7 +124,7 @@ namespace pcpp
 		 * returned false it's impossible to use DPDK with PcapPlusPlus. You can get some more details about mbufs and pools in 
 		 * DpdkDevice.h file description or in DPDK web site
 		 */
-		static bool initDpdk(CoreMask coreMask, uint32_t mBufPoolSizePerDevice, uint8_t masterCore = 0);
+		static bool initDpdk(const CoreMask& coreMask, uint32_t mBufPoolSizePerDevice, uint8_t masterCore = 0);
 
 		/**
 		 * Get a DpdkDevice by port ID
@@ -187,7 +187,7 @@ namespace pcpp
 		 * returned false), number of cores differs from number of workers, core mask includes DPDK master core or if one of the 
 		 * worker threads couldn't be run
 		 */
-		bool startDpdkWorkerThreads(CoreMask coreMask, std::vector<DpdkWorkerThread*>& workerThreadsVec);
+		bool startDpdkWorkerThreads(const CoreMask& coreMask, std::vector<DpdkWorkerThread*>& workerThreadsVec);
 
 		/**
 		 * Assuming worker threads are running, this method orders them to stop by calling DpdkWorkerThread#stop(). Then it waits until
@@ -0,0 +1,201 @@
+#ifndef PCAPPP_PACKET_FLIGHT_RECORDER
+#define PCAPPP_PACKET_FLIGHT_RECORDER
+
+#include "RawPacket.h"
+#include "AsyncPcapFileDevice.h"
+#include <string>
+#include <vector>
+
+/**
+ * @file
+ * This file provides an in-memory "flight recorder" that keeps the most recent traffic of a capture and dumps a time window of it to a file
+ * on demand, for example when an alert fires, without writing all traffic to disk.<BR>
+ * How it works:
+ * - The memory is divided into lanes, one per capture thread. Each lane is a ring of large slabs and packets are stored one after the
+ *   other in the current slab: a small header (timestamp in nanoseconds, captured and original length, link type) followed by the packet
+ *   data. When the current slab is full the lane moves to its oldest slab and overwrites it
+ * - Adding a packet never takes a lock and never waits: each lane has a single writer (the capture thread that owns it), and readers
+ *   detect a slab being overwritten while they read it by its generation number, which the writer increments before reusing the slab
+ *   (a seqlock). Packets of a slab that was overwritten during a dump are simply not dumped: they were the oldest packets anyway
+ * - dumpRange() only queues the request. A background thread copies the relevant slabs one at a time, merges the lanes by timestamp,
+ *   applies the BPF filter and writes the packets to a pcap or pcap-ng file, so capture is never paused
+ */
+
+/**
+* \namespace pcpp
+* \brief The main namespace for the PcapPlusPlus lib
+*/
+namespace pcpp
+{
+
+	class PcapLiveDevice;
+	struct PacketFlightRecorderData;
+	struct FlightRecorderDumpRequest;
+
+	/**
+	 * A callback that is called from the background thread when a dump requested with PacketFlightRecorder#dumpRange() is finished
+	 * @param[in] fileName The name of the file the packets were written to
+	 * @param[in] numOfPackets The number of packets written to the file
+	 * @param[in] success False if the file couldn't be created, the filter is invalid or writing to the file failed
+	 * @param[in] userCookie A pointer to the object given in PacketFlightRecorder#dumpRange()
+	 */
+	typedef void (*OnFlightRecorderDumpFinishedCallback)(const std::string& fileName, uint64_t numOfPackets, bool success, void* userCookie);
+
+	/**
+	 * @class PacketFlightRecorder
+	 * An in-memory ring of the most recent packets with a triggered dump of a time window to a file. Please refer to the documentation at the
+	 * top of PacketFlightRecorder.h to understand how it works.<BR>
+	 * Feeding the recorder:
+	 * - PcapLiveDevice: pass onPacketArrives() as the capture callback and the recorder as the cookie (lane #0 is used)
+	 * - PfRingDevice: call addPackets() with the packet array and the thread ID as the lane
+	 * - DpdkDevice and any other device: call addPacket() for every packet with the thread/core ID as the lane
+	 *
+	 * Each lane must be fed by a single thread at a time. Packets within a lane are expected to arrive in timestamp order, which is the case
+	 * for any capture
+	 */
+	class PacketFlightRecorder
+	{
+	public:
+
+		/**
+		 * @struct Config
+		 * The recorder configuration
+		 */
+		struct Config
+		{
+			/** The total memory used to store packets, divided equally between the lanes. The default is 256MB */
+			uint64_t memorySize;
+			/** The size of each slab. It's also the maximum size of a stored packet. The default is 4MB */
+			uint32_t slabSize;
+			/** The number of lanes, usually the number of capture threads. The default is 1 */
+			uint16_t numOfLanes;
+			/** Packets longer than this are truncated when stored. 0 means store whole packets. The default is 0 */
+			uint32_t snapLen;
+
+			/**
+			 * A c'tor that sets the default values
+			 */
+			Config() : memorySize(256 * 1024 * 1024), slabSize(4 * 1024 * 1024), numOfLanes(1), snapLen(0) {}
+		};
+
+		/**
+		 * @struct Stats
+		 * Recorder statistics
+		 */
+		struct Stats
+		{
+			/** Number of packets added to the recorder */
+			uint64_t packetsAdded;
+			/** Number of packets that were overwritten by newer packets */
+			uint64_t packetsOverwritten;
+			/** Number of packets that weren't added because they were larger than a slab */
+			uint64_t packetsNotAdded;
+			/** Number of bytes of stored packets (including their headers) currently in the recorder */
+			uint64_t bytesStored;
+		};
+
+		/**
+		 * A c'tor for this class. Allocates all the memory for the recorder
+		 * @param[in] config The recorder configuration
+		 */
+		PacketFlightRecorder(const Config& config = Config());
+
+		/**
+		 * A d'tor for this class. Waits for all queued dumps to finish and frees the memory
+		 */
+		~PacketFlightRecorder();
+
+		/**
+		 * @return True if the memory for the recorder was allocated successfully, false otherwise (an error will be printed to log)
+		 */
+		bool isValid() const { return m_Lanes != NULL; }
+
+		/**
+		 * Store a packet in the recorder, overwriting the oldest packets of the lane if needed. This method never blocks
+		 * @param[in] rawPacket The packet to store
+		 * @param[in] lane The lane to store the packet in. Each lane must be fed by a single thread at a time
+		 * @return True if the packet was stored, false if the lane is invalid or the packet is larger than a slab
+		 */
+		bool addPacket(const RawPacket& rawPacket, uint16_t lane = 0);
+
+		/**
+		 * Store multiple packets in the recorder
+		 * @param[in] packets An array of packets
+		 * @param[in] numOfPackets The number of packets in the array
+		 * @param[in] lane The lane to store the packets in
+		 * @return The number of packets stored
+		 */
+		uint32_t addPackets(const RawPacket* packets, uint32_t numOfPackets, uint16_t lane = 0);
+
+		/**
+		 * A capture callback that can be given to PcapLiveDevice#startCapture() with the recorder as the user cookie. Packets are stored in
+		 * lane #0
+		 */
+		static void onPacketArrives(RawPacket* rawPacket, PcapLiveDevice* device, void* recorder);
+
+		/**
+		 * Queue a dump of all stored packets whose timestamps are in [startTime, endTime] to a file. The method returns immediately and the
+		 * dump is done in a background thread while packets keep being added. Packets are written in timestamp order. Dumps are done one
+		 * after the other in the order they were requested
+		 * @param[in] startTime The timestamp of the first packet to dump
+		 * @param[in] endTime The timestamp of the last packet to dump
+		 * @param[in] fileName The file to write the packets to. If it exists it's overwritten
+		 * @param[in] filter An optional BPF filter. Only packets that match it are dumped
+		 * @param[in] fileFormat The file format. For pcap files only packets of the first dumped packet's link layer type are written
+		 * @param[in] onFinished An optional callback to call when the dump is finished
+		 * @param[in] userCookie A pointer that is passed to the callback
+		 * @return True if the dump was queued, false if the recorder isn't valid or the time range is invalid
+		 */
+		bool dumpRange(const timespec& startTime, const timespec& endTime, const std::string& fileName, const std::string& filter = "",
+				CaptureFileFormat fileFormat = CaptureFilePcap, OnFlightRecorderDumpFinishedCallback onFinished = NULL, void* userCookie = NULL);
+
+		/**
+		 * Wait until all queued dumps are finished
+		 */
+		void waitForDumps();
+
+		/**
+		 * @return The number of dumps that were queued and aren't finished yet
+		 */
+		uint32_t getNumOfPendingDumps() const;
+
+		/**
+		 * Get the time range of the stored packets. The range may change right after it's returned since packets keep being added
+		 * @param[out] oldest The timestamp of the oldest stored packet
+		 * @param[out] newest The timestamp of the newest stored packet
+		 * @return False if no packets are stored, true otherwise
+		 */
+		bool getTimeRange(timespec& oldest, timespec& newest) const;
+
+		/**
+		 * Get the recorder statistics. The statistics of each lane are read without locking so they may be slightly stale
+		 * @param[out] stats The stats struct where stats are returned
+		 */
+		void getStatistics(Stats& stats) const;
+
+		/**
+		 * @return The configuration of the recorder. The memory size may be rounded down to a whole number of slabs per lane
+		 */
+		const Config& getConfig() const { return m_Config; }
+
+	private:
+		struct Slab;
+		struct Lane;
+
+		Config m_Config;
+		uint32_t m_SlabsPerLane;
+		Lane* m_Lanes;
+		PacketFlightRecorderData* m_Data;
+
+		// private copy c'tor
+		PacketFlightRecorder(const PacketFlightRecorder& other);
+		PacketFlightRecorder& operator=(const PacketFlightRecorder& other);
+
+		void startNewSlab(Lane& lane, uint64_t timestamp);
+		bool doDump(const FlightRecorderDumpRequest& request, uint64_t& numOfPackets);
+		static void* dumpThreadMain(void* ptr);
+	};
+
+} // namespace pcpp
+
+#endif /* PCAPPP_PACKET_FLIGHT_RECORDER */
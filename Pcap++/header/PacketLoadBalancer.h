@@ -0,0 +1,304 @@
+#ifndef PCAPPP_PACKET_LOAD_BALANCER
+#define PCAPPP_PACKET_LOAD_BALANCER
+
+#include "RawPacket.h"
+#include <string>
+#include <vector>
+
+/**
+ * @file
+ * This file provides a software load balancer that spreads the packets of a single capture source (for example a PcapLiveDevice or a
+ * pcap file) between several workers, keeping all packets of a flow on the same worker.<BR>
+ * Only DpdkDevice (RSS) and PfRingDevice (channel distribution) spread packets in hardware. With any other source all packets arrive to a
+ * single thread, so the load balancer does this in software:
+ * - Each packet is hashed by its 5-tuple, symmetrically, so both directions of a connection reach the same worker (like
+ *   pcpp#hash5Tuple() with directionUnique=false). IP packets that aren't TCP or UDP are hashed by their IP addresses, and non-IP
+ *   packets all go to the worker of hash 0
+ * - The hash selects a bucket of an indirection table (like the RSS redirection table of a NIC) and the bucket selects the worker. The
+ *   packets of each bucket are counted, so rebalance() can move buckets from the busiest worker to the least busy one, and the stats show
+ *   when a single bucket (usually a single large flow) dominates, which moving buckets can't fix. A moved bucket keeps going to its old
+ *   worker until the old worker received the packets of the bucket that are in its ring, so the packets of a flow are never reordered
+ * - Each worker has a lock-free single-producer single-consumer ring. The distributing thread copies the packet into a slot of the ring
+ *   of its worker and never waits: if the ring is full the packet is dropped and counted
+ * - The rings don't contain pointers, so they can be placed in shared memory (see Config#sharedMemoryName): workers can then be other
+ *   processes that attach to the rings with PacketLoadBalancerWorker
+ */
+
+/**
+* \namespace pcpp
+* \brief The main namespace for the PcapPlusPlus lib
+*/
+namespace pcpp
+{
+
+	class PcapLiveDevice;
+
+	/**
+	 * A callback that is called with the packets a worker received, in batches of up to 64 packets
+	 * @param[in] packets An array of packets. The packets point to the ring memory and are valid only until the callback returns, so they
+	 * need to be copied if they're used later
+	 * @param[in] numOfPackets The number of packets in the array
+	 * @param[in] workerId The worker the packets were distributed to
+	 * @param[in] userCookie A pointer to the object given to the receivePackets() method
+	 */
+	typedef void (*OnBalancedPacketsCallback)(RawPacket* packets, uint32_t numOfPackets, uint16_t workerId, void* userCookie);
+
+	/**
+	 * @class PacketLoadBalancer
+	 * Distributes packets between workers by flow. Please refer to the documentation at the top of PacketLoadBalancer.h to understand how
+	 * it works.<BR>
+	 * Packets are distributed by a single thread at a time (for example the capture thread): call distributePacket() for every packet, or
+	 * pass onPacketArrives() as the capture callback of a PcapLiveDevice with the balancer as the cookie. Worker threads call
+	 * receivePackets() with their worker ID, and worker processes use PacketLoadBalancerWorker
+	 */
+	class PacketLoadBalancer
+	{
+	public:
+
+		/**
+		 * @struct Config
+		 * The load balancer configuration
+		 */
+		struct Config
+		{
+			/** The number of workers. The default is 2 */
+			uint16_t numOfWorkers;
+			/** The number of packets each worker ring can hold. Rounded up to a power of 2. The default is 4096 */
+			uint32_t ringSize;
+			/** Packets longer than this are truncated (their frame length is kept). The default is 2048 */
+			uint32_t maxPacketLen;
+			/** The number of buckets in the indirection table. More buckets allow finer rebalancing. The default is 256 */
+			uint32_t numOfBuckets;
+			/**
+			 * If not empty, the rings are created in a POSIX shared memory object with this name (for example "/pcpp_balancer") so worker
+			 * processes can attach to them. Creating the balancer fails if an object with this name already exists, and the object is removed
+			 * when the balancer is freed. Not supported on Windows. The default is empty, which means the rings are in the memory of this
+			 * process
+			 */
+			std::string sharedMemoryName;
+
+			/**
+			 * A c'tor that sets the default values
+			 */
+			Config() : numOfWorkers(2), ringSize(4096), maxPacketLen(2048), numOfBuckets(256) {}
+		};
+
+		/**
+		 * @struct WorkerStats
+		 * The statistics of a single worker
+		 */
+		struct WorkerStats
+		{
+			/** Number of packets distributed to the worker */
+			uint64_t packetsDistributed;
+			/** Number of bytes distributed to the worker (after truncation) */
+			uint64_t bytesDistributed;
+			/** Number of packets that weren't distributed because the worker ring was full */
+			uint64_t packetsDropped;
+			/** Number of packets in the worker ring that the worker didn't receive yet */
+			uint32_t packetsQueued;
+			/** Number of buckets of the indirection table assigned to the worker, including buckets that are still moving to it */
+			uint32_t numOfBuckets;
+		};
+
+		/**
+		 * @struct Stats
+		 * The load balancer statistics
+		 */
+		struct Stats
+		{
+			/** Number of packets distributed to all workers */
+			uint64_t packetsDistributed;
+			/** Number of packets that weren't distributed because a worker ring was full */
+			uint64_t packetsDropped;
+			/** Number of packets that weren't IP packets. They all go to the worker of hash 0 */
+			uint64_t packetsWithoutFlow;
+			/** Number of times rebalance() was called */
+			uint64_t numOfRebalances;
+			/** Number of buckets moved between workers by rebalance() */
+			uint64_t numOfBucketsMoved;
+			/**
+			 * The packets of the busiest worker divided by the average packets per worker, since the last rebalance. 1 means a perfect
+			 * balance and numOfWorkers means all packets go to one worker. 0 if no packets were distributed since the last rebalance
+			 */
+			double imbalance;
+			/** The busiest bucket since the last rebalance */
+			uint32_t busiestBucket;
+			/**
+			 * The portion (between 0 and 1) of the packets since the last rebalance that belong to the busiest bucket. If it's larger than
+			 * 1/numOfWorkers, a single bucket (usually a single flow) loads its worker more than the average and rebalancing can't help
+			 */
+			double busiestBucketShare;
+		};
+
+		/**
+		 * A c'tor for this class. Allocates the worker rings, in shared memory if Config#sharedMemoryName is set
+		 * @param[in] config The load balancer configuration
+		 */
+		PacketLoadBalancer(const Config& config = Config());
+
+		/**
+		 * A d'tor for this class. Frees the rings and removes the shared memory object if one was created. Worker processes that are
+		 * attached to it keep their mapping until they detach
+		 */
+		~PacketLoadBalancer();
+
+		/**
+		 * @return True if the rings were allocated successfully, false otherwise (an error will be printed to log)
+		 */
+		bool isValid() const { return m_Memory != NULL; }
+
+		/**
+		 * Hash a packet by its flow and copy it to the ring of the worker of its bucket. This method never blocks
+		 * @param[in] rawPacket The packet to distribute
+		 * @return The worker ID the packet was distributed to, or -1 if the balancer isn't valid or the worker ring is full
+		 */
+		int distributePacket(const RawPacket& rawPacket);
+
+		/**
+		 * Copy a packet to the ring of the worker of the bucket of a hash that was already calculated, for example by the NIC
+		 * @param[in] rawPacket The packet to distribute
+		 * @param[in] hash The flow hash of the packet. It should be symmetric to keep both directions of a flow on the same worker
+		 * @return The worker ID the packet was distributed to, or -1 if the balancer isn't valid or the worker ring is full
+		 */
+		int distributePacket(const RawPacket& rawPacket, uint32_t hash);
+
+		/**
+		 * A capture callback that can be given to PcapLiveDevice#startCapture() with the balancer as the user cookie
+		 */
+		static void onPacketArrives(RawPacket* rawPacket, PcapLiveDevice* device, void* balancer);
+
+		/**
+		 * Calculate the symmetric flow hash that distributePacket() uses
+		 * @param[in] rawPacket The packet to hash
+		 * @return The flow hash or 0 if the packet isn't an IP packet
+		 */
+		static uint32_t getFlowHash(const RawPacket& rawPacket);
+
+		/**
+		 * Receive the packets waiting in the ring of a worker thread. The packets are given to the callback without copying and their slots
+		 * are reused only after it returns. Each worker should be received by a single thread at a time
+		 * @param[in] workerId The worker ID
+		 * @param[in] onPacketsReceived The callback to call with the packets
+		 * @param[in] userCookie A pointer that is passed to the callback
+		 * @param[in] maxNumOfPackets The maximum number of packets to receive. The default is 64
+		 * @return The number of packets received, 0 if the ring is empty or the worker ID is invalid
+		 */
+		uint32_t receivePackets(uint16_t workerId, OnBalancedPacketsCallback onPacketsReceived, void* userCookie = NULL, uint32_t maxNumOfPackets = 64);
+
+		/**
+		 * @param[in] hash A flow hash
+		 * @return The worker that the packets with this hash are currently distributed to. After rebalance() moved the bucket of the hash,
+		 * this is still the old worker until the move is done (see rebalance())
+		 */
+		uint16_t getWorkerOfHash(uint32_t hash) const;
+
+		/**
+		 * Move buckets from the busiest workers to the least busy ones according to the packets counted since the last rebalance, and
+		 * start counting again. Flows of a moved bucket continue on another worker, so workers that keep flow state should expect it.
+		 * The order of the packets of a flow is kept: the packets of a moved bucket keep going to the old worker until it received all the
+		 * packets of the bucket that were in its ring, and only then go to the new worker. A bucket whose packets arrive faster than the old
+		 * worker receives them therefore moves only when its traffic pauses.
+		 * Should be called by the thread that distributes the packets, for example every few seconds
+		 * @return The number of buckets moved
+		 */
+		uint32_t rebalance();
+
+		/**
+		 * Get the statistics of a worker. The counters are read without locking so they may be slightly stale
+		 * @param[in] workerId The worker ID
+		 * @param[out] stats The stats struct where stats are returned
+		 * @return False if the worker ID is invalid, true otherwise
+		 */
+		bool getWorkerStatistics(uint16_t workerId, WorkerStats& stats) const;
+
+		/**
+		 * Get the load balancer statistics. The counters are read without locking so they may be slightly stale
+		 * @param[out] stats The stats struct where stats are returned
+		 */
+		void getStatistics(Stats& stats) const;
+
+		/**
+		 * @return The configuration of the load balancer. The ring size may be rounded up
+		 */
+		const Config& getConfig() const { return m_Config; }
+
+	private:
+		struct WorkerCounters;
+
+		Config m_Config;
+		uint8_t* m_Memory;
+		size_t m_MemorySize;
+		bool m_IsSharedMemory;
+		// the worker each bucket is distributed to, and the worker it's moving to (the same worker if it isn't moving)
+		std::vector<uint16_t> m_BucketToWorker;
+		std::vector<uint16_t> m_BucketNextWorker;
+		// for a moving bucket, the head index of the old worker ring after the last packet of the bucket that was distributed to it
+		std::vector<uint32_t> m_BucketFence;
+		std::vector<uint64_t> m_BucketPackets;
+		WorkerCounters* m_WorkerCounters;
+		uint64_t m_PacketsWithoutFlow;
+		uint64_t m_NumOfRebalances;
+		uint64_t m_NumOfBucketsMoved;
+
+		// private copy c'tor
+		PacketLoadBalancer(const PacketLoadBalancer& other);
+		PacketLoadBalancer& operator=(const PacketLoadBalancer& other);
+
+		void freeMemory();
+	};
+
+	/**
+	 * @class PacketLoadBalancerWorker
+	 * A worker in another process that receives the packets a PacketLoadBalancer distributes to it through shared memory. The balancer
+	 * must be created with Config#sharedMemoryName before the worker attaches to it
+	 */
+	class PacketLoadBalancerWorker
+	{
+	public:
+
+		/**
+		 * A c'tor for this class. Attaches to the rings of a load balancer in shared memory
+		 * @param[in] sharedMemoryName The shared memory name that was set in the balancer configuration
+		 * @param[in] workerId The worker ID, between 0 and the number of workers - 1
+		 */
+		PacketLoadBalancerWorker(const std::string& sharedMemoryName, uint16_t workerId);
+
+		/**
+		 * A d'tor for this class. Detaches from the shared memory
+		 */
+		~PacketLoadBalancerWorker();
+
+		/**
+		 * @return True if the worker is attached to the rings, false otherwise (an error will be printed to log)
+		 */
+		bool isValid() const { return m_Memory != NULL; }
+
+		/**
+		 * @return The worker ID
+		 */
+		uint16_t getWorkerId() const { return m_WorkerId; }
+
+		/**
+		 * Receive the packets waiting in the ring of this worker. The packets are given to the callback without copying and their slots are
+		 * reused only after it returns
+		 * @param[in] onPacketsReceived The callback to call with the packets
+		 * @param[in] userCookie A pointer that is passed to the callback
+		 * @param[in] maxNumOfPackets The maximum number of packets to receive. The default is 64
+		 * @return The number of packets received, 0 if the ring is empty or the worker isn't valid
+		 */
+		uint32_t receivePackets(OnBalancedPacketsCallback onPacketsReceived, void* userCookie = NULL, uint32_t maxNumOfPackets = 64);
+
+	private:
+		uint8_t* m_Memory;
+		size_t m_MemorySize;
+		uint16_t m_WorkerId;
+
+		// private copy c'tor
+		PacketLoadBalancerWorker(const PacketLoadBalancerWorker& other);
+		PacketLoadBalancerWorker& operator=(const PacketLoadBalancerWorker& other);
+	};
+
+} // namespace pcpp
+
+#endif /* PCAPPP_PACKET_LOAD_BALANCER */
@@ -0,0 +1,232 @@
+#ifndef PCAPPP_PACKET_MERGER
+#define PCAPPP_PACKET_MERGER
+
+#include "RawPacket.h"
+#include "PollingPolicy.h"
+
+/**
+ * @file
+ * This file provides a merging stage that turns the packets of several capture queues into a single stream in global timestamp order.<BR>
+ * Multi-queue captures (for example DpdkDevice#startCaptureMultiThreads() or PfRingDevice#openMultiRxChannels()) deliver each RX queue to
+ * a different thread. Packets within a queue are in timestamp order but packets of different queues are not, so writing a single pcap
+ * file or doing reassembly across queues requires sorting. How the merger works:
+ * - Each capture queue is a source. Each source has its own lock-free single-producer single-consumer ring: the capture thread copies the
+ *   packet into a preallocated slot, so adding a packet never allocates memory, never takes a lock and never waits (if the ring is full the
+ *   packet is dropped and counted)
+ * - Each source also has a watermark: the timestamp before which the source won't add any more packets. It's advanced automatically by
+ *   every added packet, and an idle capture thread can advance it with advanceWatermark() so it doesn't hold back the other sources
+ * - The merge step repeatedly takes the packet with the lowest timestamp among the heads of all rings. It's emitted once it's known to be
+ *   in order - every other source has a packet queued or a watermark at or after it - or when waiting for it is bounded by the reorder
+ *   window: it's older by the window than the newest packet seen, or it has been waiting in the merger for the window duration
+ * - Packets are emitted in batches to a user callback, pointing directly into the rings (no copy). Packets that arrive after newer packets
+ *   were already emitted (later than the reorder window) are emitted as soon as possible and counted as late
+ *
+ * The merge step can run in a background thread (start()) or be called by the user (mergePackets()). The time each packet spends in the
+ * merger is measured, so the latency added by the reorder window can be monitored (see PacketMerger#Stats)
+ */
+
+/**
+* \namespace pcpp
+* \brief The main namespace for the PcapPlusPlus lib
+*/
+namespace pcpp
+{
+
+	struct PacketMergerThreadData;
+
+	class PacketMerger;
+
+	/**
+	 * A callback that is called with every batch of merged packets
+	 * @param[in] packets An array of packets in timestamp order. The packets point to the merger memory and are valid only until the callback
+	 * returns, so they need to be copied if they're used later
+	 * @param[in] numOfPackets The number of packets in the array
+	 * @param[in] merger The merger instance
+	 * @param[in] userCookie A pointer to the object given in PacketMerger#start() or PacketMerger#mergePackets()
+	 */
+	typedef void (*OnPacketsMergedCallback)(RawPacket* packets, uint32_t numOfPackets, PacketMerger* merger, void* userCookie);
+
+	/**
+	 * @class PacketMerger
+	 * Merges the packets of several capture queues into batches in global timestamp order. Please refer to the documentation at the top of
+	 * PacketMerger.h to understand how it works.<BR>
+	 * Feeding the merger:
+	 * - PfRingDevice: call addPackets() with the packet array and the thread ID as the source
+	 * - DpdkDevice and any other device: call addPacket() for every packet with the thread/queue ID as the source
+	 *
+	 * Each source must be fed by a single thread at a time, and packets of a source are expected to be in timestamp order
+	 */
+	class PacketMerger
+	{
+	public:
+
+		/**
+		 * @struct Config
+		 * The merger configuration
+		 */
+		struct Config
+		{
+			/** The number of sources, usually the number of capture queues. The default is 1 */
+			uint16_t numOfSources;
+			/** The number of packets each source ring can hold. Rounded up to a power of 2. The default is 4096 */
+			uint32_t queueSize;
+			/** Packets longer than this are truncated (their frame length is kept). The default is 2048 */
+			uint32_t maxPacketLen;
+			/** The reorder window in nanoseconds: the maximum time a packet waits for packets of other sources. The default is 1msec */
+			uint64_t reorderWindowNsec;
+			/** The maximum number of packets in a batch given to the callback. The default is 64 */
+			uint32_t maxBatchSize;
+			/** The polling policy of the merge thread when there are no packets to emit. The default is backoff up to 100usec */
+			PollingPolicy pollingPolicy;
+
+			/**
+			 * A c'tor that sets the default values
+			 */
+			Config() : numOfSources(1), queueSize(4096), maxPacketLen(2048), reorderWindowNsec(1000000), maxBatchSize(64),
+				pollingPolicy(PollingModeBackoff, 1000, 1, 100) {}
+		};
+
+		/**
+		 * @struct Stats
+		 * Merger statistics
+		 */
+		struct Stats
+		{
+			/** Number of packets added to the merger */
+			uint64_t packetsAdded;
+			/** Number of packets that weren't added because the ring of their source was full */
+			uint64_t packetsDropped;
+			/** Number of packets that were truncated because they were longer than Config#maxPacketLen */
+			uint64_t packetsTruncated;
+			/** Number of packets emitted to the callback */
+			uint64_t packetsEmitted;
+			/** Number of emitted packets whose timestamp is earlier than a packet emitted before them */
+			uint64_t packetsLate;
+			/** Number of batches emitted to the callback */
+			uint64_t batchesEmitted;
+			/** The sum of the times in nanoseconds emitted packets waited in the merger, from being added until being emitted */
+			uint64_t totalLatencyNsec;
+			/** The longest time in nanoseconds an emitted packet waited in the merger */
+			uint64_t maxLatencyNsec;
+
+			/**
+			 * @return The average time in nanoseconds an emitted packet waited in the merger
+			 */
+			uint64_t getAverageLatencyNsec() const { return packetsEmitted == 0 ? 0 : totalLatencyNsec / packetsEmitted; }
+		};
+
+		/**
+		 * A c'tor for this class. Allocates all the memory for the source rings
+		 * @param[in] config The merger configuration
+		 */
+		PacketMerger(const Config& config = Config());
+
+		/**
+		 * A d'tor for this class. Stops the merge thread if it's running and frees the memory
+		 */
+		~PacketMerger();
+
+		/**
+		 * @return True if the memory for the merger was allocated successfully, false otherwise (an error will be printed to log)
+		 */
+		bool isValid() const { return m_Sources != NULL; }
+
+		/**
+		 * Copy a packet to the ring of a source and advance the source watermark to its timestamp. This method never blocks
+		 * @param[in] rawPacket The packet to add
+		 * @param[in] source The source to add the packet to. Each source must be fed by a single thread at a time
+		 * @return True if the packet was added, false if the source is invalid or its ring is full
+		 */
+		bool addPacket(const RawPacket& rawPacket, uint16_t source = 0);
+
+		/**
+		 * Add multiple packets of the same source
+		 * @param[in] packets An array of packets in timestamp order
+		 * @param[in] numOfPackets The number of packets in the array
+		 * @param[in] source The source to add the packets to
+		 * @return The number of packets added
+		 */
+		uint32_t addPackets(const RawPacket* packets, uint32_t numOfPackets, uint16_t source = 0);
+
+		/**
+		 * Declare that a source won't add packets with a timestamp earlier than the given time. Should be called by the thread that feeds
+		 * the source, for example with the current time when its RX queue is empty, so an idle source doesn't make the packets of other
+		 * sources wait for the whole reorder window
+		 * @param[in] source The source
+		 * @param[in] timestamp The new watermark. It's ignored if it's earlier than the current watermark of the source
+		 */
+		void advanceWatermark(uint16_t source, const timespec& timestamp);
+
+		/**
+		 * Start a background thread that merges packets and calls the callback with every batch
+		 * @param[in] onPacketsMerged The callback to call with every batch of merged packets
+		 * @param[in] userCookie A pointer that is passed to the callback
+		 * @return True if the thread was started, false if the merger isn't valid, it's already started or the thread couldn't be created
+		 */
+		bool start(OnPacketsMergedCallback onPacketsMerged, void* userCookie = NULL);
+
+		/**
+		 * Stop the merge thread. The packets left in the rings are emitted (regardless of the reorder window) before the thread exits.
+		 * Packets shouldn't be added while the merger stops
+		 */
+		void stop();
+
+		/**
+		 * @return True if the merge thread is running, false otherwise
+		 */
+		bool isStarted() const { return m_ThreadData != NULL; }
+
+		/**
+		 * Merge the packets that are ready to be emitted and call the callback with them, in the calling thread. Can be used instead of
+		 * start() when the caller already has a thread that polls, and must not be called while the merge thread is running
+		 * @param[in] onPacketsMerged The callback to call with every batch of merged packets
+		 * @param[in] userCookie A pointer that is passed to the callback
+		 * @param[in] flush If set to true all packets in the rings are emitted regardless of the reorder window, for example when capture
+		 * stops. The default is false
+		 * @return The number of packets emitted
+		 */
+		uint32_t mergePackets(OnPacketsMergedCallback onPacketsMerged, void* userCookie = NULL, bool flush = false);
+
+		/**
+		 * Get the merger statistics. The counters of the sources are read without locking so they may be slightly stale
+		 * @param[out] stats The stats struct where stats are returned
+		 */
+		void getStatistics(Stats& stats) const;
+
+		/**
+		 * @return The stats of the merge thread polling since start() was called, or empty stats if it wasn't started
+		 */
+		PollingStats getPollingStats() const;
+
+		/**
+		 * @return The configuration of the merger. The queue size may be rounded up
+		 */
+		const Config& getConfig() const { return m_Config; }
+
+	private:
+		struct Slot;
+		struct Source;
+
+		Config m_Config;
+		uint32_t m_QueueMask;
+		Source* m_Sources;
+		uint8_t* m_BatchPackets;
+		uint64_t m_LastEmittedTimestamp;
+		uint64_t m_PacketsEmitted;
+		uint64_t m_PacketsLate;
+		uint64_t m_BatchesEmitted;
+		uint64_t m_TotalLatencyNsec;
+		uint64_t m_MaxLatencyNsec;
+		PacketMergerThreadData* m_ThreadData;
+
+		// private copy c'tor
+		PacketMerger(const PacketMerger& other);
+		PacketMerger& operator=(const PacketMerger& other);
+
+		uint32_t emitBatch(OnPacketsMergedCallback onPacketsMerged, void* userCookie, bool flush);
+		static void* mergeThreadMain(void* ptr);
+	};
+
+} // namespace pcpp
+
+#endif /* PCAPPP_PACKET_MERGER */
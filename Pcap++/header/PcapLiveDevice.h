@@ -57,6 +57,7 @@ namespace pcpp
 	typedef void* (*ThreadStart)(void*);
 
 	struct PcapThread;
+	struct PcapMutex;
 
 	/**
 	 * @class PcapLiveDevice
@@ -89,10 +90,15 @@ namespace pcpp
 		const char* m_Name;
 		const char* m_Description;
 		bool m_IsLoopback;
-		uint32_t m_DeviceMtu;
+		mutable uint32_t m_DeviceMtu;
 		std::vector<pcap_addr_t> m_Addresses;
-		MacAddress m_MacAddress;
-		IPv4Address m_DefaultGateway;
+		mutable MacAddress m_MacAddress;
+		mutable IPv4Address m_DefaultGateway;
+		// device attributes that weren't retrieved yet, each is retrieved on first access under m_AttributesMutex
+		mutable bool m_DeviceMtuPending;
+		mutable bool m_MacAddressPending;
+		mutable bool m_DefaultGatewayPending;
+		PcapMutex* m_AttributesMutex;
 		PcapThread* m_CaptureThread;
 		bool m_CaptureThreadStarted;
 		PcapThread* m_StatsThread;
@@ -109,15 +115,17 @@ namespace pcpp
 		bool m_CaptureCallbackMode;
 		LinkLayerType m_LinkType;
 
-		// c'tor is not public, there should be only one for every interface (created by PcapLiveDeviceList)
+		// c'tor is not public, there should be only one for every interface (created by PcapLiveDeviceList).
+		// The calculate* flags tell whether the attribute can be retrieved for this device, it is retrieved on first access.
+		// pInterface must outlive the device as its addresses are not copied
 		PcapLiveDevice(pcap_if_t* pInterface, bool calculateMTU, bool calculateMacAddress, bool calculateDefaultGateway);
 		// copy c'tor is not public
 		PcapLiveDevice( const PcapLiveDevice& other );
 		PcapLiveDevice& operator=(const PcapLiveDevice& other);
 
-		void setDeviceMtu();
-		void setDeviceMacAddress();
-		void setDefaultGateway();
+		void setDeviceMtu() const;
+		void setDeviceMacAddress() const;
+		void setDefaultGateway() const;
 		static void* captureThreadMain(void* ptr);
 		static void* statsThreadMain(void* ptr);
 		static void onPacketArrives(uint8_t* user, const struct pcap_pkthdr* pkthdr, const uint8_t* packet);
@@ -256,14 +264,14 @@ namespace pcpp
 		const char* getDesc() const { return m_Description; }
 
 		/**
-		 * @return True if this interface is a loopback interface, false otherwise
+		 * @return True if this interface is a loopback interface (libpcap reports it with the PCAP_IF_LOOPBACK flag), false otherwise
 		 */
 		bool getLoopback() const { return m_IsLoopback; }
 
 		/**
-		 * @return The device's maximum transmission unit (MTU) in bytes
+		 * @return The device's maximum transmission unit (MTU) in bytes. It is retrieved from the OS on the first call
 		 */
-		virtual uint32_t getMtu() const { return m_DeviceMtu; }
+		virtual uint32_t getMtu() const { setDeviceMtu(); return m_DeviceMtu; }
 
 		/**
 		 * @return The device's link layer type
@@ -276,9 +284,9 @@ namespace pcpp
 		const std::vector<pcap_addr_t>& getAddresses() const { return m_Addresses; }
 
 		/**
-		 * @return The MAC address for this interface
+		 * @return The MAC address for this interface. It is retrieved from the OS on the first call
 		 */
-		virtual MacAddress getMacAddress() const { return m_MacAddress; }
+		virtual MacAddress getMacAddress() const { setDeviceMacAddress(); return m_MacAddress; }
 
 		/**
 		 * @return The IPv4 address for this interface. If multiple IPv4 addresses are defined for this interface, the first will be picked.
@@ -288,7 +296,8 @@ namespace pcpp
 
 		/**
 		 * @return The default gateway defined for this interface. If no default gateway is defined, if it's not IPv4 or if couldn't extract
-		 * default gateway IPv4Address#Zero will be returned. If multiple gateways were defined the first one will be returned
+		 * default gateway IPv4Address#Zero will be returned. If multiple gateways were defined the first one will be returned.
+		 * The default gateway is retrieved from the OS on the first call
 		 */
 		IPv4Address getDefaultGateway() const;
 
@@ -19,15 +19,21 @@ namespace pcpp
 	/**
 	 * @class PcapLiveDeviceList
 	 * A singleton class that creates, stores and provides access to all PcapLiveDevice (on Linux) or WinPcapLiveDevice (on Windows) instances. All live
-	 * devices are initialized on startup and wrap the network interfaces installed on the machine. This class enables access to them through
-	 * their IP addresses or get a vector of all of them so the user can search them in some other way
+	 * devices wrap the network interfaces installed on the machine. This class enables access to them through their IP addresses or get a vector of all
+	 * of them so the user can search them in some other way.
+	 * Creating the singleton is cheap: the network interfaces are enumerated on the first access to the device list, device attributes such as MTU
+	 * or MAC address are retrieved on the first access to them and the DNS servers are retrieved on the first call to getDnsServers().
+	 * Please notice the first access isn't thread-safe, so if multiple threads use this class make sure it's accessed once before they're started
 	 */
 	class PcapLiveDeviceList
 	{
 	private:
-		std::vector<PcapLiveDevice*> m_LiveDeviceList;
+		mutable std::vector<PcapLiveDevice*> m_LiveDeviceList;
+		mutable pcap_if_t* m_InterfaceList;
+		mutable bool m_LiveDeviceListInitialized;
 
-		std::vector<IPv4Address> m_DnsServers;
+		mutable std::vector<IPv4Address> m_DnsServers;
+		mutable bool m_DnsServersInitialized;
 
 		// private c'tor
 		PcapLiveDeviceList();
@@ -37,9 +43,11 @@ namespace pcpp
 		// private d'tor
 		~PcapLiveDeviceList();
 
-		void init();
+		void init() const;
 
-		void setDnsServers();
+		void setDnsServers() const;
+
+		void clear();
 	public:
 		/**
 		 * The access method to the singleton
@@ -54,7 +62,7 @@ namespace pcpp
 		/**
 		 * @return A vector containing pointers to all live devices currently installed on the machine
 		 */
-		const std::vector<PcapLiveDevice*>& getPcapLiveDevicesList() const { return m_LiveDeviceList; }
+		const std::vector<PcapLiveDevice*>& getPcapLiveDevicesList() const { init(); return m_LiveDeviceList; }
 
 		/**
 		 * Get a pointer to the live device by its IP address. IP address can be both IPv4 or IPv6
@@ -93,12 +101,14 @@ namespace pcpp
 
 		/**
 		 * @return A list of all DNS servers defined for this machine. If this list is empty it means no DNS servers were defined or they
-		 * couldn't be extracted from some reason
+		 * couldn't be extracted from some reason. On Linux the list is read from resolv.conf (when systemd-resolved is used, from the
+		 * resolv.conf it maintains with the upstream servers)
 		 */
-		const std::vector<IPv4Address>& getDnsServers() const { return m_DnsServers; }
+		const std::vector<IPv4Address>& getDnsServers() const { setDnsServers(); return m_DnsServers; }
 
 		/**
-		 * Reset the live device list and DNS server list, meaning clear and refetch them
+		 * Reset the live device list and DNS server list, meaning clear them so they're refetched on next access. Pointers to previously fetched
+		 * devices become invalid
 		 */
 		void reset();
 	};
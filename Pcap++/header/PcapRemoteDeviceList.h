@@ -32,9 +32,11 @@ namespace pcpp
 		IPAddress m_RemoteMachineIpAddress;
 		uint16_t m_RemoteMachinePort;
 		PcapRemoteAuthentication* m_RemoteAuthentication;
+		// the device addresses point into this list, so it's freed only when the devices are deleted
+		pcap_if_t* m_InterfaceList;
 
 		// private c'tor. User should create the list via static methods PcapRemoteDeviceList::getRemoteDeviceList()
-		PcapRemoteDeviceList() : m_RemoteMachinePort(0), m_RemoteAuthentication(NULL) {}
+		PcapRemoteDeviceList() : m_RemoteMachinePort(0), m_RemoteAuthentication(NULL), m_InterfaceList(NULL) {}
 		// private copy c'tor
 		PcapRemoteDeviceList(const PcapRemoteDeviceList& other);
 		PcapRemoteDeviceList& operator=(const PcapRemoteDeviceList& other);
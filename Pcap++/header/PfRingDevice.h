@@ -5,6 +5,7 @@
 #include "MacAddress.h"
 #include "SystemUtils.h"
 #include "Packet.h"
+#include "PollingPolicy.h"
 #include <pthread.h>
 
 /// @file
@@ -40,6 +41,7 @@ namespace pcpp
 			pfring* Channel;
 			bool IsInUse;
 			bool IsAffinitySet;
+			PollingController Poller;
 
 			CoreConfiguration();
 			void clear();
@@ -58,10 +60,11 @@ namespace pcpp
 		bool m_ReentrantMode;
 		bool m_HwClockEnabled;
 		bool m_IsFilterCurrentlySet;
+		PollingPolicy m_PollingPolicy;
 
 		PfRingDevice(const char* deviceName);
 
-		bool initCoreConfigurationByCoreMask(CoreMask coreMask);
+		bool initCoreConfigurationByCoreMask(const CoreMask& coreMask);
 		static void* captureThreadMain(void *ptr);
 
 		int openSingleRxChannel(const char* deviceName, pfring** ring);
@@ -158,7 +161,7 @@ namespace pcpp
 		 * @param[in] coreMask The cores to be used as mask. For example:
 		 * @return True if this action succeeds, false otherwise
 		 */
-		bool startCaptureMultiThread(OnPfRingPacketsArriveCallback onPacketsArrive, void* onPacketsArriveUserCookie, CoreMask coreMask);
+		bool startCaptureMultiThread(OnPfRingPacketsArriveCallback onPacketsArrive, void* onPacketsArriveUserCookie, const CoreMask& coreMask);
 
 		/**
 		 * Stops capturing packets (works will all type of startCapture*)
@@ -239,6 +242,34 @@ namespace pcpp
 		 */
 		void getStatistics(PfRingStats& stats) const;
 
+		/**
+		 * Set the polling policy of the capture threads (see PollingPolicy.h). By default capture threads busy-poll their RX channels.
+		 * In pcpp#PollingModeInterrupt the capture threads block in pfring_poll() after PollingPolicy#spinCount empty polls.
+		 * The policy can't be changed while capture is running
+		 * @param[in] policy The polling policy to use
+		 * @return True if the policy was set, false if capture is currently running
+		 */
+		bool setPollingPolicy(const PollingPolicy& policy);
+
+		/**
+		 * @return The polling policy of the capture threads
+		 */
+		const PollingPolicy& getPollingPolicy() const { return m_PollingPolicy; }
+
+		/**
+		 * Get the polling stats (how the capture thread spent its time) of a specific thread/core. Stats are zeroed when capture starts
+		 * and are kept after capture stops
+		 * @param[in] core The requested core
+		 * @param[out] stats A reference for the stats object where the stats are written. Current values will be overriden
+		 */
+		void getPollingStats(SystemCore core, PollingStats& stats) const;
+
+		/**
+		 * Get the polling stats of all capture threads summed together
+		 * @param[out] stats A reference for the stats object where the stats are written. Current values will be overriden
+		 */
+		void getPollingStats(PollingStats& stats) const;
+
 		/**
 		 * Return true if filter is currently set
 		 * @return True if filter is currently set, false otherwise
@@ -0,0 +1,194 @@
+#ifndef PCAPPP_POLLING_POLICY
+#define PCAPPP_POLLING_POLICY
+
+#include <stdint.h>
+
+/**
+ * @file
+ * This file includes the polling policies used by the capture loops of poll-mode devices (pcpp#DpdkDevice, pcpp#PfRingDevice and pcpp#XdpDevice).<BR>
+ * By default these devices busy-poll their RX queues, which gives the lowest latency but keeps each capture core at 100% even when there
+ * is no traffic at all. A pcpp#PollingPolicy lets the user trade some latency for CPU time:
+ * - pcpp#PollingModeBusySpin - poll continuously (the default behavior)
+ * - pcpp#PollingModeBackoff - spin for a number of empty polls and then sleep between polls, doubling the sleep time on each empty poll up
+ *   to a maximum. The first poll that returns packets resets the sleep time, so a burst is picked up with no more than one sleep delay
+ * - pcpp#PollingModeInterrupt - spin for a number of empty polls and then block until the device signals that packets arrived (or a
+ *   timeout expires). This is supported only by devices and drivers that support RX interrupts; otherwise pcpp#PollingModeBackoff is used
+ *
+ * Regardless of the policy, each capture thread accounts how its time is spent (see pcpp#PollingStats) so it's possible to see how loaded
+ * a capture core really is and whether a few lightly loaded sensors can share cores
+ */
+
+/**
+* \namespace pcpp
+* \brief The main namespace for the PcapPlusPlus lib
+*/
+namespace pcpp
+{
+
+	/**
+	 * @enum PollingMode
+	 * The way a capture thread behaves when its RX queue is empty
+	 */
+	enum PollingMode
+	{
+		/** Poll continuously */
+		PollingModeBusySpin,
+		/** Spin for a number of empty polls, then sleep between polls with exponential backoff */
+		PollingModeBackoff,
+		/** Spin for a number of empty polls, then wait for an RX interrupt */
+		PollingModeInterrupt
+	};
+
+	/**
+	 * @struct PollingPolicy
+	 * The polling policy of a capture thread
+	 */
+	struct PollingPolicy
+	{
+		/** The polling mode */
+		PollingMode mode;
+
+		/**
+		 * The number of consecutive empty polls before the thread starts sleeping (PollingModeBackoff) or waits for an interrupt
+		 * (PollingModeInterrupt). Not relevant for PollingModeBusySpin
+		 */
+		uint32_t spinCount;
+
+		/** The first sleep time in microseconds in PollingModeBackoff */
+		uint32_t minSleepUsec;
+
+		/** The maximum sleep time in microseconds in PollingModeBackoff */
+		uint32_t maxSleepUsec;
+
+		/** The maximum time in milliseconds to wait for an interrupt in PollingModeInterrupt */
+		uint32_t interruptTimeoutMsec;
+
+		/**
+		 * A c'tor for this struct
+		 * @param[in] mode The polling mode. Default is PollingModeBusySpin
+		 * @param[in] spinCount The number of consecutive empty polls before sleeping or waiting for an interrupt. Default is 1000
+		 * @param[in] minSleepUsec The first sleep time in microseconds. Default is 1
+		 * @param[in] maxSleepUsec The maximum sleep time in microseconds. Default is 1000
+		 * @param[in] interruptTimeoutMsec The maximum time in milliseconds to wait for an interrupt. Default is 10
+		 */
+		PollingPolicy(PollingMode mode = PollingModeBusySpin, uint32_t spinCount = 1000, uint32_t minSleepUsec = 1, uint32_t maxSleepUsec = 1000, uint32_t interruptTimeoutMsec = 10) :
+			mode(mode), spinCount(spinCount), minSleepUsec(minSleepUsec), maxSleepUsec(maxSleepUsec), interruptTimeoutMsec(interruptTimeoutMsec) {}
+	};
+
+	/**
+	 * @struct PollingStats
+	 * Describes how a capture thread spent its time
+	 */
+	struct PollingStats
+	{
+		/** Total number of polls */
+		uint64_t numOfPolls;
+		/** Number of polls that returned no packets */
+		uint64_t numOfEmptyPolls;
+		/** Number of times the thread slept (PollingModeBackoff) */
+		uint64_t numOfSleeps;
+		/** Number of times the thread waited for an interrupt (PollingModeInterrupt) */
+		uint64_t numOfInterruptWaits;
+		/** Time in nanoseconds spent in polls that returned packets and in processing these packets */
+		uint64_t busyTimeNsec;
+		/** Time in nanoseconds spent in polls that returned no packets */
+		uint64_t idleTimeNsec;
+		/** Time in nanoseconds spent sleeping or waiting for interrupts */
+		uint64_t sleepTimeNsec;
+
+		/**
+		 * A c'tor for this struct that zeroes all counters
+		 */
+		PollingStats() { clear(); }
+
+		/**
+		 * Zero all counters
+		 */
+		void clear();
+
+		/**
+		 * Add the counters of another PollingStats instance to this one, for example: for summing the stats of all capture threads of a device
+		 * @param[in] other The stats to add
+		 */
+		void add(const PollingStats& other);
+
+		/**
+		 * @return The portion (between 0 and 1) of the measured time spent on polls that returned packets and on processing them
+		 */
+		double getBusyRatio() const;
+	};
+
+	/**
+	 * @class PollingController
+	 * Implements a PollingPolicy inside a capture loop and accounts the time spent in it. Each capture thread should have its own instance.
+	 * The capture loop calls onPoll() right after each poll of the RX queue. onPoll() sleeps when the policy says so, or returns
+	 * PollingController#WaitForInterrupt in which case the capture loop waits for the device RX interrupt and then calls onInterruptWaitDone()
+	 */
+	class PollingController
+	{
+	public:
+
+		/**
+		 * @enum PollAction
+		 * What the capture loop should do after a poll
+		 */
+		enum PollAction
+		{
+			/** Poll the RX queue again */
+			PollAgain,
+			/** Wait for an RX interrupt (up to PollingPolicy#interruptTimeoutMsec) and then call onInterruptWaitDone() */
+			WaitForInterrupt
+		};
+
+		/**
+		 * A c'tor for this class
+		 * @param[in] policy The polling policy to implement. Default is busy spin
+		 */
+		PollingController(const PollingPolicy& policy = PollingPolicy());
+
+		/**
+		 * Set a new policy, zero the stats and restart time measurement. Should be called when the capture loop starts
+		 * @param[in] policy The polling policy to implement
+		 */
+		void reset(const PollingPolicy& policy);
+
+		/**
+		 * Used when the policy is PollingModeInterrupt but the device doesn't support RX interrupts. Switches to PollingModeBackoff
+		 */
+		void fallBackToBackoff();
+
+		/**
+		 * Should be called by the capture loop right after each poll of the RX queue. Accounts the time since the previous poll and sleeps
+		 * if the policy requires
+		 * @param[in] numOfPackets The number of packets returned by the poll
+		 * @return The action the capture loop should take
+		 */
+		PollAction onPoll(uint32_t numOfPackets);
+
+		/**
+		 * Should be called by the capture loop after waiting for an RX interrupt
+		 */
+		void onInterruptWaitDone();
+
+		/**
+		 * @return The policy currently implemented
+		 */
+		const PollingPolicy& getPolicy() const { return m_Policy; }
+
+		/**
+		 * @return The stats gathered since the last call to reset()
+		 */
+		const PollingStats& getStats() const { return m_Stats; }
+
+	private:
+		PollingPolicy m_Policy;
+		PollingStats m_Stats;
+		uint64_t m_LastTimestamp;
+		bool m_LastPollHadPackets;
+		uint32_t m_ConsecutiveEmptyPolls;
+		uint32_t m_CurSleepUsec;
+	};
+
+} // namespace pcpp
+
+#endif // PCAPPP_POLLING_POLICY
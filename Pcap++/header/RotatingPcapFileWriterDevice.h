@@ -0,0 +1,181 @@
+#ifndef PCAPPP_ROTATING_FILE_WRITER_DEVICE
+#define PCAPPP_ROTATING_FILE_WRITER_DEVICE
+
+#include "AsyncPcapFileDevice.h"
+#include <string>
+#include <vector>
+#include <deque>
+
+/**
+ * @file
+ * This file provides a writer for long-running captures that splits the capture into a ring of files, like dumpcap's ring buffer mode
+ * (-b filesize/duration/packets/files)
+ */
+
+/**
+* \namespace pcpp
+* \brief The main namespace for the PcapPlusPlus lib
+*/
+namespace pcpp
+{
+
+	struct RotatingFileWriterData;
+
+	/**
+	 * @struct RotatingFileWriterConfiguration
+	 * The configuration of RotatingPcapFileWriterDevice. A file is rotated when any of the non-zero limits is reached
+	 */
+	struct RotatingFileWriterConfiguration
+	{
+		/** Rotate to a new file when writing the next packet would make the file larger than this many bytes. 0 means no limit. The default is 0 */
+		uint64_t maxFileSize;
+
+		/**
+		 * Rotate to a new file when a packet's timestamp is this many seconds or more after the timestamp of the first packet in the file.
+		 * 0 means no limit. The default is 0
+		 */
+		uint32_t maxFileDuration;
+
+		/** Rotate to a new file after this many packets. 0 means no limit. The default is 0 */
+		uint64_t maxPacketsPerFile;
+
+		/** The maximum number of files to keep. When a new file exceeds it the oldest file is deleted. 0 means keep all files. The default is 0 */
+		uint32_t maxFiles;
+
+		/**
+		 * The number of bytes to preallocate for every file (see AsyncPcapFileWriterDevice#preallocate()). 0 means use maxFileSize. The default
+		 * is 0, so if maxFileSize isn't set either files aren't preallocated
+		 */
+		uint64_t preallocateSize;
+
+		/** The I/O configuration of the underlying AsyncPcapFileWriterDevice */
+		AsyncFileConfiguration ioConfig;
+
+		/**
+		 * A c'tor that sets the default values
+		 */
+		RotatingFileWriterConfiguration() : maxFileSize(0), maxFileDuration(0), maxPacketsPerFile(0), maxFiles(0), preallocateSize(0) {}
+	};
+
+
+	/**
+	 * @class RotatingPcapFileWriterDevice
+	 * A pcap or pcap-ng file writer that rotates the file it writes to by size, by time or by number of packets, and optionally keeps only
+	 * the last N files.<BR>
+	 * Files are named like dumpcap names them: the file name given in the c'tor is split into a prefix and an extension, and each file is
+	 * named <prefix>_<5-digit file number>_<YYYYmmddHHMMSS><extension>, where the time is the local time of the first packet in the file.
+	 * For example "/tmp/capture.pcapng" creates /tmp/capture_00001_20200101120000.pcapng, /tmp/capture_00002_20200101120500.pcapng, etc.<BR>
+	 * Rotation doesn't stall the writing thread: the next file is created, gets its header and is preallocated in a background thread ahead
+	 * of time, so rotating only switches to it. Closing the previous file (which flushes it) and deleting the oldest file are done in the
+	 * background thread too. Until a file gets its first packet it has a temporary name: <prefix>_<5-digit file number>.tmp<BR>
+	 * Files are written with AsyncPcapFileWriterDevice, so this class isn't supported on Windows. The class isn't thread-safe: packets
+	 * should be written from one thread
+	 */
+	class RotatingPcapFileWriterDevice : public IFileWriterDevice
+	{
+	public:
+
+		/**
+		 * A c'tor for this class. Notice that after calling this c'tor no file is created yet, for creating the first file call open()
+		 * @param[in] fileName The file name template (see the class description)
+		 * @param[in] config The rotation configuration
+		 * @param[in] linkLayerType The link layer type of all packets. The default is Ethernet
+		 * @param[in] fileFormat The file format of all files. The default is pcap
+		 */
+		RotatingPcapFileWriterDevice(const char* fileName, const RotatingFileWriterConfiguration& config, LinkLayerType linkLayerType = LINKTYPE_ETHERNET,
+				CaptureFileFormat fileFormat = CaptureFilePcap);
+
+		/**
+		 * A d'tor for this class. Closes the device if it's opened
+		 */
+		virtual ~RotatingPcapFileWriterDevice();
+
+		/**
+		 * @return The name of the file currently written to. If the file didn't get packets yet it's the temporary name
+		 */
+		std::string getCurrentFileName() const;
+
+		/**
+		 * @return The names of the files that got packets and weren't deleted, from the oldest to the current one
+		 */
+		std::vector<std::string> getFileNames() const;
+
+		/**
+		 * @return The number of the file currently written to, starting from 1
+		 */
+		uint32_t getCurrentFileNumber() const { return m_CurFileNumber; }
+
+		/**
+		 * Switch to a new file regardless of the limits. Does nothing if the current file has no packets
+		 * @return True if rotated successfully or if there was nothing to rotate, false otherwise
+		 */
+		bool rotate();
+
+		/**
+		 * Write a packet to the current file, rotating first if the packet doesn't fit the limits of the current file
+		 * @param[in] packet The packet to write
+		 * @return True if the packet was written successfully. False if the device isn't opened, if the packet link layer type is different
+		 * than the one given in the c'tor or if rotating or writing failed (in all cases an error will be printed to log)
+		 */
+		bool writePacket(RawPacket const& packet);
+
+		/**
+		 * Write multiple packets. Rotation may happen between packets
+		 * @param[in] packets The packets to write
+		 * @return True if all packets were written successfully, false otherwise
+		 */
+		bool writePackets(const RawPacketVector& packets);
+
+		/**
+		 * Start the background thread and create the first file
+		 * @return True if the first file was created successfully or if the device is already opened, false otherwise
+		 */
+		bool open();
+
+		/**
+		 * Append mode isn't supported by this device. Calling it with appendMode=false is the same as calling open()
+		 * @param[in] appendMode Must be false
+		 * @return The return value of open(), or false if appendMode is true
+		 */
+		bool open(bool appendMode);
+
+		/**
+		 * Close the current file, wait until the background thread finishes its work and stop it. A temporary file that didn't get any
+		 * packets is deleted
+		 */
+		void close();
+
+		/**
+		 * Get statistics of packets written so far to all files
+		 * @param[out] stats The stats struct where stats are returned
+		 */
+		void getStatistics(PcapStats& stats) const;
+
+	private:
+		RotatingFileWriterConfiguration m_Config;
+		LinkLayerType m_LinkLayerType;
+		CaptureFileFormat m_FileFormat;
+		std::string m_FilePrefix;
+		std::string m_FileExtension;
+		RotatingFileWriterData* m_Data;
+		AsyncPcapFileWriterDevice* m_CurWriter;
+		std::string m_CurFileName;
+		uint32_t m_CurFileNumber;
+		uint64_t m_CurFilePackets;
+		time_t m_CurFileStartTime;
+		std::deque<std::string> m_FileNames;
+
+		// private copy c'tor
+		RotatingPcapFileWriterDevice(const RotatingPcapFileWriterDevice& other);
+		RotatingPcapFileWriterDevice& operator=(const RotatingPcapFileWriterDevice& other);
+
+		std::string getTempFileName(uint32_t fileNumber) const;
+		std::string getFinalFileName(uint32_t fileNumber, time_t timestamp) const;
+		bool shouldRotate(const RawPacket& packet) const;
+		bool switchToNextFile();
+		void nameCurrentFile(time_t timestamp);
+	};
+
+} // namespace pcpp
+
+#endif /* PCAPPP_ROTATING_FILE_WRITER_DEVICE */
@@ -0,0 +1,351 @@
+#ifndef PCAPPP_SHARED_MEMORY_RING
+#define PCAPPP_SHARED_MEMORY_RING
+
+#include "PcapDevice.h"
+#include "PcapFilter.h"
+#include <string>
+
+/**
+ * @file
+ * This file provides a packet ring in shared memory that one process writes captured packets to and several other processes read from,
+ * without copying the packets through pipes or sockets and without each process opening its own capture.<BR>
+ * The ring has 2 sides:
+ * - pcpp#SharedMemoryRingWriterDevice - creates the ring and writes the packets it's fed with. It doesn't capture packets by itself, the
+ *   user feeds it from any device, for example by passing SharedMemoryRingWriterDevice#onPacketArrives as the capture callback of
+ *   pcpp#PcapLiveDevice
+ * - pcpp#SharedMemoryRingReaderDevice - a consumer that attaches to the ring by its name. Each reader has its own cursor, so every reader
+ *   sees every packet written after it attached, at its own pace
+ *
+ * How it works:
+ * - The ring is an array of fixed size slots, each holding one packet (truncated to the max packet length) with its timestamp, captured
+ *   length and original length. The writer publishes a slot by advancing the ring head, and each reader advances its own cursor
+ * - The memory can be a POSIX shared memory object (the default), a Linux memfd or a file. Huge pages are used with a memfd created with
+ *   huge pages or with a file on a hugetlbfs mount (for example /dev/hugepages/ring)
+ * - When the slowest reader is a whole ring behind, the policy decides what happens (see SharedMemoryRingWriterDevice#SlowConsumerPolicy):
+ *   either the writer drops the new packet and all readers see every packet that was written (readers of this policy receive packets
+ *   without copying them), or the writer overwrites the oldest packets and only the slow reader loses packets. A reader process that
+ *   exited without closing its device doesn't hold the writer back: its cursor is released when the ring is full
+ * - When the writer closes the ring, readers receive the packets left in it and then see the end of the stream
+ *
+ * Shared memory rings aren't supported on Windows
+ */
+
+/**
+* \namespace pcpp
+* \brief The main namespace for the PcapPlusPlus lib
+*/
+namespace pcpp
+{
+
+	class PcapLiveDevice;
+	class SharedMemoryRingReaderDevice;
+
+	/**
+	 * @typedef OnSharedMemoryPacketsCallback
+	 * A callback that is called with the packets a SharedMemoryRingReaderDevice received
+	 * @param[in] packets An array of packets. The packets are valid only until the callback returns, so they need to be copied if they're
+	 * used later
+	 * @param[in] numOfPackets The number of packets in the array
+	 * @param[in] device The reader device
+	 * @param[in] userCookie A pointer to the object given to SharedMemoryRingReaderDevice#receivePackets()
+	 */
+	typedef void (*OnSharedMemoryPacketsCallback)(RawPacket* packets, uint32_t numOfPackets, SharedMemoryRingReaderDevice* device, void* userCookie);
+
+	/**
+	 * @class SharedMemoryRingWriterDevice
+	 * The writer side of a shared memory packet ring. Please refer to the documentation at the top of SharedMemoryRing.h to understand how
+	 * it works. Packets should be written by a single thread at a time
+	 */
+	class SharedMemoryRingWriterDevice : public IPcapDevice
+	{
+	public:
+
+		/**
+		 * An enum for the kinds of memory the ring can be in
+		 */
+		enum MemoryType
+		{
+			/** A POSIX shared memory object. The name should look like "/pcpp_ring" */
+			PosixSharedMemory,
+			/**
+			 * A Linux memfd. The name is only a label: other processes attach with the path returned by getAttachName(), or inherit the
+			 * memory by fork()
+			 */
+			MemfdSharedMemory,
+			/** A file created with the name as its path, for example on a hugetlbfs or tmpfs mount */
+			FileSharedMemory
+		};
+
+		/**
+		 * An enum for what the writer does when the slowest reader is a whole ring behind
+		 */
+		enum SlowConsumerPolicy
+		{
+			/**
+			 * The new packet is dropped, so readers never lose packets that were written but a slow reader slows the whole ring. Readers
+			 * receive packets without copying them
+			 */
+			DropNewestPackets,
+			/**
+			 * The oldest packets are overwritten, so the writer and fast readers are never held back and a slow reader loses the packets
+			 * it didn't read in time. Readers copy packets before giving them to the user, since they may be overwritten
+			 */
+			OverwriteOldestPackets
+		};
+
+		/**
+		 * @struct Config
+		 * The ring configuration
+		 */
+		struct Config
+		{
+			/** The number of packets the ring can hold. Rounded up to a power of 2. The default is 4096 */
+			uint32_t numOfSlots;
+			/** Packets longer than this are truncated (their original length is kept). The default is 2048 */
+			uint32_t maxPacketLen;
+			/** The maximum number of readers attached at the same time. The default is 8 */
+			uint32_t maxConsumers;
+			/** The kind of memory the ring is in. The default is PosixSharedMemory */
+			MemoryType memoryType;
+			/**
+			 * Use huge pages. Supported with MemfdSharedMemory, and with FileSharedMemory if the file is on a hugetlbfs mount. The ring size
+			 * is rounded up to 2MB. The default is false
+			 */
+			bool useHugePages;
+			/** What the writer does when the slowest reader is a whole ring behind. The default is DropNewestPackets */
+			SlowConsumerPolicy slowConsumerPolicy;
+
+			/**
+			 * A c'tor that sets the default values
+			 */
+			Config() : numOfSlots(4096), maxPacketLen(2048), maxConsumers(8), memoryType(PosixSharedMemory), useHugePages(false),
+				slowConsumerPolicy(DropNewestPackets) {}
+		};
+
+		/**
+		 * A c'tor for this class. It doesn't create the ring, please call open()
+		 * @param[in] name The name of the ring. Its meaning depends on Config#memoryType
+		 * @param[in] config The ring configuration
+		 */
+		SharedMemoryRingWriterDevice(const std::string& name, const Config& config = Config());
+
+		/**
+		 * A d'tor for this class. Closes the device if it's open
+		 */
+		~SharedMemoryRingWriterDevice();
+
+		/**
+		 * Copy a packet to the ring. This method never blocks
+		 * @param[in] rawPacket The packet to write
+		 * @return True if the packet was written or filtered out by the device filter, false if the device isn't open or the packet was
+		 * dropped because the slowest reader is a whole ring behind (with the DropNewestPackets policy)
+		 */
+		bool writePacket(const RawPacket& rawPacket);
+
+		/**
+		 * Write several packets. See writePacket()
+		 * @param[in] packets The packets to write
+		 * @return True if all packets were written or filtered out, false otherwise
+		 */
+		bool writePackets(const RawPacketVector& packets);
+
+		/**
+		 * A capture callback that can be passed to PcapLiveDevice#startCapture() with a pointer to the writer as the user cookie
+		 * @param[in] packet The captured packet
+		 * @param[in] device The live device
+		 * @param[in] userCookie A pointer to a SharedMemoryRingWriterDevice instance
+		 */
+		static void onPacketArrives(RawPacket* packet, PcapLiveDevice* device, void* userCookie);
+
+		/**
+		 * @return The name readers should attach with. It's the ring name, except for MemfdSharedMemory where it's the path of the memfd
+		 * under /proc. Empty if the device isn't open
+		 */
+		std::string getAttachName() const;
+
+		/**
+		 * @return The number of readers currently attached to the ring
+		 */
+		int getNumOfConsumers() const;
+
+		/**
+		 * @return The number of packets the slowest attached reader didn't read yet, or 0 if no reader is attached
+		 */
+		uint64_t getSlowestConsumerLag() const;
+
+		/**
+		 * @return The configuration of the ring. The number of slots may be rounded up
+		 */
+		const Config& getConfig() const { return m_Config; }
+
+		// implement abstract methods
+
+		/**
+		 * Create the ring memory. Creating fails if a POSIX shared memory object or a file with the ring name already exists
+		 * @return True if the ring was created successfully, false otherwise
+		 */
+		bool open();
+
+		/**
+		 * Mark the stream as ended, so readers stop after reading the packets left in the ring, and remove the ring name. Readers that are
+		 * attached keep their memory until they close
+		 */
+		void close();
+
+		/**
+		 * Get statistics: packetsRecv is the number of packets written to the ring and packetsDrop is the number of packets dropped because
+		 * the slowest reader was a whole ring behind
+		 * @param[out] stats An object containing the stats
+		 */
+		void getStatistics(IPcapDevice::PcapStats& stats) const;
+
+		using IPcapDevice::setFilter;
+
+		/**
+		 * Set a BPF filter. Only packets that match it are written to the ring
+		 * @param[in] filterAsString The filter in Berkeley Packet Filter (BPF) syntax (http://biot.com/capstats/bpf.html)
+		 * @return True if the filter is valid, false otherwise
+		 */
+		bool setFilter(std::string filterAsString);
+
+		/**
+		 * Clear the filter
+		 * @return Always true
+		 */
+		bool clearFilter();
+
+	private:
+		std::string m_Name;
+		Config m_Config;
+		uint8_t* m_Memory;
+		size_t m_MemorySize;
+		int m_MemfdDescriptor;
+		uint64_t m_SlowestCursor;
+		uint32_t m_ConsumersGeneration;
+		uint64_t m_PacketsFiltered;
+		BpfFilterWrapper m_Filter;
+		bool m_HasFilter;
+
+		// private copy c'tor
+		SharedMemoryRingWriterDevice(const SharedMemoryRingWriterDevice& other);
+		SharedMemoryRingWriterDevice& operator=(const SharedMemoryRingWriterDevice& other);
+
+		bool hasRoomForPacket(uint64_t head);
+	};
+
+
+	/**
+	 * @class SharedMemoryRingReaderDevice
+	 * A reader (consumer) of a shared memory packet ring. Please refer to the documentation at the top of SharedMemoryRing.h to understand
+	 * how it works. A reader sees the packets written after it was opened. Each reader should be used by a single thread at a time
+	 */
+	class SharedMemoryRingReaderDevice : public IPcapDevice
+	{
+	public:
+
+		/**
+		 * A c'tor for this class. It doesn't attach to the ring, please call open()
+		 * @param[in] name The name to attach with, as returned by SharedMemoryRingWriterDevice#getAttachName(). Names with more than one '/'
+		 * are opened as file paths, other names as POSIX shared memory objects
+		 */
+		SharedMemoryRingReaderDevice(const std::string& name);
+
+		/**
+		 * A d'tor for this class. Closes the device if it's open
+		 */
+		~SharedMemoryRingReaderDevice();
+
+		/**
+		 * Receive the next packet. The packet data is copied
+		 * @param[out] rawPacket The packet to fill
+		 * @return True if a packet was received, false if no packet is waiting in the ring or the device isn't open
+		 */
+		bool getNextPacket(RawPacket& rawPacket);
+
+		/**
+		 * Receive several packets. The packet data is copied
+		 * @param[out] packets The vector the packets are appended to
+		 * @param[in] numOfPacketsToRead The maximum number of packets to receive, or -1 to receive all waiting packets. The default is -1
+		 * @return The number of packets received
+		 */
+		int getNextPackets(RawPacketVector& packets, int numOfPacketsToRead = -1);
+
+		/**
+		 * Receive the packets waiting in the ring and give them to a callback in batches of up to 64 packets. With the DropNewestPackets
+		 * policy the packets point to the ring memory, which is released only after the callback returns
+		 * @param[in] onPacketsReceived The callback to call with the packets
+		 * @param[in] userCookie A pointer that is passed to the callback
+		 * @param[in] maxNumOfPackets The maximum number of packets to receive. The default is 64
+		 * @return The number of packets received, 0 if no packet is waiting in the ring or the device isn't open
+		 */
+		uint32_t receivePackets(OnSharedMemoryPacketsCallback onPacketsReceived, void* userCookie = NULL, uint32_t maxNumOfPackets = 64);
+
+		/**
+		 * @return True if the writer closed the ring and all packets left in it were received
+		 */
+		bool isStreamEnded();
+
+		/**
+		 * @return The slow consumer policy of the ring, valid only when the device is open
+		 */
+		SharedMemoryRingWriterDevice::SlowConsumerPolicy getSlowConsumerPolicy() const;
+
+		// implement abstract methods
+
+		/**
+		 * Attach to the ring and start reading from the packets written from now on
+		 * @return True if attached successfully, false if the ring doesn't exist or all its reader places are taken
+		 */
+		bool open();
+
+		/**
+		 * Detach from the ring
+		 */
+		void close();
+
+		/**
+		 * Get statistics: packetsRecv is the number of packets received by this reader and packetsDrop is the number of packets this
+		 * reader lost: packets the writer dropped since the reader was opened and packets overwritten before the reader read them
+		 * @param[out] stats An object containing the stats
+		 */
+		void getStatistics(IPcapDevice::PcapStats& stats) const;
+
+		using IPcapDevice::setFilter;
+
+		/**
+		 * Set a BPF filter. Only packets that match it are received, the others are skipped
+		 * @param[in] filterAsString The filter in Berkeley Packet Filter (BPF) syntax (http://biot.com/capstats/bpf.html)
+		 * @return True if the filter is valid, false otherwise
+		 */
+		bool setFilter(std::string filterAsString);
+
+		/**
+		 * Clear the filter
+		 * @return Always true
+		 */
+		bool clearFilter();
+
+	private:
+		std::string m_Name;
+		uint8_t* m_Memory;
+		size_t m_MemorySize;
+		int m_ConsumerId;
+		uint64_t m_Cursor;
+		uint64_t m_PacketsReceived;
+		uint64_t m_PacketsLost;
+		uint64_t m_WriterDropsOnOpen;
+		uint8_t* m_BatchPackets;
+		uint8_t* m_CopyBuffer;
+		BpfFilterWrapper m_Filter;
+		bool m_HasFilter;
+
+		// private copy c'tor
+		SharedMemoryRingReaderDevice(const SharedMemoryRingReaderDevice& other);
+		SharedMemoryRingReaderDevice& operator=(const SharedMemoryRingReaderDevice& other);
+
+		const uint8_t* readSlot(uint64_t position, uint8_t* copyTo, RawPacket& rawPacket);
+	};
+
+} // namespace pcpp
+
+#endif // PCAPPP_SHARED_MEMORY_RING
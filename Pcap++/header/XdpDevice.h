@@ -0,0 +1,341 @@
+#ifndef PCAPPP_XDP_DEVICE
+#define PCAPPP_XDP_DEVICE
+
+#include <string>
+#include <vector>
+#include <pthread.h>
+#include "Device.h"
+#include "SystemUtils.h"
+#include "PollingPolicy.h"
+
+/**
+ * @file
+ * This file provides XdpDevice, a PcapPlusPlus wrapper for Linux AF_XDP sockets. AF_XDP delivers packets from the NIC driver
+ * directly into a user-space memory area (called UMEM) which is shared between the kernel and the application, bypassing most
+ * of the kernel network stack but without taking the NIC away from the kernel like DPDK does.<BR>
+ * How does it work? for every opened RX/TX queue XdpDevice creates an AF_XDP socket with its own UMEM. The UMEM is divided into
+ * fixed-size frames: half of them are handed to the kernel through the fill ring for receiving packets, and the other half are used
+ * for transmitting packets and are returned by the kernel through the completion ring once sent. A tiny XDP program is attached to
+ * the interface and redirects packets arriving on an opened queue to its AF_XDP socket. Packets arriving on other queues, or
+ * arriving while the socket isn't ready, continue to the kernel network stack as usual.<BR>
+ * XdpDevice can work in 2 modes:
+ * - Native mode - the XDP program runs inside the NIC driver. If the driver supports it, packet data isn't copied at all
+ *   (zero-copy mode)
+ * - Generic (SKB) mode - the XDP program runs after the kernel allocated a socket buffer for the packet. This mode works with any
+ *   interface, including veth pairs, which makes it convenient for testing, but it's slower since packets are copied
+ *
+ * XdpDevice requires Linux 5.3 or later and root privileges (or CAP_NET_ADMIN + CAP_BPF). PcapPlusPlus must be configured with
+ * --use-xdp in order to use it.
+ */
+
+/**
+* \namespace pcpp
+* \brief The main namespace for the PcapPlusPlus lib
+*/
+namespace pcpp
+{
+
+	class XdpDevice;
+	struct XdpQueue;
+
+	/**
+	 * @typedef OnXdpPacketsArriveCallback
+	 * A callback that is called when a burst of packets are captured by XdpDevice
+	 * @param[in] packets A pointer to an array of RawPacket. The raw data of these packets points directly into the UMEM and is valid
+	 * only until the callback returns, so packets that should be kept must be copied
+	 * @param[in] numOfPackets The length of the array
+	 * @param[in] threadId The ID of the queue (thread) that captured the packets
+	 * @param[in] device A pointer to the XdpDevice who captured the packets
+	 * @param[in] userCookie The user cookie assigned by the user in XdpDevice#startCaptureSingleThread() or XdpDevice#startCaptureMultiThreads()
+	 */
+	typedef void (*OnXdpPacketsArriveCallback)(RawPacket* packets, uint32_t numOfPackets, uint8_t threadId, XdpDevice* device, void* userCookie);
+
+	/**
+	 * @class XdpDevice
+	 * A class wrapping AF_XDP sockets of a single network interface. It supports opening several RX/TX queues, receiving packets
+	 * with capture threads (one per queue, with the same burst callback shape as DpdkDevice) or by polling, and sending packets.
+	 * Each opened queue may be used by one receiving thread and one sending thread concurrently
+	 */
+	class XdpDevice : public IDevice
+	{
+	public:
+
+		/**
+		 * How to attach the XDP program to the interface
+		 */
+		enum XdpAttachMode
+		{
+			/** Try native mode first and fall back to generic mode if the driver doesn't support XDP */
+			XdpAttachModeAuto,
+			/** Generic (SKB) mode which works with any interface */
+			XdpAttachModeGeneric,
+			/** Native (driver) mode */
+			XdpAttachModeNative
+		};
+
+		/**
+		 * @struct XdpDeviceConfiguration
+		 * The configuration used for opening the device queues
+		 */
+		struct XdpDeviceConfiguration
+		{
+			/** How to attach the XDP program. The default is XdpAttachModeAuto */
+			XdpAttachMode attachMode;
+
+			/**
+			 * Request zero-copy mode when the XDP program is attached in native mode. If the driver doesn't support zero-copy the
+			 * socket falls back to copy mode. The default is true
+			 */
+			bool zeroCopy;
+
+			/** The number of UMEM frames of each queue. Half of them are used for RX and half for TX. The default is 4096 */
+			uint32_t numOfFrames;
+
+			/** The size of each UMEM frame, either 2048 or 4096 bytes. The default is 4096 */
+			uint32_t frameSize;
+
+			/** The number of descriptors in the RX, TX, fill and completion rings. Must be a power of 2. The default is 2048 */
+			uint32_t ringSize;
+
+			/** The maximum number of packets delivered in a single callback or received in a single receivePackets() call. The default is 64 */
+			uint16_t burstSize;
+
+			/**
+			 * A c'tor that sets the default values
+			 */
+			XdpDeviceConfiguration() : attachMode(XdpAttachModeAuto), zeroCopy(true), numOfFrames(4096), frameSize(4096), ringSize(2048), burstSize(64) {}
+		};
+
+		/**
+		 * @struct XdpStats
+		 * Statistics of a single queue or of all opened queues
+		 */
+		struct XdpStats
+		{
+			/** Packets received by the application */
+			uint64_t rxPackets;
+			/** Bytes received by the application */
+			uint64_t rxBytes;
+			/** Packets sent by the application */
+			uint64_t txPackets;
+			/** Bytes sent by the application */
+			uint64_t txBytes;
+			/** Packets that couldn't be sent because the TX ring or the TX frames were exhausted */
+			uint64_t txDropped;
+			/** Packets dropped by the kernel for reasons other than a full RX ring */
+			uint64_t rxDroppedByKernel;
+			/** Times the RX ring was full when the kernel tried to deliver a packet */
+			uint64_t rxRingFull;
+			/** Times the fill ring was empty when the kernel needed a frame */
+			uint64_t fillRingEmpty;
+			/** Invalid RX descriptors reported by the kernel */
+			uint64_t rxInvalidDescs;
+			/** Invalid TX descriptors reported by the kernel */
+			uint64_t txInvalidDescs;
+		};
+
+		/**
+		 * A c'tor for this class. It doesn't open the device
+		 * @param[in] interfaceName The name of the network interface, for example "eth0"
+		 */
+		XdpDevice(const std::string& interfaceName);
+
+		/**
+		 * A d'tor for this class. Stops the capture threads and closes the device if needed
+		 */
+		virtual ~XdpDevice();
+
+		/**
+		 * @return The interface name
+		 */
+		const std::string& getInterfaceName() const { return m_InterfaceName; }
+
+		/**
+		 * @return The interface index or 0 if the interface doesn't exist
+		 */
+		int getInterfaceIndex() const { return m_InterfaceIndex; }
+
+		/**
+		 * @return The number of RX queues of the interface as reported by sysfs, or 1 if it cannot be determined
+		 */
+		uint16_t getTotalNumOfRxQueues() const;
+
+		/**
+		 * @return The number of queues currently opened
+		 */
+		uint16_t getNumOfOpenedQueues() const { return (uint16_t)m_Queues.size(); }
+
+		/**
+		 * @return The mode the XDP program is actually attached in. Relevant only when the device is opened
+		 */
+		XdpAttachMode getAttachMode() const { return m_AttachMode; }
+
+		/**
+		 * @return True if the sockets work in zero-copy mode, false if packets are copied to the UMEM
+		 */
+		bool isZeroCopy() const { return m_ZeroCopy; }
+
+		/**
+		 * @return The configuration the device was opened with
+		 */
+		const XdpDeviceConfiguration& getConfiguration() const { return m_Config; }
+
+		/**
+		 * Open queue #0 of the interface with the default configuration
+		 * @return True if the device was opened successfully, false otherwise
+		 */
+		bool open();
+
+		/**
+		 * Open several queues of the interface. Queues #0 to numOfQueues-1 are opened, each with its own AF_XDP socket and UMEM
+		 * @param[in] numOfQueues The number of queues to open
+		 * @param[in] config The device configuration
+		 * @return True if the device was opened successfully, false otherwise
+		 */
+		bool openMultiQueues(uint16_t numOfQueues, const XdpDeviceConfiguration& config = XdpDeviceConfiguration());
+
+		/**
+		 * Stop the capture threads, close the sockets, detach the XDP program and free the UMEM
+		 */
+		void close();
+
+		/**
+		 * Receive the packets that are currently waiting on a queue, up to XdpDeviceConfiguration#burstSize packets. The packet data
+		 * is copied out of the UMEM so the packets remain valid after the call. This method shouldn't be used on queues which are
+		 * handled by a capture thread
+		 * @param[out] rawPacketsVec A vector to add the received packets to
+		 * @param[in] queueId The queue to receive from
+		 * @param[in] timeoutMsec The time to wait for packets if none are waiting. 0 means returning immediately and a negative value
+		 * means waiting forever
+		 * @return The number of packets received
+		 */
+		uint16_t receivePackets(RawPacketVector& rawPacketsVec, uint16_t queueId = 0, int timeoutMsec = 0);
+
+		/**
+		 * Send an array of packets. Packet data is copied into TX frames of the queue UMEM
+		 * @param[in] rawPacketsArr An array of packets to send
+		 * @param[in] arrLength The length of the array
+		 * @param[in] queueId The queue to send the packets on
+		 * @return The number of packets actually queued for sending. It may be lower than arrLength if the TX ring is full or if
+		 * a packet is larger than a frame
+		 */
+		uint16_t sendPackets(const RawPacket* rawPacketsArr, uint16_t arrLength, uint16_t queueId = 0);
+
+		/**
+		 * Send a vector of packets. The packets are queued on the TX ring in one batch, same as in the array overload of this method
+		 * @param[in] rawPacketsVec The packets to send. Only the first 65535 packets are sent
+		 * @param[in] queueId The queue to send the packets on
+		 * @return The number of packets actually queued for sending. It may be lower than the vector size if the TX ring is full or if
+		 * a packet is larger than a frame
+		 */
+		uint16_t sendPackets(const RawPacketVector& rawPacketsVec, uint16_t queueId = 0);
+
+		/**
+		 * Send a single packet
+		 * @param[in] rawPacket The packet to send
+		 * @param[in] queueId The queue to send the packet on
+		 * @return True if the packet was queued for sending, false otherwise
+		 */
+		bool sendPacket(const RawPacket& rawPacket, uint16_t queueId = 0);
+
+		/**
+		 * Start capturing on a single thread. Works only when a single queue is opened
+		 * @param[in] onPacketsArrive A callback that is called for every burst of captured packets
+		 * @param[in] onPacketsArriveUserCookie A cookie delivered to the callback
+		 * @return True if the capture thread started successfully, false otherwise
+		 */
+		bool startCaptureSingleThread(OnXdpPacketsArriveCallback onPacketsArrive, void* onPacketsArriveUserCookie);
+
+		/**
+		 * Start capturing with one thread per opened queue. The number of cores in the core mask must be equal to the number of opened
+		 * queues: the thread of queue #N is pinned to the Nth core in the mask
+		 * @param[in] onPacketsArrive A callback that is called for every burst of captured packets
+		 * @param[in] onPacketsArriveUserCookie A cookie delivered to the callback
+		 * @param[in] coreMask The cores to run the capture threads on
+		 * @return True if all capture threads started successfully, false otherwise
+		 */
+		bool startCaptureMultiThreads(OnXdpPacketsArriveCallback onPacketsArrive, void* onPacketsArriveUserCookie, const CoreMask& coreMask);
+
+		/**
+		 * Stop all capture threads and wait for them to exit
+		 */
+		void stopCapture();
+
+		/**
+		 * @return True if capture threads are currently running, false otherwise
+		 */
+		bool isCapturing() const { return !m_CaptureThreads.empty(); }
+
+		/**
+		 * Set the polling policy of the capture threads (see PollingPolicy.h). By default capture threads busy-poll their queues.
+		 * In pcpp#PollingModeInterrupt the capture threads block in poll() after PollingPolicy#spinCount empty polls
+		 * @param[in] policy The policy to use
+		 * @return False if capture is currently running, true otherwise
+		 */
+		bool setPollingPolicy(const PollingPolicy& policy);
+
+		/**
+		 * @return The polling policy of the capture threads
+		 */
+		const PollingPolicy& getPollingPolicy() const { return m_PollingPolicy; }
+
+		/**
+		 * Get the polling stats of the capture thread of a single queue since capture started
+		 * @param[out] stats The polling stats
+		 * @param[in] queueId The queue ID
+		 */
+		void getPollingStats(PollingStats& stats, uint16_t queueId) const;
+
+		/**
+		 * Get the aggregated polling stats of all capture threads since capture started
+		 * @param[out] stats The aggregated polling stats
+		 */
+		void getPollingStats(PollingStats& stats) const;
+
+		/**
+		 * Get the statistics of a single queue
+		 * @param[out] stats The queue statistics
+		 * @param[in] queueId The queue ID
+		 */
+		void getStatistics(XdpStats& stats, uint16_t queueId) const;
+
+		/**
+		 * Get the aggregated statistics of all opened queues
+		 * @param[out] stats The aggregated statistics
+		 */
+		void getStatistics(XdpStats& stats) const;
+
+	private:
+		std::string m_InterfaceName;
+		int m_InterfaceIndex;
+		XdpDeviceConfiguration m_Config;
+		XdpAttachMode m_AttachMode;
+		bool m_ZeroCopy;
+		std::vector<XdpQueue*> m_Queues;
+		int m_XskMapFd;
+		int m_ProgramFd;
+		uint32_t m_AttachFlags;
+		bool m_ProgramAttached;
+
+		OnXdpPacketsArriveCallback m_OnPacketsArrive;
+		void* m_OnPacketsArriveUserCookie;
+		volatile bool m_StopThread;
+		std::vector<pthread_t> m_CaptureThreads;
+		PollingPolicy m_PollingPolicy;
+
+		// private copy c'tor and assignment operator
+		XdpDevice(const XdpDevice& other);
+		XdpDevice& operator=(const XdpDevice& other);
+
+		bool loadAndAttachProgram();
+		void detachProgram();
+		bool startCaptureThread(XdpQueue* queue, int coreId);
+		uint16_t receiveBurst(XdpQueue* queue, RawPacket* packets);
+		void releaseBurst(XdpQueue* queue, RawPacket* packets, uint16_t numOfPackets);
+		uint16_t sendBurst(const RawPacket* rawPacketsArr, const RawPacket* const* rawPacketPtrs, uint16_t numOfPackets, uint16_t queueId);
+		static void* captureThreadMain(void* ptr);
+	};
+
+} // namespace pcpp
+
+#endif /* PCAPPP_XDP_DEVICE */
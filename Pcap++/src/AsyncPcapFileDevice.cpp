@@ -0,0 +1,1377 @@
+#define LOG_MODULE PcapLogModuleFileDevice
+
+#include "AsyncPcapFileDevice.h"
+#include "Logger.h"
+#include <algorithm>
+#include <string.h>
+#include <errno.h>
+#include <stdlib.h>
+#if !defined(WIN32) && !defined(WINx64) && !defined(PCAPPP_MINGW_ENV)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+#if defined(LINUX) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define PCPP_HAS_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+#define PCAP_MAGIC_USEC 0xa1b2c3d4
+#define PCAP_MAGIC_NSEC 0xa1b23c4d
+#define PCAPNG_SECTION_HEADER_BLOCK 0x0A0D0D0A
+#define PCAPNG_INTERFACE_DESCRIPTION_BLOCK 1
+#define PCAPNG_SIMPLE_PACKET_BLOCK 3
+#define PCAPNG_ENHANCED_PACKET_BLOCK 6
+#define PCAPNG_BYTE_ORDER_MAGIC 0x1A2B3C4D
+#define PCAPNG_OPTION_IF_TSRESOL 9
+// larger records are considered a corrupted file, same as libpcap
+#define ASYNC_FILE_MAX_RECORD_SIZE (256 * 1024)
+#define ASYNC_FILE_ALIGNMENT 4096
+
+namespace pcpp
+{
+
+static inline uint32_t byteSwap32(uint32_t value)
+{
+	return (value >> 24) | ((value >> 8) & 0xff00) | ((value << 8) & 0xff0000) | (value << 24);
+}
+
+// ~~~~~~~~~~~~~~~~~~~
+// AsyncFileIO members
+// ~~~~~~~~~~~~~~~~~~~
+
+/**
+ * Manages a file and AsyncFileConfiguration#queueDepth aligned chunk buffers. A read or write of a whole buffer is submitted with
+ * submitRead() or submitWrite() and waitFor() blocks until it completes. With io_uring the operations run in the kernel in the background
+ * and are submitted in batches; with the POSIX backend they're done synchronously in waitFor()
+ */
+class AsyncFileIO
+{
+public:
+	AsyncFileIO();
+	~AsyncFileIO();
+
+	bool open(const char* fileName, bool forWriting, bool append, const AsyncFileConfiguration& config, uint64_t& fileSize);
+	void close();
+
+	bool isIoUring() const { return m_RingFd >= 0; }
+	bool isDirectIO() const { return m_DirectIO; }
+	bool isPreallocated() const { return m_Preallocated; }
+	uint16_t getNumOfBuffers() const { return (uint16_t)m_Ops.size(); }
+	uint32_t getBufferSize() const { return m_BufferSize; }
+	uint8_t* getBuffer(uint16_t index) const { return m_Buffers + (size_t)index * m_BufferSize; }
+	bool isPending(uint16_t index) const { return m_Ops[index].pending; }
+
+	void submitRead(uint16_t index, uint64_t offset, uint32_t len) { submit(index, false, offset, len); }
+	void submitWrite(uint16_t index, uint64_t offset, uint32_t len) { submit(index, true, offset, len); }
+	void flushSubmissions();
+	int waitFor(uint16_t index);
+	bool waitForAll();
+
+	int readSync(void* buffer, uint32_t len, uint64_t offset);
+	bool truncate(uint64_t size);
+	bool preallocate(uint64_t size);
+
+private:
+	struct Op
+	{
+		bool pending;
+		bool completed;
+		bool isWrite;
+		uint64_t offset;
+		uint32_t len;
+		int result;
+		uint8_t* buffer;
+#ifdef PCPP_HAS_IO_URING
+		struct iovec iov;
+#endif
+	};
+
+	int m_Fd;
+	bool m_DirectIO;
+	bool m_Preallocated;
+	uint8_t* m_Buffers;
+	uint32_t m_BufferSize;
+	std::vector<Op> m_Ops;
+
+	int m_RingFd;
+#ifdef PCPP_HAS_IO_URING
+	uint32_t* m_SqTail;
+	uint32_t m_SqMask;
+	uint32_t* m_SqArray;
+	struct io_uring_sqe* m_Sqes;
+	uint32_t* m_CqHead;
+	uint32_t* m_CqTail;
+	uint32_t m_CqMask;
+	struct io_uring_cqe* m_Cqes;
+	void* m_SqRing;
+	size_t m_SqRingSize;
+	void* m_CqRing;
+	size_t m_CqRingSize;
+	size_t m_SqesSize;
+	bool m_FixedBuffers;
+	uint32_t m_ToSubmit;
+
+	bool setupIoUring();
+	void teardownIoUring();
+	void reapCompletions();
+	void abortIoUring(int error);
+#endif
+
+	void submit(uint16_t index, bool isWrite, uint64_t offset, uint32_t len);
+	int completeSync(Op& op, uint32_t done);
+};
+
+AsyncFileIO::AsyncFileIO() : m_Fd(-1), m_DirectIO(false), m_Preallocated(false), m_Buffers(NULL), m_BufferSize(0), m_RingFd(-1)
+{
+#ifdef PCPP_HAS_IO_URING
+	m_SqTail = m_SqArray = m_CqHead = m_CqTail = NULL;
+	m_SqMask = m_CqMask = 0;
+	m_Sqes = NULL;
+	m_Cqes = NULL;
+	m_SqRing = m_CqRing = MAP_FAILED;
+	m_SqRingSize = m_CqRingSize = m_SqesSize = 0;
+	m_FixedBuffers = false;
+	m_ToSubmit = 0;
+#endif
+}
+
+AsyncFileIO::~AsyncFileIO()
+{
+	close();
+}
+
+#if defined(WIN32) || defined(WINx64) || defined(PCAPPP_MINGW_ENV)
+
+bool AsyncFileIO::open(const char* fileName, bool forWriting, bool append, const AsyncFileConfiguration& config, uint64_t& fileSize)
+{
+	LOG_ERROR("Async file devices are not supported on Windows");
+	return false;
+}
+
+void AsyncFileIO::close() {}
+void AsyncFileIO::flushSubmissions() {}
+int AsyncFileIO::waitFor(uint16_t index) { return -1; }
+bool AsyncFileIO::waitForAll() { return false; }
+int AsyncFileIO::readSync(void* buffer, uint32_t len, uint64_t offset) { return -1; }
+bool AsyncFileIO::truncate(uint64_t size) { return false; }
+bool AsyncFileIO::preallocate(uint64_t size) { return false; }
+void AsyncFileIO::submit(uint16_t index, bool isWrite, uint64_t offset, uint32_t len) {}
+int AsyncFileIO::completeSync(Op& op, uint32_t done) { return -1; }
+
+#else
+
+bool AsyncFileIO::open(const char* fileName, bool forWriting, bool append, const AsyncFileConfiguration& config, uint64_t& fileSize)
+{
+	int flags = forWriting ? (O_RDWR | (append ? 0 : O_CREAT | O_TRUNC)) : O_RDONLY;
+	m_DirectIO = false;
+#ifdef O_DIRECT
+	if (config.directIO && !append)
+	{
+		m_Fd = ::open(fileName, flags | O_DIRECT, 0644);
+		if (m_Fd >= 0)
+			m_DirectIO = true;
+		else if (errno == EINVAL)
+			LOG_DEBUG("File system of '%s' doesn't support O_DIRECT, using buffered I/O", fileName);
+	}
+#endif
+	if (m_Fd < 0)
+		m_Fd = ::open(fileName, flags, 0644);
+
+	if (m_Fd < 0)
+	{
+		LOG_ERROR("Cannot open file '%s': %s", fileName, strerror(errno));
+		return false;
+	}
+
+	struct stat fileStat;
+	if (fstat(m_Fd, &fileStat) != 0)
+	{
+		LOG_ERROR("Cannot get the size of file '%s': %s", fileName, strerror(errno));
+		close();
+		return false;
+	}
+	fileSize = fileStat.st_size;
+
+#ifdef POSIX_FADV_SEQUENTIAL
+	if (!forWriting)
+		posix_fadvise(m_Fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+	uint16_t numOfBuffers = config.queueDepth > 0 ? config.queueDepth : 1;
+	m_BufferSize = config.chunkSize > 0 ? config.chunkSize : ASYNC_FILE_ALIGNMENT;
+	m_BufferSize = (m_BufferSize + ASYNC_FILE_ALIGNMENT - 1) / ASYNC_FILE_ALIGNMENT * ASYNC_FILE_ALIGNMENT;
+	void* buffers = NULL;
+	if (posix_memalign(&buffers, ASYNC_FILE_ALIGNMENT, (size_t)numOfBuffers * m_BufferSize) != 0)
+	{
+		LOG_ERROR("Cannot allocate %d buffers of %d bytes for file '%s'", numOfBuffers, m_BufferSize, fileName);
+		close();
+		return false;
+	}
+	m_Buffers = (uint8_t*)buffers;
+
+	Op emptyOp;
+	memset(&emptyOp, 0, sizeof(emptyOp));
+	m_Ops.assign(numOfBuffers, emptyOp);
+
+	if (config.backend != AsyncFileConfiguration::BackendPosix)
+	{
+#ifdef PCPP_HAS_IO_URING
+		if (!setupIoUring())
+			teardownIoUring();
+#endif
+		if (!isIoUring() && config.backend == AsyncFileConfiguration::BackendIoUring)
+		{
+			LOG_ERROR("io_uring isn't available for file '%s'", fileName);
+			close();
+			return false;
+		}
+	}
+
+	LOG_DEBUG("Opened file '%s' with %s%s, %d chunks of %d bytes", fileName, (isIoUring() ? "io_uring" : "pread/pwrite"),
+			(m_DirectIO ? " and O_DIRECT" : ""), numOfBuffers, m_BufferSize);
+	return true;
+}
+
+void AsyncFileIO::close()
+{
+	if (m_Fd >= 0)
+	{
+		waitForAll();
+		::close(m_Fd);
+		m_Fd = -1;
+	}
+
+#ifdef PCPP_HAS_IO_URING
+	teardownIoUring();
+#endif
+
+	free(m_Buffers);
+	m_Buffers = NULL;
+	m_Ops.clear();
+}
+
+#ifdef PCPP_HAS_IO_URING
+
+bool AsyncFileIO::setupIoUring()
+{
+	struct io_uring_params params;
+	memset(&params, 0, sizeof(params));
+	m_RingFd = (int)syscall(__NR_io_uring_setup, (unsigned)m_Ops.size(), &params);
+	if (m_RingFd < 0)
+	{
+		LOG_DEBUG("io_uring_setup failed: %s", strerror(errno));
+		return false;
+	}
+
+	m_SqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+	m_CqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+	bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+	if (singleMmap)
+		m_SqRingSize = m_CqRingSize = std::max(m_SqRingSize, m_CqRingSize);
+
+	m_SqRing = mmap(NULL, m_SqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_RingFd, IORING_OFF_SQ_RING);
+	if (m_SqRing == MAP_FAILED)
+		return false;
+
+	if (singleMmap)
+		m_CqRing = m_SqRing;
+	else
+	{
+		m_CqRing = mmap(NULL, m_CqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_RingFd, IORING_OFF_CQ_RING);
+		if (m_CqRing == MAP_FAILED)
+			return false;
+	}
+
+	m_SqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+	void* sqes = mmap(NULL, m_SqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_RingFd, IORING_OFF_SQES);
+	if (sqes == MAP_FAILED)
+		return false;
+	m_Sqes = (struct io_uring_sqe*)sqes;
+
+	uint8_t* sqRing = (uint8_t*)m_SqRing;
+	m_SqTail = (uint32_t*)(sqRing + params.sq_off.tail);
+	m_SqMask = *(uint32_t*)(sqRing + params.sq_off.ring_mask);
+	m_SqArray = (uint32_t*)(sqRing + params.sq_off.array);
+
+	uint8_t* cqRing = (uint8_t*)m_CqRing;
+	m_CqHead = (uint32_t*)(cqRing + params.cq_off.head);
+	m_CqTail = (uint32_t*)(cqRing + params.cq_off.tail);
+	m_CqMask = *(uint32_t*)(cqRing + params.cq_off.ring_mask);
+	m_Cqes = (struct io_uring_cqe*)(cqRing + params.cq_off.cqes);
+
+	// registering the buffers saves the kernel from mapping them on every operation. It may fail because of RLIMIT_MEMLOCK, in which
+	// case the buffers are passed to each operation with an iovec
+	std::vector<struct iovec> iovecs(m_Ops.size());
+	for (size_t i = 0; i < m_Ops.size(); i++)
+	{
+		iovecs[i].iov_base = getBuffer((uint16_t)i);
+		iovecs[i].iov_len = m_BufferSize;
+	}
+	m_FixedBuffers = syscall(__NR_io_uring_register, m_RingFd, IORING_REGISTER_BUFFERS, &iovecs[0], (unsigned)iovecs.size()) == 0;
+	if (!m_FixedBuffers)
+		LOG_DEBUG("Couldn't register io_uring buffers: %s", strerror(errno));
+
+	return true;
+}
+
+void AsyncFileIO::teardownIoUring()
+{
+	if (m_Sqes != NULL)
+		munmap(m_Sqes, m_SqesSize);
+	if (m_CqRing != MAP_FAILED && m_CqRing != m_SqRing)
+		munmap(m_CqRing, m_CqRingSize);
+	if (m_SqRing != MAP_FAILED)
+		munmap(m_SqRing, m_SqRingSize);
+	if (m_RingFd >= 0)
+		::close(m_RingFd);
+
+	m_RingFd = -1;
+	m_Sqes = NULL;
+	m_SqRing = m_CqRing = MAP_FAILED;
+	m_FixedBuffers = false;
+	m_ToSubmit = 0;
+}
+
+void AsyncFileIO::reapCompletions()
+{
+	uint32_t head = *m_CqHead;
+	uint32_t tail = __atomic_load_n(m_CqTail, __ATOMIC_ACQUIRE);
+	for (; head != tail; head++)
+	{
+		struct io_uring_cqe* cqe = &m_Cqes[head & m_CqMask];
+		Op& op = m_Ops[cqe->user_data];
+		if (!op.pending)
+			continue;
+		op.result = cqe->res;
+		op.completed = true;
+	}
+
+	__atomic_store_n(m_CqHead, head, __ATOMIC_RELEASE);
+}
+
+void AsyncFileIO::abortIoUring(int error)
+{
+	// closing the ring makes the kernel cancel or finish the operations that are still in flight, so the buffers can be reused or freed
+	// afterwards. The operations that didn't complete fail with the error and the rest of the I/O is done with pread()/pwrite()
+	teardownIoUring();
+
+	for (size_t i = 0; i < m_Ops.size(); i++)
+	{
+		Op& op = m_Ops[i];
+		if (op.pending && !op.completed)
+		{
+			op.result = error;
+			op.completed = true;
+		}
+	}
+}
+
+#endif // PCPP_HAS_IO_URING
+
+void AsyncFileIO::submit(uint16_t index, bool isWrite, uint64_t offset, uint32_t len)
+{
+	Op& op = m_Ops[index];
+	op.pending = true;
+	op.completed = false;
+	op.isWrite = isWrite;
+	op.offset = offset;
+	op.len = len;
+	op.result = 0;
+	op.buffer = getBuffer(index);
+
+#ifdef PCPP_HAS_IO_URING
+	op.iov.iov_base = op.buffer;
+	op.iov.iov_len = len;
+	if (isIoUring())
+	{
+		// there is one submission queue entry per buffer so the queue never overflows
+		uint32_t tail = *m_SqTail;
+		uint32_t sqeIndex = tail & m_SqMask;
+		struct io_uring_sqe* sqe = &m_Sqes[sqeIndex];
+		memset(sqe, 0, sizeof(*sqe));
+		sqe->fd = m_Fd;
+		sqe->off = offset;
+		sqe->user_data = index;
+		if (m_FixedBuffers)
+		{
+			sqe->opcode = isWrite ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+			sqe->addr = (uint64_t)(unsigned long)getBuffer(index);
+			sqe->len = len;
+			sqe->buf_index = index;
+		}
+		else
+		{
+			sqe->opcode = isWrite ? IORING_OP_WRITEV : IORING_OP_READV;
+			sqe->addr = (uint64_t)(unsigned long)&op.iov;
+			sqe->len = 1;
+		}
+
+		m_SqArray[sqeIndex] = sqeIndex;
+		__atomic_store_n(m_SqTail, tail + 1, __ATOMIC_RELEASE);
+		m_ToSubmit++;
+	}
+#endif
+}
+
+void AsyncFileIO::flushSubmissions()
+{
+#ifdef PCPP_HAS_IO_URING
+	while (m_ToSubmit > 0)
+	{
+		int res = (int)syscall(__NR_io_uring_enter, m_RingFd, m_ToSubmit, 0, 0, NULL, 0);
+		if (res < 0)
+		{
+			if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+				continue;
+			LOG_ERROR("io_uring_enter failed: %s", strerror(errno));
+			return;
+		}
+		m_ToSubmit -= res;
+	}
+#endif
+}
+
+int AsyncFileIO::completeSync(Op& op, uint32_t done)
+{
+	// completes the operation synchronously: used by the POSIX backend and for short reads/writes
+	uint8_t* buffer = op.buffer;
+	while (done < op.len)
+	{
+		ssize_t res = op.isWrite ? pwrite(m_Fd, buffer + done, op.len - done, op.offset + done) : pread(m_Fd, buffer + done, op.len - done, op.offset + done);
+		if (res < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			return -errno;
+		}
+		if (res == 0)
+			break;
+		done += res;
+	}
+
+	return done;
+}
+
+int AsyncFileIO::waitFor(uint16_t index)
+{
+	Op& op = m_Ops[index];
+	if (!op.pending)
+		return 0;
+
+#ifdef PCPP_HAS_IO_URING
+	while (isIoUring() && !op.completed)
+	{
+		reapCompletions();
+		if (op.completed)
+			break;
+
+		int res = (int)syscall(__NR_io_uring_enter, m_RingFd, m_ToSubmit, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+		if (res < 0)
+		{
+			if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+				continue;
+			int error = -errno;
+			LOG_ERROR("io_uring_enter failed: %s", strerror(errno));
+			abortIoUring(error);
+			break;
+		}
+		m_ToSubmit -= res;
+	}
+#endif
+
+	// the operation stays pending until its completion was reaped, so its buffer isn't reused while the kernel may still access it
+	op.pending = false;
+
+	// operations of the POSIX backend are done here
+	if (!op.completed)
+		return completeSync(op, 0);
+
+	if (op.result < 0 || (uint32_t)op.result == op.len)
+		return op.result;
+
+	return completeSync(op, op.result);
+}
+
+bool AsyncFileIO::waitForAll()
+{
+	flushSubmissions();
+
+	bool result = true;
+	for (uint16_t i = 0; i < m_Ops.size(); i++)
+	{
+		if (!m_Ops[i].pending)
+			continue;
+
+		bool isWrite = m_Ops[i].isWrite;
+		uint32_t len = m_Ops[i].len;
+		int res = waitFor(i);
+		if (res < 0 || (isWrite && (uint32_t)res != len))
+			result = false;
+	}
+
+	return result;
+}
+
+int AsyncFileIO::readSync(void* buffer, uint32_t len, uint64_t offset)
+{
+	ssize_t res = pread(m_Fd, buffer, len, offset);
+	return res < 0 ? -errno : (int)res;
+}
+
+bool AsyncFileIO::truncate(uint64_t size)
+{
+	return ftruncate(m_Fd, size) == 0;
+}
+
+bool AsyncFileIO::preallocate(uint64_t size)
+{
+#if defined(LINUX) && defined(FALLOC_FL_KEEP_SIZE)
+	// the file size isn't changed so readers of the file being written don't see the preallocated space as data
+	if (fallocate(m_Fd, FALLOC_FL_KEEP_SIZE, 0, size) != 0)
+	{
+		LOG_DEBUG("fallocate failed: %s", strerror(errno));
+		return false;
+	}
+
+	m_Preallocated = true;
+	return true;
+#else
+	LOG_DEBUG("Preallocating files isn't supported on this platform");
+	return false;
+#endif
+}
+
+#endif // WIN32 || WINx64 || PCPP_MINGW_ENV
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// AsyncPcapFileReaderDevice members
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+AsyncPcapFileReaderDevice::AsyncPcapFileReaderDevice(const char* fileName, const AsyncFileConfiguration& config) :
+	IFileReaderDevice(fileName), m_Config(config)
+{
+	m_IO = NULL;
+	m_FileFormat = CaptureFilePcap;
+	m_LinkLayerType = LINKTYPE_ETHERNET;
+	m_SwapBytes = false;
+	m_NanosecondPrecision = false;
+	m_FileSize = 0;
+	m_NextReadOffset = 0;
+	m_CurChunk = 0;
+	m_CurChunkPos = 0;
+	m_CurChunkLen = 0;
+}
+
+AsyncPcapFileReaderDevice::~AsyncPcapFileReaderDevice()
+{
+	close();
+}
+
+bool AsyncPcapFileReaderDevice::isUsingIoUring() const
+{
+	return m_IO != NULL && m_IO->isIoUring();
+}
+
+uint32_t AsyncPcapFileReaderDevice::swap32(uint32_t value) const
+{
+	return m_SwapBytes ? byteSwap32(value) : value;
+}
+
+uint16_t AsyncPcapFileReaderDevice::swap16(uint16_t value) const
+{
+	return m_SwapBytes ? (uint16_t)((value >> 8) | (value << 8)) : value;
+}
+
+bool AsyncPcapFileReaderDevice::nextChunk()
+{
+	uint16_t numOfChunks = m_IO->getNumOfBuffers();
+
+	// the chunk that was just consumed is reused to read ahead the next unread part of the file
+	if (m_NextReadOffset < m_FileSize)
+	{
+		m_IO->submitRead(m_CurChunk, m_NextReadOffset, m_IO->getBufferSize());
+		m_IO->flushSubmissions();
+		m_NextReadOffset += m_IO->getBufferSize();
+	}
+
+	m_CurChunk = (m_CurChunk + 1) % numOfChunks;
+	m_CurChunkPos = 0;
+	m_CurChunkLen = 0;
+
+	if (!m_IO->isPending(m_CurChunk))
+		return false;
+
+	int res = m_IO->waitFor(m_CurChunk);
+	if (res < 0)
+	{
+		LOG_ERROR("Error reading file '%s': %s", m_FileName, strerror(-res));
+		return false;
+	}
+
+	m_CurChunkLen = res;
+	return res > 0;
+}
+
+bool AsyncPcapFileReaderDevice::hasMoreData()
+{
+	while (m_CurChunkPos == m_CurChunkLen)
+	{
+		if (!nextChunk())
+			return false;
+	}
+
+	return true;
+}
+
+bool AsyncPcapFileReaderDevice::readBytes(void* dest, uint32_t len)
+{
+	uint8_t* destPtr = (uint8_t*)dest;
+	while (len > 0)
+	{
+		if (!hasMoreData())
+			return false;
+
+		uint32_t toCopy = std::min<uint32_t>(len, m_CurChunkLen - m_CurChunkPos);
+		memcpy(destPtr, m_IO->getBuffer(m_CurChunk) + m_CurChunkPos, toCopy);
+		m_CurChunkPos += toCopy;
+		destPtr += toCopy;
+		len -= toCopy;
+	}
+
+	return true;
+}
+
+bool AsyncPcapFileReaderDevice::skipBytes(uint64_t len)
+{
+	while (len > 0)
+	{
+		if (!hasMoreData())
+			return false;
+
+		uint32_t toSkip = (uint32_t)std::min<uint64_t>(len, m_CurChunkLen - m_CurChunkPos);
+		m_CurChunkPos += toSkip;
+		len -= toSkip;
+	}
+
+	return true;
+}
+
+bool AsyncPcapFileReaderDevice::open()
+{
+	m_NumOfPacketsRead = 0;
+	m_NumOfPacketsNotParsed = 0;
+
+	if (m_IO != NULL)
+	{
+		LOG_DEBUG("File '%s' already opened. Nothing to do", m_FileName);
+		return true;
+	}
+
+	m_IO = new AsyncFileIO();
+	if (!m_IO->open(m_FileName, false, false, m_Config, m_FileSize))
+	{
+		delete m_IO;
+		m_IO = NULL;
+		return false;
+	}
+
+	// start reading ahead as many chunks as possible
+	m_NextReadOffset = 0;
+	for (uint16_t i = 0; i < m_IO->getNumOfBuffers() && m_NextReadOffset < m_FileSize; i++)
+	{
+		m_IO->submitRead(i, m_NextReadOffset, m_IO->getBufferSize());
+		m_NextReadOffset += m_IO->getBufferSize();
+	}
+	m_IO->flushSubmissions();
+
+	// nextChunk() moves to the next chunk, so start from the last one to make chunk #0 the current one
+	m_CurChunk = m_IO->getNumOfBuffers() - 1;
+	m_CurChunkPos = m_CurChunkLen = 0;
+	uint64_t nextReadOffset = m_NextReadOffset;
+	m_NextReadOffset = m_FileSize;
+	nextChunk();
+	m_NextReadOffset = nextReadOffset;
+
+	uint32_t magic;
+	if (!readBytes(&magic, sizeof(magic)))
+	{
+		LOG_ERROR("File '%s' is empty or couldn't be read", m_FileName);
+		close();
+		return false;
+	}
+
+	m_SwapBytes = false;
+	m_PcapNgInterfaces.clear();
+	bool validFile = false;
+	if (magic == PCAP_MAGIC_USEC || magic == PCAP_MAGIC_NSEC || byteSwap32(magic) == PCAP_MAGIC_USEC || byteSwap32(magic) == PCAP_MAGIC_NSEC)
+	{
+		m_FileFormat = CaptureFilePcap;
+		m_SwapBytes = (magic != PCAP_MAGIC_USEC && magic != PCAP_MAGIC_NSEC);
+		m_NanosecondPrecision = (swap32(magic) == PCAP_MAGIC_NSEC);
+
+		// version_major, version_minor, thiszone, sigfigs, snaplen, linktype
+		uint32_t header[5];
+		if (readBytes(header, sizeof(header)))
+		{
+			m_LinkLayerType = static_cast<LinkLayerType>(swap32(header[4]) & 0xffff);
+			validFile = true;
+		}
+	}
+	else if (magic == PCAPNG_SECTION_HEADER_BLOCK)
+	{
+		m_FileFormat = CaptureFilePcapNg;
+		uint32_t blockLen;
+		validFile = readBytes(&blockLen, sizeof(blockLen)) && readPcapNgSectionHeader(blockLen);
+		m_LinkLayerType = LINKTYPE_ETHERNET;
+	}
+
+	if (!validFile)
+	{
+		LOG_ERROR("File '%s' is not a valid pcap or pcap-ng file", m_FileName);
+		close();
+		return false;
+	}
+
+	LOG_DEBUG("Successfully opened async reader device for filename '%s'", m_FileName);
+	m_DeviceOpened = true;
+	return true;
+}
+
+bool AsyncPcapFileReaderDevice::readPcapNgSectionHeader(uint32_t blockLen)
+{
+	// the block type is a palindrome, so the byte order is known only from the byte-order magic which follows the block length
+	uint32_t byteOrderMagic;
+	if (!readBytes(&byteOrderMagic, sizeof(byteOrderMagic)))
+		return false;
+
+	if (byteOrderMagic == PCAPNG_BYTE_ORDER_MAGIC)
+		m_SwapBytes = false;
+	else if (byteSwap32(byteOrderMagic) == PCAPNG_BYTE_ORDER_MAGIC)
+		m_SwapBytes = true;
+	else
+	{
+		LOG_ERROR("Invalid pcap-ng byte-order magic in file '%s'", m_FileName);
+		return false;
+	}
+
+	blockLen = swap32(blockLen);
+	if (blockLen < 28 || blockLen % 4 != 0)
+	{
+		LOG_ERROR("Invalid pcap-ng section header length %d in file '%s'", blockLen, m_FileName);
+		return false;
+	}
+
+	// interface IDs are local to a section
+	m_PcapNgInterfaces.clear();
+	return skipBytes(blockLen - 12);
+}
+
+bool AsyncPcapFileReaderDevice::readPcapNgInterface(uint32_t bodyLen)
+{
+	if (bodyLen < 8 || bodyLen > ASYNC_FILE_MAX_RECORD_SIZE)
+		return false;
+
+	std::vector<uint8_t> body(bodyLen);
+	if (!readBytes(&body[0], bodyLen))
+		return false;
+
+	PcapNgInterface pcapNgInterface;
+	uint16_t linkType;
+	memcpy(&linkType, &body[0], sizeof(linkType));
+	memcpy(&pcapNgInterface.snapLen, &body[4], sizeof(pcapNgInterface.snapLen));
+	pcapNgInterface.linkType = static_cast<LinkLayerType>(swap16(linkType));
+	pcapNgInterface.snapLen = swap32(pcapNgInterface.snapLen);
+	pcapNgInterface.unitsPerSecond = 1000000;
+
+	uint32_t offset = 8;
+	while (offset + 4 <= bodyLen)
+	{
+		uint16_t optionCode, optionLen;
+		memcpy(&optionCode, &body[offset], sizeof(optionCode));
+		memcpy(&optionLen, &body[offset + 2], sizeof(optionLen));
+		optionCode = swap16(optionCode);
+		optionLen = swap16(optionLen);
+		offset += 4;
+		if (optionCode == 0 || offset + optionLen > bodyLen)
+			break;
+
+		if (optionCode == PCAPNG_OPTION_IF_TSRESOL && optionLen >= 1)
+		{
+			uint8_t tsresol = body[offset];
+			uint8_t exponent = tsresol & 0x7f;
+			pcapNgInterface.unitsPerSecond = 1;
+			for (uint8_t i = 0; i < exponent && pcapNgInterface.unitsPerSecond < 1000000000000000000ULL; i++)
+				pcapNgInterface.unitsPerSecond *= (tsresol & 0x80) ? 2 : 10;
+		}
+
+		offset += (optionLen + 3) & ~3;
+	}
+
+	if (m_PcapNgInterfaces.empty())
+		m_LinkLayerType = pcapNgInterface.linkType;
+
+	m_PcapNgInterfaces.push_back(pcapNgInterface);
+	return true;
+}
+
+bool AsyncPcapFileReaderDevice::readNextPcapPacket(RawPacket& rawPacket)
+{
+	if (!hasMoreData())
+	{
+		LOG_DEBUG("Packet could not be read. Probably end-of-file");
+		return false;
+	}
+
+	// tv_sec, tv_usec (or tv_nsec), caplen, len
+	uint32_t header[4];
+	if (!readBytes(header, sizeof(header)))
+	{
+		LOG_ERROR("Truncated packet header in file '%s'", m_FileName);
+		return false;
+	}
+
+	uint32_t capLen = swap32(header[2]);
+	if (capLen > ASYNC_FILE_MAX_RECORD_SIZE)
+	{
+		LOG_ERROR("Invalid packet length %d in file '%s', file is probably corrupted", capLen, m_FileName);
+		return false;
+	}
+
+	uint8_t* packetData = new uint8_t[capLen];
+	if (!readBytes(packetData, capLen))
+	{
+		LOG_ERROR("Truncated packet data in file '%s'", m_FileName);
+		delete [] packetData;
+		return false;
+	}
+
+	timespec timestamp;
+	timestamp.tv_sec = swap32(header[0]);
+	timestamp.tv_nsec = m_NanosecondPrecision ? swap32(header[1]) : swap32(header[1]) * 1000;
+	if (!rawPacket.setRawData(packetData, capLen, timestamp, m_LinkLayerType, swap32(header[3])))
+	{
+		LOG_ERROR("Couldn't set data to raw packet");
+		return false;
+	}
+
+	return true;
+}
+
+bool AsyncPcapFileReaderDevice::readNextPcapNgPacket(RawPacket& rawPacket)
+{
+	while (true)
+	{
+		if (!hasMoreData())
+		{
+			LOG_DEBUG("Packet could not be read. Probably end-of-file");
+			return false;
+		}
+
+		uint32_t blockHeader[2];
+		if (!readBytes(blockHeader, sizeof(blockHeader)))
+		{
+			LOG_ERROR("Truncated pcap-ng block in file '%s'", m_FileName);
+			return false;
+		}
+
+		if (blockHeader[0] == PCAPNG_SECTION_HEADER_BLOCK)
+		{
+			if (!readPcapNgSectionHeader(blockHeader[1]))
+				return false;
+			continue;
+		}
+
+		uint32_t blockType = swap32(blockHeader[0]);
+		uint32_t blockLen = swap32(blockHeader[1]);
+		if (blockLen < 12 || blockLen % 4 != 0)
+		{
+			LOG_ERROR("Invalid pcap-ng block length %d in file '%s', file is probably corrupted", blockLen, m_FileName);
+			return false;
+		}
+
+		uint32_t bodyLen = blockLen - 12;
+		if (blockType == PCAPNG_INTERFACE_DESCRIPTION_BLOCK)
+		{
+			if (!readPcapNgInterface(bodyLen) || !skipBytes(4))
+			{
+				LOG_ERROR("Invalid pcap-ng interface description block in file '%s'", m_FileName);
+				return false;
+			}
+			continue;
+		}
+
+		if (blockType != PCAPNG_ENHANCED_PACKET_BLOCK && blockType != PCAPNG_SIMPLE_PACKET_BLOCK)
+		{
+			if (!skipBytes(bodyLen + 4))
+			{
+				LOG_ERROR("Truncated pcap-ng block in file '%s'", m_FileName);
+				return false;
+			}
+			continue;
+		}
+
+		uint32_t interfaceId = 0, capLen, origLen;
+		uint64_t timestampUnits = 0;
+		uint32_t packetHeaderLen;
+		if (blockType == PCAPNG_ENHANCED_PACKET_BLOCK)
+		{
+			// interface ID, timestamp (high), timestamp (low), captured length, original length
+			uint32_t packetHeader[5];
+			packetHeaderLen = sizeof(packetHeader);
+			if (bodyLen < packetHeaderLen || !readBytes(packetHeader, packetHeaderLen))
+			{
+				LOG_ERROR("Invalid pcap-ng enhanced packet block in file '%s'", m_FileName);
+				return false;
+			}
+			interfaceId = swap32(packetHeader[0]);
+			timestampUnits = ((uint64_t)swap32(packetHeader[1]) << 32) | swap32(packetHeader[2]);
+			capLen = swap32(packetHeader[3]);
+			origLen = swap32(packetHeader[4]);
+		}
+		else
+		{
+			// a simple packet block has only the original length, the captured length is derived from the block length
+			packetHeaderLen = sizeof(origLen);
+			if (bodyLen < packetHeaderLen || !readBytes(&origLen, packetHeaderLen))
+			{
+				LOG_ERROR("Invalid pcap-ng simple packet block in file '%s'", m_FileName);
+				return false;
+			}
+			origLen = swap32(origLen);
+			capLen = std::min(origLen, bodyLen - packetHeaderLen);
+			if (!m_PcapNgInterfaces.empty() && m_PcapNgInterfaces[0].snapLen > 0)
+				capLen = std::min(capLen, m_PcapNgInterfaces[0].snapLen);
+		}
+
+		if (interfaceId >= m_PcapNgInterfaces.size() || capLen > bodyLen - packetHeaderLen || capLen > ASYNC_FILE_MAX_RECORD_SIZE)
+		{
+			LOG_ERROR("Invalid pcap-ng packet block in file '%s', file is probably corrupted", m_FileName);
+			return false;
+		}
+
+		uint8_t* packetData = new uint8_t[capLen];
+		if (!readBytes(packetData, capLen) || !skipBytes(bodyLen - packetHeaderLen - capLen + 4))
+		{
+			LOG_ERROR("Truncated pcap-ng packet block in file '%s'", m_FileName);
+			delete [] packetData;
+			return false;
+		}
+
+		const PcapNgInterface& pcapNgInterface = m_PcapNgInterfaces[interfaceId];
+		timespec timestamp;
+		timestamp.tv_sec = timestampUnits / pcapNgInterface.unitsPerSecond;
+		uint64_t remainder = timestampUnits % pcapNgInterface.unitsPerSecond;
+		if (pcapNgInterface.unitsPerSecond <= 1000000000 && 1000000000 % pcapNgInterface.unitsPerSecond == 0)
+			timestamp.tv_nsec = remainder * (1000000000 / pcapNgInterface.unitsPerSecond);
+		else
+			timestamp.tv_nsec = (long)((double)remainder * 1000000000.0 / (double)pcapNgInterface.unitsPerSecond);
+
+		if (!rawPacket.setRawData(packetData, capLen, timestamp, pcapNgInterface.linkType, origLen))
+		{
+			LOG_ERROR("Couldn't set data to raw packet");
+			return false;
+		}
+
+		return true;
+	}
+}
+
+bool AsyncPcapFileReaderDevice::getNextPacket(RawPacket& rawPacket)
+{
+	rawPacket.clear();
+	if (m_IO == NULL)
+	{
+		LOG_ERROR("File device '%s' not opened", m_FileName);
+		return false;
+	}
+
+	while (true)
+	{
+		bool packetRead = (m_FileFormat == CaptureFilePcap ? readNextPcapPacket(rawPacket) : readNextPcapNgPacket(rawPacket));
+		if (!packetRead)
+			return false;
+
+		if (m_BpfWrapper.matchPacketWithFilter(&rawPacket))
+			break;
+
+		m_NumOfPacketsNotParsed++;
+		rawPacket.clear();
+	}
+
+	m_NumOfPacketsRead++;
+	return true;
+}
+
+void AsyncPcapFileReaderDevice::close()
+{
+	if (m_IO == NULL)
+		return;
+
+	delete m_IO;
+	m_IO = NULL;
+	m_DeviceOpened = false;
+	LOG_DEBUG("Async reader closed for file '%s'", m_FileName);
+}
+
+void AsyncPcapFileReaderDevice::getStatistics(PcapStats& stats) const
+{
+	stats.packetsRecv = m_NumOfPacketsRead;
+	stats.packetsDrop = m_NumOfPacketsNotParsed;
+	stats.packetsDropByInterface = 0;
+	LOG_DEBUG("Statistics received for async reader device for filename '%s'", m_FileName);
+}
+
+bool AsyncPcapFileReaderDevice::setFilter(std::string filterAsString)
+{
+	return m_BpfWrapper.setFilter(filterAsString);
+}
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// AsyncPcapFileWriterDevice members
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+AsyncPcapFileWriterDevice::AsyncPcapFileWriterDevice(const char* fileName, LinkLayerType linkLayerType, CaptureFileFormat fileFormat,
+		const AsyncFileConfiguration& config) : IFileWriterDevice(fileName), m_Config(config)
+{
+	m_IO = NULL;
+	m_LinkLayerType = linkLayerType;
+	m_FileFormat = fileFormat;
+	m_TimestampUnitsPerSecond = (fileFormat == CaptureFilePcapNg ? 1000000000 : 1000000);
+	m_FileOffset = 0;
+	m_CurChunk = 0;
+	m_CurChunkPos = 0;
+	m_WriteError = false;
+}
+
+AsyncPcapFileWriterDevice::~AsyncPcapFileWriterDevice()
+{
+	close();
+}
+
+bool AsyncPcapFileWriterDevice::isUsingIoUring() const
+{
+	return m_IO != NULL && m_IO->isIoUring();
+}
+
+bool AsyncPcapFileWriterDevice::submitCurrentChunk()
+{
+	m_IO->submitWrite(m_CurChunk, m_FileOffset, m_IO->getBufferSize());
+	m_IO->flushSubmissions();
+	m_FileOffset += m_IO->getBufferSize();
+	m_CurChunk = (m_CurChunk + 1) % m_IO->getNumOfBuffers();
+	m_CurChunkPos = 0;
+
+	// wait only if the next chunk is still being written
+	uint32_t len = m_IO->getBufferSize();
+	if (m_IO->isPending(m_CurChunk) && m_IO->waitFor(m_CurChunk) != (int)len)
+	{
+		LOG_ERROR("Error writing to file '%s'", m_FileName);
+		m_WriteError = true;
+		return false;
+	}
+
+	return true;
+}
+
+bool AsyncPcapFileWriterDevice::writeBytes(const void* data, uint32_t len)
+{
+	const uint8_t* dataPtr = (const uint8_t*)data;
+	while (len > 0)
+	{
+		uint32_t toCopy = std::min(len, m_IO->getBufferSize() - m_CurChunkPos);
+		memcpy(m_IO->getBuffer(m_CurChunk) + m_CurChunkPos, dataPtr, toCopy);
+		m_CurChunkPos += toCopy;
+		dataPtr += toCopy;
+		len -= toCopy;
+
+		if (m_CurChunkPos == m_IO->getBufferSize() && !submitCurrentChunk())
+			return false;
+	}
+
+	return true;
+}
+
+bool AsyncPcapFileWriterDevice::writePacket(RawPacket const& packet)
+{
+	if (m_IO == NULL)
+	{
+		LOG_ERROR("Device not opened");
+		m_NumOfPacketsNotWritten++;
+		return false;
+	}
+
+	if (packet.getLinkLayerType() != m_LinkLayerType)
+	{
+		LOG_ERROR("Cannot write a packet with a different link layer type");
+		m_NumOfPacketsNotWritten++;
+		return false;
+	}
+
+	if (m_WriteError)
+	{
+		LOG_ERROR("A previous write to file '%s' failed", m_FileName);
+		m_NumOfPacketsNotWritten++;
+		return false;
+	}
+
+	RawPacket& rawPacket = const_cast<RawPacket&>(packet);
+	uint32_t capLen = rawPacket.getRawDataLen();
+	timespec timestamp = rawPacket.getPacketTimeStamp();
+	uint32_t subSecondUnits = (m_TimestampUnitsPerSecond == 1000000000 ? timestamp.tv_nsec : timestamp.tv_nsec / 1000);
+
+	bool result;
+	if (m_FileFormat == CaptureFilePcap)
+	{
+		uint32_t header[4] = { (uint32_t)timestamp.tv_sec, subSecondUnits, capLen, (uint32_t)rawPacket.getFrameLength() };
+		result = writeBytes(header, sizeof(header)) && writeBytes(rawPacket.getRawData(), capLen);
+	}
+	else
+	{
+		uint32_t paddedLen = (capLen + 3) & ~3;
+		uint64_t timestampUnits = (uint64_t)timestamp.tv_sec * m_TimestampUnitsPerSecond + subSecondUnits;
+		uint32_t blockLen = 32 + paddedLen;
+		uint32_t header[7] = { PCAPNG_ENHANCED_PACKET_BLOCK, blockLen, 0, (uint32_t)(timestampUnits >> 32), (uint32_t)timestampUnits, capLen,
+				(uint32_t)rawPacket.getFrameLength() };
+		uint32_t padding = 0;
+		result = writeBytes(header, sizeof(header)) && writeBytes(rawPacket.getRawData(), capLen) && writeBytes(&padding, paddedLen - capLen)
+				&& writeBytes(&blockLen, sizeof(blockLen));
+	}
+
+	if (!result)
+	{
+		m_NumOfPacketsNotWritten++;
+		return false;
+	}
+
+	m_NumOfPacketsWritten++;
+	return true;
+}
+
+bool AsyncPcapFileWriterDevice::writePackets(const RawPacketVector& packets)
+{
+	for (RawPacketVector::ConstVectorIterator iter = packets.begin(); iter != packets.end(); iter++)
+	{
+		if (!writePacket(**iter))
+			return false;
+	}
+
+	return true;
+}
+
+bool AsyncPcapFileWriterDevice::writeFileHeader()
+{
+	if (m_FileFormat == CaptureFilePcap)
+	{
+		uint32_t magic = PCAP_MAGIC_USEC;
+		uint16_t version[2] = { 2, 4 };
+		uint32_t header[4] = { 0, 0, PCPP_MAX_PACKET_SIZE, (uint32_t)m_LinkLayerType };
+		return writeBytes(&magic, sizeof(magic)) && writeBytes(version, sizeof(version)) && writeBytes(header, sizeof(header));
+	}
+
+	// section header block with an unspecified section length
+	uint32_t sectionHeader[7] = { PCAPNG_SECTION_HEADER_BLOCK, 28, PCAPNG_BYTE_ORDER_MAGIC, 1, 0xffffffff, 0xffffffff, 28 };
+	uint16_t version[2] = { 1, 0 };
+	memcpy(&sectionHeader[3], version, sizeof(version));
+
+	// interface description block with an if_tsresol option of nanoseconds
+	uint32_t interfaceHeader[8] = { PCAPNG_INTERFACE_DESCRIPTION_BLOCK, 32, 0, 0, 0, 0, 0, 32 };
+	uint16_t linkType[2] = { (uint16_t)m_LinkLayerType, 0 };
+	memcpy(&interfaceHeader[2], linkType, sizeof(linkType));
+	uint16_t tsresolOption[2] = { PCAPNG_OPTION_IF_TSRESOL, 1 };
+	memcpy(&interfaceHeader[4], tsresolOption, sizeof(tsresolOption));
+	interfaceHeader[5] = 9;
+
+	return writeBytes(sectionHeader, sizeof(sectionHeader)) && writeBytes(interfaceHeader, sizeof(interfaceHeader));
+}
+
+bool AsyncPcapFileWriterDevice::checkAppendedFile(uint64_t fileSize)
+{
+	if (m_FileFormat == CaptureFilePcap)
+	{
+		uint32_t header[6];
+		if (fileSize < sizeof(header) || m_IO->readSync(header, sizeof(header), 0) != (int)sizeof(header))
+		{
+			LOG_ERROR("File '%s' is not a valid pcap file", m_FileName);
+			return false;
+		}
+
+		if (header[0] != PCAP_MAGIC_USEC && header[0] != PCAP_MAGIC_NSEC)
+		{
+			LOG_ERROR("File '%s' is not a pcap file with the byte order of this machine", m_FileName);
+			return false;
+		}
+
+		if ((header[5] & 0xffff) != (uint32_t)m_LinkLayerType)
+		{
+			LOG_ERROR("Pcap file '%s' has a different link layer type than the one chosen in the c'tor, %d vs. %d", m_FileName, header[5] & 0xffff, m_LinkLayerType);
+			return false;
+		}
+
+		m_TimestampUnitsPerSecond = (header[0] == PCAP_MAGIC_NSEC ? 1000000000 : 1000000);
+		return true;
+	}
+
+	// read the section header block and the interface description block that must follow it
+	uint32_t sectionHeader[3];
+	if (m_IO->readSync(sectionHeader, sizeof(sectionHeader), 0) != (int)sizeof(sectionHeader) || sectionHeader[0] != PCAPNG_SECTION_HEADER_BLOCK
+			|| sectionHeader[2] != PCAPNG_BYTE_ORDER_MAGIC)
+	{
+		LOG_ERROR("File '%s' is not a pcap-ng file with the byte order of this machine", m_FileName);
+		return false;
+	}
+
+	uint8_t interfaceBlock[256];
+	int len = m_IO->readSync(interfaceBlock, sizeof(interfaceBlock), sectionHeader[1]);
+	uint32_t blockType, blockLen;
+	uint16_t linkType;
+	memcpy(&blockType, interfaceBlock, sizeof(blockType));
+	memcpy(&blockLen, interfaceBlock + 4, sizeof(blockLen));
+	memcpy(&linkType, interfaceBlock + 8, sizeof(linkType));
+	if (len < 20 || blockType != PCAPNG_INTERFACE_DESCRIPTION_BLOCK || blockLen < 20)
+	{
+		LOG_ERROR("Pcap-ng file '%s' doesn't start with an interface description block", m_FileName);
+		return false;
+	}
+
+	if (linkType != (uint16_t)m_LinkLayerType)
+	{
+		LOG_ERROR("Pcap-ng file '%s' has a different link layer type than the one chosen in the c'tor, %d vs. %d", m_FileName, linkType, m_LinkLayerType);
+		return false;
+	}
+
+	// packets are appended to interface #0 so they must be written in its timestamp resolution
+	m_TimestampUnitsPerSecond = 1000000;
+	uint32_t bodyEnd = std::min<uint32_t>(blockLen - 4, len);
+	for (uint32_t offset = 16; offset + 4 <= bodyEnd; )
+	{
+		uint16_t option[2];
+		memcpy(option, interfaceBlock + offset, sizeof(option));
+		if (option[0] == 0)
+			break;
+		if (option[0] == PCAPNG_OPTION_IF_TSRESOL && option[1] >= 1 && offset + 4 < bodyEnd)
+		{
+			uint8_t tsresol = interfaceBlock[offset + 4];
+			if (tsresol != 6 && tsresol != 9)
+			{
+				LOG_ERROR("Pcap-ng file '%s' has an unsupported timestamp resolution", m_FileName);
+				return false;
+			}
+			m_TimestampUnitsPerSecond = (tsresol == 9 ? 1000000000 : 1000000);
+		}
+		offset += 4 + ((option[1] + 3) & ~3);
+	}
+
+	return true;
+}
+
+bool AsyncPcapFileWriterDevice::open()
+{
+	return open(false);
+}
+
+bool AsyncPcapFileWriterDevice::open(bool appendMode)
+{
+	if (m_IO != NULL)
+	{
+		LOG_DEBUG("File '%s' already opened. Nothing to do", m_FileName);
+		return true;
+	}
+
+	m_NumOfPacketsNotWritten = 0;
+	m_NumOfPacketsWritten = 0;
+	m_WriteError = false;
+	m_CurChunk = 0;
+	m_CurChunkPos = 0;
+	m_TimestampUnitsPerSecond = (m_FileFormat == CaptureFilePcapNg ? 1000000000 : 1000000);
+
+	uint64_t fileSize = 0;
+	m_IO = new AsyncFileIO();
+	if (!m_IO->open(m_FileName, true, appendMode, m_Config, fileSize) || (appendMode && !checkAppendedFile(fileSize)))
+	{
+		delete m_IO;
+		m_IO = NULL;
+		return false;
+	}
+
+	m_FileOffset = (appendMode ? fileSize : 0);
+	if (!appendMode && !writeFileHeader())
+	{
+		delete m_IO;
+		m_IO = NULL;
+		return false;
+	}
+
+	m_DeviceOpened = true;
+	LOG_DEBUG("Async file writer device for file '%s' opened successfully", m_FileName);
+	return true;
+}
+
+bool AsyncPcapFileWriterDevice::flush()
+{
+	if (m_IO == NULL)
+		return false;
+
+	// the partially filled chunk is written but stays the current one: it's written again at the same offset once it's full. With O_DIRECT
+	// the write is padded to the alignment and the padding is truncated when the file is closed
+	if (m_CurChunkPos > 0)
+	{
+		uint32_t len = m_CurChunkPos;
+		if (m_IO->isDirectIO())
+			len = (len + ASYNC_FILE_ALIGNMENT - 1) / ASYNC_FILE_ALIGNMENT * ASYNC_FILE_ALIGNMENT;
+		m_IO->submitWrite(m_CurChunk, m_FileOffset, len);
+	}
+
+	if (!m_IO->waitForAll())
+	{
+		LOG_ERROR("Error writing to file '%s'", m_FileName);
+		m_WriteError = true;
+		return false;
+	}
+
+	return !m_WriteError;
+}
+
+void AsyncPcapFileWriterDevice::close()
+{
+	if (m_IO == NULL)
+		return;
+
+	flush();
+	// O_DIRECT padding and preallocated space beyond the written data are released
+	if ((m_IO->isDirectIO() || m_IO->isPreallocated()) && !m_IO->truncate(getBytesWritten()))
+		LOG_ERROR("Error truncating file '%s'", m_FileName);
+
+	delete m_IO;
+	m_IO = NULL;
+	m_DeviceOpened = false;
+	LOG_DEBUG("Async file writer closed for file '%s'", m_FileName);
+}
+
+bool AsyncPcapFileWriterDevice::preallocate(uint64_t size)
+{
+	if (m_IO == NULL)
+	{
+		LOG_ERROR("Device not opened");
+		return false;
+	}
+
+	return m_IO->preallocate(size);
+}
+
+void AsyncPcapFileWriterDevice::getStatistics(PcapStats& stats) const
+{
+	stats.packetsRecv = m_NumOfPacketsWritten;
+	stats.packetsDrop = m_NumOfPacketsNotWritten;
+	stats.packetsDropByInterface = 0;
+	LOG_DEBUG("Statistics received for async writer device for filename '%s'", m_FileName);
+}
+
+} // namespace pcpp
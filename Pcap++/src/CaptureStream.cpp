@@ -0,0 +1,1173 @@
+#define LOG_MODULE PcapLogModuleCaptureStream
+
+#include "CaptureStream.h"
+#include "PcapFileDevice.h"
+#include "PcapFilter.h"
+#include "Logger.h"
+#include "SystemUtils.h"
+#include "EndianPortable.h"
+#include <pthread.h>
+#include <string.h>
+#include <errno.h>
+#include <deque>
+#include <vector>
+#if defined(WIN32) || defined(WINx64) || defined(PCAPPP_MINGW_ENV)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#endif
+#ifdef USE_Z_STD
+#include <zstd.h>
+#endif
+
+namespace pcpp
+{
+
+#if defined(WIN32) || defined(WINx64) || defined(PCAPPP_MINGW_ENV)
+typedef SOCKET stream_socket_t;
+#define PCPP_INVALID_SOCKET INVALID_SOCKET
+#define closeStreamSocket closesocket
+#else
+typedef int stream_socket_t;
+#define PCPP_INVALID_SOCKET -1
+#define closeStreamSocket ::close
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+#define PCPP_CAPTURE_STREAM_MAGIC 0x50435354 // "PCST"
+#define PCPP_CAPTURE_STREAM_VERSION 1
+#define PCPP_CAPTURE_STREAM_FLAG_COMPRESSED 0x0001
+#define PCPP_CAPTURE_STREAM_MAX_MESSAGE_LEN (64*1024*1024)
+#define PCPP_CAPTURE_STREAM_HANDSHAKE_TIMEOUT_MSEC 5000
+#define PCPP_CAPTURE_STREAM_ACCEPT_POLL_MSEC 50
+#define PCPP_CAPTURE_STREAM_STOP_DRAIN_MSEC 1000
+#define PCPP_CAPTURE_STREAM_CAPTURE_POLL_MSEC 100
+
+enum CaptureStreamMessageType
+{
+	CaptureStreamHello = 1,
+	CaptureStreamHelloReply = 2,
+	CaptureStreamBatch = 3,
+	CaptureStreamCredit = 4,
+	CaptureStreamSetFilter = 5,
+	CaptureStreamEnd = 6
+};
+
+#pragma pack(push, 1)
+struct capture_stream_header
+{
+	uint32_t magic;
+	uint8_t version;
+	uint8_t type;
+	uint16_t flags;
+	uint32_t length;
+};
+
+struct capture_stream_hello
+{
+	uint32_t windowSize;
+};
+
+struct capture_stream_hello_reply
+{
+	uint16_t linkType;
+	uint16_t reserved;
+};
+
+struct capture_stream_batch_header
+{
+	uint32_t numOfPackets;
+	uint32_t uncompressedLength;
+	uint64_t packetsDropped;
+};
+
+struct capture_stream_packet_header
+{
+	uint64_t tsSec;
+	uint32_t tsNsec;
+	uint32_t captureLength;
+	uint32_t frameLength;
+};
+
+struct capture_stream_credit
+{
+	uint32_t numOfBatches;
+};
+#pragma pack(pop)
+
+
+// ~~~~~~~~~~~~~~
+// Socket helpers
+// ~~~~~~~~~~~~~~
+
+#if defined(WIN32) || defined(WINx64) || defined(PCAPPP_MINGW_ENV)
+static void initWinSock()
+{
+	static bool isInitialized = false;
+	if (isInitialized)
+		return;
+
+	WSADATA wsaData;
+	int res = WSAStartup(MAKEWORD(2,2), &wsaData);
+	if (res != 0)
+		LOG_ERROR("WSAStartup failed with error code: %d", res);
+	else
+		isInitialized = true;
+}
+#endif
+
+static uint64_t getMonotonicTimeMsec()
+{
+	long sec = 0, nsec = 0;
+	clockGetTime(sec, nsec);
+	return (uint64_t)sec * 1000 + (uint64_t)nsec / 1000000;
+}
+
+static bool sendAll(stream_socket_t fd, const uint8_t* data, size_t dataLen)
+{
+	while (dataLen > 0)
+	{
+		int res = send(fd, (const char*)data, (int)dataLen, MSG_NOSIGNAL);
+		if (res <= 0)
+		{
+			if (res < 0 && errno == EINTR)
+				continue;
+			return false;
+		}
+
+		data += res;
+		dataLen -= res;
+	}
+
+	return true;
+}
+
+static bool recvAll(stream_socket_t fd, uint8_t* data, size_t dataLen)
+{
+	while (dataLen > 0)
+	{
+		int res = recv(fd, (char*)data, (int)dataLen, 0);
+		if (res <= 0)
+		{
+			if (res < 0 && errno == EINTR)
+				continue;
+			return false;
+		}
+
+		data += res;
+		dataLen -= res;
+	}
+
+	return true;
+}
+
+// returns 1 if the socket is readable, 0 on timeout and -1 on error. A negative timeout means waiting forever
+static int waitForReadable(stream_socket_t fd, int timeoutMsec)
+{
+	fd_set readSet;
+	FD_ZERO(&readSet);
+	FD_SET(fd, &readSet);
+
+	timeval timeout;
+	timeout.tv_sec = timeoutMsec / 1000;
+	timeout.tv_usec = (timeoutMsec % 1000) * 1000;
+
+	int res = select((int)fd + 1, &readSet, NULL, NULL, (timeoutMsec < 0 ? NULL : &timeout));
+	if (res < 0 && errno == EINTR)
+		return 0;
+
+	return (res < 0 ? -1 : (res > 0 ? 1 : 0));
+}
+
+static bool sendMessage(stream_socket_t fd, uint8_t type, uint16_t flags, const uint8_t* payload, uint32_t payloadLen)
+{
+	capture_stream_header header;
+	header.magic = htobe32(PCPP_CAPTURE_STREAM_MAGIC);
+	header.version = PCPP_CAPTURE_STREAM_VERSION;
+	header.type = type;
+	header.flags = htobe16(flags);
+	header.length = htobe32(payloadLen);
+
+	if (!sendAll(fd, (const uint8_t*)&header, sizeof(header)))
+		return false;
+
+	return (payloadLen == 0 || sendAll(fd, payload, payloadLen));
+}
+
+// reads a whole message. The payload is written to the buffer which is resized as needed
+static bool recvMessage(stream_socket_t fd, uint8_t& type, uint16_t& flags, std::vector<uint8_t>& payload)
+{
+	capture_stream_header header;
+	if (!recvAll(fd, (uint8_t*)&header, sizeof(header)))
+		return false;
+
+	if (be32toh(header.magic) != PCPP_CAPTURE_STREAM_MAGIC || header.version != PCPP_CAPTURE_STREAM_VERSION)
+	{
+		LOG_ERROR("Received a message with unknown magic or version");
+		return false;
+	}
+
+	uint32_t length = be32toh(header.length);
+	if (length > PCPP_CAPTURE_STREAM_MAX_MESSAGE_LEN)
+	{
+		LOG_ERROR("Received a message which is too long: %u bytes", length);
+		return false;
+	}
+
+	type = header.type;
+	flags = be16toh(header.flags);
+	payload.resize(length);
+	return (length == 0 || recvAll(fd, &payload[0], length));
+}
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// CaptureStreamServer methods
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+struct StreamBatch
+{
+	std::vector<uint8_t> data;
+	uint32_t numOfPackets;
+
+	StreamBatch() : numOfPackets(0) {}
+};
+
+struct CaptureStreamServerData
+{
+	pthread_t workerThread;
+	pthread_mutex_t mutex;
+	pthread_cond_t queueCond;
+	stream_socket_t listenSocket;
+	stream_socket_t clientSocket;
+	bool running;
+	bool stopRequested;
+
+	// the batch currently being filled, batches waiting for the client and batches to reuse. All protected by mutex
+	StreamBatch* curBatch;
+	uint64_t curBatchStartTime;
+	std::deque<StreamBatch*> queue;
+	std::vector<StreamBatch*> freeBatches;
+
+	// client session state
+	uint32_t credits;
+	bool compression;
+	BpfFilterWrapper filter;
+	bool hasFilter;
+
+	CaptureStreamServer::Stats stats;
+	std::vector<uint8_t> recvBuffer;
+	std::vector<uint8_t> compressBuffer;
+#ifdef USE_Z_STD
+	ZSTD_CCtx* compressContext;
+#endif
+
+	CaptureStreamServerData() : listenSocket(PCPP_INVALID_SOCKET), clientSocket(PCPP_INVALID_SOCKET), running(false), stopRequested(false),
+		curBatch(NULL), curBatchStartTime(0), credits(0), compression(false), hasFilter(false)
+	{
+		memset(&stats, 0, sizeof(stats));
+		pthread_mutex_init(&mutex, NULL);
+		pthread_cond_init(&queueCond, NULL);
+#ifdef USE_Z_STD
+		compressContext = NULL;
+#endif
+	}
+
+	~CaptureStreamServerData()
+	{
+		delete curBatch;
+		for (std::deque<StreamBatch*>::iterator iter = queue.begin(); iter != queue.end(); iter++)
+			delete *iter;
+		for (std::vector<StreamBatch*>::iterator iter = freeBatches.begin(); iter != freeBatches.end(); iter++)
+			delete *iter;
+#ifdef USE_Z_STD
+		if (compressContext != NULL)
+			ZSTD_freeCCtx(compressContext);
+#endif
+		pthread_mutex_destroy(&mutex);
+		pthread_cond_destroy(&queueCond);
+	}
+
+	// should be called with the mutex locked
+	void closeCurrentBatch()
+	{
+		if (curBatch == NULL)
+			return;
+
+		if (curBatch->numOfPackets == 0)
+			return;
+
+		queue.push_back(curBatch);
+		curBatch = NULL;
+	}
+
+	// should be called with the mutex locked
+	void recycleBatch(StreamBatch* batch)
+	{
+		batch->data.clear();
+		batch->numOfPackets = 0;
+		freeBatches.push_back(batch);
+	}
+
+	void dropClient()
+	{
+		if (clientSocket != PCPP_INVALID_SOCKET)
+			closeStreamSocket(clientSocket);
+
+		pthread_mutex_lock(&mutex);
+		clientSocket = PCPP_INVALID_SOCKET;
+		credits = 0;
+		hasFilter = false;
+		filter.setFilter("");
+		pthread_mutex_unlock(&mutex);
+	}
+};
+
+CaptureStreamServer::CaptureStreamServer(const IPv4Address& listenAddress, uint16_t port, LinkLayerType linkType, const Config& config) :
+	m_ListenAddress(listenAddress), m_Port(port), m_LinkType(linkType), m_Config(config), m_Data(NULL)
+{
+#if defined(WIN32) || defined(WINx64) || defined(PCAPPP_MINGW_ENV)
+	initWinSock();
+#endif
+	if (m_Config.maxBatchPackets == 0)
+		m_Config.maxBatchPackets = 1;
+	if (m_Config.maxQueuedBatches == 0)
+		m_Config.maxQueuedBatches = 1;
+}
+
+CaptureStreamServer::~CaptureStreamServer()
+{
+	stop();
+}
+
+bool CaptureStreamServer::start()
+{
+	if (m_Data != NULL)
+	{
+		LOG_ERROR("Capture stream server is already running");
+		return false;
+	}
+
+	stream_socket_t listenSocket = socket(AF_INET, SOCK_STREAM, 0);
+	if (listenSocket == PCPP_INVALID_SOCKET)
+	{
+		LOG_ERROR("Cannot create listening socket: %s", strerror(errno));
+		return false;
+	}
+
+	int reuse = 1;
+	setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+
+	sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htobe16(m_Port);
+	addr.sin_addr.s_addr = m_ListenAddress.toInt();
+	if (bind(listenSocket, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(listenSocket, 1) != 0)
+	{
+		LOG_ERROR("Cannot listen on %s:%d: %s", m_ListenAddress.toString().c_str(), m_Port, strerror(errno));
+		closeStreamSocket(listenSocket);
+		return false;
+	}
+
+	socklen_t addrLen = sizeof(addr);
+	if (getsockname(listenSocket, (sockaddr*)&addr, &addrLen) == 0)
+		m_Port = be16toh(addr.sin_port);
+
+	m_Data = new CaptureStreamServerData();
+	m_Data->listenSocket = listenSocket;
+	m_Data->running = true;
+#ifdef USE_Z_STD
+	m_Data->compressContext = ZSTD_createCCtx();
+#endif
+
+	int err = pthread_create(&m_Data->workerThread, NULL, workerThreadMain, (void*)this);
+	if (err != 0)
+	{
+		LOG_ERROR("Cannot create capture stream server thread: [%s]", strerror(err));
+		closeStreamSocket(listenSocket);
+		delete m_Data;
+		m_Data = NULL;
+		return false;
+	}
+
+	LOG_DEBUG("Capture stream server listening on %s:%d", m_ListenAddress.toString().c_str(), m_Port);
+	return true;
+}
+
+void CaptureStreamServer::stop()
+{
+	if (m_Data == NULL)
+		return;
+
+	pthread_mutex_lock(&m_Data->mutex);
+	m_Data->stopRequested = true;
+	m_Data->running = false;
+	pthread_cond_broadcast(&m_Data->queueCond);
+	pthread_mutex_unlock(&m_Data->mutex);
+
+	pthread_join(m_Data->workerThread, NULL);
+
+	closeStreamSocket(m_Data->listenSocket);
+	delete m_Data;
+	m_Data = NULL;
+	LOG_DEBUG("Capture stream server stopped");
+}
+
+bool CaptureStreamServer::isRunning() const
+{
+	return m_Data != NULL;
+}
+
+bool CaptureStreamServer::isClientConnected() const
+{
+	if (m_Data == NULL)
+		return false;
+
+	pthread_mutex_lock(&m_Data->mutex);
+	bool res = (m_Data->clientSocket != PCPP_INVALID_SOCKET);
+	pthread_mutex_unlock(&m_Data->mutex);
+	return res;
+}
+
+bool CaptureStreamServer::addPacket(const RawPacket& rawPacket, bool block)
+{
+	if (m_Data == NULL)
+		return false;
+
+	CaptureStreamServerData* data = m_Data;
+	size_t captureLen = (size_t)rawPacket.getRawDataLen();
+	size_t recordLen = sizeof(capture_stream_packet_header) + captureLen;
+
+	pthread_mutex_lock(&data->mutex);
+
+	if (!data->running)
+	{
+		pthread_mutex_unlock(&data->mutex);
+		return false;
+	}
+
+	if (data->hasFilter && !data->filter.matchPacketWithFilter(&rawPacket))
+	{
+		data->stats.packetsFiltered++;
+		pthread_mutex_unlock(&data->mutex);
+		return true;
+	}
+
+	if (data->curBatch != NULL && data->curBatch->numOfPackets > 0 && data->curBatch->data.size() + recordLen > m_Config.maxBatchBytes)
+		data->closeCurrentBatch();
+
+	if (data->curBatch == NULL)
+	{
+		while (data->queue.size() >= m_Config.maxQueuedBatches)
+		{
+			if (!block || !data->running)
+			{
+				data->stats.packetsDropped++;
+				pthread_mutex_unlock(&data->mutex);
+				return false;
+			}
+
+			pthread_cond_wait(&data->queueCond, &data->mutex);
+		}
+
+		if (data->freeBatches.empty())
+			data->curBatch = new StreamBatch();
+		else
+		{
+			data->curBatch = data->freeBatches.back();
+			data->freeBatches.pop_back();
+		}
+
+		data->curBatchStartTime = getMonotonicTimeMsec();
+	}
+
+	timespec ts = rawPacket.getPacketTimeStamp();
+	capture_stream_packet_header pktHeader;
+	pktHeader.tsSec = htobe64((uint64_t)ts.tv_sec);
+	pktHeader.tsNsec = htobe32((uint32_t)ts.tv_nsec);
+	pktHeader.captureLength = htobe32((uint32_t)captureLen);
+	pktHeader.frameLength = htobe32((uint32_t)rawPacket.getFrameLength());
+
+	std::vector<uint8_t>& batchData = data->curBatch->data;
+	size_t offset = batchData.size();
+	batchData.resize(offset + recordLen);
+	memcpy(&batchData[offset], &pktHeader, sizeof(pktHeader));
+	if (captureLen > 0)
+		memcpy(&batchData[offset + sizeof(pktHeader)], rawPacket.getRawData(), captureLen);
+	data->curBatch->numOfPackets++;
+
+	if (data->curBatch->numOfPackets >= m_Config.maxBatchPackets)
+		data->closeCurrentBatch();
+
+	pthread_mutex_unlock(&data->mutex);
+	return true;
+}
+
+bool CaptureStreamServer::sendPacket(const RawPacket& rawPacket)
+{
+	return addPacket(rawPacket, m_Config.blockWhenQueueFull);
+}
+
+int CaptureStreamServer::sendPackets(const RawPacketVector& packets)
+{
+	int count = 0;
+	for (RawPacketVector::ConstVectorIterator iter = packets.begin(); iter != packets.end(); iter++)
+	{
+		if (addPacket(**iter, m_Config.blockWhenQueueFull))
+			count++;
+	}
+
+	return count;
+}
+
+void CaptureStreamServer::flush()
+{
+	if (m_Data == NULL)
+		return;
+
+	pthread_mutex_lock(&m_Data->mutex);
+	m_Data->closeCurrentBatch();
+	pthread_mutex_unlock(&m_Data->mutex);
+}
+
+int CaptureStreamServer::streamFile(IFileReaderDevice& reader)
+{
+	if (m_Data == NULL)
+	{
+		LOG_ERROR("Capture stream server isn't running");
+		return -1;
+	}
+
+	int count = 0;
+	RawPacket rawPacket;
+	while (reader.getNextPacket(rawPacket))
+	{
+		if (!addPacket(rawPacket, true))
+			break;
+		count++;
+	}
+
+	flush();
+	return count;
+}
+
+void CaptureStreamServer::onPacketArrives(RawPacket* packet, PcapLiveDevice* device, void* userCookie)
+{
+	CaptureStreamServer* server = (CaptureStreamServer*)userCookie;
+	if (server != NULL && packet != NULL)
+		server->sendPacket(*packet);
+}
+
+void CaptureStreamServer::getStats(Stats& stats) const
+{
+	if (m_Data == NULL)
+	{
+		memset(&stats, 0, sizeof(stats));
+		return;
+	}
+
+	pthread_mutex_lock(&m_Data->mutex);
+	stats = m_Data->stats;
+	pthread_mutex_unlock(&m_Data->mutex);
+}
+
+static bool serverHandshake(CaptureStreamServerData* data, stream_socket_t clientSocket, LinkLayerType linkType)
+{
+	if (waitForReadable(clientSocket, PCPP_CAPTURE_STREAM_HANDSHAKE_TIMEOUT_MSEC) <= 0)
+	{
+		LOG_ERROR("Capture stream client didn't send a hello message");
+		return false;
+	}
+
+	uint8_t type;
+	uint16_t flags;
+	if (!recvMessage(clientSocket, type, flags, data->recvBuffer) || type != CaptureStreamHello || data->recvBuffer.size() < sizeof(capture_stream_hello))
+	{
+		LOG_ERROR("Capture stream client sent an invalid hello message");
+		return false;
+	}
+
+	capture_stream_hello* hello = (capture_stream_hello*)&data->recvBuffer[0];
+	uint32_t windowSize = be32toh(hello->windowSize);
+	bool compression = false;
+#ifdef USE_Z_STD
+	compression = ((flags & PCPP_CAPTURE_STREAM_FLAG_COMPRESSED) != 0 && data->compressContext != NULL);
+#endif
+
+	capture_stream_hello_reply reply;
+	reply.linkType = htobe16((uint16_t)linkType);
+	reply.reserved = 0;
+	if (!sendMessage(clientSocket, CaptureStreamHelloReply, (compression ? PCPP_CAPTURE_STREAM_FLAG_COMPRESSED : 0), (const uint8_t*)&reply, sizeof(reply)))
+		return false;
+
+	int noDelay = 1;
+	setsockopt(clientSocket, IPPROTO_TCP, TCP_NODELAY, (const char*)&noDelay, sizeof(noDelay));
+
+	pthread_mutex_lock(&data->mutex);
+	data->clientSocket = clientSocket;
+	data->credits = windowSize;
+	data->compression = compression;
+	data->stats.numOfClients++;
+	pthread_mutex_unlock(&data->mutex);
+
+	LOG_DEBUG("Capture stream client connected, window size is %u, compression is %s", windowSize, (compression ? "on" : "off"));
+	return true;
+}
+
+static bool sendBatch(CaptureStreamServerData* data, StreamBatch* batch, uint64_t packetsDropped, int compressionLevel)
+{
+	const uint8_t* payload = (batch->data.empty() ? NULL : &batch->data[0]);
+	size_t payloadLen = batch->data.size();
+	uint16_t flags = 0;
+
+#ifdef USE_Z_STD
+	if (data->compression && payloadLen > 0)
+	{
+		size_t bound = ZSTD_compressBound(payloadLen);
+		if (data->compressBuffer.size() < bound)
+			data->compressBuffer.resize(bound);
+
+		size_t compressedLen = ZSTD_compressCCtx(data->compressContext, &data->compressBuffer[0], bound, payload, payloadLen, compressionLevel);
+		if (!ZSTD_isError(compressedLen) && compressedLen < payloadLen)
+		{
+			payload = &data->compressBuffer[0];
+			payloadLen = compressedLen;
+			flags = PCPP_CAPTURE_STREAM_FLAG_COMPRESSED;
+		}
+	}
+#else
+	(void)compressionLevel;
+#endif
+
+	capture_stream_batch_header batchHeader;
+	batchHeader.numOfPackets = htobe32(batch->numOfPackets);
+	batchHeader.uncompressedLength = htobe32((uint32_t)batch->data.size());
+	batchHeader.packetsDropped = htobe64(packetsDropped);
+
+	capture_stream_header header;
+	header.magic = htobe32(PCPP_CAPTURE_STREAM_MAGIC);
+	header.version = PCPP_CAPTURE_STREAM_VERSION;
+	header.type = CaptureStreamBatch;
+	header.flags = htobe16(flags);
+	header.length = htobe32((uint32_t)(sizeof(batchHeader) + payloadLen));
+
+	uint8_t headers[sizeof(header) + sizeof(batchHeader)];
+	memcpy(headers, &header, sizeof(header));
+	memcpy(headers + sizeof(header), &batchHeader, sizeof(batchHeader));
+
+	if (!sendAll(data->clientSocket, headers, sizeof(headers)) || (payloadLen > 0 && !sendAll(data->clientSocket, payload, payloadLen)))
+		return false;
+
+	pthread_mutex_lock(&data->mutex);
+	data->stats.packetsSent += batch->numOfPackets;
+	data->stats.batchesSent++;
+	data->stats.bytesSent += sizeof(headers) + payloadLen;
+	data->stats.uncompressedBytes += batch->data.size();
+	pthread_mutex_unlock(&data->mutex);
+	return true;
+}
+
+// handle a single message from the client. Returns false if the client disconnected or sent an invalid message
+static bool handleClientMessage(CaptureStreamServerData* data, LinkLayerType linkType)
+{
+	uint8_t type;
+	uint16_t flags;
+	if (!recvMessage(data->clientSocket, type, flags, data->recvBuffer))
+		return false;
+
+	switch (type)
+	{
+	case CaptureStreamCredit:
+	{
+		if (data->recvBuffer.size() < sizeof(capture_stream_credit))
+			return false;
+		capture_stream_credit* credit = (capture_stream_credit*)&data->recvBuffer[0];
+		pthread_mutex_lock(&data->mutex);
+		data->credits += be32toh(credit->numOfBatches);
+		pthread_mutex_unlock(&data->mutex);
+		return true;
+	}
+	case CaptureStreamSetFilter:
+	{
+		std::string filterStr(data->recvBuffer.begin(), data->recvBuffer.end());
+		pthread_mutex_lock(&data->mutex);
+		bool res = data->filter.setFilter(filterStr, linkType);
+		data->hasFilter = (res && !filterStr.empty());
+		pthread_mutex_unlock(&data->mutex);
+		if (!res)
+			LOG_ERROR("Capture stream client sent an invalid filter: '%s'", filterStr.c_str());
+		else
+			LOG_DEBUG("Capture stream filter set to '%s'", filterStr.c_str());
+		return true;
+	}
+	case CaptureStreamEnd:
+		return false;
+	default:
+		LOG_DEBUG("Ignoring capture stream message of type %d", (int)type);
+		return true;
+	}
+}
+
+void* CaptureStreamServer::workerThreadMain(void* ptr)
+{
+	CaptureStreamServer* server = (CaptureStreamServer*)ptr;
+	CaptureStreamServerData* data = server->m_Data;
+	uint64_t stopDeadline = 0;
+
+	while (true)
+	{
+		pthread_mutex_lock(&data->mutex);
+		bool stopRequested = data->stopRequested;
+		pthread_mutex_unlock(&data->mutex);
+
+		if (data->clientSocket == PCPP_INVALID_SOCKET)
+		{
+			if (stopRequested)
+				break;
+
+			if (waitForReadable(data->listenSocket, PCPP_CAPTURE_STREAM_ACCEPT_POLL_MSEC) <= 0)
+				continue;
+
+			stream_socket_t clientSocket = accept(data->listenSocket, NULL, NULL);
+			if (clientSocket == PCPP_INVALID_SOCKET)
+				continue;
+
+			if (!serverHandshake(data, clientSocket, server->m_LinkType))
+				closeStreamSocket(clientSocket);
+
+			continue;
+		}
+
+		if (stopRequested && stopDeadline == 0)
+			stopDeadline = getMonotonicTimeMsec() + PCPP_CAPTURE_STREAM_STOP_DRAIN_MSEC;
+
+		// wait for flow control messages from the client. This wait also sets the pace for closing partial batches
+		int waitRes = waitForReadable(data->clientSocket, (int)server->m_Config.batchTimeoutMsec);
+		if (waitRes < 0 || (waitRes > 0 && !handleClientMessage(data, server->m_LinkType)))
+		{
+			LOG_DEBUG("Capture stream client disconnected");
+			data->dropClient();
+			continue;
+		}
+
+		pthread_mutex_lock(&data->mutex);
+
+		if (data->curBatch != NULL && (stopRequested || getMonotonicTimeMsec() - data->curBatchStartTime >= server->m_Config.batchTimeoutMsec))
+			data->closeCurrentBatch();
+
+		bool sendFailed = false;
+		while (data->credits > 0 && !data->queue.empty())
+		{
+			StreamBatch* batch = data->queue.front();
+			data->queue.pop_front();
+			data->credits--;
+			uint64_t packetsDropped = data->stats.packetsDropped;
+			pthread_cond_broadcast(&data->queueCond);
+			pthread_mutex_unlock(&data->mutex);
+
+			sendFailed = !sendBatch(data, batch, packetsDropped, server->m_Config.compressionLevel);
+
+			pthread_mutex_lock(&data->mutex);
+			data->recycleBatch(batch);
+			if (sendFailed)
+				break;
+		}
+
+		bool drained = data->queue.empty();
+		pthread_mutex_unlock(&data->mutex);
+
+		if (sendFailed)
+		{
+			LOG_DEBUG("Failed to send a batch, dropping capture stream client");
+			data->dropClient();
+			continue;
+		}
+
+		if (stopRequested && (drained || getMonotonicTimeMsec() >= stopDeadline))
+		{
+			sendMessage(data->clientSocket, CaptureStreamEnd, 0, NULL, 0);
+			data->dropClient();
+			break;
+		}
+	}
+
+	return NULL;
+}
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// CaptureStreamClientDevice methods
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+struct CaptureStreamClientData
+{
+	stream_socket_t socket;
+	pthread_t captureThread;
+	pthread_mutex_t sendMutex;
+	bool captureThreadStarted;
+	volatile bool stopCapture;
+	volatile bool streamEnded;
+	OnCaptureStreamBatchArrives onBatchArrives;
+	void* onBatchArrivesUserCookie;
+	std::vector<uint8_t> recvBuffer;
+	std::vector<uint8_t> decompressBuffer;
+
+	CaptureStreamClientData() : socket(PCPP_INVALID_SOCKET), captureThreadStarted(false), stopCapture(false), streamEnded(false),
+		onBatchArrives(NULL), onBatchArrivesUserCookie(NULL)
+	{
+		pthread_mutex_init(&sendMutex, NULL);
+	}
+
+	~CaptureStreamClientData()
+	{
+		pthread_mutex_destroy(&sendMutex);
+	}
+
+	bool send(uint8_t type, const uint8_t* payload, uint32_t payloadLen)
+	{
+		pthread_mutex_lock(&sendMutex);
+		bool res = sendMessage(socket, type, 0, payload, payloadLen);
+		pthread_mutex_unlock(&sendMutex);
+		return res;
+	}
+};
+
+CaptureStreamClientDevice::CaptureStreamClientDevice(const IPv4Address& serverAddress, uint16_t port, bool useCompression, uint32_t windowSize) :
+	IPcapDevice(), m_ServerAddress(serverAddress), m_Port(port), m_UseCompression(useCompression), m_CompressionEnabled(false),
+	m_WindowSize(windowSize == 0 ? 1 : windowSize), m_LinkType(LINKTYPE_ETHERNET), m_PacketsReceived(0), m_PacketsDroppedByServer(0), m_Data(NULL)
+{
+#if defined(WIN32) || defined(WINx64) || defined(PCAPPP_MINGW_ENV)
+	initWinSock();
+#endif
+}
+
+CaptureStreamClientDevice::~CaptureStreamClientDevice()
+{
+	close();
+}
+
+bool CaptureStreamClientDevice::open()
+{
+	if (m_DeviceOpened)
+	{
+		LOG_ERROR("Device is already opened");
+		return false;
+	}
+
+	stream_socket_t fd = socket(AF_INET, SOCK_STREAM, 0);
+	if (fd == PCPP_INVALID_SOCKET)
+	{
+		LOG_ERROR("Cannot create socket: %s", strerror(errno));
+		return false;
+	}
+
+	sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htobe16(m_Port);
+	addr.sin_addr.s_addr = m_ServerAddress.toInt();
+	if (connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0)
+	{
+		LOG_ERROR("Cannot connect to capture stream server %s:%d: %s", m_ServerAddress.toString().c_str(), m_Port, strerror(errno));
+		closeStreamSocket(fd);
+		return false;
+	}
+
+	int noDelay = 1;
+	setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, (const char*)&noDelay, sizeof(noDelay));
+
+	uint16_t helloFlags = 0;
+#ifdef USE_Z_STD
+	if (m_UseCompression)
+		helloFlags = PCPP_CAPTURE_STREAM_FLAG_COMPRESSED;
+#else
+	if (m_UseCompression)
+		LOG_DEBUG("PcapPlusPlus was built without zstd, requesting an uncompressed stream");
+#endif
+
+	capture_stream_hello hello;
+	hello.windowSize = htobe32(m_WindowSize);
+	std::vector<uint8_t> reply;
+	uint8_t type = 0;
+	uint16_t flags = 0;
+	if (!sendMessage(fd, CaptureStreamHello, helloFlags, (const uint8_t*)&hello, sizeof(hello)) ||
+			waitForReadable(fd, PCPP_CAPTURE_STREAM_HANDSHAKE_TIMEOUT_MSEC) <= 0 ||
+			!recvMessage(fd, type, flags, reply) || type != CaptureStreamHelloReply || reply.size() < sizeof(capture_stream_hello_reply))
+	{
+		LOG_ERROR("Capture stream handshake with server %s:%d failed", m_ServerAddress.toString().c_str(), m_Port);
+		closeStreamSocket(fd);
+		return false;
+	}
+
+	m_LinkType = (LinkLayerType)be16toh(((capture_stream_hello_reply*)&reply[0])->linkType);
+	m_CompressionEnabled = ((flags & PCPP_CAPTURE_STREAM_FLAG_COMPRESSED) != 0);
+	m_PacketsReceived = 0;
+	m_PacketsDroppedByServer = 0;
+
+	m_Data = new CaptureStreamClientData();
+	m_Data->socket = fd;
+	m_DeviceOpened = true;
+
+	LOG_DEBUG("Connected to capture stream server %s:%d", m_ServerAddress.toString().c_str(), m_Port);
+	return true;
+}
+
+void CaptureStreamClientDevice::close()
+{
+	if (m_Data == NULL)
+		return;
+
+	stopCapture();
+
+	if (!m_Data->streamEnded)
+		m_Data->send(CaptureStreamEnd, NULL, 0);
+
+	closeStreamSocket(m_Data->socket);
+	delete m_Data;
+	m_Data = NULL;
+	m_DeviceOpened = false;
+	LOG_DEBUG("Disconnected from capture stream server %s:%d", m_ServerAddress.toString().c_str(), m_Port);
+}
+
+int CaptureStreamClientDevice::getNextBatch(RawPacketVector& packets, int timeoutMsec)
+{
+	if (m_Data == NULL)
+	{
+		LOG_ERROR("Device not opened");
+		return -1;
+	}
+
+	if (m_Data->streamEnded)
+		return -1;
+
+	uint8_t type = 0;
+	uint16_t flags = 0;
+	std::vector<uint8_t>& buffer = m_Data->recvBuffer;
+
+	while (type != CaptureStreamBatch)
+	{
+		int waitRes = waitForReadable(m_Data->socket, timeoutMsec);
+		if (waitRes == 0)
+			return 0;
+
+		if (waitRes < 0 || !recvMessage(m_Data->socket, type, flags, buffer))
+		{
+			LOG_ERROR("Connection to capture stream server was lost");
+			m_Data->streamEnded = true;
+			return -1;
+		}
+
+		if (type == CaptureStreamEnd)
+		{
+			LOG_DEBUG("Capture stream server ended the stream");
+			m_Data->streamEnded = true;
+			return -1;
+		}
+	}
+
+	if (buffer.size() < sizeof(capture_stream_batch_header))
+	{
+		LOG_ERROR("Received a malformed batch");
+		return -1;
+	}
+
+	capture_stream_batch_header* batchHeader = (capture_stream_batch_header*)&buffer[0];
+	uint32_t numOfPackets = be32toh(batchHeader->numOfPackets);
+	m_PacketsDroppedByServer = be64toh(batchHeader->packetsDropped);
+
+	const uint8_t* records = &buffer[0] + sizeof(capture_stream_batch_header);
+	size_t recordsLen = buffer.size() - sizeof(capture_stream_batch_header);
+
+	if (flags & PCPP_CAPTURE_STREAM_FLAG_COMPRESSED)
+	{
+#ifdef USE_Z_STD
+		// the uncompressed length comes from the peer so it's limited like the length of any other message
+		size_t uncompressedLen = be32toh(batchHeader->uncompressedLength);
+		if (uncompressedLen == 0 || uncompressedLen > PCPP_CAPTURE_STREAM_MAX_MESSAGE_LEN)
+		{
+			LOG_ERROR("Received a batch with an invalid uncompressed length of %d bytes", (int)uncompressedLen);
+			return -1;
+		}
+
+		if (m_Data->decompressBuffer.size() < uncompressedLen)
+			m_Data->decompressBuffer.resize(uncompressedLen);
+
+		size_t res = ZSTD_decompress(&m_Data->decompressBuffer[0], uncompressedLen, records, recordsLen);
+		if (ZSTD_isError(res) || res != uncompressedLen)
+		{
+			LOG_ERROR("Failed to decompress a batch");
+			return -1;
+		}
+
+		records = &m_Data->decompressBuffer[0];
+		recordsLen = uncompressedLen;
+#else
+		LOG_ERROR("Received a compressed batch but PcapPlusPlus was built without zstd");
+		return -1;
+#endif
+	}
+
+	uint32_t numOfParsedPackets = 0;
+	while (numOfParsedPackets < numOfPackets && recordsLen >= sizeof(capture_stream_packet_header))
+	{
+		const capture_stream_packet_header* pktHeader = (const capture_stream_packet_header*)records;
+		uint32_t captureLen = be32toh(pktHeader->captureLength);
+		if (recordsLen - sizeof(capture_stream_packet_header) < captureLen)
+			break;
+
+		timespec ts;
+		ts.tv_sec = (time_t)be64toh(pktHeader->tsSec);
+		ts.tv_nsec = (long)be32toh(pktHeader->tsNsec);
+
+		uint8_t* packetData = new uint8_t[captureLen];
+		memcpy(packetData, records + sizeof(capture_stream_packet_header), captureLen);
+		RawPacket* rawPacket = new RawPacket();
+		rawPacket->setRawData(packetData, (int)captureLen, ts, m_LinkType, (int)be32toh(pktHeader->frameLength));
+		packets.pushBack(rawPacket);
+
+		records += sizeof(capture_stream_packet_header) + captureLen;
+		recordsLen -= sizeof(capture_stream_packet_header) + captureLen;
+		numOfParsedPackets++;
+	}
+
+	if (numOfParsedPackets != numOfPackets)
+		LOG_ERROR("Received a malformed batch: expected %u packets but parsed only %u", numOfPackets, numOfParsedPackets);
+
+	m_PacketsReceived += numOfParsedPackets;
+
+	// the batch is consumed, let the server send another one
+	capture_stream_credit credit;
+	credit.numOfBatches = htobe32(1);
+	m_Data->send(CaptureStreamCredit, (const uint8_t*)&credit, sizeof(credit));
+
+	return (int)numOfParsedPackets;
+}
+
+void* CaptureStreamClientDevice::captureThreadMain(void* ptr)
+{
+	CaptureStreamClientDevice* device = (CaptureStreamClientDevice*)ptr;
+	CaptureStreamClientData* data = device->m_Data;
+
+	while (!data->stopCapture)
+	{
+		RawPacketVector packets;
+		int res = device->getNextBatch(packets, PCPP_CAPTURE_STREAM_CAPTURE_POLL_MSEC);
+		if (res < 0)
+			break;
+
+		if (res > 0)
+			data->onBatchArrives(packets, device, data->onBatchArrivesUserCookie);
+	}
+
+	return NULL;
+}
+
+bool CaptureStreamClientDevice::startCapture(OnCaptureStreamBatchArrives onBatchArrives, void* userCookie)
+{
+	if (m_Data == NULL)
+	{
+		LOG_ERROR("Device not opened");
+		return false;
+	}
+
+	if (m_Data->captureThreadStarted)
+	{
+		LOG_ERROR("Capture is already running");
+		return false;
+	}
+
+	if (onBatchArrives == NULL)
+	{
+		LOG_ERROR("Callback is NULL");
+		return false;
+	}
+
+	m_Data->onBatchArrives = onBatchArrives;
+	m_Data->onBatchArrivesUserCookie = userCookie;
+	m_Data->stopCapture = false;
+
+	int err = pthread_create(&m_Data->captureThread, NULL, captureThreadMain, (void*)this);
+	if (err != 0)
+	{
+		LOG_ERROR("Cannot create capture stream client thread: [%s]", strerror(err));
+		return false;
+	}
+
+	m_Data->captureThreadStarted = true;
+	return true;
+}
+
+void CaptureStreamClientDevice::stopCapture()
+{
+	if (m_Data == NULL || !m_Data->captureThreadStarted)
+		return;
+
+	m_Data->stopCapture = true;
+	pthread_join(m_Data->captureThread, NULL);
+	m_Data->captureThreadStarted = false;
+}
+
+bool CaptureStreamClientDevice::captureActive() const
+{
+	return (m_Data != NULL && m_Data->captureThreadStarted);
+}
+
+bool CaptureStreamClientDevice::isStreamEnded() const
+{
+	return (m_Data == NULL || m_Data->streamEnded);
+}
+
+void CaptureStreamClientDevice::getStatistics(IPcapDevice::PcapStats& stats) const
+{
+	stats.packetsRecv = m_PacketsReceived;
+	stats.packetsDrop = m_PacketsDroppedByServer;
+	stats.packetsDropByInterface = 0;
+}
+
+bool CaptureStreamClientDevice::sendFilter(const std::string& filterAsString)
+{
+	if (m_Data == NULL)
+	{
+		LOG_ERROR("Device not opened");
+		return false;
+	}
+
+	if (!m_Data->send(CaptureStreamSetFilter, (const uint8_t*)filterAsString.c_str(), (uint32_t)filterAsString.length()))
+	{
+		LOG_ERROR("Failed to send the filter to the capture stream server");
+		return false;
+	}
+
+	return true;
+}
+
+bool CaptureStreamClientDevice::setFilter(std::string filterAsString)
+{
+	BpfFilterWrapper filter;
+	if (!filter.setFilter(filterAsString, m_LinkType))
+	{
+		LOG_ERROR("Filter '%s' is not valid", filterAsString.c_str());
+		return false;
+	}
+
+	return sendFilter(filterAsString);
+}
+
+bool CaptureStreamClientDevice::clearFilter()
+{
+	return sendFilter("");
+}
+
+} // namespace pcpp
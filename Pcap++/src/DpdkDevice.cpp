@@ -18,9 +18,11 @@
 #include "rte_errno.h"
 #include "rte_malloc.h"
 #include "rte_cycles.h"
+#include "rte_interrupts.h"
 #include <string>
 #include <stdint.h>
 #include <unistd.h>
+#include <errno.h>
 
 #define MAX_BURST_SIZE 64
 
@@ -248,6 +250,8 @@ bool DpdkDevice::configurePort(uint8_t numOfRxQueues, uint8_t numOfTxQueues)
 	portConf.rx_adv_conf.rss_conf.rss_key = m_Config.rssKey;
 	portConf.rx_adv_conf.rss_conf.rss_key_len = m_Config.rssKeyLength;
 	portConf.rx_adv_conf.rss_conf.rss_hf = convertRssHfToDpdkRssHf(m_Config.rssHashFunction);
+	// RX interrupts are needed only for waking up capture threads in interrupt polling mode
+	portConf.intr_conf.rxq = (m_Config.pollingPolicy.mode == PollingModeInterrupt ? 1 : 0);
 
 	int res = rte_eth_dev_configure((uint8_t) m_Id, numOfRxQueues, numOfTxQueues, &portConf);
 	if (res < 0)
@@ -497,40 +501,33 @@ void DpdkDevice::getLinkStatus(LinkStatus& linkStatus) const
 }
 
 
-bool DpdkDevice::initCoreConfigurationByCoreMask(CoreMask coreMask)
+bool DpdkDevice::initCoreConfigurationByCoreMask(const CoreMask& coreMask)
 {
-	int i = 0;
 	int numOfCores = getNumOfCores();
 	clearCoreConfiguration();
-	while ((coreMask != 0) && (i < numOfCores))
+	for (int i = coreMask.getFirstCore(); i >= 0; i = coreMask.getNextCore(i))
 	{
-		if (coreMask & 1)
+		if (i >= numOfCores || i >= MAX_NUM_OF_CORES || i >= RTE_MAX_LCORE) // this mean coreMask contains a core that doesn't exist
 		{
-			if (i == DpdkDeviceList::getInstance().getDpdkMasterCore().Id)
-			{
-				LOG_ERROR("Core %d is the master core, you can't use it for capturing threads", i);
-				clearCoreConfiguration();
-				return false;
-			}
-
-			if (!rte_lcore_is_enabled(i))
-			{
-				LOG_ERROR("Trying to use core #%d which isn't initialized by DPDK", i);
-				clearCoreConfiguration();
-				return false;
-			}
-			m_CoreConfiguration[i].IsCoreInUse = true;
+			LOG_ERROR("Trying to use a core [%d] that doesn't exist while machine has %d cores", i, numOfCores);
+			clearCoreConfiguration();
+			return false;
 		}
 
-		coreMask = coreMask >> 1;
-		i++;
-	}
+		if (i == DpdkDeviceList::getInstance().getDpdkMasterCore().Id)
+		{
+			LOG_ERROR("Core %d is the master core, you can't use it for capturing threads", i);
+			clearCoreConfiguration();
+			return false;
+		}
 
-	if (coreMask != 0) // this mean coreMask contains a core that doesn't exist
-	{
-		LOG_ERROR("Trying to use a core [%d] that doesn't exist while machine has %d cores", i, numOfCores);
-		clearCoreConfiguration();
-		return false;
+		if (!rte_lcore_is_enabled(i))
+		{
+			LOG_ERROR("Trying to use core #%d which isn't initialized by DPDK", i);
+			clearCoreConfiguration();
+			return false;
+		}
+		m_CoreConfiguration[i].IsCoreInUse = true;
 	}
 
 	return true;
@@ -585,7 +582,7 @@ bool DpdkDevice::startCaptureSingleThread(OnDpdkPacketsArriveCallback onPacketsA
 	return false;
 }
 
-bool DpdkDevice::startCaptureMultiThreads(OnDpdkPacketsArriveCallback onPacketsArrive, void* onPacketsArriveUserCookie, CoreMask coreMask)
+bool DpdkDevice::startCaptureMultiThreads(OnDpdkPacketsArriveCallback onPacketsArrive, void* onPacketsArriveUserCookie, const CoreMask& coreMask)
 {
 	if (!m_DeviceOpened)
 	{
@@ -658,10 +655,36 @@ int DpdkDevice::dpdkCaptureThreadMain(void *ptr)
 
 	int queueId = pThis->m_CoreConfiguration[coreId].RxQueueId;
 
+	PollingController& poller = pThis->m_CoreConfiguration[coreId].Poller;
+	poller.reset(pThis->m_Config.pollingPolicy);
+	bool rxInterruptRegistered = false;
+	if (poller.getPolicy().mode == PollingModeInterrupt)
+	{
+		// register the RX queue interrupt in the per-thread epoll instance of this thread. It's unregistered when capture stops, but it
+		// may still be registered if a previous capture thread on this core didn't exit cleanly, which is fine
+		int res = rte_eth_dev_rx_intr_ctl_q(pThis->m_Id, queueId, RTE_EPOLL_PER_THREAD, RTE_INTR_EVENT_ADD, NULL);
+		if (res == 0 || res == -EEXIST)
+		{
+			rxInterruptRegistered = true;
+		}
+		else
+		{
+			LOG_ERROR("Cannot register RX interrupt of queue %d on device [%s], error: '%s'. Falling back to backoff polling", queueId, pThis->m_DeviceName, rte_strerror(-res));
+			poller.fallBackToBackoff();
+		}
+	}
+
 	while (likely(!pThis->m_StopThread))
 	{
 		uint32_t numOfPktsReceived = rte_eth_rx_burst(pThis->m_Id, queueId, mBufArray, MAX_BURST_SIZE);
 
+		if (unlikely(poller.onPoll(numOfPktsReceived) == PollingController::WaitForInterrupt))
+		{
+			if (!pThis->waitForRxInterrupt(queueId, poller.getPolicy().interruptTimeoutMsec))
+				poller.fallBackToBackoff();
+			poller.onInterruptWaitDone();
+		}
+
 		if (unlikely(numOfPktsReceived == 0))
 			continue;
 
@@ -680,11 +703,48 @@ int DpdkDevice::dpdkCaptureThreadMain(void *ptr)
 		}
 	}
 
+	// unregister the RX queue interrupt so the next capture on this core can register it again
+	if (rxInterruptRegistered)
+		rte_eth_dev_rx_intr_ctl_q(pThis->m_Id, queueId, RTE_EPOLL_PER_THREAD, RTE_INTR_EVENT_DEL, NULL);
+
 	LOG_DEBUG("Exiting capture thread %d", coreId);
 
 	return 0;
 }
 
+bool DpdkDevice::waitForRxInterrupt(uint16_t rxQueueId, uint32_t timeoutMsec)
+{
+	if (rte_eth_dev_rx_intr_enable(m_Id, rxQueueId) != 0)
+	{
+		LOG_ERROR("Cannot enable RX interrupt of queue %d on device [%s]. Falling back to backoff polling", rxQueueId, m_DeviceName);
+		return false;
+	}
+
+	struct rte_epoll_event event;
+	rte_epoll_wait(RTE_EPOLL_PER_THREAD, &event, 1, (int)timeoutMsec);
+	rte_eth_dev_rx_intr_disable(m_Id, rxQueueId);
+	return true;
+}
+
+void DpdkDevice::getPollingStats(uint32_t coreId, PollingStats& stats) const
+{
+	stats.clear();
+	if (coreId >= MAX_NUM_OF_CORES || !m_CoreConfiguration[coreId].IsCoreInUse)
+		return;
+
+	stats = m_CoreConfiguration[coreId].Poller.getStats();
+}
+
+void DpdkDevice::getPollingStats(PollingStats& stats) const
+{
+	stats.clear();
+	for (int coreId = 0; coreId < MAX_NUM_OF_CORES; coreId++)
+	{
+		if (m_CoreConfiguration[coreId].IsCoreInUse)
+			stats.add(m_CoreConfiguration[coreId].Poller.getStats());
+	}
+}
+
 #define nanosec_gap(begin, end) ((end.tv_sec - begin.tv_sec) * 1000000000.0 + (end.tv_nsec - begin.tv_nsec))
 
 void DpdkDevice::getStatistics(DpdkDeviceStats& stats) const
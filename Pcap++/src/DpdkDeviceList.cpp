@@ -63,10 +63,9 @@ DpdkDeviceList::~DpdkDeviceList()
 }
 
 const uint32_t initDpdkArgc = 7;
-const uint32_t maxArgLen = 20;
 char** initDpdkArgv;
 
-bool DpdkDeviceList::initDpdk(CoreMask coreMask, uint32_t mBufPoolSizePerDevice, uint8_t masterCore)
+bool DpdkDeviceList::initDpdk(const CoreMask& coreMask, uint32_t mBufPoolSizePerDevice, uint8_t masterCore)
 {
 	if (m_IsDpdkInitialized)
 	{
@@ -98,7 +97,7 @@ bool DpdkDeviceList::initDpdk(CoreMask coreMask, uint32_t mBufPoolSizePerDevice,
 	dpdkParamsStream << "-n ";
 	dpdkParamsStream << "2 ";
 	dpdkParamsStream << "-c ";
-	dpdkParamsStream << "0x" << std::hex << std::setw(2) << std::setfill('0') << coreMask << " ";
+	dpdkParamsStream << coreMask.toHexString() << " ";
 	dpdkParamsStream << "--master-lcore ";
 	dpdkParamsStream << (int)masterCore;
 
@@ -107,7 +106,7 @@ bool DpdkDeviceList::initDpdk(CoreMask coreMask, uint32_t mBufPoolSizePerDevice,
 	uint32_t i = 0;
     while (dpdkParamsStream.good() && i < initDpdkArgc){
     	dpdkParamsStream >> dpdkParamsArray[i];
-    	initDpdkArgv[i] = new char[maxArgLen];
+    	initDpdkArgv[i] = new char[dpdkParamsArray[i].length() + 1];
     	strcpy(initDpdkArgv[i], dpdkParamsArray[i].c_str());
         i++;
     }
@@ -293,7 +292,7 @@ int DpdkDeviceList::dpdkWorkerThreadStart(void *ptr)
 	return 0;
 }
 
-bool DpdkDeviceList::startDpdkWorkerThreads(CoreMask coreMask, std::vector<DpdkWorkerThread*>& workerThreadsVec)
+bool DpdkDeviceList::startDpdkWorkerThreads(const CoreMask& coreMask, std::vector<DpdkWorkerThread*>& workerThreadsVec)
 {
 	if (!isInitialized())
 	{
@@ -301,23 +300,16 @@ bool DpdkDeviceList::startDpdkWorkerThreads(CoreMask coreMask, std::vector<DpdkW
 		return false;
 	}
 
-	CoreMask tempCoreMask = coreMask;
 	size_t numOfCoresInMask = 0;
-	int coreNum = 0;
-	while (tempCoreMask > 0)
+	for (int coreNum = coreMask.getFirstCore(); coreNum >= 0; coreNum = coreMask.getNextCore(coreNum))
 	{
-		if (tempCoreMask & 1)
+		if (coreNum >= RTE_MAX_LCORE || coreNum >= MAX_NUM_OF_CORES || !rte_lcore_is_enabled(coreNum))
 		{
-			if (!rte_lcore_is_enabled(coreNum))
-			{
-				LOG_ERROR("Trying to use core #%d which isn't initialized by DPDK", coreNum);
-				return false;
-			}
-
-			numOfCoresInMask++;
+			LOG_ERROR("Trying to use core #%d which isn't initialized by DPDK", coreNum);
+			return false;
 		}
-		tempCoreMask = tempCoreMask >> 1;
-		coreNum++;
+
+		numOfCoresInMask++;
 	}
 
 	if (numOfCoresInMask == 0)
@@ -332,7 +324,7 @@ bool DpdkDeviceList::startDpdkWorkerThreads(CoreMask coreMask, std::vector<DpdkW
 		return false;
 	}
 
-	if (coreMask & getDpdkMasterCore().Mask)
+	if (coreMask.isCoreSet(getDpdkMasterCore().Id))
 	{
 		LOG_ERROR("Cannot run worker thread on DPDK master core");
 		return false;
@@ -344,7 +336,7 @@ bool DpdkDeviceList::startDpdkWorkerThreads(CoreMask coreMask, std::vector<DpdkW
 	while (iter != workerThreadsVec.end())
 	{
 		SystemCore core = SystemCores::IdToSystemCore[index];
-		if (!(coreMask & core.Mask))
+		if (!coreMask.isCoreSet(core.Id))
 		{
 			index++;
 			continue;
@@ -0,0 +1,636 @@
+#define LOG_MODULE PcapLogModuleFlightRecorder
+
+#include "PacketFlightRecorder.h"
+#include "PcapFileDevice.h"
+#include "PcapFilter.h"
+#include "Logger.h"
+#include <pthread.h>
+#include <string.h>
+#include <deque>
+#include <new>
+#if defined(_MSC_VER)
+#include <windows.h>
+#endif
+
+// packet record header: timestamp (8 bytes), captured length (4), original length (4), link type (2), reserved (6)
+#define FLIGHT_RECORDER_RECORD_HEADER_SIZE 24
+#define FLIGHT_RECORDER_RECORD_ALIGNMENT 8
+#define NSEC_PER_SEC 1000000000ULL
+
+namespace pcpp
+{
+
+// the writer of a lane and the dump thread share the slab headers. These are the only accesses that need ordering; the packet data is
+// protected by the slab generation
+
+#if defined(_MSC_VER)
+
+template<typename T>
+static inline T atomicLoadAcquire(const volatile T* ptr) { T value = *ptr; _ReadWriteBarrier(); return value; }
+template<typename T>
+static inline void atomicStoreRelease(volatile T* ptr, T value) { _ReadWriteBarrier(); *ptr = value; }
+static inline void atomicFenceRelease() { _ReadWriteBarrier(); }
+static inline void atomicFenceAcquire() { MemoryBarrier(); }
+
+#else
+
+template<typename T>
+static inline T atomicLoadAcquire(const volatile T* ptr) { return __atomic_load_n(ptr, __ATOMIC_ACQUIRE); }
+template<typename T>
+static inline void atomicStoreRelease(volatile T* ptr, T value) { __atomic_store_n(ptr, value, __ATOMIC_RELEASE); }
+static inline void atomicFenceRelease() { __atomic_thread_fence(__ATOMIC_RELEASE); }
+static inline void atomicFenceAcquire() { __atomic_thread_fence(__ATOMIC_ACQUIRE); }
+
+#endif
+
+struct PacketFlightRecorder::Slab
+{
+	uint8_t* data;
+	// incremented each time the slab is reused
+	volatile uint64_t generation;
+	volatile uint32_t usedBytes;
+	volatile uint32_t numOfPackets;
+	volatile uint64_t firstTimestamp;
+	volatile uint64_t lastTimestamp;
+};
+
+struct PacketFlightRecorder::Lane
+{
+	Slab* slabs;
+	volatile uint32_t curSlab;
+	volatile uint64_t packetsAdded;
+	volatile uint64_t packetsOverwritten;
+	volatile uint64_t packetsNotAdded;
+	bool hasPackets;
+};
+
+struct FlightRecorderDumpRequest
+{
+	uint64_t startTime;
+	uint64_t endTime;
+	std::string fileName;
+	std::string filter;
+	CaptureFileFormat fileFormat;
+	OnFlightRecorderDumpFinishedCallback onFinished;
+	void* userCookie;
+};
+
+struct PacketFlightRecorderData
+{
+	pthread_t dumpThread;
+	bool dumpThreadStarted;
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	std::deque<FlightRecorderDumpRequest> requests;
+	uint32_t pendingDumps;
+	bool stopDumpThread;
+
+	PacketFlightRecorderData() : dumpThreadStarted(false), pendingDumps(0), stopDumpThread(false)
+	{
+		pthread_mutex_init(&mutex, NULL);
+		pthread_cond_init(&cond, NULL);
+	}
+
+	~PacketFlightRecorderData()
+	{
+		pthread_mutex_destroy(&mutex);
+		pthread_cond_destroy(&cond);
+	}
+};
+
+/**
+ * Iterates the packets of one lane during a dump. Slabs are copied one at a time to a private buffer and a slab is used only if it wasn't
+ * reused since the dump started
+ */
+class FlightRecorderLaneReader
+{
+public:
+	struct SlabRef
+	{
+		uint8_t* data;
+		const volatile uint64_t* generation;
+		const volatile uint32_t* usedBytes;
+		uint64_t expectedGeneration;
+	};
+
+	std::vector<SlabRef> slabs;
+	size_t nextSlab;
+	std::vector<uint8_t> buffer;
+	uint32_t bufferLen;
+	uint32_t pos;
+	uint64_t numOfOverwrittenSlabs;
+
+	FlightRecorderLaneReader(uint32_t slabSize) : nextSlab(0), buffer(slabSize), bufferLen(0), pos(0), numOfOverwrittenSlabs(0) {}
+
+	// returns the current record or NULL if there are no more records
+	const uint8_t* current()
+	{
+		while (pos >= bufferLen)
+		{
+			if (!loadNextSlab())
+				return NULL;
+		}
+
+		return &buffer[pos];
+	}
+
+	void advance()
+	{
+		uint32_t capLen;
+		memcpy(&capLen, &buffer[pos + 8], sizeof(capLen));
+		pos += (FLIGHT_RECORDER_RECORD_HEADER_SIZE + capLen + FLIGHT_RECORDER_RECORD_ALIGNMENT - 1) & ~(FLIGHT_RECORDER_RECORD_ALIGNMENT - 1);
+	}
+
+private:
+	bool loadNextSlab()
+	{
+		while (nextSlab < slabs.size())
+		{
+			SlabRef& slab = slabs[nextSlab++];
+			pos = 0;
+			bufferLen = 0;
+
+			// seqlock read: the copy is valid only if the generation didn't change while copying
+			if (atomicLoadAcquire(slab.generation) != slab.expectedGeneration)
+			{
+				numOfOverwrittenSlabs++;
+				continue;
+			}
+
+			uint32_t usedBytes = atomicLoadAcquire(slab.usedBytes);
+			memcpy(&buffer[0], slab.data, usedBytes);
+			atomicFenceAcquire();
+			if (*slab.generation != slab.expectedGeneration)
+			{
+				numOfOverwrittenSlabs++;
+				continue;
+			}
+
+			bufferLen = usedBytes;
+			if (bufferLen > 0)
+				return true;
+		}
+
+		return false;
+	}
+};
+
+static uint64_t timespecToNsec(const timespec& ts)
+{
+	return (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+static timespec nsecToTimespec(uint64_t nsec)
+{
+	timespec ts;
+	ts.tv_sec = nsec / NSEC_PER_SEC;
+	ts.tv_nsec = nsec % NSEC_PER_SEC;
+	return ts;
+}
+
+
+PacketFlightRecorder::PacketFlightRecorder(const Config& config) : m_Config(config), m_SlabsPerLane(0), m_Lanes(NULL), m_Data(NULL)
+{
+	if (m_Config.numOfLanes == 0 || m_Config.slabSize < 2 * FLIGHT_RECORDER_RECORD_HEADER_SIZE)
+	{
+		LOG_ERROR("Invalid flight recorder configuration: number of lanes must be positive and slab size must be at least %d bytes",
+				2 * FLIGHT_RECORDER_RECORD_HEADER_SIZE);
+		return;
+	}
+
+	m_Config.slabSize &= ~(FLIGHT_RECORDER_RECORD_ALIGNMENT - 1);
+	m_SlabsPerLane = (uint32_t)(m_Config.memorySize / m_Config.numOfLanes / m_Config.slabSize);
+	if (m_SlabsPerLane < 2)
+	{
+		LOG_ERROR("Flight recorder memory size is too small: each lane must have at least 2 slabs of %u bytes", m_Config.slabSize);
+		return;
+	}
+	m_Config.memorySize = (uint64_t)m_SlabsPerLane * m_Config.slabSize * m_Config.numOfLanes;
+
+	Lane* lanes = new Lane[m_Config.numOfLanes];
+	memset(lanes, 0, sizeof(Lane) * m_Config.numOfLanes);
+	for (uint16_t i = 0; i < m_Config.numOfLanes; i++)
+	{
+		lanes[i].slabs = new Slab[m_SlabsPerLane];
+		memset(lanes[i].slabs, 0, sizeof(Slab) * m_SlabsPerLane);
+		for (uint32_t j = 0; j < m_SlabsPerLane; j++)
+		{
+			lanes[i].slabs[j].data = new (std::nothrow) uint8_t[m_Config.slabSize];
+			if (lanes[i].slabs[j].data == NULL)
+			{
+				LOG_ERROR("Couldn't allocate %llu bytes for the flight recorder", (unsigned long long)m_Config.memorySize);
+				m_Lanes = lanes;
+				for (uint16_t k = 0; k <= i; k++)
+				{
+					for (uint32_t l = 0; l < m_SlabsPerLane; l++)
+						delete [] m_Lanes[k].slabs[l].data;
+					delete [] m_Lanes[k].slabs;
+				}
+				delete [] m_Lanes;
+				m_Lanes = NULL;
+				return;
+			}
+		}
+	}
+
+	m_Lanes = lanes;
+	m_Data = new PacketFlightRecorderData();
+	LOG_DEBUG("Flight recorder created with %d lanes of %u slabs of %u bytes", m_Config.numOfLanes, m_SlabsPerLane, m_Config.slabSize);
+}
+
+PacketFlightRecorder::~PacketFlightRecorder()
+{
+	if (m_Data != NULL)
+	{
+		pthread_mutex_lock(&m_Data->mutex);
+		m_Data->stopDumpThread = true;
+		pthread_cond_broadcast(&m_Data->cond);
+		bool joinThread = m_Data->dumpThreadStarted;
+		pthread_mutex_unlock(&m_Data->mutex);
+		if (joinThread)
+			pthread_join(m_Data->dumpThread, NULL);
+
+		delete m_Data;
+	}
+
+	if (m_Lanes != NULL)
+	{
+		for (uint16_t i = 0; i < m_Config.numOfLanes; i++)
+		{
+			for (uint32_t j = 0; j < m_SlabsPerLane; j++)
+				delete [] m_Lanes[i].slabs[j].data;
+			delete [] m_Lanes[i].slabs;
+		}
+		delete [] m_Lanes;
+	}
+}
+
+void PacketFlightRecorder::startNewSlab(Lane& lane, uint64_t timestamp)
+{
+	uint32_t nextSlabIndex = (lane.curSlab + 1) % m_SlabsPerLane;
+	Slab& slab = lane.slabs[nextSlabIndex];
+
+	// readers that copy this slab from now on will see the generation change. The fence makes sure the new generation is visible
+	// before any of the slab data is overwritten
+	slab.generation = slab.generation + 1;
+	atomicFenceRelease();
+
+	lane.packetsOverwritten = lane.packetsOverwritten + slab.numOfPackets;
+	slab.numOfPackets = 0;
+	slab.firstTimestamp = timestamp;
+	slab.lastTimestamp = timestamp;
+	atomicStoreRelease(&slab.usedBytes, (uint32_t)0);
+	atomicStoreRelease(&lane.curSlab, nextSlabIndex);
+}
+
+bool PacketFlightRecorder::addPacket(const RawPacket& rawPacket, uint16_t lane)
+{
+	if (m_Lanes == NULL || lane >= m_Config.numOfLanes)
+		return false;
+
+	Lane& curLane = m_Lanes[lane];
+	RawPacket& packet = const_cast<RawPacket&>(rawPacket);
+	uint32_t capLen = packet.getRawDataLen();
+	if (m_Config.snapLen > 0 && capLen > m_Config.snapLen)
+		capLen = m_Config.snapLen;
+
+	uint32_t recordLen = (FLIGHT_RECORDER_RECORD_HEADER_SIZE + capLen + FLIGHT_RECORDER_RECORD_ALIGNMENT - 1) & ~(FLIGHT_RECORDER_RECORD_ALIGNMENT - 1);
+	if (recordLen > m_Config.slabSize)
+	{
+		curLane.packetsNotAdded = curLane.packetsNotAdded + 1;
+		return false;
+	}
+
+	uint64_t timestamp = timespecToNsec(packet.getPacketTimeStamp());
+	Slab* slab = &curLane.slabs[curLane.curSlab];
+	if (!curLane.hasPackets)
+	{
+		slab->firstTimestamp = timestamp;
+		curLane.hasPackets = true;
+	}
+	else if (slab->usedBytes + recordLen > m_Config.slabSize)
+	{
+		startNewSlab(curLane, timestamp);
+		slab = &curLane.slabs[curLane.curSlab];
+	}
+
+	uint32_t usedBytes = slab->usedBytes;
+	uint8_t* record = slab->data + usedBytes;
+	uint32_t origLen = packet.getFrameLength();
+	uint16_t linkType = (uint16_t)packet.getLinkLayerType();
+	memset(record, 0, FLIGHT_RECORDER_RECORD_HEADER_SIZE);
+	memcpy(record, &timestamp, sizeof(timestamp));
+	memcpy(record + 8, &capLen, sizeof(capLen));
+	memcpy(record + 12, &origLen, sizeof(origLen));
+	memcpy(record + 16, &linkType, sizeof(linkType));
+	memcpy(record + FLIGHT_RECORDER_RECORD_HEADER_SIZE, packet.getRawData(), capLen);
+
+	slab->lastTimestamp = timestamp;
+	slab->numOfPackets = slab->numOfPackets + 1;
+	atomicStoreRelease(&slab->usedBytes, usedBytes + recordLen);
+	curLane.packetsAdded = curLane.packetsAdded + 1;
+	return true;
+}
+
+uint32_t PacketFlightRecorder::addPackets(const RawPacket* packets, uint32_t numOfPackets, uint16_t lane)
+{
+	uint32_t numOfPacketsAdded = 0;
+	for (uint32_t i = 0; i < numOfPackets; i++)
+	{
+		if (addPacket(packets[i], lane))
+			numOfPacketsAdded++;
+	}
+
+	return numOfPacketsAdded;
+}
+
+void PacketFlightRecorder::onPacketArrives(RawPacket* rawPacket, PcapLiveDevice* device, void* recorder)
+{
+	((PacketFlightRecorder*)recorder)->addPacket(*rawPacket, 0);
+}
+
+bool PacketFlightRecorder::dumpRange(const timespec& startTime, const timespec& endTime, const std::string& fileName, const std::string& filter,
+		CaptureFileFormat fileFormat, OnFlightRecorderDumpFinishedCallback onFinished, void* userCookie)
+{
+	if (m_Lanes == NULL)
+	{
+		LOG_ERROR("Flight recorder isn't valid");
+		return false;
+	}
+
+	FlightRecorderDumpRequest request;
+	request.startTime = timespecToNsec(startTime);
+	request.endTime = timespecToNsec(endTime);
+	request.fileName = fileName;
+	request.filter = filter;
+	request.fileFormat = fileFormat;
+	request.onFinished = onFinished;
+	request.userCookie = userCookie;
+	if (request.startTime > request.endTime)
+	{
+		LOG_ERROR("Dump start time is after its end time");
+		return false;
+	}
+
+	pthread_mutex_lock(&m_Data->mutex);
+	if (!m_Data->dumpThreadStarted)
+	{
+		int err = pthread_create(&m_Data->dumpThread, NULL, dumpThreadMain, (void*)this);
+		if (err != 0)
+		{
+			pthread_mutex_unlock(&m_Data->mutex);
+			LOG_ERROR("Couldn't create the flight recorder dump thread, error code is %d", err);
+			return false;
+		}
+		m_Data->dumpThreadStarted = true;
+	}
+
+	m_Data->requests.push_back(request);
+	m_Data->pendingDumps++;
+	pthread_cond_broadcast(&m_Data->cond);
+	pthread_mutex_unlock(&m_Data->mutex);
+
+	LOG_DEBUG("Dump to '%s' queued", fileName.c_str());
+	return true;
+}
+
+void PacketFlightRecorder::waitForDumps()
+{
+	if (m_Data == NULL)
+		return;
+
+	pthread_mutex_lock(&m_Data->mutex);
+	while (m_Data->pendingDumps > 0)
+		pthread_cond_wait(&m_Data->cond, &m_Data->mutex);
+	pthread_mutex_unlock(&m_Data->mutex);
+}
+
+uint32_t PacketFlightRecorder::getNumOfPendingDumps() const
+{
+	if (m_Data == NULL)
+		return 0;
+
+	pthread_mutex_lock(&m_Data->mutex);
+	uint32_t pendingDumps = m_Data->pendingDumps;
+	pthread_mutex_unlock(&m_Data->mutex);
+	return pendingDumps;
+}
+
+void* PacketFlightRecorder::dumpThreadMain(void* ptr)
+{
+	PacketFlightRecorder* recorder = (PacketFlightRecorder*)ptr;
+	PacketFlightRecorderData* data = recorder->m_Data;
+
+	pthread_mutex_lock(&data->mutex);
+	while (true)
+	{
+		while (data->requests.empty() && !data->stopDumpThread)
+			pthread_cond_wait(&data->cond, &data->mutex);
+
+		// queued dumps are finished before the thread stops
+		if (data->requests.empty())
+			break;
+
+		FlightRecorderDumpRequest request = data->requests.front();
+		data->requests.pop_front();
+		pthread_mutex_unlock(&data->mutex);
+
+		uint64_t numOfPackets = 0;
+		bool success = recorder->doDump(request, numOfPackets);
+		if (request.onFinished != NULL)
+			request.onFinished(request.fileName, numOfPackets, success, request.userCookie);
+
+		pthread_mutex_lock(&data->mutex);
+		data->pendingDumps--;
+		pthread_cond_broadcast(&data->cond);
+	}
+	pthread_mutex_unlock(&data->mutex);
+
+	return NULL;
+}
+
+bool PacketFlightRecorder::doDump(const FlightRecorderDumpRequest& request, uint64_t& numOfPackets)
+{
+	BpfFilterWrapper filter;
+	if (!request.filter.empty() && !filter.setFilter(request.filter))
+	{
+		LOG_ERROR("Invalid dump filter '%s'", request.filter.c_str());
+		return false;
+	}
+
+	// take a snapshot of the slabs that may contain packets in the range, from the oldest to the newest of each lane. Slabs that are
+	// reused after this point are skipped when they're reached
+	std::vector<FlightRecorderLaneReader*> laneReaders;
+	for (uint16_t i = 0; i < m_Config.numOfLanes; i++)
+	{
+		Lane& lane = m_Lanes[i];
+		FlightRecorderLaneReader* laneReader = new FlightRecorderLaneReader(m_Config.slabSize);
+		laneReaders.push_back(laneReader);
+		uint32_t curSlab = atomicLoadAcquire(&lane.curSlab);
+		for (uint32_t j = 1; j <= m_SlabsPerLane; j++)
+		{
+			Slab& slab = lane.slabs[(curSlab + j) % m_SlabsPerLane];
+			FlightRecorderLaneReader::SlabRef slabRef;
+			slabRef.data = slab.data;
+			slabRef.generation = &slab.generation;
+			slabRef.usedBytes = &slab.usedBytes;
+			slabRef.expectedGeneration = atomicLoadAcquire(&slab.generation);
+
+			// the timestamps are only a hint for skipping slabs: if the slab is reused meanwhile it'll be skipped anyway
+			if (atomicLoadAcquire(&slab.usedBytes) == 0 || slab.lastTimestamp < request.startTime || slab.firstTimestamp > request.endTime)
+				continue;
+
+			laneReader->slabs.push_back(slabRef);
+		}
+	}
+
+	IFileWriterDevice* writer = NULL;
+	LinkLayerType pcapLinkType = LINKTYPE_ETHERNET;
+	if (request.fileFormat == CaptureFilePcapNg)
+		writer = new PcapNgFileWriterDevice(request.fileName.c_str());
+
+	bool success = true;
+	while (success)
+	{
+		// merge the lanes: take the packet with the earliest timestamp
+		FlightRecorderLaneReader* earliestLane = NULL;
+		uint64_t earliestTimestamp = 0;
+		for (std::vector<FlightRecorderLaneReader*>::iterator iter = laneReaders.begin(); iter != laneReaders.end(); iter++)
+		{
+			const uint8_t* record;
+			uint64_t timestamp = 0;
+			while ((record = (*iter)->current()) != NULL)
+			{
+				memcpy(&timestamp, record, sizeof(timestamp));
+				if (timestamp >= request.startTime)
+					break;
+				(*iter)->advance();
+			}
+
+			if (record == NULL || timestamp > request.endTime)
+				continue;
+
+			if (earliestLane == NULL || timestamp < earliestTimestamp)
+			{
+				earliestLane = *iter;
+				earliestTimestamp = timestamp;
+			}
+		}
+
+		if (earliestLane == NULL)
+			break;
+
+		const uint8_t* record = earliestLane->current();
+		uint32_t capLen, origLen;
+		uint16_t linkType;
+		memcpy(&capLen, record + 8, sizeof(capLen));
+		memcpy(&origLen, record + 12, sizeof(origLen));
+		memcpy(&linkType, record + 16, sizeof(linkType));
+		const uint8_t* packetData = record + FLIGHT_RECORDER_RECORD_HEADER_SIZE;
+		timespec timestamp = nsecToTimespec(earliestTimestamp);
+
+		// a pcap file has a single link layer type, which is known only when the first packet is written
+		bool skipPacket = (request.fileFormat == CaptureFilePcap && writer != NULL && linkType != pcapLinkType);
+		if (!skipPacket && filter.matchPacketWithFilter(packetData, capLen, timestamp, linkType))
+		{
+			if (writer == NULL)
+			{
+				pcapLinkType = static_cast<LinkLayerType>(linkType);
+				writer = new PcapFileWriterDevice(request.fileName.c_str(), pcapLinkType);
+			}
+
+			if (!writer->isOpened() && !writer->open())
+			{
+				LOG_ERROR("Couldn't create dump file '%s'", request.fileName.c_str());
+				success = false;
+				break;
+			}
+
+			RawPacket rawPacket(packetData, capLen, timestamp, false, static_cast<LinkLayerType>(linkType));
+			rawPacket.setRawData(packetData, capLen, timestamp, static_cast<LinkLayerType>(linkType), origLen);
+			if (writer->writePacket(rawPacket))
+				numOfPackets++;
+		}
+
+		earliestLane->advance();
+	}
+
+	// create an empty file if there are no packets in the range
+	if (success && writer == NULL)
+		writer = new PcapFileWriterDevice(request.fileName.c_str());
+	if (success && !writer->isOpened() && !writer->open())
+	{
+		LOG_ERROR("Couldn't create dump file '%s'", request.fileName.c_str());
+		success = false;
+	}
+
+	uint64_t numOfOverwrittenSlabs = 0;
+	for (std::vector<FlightRecorderLaneReader*>::iterator iter = laneReaders.begin(); iter != laneReaders.end(); iter++)
+	{
+		numOfOverwrittenSlabs += (*iter)->numOfOverwrittenSlabs;
+		delete *iter;
+	}
+
+	if (writer != NULL)
+	{
+		writer->close();
+		delete writer;
+	}
+
+	LOG_DEBUG("Dumped %llu packets to '%s', %llu slabs were overwritten during the dump", (unsigned long long)numOfPackets, request.fileName.c_str(),
+			(unsigned long long)numOfOverwrittenSlabs);
+	return success;
+}
+
+bool PacketFlightRecorder::getTimeRange(timespec& oldest, timespec& newest) const
+{
+	if (m_Lanes == NULL)
+		return false;
+
+	bool found = false;
+	uint64_t oldestTimestamp = 0, newestTimestamp = 0;
+	for (uint16_t i = 0; i < m_Config.numOfLanes; i++)
+	{
+		Lane& lane = m_Lanes[i];
+		uint32_t curSlab = atomicLoadAcquire(&lane.curSlab);
+		for (uint32_t j = 1; j <= m_SlabsPerLane; j++)
+		{
+			Slab& slab = lane.slabs[(curSlab + j) % m_SlabsPerLane];
+			if (atomicLoadAcquire(&slab.usedBytes) == 0)
+				continue;
+
+			if (!found || slab.firstTimestamp < oldestTimestamp)
+				oldestTimestamp = slab.firstTimestamp;
+			if (!found || slab.lastTimestamp > newestTimestamp)
+				newestTimestamp = slab.lastTimestamp;
+			found = true;
+		}
+	}
+
+	if (found)
+	{
+		oldest = nsecToTimespec(oldestTimestamp);
+		newest = nsecToTimespec(newestTimestamp);
+	}
+
+	return found;
+}
+
+void PacketFlightRecorder::getStatistics(Stats& stats) const
+{
+	memset(&stats, 0, sizeof(stats));
+	if (m_Lanes == NULL)
+		return;
+
+	for (uint16_t i = 0; i < m_Config.numOfLanes; i++)
+	{
+		Lane& lane = m_Lanes[i];
+		stats.packetsAdded += lane.packetsAdded;
+		stats.packetsOverwritten += lane.packetsOverwritten;
+		stats.packetsNotAdded += lane.packetsNotAdded;
+		for (uint32_t j = 0; j < m_SlabsPerLane; j++)
+			stats.bytesStored += atomicLoadAcquire(&lane.slabs[j].usedBytes);
+	}
+}
+
+} // namespace pcpp
@@ -0,0 +1,555 @@
+#define LOG_MODULE PcapLogModuleLoadBalancer
+
+#include "PacketLoadBalancer.h"
+#include "PacketUtils.h"
+#include "Packet.h"
+#include "Logger.h"
+#include <string.h>
+#include <new>
+#if !defined(WIN32) && !defined(WINx64) && !defined(PCAPPP_MINGW_ENV)
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define NSEC_PER_SEC 1000000000ULL
+#define CACHE_LINE_SIZE 64
+#define LOAD_BALANCER_MAGIC 0x50434C42
+#define LOAD_BALANCER_RECEIVE_BATCH_SIZE 64
+
+namespace pcpp
+{
+
+// the distributing thread and each worker share the ring indices of the worker. Slots are written by the distributing thread before the
+// head index is published and read by the worker before the tail index is published. The rings may be in shared memory, so only offsets
+// from the beginning of the memory are stored in it
+
+#if defined(_MSC_VER)
+
+template<typename T>
+static inline T atomicLoadAcquire(const volatile T* ptr) { T value = *ptr; _ReadWriteBarrier(); return value; }
+template<typename T>
+static inline void atomicStoreRelease(volatile T* ptr, T value) { _ReadWriteBarrier(); *ptr = value; }
+
+#else
+
+template<typename T>
+static inline T atomicLoadAcquire(const volatile T* ptr) { return __atomic_load_n(ptr, __ATOMIC_ACQUIRE); }
+template<typename T>
+static inline void atomicStoreRelease(volatile T* ptr, T value) { __atomic_store_n(ptr, value, __ATOMIC_RELEASE); }
+
+#endif
+
+// the beginning of the memory. The magic is written last, so a worker that sees it sees the rest of the header
+struct LoadBalancerMemoryHeader
+{
+	volatile uint32_t magic;
+	uint32_t numOfWorkers;
+	uint32_t ringSize;
+	uint32_t slotSize;
+	uint64_t memorySize;
+};
+
+// the beginning of the memory of each worker, followed by its slots
+struct LoadBalancerRing
+{
+	// written by the distributing thread
+	volatile uint32_t head;
+	// keeps the fields of the distributing thread and the fields of the worker in different cache lines
+	uint8_t padding[CACHE_LINE_SIZE - sizeof(uint32_t)];
+	// written by the worker
+	volatile uint32_t tail;
+	uint8_t padding2[CACHE_LINE_SIZE - sizeof(uint32_t)];
+};
+
+// the beginning of each slot, followed by the packet data
+struct LoadBalancerSlot
+{
+	uint64_t timestamp;
+	uint32_t captureLen;
+	uint32_t frameLength;
+	uint16_t linkType;
+	uint8_t reserved[6];
+};
+
+struct PacketLoadBalancer::WorkerCounters
+{
+	uint64_t packetsDistributed;
+	uint64_t bytesDistributed;
+	uint64_t packetsDropped;
+};
+
+static size_t alignToCacheLine(size_t size)
+{
+	return (size + CACHE_LINE_SIZE - 1) & ~((size_t)CACHE_LINE_SIZE - 1);
+}
+
+static size_t getRingOffset(const LoadBalancerMemoryHeader* header, uint16_t workerId)
+{
+	return alignToCacheLine(sizeof(LoadBalancerMemoryHeader)) + (size_t)workerId * (sizeof(LoadBalancerRing) + (size_t)header->ringSize * header->slotSize);
+}
+
+static inline LoadBalancerRing* getRing(uint8_t* memory, uint16_t workerId)
+{
+	return (LoadBalancerRing*)(memory + getRingOffset((LoadBalancerMemoryHeader*)memory, workerId));
+}
+
+static inline LoadBalancerSlot* getSlot(uint8_t* memory, LoadBalancerRing* ring, uint32_t index)
+{
+	LoadBalancerMemoryHeader* header = (LoadBalancerMemoryHeader*)memory;
+	return (LoadBalancerSlot*)((uint8_t*)ring + sizeof(LoadBalancerRing) + (size_t)(index & (header->ringSize - 1)) * header->slotSize);
+}
+
+static timespec nsecToTimespec(uint64_t nsec)
+{
+	timespec ts;
+	ts.tv_sec = nsec / NSEC_PER_SEC;
+	ts.tv_nsec = nsec % NSEC_PER_SEC;
+	return ts;
+}
+
+// the receive side of a ring, used by both worker threads and worker processes. Each worker must be received by a single thread at a time
+static uint32_t receiveFromRing(uint8_t* memory, uint16_t workerId, OnBalancedPacketsCallback onPacketsReceived, void* userCookie, uint32_t maxNumOfPackets)
+{
+	LoadBalancerRing* ring = getRing(memory, workerId);
+	uint32_t tail = ring->tail;
+	uint32_t numOfPackets = atomicLoadAcquire(&ring->head) - tail;
+	if (numOfPackets > maxNumOfPackets)
+		numOfPackets = maxNumOfPackets;
+
+	// RawPacket objects are created in place over the slots, so the batch storage doesn't depend on the ring memory
+	uint64_t batchStorage[(LOAD_BALANCER_RECEIVE_BATCH_SIZE * sizeof(RawPacket) + sizeof(uint64_t) - 1) / sizeof(uint64_t)];
+	RawPacket* batch = (RawPacket*)batchStorage;
+
+	uint32_t numOfPacketsReceived = 0;
+	while (numOfPacketsReceived < numOfPackets)
+	{
+		uint32_t batchSize = numOfPackets - numOfPacketsReceived;
+		if (batchSize > LOAD_BALANCER_RECEIVE_BATCH_SIZE)
+			batchSize = LOAD_BALANCER_RECEIVE_BATCH_SIZE;
+
+		for (uint32_t i = 0; i < batchSize; i++)
+		{
+			LoadBalancerSlot* slot = getSlot(memory, ring, tail + i);
+			uint8_t* data = (uint8_t*)(slot + 1);
+			timespec timestamp = nsecToTimespec(slot->timestamp);
+			new (&batch[i]) RawPacket(data, (int)slot->captureLen, timestamp, false, (LinkLayerType)slot->linkType);
+			batch[i].setRawData(data, (int)slot->captureLen, timestamp, (LinkLayerType)slot->linkType, (int)slot->frameLength);
+		}
+
+		onPacketsReceived(batch, batchSize, workerId, userCookie);
+
+		for (uint32_t i = 0; i < batchSize; i++)
+			batch[i].~RawPacket();
+
+		// the slots of the batch can be reused only now that the callback returned
+		tail += batchSize;
+		atomicStoreRelease(&ring->tail, tail);
+		numOfPacketsReceived += batchSize;
+	}
+
+	return numOfPacketsReceived;
+}
+
+
+PacketLoadBalancer::PacketLoadBalancer(const Config& config) : m_Config(config), m_Memory(NULL), m_MemorySize(0), m_IsSharedMemory(false),
+	m_WorkerCounters(NULL), m_PacketsWithoutFlow(0), m_NumOfRebalances(0), m_NumOfBucketsMoved(0)
+{
+	if (m_Config.numOfWorkers == 0 || m_Config.ringSize == 0 || m_Config.ringSize > 0x80000000 || m_Config.maxPacketLen == 0 || m_Config.numOfBuckets == 0)
+	{
+		LOG_ERROR("Invalid load balancer configuration: number of workers, ring size, max packet length and number of buckets must be positive");
+		return;
+	}
+
+	uint32_t ringSize = 1;
+	while (ringSize < m_Config.ringSize)
+		ringSize <<= 1;
+	m_Config.ringSize = ringSize;
+
+	uint32_t slotSize = (uint32_t)alignToCacheLine(sizeof(LoadBalancerSlot) + m_Config.maxPacketLen);
+	size_t memorySize = alignToCacheLine(sizeof(LoadBalancerMemoryHeader)) + (size_t)m_Config.numOfWorkers * (sizeof(LoadBalancerRing) + (size_t)ringSize * slotSize);
+
+	uint8_t* memory = NULL;
+	if (m_Config.sharedMemoryName.empty())
+	{
+		memory = new (std::nothrow) uint8_t[memorySize];
+		if (memory == NULL)
+		{
+			LOG_ERROR("Couldn't allocate %llu bytes for the load balancer", (unsigned long long)memorySize);
+			return;
+		}
+	}
+	else
+	{
+#if defined(WIN32) || defined(WINx64) || defined(PCAPPP_MINGW_ENV)
+		LOG_ERROR("Load balancer shared memory isn't supported on Windows");
+		return;
+#else
+		// O_EXCL prevents two balancers from sharing the same rings
+		int fd = shm_open(m_Config.sharedMemoryName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+		if (fd < 0)
+		{
+			LOG_ERROR("Couldn't create shared memory '%s': %s", m_Config.sharedMemoryName.c_str(), strerror(errno));
+			return;
+		}
+
+		if (ftruncate(fd, (off_t)memorySize) != 0)
+		{
+			LOG_ERROR("Couldn't resize shared memory '%s' to %llu bytes: %s", m_Config.sharedMemoryName.c_str(), (unsigned long long)memorySize, strerror(errno));
+			close(fd);
+			shm_unlink(m_Config.sharedMemoryName.c_str());
+			return;
+		}
+
+		void* mapping = mmap(NULL, memorySize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		close(fd);
+		if (mapping == MAP_FAILED)
+		{
+			LOG_ERROR("Couldn't map shared memory '%s': %s", m_Config.sharedMemoryName.c_str(), strerror(errno));
+			shm_unlink(m_Config.sharedMemoryName.c_str());
+			return;
+		}
+
+		memory = (uint8_t*)mapping;
+		m_IsSharedMemory = true;
+#endif
+	}
+
+	LoadBalancerMemoryHeader* header = (LoadBalancerMemoryHeader*)memory;
+	header->numOfWorkers = m_Config.numOfWorkers;
+	header->ringSize = ringSize;
+	header->slotSize = slotSize;
+	header->memorySize = memorySize;
+	for (uint16_t i = 0; i < m_Config.numOfWorkers; i++)
+		memset(getRing(memory, i), 0, sizeof(LoadBalancerRing));
+	atomicStoreRelease(&header->magic, (uint32_t)LOAD_BALANCER_MAGIC);
+
+	m_Memory = memory;
+	m_MemorySize = memorySize;
+
+	m_WorkerCounters = new WorkerCounters[m_Config.numOfWorkers];
+	memset(m_WorkerCounters, 0, sizeof(WorkerCounters) * m_Config.numOfWorkers);
+
+	m_BucketToWorker.resize(m_Config.numOfBuckets);
+	for (uint32_t i = 0; i < m_Config.numOfBuckets; i++)
+		m_BucketToWorker[i] = (uint16_t)(i % m_Config.numOfWorkers);
+	m_BucketNextWorker = m_BucketToWorker;
+	m_BucketFence.resize(m_Config.numOfBuckets, 0);
+	m_BucketPackets.resize(m_Config.numOfBuckets, 0);
+
+	LOG_DEBUG("Load balancer created with %d workers of %u packets%s", m_Config.numOfWorkers, ringSize, m_IsSharedMemory ? " in shared memory" : "");
+}
+
+PacketLoadBalancer::~PacketLoadBalancer()
+{
+	freeMemory();
+	delete [] m_WorkerCounters;
+}
+
+void PacketLoadBalancer::freeMemory()
+{
+	if (m_Memory == NULL)
+		return;
+
+#if !defined(WIN32) && !defined(WINx64) && !defined(PCAPPP_MINGW_ENV)
+	if (m_IsSharedMemory)
+	{
+		munmap(m_Memory, m_MemorySize);
+		shm_unlink(m_Config.sharedMemoryName.c_str());
+		m_Memory = NULL;
+		return;
+	}
+#endif
+
+	delete [] m_Memory;
+	m_Memory = NULL;
+}
+
+uint32_t PacketLoadBalancer::getFlowHash(const RawPacket& rawPacket)
+{
+	// the packet isn't modified by parsing, and only the layers up to the transport layer are needed
+	Packet packet(const_cast<RawPacket*>(&rawPacket), false, UnknownProtocol, OsiModelTransportLayer);
+	uint32_t hash = hash5Tuple(&packet, false);
+	if (hash == 0)
+		hash = hash2Tuple(&packet);
+
+	return hash;
+}
+
+int PacketLoadBalancer::distributePacket(const RawPacket& rawPacket)
+{
+	if (m_Memory == NULL)
+		return -1;
+
+	uint32_t hash = getFlowHash(rawPacket);
+	if (hash == 0)
+		m_PacketsWithoutFlow++;
+
+	return distributePacket(rawPacket, hash);
+}
+
+int PacketLoadBalancer::distributePacket(const RawPacket& rawPacket, uint32_t hash)
+{
+	if (m_Memory == NULL)
+		return -1;
+
+	uint32_t bucket = hash % m_Config.numOfBuckets;
+	uint16_t workerId = m_BucketToWorker[bucket];
+	m_BucketPackets[bucket]++;
+
+	// a moving bucket switches to its new worker once the old worker received all of its packets, so they aren't reordered
+	if (m_BucketNextWorker[bucket] != workerId && (int32_t)(atomicLoadAcquire(&getRing(m_Memory, workerId)->tail) - m_BucketFence[bucket]) >= 0)
+	{
+		workerId = m_BucketNextWorker[bucket];
+		m_BucketToWorker[bucket] = workerId;
+	}
+
+	WorkerCounters& counters = m_WorkerCounters[workerId];
+	LoadBalancerRing* ring = getRing(m_Memory, workerId);
+	uint32_t head = ring->head;
+	if (head - atomicLoadAcquire(&ring->tail) >= m_Config.ringSize)
+	{
+		counters.packetsDropped++;
+		return -1;
+	}
+
+	LoadBalancerSlot* slot = getSlot(m_Memory, ring, head);
+	uint32_t captureLen = (uint32_t)rawPacket.getRawDataLen();
+	if (captureLen > m_Config.maxPacketLen)
+		captureLen = m_Config.maxPacketLen;
+
+	memcpy((uint8_t*)(slot + 1), rawPacket.getRawData(), captureLen);
+	timespec timestamp = rawPacket.getPacketTimeStamp();
+	slot->timestamp = (uint64_t)timestamp.tv_sec * NSEC_PER_SEC + timestamp.tv_nsec;
+	slot->captureLen = captureLen;
+	slot->frameLength = (uint32_t)rawPacket.getFrameLength();
+	slot->linkType = (uint16_t)rawPacket.getLinkLayerType();
+
+	atomicStoreRelease(&ring->head, head + 1);
+	if (m_BucketNextWorker[bucket] != workerId)
+		m_BucketFence[bucket] = head + 1;
+
+	counters.packetsDistributed++;
+	counters.bytesDistributed += captureLen;
+	return workerId;
+}
+
+void PacketLoadBalancer::onPacketArrives(RawPacket* rawPacket, PcapLiveDevice* device, void* balancer)
+{
+	((PacketLoadBalancer*)balancer)->distributePacket(*rawPacket);
+}
+
+uint32_t PacketLoadBalancer::receivePackets(uint16_t workerId, OnBalancedPacketsCallback onPacketsReceived, void* userCookie, uint32_t maxNumOfPackets)
+{
+	if (m_Memory == NULL || workerId >= m_Config.numOfWorkers || onPacketsReceived == NULL)
+		return 0;
+
+	return receiveFromRing(m_Memory, workerId, onPacketsReceived, userCookie, maxNumOfPackets);
+}
+
+uint16_t PacketLoadBalancer::getWorkerOfHash(uint32_t hash) const
+{
+	if (m_Memory == NULL)
+		return 0;
+
+	return m_BucketToWorker[hash % m_Config.numOfBuckets];
+}
+
+uint32_t PacketLoadBalancer::rebalance()
+{
+	if (m_Memory == NULL)
+		return 0;
+
+	uint16_t numOfWorkers = m_Config.numOfWorkers;
+	std::vector<uint64_t> workerPackets(numOfWorkers, 0);
+	for (uint32_t i = 0; i < m_Config.numOfBuckets; i++)
+		workerPackets[m_BucketNextWorker[i]] += m_BucketPackets[i];
+
+	// moving a bucket with less packets than the gap between the busiest worker and the least busy one makes the busiest worker less busy
+	// without making the other worker busier than the busiest was. The bucket closest to half of the gap closes it best. The number of
+	// moves is limited so flows aren't moved needlessly
+	uint32_t numOfBucketsMoved = 0;
+	while (numOfBucketsMoved < m_Config.numOfBuckets)
+	{
+		uint16_t busiest = 0, leastBusy = 0;
+		for (uint16_t i = 1; i < numOfWorkers; i++)
+		{
+			if (workerPackets[i] > workerPackets[busiest])
+				busiest = i;
+			if (workerPackets[i] < workerPackets[leastBusy])
+				leastBusy = i;
+		}
+
+		uint64_t gap = workerPackets[busiest] - workerPackets[leastBusy];
+		int bucketToMove = -1;
+		uint64_t bestDistance = 0;
+		for (uint32_t i = 0; i < m_Config.numOfBuckets; i++)
+		{
+			uint64_t packets = m_BucketPackets[i];
+			if (m_BucketNextWorker[i] != busiest || packets == 0 || packets >= gap)
+				continue;
+
+			uint64_t distance = (2 * packets > gap ? 2 * packets - gap : gap - 2 * packets);
+			if (bucketToMove < 0 || distance < bestDistance)
+			{
+				bucketToMove = (int)i;
+				bestDistance = distance;
+			}
+		}
+
+		if (bucketToMove < 0)
+			break;
+
+		// the packets of the bucket that were already distributed are before the current head of the ring of the worker it's distributed
+		// to. If the bucket is already moving, its fence is kept
+		uint16_t curWorker = m_BucketToWorker[bucketToMove];
+		if (m_BucketNextWorker[bucketToMove] == curWorker)
+			m_BucketFence[bucketToMove] = getRing(m_Memory, curWorker)->head;
+		m_BucketNextWorker[bucketToMove] = leastBusy;
+		workerPackets[busiest] -= m_BucketPackets[bucketToMove];
+		workerPackets[leastBusy] += m_BucketPackets[bucketToMove];
+		numOfBucketsMoved++;
+	}
+
+	for (uint32_t i = 0; i < m_Config.numOfBuckets; i++)
+		m_BucketPackets[i] = 0;
+
+	m_NumOfRebalances++;
+	m_NumOfBucketsMoved += numOfBucketsMoved;
+	LOG_DEBUG("Load balancer moved %u buckets", numOfBucketsMoved);
+	return numOfBucketsMoved;
+}
+
+bool PacketLoadBalancer::getWorkerStatistics(uint16_t workerId, WorkerStats& stats) const
+{
+	memset(&stats, 0, sizeof(WorkerStats));
+	if (m_Memory == NULL || workerId >= m_Config.numOfWorkers)
+		return false;
+
+	stats.packetsDistributed = m_WorkerCounters[workerId].packetsDistributed;
+	stats.bytesDistributed = m_WorkerCounters[workerId].bytesDistributed;
+	stats.packetsDropped = m_WorkerCounters[workerId].packetsDropped;
+
+	LoadBalancerRing* ring = getRing(m_Memory, workerId);
+	stats.packetsQueued = ring->head - atomicLoadAcquire(&ring->tail);
+
+	for (uint32_t i = 0; i < m_Config.numOfBuckets; i++)
+	{
+		if (m_BucketNextWorker[i] == workerId)
+			stats.numOfBuckets++;
+	}
+
+	return true;
+}
+
+void PacketLoadBalancer::getStatistics(Stats& stats) const
+{
+	memset(&stats, 0, sizeof(Stats));
+	if (m_Memory == NULL)
+		return;
+
+	for (uint16_t i = 0; i < m_Config.numOfWorkers; i++)
+	{
+		stats.packetsDistributed += m_WorkerCounters[i].packetsDistributed;
+		stats.packetsDropped += m_WorkerCounters[i].packetsDropped;
+	}
+
+	stats.packetsWithoutFlow = m_PacketsWithoutFlow;
+	stats.numOfRebalances = m_NumOfRebalances;
+	stats.numOfBucketsMoved = m_NumOfBucketsMoved;
+
+	std::vector<uint64_t> workerPackets(m_Config.numOfWorkers, 0);
+	uint64_t totalPackets = 0;
+	for (uint32_t i = 0; i < m_Config.numOfBuckets; i++)
+	{
+		workerPackets[m_BucketToWorker[i]] += m_BucketPackets[i];
+		totalPackets += m_BucketPackets[i];
+		if (m_BucketPackets[i] > m_BucketPackets[stats.busiestBucket])
+			stats.busiestBucket = i;
+	}
+
+	if (totalPackets == 0)
+		return;
+
+	uint64_t busiestWorkerPackets = 0;
+	for (uint16_t i = 0; i < m_Config.numOfWorkers; i++)
+	{
+		if (workerPackets[i] > busiestWorkerPackets)
+			busiestWorkerPackets = workerPackets[i];
+	}
+
+	stats.imbalance = (double)busiestWorkerPackets * m_Config.numOfWorkers / totalPackets;
+	stats.busiestBucketShare = (double)m_BucketPackets[stats.busiestBucket] / totalPackets;
+}
+
+
+PacketLoadBalancerWorker::PacketLoadBalancerWorker(const std::string& sharedMemoryName, uint16_t workerId) :
+	m_Memory(NULL), m_MemorySize(0), m_WorkerId(workerId)
+{
+#if defined(WIN32) || defined(WINx64) || defined(PCAPPP_MINGW_ENV)
+	LOG_ERROR("Load balancer shared memory isn't supported on Windows");
+#else
+	int fd = shm_open(sharedMemoryName.c_str(), O_RDWR, 0);
+	if (fd < 0)
+	{
+		LOG_ERROR("Couldn't open shared memory '%s': %s", sharedMemoryName.c_str(), strerror(errno));
+		return;
+	}
+
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) != 0 || (size_t)fileStat.st_size < sizeof(LoadBalancerMemoryHeader))
+	{
+		LOG_ERROR("Shared memory '%s' isn't a load balancer", sharedMemoryName.c_str());
+		close(fd);
+		return;
+	}
+
+	size_t memorySize = (size_t)fileStat.st_size;
+	void* mapping = mmap(NULL, memorySize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (mapping == MAP_FAILED)
+	{
+		LOG_ERROR("Couldn't map shared memory '%s': %s", sharedMemoryName.c_str(), strerror(errno));
+		return;
+	}
+
+	LoadBalancerMemoryHeader* header = (LoadBalancerMemoryHeader*)mapping;
+	if (atomicLoadAcquire(&header->magic) != LOAD_BALANCER_MAGIC || header->memorySize != memorySize)
+	{
+		LOG_ERROR("Shared memory '%s' isn't a load balancer", sharedMemoryName.c_str());
+		munmap(mapping, memorySize);
+		return;
+	}
+
+	if (workerId >= header->numOfWorkers)
+	{
+		LOG_ERROR("Worker ID %d is invalid, the load balancer has %u workers", workerId, header->numOfWorkers);
+		munmap(mapping, memorySize);
+		return;
+	}
+
+	m_Memory = (uint8_t*)mapping;
+	m_MemorySize = memorySize;
+	LOG_DEBUG("Worker %d attached to load balancer '%s'", workerId, sharedMemoryName.c_str());
+#endif
+}
+
+PacketLoadBalancerWorker::~PacketLoadBalancerWorker()
+{
+#if !defined(WIN32) && !defined(WINx64) && !defined(PCAPPP_MINGW_ENV)
+	if (m_Memory != NULL)
+		munmap(m_Memory, m_MemorySize);
+#endif
+}
+
+uint32_t PacketLoadBalancerWorker::receivePackets(OnBalancedPacketsCallback onPacketsReceived, void* userCookie, uint32_t maxNumOfPackets)
+{
+	if (m_Memory == NULL || onPacketsReceived == NULL)
+		return 0;
+
+	return receiveFromRing(m_Memory, m_WorkerId, onPacketsReceived, userCookie, maxNumOfPackets);
+}
+
+} // namespace pcpp
@@ -0,0 +1,442 @@
+#define LOG_MODULE PcapLogModulePacketMerger
+
+#include "PacketMerger.h"
+#include "Logger.h"
+#include <pthread.h>
+#include <string.h>
+#include <new>
+#if defined(WIN32) || defined(WINx64) || defined(PCAPPP_MINGW_ENV)
+#include <windows.h>
+#include "SystemUtils.h"
+#else
+#include <time.h>
+#endif
+
+#define NSEC_PER_SEC 1000000000ULL
+
+namespace pcpp
+{
+
+// the capture thread of a source and the merge thread share the ring indices and the source watermark. Slots are written by the capture
+// thread before the head index is published and read by the merge thread before the tail index is published
+
+#if defined(_MSC_VER)
+
+template<typename T>
+static inline T atomicLoadAcquire(const volatile T* ptr) { T value = *ptr; _ReadWriteBarrier(); return value; }
+template<typename T>
+static inline void atomicStoreRelease(volatile T* ptr, T value) { _ReadWriteBarrier(); *ptr = value; }
+
+#else
+
+template<typename T>
+static inline T atomicLoadAcquire(const volatile T* ptr) { return __atomic_load_n(ptr, __ATOMIC_ACQUIRE); }
+template<typename T>
+static inline void atomicStoreRelease(volatile T* ptr, T value) { __atomic_store_n(ptr, value, __ATOMIC_RELEASE); }
+
+#endif
+
+static uint64_t getMonotonicTimeNsec()
+{
+#if defined(WIN32) || defined(WINx64) || defined(PCAPPP_MINGW_ENV)
+	long sec = 0, nsec = 0;
+	clockGetTime(sec, nsec);
+	return (uint64_t)sec * NSEC_PER_SEC + (uint64_t)nsec;
+#else
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * NSEC_PER_SEC + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static uint64_t timespecToNsec(const timespec& ts)
+{
+	return (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+static timespec nsecToTimespec(uint64_t nsec)
+{
+	timespec ts;
+	ts.tv_sec = nsec / NSEC_PER_SEC;
+	ts.tv_nsec = nsec % NSEC_PER_SEC;
+	return ts;
+}
+
+struct PacketMerger::Slot
+{
+	uint64_t timestamp;
+	// the monotonic time the packet was added, for measuring the latency
+	uint64_t addedTime;
+	uint32_t captureLen;
+	uint32_t frameLength;
+	LinkLayerType linkType;
+	uint8_t* data;
+};
+
+struct PacketMerger::Source
+{
+	Slot* slots;
+	uint8_t* data;
+
+	// written by the capture thread
+	volatile uint32_t head;
+	volatile uint64_t watermark;
+	// the latest timestamp of a packet added to the source. The watermark may be later if it was advanced by the user
+	volatile uint64_t latestTimestamp;
+	volatile uint64_t packetsAdded;
+	volatile uint64_t packetsDropped;
+	volatile uint64_t packetsTruncated;
+
+	// keeps the capture thread fields and the merge thread fields in different cache lines
+	uint8_t padding[64];
+
+	// written by the merge thread
+	volatile uint32_t tail;
+	// the next slot to emit, it's published to tail after the batch is handed to the callback
+	uint32_t readPos;
+	// the head and the watermark as read at the beginning of the current batch
+	uint32_t headSnapshot;
+	uint64_t watermarkSnapshot;
+};
+
+struct PacketMergerThreadData
+{
+	pthread_t thread;
+	volatile bool stopThread;
+	OnPacketsMergedCallback onPacketsMerged;
+	void* userCookie;
+	PollingController pollingController;
+};
+
+
+PacketMerger::PacketMerger(const Config& config) : m_Config(config), m_QueueMask(0), m_Sources(NULL), m_BatchPackets(NULL),
+	m_LastEmittedTimestamp(0), m_PacketsEmitted(0), m_PacketsLate(0), m_BatchesEmitted(0), m_TotalLatencyNsec(0), m_MaxLatencyNsec(0),
+	m_ThreadData(NULL)
+{
+	if (m_Config.numOfSources == 0 || m_Config.queueSize == 0 || m_Config.queueSize > 0x80000000 || m_Config.maxPacketLen == 0 || m_Config.maxBatchSize == 0)
+	{
+		LOG_ERROR("Invalid packet merger configuration: number of sources, queue size, max packet length and max batch size must be positive");
+		return;
+	}
+
+	uint32_t queueSize = 1;
+	while (queueSize < m_Config.queueSize)
+		queueSize <<= 1;
+	m_Config.queueSize = queueSize;
+	m_QueueMask = queueSize - 1;
+
+	Source* sources = new Source[m_Config.numOfSources];
+	memset(sources, 0, sizeof(Source) * m_Config.numOfSources);
+	for (uint16_t i = 0; i < m_Config.numOfSources; i++)
+	{
+		sources[i].data = new (std::nothrow) uint8_t[(size_t)queueSize * m_Config.maxPacketLen];
+		if (sources[i].data == NULL)
+		{
+			LOG_ERROR("Couldn't allocate %llu bytes for the packet merger",
+					(unsigned long long)queueSize * m_Config.maxPacketLen * m_Config.numOfSources);
+			for (uint16_t j = 0; j < i; j++)
+			{
+				delete [] sources[j].data;
+				delete [] sources[j].slots;
+			}
+			delete [] sources;
+			return;
+		}
+
+		sources[i].slots = new Slot[queueSize];
+		for (uint32_t j = 0; j < queueSize; j++)
+			sources[i].slots[j].data = sources[i].data + (size_t)j * m_Config.maxPacketLen;
+	}
+
+	m_Sources = sources;
+	m_BatchPackets = new uint8_t[m_Config.maxBatchSize * sizeof(RawPacket)];
+	LOG_DEBUG("Packet merger created with %d sources of %u packets", m_Config.numOfSources, queueSize);
+}
+
+PacketMerger::~PacketMerger()
+{
+	stop();
+
+	if (m_Sources != NULL)
+	{
+		for (uint16_t i = 0; i < m_Config.numOfSources; i++)
+		{
+			delete [] m_Sources[i].data;
+			delete [] m_Sources[i].slots;
+		}
+		delete [] m_Sources;
+	}
+
+	delete [] m_BatchPackets;
+}
+
+bool PacketMerger::addPacket(const RawPacket& rawPacket, uint16_t source)
+{
+	if (m_Sources == NULL || source >= m_Config.numOfSources)
+		return false;
+
+	Source& src = m_Sources[source];
+	uint32_t head = src.head;
+	if (head - atomicLoadAcquire(&src.tail) > m_QueueMask)
+	{
+		src.packetsDropped++;
+		return false;
+	}
+
+	Slot& slot = src.slots[head & m_QueueMask];
+	uint32_t captureLen = (uint32_t)rawPacket.getRawDataLen();
+	if (captureLen > m_Config.maxPacketLen)
+	{
+		captureLen = m_Config.maxPacketLen;
+		src.packetsTruncated++;
+	}
+
+	memcpy(slot.data, rawPacket.getRawData(), captureLen);
+	slot.captureLen = captureLen;
+	slot.frameLength = (uint32_t)rawPacket.getFrameLength();
+	slot.linkType = rawPacket.getLinkLayerType();
+	slot.timestamp = timespecToNsec(rawPacket.getPacketTimeStamp());
+	slot.addedTime = getMonotonicTimeNsec();
+
+	atomicStoreRelease(&src.head, head + 1);
+	if (slot.timestamp > src.latestTimestamp)
+		atomicStoreRelease(&src.latestTimestamp, slot.timestamp);
+	if (slot.timestamp > src.watermark)
+		atomicStoreRelease(&src.watermark, slot.timestamp);
+	src.packetsAdded++;
+	return true;
+}
+
+uint32_t PacketMerger::addPackets(const RawPacket* packets, uint32_t numOfPackets, uint16_t source)
+{
+	uint32_t numOfPacketsAdded = 0;
+	for (uint32_t i = 0; i < numOfPackets; i++)
+	{
+		if (addPacket(packets[i], source))
+			numOfPacketsAdded++;
+	}
+
+	return numOfPacketsAdded;
+}
+
+void PacketMerger::advanceWatermark(uint16_t source, const timespec& timestamp)
+{
+	if (m_Sources == NULL || source >= m_Config.numOfSources)
+		return;
+
+	uint64_t watermark = timespecToNsec(timestamp);
+	if (watermark > m_Sources[source].watermark)
+		atomicStoreRelease(&m_Sources[source].watermark, watermark);
+}
+
+uint32_t PacketMerger::emitBatch(OnPacketsMergedCallback onPacketsMerged, void* userCookie, bool flush)
+{
+	uint16_t numOfSources = m_Config.numOfSources;
+
+	// the watermark of a source is read before its head, so all packets up to the watermark are seen as queued. Packets added after the
+	// head was read have a timestamp at or after the watermark
+	uint64_t latestTimestamp = 0;
+	for (uint16_t i = 0; i < numOfSources; i++)
+	{
+		Source& src = m_Sources[i];
+		src.watermarkSnapshot = atomicLoadAcquire(&src.watermark);
+		uint64_t srcLatestTimestamp = atomicLoadAcquire(&src.latestTimestamp);
+		src.headSnapshot = atomicLoadAcquire(&src.head);
+		if (srcLatestTimestamp > latestTimestamp)
+			latestTimestamp = srcLatestTimestamp;
+	}
+
+	uint64_t now = getMonotonicTimeNsec();
+	RawPacket* batch = (RawPacket*)m_BatchPackets;
+	uint32_t batchSize = 0;
+	while (batchSize < m_Config.maxBatchSize)
+	{
+		// find the earliest packet among the heads of all rings
+		int minSource = -1;
+		uint64_t minTimestamp = 0;
+		for (uint16_t i = 0; i < numOfSources; i++)
+		{
+			Source& src = m_Sources[i];
+			if (src.readPos == src.headSnapshot)
+				continue;
+
+			uint64_t timestamp = src.slots[src.readPos & m_QueueMask].timestamp;
+			if (minSource < 0 || timestamp < minTimestamp)
+			{
+				minSource = i;
+				minTimestamp = timestamp;
+			}
+		}
+
+		if (minSource < 0)
+			break;
+
+		Source& src = m_Sources[minSource];
+		Slot& slot = src.slots[src.readPos & m_QueueMask];
+
+		bool ready = flush || minTimestamp + m_Config.reorderWindowNsec <= latestTimestamp || now - slot.addedTime >= m_Config.reorderWindowNsec;
+		if (!ready)
+		{
+			// the packet is in order if no source can add an earlier packet
+			ready = true;
+			for (uint16_t i = 0; i < numOfSources; i++)
+			{
+				Source& other = m_Sources[i];
+				if (other.readPos == other.headSnapshot && other.watermarkSnapshot < minTimestamp)
+				{
+					ready = false;
+					break;
+				}
+			}
+		}
+
+		if (!ready)
+			break;
+
+		new (&batch[batchSize]) RawPacket(slot.data, (int)slot.captureLen, nsecToTimespec(slot.timestamp), false, slot.linkType);
+		batch[batchSize].setRawData(slot.data, (int)slot.captureLen, nsecToTimespec(slot.timestamp), slot.linkType, (int)slot.frameLength);
+		batchSize++;
+		src.readPos++;
+
+		uint64_t latency = now - slot.addedTime;
+		m_TotalLatencyNsec += latency;
+		if (latency > m_MaxLatencyNsec)
+			m_MaxLatencyNsec = latency;
+
+		if (minTimestamp < m_LastEmittedTimestamp)
+			m_PacketsLate++;
+		else
+			m_LastEmittedTimestamp = minTimestamp;
+	}
+
+	if (batchSize == 0)
+		return 0;
+
+	onPacketsMerged(batch, batchSize, this, userCookie);
+
+	for (uint32_t i = 0; i < batchSize; i++)
+		batch[i].~RawPacket();
+
+	// the slots of the batch can be reused only now that the callback returned
+	for (uint16_t i = 0; i < numOfSources; i++)
+	{
+		if (m_Sources[i].tail != m_Sources[i].readPos)
+			atomicStoreRelease(&m_Sources[i].tail, m_Sources[i].readPos);
+	}
+
+	m_PacketsEmitted += batchSize;
+	m_BatchesEmitted++;
+	return batchSize;
+}
+
+uint32_t PacketMerger::mergePackets(OnPacketsMergedCallback onPacketsMerged, void* userCookie, bool flush)
+{
+	if (m_Sources == NULL || onPacketsMerged == NULL)
+		return 0;
+
+	uint32_t numOfPacketsEmitted = 0;
+	uint32_t batchSize;
+	while ((batchSize = emitBatch(onPacketsMerged, userCookie, flush)) > 0)
+		numOfPacketsEmitted += batchSize;
+
+	return numOfPacketsEmitted;
+}
+
+void* PacketMerger::mergeThreadMain(void* ptr)
+{
+	PacketMerger* merger = (PacketMerger*)ptr;
+	PacketMergerThreadData* threadData = merger->m_ThreadData;
+
+	while (!atomicLoadAcquire(&threadData->stopThread))
+	{
+		uint32_t numOfPackets = merger->mergePackets(threadData->onPacketsMerged, threadData->userCookie);
+		threadData->pollingController.onPoll(numOfPackets);
+	}
+
+	merger->mergePackets(threadData->onPacketsMerged, threadData->userCookie, true);
+	return NULL;
+}
+
+bool PacketMerger::start(OnPacketsMergedCallback onPacketsMerged, void* userCookie)
+{
+	if (m_Sources == NULL)
+	{
+		LOG_ERROR("Packet merger isn't valid");
+		return false;
+	}
+
+	if (m_ThreadData != NULL)
+	{
+		LOG_ERROR("Packet merger is already started");
+		return false;
+	}
+
+	if (onPacketsMerged == NULL)
+	{
+		LOG_ERROR("Callback is NULL");
+		return false;
+	}
+
+	m_ThreadData = new PacketMergerThreadData();
+	m_ThreadData->stopThread = false;
+	m_ThreadData->onPacketsMerged = onPacketsMerged;
+	m_ThreadData->userCookie = userCookie;
+	m_ThreadData->pollingController.reset(m_Config.pollingPolicy);
+	// there is no device to wait for an interrupt from
+	if (m_Config.pollingPolicy.mode == PollingModeInterrupt)
+		m_ThreadData->pollingController.fallBackToBackoff();
+
+	int err = pthread_create(&m_ThreadData->thread, NULL, mergeThreadMain, (void*)this);
+	if (err != 0)
+	{
+		delete m_ThreadData;
+		m_ThreadData = NULL;
+		LOG_ERROR("Couldn't create the packet merger thread, error code is %d", err);
+		return false;
+	}
+
+	LOG_DEBUG("Packet merger thread started");
+	return true;
+}
+
+void PacketMerger::stop()
+{
+	if (m_ThreadData == NULL)
+		return;
+
+	atomicStoreRelease(&m_ThreadData->stopThread, true);
+	pthread_join(m_ThreadData->thread, NULL);
+	delete m_ThreadData;
+	m_ThreadData = NULL;
+	LOG_DEBUG("Packet merger thread stopped");
+}
+
+void PacketMerger::getStatistics(Stats& stats) const
+{
+	memset(&stats, 0, sizeof(Stats));
+	if (m_Sources == NULL)
+		return;
+
+	for (uint16_t i = 0; i < m_Config.numOfSources; i++)
+	{
+		stats.packetsAdded += m_Sources[i].packetsAdded;
+		stats.packetsDropped += m_Sources[i].packetsDropped;
+		stats.packetsTruncated += m_Sources[i].packetsTruncated;
+	}
+
+	stats.packetsEmitted = m_PacketsEmitted;
+	stats.packetsLate = m_PacketsLate;
+	stats.batchesEmitted = m_BatchesEmitted;
+	stats.totalLatencyNsec = m_TotalLatencyNsec;
+	stats.maxLatencyNsec = m_MaxLatencyNsec;
+}
+
+PollingStats PacketMerger::getPollingStats() const
+{
+	if (m_ThreadData == NULL)
+		return PollingStats();
+
+	return m_ThreadData->pollingController.getStats();
+}
+
+} // namespace pcpp
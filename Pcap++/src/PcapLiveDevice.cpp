@@ -53,6 +53,21 @@ struct PcapThread
 	pthread_t pthread;
 };
 
+struct PcapMutex
+{
+	pthread_mutex_t mutex;
+};
+
+// locks a PcapMutex for the scope it's defined in
+class PcapMutexLock
+{
+public:
+	PcapMutexLock(PcapMutex* mutex) : m_Mutex(mutex) { pthread_mutex_lock(&m_Mutex->mutex); }
+	~PcapMutexLock() { pthread_mutex_unlock(&m_Mutex->mutex); }
+private:
+	PcapMutex* m_Mutex;
+};
+
 #ifdef HAS_SET_DIRECTION_ENABLED
 static pcap_direction_t directionTypeMap(PcapLiveDevice::PcapDirection direction)
 {
@@ -68,7 +83,8 @@ static pcap_direction_t directionTypeMap(PcapLiveDevice::PcapDirection direction
 
 
 PcapLiveDevice::PcapLiveDevice(pcap_if_t* pInterface, bool calculateMTU, bool calculateMacAddress, bool calculateDefaultGateway) : IPcapDevice(),
-		m_MacAddress(""), m_DefaultGateway(IPv4Address::Zero)
+		m_MacAddress(""), m_DefaultGateway(IPv4Address::Zero),
+		m_DeviceMtuPending(calculateMTU), m_MacAddressPending(calculateMacAddress), m_DefaultGatewayPending(calculateDefaultGateway)
 {
 	m_Name = NULL;
 	m_Description = NULL;
@@ -91,34 +107,25 @@ PcapLiveDevice::PcapLiveDevice(pcap_if_t* pInterface, bool calculateMTU, bool ca
 		strncpy((char*)m_Description, "", strLength);
 	LOG_DEBUG("Added live device: name=%s; desc=%s", m_Name, m_Description);
 	LOG_DEBUG("   Addresses:");
-	while (pInterface->addresses != NULL)
+	for (pcap_addr_t* curAddress = pInterface->addresses; curAddress != NULL; curAddress = curAddress->next)
 	{
-		m_Addresses.insert(m_Addresses.end(), *(pInterface->addresses));
-		pInterface->addresses = pInterface->addresses->next;
-		if (LoggerPP::getInstance().isDebugEnabled(PcapLogModuleLiveDevice) && pInterface->addresses != NULL && pInterface->addresses->addr != NULL)
+		m_Addresses.insert(m_Addresses.end(), *curAddress);
+		if (LoggerPP::getInstance().isDebugEnabled(PcapLogModuleLiveDevice) && curAddress->addr != NULL)
 		{
 			char addrAsString[INET6_ADDRSTRLEN];
-			internal::sockaddr2string(pInterface->addresses->addr, addrAsString);
+			internal::sockaddr2string(curAddress->addr, addrAsString);
 			LOG_DEBUG("      %s", addrAsString);
 		}
 	}
 
-	if (calculateMTU)
-	{
-		setDeviceMtu();
-		LOG_DEBUG("   MTU: %d", (int)m_DeviceMtu);
-	}
-
-	if (calculateDefaultGateway)
-	{
-		setDefaultGateway();
-		LOG_DEBUG("   Default Gateway: %s", m_DefaultGateway.toString().c_str());
-	}
+	// MTU, MAC address and default gateway require system calls (and on some platforms running shell commands), they are retrieved
+	// only when they're first needed. The getters may be called from several threads, so the retrieval is done under a mutex
+	m_AttributesMutex = new PcapMutex();
+	pthread_mutex_init(&m_AttributesMutex->mutex, NULL);
 
 	//init all other members
 	m_CaptureThreadStarted = false;
 	m_StatsThreadStarted = false;
-	m_IsLoopback = false;
 	m_StopThread = false;
 	m_CaptureThread = new PcapThread();
 	m_StatsThread = new PcapThread();
@@ -133,12 +140,6 @@ PcapLiveDevice::PcapLiveDevice(pcap_if_t* pInterface, bool calculateMTU, bool ca
 	m_cbOnStatsUpdateUserCookie = NULL;
 	m_CaptureCallbackMode = true;
 	m_CapturedPackets = NULL;
-	if (calculateMacAddress)
-	{
-		setDeviceMacAddress();
-		if (m_MacAddress.isValid())
-			LOG_DEBUG("   MAC addr: %s", m_MacAddress.toString().c_str());
-	}
 }
 
 void PcapLiveDevice::onPacketArrives(uint8_t* user, const struct pcap_pkthdr* pkthdr, const uint8_t* packet)
@@ -348,6 +349,9 @@ bool PcapLiveDevice::open(const DeviceConfiguration& config)
 
 	LOG_DEBUG("Device '%s' opened", m_Name);
 
+	// sendPacket() checks packets against the MTU without locking, so it's retrieved before any packet can be sent
+	setDeviceMtu();
+
 	m_DeviceOpened = true;
 
 	return true;
@@ -664,8 +668,14 @@ std::string PcapLiveDevice::printThreadId(PcapThread* id)
 	return result;
 }
 
-void PcapLiveDevice::setDeviceMtu()
+void PcapLiveDevice::setDeviceMtu() const
 {
+	PcapMutexLock lock(m_AttributesMutex);
+	if (!m_DeviceMtuPending)
+		return;
+
+	m_DeviceMtuPending = false;
+
 #if defined(WIN32) || defined(WINx64) || defined(PCAPPP_MINGW_ENV)
 
 	if (m_IsLoopback)
@@ -715,7 +725,9 @@ void PcapLiveDevice::setDeviceMtu()
 	strncpy(ifr.ifr_name, m_Name, sizeof(ifr.ifr_name) - 1);
 
 	int socketfd = socket(AF_INET, SOCK_DGRAM, IPPROTO_IP);
-	if (ioctl(socketfd, SIOCGIFMTU, &ifr) == -1)
+	int ioctlRes = ioctl(socketfd, SIOCGIFMTU, &ifr);
+	::close(socketfd);
+	if (ioctlRes == -1)
 	{
 		LOG_DEBUG("Error in retrieving MTU: ioctl() returned -1");
 		m_DeviceMtu = 0;
@@ -724,10 +736,18 @@ void PcapLiveDevice::setDeviceMtu()
 
 	m_DeviceMtu = ifr.ifr_mtu;
 #endif
+
+	LOG_DEBUG("Device '%s' MTU: %d", m_Name, (int)m_DeviceMtu);
 }
 
-void PcapLiveDevice::setDeviceMacAddress()
+void PcapLiveDevice::setDeviceMacAddress() const
 {
+	PcapMutexLock lock(m_AttributesMutex);
+	if (!m_MacAddressPending)
+		return;
+
+	m_MacAddressPending = false;
+
 #if defined(WIN32) || defined(WINx64) || defined(PCAPPP_MINGW_ENV)
 
 	LPADAPTER adapter = PacketOpenAdapter((char*)m_Name);
@@ -771,7 +791,9 @@ void PcapLiveDevice::setDeviceMacAddress()
 	strncpy(ifr.ifr_name, m_Name, sizeof(ifr.ifr_name) - 1);
 
 	int socketfd = socket(AF_INET, SOCK_DGRAM, IPPROTO_IP);
-	if (ioctl(socketfd, SIOCGIFHWADDR, &ifr) == -1)
+	int ioctlRes = ioctl(socketfd, SIOCGIFHWADDR, &ifr);
+	::close(socketfd);
+	if (ioctlRes == -1)
 	{
 		LOG_DEBUG("Error in retrieving MAC address: ioctl() returned -1");
 		return;
@@ -813,8 +835,14 @@ void PcapLiveDevice::setDeviceMacAddress()
 #endif
 }
 
-void PcapLiveDevice::setDefaultGateway()
+void PcapLiveDevice::setDefaultGateway() const
 {
+	PcapMutexLock lock(m_AttributesMutex);
+	if (!m_DefaultGatewayPending)
+		return;
+
+	m_DefaultGatewayPending = false;
+
 #if defined(WIN32) || defined(WINx64) || defined(PCAPPP_MINGW_ENV)
 	ULONG outBufLen = sizeof (IP_ADAPTER_INFO);
 	uint8_t* buffer = new uint8_t[outBufLen];
@@ -923,6 +951,7 @@ IPv4Address PcapLiveDevice::getIPv4Address() const
 
 IPv4Address PcapLiveDevice::getDefaultGateway() const
 {
+	setDefaultGateway();
 	return m_DefaultGateway;
 }
 
@@ -944,6 +973,8 @@ PcapLiveDevice::~PcapLiveDevice()
 		delete [] m_Description;
 	delete m_CaptureThread;
 	delete m_StatsThread;
+	pthread_mutex_destroy(&m_AttributesMutex->mutex);
+	delete m_AttributesMutex;
 }
 
 } // namespace pcpp
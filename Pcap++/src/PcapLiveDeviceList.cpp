@@ -7,6 +7,7 @@
 #include "pcap.h"
 #include <string.h>
 #include <sstream>
+#include <fstream>
 #include <algorithm>
 #if defined(WIN32) || defined(WINx64)
 #include <ws2tcpip.h>
@@ -22,32 +23,58 @@
 namespace pcpp
 {
 
-PcapLiveDeviceList::PcapLiveDeviceList()
+PcapLiveDeviceList::PcapLiveDeviceList() : m_InterfaceList(NULL), m_LiveDeviceListInitialized(false), m_DnsServersInitialized(false)
 {
-	init();
+	// devices and DNS servers are fetched on first access
 }
 
 PcapLiveDeviceList::~PcapLiveDeviceList()
+{
+	clear();
+}
+
+void PcapLiveDeviceList::clear()
 {
 	for(std::vector<PcapLiveDevice*>::iterator devIter = m_LiveDeviceList.begin(); devIter != m_LiveDeviceList.end(); devIter++)
 	{
 		delete (*devIter);
 	}
+
+	m_LiveDeviceList.clear();
+
+	if (m_InterfaceList != NULL)
+	{
+		LOG_DEBUG("Freeing live device data");
+		pcap_freealldevs(m_InterfaceList);
+		m_InterfaceList = NULL;
+	}
+
+	m_LiveDeviceListInitialized = false;
+
+	m_DnsServers.clear();
+	m_DnsServersInitialized = false;
 }
 
-void PcapLiveDeviceList::init()
+void PcapLiveDeviceList::init() const
 {
-	pcap_if_t* interfaceList;
+	if (m_LiveDeviceListInitialized)
+		return;
+
+	m_LiveDeviceListInitialized = true;
+
 	char errbuf[PCAP_ERRBUF_SIZE];
-	int err = pcap_findalldevs(&interfaceList, errbuf);
+	int err = pcap_findalldevs(&m_InterfaceList, errbuf);
 	if (err < 0)
 	{
 		LOG_ERROR("Error searching for devices: %s", errbuf);
+		m_InterfaceList = NULL;
+		return;
 	}
 
 	LOG_DEBUG("Pcap lib version info: %s", IPcapDevice::getPcapLibVersionInfo().c_str());
 
-	pcap_if_t* currInterface = interfaceList;
+	// the interface list is freed only when the devices are deleted because devices point to the addresses it holds
+	pcap_if_t* currInterface = m_InterfaceList;
 	while (currInterface != NULL)
 	{
 #ifdef WIN32
@@ -58,15 +85,15 @@ void PcapLiveDeviceList::init()
 		currInterface = currInterface->next;
 		m_LiveDeviceList.insert(m_LiveDeviceList.end(), dev);
 	}
-
-	setDnsServers();
-
-	LOG_DEBUG("Freeing live device data");
-	pcap_freealldevs(interfaceList);
 }
 
-void PcapLiveDeviceList::setDnsServers()
+void PcapLiveDeviceList::setDnsServers() const
 {
+	if (m_DnsServersInitialized)
+		return;
+
+	m_DnsServersInitialized = true;
+
 #if defined(WIN32) || defined(WINx64)
 	FIXED_INFO * fixedInfo;
 	ULONG    ulOutBufLen;
@@ -103,43 +130,34 @@ void PcapLiveDeviceList::setDnsServers()
 
 	delete[] buf2;
 #elif LINUX
-	// verify that nmcli exist
-	std::string command = "command -v nmcli >/dev/null 2>&1 || { echo 'nmcli not installed'; }";
-	std::string nmcliExists = executeShellCommand(command);
-	if (nmcliExists != "")
+	// the kernel has no notion of DNS servers (so netlink can't provide them), they're configured in resolv.conf. When systemd-resolved manages
+	// /etc/resolv.conf it only points to the local stub resolver, and the upstream servers are listed in the resolv.conf systemd-resolved maintains
+	const char* resolvConfFiles[] = { "/run/systemd/resolve/resolv.conf", "/etc/resolv.conf" };
+	std::ifstream resolvConf;
+	for (size_t fileIndex = 0; fileIndex < sizeof(resolvConfFiles)/sizeof(resolvConfFiles[0]) && !resolvConf.is_open(); fileIndex++)
 	{
-		LOG_DEBUG("Error retrieving DNS server list: nmcli doesn't exist");
-		return;
+		resolvConf.open(resolvConfFiles[fileIndex]);
+		if (resolvConf.is_open())
+			LOG_DEBUG("Reading DNS servers from '%s'", resolvConfFiles[fileIndex]);
 	}
 
-	// check nmcli major version (0 or 1)
-	command = "nmcli -v | awk -F' ' '{print $NF}' | awk -F'.' '{print $1}'";
-	std::string nmcliMajorVer = executeShellCommand(command);
-	nmcliMajorVer.erase(std::remove(nmcliMajorVer.begin(), nmcliMajorVer.end(), '\n'), nmcliMajorVer.end());
-	LOG_DEBUG("Found nmcli. nmcli major version is: '%s'", nmcliMajorVer.c_str());
-
-	// build nmcli command according to its major version
-	if (nmcliMajorVer == "0")
-		command = "nmcli dev list | grep IP4.DNS";
-	else
-		command = "nmcli dev show | grep IP4.DNS";
-
-	std::string dnsServersInfo = executeShellCommand(command);
-	if (dnsServersInfo == "")
+	if (!resolvConf.is_open())
 	{
-		LOG_DEBUG("Error retrieving DNS server list: call to nmcli gave no output");
+		LOG_DEBUG("Error retrieving DNS server list: couldn't open resolv.conf");
 		return;
 	}
 
-	std::istringstream stream(dnsServersInfo);
 	std::string line;
 	int i = 1;
-	while(std::getline(stream, line))
+	while(std::getline(resolvConf, line))
 	{
 		std::istringstream lineStream(line);
-		std::string headline;
+		std::string keyword;
 		std::string dnsIP;
-		lineStream >> headline;
+		lineStream >> keyword;
+		if (keyword != "nameserver")
+			continue;
+
 		lineStream >> dnsIP;
 		IPv4Address dnsIPAddr(dnsIP);
 		if (!dnsIPAddr.isValid())
@@ -229,6 +247,8 @@ PcapLiveDevice* PcapLiveDeviceList::getPcapLiveDeviceByIp(const IPAddress& ipAdd
 
 PcapLiveDevice* PcapLiveDeviceList::getPcapLiveDeviceByIp(const IPv4Address& ipAddr) const
 {
+	init();
+
 	LOG_DEBUG("Searching all live devices...");
 	for(std::vector<PcapLiveDevice*>::const_iterator devIter = m_LiveDeviceList.begin(); devIter != m_LiveDeviceList.end(); devIter++)
 	{
@@ -262,6 +282,8 @@ PcapLiveDevice* PcapLiveDeviceList::getPcapLiveDeviceByIp(const IPv4Address& ipA
 
 PcapLiveDevice* PcapLiveDeviceList::getPcapLiveDeviceByIp(const IPv6Address& ip6Addr) const
 {
+	init();
+
 	LOG_DEBUG("Searching all live devices...");
 	for(std::vector<PcapLiveDevice*>::const_iterator devIter = m_LiveDeviceList.begin(); devIter != m_LiveDeviceList.end(); devIter++)
 	{
@@ -314,6 +336,8 @@ PcapLiveDevice* PcapLiveDeviceList::getPcapLiveDeviceByIp(const std::string& ipA
 
 PcapLiveDevice* PcapLiveDeviceList::getPcapLiveDeviceByName(const std::string& name) const
 {
+	init();
+
 	LOG_DEBUG("Searching all live devices...");
 	for(std::vector<PcapLiveDevice*>::const_iterator devIter = m_LiveDeviceList.begin(); devIter != m_LiveDeviceList.end(); devIter++)
 	{
@@ -328,15 +352,7 @@ PcapLiveDevice* PcapLiveDeviceList::getPcapLiveDeviceByName(const std::string& n
 
 void PcapLiveDeviceList::reset()
 {
-	for(std::vector<PcapLiveDevice*>::iterator devIter = m_LiveDeviceList.begin(); devIter != m_LiveDeviceList.end(); devIter++)
-	{
-		delete (*devIter);
-	}
-
-	m_LiveDeviceList.clear();
-	m_DnsServers.clear();
-
-	init();
+	clear();
 }
 
 } // namespace pcpp
@@ -58,6 +58,7 @@ PcapRemoteDeviceList* PcapRemoteDeviceList::getRemoteDeviceList(const IPAddress&
 	resultList->setRemoteMachineIpAddress(ipAddress);
 	resultList->setRemoteMachinePort(port);
 	resultList->setRemoteAuthentication(remoteAuth);
+	resultList->m_InterfaceList = interfaceList;
 
 	pcap_if_t* currInterface = interfaceList;
 	while (currInterface != NULL)
@@ -68,7 +69,6 @@ PcapRemoteDeviceList* PcapRemoteDeviceList::getRemoteDeviceList(const IPAddress&
 		currInterface = currInterface->next;
 	}
 
-	pcap_freealldevs(interfaceList);
 	return resultList;
 }
 
@@ -212,6 +212,11 @@ PcapRemoteDeviceList::~PcapRemoteDeviceList()
 		m_RemoteDeviceList.erase(devIter);
 	}
 
+	if (m_InterfaceList != NULL)
+	{
+		pcap_freealldevs(m_InterfaceList);
+	}
+
 	if (m_RemoteAuthentication != NULL)
 	{
 		delete m_RemoteAuthentication;
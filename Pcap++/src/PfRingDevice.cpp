@@ -396,33 +396,26 @@ void PfRingDevice::close()
 	LOG_DEBUG("Device [%s] closed", m_DeviceName);
 }
 
-bool PfRingDevice::initCoreConfigurationByCoreMask(CoreMask coreMask)
+bool PfRingDevice::initCoreConfigurationByCoreMask(const CoreMask& coreMask)
 {
-	int i = 0;
 	int numOfCores = getNumOfCores();
 	clearCoreConfiguration();
-	while ((coreMask != 0) && (i < numOfCores))
+	for (int i = coreMask.getFirstCore(); i >= 0; i = coreMask.getNextCore(i))
 	{
-		if (coreMask & 1)
+		if (i >= numOfCores || i >= MAX_NUM_OF_CORES) // this mean coreMask contains a core that doesn't exist
 		{
-			m_CoreConfiguration[i].IsInUse = true;
+			LOG_ERROR("Trying to use a core [%d] that doesn't exist while machine has %d cores", i, numOfCores);
+			clearCoreConfiguration();
+			return false;
 		}
 
-		coreMask = coreMask >> 1;
-		i++;
-	}
-
-	if (coreMask != 0) // this mean coreMask contains a core that doesn't exist
-	{
-		LOG_ERROR("Trying to use a core [%d] that doesn't exist while machine has %d cores", i, numOfCores);
-		clearCoreConfiguration();
-		return false;
+		m_CoreConfiguration[i].IsInUse = true;
 	}
 
 	return true;
 }
 
-bool PfRingDevice::startCaptureMultiThread(OnPfRingPacketsArriveCallback onPacketsArrive, void* onPacketsArriveUserCookie, CoreMask coreMask)
+bool PfRingDevice::startCaptureMultiThread(OnPfRingPacketsArriveCallback onPacketsArrive, void* onPacketsArriveUserCookie, const CoreMask& coreMask)
 {
 	if (!m_StopThread)
 	{
@@ -560,6 +553,9 @@ void* PfRingDevice::captureThreadMain(void* ptr)
 		return (void*)NULL;
 	}
 
+	PollingController& poller = device->m_CoreConfiguration[coreId].Poller;
+	poller.reset(device->m_PollingPolicy);
+
 	while (!device->m_StopThread)
 	{
 		// if buffer is NULL PF_RING avoids copy of the data
@@ -577,6 +573,12 @@ void* PfRingDevice::captureThreadMain(void* ptr)
 
 		struct pfring_pkthdr pktHdr;
 		int recvRes = pfring_recv(ring, &buffer, bufferLen, &pktHdr, 0);
+		if (poller.onPoll(recvRes > 0 ? 1 : 0) == PollingController::WaitForInterrupt)
+		{
+			pfring_poll(ring, poller.getPolicy().interruptTimeoutMsec);
+			poller.onInterruptWaitDone();
+		}
+
 		if (recvRes > 0)
 		{
 			// if caplen < len it means we don't have the whole packet. Treat this case as packet drop
@@ -600,6 +602,37 @@ void* PfRingDevice::captureThreadMain(void* ptr)
 	return (void*)NULL;
 }
 
+bool PfRingDevice::setPollingPolicy(const PollingPolicy& policy)
+{
+	if (!m_StopThread)
+	{
+		LOG_ERROR("Cannot change the polling policy of device [%s] while capturing", m_DeviceName);
+		return false;
+	}
+
+	m_PollingPolicy = policy;
+	return true;
+}
+
+void PfRingDevice::getPollingStats(SystemCore core, PollingStats& stats) const
+{
+	stats.clear();
+	if (core.Id >= MAX_NUM_OF_CORES || !m_CoreConfiguration[core.Id].IsInUse)
+		return;
+
+	stats = m_CoreConfiguration[core.Id].Poller.getStats();
+}
+
+void PfRingDevice::getPollingStats(PollingStats& stats) const
+{
+	stats.clear();
+	for (int coreId = 0; coreId < MAX_NUM_OF_CORES; coreId++)
+	{
+		if (m_CoreConfiguration[coreId].IsInUse)
+			stats.add(m_CoreConfiguration[coreId].Poller.getStats());
+	}
+}
+
 void PfRingDevice::getThreadStatistics(SystemCore core, PfRingStats& stats) const
 {
 	pfring* ring = NULL;
@@ -866,6 +899,7 @@ void PfRingDevice::CoreConfiguration::clear()
 	Channel = NULL;
 	IsInUse = false;
 	IsAffinitySet = true;
+	Poller.reset(PollingPolicy());
 }
 
 } // namespace pcpp
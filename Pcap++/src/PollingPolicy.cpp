@@ -0,0 +1,147 @@
+#include "PollingPolicy.h"
+#if defined(WIN32) || defined(WINx64) || defined(PCAPPP_MINGW_ENV)
+#include <windows.h>
+#include "SystemUtils.h"
+#else
+#include <time.h>
+#endif
+
+namespace pcpp
+{
+
+static uint64_t getMonotonicTimeNsec()
+{
+#if defined(WIN32) || defined(WINx64) || defined(PCAPPP_MINGW_ENV)
+	long sec = 0, nsec = 0;
+	clockGetTime(sec, nsec);
+	return (uint64_t)sec * 1000000000ULL + (uint64_t)nsec;
+#else
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static void sleepUsec(uint32_t usec)
+{
+#if defined(WIN32) || defined(WINx64) || defined(PCAPPP_MINGW_ENV)
+	// Windows can't sleep less than a millisecond
+	Sleep(usec < 1000 ? 1 : usec / 1000);
+#else
+	timespec ts;
+	ts.tv_sec = usec / 1000000;
+	ts.tv_nsec = (usec % 1000000) * 1000;
+	nanosleep(&ts, NULL);
+#endif
+}
+
+
+void PollingStats::clear()
+{
+	numOfPolls = 0;
+	numOfEmptyPolls = 0;
+	numOfSleeps = 0;
+	numOfInterruptWaits = 0;
+	busyTimeNsec = 0;
+	idleTimeNsec = 0;
+	sleepTimeNsec = 0;
+}
+
+void PollingStats::add(const PollingStats& other)
+{
+	numOfPolls += other.numOfPolls;
+	numOfEmptyPolls += other.numOfEmptyPolls;
+	numOfSleeps += other.numOfSleeps;
+	numOfInterruptWaits += other.numOfInterruptWaits;
+	busyTimeNsec += other.busyTimeNsec;
+	idleTimeNsec += other.idleTimeNsec;
+	sleepTimeNsec += other.sleepTimeNsec;
+}
+
+double PollingStats::getBusyRatio() const
+{
+	uint64_t totalTime = busyTimeNsec + idleTimeNsec + sleepTimeNsec;
+	if (totalTime == 0)
+		return 0;
+
+	return (double)busyTimeNsec / (double)totalTime;
+}
+
+
+PollingController::PollingController(const PollingPolicy& policy)
+{
+	reset(policy);
+}
+
+void PollingController::reset(const PollingPolicy& policy)
+{
+	m_Policy = policy;
+	if (m_Policy.minSleepUsec == 0)
+		m_Policy.minSleepUsec = 1;
+	if (m_Policy.maxSleepUsec < m_Policy.minSleepUsec)
+		m_Policy.maxSleepUsec = m_Policy.minSleepUsec;
+
+	m_Stats.clear();
+	m_LastTimestamp = getMonotonicTimeNsec();
+	m_LastPollHadPackets = false;
+	m_ConsecutiveEmptyPolls = 0;
+	m_CurSleepUsec = m_Policy.minSleepUsec;
+}
+
+void PollingController::fallBackToBackoff()
+{
+	m_Policy.mode = PollingModeBackoff;
+}
+
+PollingController::PollAction PollingController::onPoll(uint32_t numOfPackets)
+{
+	// the time since the previous poll is charged according to the previous poll result: if it returned packets this time was spent
+	// processing them
+	uint64_t now = getMonotonicTimeNsec();
+	if (m_LastPollHadPackets)
+		m_Stats.busyTimeNsec += now - m_LastTimestamp;
+	else
+		m_Stats.idleTimeNsec += now - m_LastTimestamp;
+	m_LastTimestamp = now;
+
+	m_Stats.numOfPolls++;
+	m_LastPollHadPackets = (numOfPackets > 0);
+
+	if (numOfPackets > 0)
+	{
+		m_ConsecutiveEmptyPolls = 0;
+		m_CurSleepUsec = m_Policy.minSleepUsec;
+		return PollAgain;
+	}
+
+	m_Stats.numOfEmptyPolls++;
+
+	if (m_Policy.mode == PollingModeBusySpin || m_ConsecutiveEmptyPolls++ < m_Policy.spinCount)
+		return PollAgain;
+
+	if (m_Policy.mode == PollingModeInterrupt)
+		return WaitForInterrupt;
+
+	sleepUsec(m_CurSleepUsec);
+	m_Stats.numOfSleeps++;
+	m_CurSleepUsec = (m_CurSleepUsec > m_Policy.maxSleepUsec / 2 ? m_Policy.maxSleepUsec : m_CurSleepUsec * 2);
+
+	now = getMonotonicTimeNsec();
+	m_Stats.sleepTimeNsec += now - m_LastTimestamp;
+	m_LastTimestamp = now;
+
+	return PollAgain;
+}
+
+void PollingController::onInterruptWaitDone()
+{
+	uint64_t now = getMonotonicTimeNsec();
+	m_Stats.sleepTimeNsec += now - m_LastTimestamp;
+	m_LastTimestamp = now;
+	m_Stats.numOfInterruptWaits++;
+
+	// spin again after waking up in case more packets follow
+	m_ConsecutiveEmptyPolls = 0;
+}
+
+} // namespace pcpp
@@ -0,0 +1,438 @@
+#define LOG_MODULE PcapLogModuleFileDevice
+
+#include "RotatingPcapFileWriterDevice.h"
+#include "Logger.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <time.h>
+
+namespace pcpp
+{
+
+/**
+ * Work done by the background thread of RotatingPcapFileWriterDevice. Tasks are done in the order they're queued, so a file is always
+ * closed before it's deleted and renamed before it's closed
+ */
+struct RotatingFileWriterTask
+{
+	enum Type
+	{
+		PrepareFile,
+		RenameFile,
+		CloseFile,
+		DeleteFile
+	};
+
+	Type type;
+	std::string fileName;
+	std::string newFileName;
+	AsyncPcapFileWriterDevice* writer;
+
+	RotatingFileWriterTask(Type taskType, const std::string& name, AsyncPcapFileWriterDevice* taskWriter = NULL, const std::string& newName = "") :
+		type(taskType), fileName(name), newFileName(newName), writer(taskWriter) {}
+};
+
+struct RotatingFileWriterData
+{
+	pthread_t workerThread;
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	std::deque<RotatingFileWriterTask> tasks;
+	bool stopWorker;
+
+	// the result of the last PrepareFile task
+	bool prepareDone;
+	AsyncPcapFileWriterDevice* preparedWriter;
+	std::string preparedFileName;
+
+	LinkLayerType linkLayerType;
+	CaptureFileFormat fileFormat;
+	AsyncFileConfiguration ioConfig;
+	uint64_t preallocateSize;
+
+	RotatingFileWriterData() : stopWorker(false), prepareDone(false), preparedWriter(NULL), linkLayerType(LINKTYPE_ETHERNET),
+		fileFormat(CaptureFilePcap), preallocateSize(0)
+	{
+		pthread_mutex_init(&mutex, NULL);
+		pthread_cond_init(&cond, NULL);
+	}
+
+	~RotatingFileWriterData()
+	{
+		pthread_mutex_destroy(&mutex);
+		pthread_cond_destroy(&cond);
+	}
+
+	void addTask(const RotatingFileWriterTask& task)
+	{
+		pthread_mutex_lock(&mutex);
+		tasks.push_back(task);
+		pthread_cond_broadcast(&cond);
+		pthread_mutex_unlock(&mutex);
+	}
+
+	AsyncPcapFileWriterDevice* waitForPreparedWriter(std::string& fileName)
+	{
+		pthread_mutex_lock(&mutex);
+		if (!prepareDone)
+			LOG_DEBUG("Next file isn't ready yet, waiting for it");
+		while (!prepareDone)
+			pthread_cond_wait(&cond, &mutex);
+
+		AsyncPcapFileWriterDevice* writer = preparedWriter;
+		fileName = preparedFileName;
+		preparedWriter = NULL;
+		prepareDone = false;
+		pthread_mutex_unlock(&mutex);
+		return writer;
+	}
+
+	void doTask(RotatingFileWriterTask& task)
+	{
+		switch (task.type)
+		{
+		case RotatingFileWriterTask::PrepareFile:
+		{
+			AsyncPcapFileWriterDevice* writer = new AsyncPcapFileWriterDevice(task.fileName.c_str(), linkLayerType, fileFormat, ioConfig);
+			if (!writer->open())
+			{
+				LOG_ERROR("Couldn't create file '%s'", task.fileName.c_str());
+				delete writer;
+				writer = NULL;
+			}
+			else if (preallocateSize > 0 && !writer->preallocate(preallocateSize))
+				LOG_DEBUG("Couldn't preallocate file '%s'", task.fileName.c_str());
+
+			pthread_mutex_lock(&mutex);
+			preparedWriter = writer;
+			preparedFileName = task.fileName;
+			prepareDone = true;
+			pthread_cond_broadcast(&cond);
+			pthread_mutex_unlock(&mutex);
+			break;
+		}
+
+		case RotatingFileWriterTask::RenameFile:
+			if (rename(task.fileName.c_str(), task.newFileName.c_str()) != 0)
+				LOG_ERROR("Couldn't rename file '%s' to '%s'", task.fileName.c_str(), task.newFileName.c_str());
+			break;
+
+		case RotatingFileWriterTask::CloseFile:
+			task.writer->close();
+			delete task.writer;
+			break;
+
+		case RotatingFileWriterTask::DeleteFile:
+			if (remove(task.fileName.c_str()) != 0)
+				LOG_ERROR("Couldn't delete file '%s'", task.fileName.c_str());
+			break;
+		}
+	}
+};
+
+static void* rotatingFileWriterThreadMain(void* ptr)
+{
+	RotatingFileWriterData* data = (RotatingFileWriterData*)ptr;
+
+	pthread_mutex_lock(&data->mutex);
+	while (true)
+	{
+		while (data->tasks.empty() && !data->stopWorker)
+			pthread_cond_wait(&data->cond, &data->mutex);
+
+		if (data->tasks.empty())
+			break;
+
+		RotatingFileWriterTask task = data->tasks.front();
+		data->tasks.pop_front();
+		pthread_mutex_unlock(&data->mutex);
+		data->doTask(task);
+		pthread_mutex_lock(&data->mutex);
+	}
+	pthread_mutex_unlock(&data->mutex);
+
+	return NULL;
+}
+
+
+RotatingPcapFileWriterDevice::RotatingPcapFileWriterDevice(const char* fileName, const RotatingFileWriterConfiguration& config, LinkLayerType linkLayerType,
+		CaptureFileFormat fileFormat) : IFileWriterDevice(fileName), m_Config(config)
+{
+	m_LinkLayerType = linkLayerType;
+	m_FileFormat = fileFormat;
+	m_Data = NULL;
+	m_CurWriter = NULL;
+	m_CurFileNumber = 0;
+	m_CurFilePackets = 0;
+	m_CurFileStartTime = 0;
+
+	// split the name to prefix and extension the same way dumpcap does: the extension starts at the last dot of the base name
+	std::string name(fileName);
+	size_t lastSeparator = name.find_last_of("/\\");
+	size_t lastDot = name.rfind('.');
+	if (lastDot != std::string::npos && (lastSeparator == std::string::npos || lastDot > lastSeparator + 1))
+	{
+		m_FilePrefix = name.substr(0, lastDot);
+		m_FileExtension = name.substr(lastDot);
+	}
+	else
+		m_FilePrefix = name;
+}
+
+RotatingPcapFileWriterDevice::~RotatingPcapFileWriterDevice()
+{
+	close();
+}
+
+std::string RotatingPcapFileWriterDevice::getTempFileName(uint32_t fileNumber) const
+{
+	char suffix[32];
+	snprintf(suffix, sizeof(suffix), "_%05u.tmp", fileNumber);
+	return m_FilePrefix + suffix;
+}
+
+std::string RotatingPcapFileWriterDevice::getFinalFileName(uint32_t fileNumber, time_t timestamp) const
+{
+	struct tm localTime;
+#if defined(WIN32) || defined(WINx64) || defined(PCAPPP_MINGW_ENV)
+	localtime_s(&localTime, &timestamp);
+#else
+	localtime_r(&timestamp, &localTime);
+#endif
+
+	char timeStr[32];
+	strftime(timeStr, sizeof(timeStr), "%Y%m%d%H%M%S", &localTime);
+	char suffix[64];
+	snprintf(suffix, sizeof(suffix), "_%05u_%s", fileNumber, timeStr);
+	return m_FilePrefix + suffix + m_FileExtension;
+}
+
+std::string RotatingPcapFileWriterDevice::getCurrentFileName() const
+{
+	return m_CurFileName;
+}
+
+std::vector<std::string> RotatingPcapFileWriterDevice::getFileNames() const
+{
+	return std::vector<std::string>(m_FileNames.begin(), m_FileNames.end());
+}
+
+bool RotatingPcapFileWriterDevice::open(bool appendMode)
+{
+	if (appendMode)
+	{
+		LOG_ERROR("Append mode isn't supported by the rotating file writer");
+		return false;
+	}
+
+	return open();
+}
+
+bool RotatingPcapFileWriterDevice::open()
+{
+	if (m_Data != NULL)
+	{
+		LOG_DEBUG("Rotating writer '%s' already opened. Nothing to do", m_FileName);
+		return true;
+	}
+
+	m_NumOfPacketsWritten = 0;
+	m_NumOfPacketsNotWritten = 0;
+	m_CurFileNumber = 0;
+	m_CurFilePackets = 0;
+	m_CurFileName.clear();
+	m_FileNames.clear();
+
+	m_Data = new RotatingFileWriterData();
+	m_Data->linkLayerType = m_LinkLayerType;
+	m_Data->fileFormat = m_FileFormat;
+	m_Data->ioConfig = m_Config.ioConfig;
+	m_Data->preallocateSize = (m_Config.preallocateSize > 0 ? m_Config.preallocateSize : m_Config.maxFileSize);
+
+	int err = pthread_create(&m_Data->workerThread, NULL, rotatingFileWriterThreadMain, (void*)m_Data);
+	if (err != 0)
+	{
+		LOG_ERROR("Couldn't create the rotating writer thread, error code is %d", err);
+		delete m_Data;
+		m_Data = NULL;
+		return false;
+	}
+
+	m_Data->addTask(RotatingFileWriterTask(RotatingFileWriterTask::PrepareFile, getTempFileName(1)));
+	if (!switchToNextFile())
+	{
+		close();
+		return false;
+	}
+
+	m_DeviceOpened = true;
+	LOG_DEBUG("Rotating writer '%s' opened successfully", m_FileName);
+	return true;
+}
+
+bool RotatingPcapFileWriterDevice::switchToNextFile()
+{
+	std::string fileName;
+	AsyncPcapFileWriterDevice* nextWriter = m_Data->waitForPreparedWriter(fileName);
+	if (nextWriter == NULL)
+	{
+		// try again on the next rotation
+		m_Data->addTask(RotatingFileWriterTask(RotatingFileWriterTask::PrepareFile, fileName));
+		return false;
+	}
+
+	if (m_CurWriter != NULL)
+		m_Data->addTask(RotatingFileWriterTask(RotatingFileWriterTask::CloseFile, m_CurFileName, m_CurWriter));
+
+	m_CurWriter = nextWriter;
+	m_CurFileName = fileName;
+	m_CurFileNumber++;
+	m_CurFilePackets = 0;
+
+	m_Data->addTask(RotatingFileWriterTask(RotatingFileWriterTask::PrepareFile, getTempFileName(m_CurFileNumber + 1)));
+	return true;
+}
+
+void RotatingPcapFileWriterDevice::nameCurrentFile(time_t timestamp)
+{
+	std::string finalName = getFinalFileName(m_CurFileNumber, timestamp);
+	m_Data->addTask(RotatingFileWriterTask(RotatingFileWriterTask::RenameFile, m_CurFileName, NULL, finalName));
+	m_CurFileName = finalName;
+	m_CurFileStartTime = timestamp;
+
+	m_FileNames.push_back(finalName);
+	if (m_Config.maxFiles > 0 && m_FileNames.size() > m_Config.maxFiles)
+	{
+		m_Data->addTask(RotatingFileWriterTask(RotatingFileWriterTask::DeleteFile, m_FileNames.front()));
+		m_FileNames.pop_front();
+	}
+}
+
+bool RotatingPcapFileWriterDevice::shouldRotate(const RawPacket& packet) const
+{
+	if (m_CurFilePackets == 0)
+		return false;
+
+	if (m_Config.maxPacketsPerFile > 0 && m_CurFilePackets >= m_Config.maxPacketsPerFile)
+		return true;
+
+	if (m_Config.maxFileDuration > 0 && packet.getPacketTimeStamp().tv_sec - m_CurFileStartTime >= (time_t)m_Config.maxFileDuration)
+		return true;
+
+	if (m_Config.maxFileSize > 0)
+	{
+		uint64_t dataLen = packet.getRawDataLen();
+		uint64_t recordLen = (m_FileFormat == CaptureFilePcap ? 16 + dataLen : 32 + ((dataLen + 3) & ~3));
+		if (m_CurWriter->getBytesWritten() + recordLen > m_Config.maxFileSize)
+			return true;
+	}
+
+	return false;
+}
+
+bool RotatingPcapFileWriterDevice::rotate()
+{
+	if (m_Data == NULL)
+	{
+		LOG_ERROR("Device not opened");
+		return false;
+	}
+
+	if (m_CurFilePackets == 0)
+		return true;
+
+	return switchToNextFile();
+}
+
+bool RotatingPcapFileWriterDevice::writePacket(RawPacket const& packet)
+{
+	if (m_Data == NULL)
+	{
+		LOG_ERROR("Device not opened");
+		m_NumOfPacketsNotWritten++;
+		return false;
+	}
+
+	if (packet.getLinkLayerType() != m_LinkLayerType)
+	{
+		LOG_ERROR("Cannot write a packet with a different link layer type");
+		m_NumOfPacketsNotWritten++;
+		return false;
+	}
+
+	if (shouldRotate(packet) && !switchToNextFile())
+	{
+		LOG_ERROR("Couldn't rotate to the next file of '%s'", m_FileName);
+		m_NumOfPacketsNotWritten++;
+		return false;
+	}
+
+	if (m_CurFilePackets == 0)
+		nameCurrentFile(packet.getPacketTimeStamp().tv_sec);
+
+	if (!m_CurWriter->writePacket(packet))
+	{
+		m_NumOfPacketsNotWritten++;
+		return false;
+	}
+
+	m_CurFilePackets++;
+	m_NumOfPacketsWritten++;
+	return true;
+}
+
+bool RotatingPcapFileWriterDevice::writePackets(const RawPacketVector& packets)
+{
+	for (RawPacketVector::ConstVectorIterator iter = packets.begin(); iter != packets.end(); iter++)
+	{
+		if (!writePacket(**iter))
+			return false;
+	}
+
+	return true;
+}
+
+void RotatingPcapFileWriterDevice::close()
+{
+	if (m_Data == NULL)
+		return;
+
+	// a file is deleted only if it never got packets, otherwise it's in m_FileNames
+	if (m_CurWriter != NULL)
+	{
+		m_Data->addTask(RotatingFileWriterTask(RotatingFileWriterTask::CloseFile, m_CurFileName, m_CurWriter));
+		if (m_CurFilePackets == 0)
+			m_Data->addTask(RotatingFileWriterTask(RotatingFileWriterTask::DeleteFile, m_CurFileName));
+		m_CurWriter = NULL;
+	}
+
+	// the worker finishes all queued tasks before it stops
+	pthread_mutex_lock(&m_Data->mutex);
+	m_Data->stopWorker = true;
+	pthread_cond_broadcast(&m_Data->cond);
+	pthread_mutex_unlock(&m_Data->mutex);
+	pthread_join(m_Data->workerThread, NULL);
+
+	// the file that was prepared for the next rotation isn't needed
+	if (m_Data->preparedWriter != NULL)
+	{
+		m_Data->preparedWriter->close();
+		delete m_Data->preparedWriter;
+		remove(m_Data->preparedFileName.c_str());
+	}
+
+	delete m_Data;
+	m_Data = NULL;
+	m_DeviceOpened = false;
+	LOG_DEBUG("Rotating writer '%s' closed", m_FileName);
+}
+
+void RotatingPcapFileWriterDevice::getStatistics(PcapStats& stats) const
+{
+	stats.packetsRecv = m_NumOfPacketsWritten;
+	stats.packetsDrop = m_NumOfPacketsNotWritten;
+	stats.packetsDropByInterface = 0;
+	LOG_DEBUG("Statistics received for rotating writer '%s'", m_FileName);
+}
+
+} // namespace pcpp
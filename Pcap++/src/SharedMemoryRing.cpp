@@ -0,0 +1,762 @@
+#if !defined(WIN32) && !defined(WINx64) && !defined(PCAPPP_MINGW_ENV)
+
+#define LOG_MODULE PcapLogModuleSharedMemoryRing
+
+#include "SharedMemoryRing.h"
+#include "Logger.h"
+#include <string.h>
+#include <stdio.h>
+#include <new>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#if defined(LINUX)
+#include <sys/syscall.h>
+#endif
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+#ifndef MFD_HUGETLB
+#define MFD_HUGETLB 0x0004U
+#endif
+
+#define NSEC_PER_SEC 1000000000ULL
+#define CACHE_LINE_SIZE 64
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+#define SHARED_MEMORY_RING_MAGIC 0x50435352
+#define SHARED_MEMORY_RING_VERSION 1
+#define SHARED_MEMORY_RING_BATCH_SIZE 64
+// marks a slot the writer is overwriting
+#define SLOT_BEING_WRITTEN 0xFFFFFFFFFFFFFFFFULL
+
+namespace pcpp
+{
+
+// the writer and each reader share the ring head, the reader cursor and, with the OverwriteOldestPackets policy, the slot sequence numbers.
+// The memory layout doesn't contain pointers since the ring is mapped at a different address in every process:
+// | header | writer state | reader states (one cache line each) | slots (a header and the packet data each) |
+
+template<typename T>
+static inline T atomicLoadAcquire(const volatile T* ptr) { return __atomic_load_n(ptr, __ATOMIC_ACQUIRE); }
+template<typename T>
+static inline void atomicStoreRelease(volatile T* ptr, T value) { __atomic_store_n(ptr, value, __ATOMIC_RELEASE); }
+
+enum SharedMemoryRingConsumerState
+{
+	ConsumerFree = 0,
+	// the reader took the place but its cursor isn't set yet, so the writer ignores it
+	ConsumerJoining = 1,
+	ConsumerActive = 2
+};
+
+struct SharedMemoryRingHeader
+{
+	// written last when the ring is created, so a reader that sees it sees the rest of the header
+	volatile uint32_t magic;
+	uint32_t version;
+	uint32_t numOfSlots;
+	uint32_t slotSize;
+	uint32_t maxPacketLen;
+	uint32_t maxConsumers;
+	uint32_t slowConsumerPolicy;
+	uint32_t reserved;
+	uint64_t memorySize;
+	volatile uint32_t closed;
+	// incremented by every reader that becomes active, so the writer knows its cached slowest cursor may be stale
+	volatile uint32_t consumersGeneration;
+};
+
+struct SharedMemoryRingWriterState
+{
+	volatile uint64_t head;
+	volatile uint64_t packetsWritten;
+	volatile uint64_t packetsDropped;
+};
+
+struct SharedMemoryRingConsumer
+{
+	volatile uint32_t state;
+	volatile int32_t pid;
+	volatile uint64_t cursor;
+};
+
+struct SharedMemoryRingSlot
+{
+	// the position of the packet in the slot, or SLOT_BEING_WRITTEN while the writer overwrites it
+	volatile uint64_t sequence;
+	uint64_t timestamp;
+	uint32_t captureLen;
+	uint32_t frameLength;
+	uint16_t linkType;
+	uint8_t reserved[6];
+};
+
+static size_t alignToCacheLine(size_t size)
+{
+	return (size + CACHE_LINE_SIZE - 1) & ~((size_t)CACHE_LINE_SIZE - 1);
+}
+
+static inline SharedMemoryRingHeader* getHeader(uint8_t* memory)
+{
+	return (SharedMemoryRingHeader*)memory;
+}
+
+static inline SharedMemoryRingWriterState* getWriterState(uint8_t* memory)
+{
+	return (SharedMemoryRingWriterState*)(memory + alignToCacheLine(sizeof(SharedMemoryRingHeader)));
+}
+
+static inline SharedMemoryRingConsumer* getConsumer(uint8_t* memory, uint32_t consumerId)
+{
+	return (SharedMemoryRingConsumer*)(memory + alignToCacheLine(sizeof(SharedMemoryRingHeader)) + alignToCacheLine(sizeof(SharedMemoryRingWriterState))
+			+ (size_t)consumerId * alignToCacheLine(sizeof(SharedMemoryRingConsumer)));
+}
+
+static inline SharedMemoryRingSlot* getSlot(uint8_t* memory, uint64_t position)
+{
+	SharedMemoryRingHeader* header = getHeader(memory);
+	uint8_t* slots = (uint8_t*)getConsumer(memory, header->maxConsumers);
+	return (SharedMemoryRingSlot*)(slots + (size_t)(position & (header->numOfSlots - 1)) * header->slotSize);
+}
+
+static timespec nsecToTimespec(uint64_t nsec)
+{
+	timespec ts;
+	ts.tv_sec = nsec / NSEC_PER_SEC;
+	ts.tv_nsec = nsec % NSEC_PER_SEC;
+	return ts;
+}
+
+static int createMemfd(const char* name, unsigned int flags)
+{
+#if defined(LINUX) && defined(__NR_memfd_create)
+	return (int)syscall(__NR_memfd_create, name, flags);
+#else
+	errno = ENOSYS;
+	return -1;
+#endif
+}
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// SharedMemoryRingWriterDevice members
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+SharedMemoryRingWriterDevice::SharedMemoryRingWriterDevice(const std::string& name, const Config& config) : IPcapDevice(),
+	m_Name(name), m_Config(config), m_Memory(NULL), m_MemorySize(0), m_MemfdDescriptor(-1), m_SlowestCursor(0), m_ConsumersGeneration(0),
+	m_PacketsFiltered(0), m_HasFilter(false)
+{
+}
+
+SharedMemoryRingWriterDevice::~SharedMemoryRingWriterDevice()
+{
+	close();
+}
+
+bool SharedMemoryRingWriterDevice::open()
+{
+	if (m_DeviceOpened)
+	{
+		LOG_ERROR("Shared memory ring '%s' is already open", m_Name.c_str());
+		return false;
+	}
+
+	if (m_Config.numOfSlots == 0 || m_Config.numOfSlots > 0x80000000 || m_Config.maxPacketLen == 0 || m_Config.maxConsumers == 0)
+	{
+		LOG_ERROR("Invalid shared memory ring configuration: number of slots, max packet length and max consumers must be positive");
+		return false;
+	}
+
+	if (m_Config.useHugePages && m_Config.memoryType == PosixSharedMemory)
+	{
+		LOG_ERROR("Huge pages aren't supported with POSIX shared memory, please use a memfd or a file on a hugetlbfs mount");
+		return false;
+	}
+
+	uint32_t numOfSlots = 1;
+	while (numOfSlots < m_Config.numOfSlots)
+		numOfSlots <<= 1;
+	m_Config.numOfSlots = numOfSlots;
+
+	uint32_t slotSize = (uint32_t)alignToCacheLine(sizeof(SharedMemoryRingSlot) + m_Config.maxPacketLen);
+	size_t memorySize = alignToCacheLine(sizeof(SharedMemoryRingHeader)) + alignToCacheLine(sizeof(SharedMemoryRingWriterState))
+			+ (size_t)m_Config.maxConsumers * alignToCacheLine(sizeof(SharedMemoryRingConsumer)) + (size_t)numOfSlots * slotSize;
+	if (m_Config.useHugePages)
+		memorySize = (memorySize + HUGE_PAGE_SIZE - 1) & ~((size_t)HUGE_PAGE_SIZE - 1);
+
+	int fd = -1;
+	switch (m_Config.memoryType)
+	{
+	case PosixSharedMemory:
+		fd = shm_open(m_Name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+		break;
+	case MemfdSharedMemory:
+		fd = createMemfd(m_Name.c_str(), MFD_CLOEXEC | (m_Config.useHugePages ? MFD_HUGETLB : 0));
+		break;
+	case FileSharedMemory:
+		fd = ::open(m_Name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+		break;
+	}
+
+	if (fd < 0)
+	{
+		LOG_ERROR("Couldn't create shared memory ring '%s': %s", m_Name.c_str(), strerror(errno));
+		return false;
+	}
+
+	void* mapping = MAP_FAILED;
+	if (ftruncate(fd, (off_t)memorySize) != 0)
+	{
+		LOG_ERROR("Couldn't resize shared memory ring '%s' to %llu bytes: %s", m_Name.c_str(), (unsigned long long)memorySize, strerror(errno));
+	}
+	else
+	{
+		int flags = MAP_SHARED;
+#if defined(LINUX)
+		// fault in the whole ring now rather than in the capture path
+		flags |= MAP_POPULATE;
+#endif
+		mapping = mmap(NULL, memorySize, PROT_READ | PROT_WRITE, flags, fd, 0);
+		if (mapping == MAP_FAILED)
+			LOG_ERROR("Couldn't map shared memory ring '%s': %s", m_Name.c_str(), strerror(errno));
+	}
+
+	if (mapping == MAP_FAILED || m_Config.memoryType != MemfdSharedMemory)
+		::close(fd);
+
+	if (mapping == MAP_FAILED)
+	{
+		if (m_Config.memoryType == PosixSharedMemory)
+			shm_unlink(m_Name.c_str());
+		else if (m_Config.memoryType == FileSharedMemory)
+			unlink(m_Name.c_str());
+		return false;
+	}
+
+	// a new object is zeroed, so all reader places are free
+	m_Memory = (uint8_t*)mapping;
+	m_MemorySize = memorySize;
+	m_MemfdDescriptor = (m_Config.memoryType == MemfdSharedMemory ? fd : -1);
+	m_SlowestCursor = 0;
+	m_ConsumersGeneration = 0;
+	m_PacketsFiltered = 0;
+
+	SharedMemoryRingHeader* header = getHeader(m_Memory);
+	header->version = SHARED_MEMORY_RING_VERSION;
+	header->numOfSlots = numOfSlots;
+	header->slotSize = slotSize;
+	header->maxPacketLen = m_Config.maxPacketLen;
+	header->maxConsumers = m_Config.maxConsumers;
+	header->slowConsumerPolicy = (uint32_t)m_Config.slowConsumerPolicy;
+	header->memorySize = memorySize;
+	atomicStoreRelease(&header->magic, (uint32_t)SHARED_MEMORY_RING_MAGIC);
+
+	m_DeviceOpened = true;
+	LOG_DEBUG("Shared memory ring '%s' created with %u slots of %u bytes", m_Name.c_str(), numOfSlots, slotSize);
+	return true;
+}
+
+void SharedMemoryRingWriterDevice::close()
+{
+	if (m_Memory == NULL)
+		return;
+
+	atomicStoreRelease(&getHeader(m_Memory)->closed, (uint32_t)1);
+	munmap(m_Memory, m_MemorySize);
+	m_Memory = NULL;
+
+	if (m_Config.memoryType == PosixSharedMemory)
+		shm_unlink(m_Name.c_str());
+	else if (m_Config.memoryType == FileSharedMemory)
+		unlink(m_Name.c_str());
+	else if (m_MemfdDescriptor >= 0)
+		::close(m_MemfdDescriptor);
+
+	m_MemfdDescriptor = -1;
+	m_DeviceOpened = false;
+	LOG_DEBUG("Shared memory ring '%s' closed", m_Name.c_str());
+}
+
+bool SharedMemoryRingWriterDevice::hasRoomForPacket(uint64_t head)
+{
+	SharedMemoryRingHeader* header = getHeader(m_Memory);
+
+	// the cached slowest cursor is enough unless it's a whole ring behind or a reader became active since it was calculated. The
+	// generation is read in the same total order the readers use, so a reader that becomes active either is seen here or sees the
+	// head that was published before this packet and starts after it
+	uint32_t generation = __atomic_load_n(&header->consumersGeneration, __ATOMIC_SEQ_CST);
+	if (generation == m_ConsumersGeneration && head - m_SlowestCursor < header->numOfSlots)
+		return true;
+
+	m_ConsumersGeneration = generation;
+	uint64_t slowestCursor = head;
+	for (uint32_t i = 0; i < header->maxConsumers; i++)
+	{
+		SharedMemoryRingConsumer* consumer = getConsumer(m_Memory, i);
+		if (atomicLoadAcquire(&consumer->state) != ConsumerActive)
+			continue;
+
+		uint64_t cursor = atomicLoadAcquire(&consumer->cursor);
+		if (head - cursor >= header->numOfSlots && kill((pid_t)consumer->pid, 0) != 0 && errno == ESRCH)
+		{
+			// the reader process exited without closing its device
+			uint32_t expected = ConsumerActive;
+			if (__atomic_compare_exchange_n(&consumer->state, &expected, (uint32_t)ConsumerFree, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+				LOG_DEBUG("Released the place of reader %u of shared memory ring '%s', its process %d doesn't exist", i, m_Name.c_str(), (int)consumer->pid);
+			continue;
+		}
+
+		if (cursor < slowestCursor)
+			slowestCursor = cursor;
+	}
+
+	m_SlowestCursor = slowestCursor;
+	return head - slowestCursor < header->numOfSlots;
+}
+
+bool SharedMemoryRingWriterDevice::writePacket(const RawPacket& rawPacket)
+{
+	if (m_Memory == NULL)
+	{
+		LOG_ERROR("Shared memory ring '%s' isn't open", m_Name.c_str());
+		return false;
+	}
+
+	if (m_HasFilter && !m_Filter.matchPacketWithFilter(&rawPacket))
+	{
+		m_PacketsFiltered++;
+		return true;
+	}
+
+	SharedMemoryRingWriterState* writerState = getWriterState(m_Memory);
+	uint64_t head = writerState->head;
+	bool overwrite = (m_Config.slowConsumerPolicy == OverwriteOldestPackets);
+	if (!overwrite && !hasRoomForPacket(head))
+	{
+		atomicStoreRelease(&writerState->packetsDropped, writerState->packetsDropped + 1);
+		return false;
+	}
+
+	SharedMemoryRingSlot* slot = getSlot(m_Memory, head);
+	if (overwrite)
+	{
+		// a reader that is copying the old packet sees the slot change and knows its copy is invalid
+		__atomic_store_n(&slot->sequence, SLOT_BEING_WRITTEN, __ATOMIC_RELAXED);
+		__atomic_thread_fence(__ATOMIC_RELEASE);
+	}
+
+	uint32_t captureLen = (uint32_t)rawPacket.getRawDataLen();
+	if (captureLen > m_Config.maxPacketLen)
+		captureLen = m_Config.maxPacketLen;
+
+	memcpy((uint8_t*)(slot + 1), rawPacket.getRawData(), captureLen);
+	timespec timestamp = rawPacket.getPacketTimeStamp();
+	slot->timestamp = (uint64_t)timestamp.tv_sec * NSEC_PER_SEC + timestamp.tv_nsec;
+	slot->captureLen = captureLen;
+	slot->frameLength = (uint32_t)rawPacket.getFrameLength();
+	slot->linkType = (uint16_t)rawPacket.getLinkLayerType();
+
+	atomicStoreRelease(&slot->sequence, head);
+	__atomic_store_n(&writerState->head, head + 1, __ATOMIC_SEQ_CST);
+	atomicStoreRelease(&writerState->packetsWritten, writerState->packetsWritten + 1);
+	return true;
+}
+
+bool SharedMemoryRingWriterDevice::writePackets(const RawPacketVector& packets)
+{
+	bool allWritten = true;
+	for (RawPacketVector::ConstVectorIterator iter = packets.begin(); iter != packets.end(); iter++)
+	{
+		if (!writePacket(**iter))
+			allWritten = false;
+	}
+
+	return allWritten;
+}
+
+void SharedMemoryRingWriterDevice::onPacketArrives(RawPacket* packet, PcapLiveDevice* device, void* userCookie)
+{
+	((SharedMemoryRingWriterDevice*)userCookie)->writePacket(*packet);
+}
+
+std::string SharedMemoryRingWriterDevice::getAttachName() const
+{
+	if (m_Memory == NULL)
+		return "";
+
+	if (m_Config.memoryType != MemfdSharedMemory)
+		return m_Name;
+
+	char path[64];
+	snprintf(path, sizeof(path), "/proc/%d/fd/%d", (int)getpid(), m_MemfdDescriptor);
+	return std::string(path);
+}
+
+int SharedMemoryRingWriterDevice::getNumOfConsumers() const
+{
+	if (m_Memory == NULL)
+		return 0;
+
+	int numOfConsumers = 0;
+	for (uint32_t i = 0; i < m_Config.maxConsumers; i++)
+	{
+		if (atomicLoadAcquire(&getConsumer(m_Memory, i)->state) == ConsumerActive)
+			numOfConsumers++;
+	}
+
+	return numOfConsumers;
+}
+
+uint64_t SharedMemoryRingWriterDevice::getSlowestConsumerLag() const
+{
+	if (m_Memory == NULL)
+		return 0;
+
+	uint64_t head = getWriterState(m_Memory)->head;
+	uint64_t lag = 0;
+	for (uint32_t i = 0; i < m_Config.maxConsumers; i++)
+	{
+		SharedMemoryRingConsumer* consumer = getConsumer(m_Memory, i);
+		if (atomicLoadAcquire(&consumer->state) != ConsumerActive)
+			continue;
+
+		uint64_t cursor = atomicLoadAcquire(&consumer->cursor);
+		if (cursor < head && head - cursor > lag)
+			lag = head - cursor;
+	}
+
+	return lag;
+}
+
+void SharedMemoryRingWriterDevice::getStatistics(IPcapDevice::PcapStats& stats) const
+{
+	stats.packetsRecv = 0;
+	stats.packetsDrop = 0;
+	stats.packetsDropByInterface = 0;
+	if (m_Memory == NULL)
+		return;
+
+	stats.packetsRecv = getWriterState(m_Memory)->packetsWritten;
+	stats.packetsDrop = getWriterState(m_Memory)->packetsDropped;
+}
+
+bool SharedMemoryRingWriterDevice::setFilter(std::string filterAsString)
+{
+	if (!m_Filter.setFilter(filterAsString))
+	{
+		LOG_ERROR("Filter '%s' is not valid", filterAsString.c_str());
+		return false;
+	}
+
+	m_HasFilter = !filterAsString.empty();
+	return true;
+}
+
+bool SharedMemoryRingWriterDevice::clearFilter()
+{
+	m_Filter.setFilter("");
+	m_HasFilter = false;
+	return true;
+}
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// SharedMemoryRingReaderDevice members
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+SharedMemoryRingReaderDevice::SharedMemoryRingReaderDevice(const std::string& name) : IPcapDevice(),
+	m_Name(name), m_Memory(NULL), m_MemorySize(0), m_ConsumerId(-1), m_Cursor(0), m_PacketsReceived(0), m_PacketsLost(0),
+	m_WriterDropsOnOpen(0), m_BatchPackets(NULL), m_CopyBuffer(NULL), m_HasFilter(false)
+{
+}
+
+SharedMemoryRingReaderDevice::~SharedMemoryRingReaderDevice()
+{
+	close();
+}
+
+bool SharedMemoryRingReaderDevice::open()
+{
+	if (m_DeviceOpened)
+	{
+		LOG_ERROR("Shared memory ring reader '%s' is already open", m_Name.c_str());
+		return false;
+	}
+
+	// memfd paths under /proc and files on hugetlbfs/tmpfs mounts are opened as files
+	bool isFilePath = (m_Name.find('/', 1) != std::string::npos);
+	int fd = (isFilePath ? ::open(m_Name.c_str(), O_RDWR) : shm_open(m_Name.c_str(), O_RDWR, 0));
+	if (fd < 0)
+	{
+		LOG_ERROR("Couldn't open shared memory ring '%s': %s", m_Name.c_str(), strerror(errno));
+		return false;
+	}
+
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) != 0 || (size_t)fileStat.st_size < sizeof(SharedMemoryRingHeader))
+	{
+		LOG_ERROR("'%s' isn't a shared memory ring", m_Name.c_str());
+		::close(fd);
+		return false;
+	}
+
+	size_t memorySize = (size_t)fileStat.st_size;
+	void* mapping = mmap(NULL, memorySize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (mapping == MAP_FAILED)
+	{
+		LOG_ERROR("Couldn't map shared memory ring '%s': %s", m_Name.c_str(), strerror(errno));
+		return false;
+	}
+
+	uint8_t* memory = (uint8_t*)mapping;
+	SharedMemoryRingHeader* header = getHeader(memory);
+	if (atomicLoadAcquire(&header->magic) != SHARED_MEMORY_RING_MAGIC || header->version != SHARED_MEMORY_RING_VERSION || header->memorySize != memorySize)
+	{
+		LOG_ERROR("'%s' isn't a shared memory ring or was created by another version", m_Name.c_str());
+		munmap(mapping, memorySize);
+		return false;
+	}
+
+	int consumerId = -1;
+	for (uint32_t i = 0; i < header->maxConsumers && consumerId < 0; i++)
+	{
+		uint32_t expected = ConsumerFree;
+		if (__atomic_compare_exchange_n(&getConsumer(memory, i)->state, &expected, (uint32_t)ConsumerJoining, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+			consumerId = (int)i;
+	}
+
+	if (consumerId < 0)
+	{
+		LOG_ERROR("All %u reader places of shared memory ring '%s' are taken", header->maxConsumers, m_Name.c_str());
+		munmap(mapping, memorySize);
+		return false;
+	}
+
+	// the reader starts at the head. If the writer didn't see this reader become active before it wrapped around the ring, the head
+	// read after becoming active shows it and the reader starts again from there
+	SharedMemoryRingConsumer* consumer = getConsumer(memory, consumerId);
+	SharedMemoryRingWriterState* writerState = getWriterState(memory);
+	consumer->pid = (int32_t)getpid();
+	uint64_t cursor = __atomic_load_n(&writerState->head, __ATOMIC_SEQ_CST);
+	while (true)
+	{
+		atomicStoreRelease(&consumer->cursor, cursor);
+		atomicStoreRelease(&consumer->state, (uint32_t)ConsumerActive);
+		__atomic_fetch_add(&header->consumersGeneration, 1, __ATOMIC_SEQ_CST);
+		uint64_t head = __atomic_load_n(&writerState->head, __ATOMIC_SEQ_CST);
+		if (head - cursor < header->numOfSlots)
+			break;
+		cursor = head;
+	}
+
+	m_Memory = memory;
+	m_MemorySize = memorySize;
+	m_ConsumerId = consumerId;
+	m_Cursor = cursor;
+	m_PacketsReceived = 0;
+	m_PacketsLost = 0;
+	m_WriterDropsOnOpen = atomicLoadAcquire(&writerState->packetsDropped);
+	m_BatchPackets = new uint8_t[SHARED_MEMORY_RING_BATCH_SIZE * sizeof(RawPacket)];
+	if (header->slowConsumerPolicy == SharedMemoryRingWriterDevice::OverwriteOldestPackets)
+		m_CopyBuffer = new uint8_t[(size_t)SHARED_MEMORY_RING_BATCH_SIZE * header->maxPacketLen];
+
+	m_DeviceOpened = true;
+	LOG_DEBUG("Attached to shared memory ring '%s' as reader %d", m_Name.c_str(), consumerId);
+	return true;
+}
+
+void SharedMemoryRingReaderDevice::close()
+{
+	if (m_Memory == NULL)
+		return;
+
+	atomicStoreRelease(&getConsumer(m_Memory, m_ConsumerId)->state, (uint32_t)ConsumerFree);
+	munmap(m_Memory, m_MemorySize);
+	m_Memory = NULL;
+	m_ConsumerId = -1;
+
+	delete [] m_BatchPackets;
+	m_BatchPackets = NULL;
+	delete [] m_CopyBuffer;
+	m_CopyBuffer = NULL;
+
+	m_DeviceOpened = false;
+	LOG_DEBUG("Detached from shared memory ring '%s'", m_Name.c_str());
+}
+
+const uint8_t* SharedMemoryRingReaderDevice::readSlot(uint64_t position, uint8_t* copyTo, RawPacket& rawPacket)
+{
+	SharedMemoryRingSlot* slot = getSlot(m_Memory, position);
+	if (copyTo == NULL)
+	{
+		// the writer doesn't reuse the slot before this reader moves its cursor past it
+		new (&rawPacket) RawPacket((uint8_t*)(slot + 1), (int)slot->captureLen, nsecToTimespec(slot->timestamp), false, (LinkLayerType)slot->linkType);
+		rawPacket.setRawData((uint8_t*)(slot + 1), (int)slot->captureLen, nsecToTimespec(slot->timestamp), (LinkLayerType)slot->linkType, (int)slot->frameLength);
+		return (uint8_t*)(slot + 1);
+	}
+
+	// the slot may be overwritten while it's copied. The copy is valid only if the sequence number is the same before and after it
+	if (atomicLoadAcquire(&slot->sequence) != position)
+		return NULL;
+
+	uint64_t timestamp = slot->timestamp;
+	uint32_t captureLen = slot->captureLen;
+	uint32_t frameLength = slot->frameLength;
+	uint16_t linkType = slot->linkType;
+	if (captureLen > getHeader(m_Memory)->maxPacketLen)
+		return NULL;
+	memcpy(copyTo, (uint8_t*)(slot + 1), captureLen);
+
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	if (__atomic_load_n(&slot->sequence, __ATOMIC_RELAXED) != position)
+		return NULL;
+
+	new (&rawPacket) RawPacket(copyTo, (int)captureLen, nsecToTimespec(timestamp), false, (LinkLayerType)linkType);
+	rawPacket.setRawData(copyTo, (int)captureLen, nsecToTimespec(timestamp), (LinkLayerType)linkType, (int)frameLength);
+	return copyTo;
+}
+
+uint32_t SharedMemoryRingReaderDevice::receivePackets(OnSharedMemoryPacketsCallback onPacketsReceived, void* userCookie, uint32_t maxNumOfPackets)
+{
+	if (m_Memory == NULL || onPacketsReceived == NULL)
+		return 0;
+
+	SharedMemoryRingHeader* header = getHeader(m_Memory);
+	SharedMemoryRingWriterState* writerState = getWriterState(m_Memory);
+	SharedMemoryRingConsumer* consumer = getConsumer(m_Memory, m_ConsumerId);
+	bool overwrite = (m_CopyBuffer != NULL);
+	RawPacket* batch = (RawPacket*)m_BatchPackets;
+
+	uint32_t numOfPacketsReceived = 0;
+	while (numOfPacketsReceived < maxNumOfPackets)
+	{
+		uint64_t head = atomicLoadAcquire(&writerState->head);
+		if (overwrite && head - m_Cursor > header->numOfSlots)
+		{
+			// the writer overwrote packets this reader didn't read
+			m_PacketsLost += head - header->numOfSlots - m_Cursor;
+			m_Cursor = head - header->numOfSlots;
+		}
+
+		if (m_Cursor == head)
+			break;
+
+		uint32_t batchSize = 0;
+		while (m_Cursor < head && batchSize < SHARED_MEMORY_RING_BATCH_SIZE && numOfPacketsReceived + batchSize < maxNumOfPackets)
+		{
+			uint8_t* copyTo = (overwrite ? m_CopyBuffer + (size_t)batchSize * header->maxPacketLen : NULL);
+			uint64_t position = m_Cursor++;
+			if (readSlot(position, copyTo, batch[batchSize]) == NULL)
+			{
+				m_PacketsLost++;
+				continue;
+			}
+
+			if (m_HasFilter && !m_Filter.matchPacketWithFilter(&batch[batchSize]))
+			{
+				batch[batchSize].~RawPacket();
+				continue;
+			}
+
+			batchSize++;
+		}
+
+		if (batchSize > 0)
+		{
+			onPacketsReceived(batch, batchSize, this, userCookie);
+
+			for (uint32_t i = 0; i < batchSize; i++)
+				batch[i].~RawPacket();
+		}
+
+		// the slots can be reused by the writer only now that the callback returned
+		atomicStoreRelease(&consumer->cursor, m_Cursor);
+		numOfPacketsReceived += batchSize;
+		m_PacketsReceived += batchSize;
+	}
+
+	return numOfPacketsReceived;
+}
+
+static void sharedMemoryRingCopyPacket(RawPacket* packets, uint32_t numOfPackets, SharedMemoryRingReaderDevice* device, void* userCookie)
+{
+	RawPacket* rawPacket = (RawPacket*)userCookie;
+	uint8_t* data = new uint8_t[packets[0].getRawDataLen()];
+	memcpy(data, packets[0].getRawData(), packets[0].getRawDataLen());
+	rawPacket->setRawData(data, packets[0].getRawDataLen(), packets[0].getPacketTimeStamp(), packets[0].getLinkLayerType(), packets[0].getFrameLength());
+}
+
+static void sharedMemoryRingCopyPackets(RawPacket* packets, uint32_t numOfPackets, SharedMemoryRingReaderDevice* device, void* userCookie)
+{
+	RawPacketVector* packetVec = (RawPacketVector*)userCookie;
+	for (uint32_t i = 0; i < numOfPackets; i++)
+		packetVec->pushBack(new RawPacket(packets[i]));
+}
+
+bool SharedMemoryRingReaderDevice::getNextPacket(RawPacket& rawPacket)
+{
+	rawPacket.clear();
+	return receivePackets(sharedMemoryRingCopyPacket, &rawPacket, 1) == 1;
+}
+
+int SharedMemoryRingReaderDevice::getNextPackets(RawPacketVector& packets, int numOfPacketsToRead)
+{
+	uint32_t maxNumOfPackets = (numOfPacketsToRead < 0 ? 0xFFFFFFFF : (uint32_t)numOfPacketsToRead);
+	return (int)receivePackets(sharedMemoryRingCopyPackets, &packets, maxNumOfPackets);
+}
+
+bool SharedMemoryRingReaderDevice::isStreamEnded()
+{
+	if (m_Memory == NULL)
+		return true;
+
+	// the closed flag is read before the head, so the packets written before the writer closed are seen
+	bool closed = (atomicLoadAcquire(&getHeader(m_Memory)->closed) != 0);
+	return closed && m_Cursor >= atomicLoadAcquire(&getWriterState(m_Memory)->head);
+}
+
+SharedMemoryRingWriterDevice::SlowConsumerPolicy SharedMemoryRingReaderDevice::getSlowConsumerPolicy() const
+{
+	if (m_Memory == NULL)
+		return SharedMemoryRingWriterDevice::DropNewestPackets;
+
+	return (SharedMemoryRingWriterDevice::SlowConsumerPolicy)getHeader(m_Memory)->slowConsumerPolicy;
+}
+
+void SharedMemoryRingReaderDevice::getStatistics(IPcapDevice::PcapStats& stats) const
+{
+	stats.packetsRecv = m_PacketsReceived;
+	stats.packetsDrop = m_PacketsLost;
+	stats.packetsDropByInterface = 0;
+	if (m_Memory != NULL)
+		stats.packetsDrop += atomicLoadAcquire(&getWriterState(m_Memory)->packetsDropped) - m_WriterDropsOnOpen;
+}
+
+bool SharedMemoryRingReaderDevice::setFilter(std::string filterAsString)
+{
+	if (!m_Filter.setFilter(filterAsString))
+	{
+		LOG_ERROR("Filter '%s' is not valid", filterAsString.c_str());
+		return false;
+	}
+
+	m_HasFilter = !filterAsString.empty();
+	return true;
+}
+
+bool SharedMemoryRingReaderDevice::clearFilter()
+{
+	m_Filter.setFilter("");
+	m_HasFilter = false;
+	return true;
+}
+
+} // namespace pcpp
+
+#endif // !WIN32 && !WINx64 && !PCAPPP_MINGW_ENV
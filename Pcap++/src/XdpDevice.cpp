@@ -0,0 +1,966 @@
+#ifdef USE_XDP
+
+#define LOG_MODULE PcapLogModuleXdpDevice
+
+#include "XdpDevice.h"
+#include "Logger.h"
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <poll.h>
+#include <time.h>
+#include <new>
+#include <algorithm>
+#include <sys/socket.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <net/if.h>
+#include <linux/if_xdp.h>
+#include <linux/if_link.h>
+#include <linux/bpf.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+
+#ifndef AF_XDP
+#define AF_XDP 44
+#endif
+
+#ifndef SOL_XDP
+#define SOL_XDP 283
+#endif
+
+namespace pcpp
+{
+
+/**
+ * A producer or consumer ring shared with the kernel. The index this side owns is advanced locally and published with release
+ * semantics; the index the kernel owns is read with acquire semantics
+ */
+struct XdpRing
+{
+	uint32_t* producer;
+	uint32_t* consumer;
+	uint32_t* flags;
+	void* descs;
+	uint32_t size;
+	uint32_t mask;
+	void* map;
+	size_t mapSize;
+
+	XdpRing() : producer(NULL), consumer(NULL), flags(NULL), descs(NULL), size(0), mask(0), map(MAP_FAILED), mapSize(0) {}
+};
+
+/**
+ * An opened queue: an AF_XDP socket, its UMEM and its 4 rings. UMEM frames [0, numOfRxFrames) cycle between the fill ring and the
+ * RX ring, frames [numOfRxFrames, numOfFrames) cycle between txFreeFrames, the TX ring and the completion ring
+ */
+struct XdpQueue
+{
+	XdpDevice* device;
+	uint16_t queueId;
+	int fd;
+	uint8_t* umem;
+	size_t umemSize;
+	XdpRing fill;
+	XdpRing completion;
+	XdpRing rx;
+	XdpRing tx;
+	std::vector<uint64_t> txFreeFrames;
+	uint8_t* packetArray;
+	PollingController poller;
+
+	uint64_t rxPackets;
+	uint64_t rxBytes;
+	uint64_t txPackets;
+	uint64_t txBytes;
+	uint64_t txDropped;
+
+	XdpQueue(XdpDevice* dev, uint16_t id) : device(dev), queueId(id), fd(-1), umem(NULL), umemSize(0), packetArray(NULL),
+		rxPackets(0), rxBytes(0), txPackets(0), txBytes(0), txDropped(0) {}
+};
+
+
+static inline uint32_t xdpLoadAcquire(const uint32_t* ptr)
+{
+	return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+static inline void xdpStoreRelease(uint32_t* ptr, uint32_t value)
+{
+	__atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+}
+
+static bool isPowerOf2(uint32_t value)
+{
+	return value != 0 && (value & (value - 1)) == 0;
+}
+
+static uint32_t roundUpToPowerOf2(uint32_t value)
+{
+	uint32_t result = 1;
+	while (result < value)
+		result <<= 1;
+	return result;
+}
+
+static long xdpBpfSyscall(int cmd, union bpf_attr* attr)
+{
+	return syscall(__NR_bpf, cmd, attr, sizeof(*attr));
+}
+
+static struct bpf_insn xdpMakeInsn(uint8_t code, uint8_t dstReg, uint8_t srcReg, int16_t off, int32_t imm)
+{
+	struct bpf_insn insn;
+	memset(&insn, 0, sizeof(insn));
+	insn.code = code;
+	insn.dst_reg = dstReg;
+	insn.src_reg = srcReg;
+	insn.off = off;
+	insn.imm = imm;
+	return insn;
+}
+
+static bool mapXdpRing(int fd, XdpRing& ring, const struct xdp_ring_offset& offsets, uint32_t size, size_t descSize, off_t pageOffset)
+{
+	ring.mapSize = offsets.desc + size * descSize;
+	ring.map = mmap(NULL, ring.mapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, pageOffset);
+	if (ring.map == MAP_FAILED)
+		return false;
+
+	uint8_t* base = (uint8_t*)ring.map;
+	ring.producer = (uint32_t*)(base + offsets.producer);
+	ring.consumer = (uint32_t*)(base + offsets.consumer);
+	ring.flags = (uint32_t*)(base + offsets.flags);
+	ring.descs = base + offsets.desc;
+	ring.size = size;
+	ring.mask = size - 1;
+	return true;
+}
+
+static void unmapXdpRing(XdpRing& ring)
+{
+	if (ring.map != MAP_FAILED)
+		munmap(ring.map, ring.mapSize);
+	ring = XdpRing();
+}
+
+static void freeXdpQueue(XdpQueue* queue)
+{
+	unmapXdpRing(queue->fill);
+	unmapXdpRing(queue->completion);
+	unmapXdpRing(queue->rx);
+	unmapXdpRing(queue->tx);
+
+	if (queue->fd >= 0)
+		::close(queue->fd);
+
+	free(queue->umem);
+	delete [] queue->packetArray;
+	delete queue;
+}
+
+/**
+ * The kernel releases the queue of a closed AF_XDP socket asynchronously, so binding right after a previous socket of the same queue
+ * was closed may fail with EBUSY for a short while
+ */
+static int bindXdpSocket(int fd, const struct sockaddr_xdp& addr)
+{
+	int result;
+	for (int attempt = 0; attempt < 20; attempt++)
+	{
+		result = bind(fd, (const struct sockaddr*)&addr, sizeof(addr));
+		if (result == 0 || errno != EBUSY)
+			break;
+		usleep(50000);
+	}
+
+	return result;
+}
+
+/**
+ * Attach or detach an XDP program using an RTM_SETLINK netlink request with a nested IFLA_XDP attribute
+ */
+static int setXdpProgramFd(int ifIndex, int progFd, uint32_t flags)
+{
+	int sock = socket(AF_NETLINK, SOCK_RAW, NETLINK_ROUTE);
+	if (sock < 0)
+		return -errno;
+
+	struct
+	{
+		struct nlmsghdr header;
+		struct ifinfomsg ifinfo;
+		char attrBuffer[64];
+	} request;
+	memset(&request, 0, sizeof(request));
+	request.header.nlmsg_len = NLMSG_LENGTH(sizeof(struct ifinfomsg));
+	request.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK;
+	request.header.nlmsg_type = RTM_SETLINK;
+	request.header.nlmsg_seq = 1;
+	request.ifinfo.ifi_family = AF_UNSPEC;
+	request.ifinfo.ifi_index = ifIndex;
+
+	struct nlattr* xdpAttr = (struct nlattr*)((uint8_t*)&request + NLMSG_ALIGN(request.header.nlmsg_len));
+	xdpAttr->nla_type = NLA_F_NESTED | IFLA_XDP;
+	xdpAttr->nla_len = NLA_HDRLEN;
+
+	struct nlattr* fdAttr = (struct nlattr*)((uint8_t*)xdpAttr + xdpAttr->nla_len);
+	fdAttr->nla_type = IFLA_XDP_FD;
+	fdAttr->nla_len = NLA_HDRLEN + sizeof(int);
+	memcpy((uint8_t*)fdAttr + NLA_HDRLEN, &progFd, sizeof(int));
+	xdpAttr->nla_len += NLA_ALIGN(fdAttr->nla_len);
+
+	struct nlattr* flagsAttr = (struct nlattr*)((uint8_t*)xdpAttr + xdpAttr->nla_len);
+	flagsAttr->nla_type = IFLA_XDP_FLAGS;
+	flagsAttr->nla_len = NLA_HDRLEN + sizeof(uint32_t);
+	memcpy((uint8_t*)flagsAttr + NLA_HDRLEN, &flags, sizeof(uint32_t));
+	xdpAttr->nla_len += NLA_ALIGN(flagsAttr->nla_len);
+
+	request.header.nlmsg_len += NLA_ALIGN(xdpAttr->nla_len);
+
+	int result = 0;
+	if (send(sock, &request, request.header.nlmsg_len, 0) < 0)
+	{
+		result = -errno;
+	}
+	else
+	{
+		char response[4096];
+		int len = recv(sock, response, sizeof(response), 0);
+		if (len < 0)
+			result = -errno;
+		else
+		{
+			for (struct nlmsghdr* header = (struct nlmsghdr*)response; NLMSG_OK(header, (unsigned int)len); header = NLMSG_NEXT(header, len))
+			{
+				if (header->nlmsg_type == NLMSG_ERROR)
+				{
+					result = ((struct nlmsgerr*)NLMSG_DATA(header))->error;
+					break;
+				}
+			}
+		}
+	}
+
+	::close(sock);
+	return result;
+}
+
+
+XdpDevice::XdpDevice(const std::string& interfaceName) : m_InterfaceName(interfaceName)
+{
+	m_DeviceOpened = false;
+	m_InterfaceIndex = if_nametoindex(interfaceName.c_str());
+	m_AttachMode = XdpAttachModeAuto;
+	m_ZeroCopy = false;
+	m_XskMapFd = -1;
+	m_ProgramFd = -1;
+	m_AttachFlags = 0;
+	m_ProgramAttached = false;
+	m_OnPacketsArrive = NULL;
+	m_OnPacketsArriveUserCookie = NULL;
+	m_StopThread = true;
+}
+
+XdpDevice::~XdpDevice()
+{
+	close();
+}
+
+uint16_t XdpDevice::getTotalNumOfRxQueues() const
+{
+	std::string queuesDir = "/sys/class/net/" + m_InterfaceName + "/queues";
+	DIR* dir = opendir(queuesDir.c_str());
+	if (dir == NULL)
+		return 1;
+
+	uint16_t numOfRxQueues = 0;
+	struct dirent* entry;
+	while ((entry = readdir(dir)) != NULL)
+	{
+		if (strncmp(entry->d_name, "rx-", 3) == 0)
+			numOfRxQueues++;
+	}
+
+	closedir(dir);
+	return numOfRxQueues > 0 ? numOfRxQueues : 1;
+}
+
+bool XdpDevice::open()
+{
+	return openMultiQueues(1);
+}
+
+bool XdpDevice::loadAndAttachProgram()
+{
+	union bpf_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.map_type = BPF_MAP_TYPE_XSKMAP;
+	attr.key_size = sizeof(uint32_t);
+	attr.value_size = sizeof(int);
+	attr.max_entries = getTotalNumOfRxQueues();
+	m_XskMapFd = (int)xdpBpfSyscall(BPF_MAP_CREATE, &attr);
+	if (m_XskMapFd < 0)
+	{
+		LOG_ERROR("Couldn't create XSKMAP for device '%s': %s", m_InterfaceName.c_str(), strerror(errno));
+		return false;
+	}
+
+	// the XDP program is equivalent to:
+	//   return bpf_redirect_map(&xsks_map, ctx->rx_queue_index, XDP_PASS);
+	// it is assembled by hand to avoid depending on clang and libbpf. When a queue has no socket in the map the packet continues
+	// to the kernel network stack
+	struct bpf_insn program[6];
+	program[0] = xdpMakeInsn(BPF_LDX | BPF_MEM | BPF_W, BPF_REG_2, BPF_REG_1, offsetof(struct xdp_md, rx_queue_index), 0);
+	program[1] = xdpMakeInsn(BPF_LD | BPF_DW | BPF_IMM, BPF_REG_1, BPF_PSEUDO_MAP_FD, 0, m_XskMapFd);
+	program[2] = xdpMakeInsn(0, 0, 0, 0, 0);
+	program[3] = xdpMakeInsn(BPF_ALU64 | BPF_MOV | BPF_K, BPF_REG_3, 0, 0, XDP_PASS);
+	program[4] = xdpMakeInsn(BPF_JMP | BPF_CALL, 0, 0, 0, BPF_FUNC_redirect_map);
+	program[5] = xdpMakeInsn(BPF_JMP | BPF_EXIT, 0, 0, 0, 0);
+
+	char license[] = "GPL";
+	char verifierLog[1024];
+	verifierLog[0] = '\0';
+	memset(&attr, 0, sizeof(attr));
+	attr.prog_type = BPF_PROG_TYPE_XDP;
+	attr.insns = (uint64_t)(unsigned long)program;
+	attr.insn_cnt = sizeof(program) / sizeof(program[0]);
+	attr.license = (uint64_t)(unsigned long)license;
+	attr.log_buf = (uint64_t)(unsigned long)verifierLog;
+	attr.log_size = sizeof(verifierLog);
+	attr.log_level = 1;
+	m_ProgramFd = (int)xdpBpfSyscall(BPF_PROG_LOAD, &attr);
+	if (m_ProgramFd < 0)
+	{
+		LOG_ERROR("Couldn't load XDP program for device '%s': %s. Verifier log: %s", m_InterfaceName.c_str(), strerror(errno), verifierLog);
+		return false;
+	}
+
+	int err = -EOPNOTSUPP;
+	if (m_Config.attachMode != XdpAttachModeGeneric)
+	{
+		m_AttachFlags = XDP_FLAGS_DRV_MODE | XDP_FLAGS_UPDATE_IF_NOEXIST;
+		err = setXdpProgramFd(m_InterfaceIndex, m_ProgramFd, m_AttachFlags);
+		if (err == 0)
+			m_AttachMode = XdpAttachModeNative;
+		else if (m_Config.attachMode == XdpAttachModeAuto)
+			LOG_DEBUG("Couldn't attach XDP program to device '%s' in native mode (%s), trying generic mode", m_InterfaceName.c_str(), strerror(-err));
+	}
+
+	if (err != 0 && m_Config.attachMode != XdpAttachModeNative)
+	{
+		m_AttachFlags = XDP_FLAGS_SKB_MODE | XDP_FLAGS_UPDATE_IF_NOEXIST;
+		err = setXdpProgramFd(m_InterfaceIndex, m_ProgramFd, m_AttachFlags);
+		if (err == 0)
+			m_AttachMode = XdpAttachModeGeneric;
+	}
+
+	if (err != 0)
+	{
+		LOG_ERROR("Couldn't attach XDP program to device '%s': %s", m_InterfaceName.c_str(), strerror(-err));
+		return false;
+	}
+
+	m_ProgramAttached = true;
+	return true;
+}
+
+void XdpDevice::detachProgram()
+{
+	if (m_ProgramAttached)
+	{
+		int err = setXdpProgramFd(m_InterfaceIndex, -1, m_AttachFlags & ~XDP_FLAGS_UPDATE_IF_NOEXIST);
+		if (err != 0)
+			LOG_ERROR("Couldn't detach XDP program from device '%s': %s", m_InterfaceName.c_str(), strerror(-err));
+		m_ProgramAttached = false;
+	}
+
+	if (m_ProgramFd >= 0)
+	{
+		::close(m_ProgramFd);
+		m_ProgramFd = -1;
+	}
+
+	if (m_XskMapFd >= 0)
+	{
+		::close(m_XskMapFd);
+		m_XskMapFd = -1;
+	}
+}
+
+bool XdpDevice::openMultiQueues(uint16_t numOfQueues, const XdpDeviceConfiguration& config)
+{
+	if (m_DeviceOpened)
+	{
+		LOG_ERROR("Device '%s' already opened", m_InterfaceName.c_str());
+		return false;
+	}
+
+	if (m_InterfaceIndex == 0)
+	{
+		LOG_ERROR("Interface '%s' doesn't exist", m_InterfaceName.c_str());
+		return false;
+	}
+
+	if (numOfQueues == 0 || numOfQueues > getTotalNumOfRxQueues())
+	{
+		LOG_ERROR("Cannot open %d queues, device '%s' has %d RX queues", numOfQueues, m_InterfaceName.c_str(), getTotalNumOfRxQueues());
+		return false;
+	}
+
+	if ((config.frameSize != 2048 && config.frameSize != 4096) || !isPowerOf2(config.ringSize) || config.numOfFrames < 2 || config.burstSize == 0)
+	{
+		LOG_ERROR("Invalid XDP configuration: frame size must be 2048 or 4096, ring size must be a power of 2, there must be at least 2 frames and burst size must be positive");
+		return false;
+	}
+
+	m_Config = config;
+	m_Queues.reserve(numOfQueues);
+
+	if (!loadAndAttachProgram())
+	{
+		close();
+		return false;
+	}
+
+	uint32_t numOfRxFrames = m_Config.numOfFrames / 2;
+	// the fill and completion rings are large enough to hold all RX and TX frames so refilling never fails
+	uint32_t fillRingSize = roundUpToPowerOf2(std::max(m_Config.ringSize, numOfRxFrames));
+	uint32_t completionRingSize = roundUpToPowerOf2(std::max(m_Config.ringSize, m_Config.numOfFrames - numOfRxFrames));
+	m_ZeroCopy = true;
+
+	for (uint16_t queueId = 0; queueId < numOfQueues; queueId++)
+	{
+		XdpQueue* queue = new XdpQueue(this, queueId);
+		m_Queues.push_back(queue);
+
+		queue->fd = socket(AF_XDP, SOCK_RAW, 0);
+		if (queue->fd < 0)
+		{
+			LOG_ERROR("Couldn't create AF_XDP socket for device '%s': %s", m_InterfaceName.c_str(), strerror(errno));
+			close();
+			return false;
+		}
+
+		queue->umemSize = (size_t)m_Config.numOfFrames * m_Config.frameSize;
+		void* umem = NULL;
+		if (posix_memalign(&umem, getpagesize(), queue->umemSize) != 0)
+		{
+			LOG_ERROR("Couldn't allocate %d bytes of UMEM for device '%s'", (int)queue->umemSize, m_InterfaceName.c_str());
+			close();
+			return false;
+		}
+		queue->umem = (uint8_t*)umem;
+		queue->packetArray = new uint8_t[m_Config.burstSize * sizeof(RawPacket)];
+
+		struct xdp_umem_reg umemReg;
+		memset(&umemReg, 0, sizeof(umemReg));
+		umemReg.addr = (uint64_t)(unsigned long)queue->umem;
+		umemReg.len = queue->umemSize;
+		umemReg.chunk_size = m_Config.frameSize;
+		umemReg.headroom = 0;
+
+		struct xdp_mmap_offsets offsets;
+		socklen_t optLen = sizeof(offsets);
+		if (setsockopt(queue->fd, SOL_XDP, XDP_UMEM_REG, &umemReg, sizeof(umemReg)) != 0
+				|| setsockopt(queue->fd, SOL_XDP, XDP_UMEM_FILL_RING, &fillRingSize, sizeof(fillRingSize)) != 0
+				|| setsockopt(queue->fd, SOL_XDP, XDP_UMEM_COMPLETION_RING, &completionRingSize, sizeof(completionRingSize)) != 0
+				|| setsockopt(queue->fd, SOL_XDP, XDP_RX_RING, &m_Config.ringSize, sizeof(m_Config.ringSize)) != 0
+				|| setsockopt(queue->fd, SOL_XDP, XDP_TX_RING, &m_Config.ringSize, sizeof(m_Config.ringSize)) != 0
+				|| getsockopt(queue->fd, SOL_XDP, XDP_MMAP_OFFSETS, &offsets, &optLen) != 0)
+		{
+			LOG_ERROR("Couldn't set up UMEM and rings of queue %d of device '%s': %s", queueId, m_InterfaceName.c_str(), strerror(errno));
+			close();
+			return false;
+		}
+
+		if (!mapXdpRing(queue->fd, queue->fill, offsets.fr, fillRingSize, sizeof(uint64_t), XDP_UMEM_PGOFF_FILL_RING)
+				|| !mapXdpRing(queue->fd, queue->completion, offsets.cr, completionRingSize, sizeof(uint64_t), XDP_UMEM_PGOFF_COMPLETION_RING)
+				|| !mapXdpRing(queue->fd, queue->rx, offsets.rx, m_Config.ringSize, sizeof(struct xdp_desc), XDP_PGOFF_RX_RING)
+				|| !mapXdpRing(queue->fd, queue->tx, offsets.tx, m_Config.ringSize, sizeof(struct xdp_desc), XDP_PGOFF_TX_RING))
+		{
+			LOG_ERROR("Couldn't map rings of queue %d of device '%s': %s", queueId, m_InterfaceName.c_str(), strerror(errno));
+			close();
+			return false;
+		}
+
+		// hand all RX frames to the kernel
+		uint64_t* fillDescs = (uint64_t*)queue->fill.descs;
+		uint32_t fillProducer = *queue->fill.producer;
+		for (uint32_t frame = 0; frame < numOfRxFrames; frame++)
+			fillDescs[(fillProducer + frame) & queue->fill.mask] = (uint64_t)frame * m_Config.frameSize;
+		xdpStoreRelease(queue->fill.producer, fillProducer + numOfRxFrames);
+
+		queue->txFreeFrames.reserve(m_Config.numOfFrames - numOfRxFrames);
+		for (uint32_t frame = numOfRxFrames; frame < m_Config.numOfFrames; frame++)
+			queue->txFreeFrames.push_back((uint64_t)frame * m_Config.frameSize);
+
+		struct sockaddr_xdp addr;
+		memset(&addr, 0, sizeof(addr));
+		addr.sxdp_family = AF_XDP;
+		addr.sxdp_ifindex = m_InterfaceIndex;
+		addr.sxdp_queue_id = queueId;
+		addr.sxdp_flags = XDP_USE_NEED_WAKEUP | XDP_COPY;
+		if (m_AttachMode == XdpAttachModeNative && m_Config.zeroCopy)
+		{
+			addr.sxdp_flags = XDP_USE_NEED_WAKEUP | XDP_ZEROCOPY;
+			if (bindXdpSocket(queue->fd, addr) != 0)
+			{
+				LOG_DEBUG("Driver of device '%s' doesn't support zero-copy (%s), using copy mode", m_InterfaceName.c_str(), strerror(errno));
+				addr.sxdp_flags = XDP_USE_NEED_WAKEUP | XDP_COPY;
+			}
+		}
+
+		if (!(addr.sxdp_flags & XDP_ZEROCOPY) && bindXdpSocket(queue->fd, addr) != 0)
+		{
+			LOG_ERROR("Couldn't bind AF_XDP socket to queue %d of device '%s': %s", queueId, m_InterfaceName.c_str(), strerror(errno));
+			close();
+			return false;
+		}
+
+		struct xdp_options options;
+		optLen = sizeof(options);
+		if (getsockopt(queue->fd, SOL_XDP, XDP_OPTIONS, &options, &optLen) != 0 || !(options.flags & XDP_OPTIONS_ZEROCOPY))
+			m_ZeroCopy = false;
+
+		union bpf_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		uint32_t key = queueId;
+		int value = queue->fd;
+		attr.map_fd = m_XskMapFd;
+		attr.key = (uint64_t)(unsigned long)&key;
+		attr.value = (uint64_t)(unsigned long)&value;
+		attr.flags = BPF_ANY;
+		if (xdpBpfSyscall(BPF_MAP_UPDATE_ELEM, &attr) != 0)
+		{
+			LOG_ERROR("Couldn't add the socket of queue %d to the XSKMAP of device '%s': %s", queueId, m_InterfaceName.c_str(), strerror(errno));
+			close();
+			return false;
+		}
+	}
+
+	LOG_DEBUG("Opened %d queues of device '%s' in %s mode, zero-copy is %s", numOfQueues, m_InterfaceName.c_str(),
+			(m_AttachMode == XdpAttachModeNative ? "native" : "generic"), (m_ZeroCopy ? "on" : "off"));
+
+	m_DeviceOpened = true;
+	return true;
+}
+
+void XdpDevice::close()
+{
+	stopCapture();
+
+	// detach the program first so packets go back to the kernel network stack before the sockets go away
+	detachProgram();
+
+	for (std::vector<XdpQueue*>::iterator iter = m_Queues.begin(); iter != m_Queues.end(); iter++)
+		freeXdpQueue(*iter);
+	m_Queues.clear();
+
+	m_ZeroCopy = false;
+	m_DeviceOpened = false;
+}
+
+uint16_t XdpDevice::receiveBurst(XdpQueue* queue, RawPacket* packets)
+{
+	XdpRing& rx = queue->rx;
+	uint32_t consumer = *rx.consumer;
+	uint32_t available = xdpLoadAcquire(rx.producer) - consumer;
+	if (available == 0)
+	{
+		// in need-wakeup mode the driver stops polling the fill ring when it runs out of frames
+		if (xdpLoadAcquire(queue->fill.flags) & XDP_RING_NEED_WAKEUP)
+			recvfrom(queue->fd, NULL, 0, MSG_DONTWAIT, NULL, NULL);
+		return 0;
+	}
+
+	uint16_t numOfPackets = (uint16_t)std::min<uint32_t>(available, m_Config.burstSize);
+
+	timespec timestamp;
+	clock_gettime(CLOCK_REALTIME, &timestamp);
+
+	struct xdp_desc* descs = (struct xdp_desc*)rx.descs;
+	for (uint16_t i = 0; i < numOfPackets; i++)
+	{
+		const struct xdp_desc& desc = descs[(consumer + i) & rx.mask];
+		// the packets point directly into the UMEM until releaseBurst() is called
+		new (&packets[i]) RawPacket(queue->umem + desc.addr, desc.len, timestamp, false);
+		queue->rxBytes += desc.len;
+	}
+
+	queue->rxPackets += numOfPackets;
+	return numOfPackets;
+}
+
+void XdpDevice::releaseBurst(XdpQueue* queue, RawPacket* packets, uint16_t numOfPackets)
+{
+	for (uint16_t i = 0; i < numOfPackets; i++)
+		packets[i].~RawPacket();
+
+	XdpRing& rx = queue->rx;
+	XdpRing& fill = queue->fill;
+	uint32_t rxConsumer = *rx.consumer;
+	uint32_t fillProducer = *fill.producer;
+	struct xdp_desc* rxDescs = (struct xdp_desc*)rx.descs;
+	uint64_t* fillDescs = (uint64_t*)fill.descs;
+	uint64_t frameMask = ~((uint64_t)m_Config.frameSize - 1);
+
+	// the fill ring can hold all RX frames so there is always room for the frames being returned
+	for (uint16_t i = 0; i < numOfPackets; i++)
+		fillDescs[(fillProducer + i) & fill.mask] = rxDescs[(rxConsumer + i) & rx.mask].addr & frameMask;
+
+	xdpStoreRelease(rx.consumer, rxConsumer + numOfPackets);
+	xdpStoreRelease(fill.producer, fillProducer + numOfPackets);
+}
+
+uint16_t XdpDevice::receivePackets(RawPacketVector& rawPacketsVec, uint16_t queueId, int timeoutMsec)
+{
+	if (!m_DeviceOpened)
+	{
+		LOG_ERROR("Device '%s' not opened", m_InterfaceName.c_str());
+		return 0;
+	}
+
+	if (queueId >= m_Queues.size())
+	{
+		LOG_ERROR("Queue %d isn't opened", queueId);
+		return 0;
+	}
+
+	XdpQueue* queue = m_Queues[queueId];
+	RawPacket* packets = (RawPacket*)queue->packetArray;
+
+	uint16_t numOfPackets = 0;
+	for (int attempt = 0; attempt < 2 && numOfPackets == 0; attempt++)
+	{
+		if (attempt == 1)
+		{
+			if (timeoutMsec == 0)
+				break;
+
+			struct pollfd pollFd;
+			pollFd.fd = queue->fd;
+			pollFd.events = POLLIN;
+			pollFd.revents = 0;
+			if (poll(&pollFd, 1, timeoutMsec) <= 0)
+				break;
+		}
+
+		numOfPackets = receiveBurst(queue, packets);
+		for (uint16_t i = 0; i < numOfPackets; i++)
+			rawPacketsVec.pushBack(new RawPacket(packets[i]));
+		releaseBurst(queue, packets, numOfPackets);
+	}
+
+	return numOfPackets;
+}
+
+uint16_t XdpDevice::sendPackets(const RawPacket* rawPacketsArr, uint16_t arrLength, uint16_t queueId)
+{
+	return sendBurst(rawPacketsArr, NULL, arrLength, queueId);
+}
+
+uint16_t XdpDevice::sendPackets(const RawPacketVector& rawPacketsVec, uint16_t queueId)
+{
+	if (rawPacketsVec.size() == 0)
+		return 0;
+
+	uint16_t numOfPackets = (rawPacketsVec.size() > 0xffff ? 0xffff : (uint16_t)rawPacketsVec.size());
+	return sendBurst(NULL, &(*rawPacketsVec.begin()), numOfPackets, queueId);
+}
+
+bool XdpDevice::sendPacket(const RawPacket& rawPacket, uint16_t queueId)
+{
+	return sendBurst(&rawPacket, NULL, 1, queueId) == 1;
+}
+
+uint16_t XdpDevice::sendBurst(const RawPacket* rawPacketsArr, const RawPacket* const* rawPacketPtrs, uint16_t numOfPackets, uint16_t queueId)
+{
+	if (!m_DeviceOpened)
+	{
+		LOG_ERROR("Device '%s' not opened", m_InterfaceName.c_str());
+		return 0;
+	}
+
+	if (queueId >= m_Queues.size())
+	{
+		LOG_ERROR("Queue %d isn't opened", queueId);
+		return 0;
+	}
+
+	XdpQueue* queue = m_Queues[queueId];
+
+	// reclaim the frames of packets the kernel already sent
+	XdpRing& completion = queue->completion;
+	uint32_t completionConsumer = *completion.consumer;
+	uint32_t completed = xdpLoadAcquire(completion.producer) - completionConsumer;
+	uint64_t* completionDescs = (uint64_t*)completion.descs;
+	for (uint32_t i = 0; i < completed; i++)
+		queue->txFreeFrames.push_back(completionDescs[(completionConsumer + i) & completion.mask]);
+	xdpStoreRelease(completion.consumer, completionConsumer + completed);
+
+	XdpRing& tx = queue->tx;
+	uint32_t txProducer = *tx.producer;
+	uint32_t txFree = tx.size - (txProducer - xdpLoadAcquire(tx.consumer));
+	struct xdp_desc* txDescs = (struct xdp_desc*)tx.descs;
+
+	// the packets are given either as an array or as an array of pointers. All of them are put on the TX ring before the kernel is kicked
+	uint16_t numOfPacketsSent = 0;
+	for (uint16_t i = 0; i < numOfPackets; i++)
+	{
+		const RawPacket& rawPacket = (rawPacketPtrs != NULL ? *rawPacketPtrs[i] : rawPacketsArr[i]);
+		int len = rawPacket.getRawDataLen();
+		if (len <= 0 || (uint32_t)len > m_Config.frameSize)
+		{
+			LOG_DEBUG("Packet of %d bytes doesn't fit in a frame of %d bytes", len, m_Config.frameSize);
+			queue->txDropped++;
+			continue;
+		}
+
+		if (txFree == 0 || queue->txFreeFrames.empty())
+		{
+			queue->txDropped += numOfPackets - i;
+			break;
+		}
+
+		uint64_t frame = queue->txFreeFrames.back();
+		queue->txFreeFrames.pop_back();
+		memcpy(queue->umem + frame, rawPacket.getRawData(), len);
+
+		struct xdp_desc& desc = txDescs[(txProducer + numOfPacketsSent) & tx.mask];
+		desc.addr = frame;
+		desc.len = len;
+		desc.options = 0;
+
+		numOfPacketsSent++;
+		txFree--;
+		queue->txBytes += len;
+	}
+
+	if (numOfPacketsSent == 0)
+		return 0;
+
+	xdpStoreRelease(tx.producer, txProducer + numOfPacketsSent);
+	queue->txPackets += numOfPacketsSent;
+
+	// in copy mode the kernel transmits only from the sendto() call, in zero-copy mode only when the driver asks for a wakeup
+	if (!m_ZeroCopy || (xdpLoadAcquire(tx.flags) & XDP_RING_NEED_WAKEUP))
+	{
+		if (sendto(queue->fd, NULL, 0, MSG_DONTWAIT, NULL, 0) < 0 && errno != EAGAIN && errno != EBUSY && errno != ENOBUFS && errno != ENETDOWN)
+			LOG_ERROR("Couldn't kick TX of queue %d of device '%s': %s", queueId, m_InterfaceName.c_str(), strerror(errno));
+	}
+
+	return numOfPacketsSent;
+}
+
+void* XdpDevice::captureThreadMain(void* ptr)
+{
+	XdpQueue* queue = (XdpQueue*)ptr;
+	XdpDevice* device = queue->device;
+	RawPacket* packets = (RawPacket*)queue->packetArray;
+
+	LOG_DEBUG("Starting capture thread of queue %d", queue->queueId);
+
+	PollingController& poller = queue->poller;
+	poller.reset(device->m_PollingPolicy);
+
+	while (!device->m_StopThread)
+	{
+		uint16_t numOfPackets = device->receiveBurst(queue, packets);
+		if (numOfPackets > 0)
+		{
+			device->m_OnPacketsArrive(packets, numOfPackets, (uint8_t)queue->queueId, device, device->m_OnPacketsArriveUserCookie);
+			device->releaseBurst(queue, packets, numOfPackets);
+		}
+
+		if (poller.onPoll(numOfPackets) == PollingController::WaitForInterrupt)
+		{
+			struct pollfd pollFd;
+			pollFd.fd = queue->fd;
+			pollFd.events = POLLIN;
+			pollFd.revents = 0;
+			poll(&pollFd, 1, poller.getPolicy().interruptTimeoutMsec);
+			poller.onInterruptWaitDone();
+		}
+	}
+
+	LOG_DEBUG("Exiting capture thread of queue %d", queue->queueId);
+	return (void*)NULL;
+}
+
+bool XdpDevice::startCaptureThread(XdpQueue* queue, int coreId)
+{
+	pthread_t thread;
+	int err = pthread_create(&thread, NULL, captureThreadMain, (void*)queue);
+	if (err != 0)
+	{
+		LOG_ERROR("Cannot create capture thread of queue %d of device '%s': [%s]", queue->queueId, m_InterfaceName.c_str(), strerror(err));
+		return false;
+	}
+
+	m_CaptureThreads.push_back(thread);
+
+	if (coreId < 0)
+		return true;
+
+	cpu_set_t cpuset;
+	CPU_ZERO(&cpuset);
+	CPU_SET(coreId, &cpuset);
+	if ((err = pthread_setaffinity_np(thread, sizeof(cpu_set_t), &cpuset)) != 0)
+	{
+		LOG_ERROR("Error while binding thread to core %d: errno=%i", coreId, err);
+		return false;
+	}
+
+	return true;
+}
+
+bool XdpDevice::startCaptureSingleThread(OnXdpPacketsArriveCallback onPacketsArrive, void* onPacketsArriveUserCookie)
+{
+	if (m_Queues.size() != 1)
+	{
+		LOG_ERROR("Single thread capture requires exactly one opened queue, device '%s' has %d", m_InterfaceName.c_str(), (int)m_Queues.size());
+		return false;
+	}
+
+	return startCaptureMultiThreads(onPacketsArrive, onPacketsArriveUserCookie, CoreMask());
+}
+
+bool XdpDevice::startCaptureMultiThreads(OnXdpPacketsArriveCallback onPacketsArrive, void* onPacketsArriveUserCookie, const CoreMask& coreMask)
+{
+	if (!m_DeviceOpened)
+	{
+		LOG_ERROR("Device '%s' not opened", m_InterfaceName.c_str());
+		return false;
+	}
+
+	if (isCapturing())
+	{
+		LOG_ERROR("Device '%s' is already capturing", m_InterfaceName.c_str());
+		return false;
+	}
+
+	if (onPacketsArrive == NULL)
+	{
+		LOG_ERROR("Capture callback is NULL");
+		return false;
+	}
+
+	// an empty core mask (used by startCaptureSingleThread) means the threads aren't pinned
+	if (!coreMask.isEmpty() && coreMask.getCoreCount() != (int)m_Queues.size())
+	{
+		LOG_ERROR("Core mask has %d cores but %d queues are opened", coreMask.getCoreCount(), (int)m_Queues.size());
+		return false;
+	}
+
+	m_OnPacketsArrive = onPacketsArrive;
+	m_OnPacketsArriveUserCookie = onPacketsArriveUserCookie;
+	m_StopThread = false;
+
+	int coreId = coreMask.getFirstCore();
+	for (std::vector<XdpQueue*>::iterator iter = m_Queues.begin(); iter != m_Queues.end(); iter++)
+	{
+		if (!startCaptureThread(*iter, coreId))
+		{
+			stopCapture();
+			return false;
+		}
+
+		if (coreId >= 0)
+			coreId = coreMask.getNextCore(coreId);
+	}
+
+	LOG_DEBUG("Capture started on %d queues of device '%s'", (int)m_Queues.size(), m_InterfaceName.c_str());
+	return true;
+}
+
+void XdpDevice::stopCapture()
+{
+	m_StopThread = true;
+	for (std::vector<pthread_t>::iterator iter = m_CaptureThreads.begin(); iter != m_CaptureThreads.end(); iter++)
+		pthread_join(*iter, NULL);
+	m_CaptureThreads.clear();
+}
+
+bool XdpDevice::setPollingPolicy(const PollingPolicy& policy)
+{
+	if (isCapturing())
+	{
+		LOG_ERROR("Cannot change the polling policy of device '%s' while capturing", m_InterfaceName.c_str());
+		return false;
+	}
+
+	m_PollingPolicy = policy;
+	return true;
+}
+
+void XdpDevice::getPollingStats(PollingStats& stats, uint16_t queueId) const
+{
+	stats.clear();
+	if (queueId < m_Queues.size())
+		stats = m_Queues[queueId]->poller.getStats();
+}
+
+void XdpDevice::getPollingStats(PollingStats& stats) const
+{
+	stats.clear();
+	for (std::vector<XdpQueue*>::const_iterator iter = m_Queues.begin(); iter != m_Queues.end(); iter++)
+		stats.add((*iter)->poller.getStats());
+}
+
+void XdpDevice::getStatistics(XdpStats& stats, uint16_t queueId) const
+{
+	memset(&stats, 0, sizeof(stats));
+	if (queueId >= m_Queues.size())
+		return;
+
+	XdpQueue* queue = m_Queues[queueId];
+	stats.rxPackets = queue->rxPackets;
+	stats.rxBytes = queue->rxBytes;
+	stats.txPackets = queue->txPackets;
+	stats.txBytes = queue->txBytes;
+	stats.txDropped = queue->txDropped;
+
+	// older kernels return a shorter struct, the missing counters remain 0
+	struct xdp_statistics kernelStats;
+	memset(&kernelStats, 0, sizeof(kernelStats));
+	socklen_t optLen = sizeof(kernelStats);
+	if (getsockopt(queue->fd, SOL_XDP, XDP_STATISTICS, &kernelStats, &optLen) != 0)
+	{
+		LOG_DEBUG("Couldn't read kernel statistics of queue %d of device '%s': %s", queueId, m_InterfaceName.c_str(), strerror(errno));
+		return;
+	}
+
+	stats.rxDroppedByKernel = kernelStats.rx_dropped;
+	stats.rxRingFull = kernelStats.rx_ring_full;
+	stats.fillRingEmpty = kernelStats.rx_fill_ring_empty_descs;
+	stats.rxInvalidDescs = kernelStats.rx_invalid_descs;
+	stats.txInvalidDescs = kernelStats.tx_invalid_descs;
+}
+
+void XdpDevice::getStatistics(XdpStats& stats) const
+{
+	memset(&stats, 0, sizeof(stats));
+	for (uint16_t queueId = 0; queueId < m_Queues.size(); queueId++)
+	{
+		XdpStats queueStats;
+		getStatistics(queueStats, queueId);
+		stats.rxPackets += queueStats.rxPackets;
+		stats.rxBytes += queueStats.rxBytes;
+		stats.txPackets += queueStats.txPackets;
+		stats.txBytes += queueStats.txBytes;
+		stats.txDropped += queueStats.txDropped;
+		stats.rxDroppedByKernel += queueStats.rxDroppedByKernel;
+		stats.rxRingFull += queueStats.rxRingFull;
+		stats.fillRingEmpty += queueStats.fillRingEmpty;
+		stats.rxInvalidDescs += queueStats.rxInvalidDescs;
+		stats.txInvalidDescs += queueStats.txInvalidDescs;
+	}
+}
+
+} // namespace pcpp
+
+#endif /* USE_XDP */
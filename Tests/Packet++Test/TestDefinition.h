@@ -19,6 +19,7 @@ PTF_TEST_CASE(VxlanParsingAndCreationTest);
 PTF_TEST_CASE(IPv4PacketCreation);
 PTF_TEST_CASE(IPv4PacketParsing);
 PTF_TEST_CASE(IPv4FragmentationTest);
+PTF_TEST_CASE(IPv4PacketFragmentationTest);
 PTF_TEST_CASE(IPv4OptionsParsingTest);
 PTF_TEST_CASE(IPv4OptionsEditTest);
 PTF_TEST_CASE(IPv4UdpChecksum);
@@ -26,6 +27,7 @@ PTF_TEST_CASE(IPv4UdpChecksum);
 // Implemented in IPv6Tests.cpp
 PTF_TEST_CASE(IPv6UdpPacketParseAndCreate);
 PTF_TEST_CASE(IPv6FragmentationTest);
+PTF_TEST_CASE(IPv6PacketFragmentationTest);
 PTF_TEST_CASE(IPv6ExtensionsTest);
 
 // Implemented in TcpTests.cpp
@@ -51,6 +53,8 @@ PTF_TEST_CASE(RawPacketTimeStampSetterTest);
 PTF_TEST_CASE(ParsePartialPacketTest);
 PTF_TEST_CASE(PacketTrailerTest);
 PTF_TEST_CASE(ResizeLayerTest);
+PTF_TEST_CASE(PacketCloneTest);
+PTF_TEST_CASE(RawPacketRefCountTest);
 
 // Implemented in HttpTests.cpp
 PTF_TEST_CASE(HttpRequestLayerParsingTest);
@@ -143,3 +147,33 @@ PTF_TEST_CASE(BgpLayerEditTest);
 // Implemented in SSHTests.cpp
 PTF_TEST_CASE(SSHParsingTest);
 PTF_TEST_CASE(SSHMalformedParsingTest);
+
+// Implemented in PacketGeneratorTests.cpp
+PTF_TEST_CASE(PacketGeneratorUdpTest);
+PTF_TEST_CASE(PacketGeneratorTcpBurstTest);
+PTF_TEST_CASE(PacketGeneratorInvalidSettingsTest);
+
+// Implemented in VoipCallTrackerTests.cpp
+PTF_TEST_CASE(VoipCallTrackerSipRtpTest);
+PTF_TEST_CASE(VoipCallTrackerCallLifecycleTest);
+
+// Implemented in ProtocolStatsTests.cpp
+PTF_TEST_CASE(ProtocolStatsHierarchyTest);
+PTF_TEST_CASE(ProtocolStatsTimeBucketsAndMergeTest);
+
+// Implemented in TrafficStatsCollectorsTests.cpp
+PTF_TEST_CASE(StringCounterTableTest);
+PTF_TEST_CASE(HttpTrafficStatsCollectorTest);
+PTF_TEST_CASE(SSLTrafficStatsCollectorTest);
+
+// Implemented in DnsResponderTests.cpp
+PTF_TEST_CASE(DnsResponderIPv4Test);
+PTF_TEST_CASE(DnsResponderIPv6AndNameErrorTest);
+
+// Implemented in StackParserTests.cpp
+PTF_TEST_CASE(StackParserTest);
+PTF_TEST_CASE(StackParserVlanAndGtpTest);
+
+// Implemented in PacketBuilderTests.cpp
+PTF_TEST_CASE(PacketBuilderEthIPv4TcpTest);
+PTF_TEST_CASE(PacketBuilderUserBufferTest);
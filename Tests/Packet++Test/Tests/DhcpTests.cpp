@@ -72,6 +72,15 @@ PTF_TEST_CASE(DhcpParsingTest)
 	PTF_ASSERT_EQUAL(dhcpLayer->getOptionData(pcpp::DHCPOPT_DHCP_LEASE_TIME).getValueAs<uint32_t>(), htobe32(43200), u32);
 	PTF_ASSERT_EQUAL(dhcpLayer->getOptionData(pcpp::DHCPOPT_TFTP_SERVER_NAME).getValueAsString(), "172.22.178.234", string);
 
+	pcpp::DhcpOptionTypes batchOptTypeArr[] = { pcpp::DHCPOPT_DHCP_LEASE_TIME, pcpp::DHCPOPT_IRC_SERVER, pcpp::DHCPOPT_SUBNET_MASK, pcpp::DHCPOPT_DHCP_LEASE_TIME };
+	std::vector<pcpp::DhcpOption> batchOpts;
+	PTF_ASSERT_EQUAL(dhcpLayer->getOptionsData(batchOptTypeArr, 4, batchOpts), 3, size);
+	PTF_ASSERT_EQUAL(batchOpts.size(), 4, size);
+	PTF_ASSERT_EQUAL(batchOpts[0].getValueAs<uint32_t>(), htobe32(43200), u32);
+	PTF_ASSERT_TRUE(batchOpts[1].isNull());
+	PTF_ASSERT_EQUAL(batchOpts[2].getValueAsIpAddr(), pcpp::IPv4Address("255.255.255.0"), object);
+	PTF_ASSERT_TRUE(batchOpts[3] == batchOpts[0]);
+
 	PTF_ASSERT_EQUAL(dhcpLayer->getMesageType(), pcpp::DHCP_OFFER, enum);
 
 
@@ -231,6 +240,8 @@ PTF_TEST_CASE(DhcpEditTest)
 
 	PTF_ASSERT_TRUE(dhcpLayer->removeOption(pcpp::DHCPOPT_DHCP_MAX_MESSAGE_SIZE));
 
+	PTF_ASSERT_TRUE(dhcpLayer->getOptionData(pcpp::DHCPOPT_TFTP_SERVER_NAME).isNull());
+
 	pcpp::DhcpOption opt = dhcpLayer->getOptionData(pcpp::DHCPOPT_SUBNET_MASK);
 	pcpp::IPv4Address newSubnet("255.255.255.0");
 	opt.setValueIpAddr(newSubnet);
@@ -245,6 +256,9 @@ PTF_TEST_CASE(DhcpEditTest)
 	opt = dhcpLayer->addOptionAfter(pcpp::DhcpOptionBuilder(pcpp::DHCPOPT_DHCP_SERVER_IDENTIFIER, newRouter), pcpp::DHCPOPT_DHCP_MESSAGE_TYPE);
 	PTF_ASSERT_FALSE(opt.isNull());
 
+	PTF_ASSERT_TRUE(dhcpLayer->getOptionData(pcpp::DHCPOPT_DHCP_SERVER_IDENTIFIER) == opt);
+	PTF_ASSERT_EQUAL(dhcpLayer->getOptionData(pcpp::DHCPOPT_ROUTERS).getValueAsIpAddr(), newRouter, object);
+
 	dhcpPacket.computeCalculateFields();
 
 	READ_FILE_INTO_BUFFER(2, "PacketExamples/Dhcp3.dat");
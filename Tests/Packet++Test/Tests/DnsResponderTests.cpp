@@ -0,0 +1,221 @@
+#include "../TestDefinition.h"
+#include "EndianPortable.h"
+#include "Logger.h"
+#include "Packet.h"
+#include "EthLayer.h"
+#include "VlanLayer.h"
+#include "IPv4Layer.h"
+#include "IPv6Layer.h"
+#include "UdpLayer.h"
+#include "DnsLayer.h"
+#include "DnsResponder.h"
+#include "SystemUtils.h"
+
+
+static void createDnsQuery(pcpp::Packet& packet, bool ipv6, bool withVlan, const std::string& name, pcpp::DnsType dnsType, bool withEdns)
+{
+	packet.addLayer(new pcpp::EthLayer(pcpp::MacAddress("aa:bb:cc:dd:ee:01"), pcpp::MacAddress("aa:bb:cc:dd:ee:02")), true);
+	if (withVlan)
+		packet.addLayer(new pcpp::VlanLayer(100, false, 0, PCPP_ETHERTYPE_IP), true);
+
+	if (ipv6)
+	{
+		pcpp::IPv6Layer* ipv6Layer = new pcpp::IPv6Layer(pcpp::IPv6Address("2001:db8::1"), pcpp::IPv6Address("2001:db8::53"));
+		ipv6Layer->getIPv6Header()->hopLimit = 64;
+		packet.addLayer(ipv6Layer, true);
+	}
+	else
+	{
+		pcpp::IPv4Layer* ipv4Layer = new pcpp::IPv4Layer(pcpp::IPv4Address("10.0.0.1"), pcpp::IPv4Address("10.0.0.53"));
+		ipv4Layer->getIPv4Header()->timeToLive = 64;
+		packet.addLayer(ipv4Layer, true);
+	}
+
+	packet.addLayer(new pcpp::UdpLayer(40000, 53), true);
+
+	pcpp::DnsLayer* dnsLayer = new pcpp::DnsLayer();
+	packet.addLayer(dnsLayer, true);
+	dnsLayer->getDnsHeader()->transactionID = htobe16(0x1234);
+	dnsLayer->getDnsHeader()->recursionDesired = 1;
+	dnsLayer->addQuery(name, dnsType, pcpp::DNS_CLASS_IN);
+	if (withEdns)
+	{
+		pcpp::GenericDnsResourceData ednsData("000a000812345678abcdef01");
+		dnsLayer->addAdditionalRecord("", pcpp::DNS_TYPE_OPT, 4096, 0, &ednsData);
+	}
+
+	packet.computeCalculateFields();
+}
+
+
+// verify the incrementally updated checksums by recomputing them on a copy of the packet
+static bool checksumsMatch(const pcpp::RawPacket& response)
+{
+	pcpp::RawPacket responseCopy(response);
+	pcpp::Packet responsePacket(&responseCopy);
+	pcpp::UdpLayer* udpLayer = responsePacket.getLayerOfType<pcpp::UdpLayer>();
+	pcpp::IPv4Layer* ipv4Layer = responsePacket.getLayerOfType<pcpp::IPv4Layer>();
+	if (udpLayer == NULL)
+		return false;
+
+	uint16_t udpChecksum = udpLayer->getUdpHeader()->headerChecksum;
+	uint16_t ipChecksum = (ipv4Layer != NULL ? ipv4Layer->getIPv4Header()->headerChecksum : 0);
+	responsePacket.computeCalculateFields();
+
+	if (ipv4Layer != NULL && ipv4Layer->getIPv4Header()->headerChecksum != ipChecksum)
+		return false;
+
+	return udpLayer->getUdpHeader()->headerChecksum == udpChecksum;
+}
+
+
+PTF_TEST_CASE(DnsResponderIPv4Test)
+{
+	pcpp::DnsResponder responder;
+	PTF_ASSERT_TRUE(responder.addARecord("www.Example.com", 300, pcpp::IPv4Address("192.0.2.10")));
+	PTF_ASSERT_TRUE(responder.addARecord("www.example.com", 300, pcpp::IPv4Address("192.0.2.11")));
+	PTF_ASSERT_TRUE(responder.addNameRecord("ftp.example.com", pcpp::DNS_TYPE_CNAME, 60, "www.example.com"));
+	PTF_ASSERT_TRUE(responder.addARecord("*", 5, pcpp::IPv4Address("127.0.0.1")));
+	pcpp::LoggerPP::getInstance().supressErrors();
+	PTF_ASSERT_FALSE(responder.addARecord("bad..name", 5, pcpp::IPv4Address("127.0.0.1")));
+	pcpp::LoggerPP::getInstance().enableErrors();
+	PTF_ASSERT_EQUAL(responder.getNumOfRecords(), 4, size);
+
+	// a query with an EDNS record, in different case than the record name
+	pcpp::Packet queryPacket(100);
+	createDnsQuery(queryPacket, false, false, "WWW.example.COM", pcpp::DNS_TYPE_A, true);
+	pcpp::RawPacket response(*queryPacket.getRawPacket());
+	PTF_ASSERT_EQUAL(responder.createResponse(response), pcpp::DnsResponder::ResponseCreated, enum);
+	PTF_ASSERT_TRUE(checksumsMatch(response));
+
+	pcpp::Packet responsePacket(&response);
+	pcpp::EthLayer* ethLayer = responsePacket.getLayerOfType<pcpp::EthLayer>();
+	PTF_ASSERT_NOT_NULL(ethLayer);
+	PTF_ASSERT_EQUAL(ethLayer->getSourceMac(), pcpp::MacAddress("aa:bb:cc:dd:ee:02"), object);
+	PTF_ASSERT_EQUAL(ethLayer->getDestMac(), pcpp::MacAddress("aa:bb:cc:dd:ee:01"), object);
+	pcpp::IPv4Layer* ipLayer = responsePacket.getLayerOfType<pcpp::IPv4Layer>();
+	PTF_ASSERT_NOT_NULL(ipLayer);
+	PTF_ASSERT_EQUAL(ipLayer->getSrcIpAddress(), pcpp::IPv4Address("10.0.0.53"), object);
+	PTF_ASSERT_EQUAL(ipLayer->getDstIpAddress(), pcpp::IPv4Address("10.0.0.1"), object);
+	PTF_ASSERT_EQUAL(be16toh(ipLayer->getIPv4Header()->totalLength), (uint16_t)(response.getRawDataLen() - sizeof(pcpp::ether_header)), u16);
+	pcpp::UdpLayer* udpLayer = responsePacket.getLayerOfType<pcpp::UdpLayer>();
+	PTF_ASSERT_NOT_NULL(udpLayer);
+	PTF_ASSERT_EQUAL(be16toh(udpLayer->getUdpHeader()->portSrc), 53, u16);
+	PTF_ASSERT_EQUAL(be16toh(udpLayer->getUdpHeader()->portDst), 40000, u16);
+
+	pcpp::DnsLayer* dnsLayer = responsePacket.getLayerOfType<pcpp::DnsLayer>();
+	PTF_ASSERT_NOT_NULL(dnsLayer);
+	PTF_ASSERT_EQUAL(be16toh(dnsLayer->getDnsHeader()->transactionID), 0x1234, hex);
+	PTF_ASSERT_EQUAL(dnsLayer->getDnsHeader()->queryOrResponse, 1, u16);
+	PTF_ASSERT_EQUAL(dnsLayer->getDnsHeader()->authoritativeAnswer, 1, u16);
+	PTF_ASSERT_EQUAL(dnsLayer->getDnsHeader()->recursionDesired, 1, u16);
+	PTF_ASSERT_EQUAL(dnsLayer->getDnsHeader()->responseCode, 0, u16);
+	PTF_ASSERT_EQUAL(dnsLayer->getQueryCount(), 1, size);
+	PTF_ASSERT_EQUAL(dnsLayer->getAnswerCount(), 2, size);
+	PTF_ASSERT_EQUAL(dnsLayer->getAdditionalRecordCount(), 0, size);
+	pcpp::DnsResource* answer = dnsLayer->getFirstAnswer();
+	PTF_ASSERT_NOT_NULL(answer);
+	PTF_ASSERT_EQUAL(answer->getName(), "WWW.example.COM", string);
+	PTF_ASSERT_EQUAL(answer->getDnsType(), pcpp::DNS_TYPE_A, enum);
+	PTF_ASSERT_EQUAL(answer->getTTL(), 300, u32);
+	PTF_ASSERT_EQUAL(answer->getData()->toString(), "192.0.2.10", string);
+	answer = dnsLayer->getNextAnswer(answer);
+	PTF_ASSERT_NOT_NULL(answer);
+	PTF_ASSERT_EQUAL(answer->getData()->toString(), "192.0.2.11", string);
+
+	// a CNAME query with VLAN, whose question ends at an odd offset, and a query that matches the wildcard record
+	pcpp::Packet cnameQueryPacket(100);
+	createDnsQuery(cnameQueryPacket, false, true, "ftp.example.com", pcpp::DNS_TYPE_CNAME, false);
+	pcpp::RawPacket cnameResponse(*cnameQueryPacket.getRawPacket());
+	PTF_ASSERT_EQUAL(responder.createResponse(cnameResponse), pcpp::DnsResponder::ResponseCreated, enum);
+	PTF_ASSERT_TRUE(checksumsMatch(cnameResponse));
+	pcpp::Packet cnameResponsePacket(&cnameResponse);
+	PTF_ASSERT_TRUE(cnameResponsePacket.isPacketOfType(pcpp::VLAN));
+	dnsLayer = cnameResponsePacket.getLayerOfType<pcpp::DnsLayer>();
+	PTF_ASSERT_NOT_NULL(dnsLayer);
+	PTF_ASSERT_EQUAL(dnsLayer->getAnswerCount(), 1, size);
+	PTF_ASSERT_EQUAL(dnsLayer->getFirstAnswer()->getData()->toString(), "www.example.com", string);
+
+	pcpp::Packet wildcardQueryPacket(100);
+	createDnsQuery(wildcardQueryPacket, false, false, "tracker.example.net", pcpp::DNS_TYPE_A, true);
+	pcpp::RawPacket wildcardResponse(*wildcardQueryPacket.getRawPacket());
+	PTF_ASSERT_EQUAL(responder.createResponse(wildcardResponse), pcpp::DnsResponder::ResponseCreated, enum);
+	PTF_ASSERT_TRUE(checksumsMatch(wildcardResponse));
+	pcpp::Packet wildcardResponsePacket(&wildcardResponse);
+	dnsLayer = wildcardResponsePacket.getLayerOfType<pcpp::DnsLayer>();
+	PTF_ASSERT_NOT_NULL(dnsLayer);
+	PTF_ASSERT_EQUAL(dnsLayer->getFirstAnswer()->getData()->toString(), "127.0.0.1", string);
+	PTF_ASSERT_EQUAL(dnsLayer->getFirstAnswer()->getTTL(), 5, u32);
+
+	// a response isn't a query, so answering it again does nothing
+	int responseLen = response.getRawDataLen();
+	PTF_ASSERT_EQUAL(responder.createResponse(response), pcpp::DnsResponder::NotSupportedQuery, enum);
+	PTF_ASSERT_EQUAL(response.getRawDataLen(), responseLen, int);
+} // DnsResponderIPv4Test
+
+
+
+PTF_TEST_CASE(DnsResponderIPv6AndNameErrorTest)
+{
+	pcpp::DnsResponder responder(false);
+	PTF_ASSERT_TRUE(responder.addAAAARecord("host.example.org", 120, pcpp::IPv6Address("2001:db8::10")));
+
+	pcpp::Packet queryPacket(100);
+	createDnsQuery(queryPacket, true, false, "host.example.org", pcpp::DNS_TYPE_AAAA, true);
+	pcpp::RawPacket response(*queryPacket.getRawPacket());
+	// the response fits in the stated buffer capacity, so the data is appended without reallocating
+	uint8_t* buffer = new uint8_t[1500];
+	memcpy(buffer, response.getRawData(), response.getRawDataLen());
+	pcpp::RawPacket bufferResponse(buffer, response.getRawDataLen(), response.getPacketTimeStamp(), true);
+	PTF_ASSERT_EQUAL(responder.createResponse(bufferResponse, 1500), pcpp::DnsResponder::ResponseCreated, enum);
+	PTF_ASSERT_TRUE(bufferResponse.getRawData() == buffer);
+	PTF_ASSERT_TRUE(checksumsMatch(bufferResponse));
+
+	pcpp::Packet responsePacket(&bufferResponse);
+	pcpp::IPv6Layer* ipLayer = responsePacket.getLayerOfType<pcpp::IPv6Layer>();
+	PTF_ASSERT_NOT_NULL(ipLayer);
+	PTF_ASSERT_EQUAL(ipLayer->getSrcIpAddress(), pcpp::IPv6Address("2001:db8::53"), object);
+	PTF_ASSERT_EQUAL(ipLayer->getDstIpAddress(), pcpp::IPv6Address("2001:db8::1"), object);
+	pcpp::DnsLayer* dnsLayer = responsePacket.getLayerOfType<pcpp::DnsLayer>();
+	PTF_ASSERT_NOT_NULL(dnsLayer);
+	PTF_ASSERT_EQUAL(dnsLayer->getDnsHeader()->authoritativeAnswer, 0, u16);
+	PTF_ASSERT_EQUAL(dnsLayer->getAnswerCount(), 1, size);
+	PTF_ASSERT_EQUAL(dnsLayer->getFirstAnswer()->getData()->toString(), "2001:db8::10", string);
+
+	// unknown names and types are left unchanged unless name errors are enabled
+	pcpp::Packet unknownQueryPacket(100);
+	createDnsQuery(unknownQueryPacket, true, false, "host.example.org", pcpp::DNS_TYPE_A, false);
+	pcpp::RawPacket unknownResponse(*unknownQueryPacket.getRawPacket());
+	PTF_ASSERT_EQUAL(responder.createResponse(unknownResponse), pcpp::DnsResponder::NoMatchingRecords, enum);
+	PTF_ASSERT_BUF_COMPARE(unknownResponse.getRawData(), unknownQueryPacket.getRawPacket()->getRawData(), unknownResponse.getRawDataLen());
+
+	responder.setNameErrorForUnknownNames(true);
+	PTF_ASSERT_EQUAL(responder.createResponse(unknownResponse), pcpp::DnsResponder::NameErrorResponseCreated, enum);
+	PTF_ASSERT_TRUE(checksumsMatch(unknownResponse));
+	pcpp::Packet nameErrorPacket(&unknownResponse);
+	dnsLayer = nameErrorPacket.getLayerOfType<pcpp::DnsLayer>();
+	PTF_ASSERT_NOT_NULL(dnsLayer);
+	PTF_ASSERT_EQUAL(dnsLayer->getDnsHeader()->queryOrResponse, 1, u16);
+	PTF_ASSERT_EQUAL(dnsLayer->getDnsHeader()->responseCode, 3, u16);
+	PTF_ASSERT_EQUAL(dnsLayer->getAnswerCount(), 0, size);
+
+	// answers that don't fit in 512 bytes
+	pcpp::DnsResponder largeResponder;
+	uint8_t txtData[255];
+	memset(txtData, 'a', sizeof(txtData));
+	txtData[0] = 254;
+	for (int i = 0; i < 3; i++)
+	{
+		PTF_ASSERT_TRUE(largeResponder.addRecord("host.example.org", pcpp::DNS_TYPE_TXT, 60, txtData, sizeof(txtData)));
+	}
+	pcpp::Packet txtQueryPacket(100);
+	createDnsQuery(txtQueryPacket, true, false, "host.example.org", pcpp::DNS_TYPE_TXT, false);
+	pcpp::RawPacket txtResponse(*txtQueryPacket.getRawPacket());
+	PTF_ASSERT_EQUAL(largeResponder.createResponse(txtResponse), pcpp::DnsResponder::ResponseTooLarge, enum);
+
+	// non-DNS packets aren't changed
+	pcpp::RawPacket nonDnsPacket(*queryPacket.getRawPacket());
+	pcpp::Packet parsedNonDnsPacket(&nonDnsPacket);
+	parsedNonDnsPacket.getLayerOfType<pcpp::UdpLayer>()->getUdpHeader()->portDst = htobe16(5353);
+	PTF_ASSERT_EQUAL(responder.createResponse(nonDnsPacket), pcpp::DnsResponder::NotSupportedQuery, enum);
+} // DnsResponderIPv6AndNameErrorTest
@@ -176,6 +176,10 @@ PTF_TEST_CASE(EthDot3LayerCreateEditTest)
 	newEthDot3Packet.computeCalculateFields();
 
 	PTF_ASSERT_BUF_COMPARE(newEthDot3Packet.getRawPacket()->getRawData(), buffer1, bufferLength1);
+	PTF_ASSERT_TRUE(newEthDot3Packet.isPacketOfType(pcpp::EthernetDot3));
+	PTF_ASSERT_FALSE(newEthDot3Packet.isPacketOfType(pcpp::Ethernet));
+	PTF_ASSERT_TRUE(newEthDot3Packet.getLayerOfType<pcpp::EthDot3Layer>() == &ethDot3NewLayer);
+	PTF_ASSERT_NULL(newEthDot3Packet.getLayerOfType<pcpp::EthLayer>());
 
 
 	// edit an EthDot3 packet
@@ -9,6 +9,8 @@
 #include "IPv4Layer.h"
 #include "UdpLayer.h"
 #include "PayloadLayer.h"
+#include "IPReassembly.h"
+#include "IPFragmentation.h"
 #include "SystemUtils.h"
 
 PTF_TEST_CASE(IPv4PacketCreation)
@@ -154,6 +156,121 @@ PTF_TEST_CASE(IPv4FragmentationTest)
 
 
 
+PTF_TEST_CASE(IPv4PacketFragmentationTest)
+{
+	timeval time;
+	gettimeofday(&time, NULL);
+
+	READ_FILE_AND_CREATE_PACKET(1, "PacketExamples/IPv4Frag1.dat");
+	READ_FILE_AND_CREATE_PACKET(2, "PacketExamples/IPv4Frag2.dat");
+	READ_FILE_AND_CREATE_PACKET(3, "PacketExamples/IPv4Frag3.dat");
+
+	pcpp::RawPacket* origFrags[3] = { &rawPacket1, &rawPacket2, &rawPacket3 };
+
+	// reassemble the original packet out of the fragments
+	pcpp::IPReassembly ipReassembly;
+	pcpp::IPReassembly::ReassemblyStatus status;
+	pcpp::Packet* reassembledPacket = NULL;
+	for (int i = 0; i < 3; i++)
+	{
+		pcpp::Packet fragPacket(origFrags[i]);
+		reassembledPacket = ipReassembly.processPacket(&fragPacket, status);
+	}
+	PTF_ASSERT_EQUAL(status, pcpp::IPReassembly::REASSEMBLED, enum);
+	PTF_ASSERT_NOT_NULL(reassembledPacket);
+
+	// fragment the reassembled packet with the same MTU and compare to the original fragments
+	pcpp::IPFragmentation ipFrag(1500);
+	size_t maxFragLen = 0;
+	PTF_ASSERT_EQUAL(ipFrag.getNumOfFragments(reassembledPacket, maxFragLen), 3, int);
+	PTF_ASSERT_EQUAL(maxFragLen, (size_t)rawPacket1.getRawDataLen(), size);
+
+	pcpp::PointerVector<pcpp::RawPacket> fragments;
+	PTF_ASSERT_EQUAL(ipFrag.fragmentPacket(reassembledPacket, fragments), 3, int);
+	PTF_ASSERT_EQUAL(fragments.size(), 3, size);
+	for (int i = 0; i < 3; i++)
+	{
+		PTF_ASSERT_EQUAL(fragments.at(i)->getRawDataLen(), origFrags[i]->getRawDataLen(), int);
+		PTF_ASSERT_BUF_COMPARE(fragments.at(i)->getRawData(), origFrags[i]->getRawData(), origFrags[i]->getRawDataLen());
+	}
+
+	// fragment into pre-allocated buffers
+	uint8_t buffers[3][1600];
+	pcpp::IPFragmentation::FragmentBuffer fragBuffers[3];
+	for (int i = 0; i < 3; i++)
+	{
+		fragBuffers[i].data = buffers[i];
+		fragBuffers[i].capacity = sizeof(buffers[i]);
+		fragBuffers[i].len = 0;
+	}
+	pcpp::LoggerPP::getInstance().supressErrors();
+	PTF_ASSERT_EQUAL(ipFrag.fragmentPacket(reassembledPacket, fragBuffers, 2), -1, int);
+	pcpp::LoggerPP::getInstance().enableErrors();
+	PTF_ASSERT_EQUAL(ipFrag.fragmentPacket(reassembledPacket, fragBuffers, 3), 3, int);
+	for (int i = 0; i < 3; i++)
+	{
+		PTF_ASSERT_EQUAL(fragBuffers[i].len, (size_t)origFrags[i]->getRawDataLen(), size);
+		PTF_ASSERT_BUF_COMPARE(fragBuffers[i].data, origFrags[i]->getRawData(), origFrags[i]->getRawDataLen());
+	}
+
+	// every fragment should parse and have a valid checksum
+	for (int i = 0; i < 3; i++)
+	{
+		pcpp::Packet fragPacket(fragments.at(i));
+		pcpp::IPv4Layer* ipLayer = fragPacket.getLayerOfType<pcpp::IPv4Layer>();
+		PTF_ASSERT_NOT_NULL(ipLayer);
+		uint16_t checksum = ipLayer->getIPv4Header()->headerChecksum;
+		ipLayer->computeCalculateFields();
+		PTF_ASSERT_EQUAL(ipLayer->getIPv4Header()->headerChecksum, checksum, u16);
+	}
+
+	// a packet that fits the MTU isn't fragmented
+	ipFrag.setMtu(5000);
+	PTF_ASSERT_EQUAL(ipFrag.getNumOfFragments(reassembledPacket, maxFragLen), 0, int);
+	PTF_ASSERT_EQUAL(ipFrag.fragmentPacket(reassembledPacket, fragments), 0, int);
+	PTF_ASSERT_EQUAL(fragments.size(), 3, size);
+
+	// fragment by payload size instead of MTU
+	ipFrag.setMaxFragmentPayloadSize(1000);
+	PTF_ASSERT_EQUAL(ipFrag.getNumOfFragments(reassembledPacket, maxFragLen), 5, int);
+	PTF_ASSERT_EQUAL(ipFrag.fragmentPacket(reassembledPacket, fragments), 5, int);
+	PTF_ASSERT_EQUAL(fragments.size(), 8, size);
+	pcpp::Packet lastFrag(fragments.at(7));
+	pcpp::IPv4Layer* lastFragIPLayer = lastFrag.getLayerOfType<pcpp::IPv4Layer>();
+	PTF_ASSERT_TRUE(lastFragIPLayer->isLastFragment());
+	PTF_ASSERT_EQUAL(lastFragIPLayer->getFragmentOffset(), 4000, u16);
+
+	// packets with the "Don't Fragment" flag aren't fragmented unless explicitly requested
+	ipFrag.setMaxFragmentPayloadSize(0);
+	ipFrag.setMtu(1500);
+	reassembledPacket->getLayerOfType<pcpp::IPv4Layer>()->getIPv4Header()->fragmentOffset |= htobe16(0x4000);
+	PTF_ASSERT_EQUAL(ipFrag.getNumOfFragments(reassembledPacket, maxFragLen), -1, int);
+	ipFrag.setIgnoreDontFragment(true);
+	pcpp::PointerVector<pcpp::RawPacket> dfFragments;
+	PTF_ASSERT_EQUAL(ipFrag.fragmentPacket(reassembledPacket, dfFragments), 3, int);
+	for (int i = 0; i < 3; i++)
+	{
+		PTF_ASSERT_BUF_COMPARE(dfFragments.at(i)->getRawData(), origFrags[i]->getRawData(), origFrags[i]->getRawDataLen());
+	}
+
+	// non-IP packets aren't fragmented
+	READ_FILE_AND_CREATE_PACKET(4, "PacketExamples/ArpRequestPacket.dat");
+	pcpp::Packet arpPacket(&rawPacket4);
+	PTF_ASSERT_EQUAL(ipFrag.fragmentPacket(&arpPacket, dfFragments), 0, int);
+
+	// packets with an invalid IPv4 header length aren't fragmented
+	reassembledPacket->getLayerOfType<pcpp::IPv4Layer>()->getIPv4Header()->internetHeaderLength = 4;
+	pcpp::LoggerPP::getInstance().supressErrors();
+	PTF_ASSERT_EQUAL(ipFrag.getNumOfFragments(reassembledPacket, maxFragLen), -1, int);
+	PTF_ASSERT_EQUAL(ipFrag.fragmentPacket(reassembledPacket, dfFragments), -1, int);
+	pcpp::LoggerPP::getInstance().enableErrors();
+	PTF_ASSERT_EQUAL(dfFragments.size(), 3, size);
+
+	delete reassembledPacket;
+} // IPv4PacketFragmentationTest
+
+
+
 PTF_TEST_CASE(IPv4OptionsParsingTest)
 {
 	timeval time;
@@ -1,6 +1,7 @@
 #include "../TestDefinition.h"
 #include "../Utils/TestUtils.h"
 #include "EndianPortable.h"
+#include "Logger.h"
 #include "IpAddress.h"
 #include "EthLayer.h"
 #include "IPv4Layer.h"
@@ -8,6 +9,8 @@
 #include "UdpLayer.h"
 #include "PayloadLayer.h"
 #include "Packet.h"
+#include "IPReassembly.h"
+#include "IPFragmentation.h"
 #include "SystemUtils.h"
 
 PTF_TEST_CASE(IPv6UdpPacketParseAndCreate)
@@ -148,6 +151,70 @@ PTF_TEST_CASE(IPv6FragmentationTest)
 
 
 
+PTF_TEST_CASE(IPv6PacketFragmentationTest)
+{
+	timeval time;
+	gettimeofday(&time, NULL);
+
+	READ_FILE_AND_CREATE_PACKET(1, "PacketExamples/IPv6Frag1.dat");
+	READ_FILE_AND_CREATE_PACKET(2, "PacketExamples/IPv6Frag2.dat");
+	READ_FILE_AND_CREATE_PACKET(3, "PacketExamples/IPv6Frag3.dat");
+	READ_FILE_AND_CREATE_PACKET(4, "PacketExamples/IPv6Frag4.dat");
+
+	pcpp::RawPacket* origFrags[4] = { &rawPacket1, &rawPacket2, &rawPacket3, &rawPacket4 };
+
+	// reassemble the original packet out of the fragments
+	pcpp::IPReassembly ipReassembly;
+	pcpp::IPReassembly::ReassemblyStatus status;
+	pcpp::Packet* reassembledPacket = NULL;
+	for (int i = 0; i < 4; i++)
+	{
+		pcpp::Packet fragPacket(origFrags[i]);
+		reassembledPacket = ipReassembly.processPacket(&fragPacket, status);
+	}
+	PTF_ASSERT_EQUAL(status, pcpp::IPReassembly::REASSEMBLED, enum);
+	PTF_ASSERT_NOT_NULL(reassembledPacket);
+	PTF_ASSERT_NULL(reassembledPacket->getLayerOfType<pcpp::IPv6Layer>()->getExtensionOfType<pcpp::IPv6FragmentationHeader>());
+
+	// fragment the reassembled packet with the same MTU and fragment ID and compare to the original fragments
+	pcpp::IPFragmentation ipFrag(1500);
+	ipFrag.setIPv6FragmentId(0xf88eb466);
+	pcpp::PointerVector<pcpp::RawPacket> fragments;
+	PTF_ASSERT_EQUAL(ipFrag.fragmentPacket(reassembledPacket, fragments), 4, int);
+	for (int i = 0; i < 4; i++)
+	{
+		PTF_ASSERT_EQUAL(fragments.at(i)->getRawDataLen(), origFrags[i]->getRawDataLen(), int);
+		PTF_ASSERT_BUF_COMPARE(fragments.at(i)->getRawData(), origFrags[i]->getRawData(), origFrags[i]->getRawDataLen());
+	}
+
+	// the fragment ID is incremented for every packet
+	PTF_ASSERT_EQUAL(ipFrag.fragmentPacket(reassembledPacket, fragments), 4, int);
+	pcpp::Packet secondFrag(fragments.at(5));
+	pcpp::IPv6FragmentationHeader* fragHeader = secondFrag.getLayerOfType<pcpp::IPv6Layer>()->getExtensionOfType<pcpp::IPv6FragmentationHeader>();
+	PTF_ASSERT_NOT_NULL(fragHeader);
+	PTF_ASSERT_EQUAL(be32toh(fragHeader->getFragHeader()->id), 0xf88eb467, u32);
+	PTF_ASSERT_EQUAL(fragHeader->getFragmentOffset(), 1448, u16);
+	PTF_ASSERT_EQUAL(fragHeader->getFragHeader()->nextHeader, pcpp::PACKETPP_IPPROTO_UDP, u8);
+
+	// an MTU that can't hold the IPv6 header, the fragmentation header and 8 bytes of payload
+	ipFrag.setMtu(50);
+	pcpp::LoggerPP::getInstance().supressErrors();
+	PTF_ASSERT_EQUAL(ipFrag.fragmentPacket(reassembledPacket, fragments), -1, int);
+	pcpp::LoggerPP::getInstance().enableErrors();
+	PTF_ASSERT_EQUAL(fragments.size(), 8, size);
+
+	// packets that are already fragments can't be fragmented again
+	ipFrag.setMtu(1000);
+	pcpp::Packet frag1(&rawPacket1);
+	pcpp::LoggerPP::getInstance().supressErrors();
+	PTF_ASSERT_EQUAL(ipFrag.fragmentPacket(&frag1, fragments), -1, int);
+	pcpp::LoggerPP::getInstance().enableErrors();
+
+	delete reassembledPacket;
+} // IPv6PacketFragmentationTest
+
+
+
 PTF_TEST_CASE(IPv6ExtensionsTest)
 {
 	timeval time;
@@ -0,0 +1,208 @@
+#include "../TestDefinition.h"
+#include "EndianPortable.h"
+#include "Logger.h"
+#include "Packet.h"
+#include "EthLayer.h"
+#include "VlanLayer.h"
+#include "IPv4Layer.h"
+#include "IPv6Layer.h"
+#include "TcpLayer.h"
+#include "UdpLayer.h"
+#include "PayloadLayer.h"
+#include "PacketBuilder.h"
+#include "SystemUtils.h"
+#include <string.h>
+
+PTF_TEST_CASE(PacketBuilderEthIPv4TcpTest)
+{
+	pcpp::MacAddress srcMac("aa:bb:cc:dd:ee:ff");
+	pcpp::MacAddress dstMac("11:22:33:44:55:66");
+	pcpp::IPv4Address srcIP("10.0.0.1");
+	pcpp::IPv4Address dstIP("192.168.1.100");
+	// an odd payload length so the last checksummed word is padded
+	uint8_t payload[] = { 0x47, 0x45, 0x54, 0x20, 0x2f, 0x20, 0x48, 0x54, 0x54, 0x50, 0x0d, 0x0a, 0x0d };
+
+	// build the same packet with layers
+	pcpp::EthLayer ethLayer(srcMac, dstMac);
+	pcpp::IPv4Layer ipLayer(srcIP, dstIP);
+	ipLayer.getIPv4Header()->timeToLive = 64;
+	ipLayer.getIPv4Header()->ipId = htobe16(1000);
+	pcpp::TcpLayer tcpLayer(12345, 30000);
+	tcpLayer.getTcpHeader()->pshFlag = 1;
+	tcpLayer.getTcpHeader()->ackFlag = 1;
+	tcpLayer.getTcpHeader()->sequenceNumber = htobe32(0x01020304);
+	tcpLayer.getTcpHeader()->windowSize = htobe16(512);
+	pcpp::PayloadLayer payloadLayer(payload, sizeof(payload), false);
+
+	pcpp::Packet layersPacket(100);
+	PTF_ASSERT_TRUE(layersPacket.addLayer(&ethLayer));
+	PTF_ASSERT_TRUE(layersPacket.addLayer(&ipLayer));
+	PTF_ASSERT_TRUE(layersPacket.addLayer(&tcpLayer));
+	PTF_ASSERT_TRUE(layersPacket.addLayer(&payloadLayer));
+	layersPacket.computeCalculateFields();
+
+	size_t packetLen = sizeof(pcpp::ether_header) + sizeof(pcpp::iphdr) + sizeof(pcpp::tcphdr) + sizeof(payload);
+	pcpp::PacketBuilder builder(packetLen);
+	PTF_ASSERT_NULL(builder.getData());
+	PTF_ASSERT_NOT_NULL(builder.addEthLayer(srcMac, dstMac));
+	pcpp::iphdr* ipHeader = builder.addIPv4Layer(srcIP, dstIP);
+	PTF_ASSERT_NOT_NULL(ipHeader);
+	ipHeader->ipId = htobe16(1000);
+	pcpp::tcphdr* tcpHeader = builder.addTcpLayer(12345, 30000);
+	PTF_ASSERT_NOT_NULL(tcpHeader);
+	tcpHeader->pshFlag = 1;
+	tcpHeader->ackFlag = 1;
+	tcpHeader->sequenceNumber = htobe32(0x01020304);
+	tcpHeader->windowSize = htobe16(512);
+	// add the payload in two parts, they're merged into one layer
+	PTF_ASSERT_NOT_NULL(builder.addPayload(payload, 5));
+	uint8_t* payloadSecondPart = builder.addPayload(NULL, sizeof(payload) - 5);
+	PTF_ASSERT_NOT_NULL(payloadSecondPart);
+	memcpy(payloadSecondPart, payload + 5, sizeof(payload) - 5);
+	PTF_ASSERT_EQUAL(builder.getNumOfLayers(), 4, size);
+	PTF_ASSERT_EQUAL(builder.getDataLen(), packetLen, size);
+
+	// the buffer is full
+	pcpp::LoggerPP::getInstance().supressErrors();
+	PTF_ASSERT_NULL(builder.addPayload(payload, 1));
+	pcpp::LoggerPP::getInstance().enableErrors();
+
+	timeval time;
+	gettimeofday(&time, NULL);
+	uint8_t* builderBuffer = builder.getData();
+	pcpp::RawPacket rawPacket;
+	PTF_ASSERT_TRUE(builder.build(rawPacket, time));
+
+	// the buffer was moved to the RawPacket without copying
+	PTF_ASSERT_TRUE(rawPacket.getRawData() == builderBuffer);
+	PTF_ASSERT_NULL(builder.getData());
+	PTF_ASSERT_EQUAL(builder.getDataLen(), 0, size);
+	PTF_ASSERT_EQUAL(rawPacket.getLinkLayerType(), pcpp::LINKTYPE_ETHERNET, enum);
+	PTF_ASSERT_EQUAL(rawPacket.getRawDataLen(), layersPacket.getRawPacket()->getRawDataLen(), int);
+	PTF_ASSERT_BUF_COMPARE(rawPacket.getRawData(), layersPacket.getRawPacket()->getRawData(), packetLen);
+
+	pcpp::Packet builtPacket(&rawPacket);
+	PTF_ASSERT_TRUE(builtPacket.isPacketOfType(pcpp::TCP));
+	pcpp::PayloadLayer* builtPayloadLayer = builtPacket.getLayerOfType<pcpp::PayloadLayer>();
+	PTF_ASSERT_NOT_NULL(builtPayloadLayer);
+	PTF_ASSERT_EQUAL(builtPayloadLayer->getPayloadLen(), sizeof(payload), size);
+
+	// the builder allocates a new buffer for the next packet
+	PTF_ASSERT_NOT_NULL(builder.addIPv4Layer(dstIP, srcIP));
+	PTF_ASSERT_NOT_NULL(builder.addUdpLayer(53, 53));
+	PTF_ASSERT_TRUE(builder.getData() != builderBuffer);
+	pcpp::RawPacket rawPacket2;
+	PTF_ASSERT_TRUE(builder.build(rawPacket2, time));
+	PTF_ASSERT_EQUAL(rawPacket2.getLinkLayerType(), pcpp::LINKTYPE_RAW, enum);
+	pcpp::Packet builtPacket2(&rawPacket2);
+	pcpp::UdpLayer* udpLayer = builtPacket2.getLayerOfType<pcpp::UdpLayer>();
+	PTF_ASSERT_NOT_NULL(udpLayer);
+	PTF_ASSERT_EQUAL(be16toh(udpLayer->getUdpHeader()->length), 8, u16);
+	uint16_t udpChecksum = udpLayer->getUdpHeader()->headerChecksum;
+	uint16_t ipChecksum = builtPacket2.getLayerOfType<pcpp::IPv4Layer>()->getIPv4Header()->headerChecksum;
+	builtPacket2.computeCalculateFields();
+	PTF_ASSERT_EQUAL(udpLayer->getUdpHeader()->headerChecksum, udpChecksum, u16);
+	PTF_ASSERT_EQUAL(builtPacket2.getLayerOfType<pcpp::IPv4Layer>()->getIPv4Header()->headerChecksum, ipChecksum, u16);
+} // PacketBuilderEthIPv4TcpTest
+
+
+
+PTF_TEST_CASE(PacketBuilderUserBufferTest)
+{
+	pcpp::MacAddress srcMac("aa:bb:cc:dd:ee:ff");
+	pcpp::MacAddress dstMac("11:22:33:44:55:66");
+	pcpp::IPv6Address srcIP("2001:db8::1");
+	pcpp::IPv6Address dstIP("2001:db8::abcd:2");
+	uint8_t payload[] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10 };
+
+	pcpp::EthLayer ethLayer(srcMac, dstMac);
+	pcpp::VlanLayer vlanLayer(100, false, 5, PCPP_ETHERTYPE_IPV6);
+	pcpp::IPv6Layer ipLayer(srcIP, dstIP);
+	ipLayer.getIPv6Header()->hopLimit = 64;
+	pcpp::UdpLayer udpLayer(2152, 2152);
+	pcpp::PayloadLayer payloadLayer(payload, sizeof(payload), false);
+
+	pcpp::Packet layersPacket(100);
+	PTF_ASSERT_TRUE(layersPacket.addLayer(&ethLayer));
+	PTF_ASSERT_TRUE(layersPacket.addLayer(&vlanLayer));
+	PTF_ASSERT_TRUE(layersPacket.addLayer(&ipLayer));
+	PTF_ASSERT_TRUE(layersPacket.addLayer(&udpLayer));
+	PTF_ASSERT_TRUE(layersPacket.addLayer(&payloadLayer));
+	layersPacket.computeCalculateFields();
+
+	uint8_t buffer[200];
+	memset(buffer, 0xff, sizeof(buffer));
+	pcpp::PacketBuilder builder(buffer, sizeof(buffer));
+	PTF_ASSERT_TRUE(builder.getData() == buffer);
+	PTF_ASSERT_NOT_NULL(builder.addEthLayer(srcMac, dstMac));
+	pcpp::vlan_header* vlanHeader = builder.addVlanLayer(100, false, 5);
+	PTF_ASSERT_NOT_NULL(vlanHeader);
+	PTF_ASSERT_EQUAL(be16toh(vlanHeader->vlan), 0xa064, u16);
+	PTF_ASSERT_NOT_NULL(builder.addIPv6Layer(srcIP, dstIP));
+	PTF_ASSERT_NOT_NULL(builder.addUdpLayer(2152, 2152));
+	PTF_ASSERT_NOT_NULL(builder.addPayload(payload, sizeof(payload)));
+	PTF_ASSERT_TRUE(builder.finalize());
+
+	int packetLen = layersPacket.getRawPacket()->getRawDataLen();
+	PTF_ASSERT_EQUAL(builder.getDataLen(), (size_t)packetLen, size);
+	PTF_ASSERT_BUF_COMPARE(buffer, layersPacket.getRawPacket()->getRawData(), packetLen);
+
+	// a user-provided buffer can't be moved to a RawPacket, but it can be wrapped by one
+	pcpp::LoggerPP::getInstance().supressErrors();
+	timeval time;
+	gettimeofday(&time, NULL);
+	pcpp::RawPacket rawPacket;
+	PTF_ASSERT_FALSE(builder.build(rawPacket, time));
+	pcpp::LoggerPP::getInstance().enableErrors();
+
+	pcpp::RawPacket wrappingRawPacket(buffer, (int)builder.getDataLen(), time, false, builder.getLinkLayerType());
+	pcpp::Packet builtPacket(&wrappingRawPacket);
+	PTF_ASSERT_TRUE(builtPacket.isPacketOfType(pcpp::VLAN));
+	PTF_ASSERT_TRUE(builtPacket.isPacketOfType(pcpp::IPv6));
+	PTF_ASSERT_TRUE(builtPacket.isPacketOfType(pcpp::UDP));
+
+	// an outer IPv4/UDP tunnel around the inner packet: the inner layers are finalized before the outer UDP checksum is computed
+	builder.clear();
+	PTF_ASSERT_EQUAL(builder.getNumOfLayers(), 0, size);
+	PTF_ASSERT_NOT_NULL(builder.addIPv4Layer(pcpp::IPv4Address("1.1.1.1"), pcpp::IPv4Address("2.2.2.2")));
+	PTF_ASSERT_NOT_NULL(builder.addUdpLayer(1000, 2000));
+	PTF_ASSERT_NOT_NULL(builder.addIPv4Layer(pcpp::IPv4Address("10.0.0.1"), pcpp::IPv4Address("10.0.0.2")));
+	PTF_ASSERT_NOT_NULL(builder.addTcpLayer(80, 8080));
+	PTF_ASSERT_TRUE(builder.finalize());
+	PTF_ASSERT_EQUAL(builder.getLinkLayerType(), pcpp::LINKTYPE_RAW, enum);
+	pcpp::RawPacket tunnelRawPacket(buffer, (int)builder.getDataLen(), time, false, builder.getLinkLayerType());
+	pcpp::Packet tunnelPacket(&tunnelRawPacket);
+	pcpp::UdpLayer* outerUdpLayer = tunnelPacket.getLayerOfType<pcpp::UdpLayer>();
+	PTF_ASSERT_NOT_NULL(outerUdpLayer);
+	PTF_ASSERT_EQUAL(be16toh(outerUdpLayer->getUdpHeader()->length), 8 + 20 + 20, u16);
+	pcpp::IPv4Layer outerIPLayer(*tunnelPacket.getLayerOfType<pcpp::IPv4Layer>());
+	pcpp::UdpLayer outerUdp(*outerUdpLayer);
+	pcpp::Packet recomputedPacket(100);
+	PTF_ASSERT_TRUE(recomputedPacket.addLayer(&outerIPLayer));
+	PTF_ASSERT_TRUE(recomputedPacket.addLayer(&outerUdp));
+	pcpp::PayloadLayer innerLayers(builder.getData() + 28, builder.getDataLen() - 28, false);
+	PTF_ASSERT_TRUE(recomputedPacket.addLayer(&innerLayers));
+	recomputedPacket.computeCalculateFields();
+	PTF_ASSERT_BUF_COMPARE(recomputedPacket.getRawPacket()->getRawData(), buffer, builder.getDataLen());
+
+	// the buffer is too small or there are too many layers
+	pcpp::LoggerPP::getInstance().supressErrors();
+	uint8_t smallBuffer[20];
+	pcpp::PacketBuilder smallBuilder(smallBuffer, sizeof(smallBuffer));
+	PTF_ASSERT_NOT_NULL(smallBuilder.addEthLayer(srcMac, dstMac));
+	PTF_ASSERT_NULL(smallBuilder.addIPv4Layer(pcpp::IPv4Address("1.1.1.1"), pcpp::IPv4Address("2.2.2.2")));
+	PTF_ASSERT_NOT_NULL(smallBuilder.addVlanLayer(1, false, 0));
+	PTF_ASSERT_EQUAL(smallBuilder.getDataLen(), 18, size);
+
+	pcpp::PacketBuilder emptyBuilder(NULL, 100);
+	PTF_ASSERT_NULL(emptyBuilder.addEthLayer(srcMac, dstMac));
+	PTF_ASSERT_FALSE(emptyBuilder.finalize());
+
+	builder.clear();
+	for (size_t i = 0; i < pcpp::PacketBuilder::MaxNumOfLayers; i++)
+	{
+		PTF_ASSERT_NOT_NULL(builder.addVlanLayer((uint16_t)i, false, 0));
+	}
+	PTF_ASSERT_NULL(builder.addVlanLayer(100, false, 0));
+	pcpp::LoggerPP::getInstance().enableErrors();
+} // PacketBuilderUserBufferTest
@@ -0,0 +1,223 @@
+#include "../TestDefinition.h"
+#include "EndianPortable.h"
+#include "Logger.h"
+#include "Packet.h"
+#include "EthLayer.h"
+#include "IPv4Layer.h"
+#include "IPv6Layer.h"
+#include "TcpLayer.h"
+#include "UdpLayer.h"
+#include "PayloadLayer.h"
+#include "PacketGenerator.h"
+#include "SystemUtils.h"
+#include <string.h>
+
+PTF_TEST_CASE(PacketGeneratorUdpTest)
+{
+	pcpp::EthLayer ethLayer(pcpp::MacAddress("aa:aa:aa:aa:aa:aa"), pcpp::MacAddress("bb:bb:bb:bb:bb:bb"), PCPP_ETHERTYPE_IP);
+	pcpp::IPv4Layer ipLayer(pcpp::IPv4Address("10.0.0.1"), pcpp::IPv4Address("20.0.0.1"));
+	ipLayer.getIPv4Header()->timeToLive = 64;
+	pcpp::UdpLayer udpLayer(1234, 5678);
+	uint8_t payload[] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a };
+	pcpp::PayloadLayer payloadLayer(payload, sizeof(payload), false);
+
+	pcpp::Packet templatePacket(100);
+	PTF_ASSERT_TRUE(templatePacket.addLayer(&ethLayer));
+	PTF_ASSERT_TRUE(templatePacket.addLayer(&ipLayer));
+	PTF_ASSERT_TRUE(templatePacket.addLayer(&udpLayer));
+	PTF_ASSERT_TRUE(templatePacket.addLayer(&payloadLayer));
+	templatePacket.computeCalculateFields();
+
+	pcpp::PacketGenerator generator;
+	PTF_ASSERT_TRUE(generator.setTemplate(&templatePacket));
+
+	// without any settings the generated packet is identical to the template
+	uint8_t buffer[1600];
+	PTF_ASSERT_EQUAL(generator.generatePacket(buffer, sizeof(buffer)), 52, int);
+	PTF_ASSERT_BUF_COMPARE(buffer, templatePacket.getRawPacket()->getRawData(), 52);
+
+	PTF_ASSERT_TRUE(generator.addFieldMutator(pcpp::PacketGenerator::IPv4SrcIPField, pcpp::PacketGenerator::IncrementMutator, 0x0a000001, 0x0a000003));
+	PTF_ASSERT_TRUE(generator.addFieldMutator(pcpp::PacketGenerator::IPv4IdField, pcpp::PacketGenerator::IncrementMutator, 100, 0xffff, 7));
+	PTF_ASSERT_TRUE(generator.addFieldMutator(pcpp::PacketGenerator::SrcPortField, pcpp::PacketGenerator::RandomMutator, 1024, 2048));
+	// the TTL is at an even offset of the IP header and this payload byte is at an odd offset of the UDP segment
+	PTF_ASSERT_TRUE(generator.addFieldMutator(14 + 8, 1, pcpp::PacketGenerator::RandomMutator, 1, 255));
+	PTF_ASSERT_TRUE(generator.addFieldMutator(14 + 20 + 8 + 3, 1, pcpp::PacketGenerator::RandomMutator, 0, 255));
+	uint8_t pattern[] = { 0xde, 0xad, 0xbe };
+	PTF_ASSERT_TRUE(generator.setPayloadPattern(pattern, sizeof(pattern)));
+	PTF_ASSERT_TRUE(generator.setPacketSizeRange(60, 1514));
+	PTF_ASSERT_EQUAL(generator.getMaxPacketLen(), 1514, size);
+
+	timeval time;
+	gettimeofday(&time, NULL);
+
+	for (int i = 0; i < 200; i++)
+	{
+		int packetLen = generator.generatePacket(buffer, sizeof(buffer));
+		PTF_ASSERT_TRUE(packetLen >= 60 && packetLen <= 1514);
+
+		pcpp::RawPacket rawPacket(buffer, packetLen, time, false);
+		pcpp::Packet packet(&rawPacket);
+		pcpp::IPv4Layer* genIPLayer = packet.getLayerOfType<pcpp::IPv4Layer>();
+		pcpp::UdpLayer* genUdpLayer = packet.getLayerOfType<pcpp::UdpLayer>();
+		PTF_ASSERT_NOT_NULL(genIPLayer);
+		PTF_ASSERT_NOT_NULL(genUdpLayer);
+
+		PTF_ASSERT_EQUAL(be32toh(genIPLayer->getIPv4Header()->ipSrc), 0x0a000001 + (uint32_t)(i % 3), u32);
+		PTF_ASSERT_EQUAL(be16toh(genIPLayer->getIPv4Header()->ipId), 100 + 7*i, u16);
+		uint16_t srcPort = be16toh(genUdpLayer->getUdpHeader()->portSrc);
+		PTF_ASSERT_TRUE(srcPort >= 1024 && srcPort <= 2048);
+		PTF_ASSERT_EQUAL(be16toh(genUdpLayer->getUdpHeader()->portDst), 5678, u16);
+		PTF_ASSERT_EQUAL(genUdpLayer->getLayerPayload()[0], 0xde, u8);
+		PTF_ASSERT_EQUAL(genUdpLayer->getLayerPayload()[4], 0xad, u8);
+
+		uint16_t totalLength = genIPLayer->getIPv4Header()->totalLength;
+		uint16_t ipChecksum = genIPLayer->getIPv4Header()->headerChecksum;
+		uint16_t udpLength = genUdpLayer->getUdpHeader()->length;
+		uint16_t udpChecksum = genUdpLayer->getUdpHeader()->headerChecksum;
+		packet.computeCalculateFields();
+		PTF_ASSERT_EQUAL(totalLength, genIPLayer->getIPv4Header()->totalLength, u16);
+		PTF_ASSERT_EQUAL(ipChecksum, genIPLayer->getIPv4Header()->headerChecksum, u16);
+		PTF_ASSERT_EQUAL(udpLength, genUdpLayer->getUdpHeader()->length, u16);
+		// a computed checksum of 0 is transmitted as 0xffff
+		if (udpChecksum != 0xffff || genUdpLayer->getUdpHeader()->headerChecksum != 0)
+		{
+			PTF_ASSERT_EQUAL(udpChecksum, genUdpLayer->getUdpHeader()->headerChecksum, u16);
+		}
+	}
+
+	PTF_ASSERT_EQUAL(generator.getNumOfGeneratedPackets(), 201, u64);
+	pcpp::LoggerPP::getInstance().supressErrors();
+	PTF_ASSERT_EQUAL(generator.generatePacket(buffer, 59), -1, int);
+	pcpp::LoggerPP::getInstance().enableErrors();
+} // PacketGeneratorUdpTest
+
+
+
+PTF_TEST_CASE(PacketGeneratorTcpBurstTest)
+{
+	pcpp::EthLayer ethLayer(pcpp::MacAddress("aa:aa:aa:aa:aa:aa"), pcpp::MacAddress("bb:bb:bb:bb:bb:bb"), PCPP_ETHERTYPE_IPV6);
+	pcpp::IPv6Layer ipLayer(pcpp::IPv6Address("2001:db8::1"), pcpp::IPv6Address("2001:db8::2"));
+	ipLayer.getIPv6Header()->hopLimit = 64;
+	pcpp::TcpLayer tcpLayer(4321, 80);
+	tcpLayer.getTcpHeader()->ackFlag = 1;
+
+	pcpp::Packet templatePacket(100);
+	PTF_ASSERT_TRUE(templatePacket.addLayer(&ethLayer));
+	PTF_ASSERT_TRUE(templatePacket.addLayer(&ipLayer));
+	PTF_ASSERT_TRUE(templatePacket.addLayer(&tcpLayer));
+	templatePacket.computeCalculateFields();
+
+	pcpp::PacketGenerator generator;
+	PTF_ASSERT_TRUE(generator.setTemplate(&templatePacket));
+	PTF_ASSERT_TRUE(generator.addFieldMutator(pcpp::PacketGenerator::IPv6DstIPField, pcpp::PacketGenerator::RandomMutator, 0, 0xffffffff));
+	PTF_ASSERT_TRUE(generator.addFieldMutator(pcpp::PacketGenerator::TcpSeqNumberField, pcpp::PacketGenerator::IncrementMutator, 0xfffffff0, 0xffffffff, 5));
+	PTF_ASSERT_TRUE(generator.addPacketSize(75, 7));
+	PTF_ASSERT_TRUE(generator.addPacketSize(577, 4));
+	PTF_ASSERT_TRUE(generator.addPacketSize(1501, 1));
+
+	uint32_t expectedSeq[] = { 0xfffffff0, 0xfffffff5, 0xfffffffa, 0xffffffff, 0xfffffff0 };
+	uint8_t firstBurstCopy[1501];
+	size_t firstBurstCopyLen = 0;
+
+	for (int burstNum = 0; burstNum < 3; burstNum++)
+	{
+		generator.setSeed(1000);
+		pcpp::PointerVector<pcpp::RawPacket>& burst = generator.generateBurst(burstNum == 1 ? 16 : 32);
+		PTF_ASSERT_EQUAL(burst.size(), (burstNum == 1 ? 16 : 32), size);
+
+		// the same seed generates the same traffic
+		if (burstNum == 0)
+		{
+			firstBurstCopyLen = burst.at(0)->getRawDataLen();
+			memcpy(firstBurstCopy, burst.at(0)->getRawData(), firstBurstCopyLen);
+		}
+		else
+		{
+			PTF_ASSERT_EQUAL((size_t)burst.at(0)->getRawDataLen(), firstBurstCopyLen, size);
+			PTF_ASSERT_BUF_COMPARE(burst.at(0)->getRawData(), firstBurstCopy, firstBurstCopyLen);
+		}
+
+		for (size_t i = 0; i < burst.size(); i++)
+		{
+			int packetLen = burst.at(i)->getRawDataLen();
+			PTF_ASSERT_TRUE(packetLen == 75 || packetLen == 577 || packetLen == 1501);
+
+			pcpp::Packet packet(burst.at(i));
+			pcpp::IPv6Layer* genIPLayer = packet.getLayerOfType<pcpp::IPv6Layer>();
+			pcpp::TcpLayer* genTcpLayer = packet.getLayerOfType<pcpp::TcpLayer>();
+			PTF_ASSERT_NOT_NULL(genIPLayer);
+			PTF_ASSERT_NOT_NULL(genTcpLayer);
+			if (i < 5)
+			{
+				PTF_ASSERT_EQUAL(be32toh(genTcpLayer->getTcpHeader()->sequenceNumber), expectedSeq[i], u32);
+			}
+
+			uint16_t payloadLength = genIPLayer->getIPv6Header()->payloadLength;
+			uint16_t tcpChecksum = genTcpLayer->getTcpHeader()->headerChecksum;
+			packet.computeCalculateFields();
+			PTF_ASSERT_EQUAL(payloadLength, genIPLayer->getIPv6Header()->payloadLength, u16);
+			PTF_ASSERT_EQUAL(tcpChecksum, genTcpLayer->getTcpHeader()->headerChecksum, u16);
+		}
+	}
+} // PacketGeneratorTcpBurstTest
+
+
+
+PTF_TEST_CASE(PacketGeneratorInvalidSettingsTest)
+{
+	pcpp::EthLayer ethLayer(pcpp::MacAddress("aa:aa:aa:aa:aa:aa"), pcpp::MacAddress("bb:bb:bb:bb:bb:bb"), PCPP_ETHERTYPE_IP);
+	pcpp::IPv4Layer ipLayer(pcpp::IPv4Address("10.0.0.1"), pcpp::IPv4Address("20.0.0.1"));
+	pcpp::UdpLayer udpLayer(1234, 5678);
+
+	pcpp::Packet templatePacket(100);
+	PTF_ASSERT_TRUE(templatePacket.addLayer(&ethLayer));
+	PTF_ASSERT_TRUE(templatePacket.addLayer(&ipLayer));
+	PTF_ASSERT_TRUE(templatePacket.addLayer(&udpLayer));
+	templatePacket.computeCalculateFields();
+
+	pcpp::PacketGenerator generator;
+	uint8_t buffer[100];
+
+	pcpp::LoggerPP::getInstance().supressErrors();
+
+	// no template
+	PTF_ASSERT_FALSE(generator.compile());
+	PTF_ASSERT_EQUAL(generator.generatePacket(buffer, sizeof(buffer)), -1, int);
+	PTF_ASSERT_EQUAL(generator.generateBurst(4).size(), 0, size);
+
+	PTF_ASSERT_TRUE(generator.setTemplate(&templatePacket));
+
+	// fields that don't exist in the template or illegal values
+	PTF_ASSERT_FALSE(generator.addFieldMutator(pcpp::PacketGenerator::TcpSeqNumberField, pcpp::PacketGenerator::IncrementMutator, 0, 10));
+	PTF_ASSERT_FALSE(generator.addFieldMutator(pcpp::PacketGenerator::IPv6SrcIPField, pcpp::PacketGenerator::IncrementMutator, 0, 10));
+	PTF_ASSERT_FALSE(generator.addFieldMutator(pcpp::PacketGenerator::SrcPortField, pcpp::PacketGenerator::IncrementMutator, 0, 0x10000));
+	PTF_ASSERT_FALSE(generator.addFieldMutator(pcpp::PacketGenerator::SrcPortField, pcpp::PacketGenerator::IncrementMutator, 10, 0));
+	PTF_ASSERT_FALSE(generator.addFieldMutator(pcpp::PacketGenerator::SrcPortField, pcpp::PacketGenerator::IncrementMutator, 0, 10, 0));
+	PTF_ASSERT_FALSE(generator.addFieldMutator(0, 3, pcpp::PacketGenerator::RandomMutator, 0, 10));
+	PTF_ASSERT_FALSE(generator.setPacketSizeRange(100, 50));
+	PTF_ASSERT_FALSE(generator.addPacketSize(0));
+	PTF_ASSERT_FALSE(generator.setPayloadPattern(NULL, 5));
+
+	// packet size smaller than the template headers
+	PTF_ASSERT_TRUE(generator.setPacketSizeRange(30, 100));
+	PTF_ASSERT_FALSE(generator.compile());
+	generator.clearPacketSizes();
+	PTF_ASSERT_TRUE(generator.compile());
+
+	// mutating the IPv4 checksum or the UDP length isn't allowed
+	PTF_ASSERT_TRUE(generator.addFieldMutator(14 + 10, 2, pcpp::PacketGenerator::RandomMutator, 0, 10));
+	PTF_ASSERT_FALSE(generator.compile());
+	generator.clearFieldMutators();
+	PTF_ASSERT_TRUE(generator.addFieldMutator(14 + 20 + 4, 1, pcpp::PacketGenerator::RandomMutator, 0, 10));
+	PTF_ASSERT_FALSE(generator.compile());
+	generator.clearFieldMutators();
+
+	// a field beyond the minimum packet size
+	PTF_ASSERT_TRUE(generator.addFieldMutator(60, 4, pcpp::PacketGenerator::RandomMutator, 0, 10));
+	PTF_ASSERT_FALSE(generator.compile());
+	PTF_ASSERT_TRUE(generator.setPacketSizeRange(64, 64));
+	PTF_ASSERT_TRUE(generator.compile());
+	PTF_ASSERT_EQUAL(generator.generatePacket(buffer, sizeof(buffer)), 64, int);
+
+	pcpp::LoggerPP::getInstance().enableErrors();
+} // PacketGeneratorInvalidSettingsTest
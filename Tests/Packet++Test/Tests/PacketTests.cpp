@@ -20,6 +20,16 @@
 #include "PayloadLayer.h"
 #include "SystemUtils.h"
 
+
+#ifdef PCPP_HAS_RTTI
+// a user-defined layer class that inherits LayerProtocol and isInstance() from a concrete layer class
+class DerivedPayloadLayer : public pcpp::PayloadLayer
+{
+public:
+	DerivedPayloadLayer(const uint8_t* data, size_t dataLen) : pcpp::PayloadLayer(data, dataLen, false) {}
+};
+#endif
+
 PTF_TEST_CASE(InsertDataToPacket)
 {
 	// Creating a packet
@@ -553,6 +563,76 @@ PTF_TEST_CASE(PacketLayerLookupTest)
 		// try to get nonexistent layer
 		PTF_ASSERT_NULL(vxlanPacket.getLayerOfType<pcpp::RadiusLayer>(true));
 	}
+
+	{
+		READ_FILE_AND_CREATE_PACKET(3, "PacketExamples/Vxlan1.dat");
+		pcpp::Packet vxlanPacket(&rawPacket3);
+
+		pcpp::IPv4Layer* outerIPLayer = vxlanPacket.getLayerOfType<pcpp::IPv4Layer>();
+		pcpp::IPv4Layer* innerIPLayer = vxlanPacket.getNextLayerOfType<pcpp::IPv4Layer>(outerIPLayer);
+		PTF_ASSERT_NOT_NULL(outerIPLayer);
+		PTF_ASSERT_NOT_NULL(innerIPLayer);
+		PTF_ASSERT_TRUE(vxlanPacket.getLayerOfType(pcpp::IPv4) == outerIPLayer);
+		PTF_ASSERT_TRUE(vxlanPacket.getLayerOfType(pcpp::IPv4, 1) == innerIPLayer);
+		PTF_ASSERT_NULL(vxlanPacket.getLayerOfType(pcpp::IPv4, 2));
+		PTF_ASSERT_NULL(vxlanPacket.getLayerOfType(pcpp::IPv6));
+		PTF_ASSERT_TRUE(vxlanPacket.getLayerOfType<pcpp::Layer>() == vxlanPacket.getFirstLayer());
+		PTF_ASSERT_TRUE(vxlanPacket.getLayerOfType<pcpp::Layer>(true) == vxlanPacket.getLastLayer());
+
+		// the layer index of a copied packet points to the copy's layers
+		pcpp::Packet copiedPacket(vxlanPacket);
+		pcpp::IPv4Layer* copiedIPLayer = copiedPacket.getLayerOfType<pcpp::IPv4Layer>();
+		PTF_ASSERT_NOT_NULL(copiedIPLayer);
+		PTF_ASSERT_TRUE(copiedIPLayer != outerIPLayer);
+		PTF_ASSERT_EQUAL(copiedIPLayer->getSrcIpAddress(), pcpp::IPv4Address("192.168.203.1"), object);
+
+		// the index follows layers removal and insertion
+		PTF_ASSERT_TRUE(vxlanPacket.removeLayer(pcpp::IPv4));
+		PTF_ASSERT_TRUE(vxlanPacket.getLayerOfType<pcpp::IPv4Layer>() == innerIPLayer);
+		PTF_ASSERT_TRUE(vxlanPacket.getLayerOfType(pcpp::IPv4) == innerIPLayer);
+
+		pcpp::IPv4Layer* newIPLayer = new pcpp::IPv4Layer(pcpp::IPv4Address("1.1.1.1"), pcpp::IPv4Address("2.2.2.2"));
+		PTF_ASSERT_TRUE(vxlanPacket.insertLayer(vxlanPacket.getFirstLayer(), newIPLayer, true));
+		PTF_ASSERT_TRUE(vxlanPacket.getLayerOfType<pcpp::IPv4Layer>() == newIPLayer);
+		PTF_ASSERT_TRUE(vxlanPacket.getLayerOfType<pcpp::IPv4Layer>(true) == innerIPLayer);
+		PTF_ASSERT_TRUE(vxlanPacket.getLayerOfType(pcpp::IPv4, 1) == innerIPLayer);
+
+		PTF_ASSERT_TRUE(vxlanPacket.removeLayer(pcpp::UDP));
+		PTF_ASSERT_FALSE(vxlanPacket.isPacketOfType(pcpp::UDP));
+		PTF_ASSERT_NULL(vxlanPacket.getLayerOfType<pcpp::UdpLayer>());
+		PTF_ASSERT_NULL(vxlanPacket.getLayerOfType(pcpp::UDP));
+	}
+
+	{
+		READ_FILE_AND_CREATE_PACKET(4, "PacketExamples/IGMPv1_1.dat");
+		pcpp::Packet igmpPacket(&rawPacket4);
+
+		// IgmpLayer matches all IGMP versions
+		pcpp::IgmpLayer* igmpLayer = igmpPacket.getLayerOfType<pcpp::IgmpLayer>();
+		PTF_ASSERT_NOT_NULL(igmpLayer);
+		PTF_ASSERT_TRUE(igmpPacket.getLayerOfType<pcpp::IgmpV1Layer>() == igmpLayer);
+		PTF_ASSERT_NULL(igmpPacket.getLayerOfType<pcpp::IgmpV2Layer>());
+		PTF_ASSERT_NULL(igmpPacket.getLayerOfType<pcpp::IgmpV3QueryLayer>());
+		PTF_ASSERT_NULL(igmpPacket.getLayerOfType<pcpp::IgmpV3ReportLayer>(true));
+	}
+
+#ifdef PCPP_HAS_RTTI
+	{
+		// a class deriving from a concrete layer class doesn't match instances of its base class
+		uint8_t payload[4] = { 0x01, 0x02, 0x03, 0x04 };
+		pcpp::Packet packet(64);
+		pcpp::PayloadLayer* payloadLayer = new pcpp::PayloadLayer(payload, 4, false);
+		DerivedPayloadLayer* derivedLayer = new DerivedPayloadLayer(payload, 4);
+		PTF_ASSERT_TRUE(packet.addLayer(payloadLayer, true));
+		PTF_ASSERT_NULL(packet.getLayerOfType<DerivedPayloadLayer>());
+		PTF_ASSERT_NULL(packet.getLayerOfType<DerivedPayloadLayer>(true));
+		PTF_ASSERT_TRUE(packet.addLayer(derivedLayer, true));
+		PTF_ASSERT_TRUE(packet.getLayerOfType<DerivedPayloadLayer>() == derivedLayer);
+		PTF_ASSERT_TRUE(packet.getLayerOfType<DerivedPayloadLayer>(true) == derivedLayer);
+		PTF_ASSERT_TRUE(packet.getLayerOfType<pcpp::PayloadLayer>() == payloadLayer);
+		PTF_ASSERT_TRUE(packet.getLayerOfType<pcpp::PayloadLayer>(true) == derivedLayer);
+	}
+#endif
 } // PacketLayerLookupTest
 
 
@@ -915,4 +995,216 @@ PTF_TEST_CASE(ResizeLayerTest)
 	PTF_ASSERT_EQUAL(rawData2[5], 0xAD, u8);
 	PTF_ASSERT_EQUAL(rawData2[6], 0xBE, u8);
 	PTF_ASSERT_EQUAL(rawData2[7], 0xEF, u8);
-} // ResizeLayerTest
\ No newline at end of file
+} // ResizeLayerTest
+
+
+PTF_TEST_CASE(PacketCloneTest)
+{
+	timeval time;
+	gettimeofday(&time, NULL);
+
+	READ_FILE_AND_CREATE_PACKET(1, "PacketExamples/packet_trailer_ipv4.dat");
+	READ_FILE_AND_CREATE_PACKET(2, "PacketExamples/TwoHttpRequests1.dat");
+
+	// a copy has the same layers over its own buffer
+	pcpp::Packet trailerPacket(&rawPacket1);
+	pcpp::Packet trailerPacketCopy(trailerPacket);
+	PTF_ASSERT_FALSE(trailerPacketCopy.isRawDataShared());
+	PTF_ASSERT_TRUE(trailerPacketCopy.getRawPacket() != trailerPacket.getRawPacket());
+	PTF_ASSERT_TRUE(trailerPacketCopy.getRawPacket()->getRawData() != trailerPacket.getRawPacket()->getRawData());
+	PTF_ASSERT_EQUAL(trailerPacketCopy.getRawPacket()->getRawDataLen(), trailerPacket.getRawPacket()->getRawDataLen(), int);
+	pcpp::Layer* curLayer = trailerPacket.getFirstLayer();
+	pcpp::Layer* curCopyLayer = trailerPacketCopy.getFirstLayer();
+	while (curLayer != NULL)
+	{
+		PTF_ASSERT_NOT_NULL(curCopyLayer);
+		PTF_ASSERT_EQUAL(curCopyLayer->getProtocol(), curLayer->getProtocol(), enum);
+		PTF_ASSERT_EQUAL(curCopyLayer->getDataLen(), curLayer->getDataLen(), size);
+		PTF_ASSERT_EQUAL(curCopyLayer->getData() - trailerPacketCopy.getRawPacket()->getRawData(), curLayer->getData() - trailerPacket.getRawPacket()->getRawData(), int);
+		PTF_ASSERT_BUF_COMPARE(curCopyLayer->getData(), curLayer->getData(), curLayer->getDataLen());
+		curLayer = curLayer->getNextLayer();
+		curCopyLayer = curCopyLayer->getNextLayer();
+	}
+	PTF_ASSERT_NULL(curCopyLayer);
+	PTF_ASSERT_TRUE(trailerPacketCopy.isPacketOfType(pcpp::PacketTrailer));
+	PTF_ASSERT_NOT_NULL(trailerPacketCopy.getLayerOfType<pcpp::TcpLayer>());
+	PTF_ASSERT_TRUE(trailerPacketCopy.getLastLayer() == trailerPacketCopy.getLayerOfType<pcpp::PacketTrailerLayer>());
+
+	// a copy of a partially parsed packet isn't parsed further
+	pcpp::Packet partialPacket(&rawPacket2, pcpp::TCP);
+	pcpp::Packet partialPacketCopy = partialPacket;
+	PTF_ASSERT_EQUAL(partialPacketCopy.getLastLayer()->getProtocol(), pcpp::TCP, enum);
+	PTF_ASSERT_FALSE(partialPacketCopy.isPacketOfType(pcpp::HTTPRequest));
+
+	// a copy-on-write copy shares the data until it's modified
+	pcpp::Packet cowPacket(trailerPacket, true);
+	PTF_ASSERT_TRUE(cowPacket.isRawDataShared());
+	PTF_ASSERT_TRUE(cowPacket.getRawPacket() != trailerPacket.getRawPacket());
+	PTF_ASSERT_TRUE(cowPacket.getRawPacket()->getRawData() == trailerPacket.getRawPacket()->getRawData());
+	PTF_ASSERT_TRUE(cowPacket.getFirstLayer()->getData() == trailerPacket.getFirstLayer()->getData());
+	PTF_ASSERT_TRUE(cowPacket.isPacketOfType(pcpp::PacketTrailer));
+
+	pcpp::IPv4Layer* cowIPLayer = cowPacket.getLayerOfType<pcpp::IPv4Layer>();
+	PTF_ASSERT_NOT_NULL(cowIPLayer);
+	PTF_ASSERT_TRUE(cowPacket.makeWritable());
+	PTF_ASSERT_FALSE(cowPacket.isRawDataShared());
+	PTF_ASSERT_TRUE(cowPacket.getRawPacket()->getRawData() != trailerPacket.getRawPacket()->getRawData());
+	PTF_ASSERT_TRUE(cowPacket.getLayerOfType<pcpp::IPv4Layer>() == cowIPLayer);
+	PTF_ASSERT_EQUAL(cowIPLayer->getData() - cowPacket.getRawPacket()->getRawData(), trailerPacket.getLayerOfType<pcpp::IPv4Layer>()->getData() - trailerPacket.getRawPacket()->getRawData(), int);
+	uint8_t origTtl = trailerPacket.getLayerOfType<pcpp::IPv4Layer>()->getIPv4Header()->timeToLive;
+	cowIPLayer->getIPv4Header()->timeToLive = origTtl + 1;
+	PTF_ASSERT_EQUAL(trailerPacket.getLayerOfType<pcpp::IPv4Layer>()->getIPv4Header()->timeToLive, origTtl, u8);
+
+	// changing the layers of a copy-on-write copy copies the data first
+	pcpp::Packet cowPacket2(trailerPacket, true);
+	PTF_ASSERT_TRUE(cowPacket2.removeLayer(pcpp::PacketTrailer));
+	PTF_ASSERT_FALSE(cowPacket2.isRawDataShared());
+	PTF_ASSERT_FALSE(cowPacket2.isPacketOfType(pcpp::PacketTrailer));
+	PTF_ASSERT_TRUE(trailerPacket.isPacketOfType(pcpp::PacketTrailer));
+	PTF_ASSERT_EQUAL(cowPacket2.getRawPacket()->getRawDataLen(), trailerPacket.getRawPacket()->getRawDataLen() - (int)trailerPacket.getLayerOfType<pcpp::PacketTrailerLayer>()->getDataLen(), int);
+
+	pcpp::Packet cowPacket3(trailerPacket, true);
+	cowPacket3.computeCalculateFields();
+	PTF_ASSERT_FALSE(cowPacket3.isRawDataShared());
+	PTF_ASSERT_TRUE(cowPacket3.getRawPacket()->getRawData() != trailerPacket.getRawPacket()->getRawData());
+
+	// the SSL handshake messages and extensions of a copy-on-write copy point to the copied data once it's writable
+	READ_FILE_AND_CREATE_PACKET(3, "PacketExamples/SSL-ClientHello1.dat");
+	pcpp::Packet clientHelloPacket(&rawPacket3);
+	pcpp::Packet cowClientHelloPacket(clientHelloPacket, true);
+	pcpp::SSLHandshakeLayer* cowHandshakeLayer = cowClientHelloPacket.getLayerOfType<pcpp::SSLHandshakeLayer>();
+	PTF_ASSERT_NOT_NULL(cowHandshakeLayer);
+	PTF_ASSERT_TRUE(cowClientHelloPacket.makeWritable());
+	PTF_ASSERT_TRUE(cowClientHelloPacket.getLayerOfType<pcpp::SSLHandshakeLayer>() == cowHandshakeLayer);
+	pcpp::SSLClientHelloMessage* cowClientHello = cowHandshakeLayer->getHandshakeMessageOfType<pcpp::SSLClientHelloMessage>();
+	PTF_ASSERT_NOT_NULL(cowClientHello);
+	PTF_ASSERT_EQUAL(cowClientHello->getExtensionCount(), 9, int);
+	pcpp::SSLServerNameIndicationExtension* cowServerNameExt = cowClientHello->getExtensionOfType<pcpp::SSLServerNameIndicationExtension>();
+	PTF_ASSERT_NOT_NULL(cowServerNameExt);
+	const uint8_t* cowData = cowClientHelloPacket.getRawPacket()->getRawData();
+	PTF_ASSERT_TRUE(cowServerNameExt->getData() > cowData && cowServerNameExt->getData() < cowData + cowClientHelloPacket.getRawPacket()->getRawDataLen());
+	PTF_ASSERT_EQUAL(cowServerNameExt->getHostName(), "www.google.com", string);
+
+	// the host name starts after the list length, the name type and the name length
+	cowServerNameExt->getData()[5] = 'x';
+	PTF_ASSERT_EQUAL(cowServerNameExt->getHostName(), "xww.google.com", string);
+	pcpp::SSLClientHelloMessage* origClientHello = clientHelloPacket.getLayerOfType<pcpp::SSLHandshakeLayer>()->getHandshakeMessageOfType<pcpp::SSLClientHelloMessage>();
+	PTF_ASSERT_EQUAL(origClientHello->getExtensionOfType<pcpp::SSLServerNameIndicationExtension>()->getHostName(), "www.google.com", string);
+} // PacketCloneTest
+
+
+
+PTF_TEST_CASE(RawPacketRefCountTest)
+{
+	timeval time;
+	gettimeofday(&time, NULL);
+
+	READ_FILE_AND_CREATE_PACKET(1, "PacketExamples/TwoHttpRequests1.dat");
+	const int dataLen = rawPacket1.getRawDataLen();
+	uint8_t* origData = new uint8_t[dataLen];
+	memcpy(origData, rawPacket1.getRawData(), dataLen);
+
+	pcpp::RawPacketBufferPool pool(2000, 1);
+
+	// copying with sharing copies the data if it isn't reference-counted
+	PTF_ASSERT_FALSE(rawPacket1.isRawDataRefCounted());
+	PTF_ASSERT_EQUAL(rawPacket1.getRawDataRefCount(), 0, u32);
+	pcpp::RawPacket notShared(rawPacket1, true);
+	PTF_ASSERT_FALSE(notShared.isRawDataRefCounted());
+	PTF_ASSERT_TRUE(notShared.getRawData() != rawPacket1.getRawData());
+
+	PTF_ASSERT_TRUE(rawPacket1.makeRawDataRefCounted(&pool));
+	PTF_ASSERT_TRUE(rawPacket1.isRawDataRefCounted());
+	PTF_ASSERT_EQUAL(rawPacket1.getRawDataRefCount(), 1, u32);
+	PTF_ASSERT_EQUAL(rawPacket1.getRawDataLen(), dataLen, int);
+	PTF_ASSERT_BUF_COMPARE(rawPacket1.getRawData(), origData, dataLen);
+
+	// fan out to several consumers without copying
+	pcpp::RawPacket* consumer1 = new pcpp::RawPacket(rawPacket1, true);
+	pcpp::RawPacket* consumer2 = new pcpp::RawPacket(rawPacket1, true);
+	PTF_ASSERT_TRUE(consumer1->getRawData() == rawPacket1.getRawData());
+	PTF_ASSERT_TRUE(consumer2->getRawData() == rawPacket1.getRawData());
+	PTF_ASSERT_EQUAL(consumer1->getRawDataLen(), dataLen, int);
+	PTF_ASSERT_EQUAL(consumer1->getPacketTimeStamp().tv_sec, rawPacket1.getPacketTimeStamp().tv_sec, int);
+	PTF_ASSERT_EQUAL(rawPacket1.getRawDataRefCount(), 3, u32);
+
+	// a regular copy isn't shared
+	pcpp::RawPacket copy(*consumer1);
+	PTF_ASSERT_FALSE(copy.isRawDataRefCounted());
+	PTF_ASSERT_TRUE(copy.getRawData() != rawPacket1.getRawData());
+	PTF_ASSERT_EQUAL(rawPacket1.getRawDataRefCount(), 3, u32);
+
+	// the consumers can be freed in any order
+	rawPacket1.clear();
+	PTF_ASSERT_FALSE(rawPacket1.isRawDataRefCounted());
+	PTF_ASSERT_EQUAL(consumer1->getRawDataRefCount(), 2, u32);
+	delete consumer1;
+	PTF_ASSERT_EQUAL(consumer2->getRawDataRefCount(), 1, u32);
+	PTF_ASSERT_BUF_COMPARE(consumer2->getRawData(), origData, dataLen);
+	PTF_ASSERT_EQUAL(pool.getNumOfFreeBuffers(), 0, size);
+	delete consumer2;
+	PTF_ASSERT_EQUAL(pool.getNumOfFreeBuffers(), 1, size);
+
+	// a released buffer is reused, changing shared data copies it first
+	pcpp::RawPacket rawPacket2(origData, dataLen, time, false);
+	PTF_ASSERT_TRUE(rawPacket2.makeRawDataRefCounted(&pool));
+	PTF_ASSERT_EQUAL(pool.getNumOfFreeBuffers(), 0, size);
+	pcpp::RawPacket rawPacket2Shared(rawPacket2, true);
+	PTF_ASSERT_TRUE(rawPacket2Shared.removeData(0, 14));
+	PTF_ASSERT_TRUE(rawPacket2Shared.isRawDataRefCounted());
+	PTF_ASSERT_TRUE(rawPacket2Shared.getRawData() != rawPacket2.getRawData());
+	PTF_ASSERT_EQUAL(rawPacket2.getRawDataRefCount(), 1, u32);
+	PTF_ASSERT_EQUAL(rawPacket2Shared.getRawDataRefCount(), 1, u32);
+	PTF_ASSERT_EQUAL(rawPacket2.getRawDataLen(), dataLen, int);
+	PTF_ASSERT_BUF_COMPARE(rawPacket2.getRawData(), origData, dataLen);
+	PTF_ASSERT_BUF_COMPARE(rawPacket2Shared.getRawData(), origData + 14, dataLen - 14);
+
+	// the pool keeps only one free buffer
+	rawPacket2.clear();
+	rawPacket2Shared.clear();
+	PTF_ASSERT_EQUAL(pool.getNumOfFreeBuffers(), 1, size);
+
+	// data longer than the pool buffers is allocated on the heap
+	pcpp::RawPacketBufferPool smallPool(32, 4);
+	pcpp::RawPacket rawPacket3(origData, dataLen, time, false);
+	PTF_ASSERT_TRUE(rawPacket3.makeRawDataRefCounted(&smallPool));
+	rawPacket3.clear();
+	PTF_ASSERT_EQUAL(smallPool.getNumOfFreeBuffers(), 0, size);
+
+	// a copy-on-write packet over reference-counted data doesn't depend on the original packet
+	pcpp::RawPacket* rawPacket4 = new pcpp::RawPacket(origData, dataLen, time, false);
+	PTF_ASSERT_TRUE(rawPacket4->makeRawDataRefCounted());
+	pcpp::Packet* packet4 = new pcpp::Packet(rawPacket4, true);
+	pcpp::Packet cowPacket(*packet4, true);
+	PTF_ASSERT_TRUE(cowPacket.isRawDataShared());
+	PTF_ASSERT_EQUAL(rawPacket4->getRawDataRefCount(), 2, u32);
+	delete packet4;
+	PTF_ASSERT_EQUAL(cowPacket.getRawPacket()->getRawDataRefCount(), 1, u32);
+	PTF_ASSERT_TRUE(cowPacket.isPacketOfType(pcpp::HTTPRequest));
+	PTF_ASSERT_BUF_COMPARE(cowPacket.getRawPacket()->getRawData(), origData, dataLen);
+	PTF_ASSERT_TRUE(cowPacket.makeWritable());
+	PTF_ASSERT_FALSE(cowPacket.getRawPacket()->isRawDataRefCounted());
+	PTF_ASSERT_NOT_NULL(cowPacket.getLayerOfType<pcpp::HttpRequestLayer>());
+
+	// an instance that held reference-counted data frees (or doesn't free) the raw data set afterwards like it did before
+	uint8_t* ownedData = new uint8_t[dataLen];
+	memcpy(ownedData, origData, dataLen);
+	pcpp::RawPacket reusedRawPacket(ownedData, dataLen, time, true);
+	for (int i = 0; i < 3; i++)
+	{
+		PTF_ASSERT_TRUE(reusedRawPacket.makeRawDataRefCounted(&pool));
+		PTF_ASSERT_TRUE(reusedRawPacket.isRawDataRefCounted());
+		ownedData = new uint8_t[dataLen];
+		memcpy(ownedData, origData, dataLen);
+		PTF_ASSERT_TRUE(reusedRawPacket.setRawData(ownedData, dataLen, time));
+		PTF_ASSERT_FALSE(reusedRawPacket.isRawDataRefCounted());
+		PTF_ASSERT_BUF_COMPARE(reusedRawPacket.getRawData(), origData, dataLen);
+	}
+
+	pcpp::RawPacket borrowingRawPacket(origData, dataLen, time, false);
+	PTF_ASSERT_TRUE(borrowingRawPacket.makeRawDataRefCounted(&pool));
+	PTF_ASSERT_TRUE(borrowingRawPacket.setRawData(origData, dataLen, time));
+	PTF_ASSERT_TRUE(borrowingRawPacket.getRawData() == origData);
+
+	delete [] origData;
+} // RawPacketRefCountTest
@@ -133,4 +133,21 @@ PTF_TEST_CASE(PacketUtilsHash5TupleIPv6)
 	PTF_ASSERT_EQUAL(pcpp::hash5Tuple(&dstSrcPacket, false), 4288746927, u32);
 	PTF_ASSERT_EQUAL(pcpp::hash5Tuple(&dstSrcPacket, true), 4288746927, u32);
 
+	// IP addresses are compared as byte arrays, so the 2-tuple hash and the 5-tuple hash with equal ports are symmetric too
+	PTF_ASSERT_EQUAL(pcpp::hash2Tuple(&srcDstPacket), pcpp::hash2Tuple(&dstSrcPacket), u32);
+
+	pcpp::IPv6Layer ipLayer3(srcIP, dstIP);
+	pcpp::UdpLayer udpLayer3(5353, 5353);
+	pcpp::Packet samePortsPacket(1);
+	samePortsPacket.addLayer(&ipLayer3);
+	samePortsPacket.addLayer(&udpLayer3);
+
+	pcpp::IPv6Layer ipLayer4(dstIP, srcIP);
+	pcpp::UdpLayer udpLayer4(5353, 5353);
+	pcpp::Packet samePortsReversePacket(1);
+	samePortsReversePacket.addLayer(&ipLayer4);
+	samePortsReversePacket.addLayer(&udpLayer4);
+
+	PTF_ASSERT_EQUAL(pcpp::hash5Tuple(&samePortsPacket), pcpp::hash5Tuple(&samePortsReversePacket), u32);
+
 } // PacketUtilsHash5TupleIPv6
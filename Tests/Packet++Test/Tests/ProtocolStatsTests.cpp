@@ -0,0 +1,215 @@
+#include "../TestDefinition.h"
+#include "../Utils/TestUtils.h"
+#include "Logger.h"
+#include "Packet.h"
+#include "ProtocolStats.h"
+#include "SystemUtils.h"
+#include <vector>
+
+
+static void setPacketTime(pcpp::RawPacket& rawPacket, long sec, long msec)
+{
+	timeval time;
+	time.tv_sec = sec;
+	time.tv_usec = msec * 1000;
+	rawPacket.setPacketTimeStamp(time);
+}
+
+
+PTF_TEST_CASE(ProtocolStatsHierarchyTest)
+{
+	timeval time;
+	gettimeofday(&time, NULL);
+
+	READ_FILE_AND_CREATE_PACKET(1, "PacketExamples/TwoHttpRequests1.dat");
+	READ_FILE_AND_CREATE_PACKET(2, "PacketExamples/TcpPacketNoOptions.dat");
+	READ_FILE_AND_CREATE_PACKET(3, "PacketExamples/Dns3.dat");
+	READ_FILE_AND_CREATE_PACKET(4, "PacketExamples/ArpRequestWithVlan.dat");
+
+	pcpp::Packet httpPacket(&rawPacket1);
+	pcpp::Packet tcpPacket(&rawPacket2);
+	pcpp::Packet dnsPacket(&rawPacket3);
+	pcpp::Packet arpPacket(&rawPacket4);
+	PTF_ASSERT_TRUE(httpPacket.isPacketOfType(pcpp::HTTPRequest));
+	PTF_ASSERT_TRUE(dnsPacket.isPacketOfType(pcpp::DNS));
+	PTF_ASSERT_TRUE(arpPacket.isPacketOfType(pcpp::VLAN));
+
+	pcpp::ProtocolStats stats;
+	for (int i = 0; i < 3; i++)
+	{
+		stats.addPacket(httpPacket);
+	}
+	stats.addPacket(tcpPacket);
+	stats.addPacket(dnsPacket);
+	stats.addPacket(arpPacket);
+
+	uint64_t totalBytes = 3 * bufferLength1 + bufferLength2 + bufferLength3 + bufferLength4;
+	PTF_ASSERT_EQUAL(stats.getTotal().packets, 6, u64);
+	PTF_ASSERT_EQUAL(stats.getTotal().bytes, totalBytes, u64);
+	PTF_ASSERT_EQUAL(stats.getProtocolCounters(pcpp::Ethernet).packets, 6, u64);
+	PTF_ASSERT_EQUAL(stats.getProtocolCounters(pcpp::TCP).packets, 4, u64);
+	PTF_ASSERT_EQUAL(stats.getProtocolCounters(pcpp::HTTPRequest).packets, 3, u64);
+	PTF_ASSERT_EQUAL(stats.getProtocolCounters(pcpp::HTTPRequest).bytes, (uint64_t)(3 * bufferLength1), u64);
+	PTF_ASSERT_EQUAL(stats.getProtocolCounters(pcpp::DNS).packets, 1, u64);
+	PTF_ASSERT_EQUAL(stats.getProtocolCounters(pcpp::ARP).packets, 1, u64);
+	PTF_ASSERT_EQUAL(stats.getProtocolCounters(pcpp::SSL).packets, 0, u64);
+	PTF_ASSERT_EQUAL(pcpp::ProtocolStats::getProtocolName(pcpp::HTTPRequest), "http.request", string);
+	PTF_ASSERT_EQUAL(pcpp::ProtocolStats::getProtocolName(pcpp::UnknownProtocol), "unknown", string);
+
+	// the first level of the hierarchy is Ethernet only, and its children are in the order they were first seen
+	std::vector<pcpp::ProtocolStats::HierarchyNode> hierarchy;
+	stats.getHierarchy(hierarchy);
+	PTF_ASSERT_GREATER_THAN(hierarchy.size(), 6, size);
+	PTF_ASSERT_EQUAL(hierarchy[0].protocol, pcpp::Ethernet, u64);
+	PTF_ASSERT_EQUAL(hierarchy[0].depth, 0, u32);
+	PTF_ASSERT_EQUAL(hierarchy[0].counters.packets, 6, u64);
+	PTF_ASSERT_EQUAL(hierarchy[1].depth, 1, u32);
+	PTF_ASSERT_EQUAL(hierarchy[1].counters.packets, 5, u64);
+	PTF_ASSERT_EQUAL(hierarchy[2].protocol, pcpp::TCP, u64);
+	PTF_ASSERT_EQUAL(hierarchy[2].counters.packets, 4, u64);
+	PTF_ASSERT_EQUAL(hierarchy[3].protocol, pcpp::HTTPRequest, u64);
+	PTF_ASSERT_EQUAL(hierarchy[3].depth, 3, u32);
+	PTF_ASSERT_EQUAL(hierarchy[3].counters.packets, 3, u64);
+	PTF_ASSERT_EQUAL(hierarchy.back().protocol, pcpp::ARP, u64);
+	PTF_ASSERT_EQUAL(hierarchy.back().counters.bytes, (uint64_t)bufferLength4, u64);
+	uint64_t firstLevelPackets = 0;
+	for (size_t i = 0; i < hierarchy.size(); i++)
+	{
+		if (hierarchy[i].depth == 0)
+		{
+			firstLevelPackets += hierarchy[i].counters.packets;
+		}
+	}
+	PTF_ASSERT_EQUAL(firstLevelPackets, 6, u64);
+
+	std::string hierarchyStr = stats.hierarchyToString();
+	PTF_ASSERT_EQUAL(hierarchyStr.substr(0, 3), "eth", string);
+	PTF_ASSERT_TRUE(hierarchyStr.find("      http.request") != std::string::npos);
+	PTF_ASSERT_TRUE(hierarchyStr.find("frames:3 ") != std::string::npos);
+
+	// when the nodes run out, paths are counted at their deepest node
+	pcpp::ProtocolStats::Config smallConfig;
+	smallConfig.maxHierarchyNodes = 3;
+	pcpp::ProtocolStats smallStats(smallConfig);
+	smallStats.addPacket(httpPacket);
+	smallStats.addPacket(dnsPacket);
+	hierarchy.clear();
+	smallStats.getHierarchy(hierarchy);
+	PTF_ASSERT_EQUAL(hierarchy.size(), 3, size);
+	PTF_ASSERT_EQUAL(hierarchy[1].counters.packets, 2, u64);
+	PTF_ASSERT_EQUAL(smallStats.getNumOfTruncatedPaths(), 2, u64);
+	PTF_ASSERT_EQUAL(smallStats.getProtocolCounters(pcpp::DNS).packets, 1, u64);
+
+	// merging a larger hierarchy into a small one keeps the protocol counters right
+	PTF_ASSERT_TRUE(smallStats.merge(stats));
+	PTF_ASSERT_EQUAL(smallStats.getTotal().packets, 8, u64);
+	PTF_ASSERT_EQUAL(smallStats.getProtocolCounters(pcpp::TCP).packets, 5, u64);
+	PTF_ASSERT_EQUAL(smallStats.getProtocolCounters(pcpp::HTTPRequest).packets, 4, u64);
+	PTF_ASSERT_EQUAL(smallStats.getProtocolCounters(pcpp::DNS).packets, 2, u64);
+	PTF_ASSERT_EQUAL(smallStats.getProtocolCounters(pcpp::ARP).packets, 1, u64);
+	PTF_ASSERT_EQUAL(smallStats.getProtocolCounters(pcpp::Ethernet).packets, 8, u64);
+
+	stats.clear();
+	PTF_ASSERT_EQUAL(stats.getTotal().packets, 0, u64);
+	PTF_ASSERT_EQUAL(stats.getProtocolCounters(pcpp::TCP).packets, 0, u64);
+	PTF_ASSERT_EQUAL(stats.getNumOfBuckets(), 0, size);
+	hierarchy.clear();
+	stats.getHierarchy(hierarchy);
+	PTF_ASSERT_EQUAL(hierarchy.size(), 0, size);
+} // ProtocolStatsHierarchyTest
+
+
+
+PTF_TEST_CASE(ProtocolStatsTimeBucketsAndMergeTest)
+{
+	timeval time;
+	gettimeofday(&time, NULL);
+
+	READ_FILE_AND_CREATE_PACKET(1, "PacketExamples/TwoHttpRequests1.dat");
+	READ_FILE_AND_CREATE_PACKET(2, "PacketExamples/Dns3.dat");
+
+	pcpp::ProtocolStats::Config config;
+	config.bucketDuration = 500;
+	config.numOfBuckets = 4;
+
+	// two instances, like two capture threads, each sees part of the traffic
+	pcpp::ProtocolStats stats1(config);
+	pcpp::ProtocolStats stats2(config);
+
+	setPacketTime(rawPacket1, 1000, 100);
+	pcpp::Packet httpPacket(&rawPacket1);
+	stats1.addPacket(httpPacket);
+	setPacketTime(rawPacket1, 1000, 400);
+	stats1.addPacket(httpPacket);
+	setPacketTime(rawPacket1, 1001, 200);
+	stats1.addPacket(httpPacket);
+
+	pcpp::Packet dnsPacket(&rawPacket2);
+	setPacketTime(rawPacket2, 1000, 700);
+	stats2.addPacket(dnsPacket);
+	setPacketTime(rawPacket2, 1001, 300);
+	stats2.addPacket(dnsPacket);
+
+	PTF_ASSERT_EQUAL(stats1.getNumOfBuckets(), 3, size);
+	const pcpp::ProtocolStats::TimeBucket* bucket = stats1.getBucket(0);
+	PTF_ASSERT_NOT_NULL(bucket);
+	PTF_ASSERT_EQUAL((long)bucket->startTime.tv_sec, 1000, int);
+	PTF_ASSERT_EQUAL((long)bucket->startTime.tv_nsec, 0, int);
+	PTF_ASSERT_EQUAL(bucket->total.packets, 2, u64);
+	PTF_ASSERT_EQUAL(bucket->perProtocol[pcpp::ProtocolStats::getProtocolIndex(pcpp::HTTPRequest)].packets, 2, u64);
+	PTF_ASSERT_EQUAL(stats1.getBucket(1)->total.packets, 0, u64);
+	PTF_ASSERT_EQUAL(stats1.getBucket(2)->total.packets, 1, u64);
+	PTF_ASSERT_NULL(stats1.getBucket(3));
+
+	PTF_ASSERT_TRUE(stats1.merge(stats2));
+	PTF_ASSERT_EQUAL(stats1.getTotal().packets, 5, u64);
+	PTF_ASSERT_EQUAL(stats1.getTotal().bytes, (uint64_t)(3 * bufferLength1 + 2 * bufferLength2), u64);
+	PTF_ASSERT_EQUAL(stats1.getProtocolCounters(pcpp::DNS).packets, 2, u64);
+	PTF_ASSERT_EQUAL(stats1.getNumOfBuckets(), 3, size);
+	PTF_ASSERT_EQUAL(stats1.getBucket(1)->total.packets, 1, u64);
+	PTF_ASSERT_EQUAL((long)stats1.getBucket(1)->startTime.tv_nsec, 500000000, int);
+	PTF_ASSERT_EQUAL(stats1.getBucket(2)->total.packets, 2, u64);
+	PTF_ASSERT_EQUAL(stats1.getBucket(2)->perProtocol[pcpp::ProtocolStats::getProtocolIndex(pcpp::DNS)].packets, 1, u64);
+
+	std::vector<pcpp::ProtocolStats::HierarchyNode> hierarchy;
+	stats1.getHierarchy(hierarchy);
+	PTF_ASSERT_EQUAL(hierarchy[0].protocol, pcpp::Ethernet, u64);
+	PTF_ASSERT_EQUAL(hierarchy[0].counters.packets, 5, u64);
+	uint64_t dnsNodePackets = 0;
+	for (size_t i = 0; i < hierarchy.size(); i++)
+	{
+		if (hierarchy[i].protocol == pcpp::DNS)
+		{
+			dnsNodePackets += hierarchy[i].counters.packets;
+		}
+	}
+	PTF_ASSERT_EQUAL(dnsNodePackets, 2, u64);
+
+	// moving more than the whole ring forward drops the old buckets, and older packets are counted as late
+	setPacketTime(rawPacket1, 1003, 0);
+	stats1.addPacket(httpPacket);
+	PTF_ASSERT_EQUAL(stats1.getNumOfBuckets(), 4, size);
+	PTF_ASSERT_EQUAL((long)stats1.getBucket(0)->startTime.tv_sec, 1001, int);
+	PTF_ASSERT_EQUAL((long)stats1.getBucket(0)->startTime.tv_nsec, 500000000, int);
+	PTF_ASSERT_EQUAL(stats1.getBucket(0)->total.packets, 0, u64);
+	PTF_ASSERT_EQUAL(stats1.getBucket(3)->total.packets, 1, u64);
+	setPacketTime(rawPacket1, 1000, 0);
+	stats1.addPacket(httpPacket);
+	PTF_ASSERT_EQUAL(stats1.getNumOfLatePackets(), 1, u64);
+	PTF_ASSERT_EQUAL(stats1.getTotal().packets, 7, u64);
+
+	// a copy is independent of the original
+	pcpp::ProtocolStats statsCopy(stats1);
+	statsCopy.addPacket(httpPacket);
+	PTF_ASSERT_EQUAL(statsCopy.getTotal().packets, 8, u64);
+	PTF_ASSERT_EQUAL(stats1.getTotal().packets, 7, u64);
+	PTF_ASSERT_EQUAL(statsCopy.getNumOfBuckets(), 4, size);
+
+	// merging stats with a different bucket duration fails
+	pcpp::ProtocolStats::Config otherConfig;
+	pcpp::ProtocolStats otherStats(otherConfig);
+	pcpp::LoggerPP::getInstance().supressErrors();
+	PTF_ASSERT_FALSE(stats1.merge(otherStats));
+	pcpp::LoggerPP::getInstance().enableErrors();
+	PTF_ASSERT_EQUAL(stats1.getTotal().packets, 7, u64);
+} // ProtocolStatsTimeBucketsAndMergeTest
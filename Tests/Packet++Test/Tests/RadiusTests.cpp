@@ -46,6 +46,13 @@ PTF_TEST_CASE(RadiusLayerParsingTest)
 	PTF_ASSERT_EQUAL(radiusAttr.getTotalSize(), 6, size);
 	PTF_ASSERT_EQUAL(htobe32(radiusAttr.getValueAs<int>()), 2, u32);
 
+	uint8_t batchAttrTypes[3] = { 80, 2, 4 };
+	std::vector<pcpp::RadiusAttribute> batchAttrs;
+	PTF_ASSERT_EQUAL(radiusLayer->getAttributes(batchAttrTypes, 3, batchAttrs), 2, size);
+	PTF_ASSERT_EQUAL(batchAttrs[0].getDataSize(), 16, size);
+	PTF_ASSERT_TRUE(batchAttrs[1].isNull());
+	PTF_ASSERT_TRUE(batchAttrs[2] == radiusLayer->getFirstAttribute());
+
 	READ_FILE_AND_CREATE_PACKET_LINKTYPE(2, "PacketExamples/radius_3.dat", pcpp::LINKTYPE_NULL);
 	pcpp::Packet radiusPacket2(&rawPacket2);
 
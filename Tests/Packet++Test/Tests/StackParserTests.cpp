@@ -0,0 +1,187 @@
+#include "../TestDefinition.h"
+#include "../Utils/TestUtils.h"
+#include "EndianPortable.h"
+#include "Packet.h"
+#include "StackParser.h"
+#include "SystemUtils.h"
+
+
+// check that the layers found by the stack parser are exactly the first layers of the generic parsing
+template<typename StackParserType>
+static bool stackParserMatchesPacket(const StackParserType& parser, const pcpp::Packet& packet)
+{
+	pcpp::Layer* layer = packet.getFirstLayer();
+	for (size_t i = 0; i < (size_t)StackParserType::NumOfLayers; i++)
+	{
+		if (layer == NULL || layer->getData() != parser.getLayerData(i) || layer->getDataLen() != parser.getLayerDataLen(i) || layer->getHeaderLen() != parser.getHeaderLen(i))
+			return false;
+
+		layer = layer->getNextLayer();
+	}
+
+	return true;
+}
+
+
+
+PTF_TEST_CASE(StackParserTest)
+{
+	timeval time;
+	gettimeofday(&time, NULL);
+
+	READ_FILE_AND_CREATE_PACKET(1, "PacketExamples/TcpPacketWithOptions.dat");
+	READ_FILE_AND_CREATE_PACKET(2, "PacketExamples/IPv6UdpPacket.dat");
+	READ_FILE_AND_CREATE_PACKET(3, "PacketExamples/packet_trailer_ipv4.dat");
+	READ_FILE_AND_CREATE_PACKET(4, "PacketExamples/IPv4-TSO.dat");
+	READ_FILE_AND_CREATE_PACKET(5, "PacketExamples/IPv4Frag1.dat");
+	READ_FILE_AND_CREATE_PACKET(6, "PacketExamples/ipv6_options_hop_by_hop.dat");
+	READ_FILE_AND_CREATE_PACKET(7, "PacketExamples/EthDot3.dat");
+
+	pcpp::Packet tcpPacket(&rawPacket1);
+	pcpp::Packet ipv6UdpPacket(&rawPacket2);
+	pcpp::Packet trailerPacket(&rawPacket3);
+	pcpp::Packet tsoPacket(&rawPacket4);
+	pcpp::Packet fragPacket(&rawPacket5);
+	pcpp::Packet ipv6OptionsPacket(&rawPacket6);
+
+	// Eth/IPv4/TCP
+	pcpp::StackParser<pcpp::EthLayer, pcpp::IPv4Layer, pcpp::TcpLayer> ipv4TcpParser;
+	PTF_ASSERT_EQUAL(ipv4TcpParser.NumOfLayers, 3, int);
+	PTF_ASSERT_FALSE(ipv4TcpParser.isParsed());
+	PTF_ASSERT_TRUE(ipv4TcpParser.parse(&rawPacket1));
+	PTF_ASSERT_TRUE(ipv4TcpParser.isParsed());
+	PTF_ASSERT_TRUE(stackParserMatchesPacket(ipv4TcpParser, tcpPacket));
+	pcpp::TcpLayer* tcpLayer = tcpPacket.getLayerOfType<pcpp::TcpLayer>();
+	PTF_ASSERT_TRUE(ipv4TcpParser.getHeader<2>() == tcpLayer->getTcpHeader());
+	PTF_ASSERT_EQUAL(ipv4TcpParser.getHeader<2>()->portDst, htobe16(80), u16);
+	PTF_ASSERT_EQUAL(ipv4TcpParser.getHeader<1>()->protocol, pcpp::PACKETPP_IPPROTO_TCP, u8);
+	PTF_ASSERT_TRUE(ipv4TcpParser.getPayload() == tcpLayer->getLayerPayload());
+	PTF_ASSERT_EQUAL(ipv4TcpParser.getPayloadLen(), tcpLayer->getLayerPayloadSize(), size);
+
+	// the same packet doesn't match other stacks
+	PTF_ASSERT_FALSE((pcpp::StackParser<pcpp::EthLayer, pcpp::IPv6Layer, pcpp::TcpLayer>().parse(&rawPacket1)));
+	PTF_ASSERT_FALSE((pcpp::StackParser<pcpp::EthLayer, pcpp::IPv4Layer, pcpp::UdpLayer>().parse(&rawPacket1)));
+	PTF_ASSERT_FALSE((pcpp::StackParser<pcpp::EthLayer, pcpp::VlanLayer, pcpp::IPv4Layer, pcpp::TcpLayer>().parse(&rawPacket1)));
+	PTF_ASSERT_FALSE(ipv4TcpParser.parse(rawPacket1.getRawData(), rawPacket1.getRawDataLen(), pcpp::LINKTYPE_LINUX_SLL));
+	PTF_ASSERT_FALSE(ipv4TcpParser.isParsed());
+
+	// a shorter stack matches the first layers
+	pcpp::StackParser<pcpp::EthLayer, pcpp::IPv4Layer> ipv4Parser;
+	PTF_ASSERT_TRUE(ipv4Parser.parse(&rawPacket1));
+	PTF_ASSERT_TRUE(stackParserMatchesPacket(ipv4Parser, tcpPacket));
+	PTF_ASSERT_TRUE(ipv4Parser.getPayload() == (uint8_t*)tcpLayer->getTcpHeader());
+
+	// Eth/IPv6/UDP
+	pcpp::StackParser<pcpp::EthLayer, pcpp::IPv6Layer, pcpp::UdpLayer> ipv6UdpParser;
+	PTF_ASSERT_TRUE(ipv6UdpParser.parse(&rawPacket2));
+	PTF_ASSERT_TRUE(stackParserMatchesPacket(ipv6UdpParser, ipv6UdpPacket));
+	PTF_ASSERT_TRUE(ipv6UdpParser.getHeader<2>() == ipv6UdpPacket.getLayerOfType<pcpp::UdpLayer>()->getUdpHeader());
+
+	// IPv6 extension headers are left to the generic parsing
+	PTF_ASSERT_EQUAL(ipv6OptionsPacket.getLayerOfType<pcpp::IPv6Layer>()->getExtensionCount(), 1, size);
+	PTF_ASSERT_FALSE(ipv6UdpParser.parse(&rawPacket6));
+	PTF_ASSERT_FALSE((pcpp::StackParser<pcpp::EthLayer, pcpp::IPv6Layer, pcpp::TcpLayer>().parse(&rawPacket6)));
+
+	// the IPv4 data length is trimmed to the total length like in IPv4Layer
+	pcpp::StackParser<pcpp::EthLayer, pcpp::IPv4Layer, pcpp::UdpLayer> ipv4UdpParser;
+	PTF_ASSERT_TRUE(ipv4UdpParser.parse(&rawPacket3) || ipv4TcpParser.parse(&rawPacket3));
+	if (ipv4UdpParser.isParsed())
+	{
+		PTF_ASSERT_TRUE(stackParserMatchesPacket(ipv4UdpParser, trailerPacket));
+	}
+	else
+	{
+		PTF_ASSERT_TRUE(stackParserMatchesPacket(ipv4TcpParser, trailerPacket));
+	}
+	PTF_ASSERT_TRUE(ipv4Parser.parse(&rawPacket3));
+	PTF_ASSERT_TRUE(ipv4Parser.getLayerDataLen(1) < ipv4Parser.getLayerDataLen(0) - ipv4Parser.getHeaderLen(0));
+
+	// a total length of 0 (TSO) isn't trimmed
+	PTF_ASSERT_TRUE(ipv4Parser.parse(&rawPacket4));
+	PTF_ASSERT_TRUE(stackParserMatchesPacket(ipv4Parser, tsoPacket));
+	PTF_ASSERT_EQUAL(ipv4Parser.getLayerDataLen(1), 60, size);
+
+	// IPv4 fragments aren't parsed beyond the IPv4 layer
+	PTF_ASSERT_FALSE(ipv4UdpParser.parse(&rawPacket5));
+	PTF_ASSERT_FALSE(ipv4TcpParser.parse(&rawPacket5));
+	PTF_ASSERT_TRUE(ipv4Parser.parse(&rawPacket5));
+	PTF_ASSERT_TRUE(stackParserMatchesPacket(ipv4Parser, fragPacket));
+
+	// IEEE 802.3 Ethernet isn't EthLayer
+	PTF_ASSERT_FALSE((pcpp::StackParser<pcpp::EthLayer, pcpp::IPv4Layer>().parse(&rawPacket7)));
+
+	// raw IP link types
+	pcpp::StackParser<pcpp::IPv4Layer, pcpp::TcpLayer> rawIPv4TcpParser;
+	const uint8_t* ipData = tcpPacket.getLayerOfType<pcpp::IPv4Layer>()->getData();
+	size_t ipDataLen = rawPacket1.getRawDataLen() - (ipData - rawPacket1.getRawData());
+	PTF_ASSERT_TRUE(rawIPv4TcpParser.parse(ipData, ipDataLen, pcpp::LINKTYPE_RAW));
+	PTF_ASSERT_TRUE(rawIPv4TcpParser.getHeader<1>() == tcpLayer->getTcpHeader());
+	PTF_ASSERT_TRUE(rawIPv4TcpParser.parse(ipData, ipDataLen, pcpp::LINKTYPE_IPV4));
+	PTF_ASSERT_FALSE(rawIPv4TcpParser.parse(ipData, ipDataLen, pcpp::LINKTYPE_IPV6));
+	PTF_ASSERT_FALSE(rawIPv4TcpParser.parse(ipData, ipDataLen, pcpp::LINKTYPE_ETHERNET));
+	PTF_ASSERT_FALSE(rawIPv4TcpParser.parse(NULL, 0, pcpp::LINKTYPE_RAW));
+
+	// truncated packets
+	PTF_ASSERT_FALSE(ipv4TcpParser.parse(rawPacket1.getRawData(), 14 + 20 + 10, pcpp::LINKTYPE_ETHERNET));
+	PTF_ASSERT_FALSE(ipv4TcpParser.parse(rawPacket1.getRawData(), 10, pcpp::LINKTYPE_ETHERNET));
+} // StackParserTest
+
+
+
+PTF_TEST_CASE(StackParserVlanAndGtpTest)
+{
+	timeval time;
+	gettimeofday(&time, NULL);
+
+	// Eth/VLAN/VLAN/IPv4/TCP
+	pcpp::Packet vlanPacket(100);
+	PTF_ASSERT_TRUE(vlanPacket.addLayer(new pcpp::EthLayer(pcpp::MacAddress("aa:bb:cc:dd:ee:ff"), pcpp::MacAddress("11:22:33:44:55:66")), true));
+	PTF_ASSERT_TRUE(vlanPacket.addLayer(new pcpp::VlanLayer(100, false, 1, PCPP_ETHERTYPE_VLAN), true));
+	PTF_ASSERT_TRUE(vlanPacket.addLayer(new pcpp::VlanLayer(200, false, 1, PCPP_ETHERTYPE_IP), true));
+	PTF_ASSERT_TRUE(vlanPacket.addLayer(new pcpp::IPv4Layer(pcpp::IPv4Address("10.0.0.1"), pcpp::IPv4Address("10.0.0.2")), true));
+	PTF_ASSERT_TRUE(vlanPacket.addLayer(new pcpp::TcpLayer(12345, 80), true));
+	vlanPacket.computeCalculateFields();
+
+	pcpp::RawPacket* vlanRawPacket = vlanPacket.getRawPacket();
+	pcpp::Packet vlanPacketReparsed(vlanRawPacket, false);
+	pcpp::StackParser<pcpp::EthLayer, pcpp::VlanLayer, pcpp::VlanLayer, pcpp::IPv4Layer, pcpp::TcpLayer> vlanParser;
+	PTF_ASSERT_TRUE(vlanParser.parse(vlanRawPacket));
+	PTF_ASSERT_TRUE(stackParserMatchesPacket(vlanParser, vlanPacketReparsed));
+	uint16_t vlanId = be16toh(vlanParser.getHeader<2>()->vlan) & 0xfff;
+	PTF_ASSERT_EQUAL(vlanId, 200, u16);
+	PTF_ASSERT_EQUAL(vlanParser.getHeader<4>()->portSrc, htobe16(12345), u16);
+	PTF_ASSERT_EQUAL(vlanParser.getPayloadLen(), 0, size);
+	PTF_ASSERT_FALSE((pcpp::StackParser<pcpp::EthLayer, pcpp::VlanLayer, pcpp::IPv4Layer, pcpp::TcpLayer>().parse(vlanRawPacket)));
+
+	// Eth/IPv4/UDP/GTP/IPv4, with and without GTP extension headers
+	READ_FILE_AND_CREATE_PACKET(1, "PacketExamples/gtp-u1.dat");
+	READ_FILE_AND_CREATE_PACKET(2, "PacketExamples/gtp-u-1ext.dat");
+	READ_FILE_AND_CREATE_PACKET(3, "PacketExamples/gtp-u-2ext.dat");
+	READ_FILE_AND_CREATE_PACKET(4, "PacketExamples/gtp-u-ipv6.dat");
+	READ_FILE_AND_CREATE_PACKET(5, "PacketExamples/gtp-c1.dat");
+
+	pcpp::StackParser<pcpp::EthLayer, pcpp::IPv4Layer, pcpp::UdpLayer, pcpp::GtpV1Layer, pcpp::IPv4Layer> gtpParser;
+	pcpp::RawPacket* gtpRawPackets[3] = { &rawPacket1, &rawPacket2, &rawPacket3 };
+	size_t gtpHeaderLens[3] = { 12, 16, 20 };
+	for (int i = 0; i < 3; i++)
+	{
+		pcpp::Packet gtpPacket(gtpRawPackets[i]);
+		PTF_ASSERT_TRUE(gtpParser.parse(gtpRawPackets[i]));
+		PTF_ASSERT_TRUE(stackParserMatchesPacket(gtpParser, gtpPacket));
+		PTF_ASSERT_EQUAL(gtpParser.getHeaderLen(3), gtpHeaderLens[i], size);
+		PTF_ASSERT_EQUAL(gtpParser.getHeader<3>()->teid, gtpPacket.getLayerOfType<pcpp::GtpV1Layer>()->getHeader()->teid, u32);
+	}
+
+	pcpp::Packet gtpIPv6Packet(&rawPacket4);
+	PTF_ASSERT_FALSE(gtpParser.parse(&rawPacket4));
+	pcpp::StackParser<pcpp::EthLayer, pcpp::IPv4Layer, pcpp::UdpLayer, pcpp::GtpV1Layer, pcpp::IPv6Layer> gtpIPv6Parser;
+	PTF_ASSERT_TRUE(gtpIPv6Parser.parse(&rawPacket4));
+	PTF_ASSERT_TRUE(stackParserMatchesPacket(gtpIPv6Parser, gtpIPv6Packet));
+
+	// GTP-C messages are the last layer
+	pcpp::Packet gtpcPacket(&rawPacket5);
+	pcpp::StackParser<pcpp::EthLayer, pcpp::IPv4Layer, pcpp::UdpLayer, pcpp::GtpV1Layer> gtpcParser;
+	PTF_ASSERT_TRUE(gtpcParser.parse(&rawPacket5));
+	PTF_ASSERT_TRUE(stackParserMatchesPacket(gtpcParser, gtpcPacket));
+	PTF_ASSERT_FALSE(gtpParser.parse(&rawPacket5));
+} // StackParserVlanAndGtpTest
@@ -85,6 +85,13 @@ PTF_TEST_CASE(TcpPacketWithOptionsParsing)
 	uint32_t tsEchoReply = timestampOptionData.getValueAs<uint32_t>(4);
 	PTF_ASSERT_EQUAL(tsValue, htobe32(195102), u32);
 	PTF_ASSERT_EQUAL(tsEchoReply, htobe32(3555729271UL), u32);
+
+	pcpp::TcpOptionType optTypes[] = { pcpp::TCPOPT_MSS, pcpp::PCPP_TCPOPT_TIMESTAMP, pcpp::PCPP_TCPOPT_NOP };
+	std::vector<pcpp::TcpOption> tcpOptions;
+	PTF_ASSERT_EQUAL(tcpLayer->getTcpOptions(optTypes, 3, tcpOptions), 2, size);
+	PTF_ASSERT_TRUE(tcpOptions[0].isNull());
+	PTF_ASSERT_TRUE(tcpOptions[1] == timestampOptionData);
+	PTF_ASSERT_TRUE(tcpOptions[2] == tcpLayer->getTcpOption(pcpp::PCPP_TCPOPT_NOP));
 } // TcpPacketWithOptionsParsing
 
 
@@ -0,0 +1,206 @@
+#include "../TestDefinition.h"
+#include "../Utils/TestUtils.h"
+#include "Packet.h"
+#include "TcpLayer.h"
+#include "StringCounterTable.h"
+#include "TrafficStatsCollectors.h"
+#include "SystemUtils.h"
+#include <stdio.h>
+#include <vector>
+
+
+PTF_TEST_CASE(StringCounterTableTest)
+{
+	pcpp::StringCounterTable table;
+	const char* data = "www.example.com:8080";
+	PTF_ASSERT_EQUAL(table.increment(data, 15), 1, u64);
+	PTF_ASSERT_EQUAL(table.increment(pcpp::PrehashedString(std::string("www.example.com"))), 2, u64);
+	PTF_ASSERT_EQUAL(table.increment(data, 20, 5), 5, u64);
+	PTF_ASSERT_EQUAL(table.increment("", 0), 1, u64);
+	PTF_ASSERT_EQUAL(table.size(), 3, size);
+
+	// grow the table well past its initial capacity
+	char name[32];
+	for (int i = 0; i < 1000; i++)
+	{
+		snprintf(name, sizeof(name), "host%d", i);
+		table.increment(name, strlen(name), i + 1);
+	}
+	PTF_ASSERT_EQUAL(table.size(), 1003, size);
+	PTF_ASSERT_EQUAL(table.getCount(pcpp::PrehashedString("www.example.com", 15)), 2, u64);
+	PTF_ASSERT_EQUAL(table.getCount(pcpp::PrehashedString("host999", 7)), 1000, u64);
+	PTF_ASSERT_EQUAL(table.getCount(pcpp::PrehashedString("host1000", 8)), 0, u64);
+
+	// a limited table counts strings that don't fit as "other"
+	pcpp::StringCounterTable limitedTable(2);
+	limitedTable.increment("a", 1);
+	limitedTable.increment("b", 1, 3);
+	PTF_ASSERT_EQUAL(limitedTable.increment("c", 1, 4), 0, u64);
+	PTF_ASSERT_EQUAL(limitedTable.increment("a", 1), 2, u64);
+	PTF_ASSERT_EQUAL(limitedTable.size(), 2, size);
+	PTF_ASSERT_EQUAL(limitedTable.getOtherCount(), 4, u64);
+
+	pcpp::StringCounterTable mergedTable;
+	mergedTable.increment("b", 1);
+	mergedTable.merge(limitedTable);
+	mergedTable.merge(limitedTable);
+	PTF_ASSERT_EQUAL(mergedTable.getCount(pcpp::PrehashedString("a", 1)), 4, u64);
+	PTF_ASSERT_EQUAL(mergedTable.getCount(pcpp::PrehashedString("b", 1)), 7, u64);
+	PTF_ASSERT_EQUAL(mergedTable.getOtherCount(), 8, u64);
+
+	std::vector<std::pair<std::string, uint64_t> > all;
+	mergedTable.getAll(all);
+	PTF_ASSERT_EQUAL(all.size(), 2, size);
+	PTF_ASSERT_EQUAL(all[0].first, "b", string);
+	PTF_ASSERT_EQUAL(all[0].second, 7, u64);
+	PTF_ASSERT_EQUAL(all[1].first, "a", string);
+
+	pcpp::StringCounterTable copiedTable = mergedTable;
+	mergedTable.clear();
+	PTF_ASSERT_EQUAL(mergedTable.size(), 0, size);
+	PTF_ASSERT_EQUAL(mergedTable.getOtherCount(), 0, u64);
+	PTF_ASSERT_EQUAL(copiedTable.getCount(pcpp::PrehashedString("b", 1)), 7, u64);
+} // StringCounterTableTest
+
+
+
+PTF_TEST_CASE(HttpTrafficStatsCollectorTest)
+{
+	timeval time;
+	gettimeofday(&time, NULL);
+
+	READ_FILE_AND_CREATE_PACKET(1, "PacketExamples/TwoHttpRequests1.dat");
+	READ_FILE_AND_CREATE_PACKET(2, "PacketExamples/TwoHttpResponses1.dat");
+	READ_FILE_AND_CREATE_PACKET(3, "PacketExamples/Dns3.dat");
+
+	pcpp::Packet requestPacket(&rawPacket1);
+	pcpp::Packet responsePacket(&rawPacket2);
+	pcpp::Packet nonHttpPacket(&rawPacket3);
+
+	// every "core" has its own collector
+	pcpp::HttpTrafficStatsCollector collector1;
+	pcpp::HttpTrafficStatsCollector collector2;
+
+	collector1.collectStats(requestPacket);
+	// a retransmission is counted as a request but doesn't open another transaction
+	collector1.collectStats(requestPacket);
+	collector1.collectStats(nonHttpPacket);
+	collector2.collectStats(responsePacket);
+
+	const pcpp::HttpTrafficStats& stats1 = collector1.getStats();
+	PTF_ASSERT_EQUAL(stats1.numOfPackets, 2, u64);
+	PTF_ASSERT_EQUAL(stats1.numOfFlows, 1, u64);
+	PTF_ASSERT_EQUAL(stats1.numOfRequests, 2, u64);
+	PTF_ASSERT_EQUAL(stats1.methodCount[pcpp::HttpRequestLayer::HttpGET], 2, u64);
+	PTF_ASSERT_EQUAL(stats1.hostnameCount.getCount(pcpp::PrehashedString("www.ynet.co.il", 14)), 2, u64);
+	PTF_ASSERT_EQUAL(stats1.numOfPipeliningFlows, 0, u64);
+	PTF_ASSERT_EQUAL(stats1.numOfResponses, 0, u64);
+	PTF_ASSERT_EQUAL(collector1.getNumOfTrackedFlows(), 1, size);
+
+	const pcpp::HttpTrafficStats& stats2 = collector2.getStats();
+	PTF_ASSERT_EQUAL(stats2.numOfResponses, 1, u64);
+	PTF_ASSERT_EQUAL(stats2.statusCodeCount[200], 1, u64);
+	PTF_ASSERT_EQUAL(stats2.numOfResponsesWithContentLength, 1, u64);
+	PTF_ASSERT_EQUAL(stats2.totalContentLength, 1616, u64);
+	PTF_ASSERT_EQUAL(stats2.contentTypeCount.getCount(pcpp::PrehashedString("application/x-javascript", 24)), 1, u64);
+	// a response without an open request doesn't complete a transaction
+	PTF_ASSERT_EQUAL(stats2.numOfTransactions, 0, u64);
+
+	// merge periodically into one aggregate
+	uint64_t payloadBytes = stats1.payloadBytes + stats2.payloadBytes;
+	pcpp::HttpTrafficStats aggregate;
+	collector1.flushStats(aggregate);
+	collector2.flushStats(aggregate);
+	PTF_ASSERT_EQUAL(aggregate.numOfPackets, 3, u64);
+	PTF_ASSERT_EQUAL(aggregate.numOfFlows, 2, u64);
+	PTF_ASSERT_EQUAL(aggregate.numOfRequests, 2, u64);
+	PTF_ASSERT_EQUAL(aggregate.numOfResponses, 1, u64);
+	PTF_ASSERT_EQUAL(aggregate.payloadBytes, payloadBytes, u64);
+	PTF_ASSERT_EQUAL(aggregate.requestHeaderBytes, 2 * (uint64_t)requestPacket.getLayerOfType<pcpp::HttpRequestLayer>()->getHeaderLen(), u64);
+	PTF_ASSERT_EQUAL(aggregate.hostnameCount.size(), 1, size);
+	PTF_ASSERT_EQUAL(aggregate.statusCodeCount[200], 1, u64);
+
+	// flushing zeroes the stats but keeps the flows
+	PTF_ASSERT_EQUAL(collector1.getStats().numOfPackets, 0, u64);
+	PTF_ASSERT_EQUAL(collector1.getStats().hostnameCount.size(), 0, size);
+	PTF_ASSERT_EQUAL(collector1.getNumOfTrackedFlows(), 1, size);
+	collector1.collectStats(requestPacket);
+	PTF_ASSERT_EQUAL(collector1.getStats().numOfFlows, 0, u64);
+	collector1.flushStats(aggregate);
+	PTF_ASSERT_EQUAL(aggregate.numOfRequests, 3, u64);
+	PTF_ASSERT_EQUAL(aggregate.hostnameCount.getCount(pcpp::PrehashedString("www.ynet.co.il", 14)), 3, u64);
+
+	// a RST closes the flow
+	pcpp::TcpLayer* tcpLayer = requestPacket.getLayerOfType<pcpp::TcpLayer>();
+	tcpLayer->getTcpHeader()->rstFlag = 1;
+	collector1.collectStats(requestPacket);
+	PTF_ASSERT_EQUAL(collector1.getNumOfTrackedFlows(), 0, size);
+
+	// flows that don't fit in the flow table aren't tracked
+	pcpp::HttpTrafficStatsCollector limitedCollector(80, 1);
+	tcpLayer->getTcpHeader()->rstFlag = 0;
+	limitedCollector.collectStats(requestPacket);
+	limitedCollector.collectStats(responsePacket);
+	PTF_ASSERT_EQUAL(limitedCollector.getStats().numOfFlows, 1, u64);
+	PTF_ASSERT_EQUAL(limitedCollector.getStats().numOfUntrackedPackets, 1, u64);
+	PTF_ASSERT_EQUAL(limitedCollector.getStats().numOfResponses, 0, u64);
+
+	limitedCollector.clear();
+	PTF_ASSERT_EQUAL(limitedCollector.getNumOfTrackedFlows(), 0, size);
+	PTF_ASSERT_EQUAL(limitedCollector.getStats().numOfPackets, 0, u64);
+} // HttpTrafficStatsCollectorTest
+
+
+
+PTF_TEST_CASE(SSLTrafficStatsCollectorTest)
+{
+	timeval time;
+	gettimeofday(&time, NULL);
+
+	READ_FILE_AND_CREATE_PACKET(1, "PacketExamples/SSL-ClientHello1.dat");
+	READ_FILE_AND_CREATE_PACKET(2, "PacketExamples/SSL-MultipleRecords1.dat");
+	READ_FILE_AND_CREATE_PACKET(3, "PacketExamples/SSL-MultipleAppData.dat");
+	READ_FILE_AND_CREATE_PACKET(4, "PacketExamples/SSL-AlertClear.dat");
+
+	pcpp::Packet clientHelloPacket(&rawPacket1);
+	pcpp::Packet serverHelloPacket(&rawPacket2);
+	pcpp::Packet appDataPacket(&rawPacket3);
+	pcpp::Packet alertPacket(&rawPacket4);
+
+	pcpp::SSLTrafficStatsCollector collector1;
+	pcpp::SSLTrafficStatsCollector collector2;
+
+	collector1.collectStats(clientHelloPacket);
+	collector1.collectStats(appDataPacket);
+	collector1.collectStats(appDataPacket);
+	collector2.collectStats(serverHelloPacket);
+	collector2.collectStats(alertPacket);
+
+	const pcpp::SSLTrafficStats& stats1 = collector1.getStats();
+	PTF_ASSERT_EQUAL(stats1.numOfPackets, 3, u64);
+	PTF_ASSERT_EQUAL(stats1.numOfClientHellos, 1, u64);
+	PTF_ASSERT_EQUAL(stats1.serverNameCount.getCount(pcpp::PrehashedString("www.google.com", 14)), 1, u64);
+	PTF_ASSERT_EQUAL(stats1.numOfHandshakeCompleteFlows, 1, u64);
+
+	const pcpp::SSLTrafficStats& stats2 = collector2.getStats();
+	PTF_ASSERT_EQUAL(stats2.numOfServerHellos, 1, u64);
+	PTF_ASSERT_EQUAL(stats2.cipherSuiteCount.size(), 1, size);
+	PTF_ASSERT_EQUAL(stats2.cipherSuiteCount.begin()->first, 0xc02b, hex);
+	PTF_ASSERT_EQUAL(stats2.versionCount.size(), 1, size);
+	PTF_ASSERT_EQUAL(stats2.versionCount.begin()->first, 0x0303, hex);
+	PTF_ASSERT_EQUAL(stats2.numOfFlowsWithAlerts, 1, u64);
+
+	uint64_t numOfFlows = stats1.numOfFlows + stats2.numOfFlows;
+	pcpp::SSLTrafficStats aggregate;
+	collector1.flushStats(aggregate);
+	collector2.flushStats(aggregate);
+	PTF_ASSERT_EQUAL(aggregate.numOfPackets, 5, u64);
+	PTF_ASSERT_EQUAL(aggregate.numOfFlows, numOfFlows, u64);
+	PTF_ASSERT_EQUAL(aggregate.numOfClientHellos, 1, u64);
+	PTF_ASSERT_EQUAL(aggregate.numOfServerHellos, 1, u64);
+	PTF_ASSERT_EQUAL(aggregate.numOfHandshakeCompleteFlows, 1, u64);
+	PTF_ASSERT_EQUAL(aggregate.numOfFlowsWithAlerts, 1, u64);
+	PTF_ASSERT_EQUAL(aggregate.serverNameCount.size(), 1, size);
+	PTF_ASSERT_EQUAL(aggregate.portCount[443], aggregate.numOfFlows, u64);
+	PTF_ASSERT_EQUAL(collector1.getStats().numOfPackets, 0, u64);
+} // SSLTrafficStatsCollectorTest
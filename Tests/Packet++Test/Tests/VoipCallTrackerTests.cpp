@@ -0,0 +1,301 @@
+#include "../TestDefinition.h"
+#include "EndianPortable.h"
+#include "Logger.h"
+#include "Packet.h"
+#include "EthLayer.h"
+#include "IPv4Layer.h"
+#include "IPv6Layer.h"
+#include "UdpLayer.h"
+#include "PayloadLayer.h"
+#include "PointerVector.h"
+#include "VoipCallTracker.h"
+#include "SystemUtils.h"
+#include <string.h>
+#include <sstream>
+
+
+struct VoipCallEndData
+{
+	int numOfEndedCalls;
+	std::string lastCallId;
+	pcpp::VoipCall::CallState lastState;
+	size_t lastNumOfStreams;
+	uint64_t lastTotalRtpPackets;
+
+	VoipCallEndData() : numOfEndedCalls(0), lastState(pcpp::VoipCall::CallStateInviting), lastNumOfStreams(0), lastTotalRtpPackets(0) {}
+};
+
+
+static void onVoipCallEnd(const pcpp::VoipCall* call, void* userCookie)
+{
+	VoipCallEndData* data = (VoipCallEndData*)userCookie;
+	data->numOfEndedCalls++;
+	data->lastCallId = call->getCallId();
+	data->lastState = call->getState();
+	data->lastNumOfStreams = call->getNumOfStreams();
+	data->lastTotalRtpPackets = 0;
+	for (size_t i = 0; i < call->getNumOfStreams(); i++)
+		data->lastTotalRtpPackets += call->getStream(i)->getNumOfPackets();
+}
+
+
+static pcpp::RawPacket* createUdpRawPacket(const std::string& srcIP, const std::string& dstIP, uint16_t srcPort, uint16_t dstPort,
+		const uint8_t* payload, size_t payloadLen, long sec, long nsec)
+{
+	bool isIPv6 = (srcIP.find(':') != std::string::npos);
+	pcpp::EthLayer ethLayer(pcpp::MacAddress("aa:aa:aa:aa:aa:aa"), pcpp::MacAddress("bb:bb:bb:bb:bb:bb"), isIPv6 ? PCPP_ETHERTYPE_IPV6 : PCPP_ETHERTYPE_IP);
+	pcpp::IPv4Layer ip4Layer(pcpp::IPv4Address(isIPv6 ? "0.0.0.0" : srcIP), pcpp::IPv4Address(isIPv6 ? "0.0.0.0" : dstIP));
+	ip4Layer.getIPv4Header()->timeToLive = 64;
+	pcpp::IPv6Layer ip6Layer(pcpp::IPv6Address(isIPv6 ? srcIP : "::"), pcpp::IPv6Address(isIPv6 ? dstIP : "::"));
+	ip6Layer.getIPv6Header()->hopLimit = 64;
+	pcpp::UdpLayer udpLayer(srcPort, dstPort);
+	pcpp::PayloadLayer payloadLayer(payload, payloadLen, false);
+
+	pcpp::Packet packet(100);
+	packet.addLayer(&ethLayer);
+	if (isIPv6)
+		packet.addLayer(&ip6Layer);
+	else
+		packet.addLayer(&ip4Layer);
+	packet.addLayer(&udpLayer);
+	packet.addLayer(&payloadLayer);
+	packet.computeCalculateFields();
+
+	int len = packet.getRawPacket()->getRawDataLen();
+	uint8_t* data = new uint8_t[len];
+	memcpy(data, packet.getRawPacket()->getRawData(), len);
+	timespec ts;
+	ts.tv_sec = sec;
+	ts.tv_nsec = nsec;
+	return new pcpp::RawPacket(data, len, ts, true);
+}
+
+
+static pcpp::RawPacket* createSipRawPacket(const std::string& srcIP, const std::string& dstIP, const std::string& firstLine, const std::string& callId,
+		const std::string& cseq, const std::string& sdp, long sec, long nsec)
+{
+	std::ostringstream msg;
+	msg << firstLine << "\r\n"
+		<< "Via: SIP/2.0/UDP " << srcIP << ":5060;branch=z9hG4bK776asdhds\r\n"
+		<< "From: <sip:alice@example.com>;tag=1928301774\r\n"
+		<< "To: <sip:bob@example.com>\r\n"
+		<< "Call-ID: " << callId << "\r\n"
+		<< "CSeq: " << cseq << "\r\n";
+	if (!sdp.empty())
+		msg << "Content-Type: application/sdp\r\n";
+	msg << "Content-Length: " << sdp.length() << "\r\n\r\n" << sdp;
+
+	std::string msgStr = msg.str();
+	return createUdpRawPacket(srcIP, dstIP, 5060, 5060, (const uint8_t*)msgStr.c_str(), msgStr.length(), sec, nsec);
+}
+
+
+static pcpp::RawPacket* createRtpRawPacket(const std::string& srcIP, const std::string& dstIP, uint16_t dstPort, uint16_t seq, uint32_t timestamp,
+		uint32_t ssrc, long sec, long nsec)
+{
+	uint8_t rtp[172];
+	memset(rtp, 0, sizeof(rtp));
+	rtp[0] = 0x80;
+	rtp[1] = 0x08;
+	*(uint16_t*)(rtp + 2) = htobe16(seq);
+	*(uint32_t*)(rtp + 4) = htobe32(timestamp);
+	*(uint32_t*)(rtp + 8) = htobe32(ssrc);
+	return createUdpRawPacket(srcIP, dstIP, 20000, dstPort, rtp, sizeof(rtp), sec, nsec);
+}
+
+
+#define PROCESS_RAW_PACKET(tracker, rawPacketPtr, expectedResult) \
+	{ \
+		pcpp::RawPacket* rawPacketToProcess = rawPacketPtr; \
+		rawPackets.pushBack(rawPacketToProcess); \
+		pcpp::Packet packetToProcess(rawPacketToProcess); \
+		PTF_ASSERT_EQUAL(tracker.processPacket(&packetToProcess), expectedResult, enum); \
+	}
+
+
+
+PTF_TEST_CASE(VoipCallTrackerSipRtpTest)
+{
+	pcpp::PointerVector<pcpp::RawPacket> rawPackets;
+	VoipCallEndData endData;
+	pcpp::VoipCallTracker tracker(onVoipCallEnd, &endData);
+
+	std::string offer =
+		"v=0\r\no=alice 2890844526 2890844526 IN IP4 10.0.0.1\r\ns=call\r\nc=IN IP4 10.0.0.1\r\nt=0 0\r\n"
+		"m=audio 40000 RTP/AVP 0 101\r\na=rtpmap:0 PCMU/8000\r\na=rtpmap:101 telephone-event/8000\r\n";
+
+	// media-level connection overrides the session-level one, a disabled media (port 0) is ignored
+	std::string answer =
+		"v=0\r\no=bob 2808844564 2808844564 IN IP4 10.0.0.2\r\ns=call\r\nc=IN IP4 10.0.0.99\r\nt=0 0\r\n"
+		"m=audio 50000 RTP/AVP 8\r\nc=IN IP4 10.0.0.2\r\na=rtpmap:8 PCMA/8000\r\nm=video 0 RTP/AVP 96\r\n";
+
+	PROCESS_RAW_PACKET(tracker, createSipRawPacket("10.0.0.1", "10.0.0.2", "INVITE sip:bob@example.com SIP/2.0", "a84b4c76e66710", "314159 INVITE", offer, 1000, 0),
+			pcpp::VoipCallTracker::SipPacketProcessed);
+
+	PTF_ASSERT_EQUAL(tracker.getNumOfCalls(), 1, size);
+	const pcpp::VoipCall* call = tracker.getCall("a84b4c76e66710");
+	PTF_ASSERT_NOT_NULL(call);
+	PTF_ASSERT_EQUAL(call->getState(), pcpp::VoipCall::CallStateInviting, enum);
+	PTF_ASSERT_EQUAL(call->getFrom(), "<sip:alice@example.com>;tag=1928301774", string);
+	PTF_ASSERT_EQUAL(call->getNumOfStreams(), 1, size);
+	PTF_ASSERT_EQUAL(call->getStream(0)->getDstIP().toString(), "10.0.0.1", string);
+	PTF_ASSERT_EQUAL(call->getStream(0)->getDstPort(), 40000, u16);
+	PTF_ASSERT_EQUAL(call->getStream(0)->getMediaType(), "audio", string);
+	PTF_ASSERT_TRUE(call->getStream(0)->isTowardsCaller());
+
+	PROCESS_RAW_PACKET(tracker, createSipRawPacket("10.0.0.2", "10.0.0.1", "SIP/2.0 100 Trying", "a84b4c76e66710", "314159 INVITE", "", 1000, 10000000),
+			pcpp::VoipCallTracker::SipPacketProcessed);
+	PTF_ASSERT_EQUAL(call->getState(), pcpp::VoipCall::CallStateInviting, enum);
+	PROCESS_RAW_PACKET(tracker, createSipRawPacket("10.0.0.2", "10.0.0.1", "SIP/2.0 180 Ringing", "a84b4c76e66710", "314159 INVITE", "", 1000, 20000000),
+			pcpp::VoipCallTracker::SipPacketProcessed);
+	PTF_ASSERT_EQUAL(call->getState(), pcpp::VoipCall::CallStateRinging, enum);
+	PROCESS_RAW_PACKET(tracker, createSipRawPacket("10.0.0.2", "10.0.0.1", "SIP/2.0 200 OK", "a84b4c76e66710", "314159 INVITE", answer, 1002, 0),
+			pcpp::VoipCallTracker::SipPacketProcessed);
+	PTF_ASSERT_EQUAL(call->getState(), pcpp::VoipCall::CallStateEstablished, enum);
+	PTF_ASSERT_EQUAL((int)call->getAnswerTime().tv_sec, 1002, int);
+	PTF_ASSERT_EQUAL(call->getNumOfStreams(), 2, size);
+	PTF_ASSERT_EQUAL(tracker.getNumOfMediaEndpoints(), 2, size);
+
+	const pcpp::RtpStream* toCallee = tracker.findStream(pcpp::IPAddress("10.0.0.2"), 50000);
+	PTF_ASSERT_NOT_NULL(toCallee);
+	PTF_ASSERT_FALSE(toCallee->isTowardsCaller());
+	PTF_ASSERT_EQUAL(toCallee->getClockRate(), 8000, u32);
+	PTF_ASSERT_TRUE(toCallee->getCall() == call);
+	PTF_ASSERT_NULL(tracker.findStream(pcpp::IPAddress("10.0.0.99"), 50000));
+	const pcpp::RtpStream* toCaller = tracker.findStream(pcpp::IPAddress("10.0.0.1"), 40000);
+	PTF_ASSERT_NOT_NULL(toCaller);
+
+	// caller -> callee: 20ms packetization with no arrival jitter, seq 1010 and 1020-1022 are missing and 1010 arrives late at the end
+	for (int i = 0; i < 50; i++)
+	{
+		uint16_t seq = 1000 + i;
+		if (seq == 1010 || (seq >= 1020 && seq <= 1022))
+			continue;
+		PROCESS_RAW_PACKET(tracker, createRtpRawPacket("10.0.0.1", "10.0.0.2", 50000, seq, 5000 + i * 160, 0x11223344, 1003 + i / 50, (i % 50) * 20000000),
+				pcpp::VoipCallTracker::RtpPacketProcessed);
+	}
+
+	PTF_ASSERT_TRUE(toCallee->getJitterMsec() < 0.001);
+	PTF_ASSERT_EQUAL(toCallee->getNumOfLostPackets(), 4, u64);
+	PROCESS_RAW_PACKET(tracker, createRtpRawPacket("10.0.0.1", "10.0.0.2", 50000, 1010, 5000 + 10 * 160, 0x11223344, 1004, 0),
+			pcpp::VoipCallTracker::RtpPacketProcessed);
+
+	PTF_ASSERT_EQUAL(toCallee->getNumOfPackets(), 47, u64);
+	PTF_ASSERT_EQUAL(toCallee->getNumOfBytes(), 47 * 172, u64);
+	PTF_ASSERT_EQUAL(toCallee->getNumOfLostPackets(), 3, u64);
+	PTF_ASSERT_EQUAL(toCallee->getNumOfSequenceGaps(), 2, u64);
+	PTF_ASSERT_EQUAL(toCallee->getNumOfOutOfOrderPackets(), 1, u64);
+	PTF_ASSERT_EQUAL(toCallee->getSsrc(), 0x11223344, u32);
+	PTF_ASSERT_EQUAL(toCallee->getPayloadType(), 8, u8);
+	PTF_ASSERT_TRUE(toCallee->getJitterMsec() > 0);
+
+	// callee -> caller: sequence numbers wrap around and every other packet is delayed by 10ms
+	for (int i = 0; i < 20; i++)
+	{
+		uint16_t seq = 65530 + i;
+		long nsec = i * 20000000 + (i % 2 == 1 ? 10000000 : 0);
+		PROCESS_RAW_PACKET(tracker, createRtpRawPacket("10.0.0.2", "10.0.0.1", 40000, seq, 80000 + i * 160, 0x55667788, 1003, nsec),
+				pcpp::VoipCallTracker::RtpPacketProcessed);
+	}
+
+	PTF_ASSERT_EQUAL(toCaller->getNumOfPackets(), 20, u64);
+	PTF_ASSERT_EQUAL(toCaller->getNumOfLostPackets(), 0, u64);
+	PTF_ASSERT_EQUAL(toCaller->getNumOfSequenceGaps(), 0, u64);
+	PTF_ASSERT_EQUAL(toCaller->getNumOfOutOfOrderPackets(), 0, u64);
+	PTF_ASSERT_TRUE(toCaller->getJitterMsec() > 5 && toCaller->getJitterMsec() < 10);
+	PTF_ASSERT_TRUE(toCaller->getMaxJitterMsec() >= toCaller->getJitterMsec());
+
+	// RTCP multiplexed on the RTP port, non-RTP data and packets to unknown endpoints aren't counted
+	uint8_t rtcp[8] = { 0x80, 0xc8, 0x00, 0x01, 0x55, 0x66, 0x77, 0x88 };
+	PROCESS_RAW_PACKET(tracker, createUdpRawPacket("10.0.0.2", "10.0.0.1", 20000, 40000, rtcp, sizeof(rtcp), 1004, 0), pcpp::VoipCallTracker::PacketNotTracked);
+	uint8_t notRtp[20] = { 0 };
+	PROCESS_RAW_PACKET(tracker, createUdpRawPacket("10.0.0.2", "10.0.0.1", 20000, 40000, notRtp, sizeof(notRtp), 1004, 0), pcpp::VoipCallTracker::PacketNotTracked);
+	PROCESS_RAW_PACKET(tracker, createRtpRawPacket("10.0.0.2", "10.0.0.1", 40002, 1, 1, 1, 1004, 0), pcpp::VoipCallTracker::PacketNotTracked);
+	PTF_ASSERT_EQUAL(toCaller->getNumOfPackets(), 20, u64);
+
+	// hang up
+	PROCESS_RAW_PACKET(tracker, createSipRawPacket("10.0.0.2", "10.0.0.1", "BYE sip:alice@example.com SIP/2.0", "a84b4c76e66710", "231 BYE", "", 1010, 0),
+			pcpp::VoipCallTracker::SipPacketProcessed);
+	PTF_ASSERT_EQUAL(endData.numOfEndedCalls, 1, int);
+	PTF_ASSERT_EQUAL(endData.lastCallId, "a84b4c76e66710", string);
+	PTF_ASSERT_EQUAL(endData.lastState, pcpp::VoipCall::CallStateTerminated, enum);
+	PTF_ASSERT_EQUAL(endData.lastNumOfStreams, 2, size);
+	PTF_ASSERT_EQUAL(endData.lastTotalRtpPackets, 67, u64);
+	PTF_ASSERT_EQUAL(tracker.getNumOfCalls(), 0, size);
+	PTF_ASSERT_EQUAL(tracker.getNumOfMediaEndpoints(), 0, size);
+
+	// media of an ended call isn't tracked anymore
+	PROCESS_RAW_PACKET(tracker, createRtpRawPacket("10.0.0.2", "10.0.0.1", 40000, 20, 1, 0x55667788, 1010, 0), pcpp::VoipCallTracker::PacketNotTracked);
+} // VoipCallTrackerSipRtpTest
+
+
+
+PTF_TEST_CASE(VoipCallTrackerCallLifecycleTest)
+{
+	pcpp::PointerVector<pcpp::RawPacket> rawPackets;
+	VoipCallEndData endData;
+	pcpp::VoipCallTracker tracker(onVoipCallEnd, &endData, 2);
+
+	std::string sdp = "v=0\r\no=alice 1 1 IN IP4 10.0.0.1\r\ns=-\r\nc=IN IP4 10.0.0.1\r\nt=0 0\r\nm=audio 40000 RTP/AVP 0\r\n";
+	std::string sdpIPv6 = "v=0\r\no=alice 1 1 IN IP6 2001:db8::1\r\ns=-\r\nc=IN IP6 2001:db8::1\r\nt=0 0\r\nm=audio 30000 RTP/AVP 0\r\n";
+
+	// requests of unknown dialogs other than INVITE are ignored
+	PROCESS_RAW_PACKET(tracker, createSipRawPacket("10.0.0.1", "10.0.0.2", "BYE sip:bob@example.com SIP/2.0", "unknown-call", "1 BYE", "", 100, 0),
+			pcpp::VoipCallTracker::SipPacketProcessed);
+	PTF_ASSERT_EQUAL(tracker.getNumOfCalls(), 0, size);
+
+	// rejected call
+	PROCESS_RAW_PACKET(tracker, createSipRawPacket("10.0.0.1", "10.0.0.2", "INVITE sip:bob@example.com SIP/2.0", "busy-call", "1 INVITE", sdp, 100, 0),
+			pcpp::VoipCallTracker::SipPacketProcessed);
+	PTF_ASSERT_EQUAL(tracker.getNumOfMediaEndpoints(), 1, size);
+	PROCESS_RAW_PACKET(tracker, createSipRawPacket("10.0.0.2", "10.0.0.1", "SIP/2.0 486 Busy Here", "busy-call", "1 INVITE", "", 101, 0),
+			pcpp::VoipCallTracker::SipPacketProcessed);
+	PTF_ASSERT_EQUAL(endData.numOfEndedCalls, 1, int);
+	PTF_ASSERT_EQUAL(endData.lastState, pcpp::VoipCall::CallStateFailed, enum);
+	PTF_ASSERT_EQUAL(tracker.getNumOfCalls(), 0, size);
+	PTF_ASSERT_EQUAL(tracker.getNumOfMediaEndpoints(), 0, size);
+
+	// cancelled call
+	PROCESS_RAW_PACKET(tracker, createSipRawPacket("10.0.0.1", "10.0.0.2", "INVITE sip:bob@example.com SIP/2.0", "cancelled-call", "1 INVITE", sdp, 102, 0),
+			pcpp::VoipCallTracker::SipPacketProcessed);
+	PROCESS_RAW_PACKET(tracker, createSipRawPacket("10.0.0.1", "10.0.0.2", "CANCEL sip:bob@example.com SIP/2.0", "cancelled-call", "1 CANCEL", "", 103, 0),
+			pcpp::VoipCallTracker::SipPacketProcessed);
+	PTF_ASSERT_EQUAL(endData.numOfEndedCalls, 2, int);
+	PTF_ASSERT_EQUAL(endData.lastState, pcpp::VoipCall::CallStateCancelled, enum);
+
+	// IPv6 media
+	PROCESS_RAW_PACKET(tracker, createSipRawPacket("2001:db8::1", "2001:db8::2", "INVITE sip:bob@example.com SIP/2.0", "ipv6-call", "1 INVITE", sdpIPv6, 104, 0),
+			pcpp::VoipCallTracker::SipPacketProcessed);
+	PTF_ASSERT_NOT_NULL(tracker.findStream(pcpp::IPAddress("2001:db8::1"), 30000));
+	PROCESS_RAW_PACKET(tracker, createRtpRawPacket("2001:db8::2", "2001:db8::1", 30000, 1, 160, 0xabcd, 105, 0),
+			pcpp::VoipCallTracker::RtpPacketProcessed);
+	PTF_ASSERT_EQUAL(tracker.findStream(pcpp::IPAddress("2001:db8::1"), 30000)->getNumOfPackets(), 1, u64);
+
+	// the maximum number of calls is 2, so the third concurrent call is ignored
+	PROCESS_RAW_PACKET(tracker, createSipRawPacket("10.0.0.1", "10.0.0.2", "INVITE sip:bob@example.com SIP/2.0", "second-call", "1 INVITE", sdp, 200, 0),
+			pcpp::VoipCallTracker::SipPacketProcessed);
+	PROCESS_RAW_PACKET(tracker, createSipRawPacket("10.0.0.3", "10.0.0.2", "INVITE sip:bob@example.com SIP/2.0", "third-call", "1 INVITE", "", 200, 0),
+			pcpp::VoipCallTracker::SipPacketProcessed);
+	PTF_ASSERT_EQUAL(tracker.getNumOfCalls(), 2, size);
+	PTF_ASSERT_NULL(tracker.getCall("third-call"));
+
+	std::vector<const pcpp::VoipCall*> calls;
+	tracker.getCalls(calls);
+	PTF_ASSERT_EQUAL(calls.size(), 2, size);
+
+	// the IPv6 call was idle since time 105
+	timespec threshold;
+	threshold.tv_sec = 150;
+	threshold.tv_nsec = 0;
+	PTF_ASSERT_EQUAL(tracker.purgeIdleCalls(threshold), 1, size);
+	PTF_ASSERT_EQUAL(endData.lastCallId, "ipv6-call", string);
+	PTF_ASSERT_EQUAL(endData.lastState, pcpp::VoipCall::CallStateTimedOut, enum);
+	PTF_ASSERT_EQUAL(endData.lastTotalRtpPackets, 1, u64);
+	PTF_ASSERT_NULL(tracker.findStream(pcpp::IPAddress("2001:db8::1"), 30000));
+
+	tracker.endAllCalls();
+	PTF_ASSERT_EQUAL(endData.numOfEndedCalls, 4, int);
+	PTF_ASSERT_EQUAL(endData.lastCallId, "second-call", string);
+	PTF_ASSERT_EQUAL(tracker.getNumOfCalls(), 0, size);
+	PTF_ASSERT_EQUAL(tracker.getNumOfMediaEndpoints(), 0, size);
+} // VoipCallTrackerCallLifecycleTest
@@ -114,12 +114,14 @@ int main(int argc, char* argv[])
 	PTF_RUN_TEST(IPv4PacketCreation, "ipv4");
 	PTF_RUN_TEST(IPv4PacketParsing, "ipv4");
 	PTF_RUN_TEST(IPv4FragmentationTest, "ipv4");
+	PTF_RUN_TEST(IPv4PacketFragmentationTest, "ipv4;ip_frag");
 	PTF_RUN_TEST(IPv4OptionsParsingTest, "ipv4");
 	PTF_RUN_TEST(IPv4OptionsEditTest, "ipv4");
 	PTF_RUN_TEST(IPv4UdpChecksum, "ipv4");
 
 	PTF_RUN_TEST(IPv6UdpPacketParseAndCreate, "ipv6");
 	PTF_RUN_TEST(IPv6FragmentationTest, "ipv6");
+	PTF_RUN_TEST(IPv6PacketFragmentationTest, "ipv6;ip_frag");
 	PTF_RUN_TEST(IPv6ExtensionsTest, "ipv6");
 
 	PTF_RUN_TEST(TcpPacketNoOptionsParsing, "tcp");
@@ -142,6 +144,8 @@ int main(int argc, char* argv[])
 	PTF_RUN_TEST(ParsePartialPacketTest, "packet;partial_packet");
 	PTF_RUN_TEST(PacketTrailerTest, "packet;packet_trailer");
 	PTF_RUN_TEST(ResizeLayerTest, "packet;resize");
+	PTF_RUN_TEST(PacketCloneTest, "packet;copy_packet");
+	PTF_RUN_TEST(RawPacketRefCountTest, "packet;raw_packet");
 
 	PTF_RUN_TEST(HttpRequestLayerParsingTest, "http");
 	PTF_RUN_TEST(HttpRequestLayerCreationTest, "http");
@@ -221,5 +225,26 @@ int main(int argc, char* argv[])
 	PTF_RUN_TEST(SSHParsingTest, "ssh");
 	PTF_RUN_TEST(SSHMalformedParsingTest, "ssh");
 
+	PTF_RUN_TEST(PacketGeneratorUdpTest, "packet_generator");
+	PTF_RUN_TEST(PacketGeneratorTcpBurstTest, "packet_generator");
+	PTF_RUN_TEST(PacketGeneratorInvalidSettingsTest, "packet_generator");
+
+	PTF_RUN_TEST(VoipCallTrackerSipRtpTest, "sip;voip");
+	PTF_RUN_TEST(VoipCallTrackerCallLifecycleTest, "sip;voip");
+
+	PTF_RUN_TEST(ProtocolStatsHierarchyTest, "protocol_stats");
+	PTF_RUN_TEST(ProtocolStatsTimeBucketsAndMergeTest, "protocol_stats");
+
+	PTF_RUN_TEST(StringCounterTableTest, "traffic_stats");
+	PTF_RUN_TEST(HttpTrafficStatsCollectorTest, "traffic_stats;http");
+	PTF_RUN_TEST(SSLTrafficStatsCollectorTest, "traffic_stats;ssl");
+
+	PTF_RUN_TEST(DnsResponderIPv4Test, "dns;dns_responder");
+	PTF_RUN_TEST(DnsResponderIPv6AndNameErrorTest, "dns;dns_responder");
+	PTF_RUN_TEST(StackParserTest, "stack_parser");
+	PTF_RUN_TEST(StackParserVlanAndGtpTest, "stack_parser;vlan;gtp");
+	PTF_RUN_TEST(PacketBuilderEthIPv4TcpTest, "packet_builder");
+	PTF_RUN_TEST(PacketBuilderUserBufferTest, "packet_builder;vlan;ipv6");
+
 	PTF_END_RUNNING_TESTS;
 }
@@ -18,6 +18,8 @@ PTF_TEST_CASE(TestPcapNgFileReadWrite);
 PTF_TEST_CASE(TestPcapNgFileReadWriteAdv);
 PTF_TEST_CASE(TestPcapFileReadLinkTypeIPv6);
 PTF_TEST_CASE(TestPcapFileReadLinkTypeIPv4);
+PTF_TEST_CASE(TestAsyncPcapFileReadWrite);
+PTF_TEST_CASE(TestRotatingPcapFileWriter);
 
 // Implemented in LiveDeviceTests.cpp
 PTF_TEST_CASE(TestPcapLiveDeviceList);
@@ -59,9 +61,12 @@ PTF_TEST_CASE(TestTcpReassemblyIPv6_OOO);
 PTF_TEST_CASE(TestTcpReassemblyCleanup);
 PTF_TEST_CASE(TestTcpReassemblyMaxOOOFrags);
 PTF_TEST_CASE(TestTcpReassemblyMaxSeq);
+PTF_TEST_CASE(TestTcpReassemblyStreamBuffers);
+PTF_TEST_CASE(TestTcpReassemblyBatch);
 
 // Implemented in IPFragmentationTests.cpp
 PTF_TEST_CASE(TestIPFragmentationSanity);
+PTF_TEST_CASE(TestIPFragmentationBatch);
 PTF_TEST_CASE(TestIPFragOutOfOrder);
 PTF_TEST_CASE(TestIPFragPartialData);
 PTF_TEST_CASE(TestIPFragMultipleFrags);
@@ -71,6 +76,7 @@ PTF_TEST_CASE(TestIPFragRemove);
 // Implemented in PfRingTests.cpp
 PTF_TEST_CASE(TestPfRingDevice);
 PTF_TEST_CASE(TestPfRingDeviceSingleChannel);
+PTF_TEST_CASE(TestPfRingPollingPolicy);
 PTF_TEST_CASE(TestPfRingMultiThreadAllCores);
 PTF_TEST_CASE(TestPfRingMultiThreadSomeCores);
 PTF_TEST_CASE(TestPfRingSendPacket);
@@ -91,3 +97,38 @@ PTF_TEST_CASE(TestKniDeviceSendReceive);
 
 // Implemented in RawSocketTests.cpp
 PTF_TEST_CASE(TestRawSockets);
+
+// Implemented in SystemUtilsTests.cpp
+PTF_TEST_CASE(TestCoreMask);
+PTF_TEST_CASE(TestSystemCoreTopology);
+
+// Implemented in PollingPolicyTests.cpp
+PTF_TEST_CASE(TestPollingControllerBusySpin);
+PTF_TEST_CASE(TestPollingControllerBackoff);
+PTF_TEST_CASE(TestPollingControllerInterrupt);
+PTF_TEST_CASE(TestPollingStats);
+
+// Implemented in CaptureStreamTests.cpp
+PTF_TEST_CASE(TestCaptureStreamFile);
+PTF_TEST_CASE(TestCaptureStreamFilter);
+
+// Implemented in XdpTests.cpp
+PTF_TEST_CASE(TestXdpDevice);
+
+// Implemented in FlightRecorderTests.cpp
+PTF_TEST_CASE(TestFlightRecorderDump);
+
+// Implemented in PacketMergerTests.cpp
+PTF_TEST_CASE(TestPacketMerger);
+PTF_TEST_CASE(TestPacketMergerThreads);
+
+// Implemented in PacketLoadBalancerTests.cpp
+PTF_TEST_CASE(TestPacketLoadBalancer);
+PTF_TEST_CASE(TestPacketLoadBalancerRebalance);
+PTF_TEST_CASE(TestPacketLoadBalancerThreads);
+PTF_TEST_CASE(TestPacketLoadBalancerProcesses);
+
+// Implemented in SharedMemoryRingTests.cpp
+PTF_TEST_CASE(TestSharedMemoryRing);
+PTF_TEST_CASE(TestSharedMemoryRingOverwrite);
+PTF_TEST_CASE(TestSharedMemoryRingProcesses);
@@ -0,0 +1,178 @@
+#include "../TestDefinition.h"
+#include "../Common/TestUtils.h"
+#include "../Common/PcapFileNamesDef.h"
+#include "Logger.h"
+#include "CaptureStream.h"
+#include "PcapFileDevice.h"
+#include "PcapFilter.h"
+#include "SystemUtils.h"
+#include <string.h>
+
+
+struct CaptureStreamReceivedPackets
+{
+	pcpp::RawPacketVector packets;
+	int numOfBatches;
+
+	CaptureStreamReceivedPackets() : numOfBatches(0) {}
+};
+
+static void captureStreamOnBatchArrives(pcpp::RawPacketVector& packets, pcpp::CaptureStreamClientDevice* device, void* userCookie)
+{
+	CaptureStreamReceivedPackets* received = (CaptureStreamReceivedPackets*)userCookie;
+	received->numOfBatches++;
+	for (pcpp::RawPacketVector::VectorIterator iter = packets.begin(); iter != packets.end(); )
+		received->packets.pushBack(packets.getAndRemoveFromVector(iter));
+}
+
+static bool captureStreamWaitForPackets(CaptureStreamReceivedPackets& received, size_t expected)
+{
+	for (int i = 0; i < 5 && received.packets.size() < expected; i++)
+		pcpp::multiPlatformSleep(1);
+
+	return received.packets.size() == expected;
+}
+
+
+
+PTF_TEST_CASE(TestCaptureStreamFile)
+{
+	std::vector<pcpp::RawPacket> packetStream;
+	std::string errMsg;
+	PTF_ASSERT_TRUE(readPcapIntoPacketVec(EXAMPLE_PCAP_PATH, packetStream, errMsg));
+
+	pcpp::CaptureStreamServer::Config config;
+	config.maxBatchPackets = 32;
+	config.maxQueuedBatches = 4;
+	config.blockWhenQueueFull = true;
+	pcpp::CaptureStreamServer server(pcpp::IPv4Address(std::string("127.0.0.1")), 0, pcpp::LINKTYPE_ETHERNET, config);
+	PTF_ASSERT_TRUE(server.start());
+	PTF_ASSERT_TRUE(server.isRunning());
+	PTF_ASSERT_NOT_EQUAL(server.getPort(), 0, u16);
+
+	pcpp::CaptureStreamClientDevice client(pcpp::IPv4Address(std::string("127.0.0.1")), server.getPort(), true, 2);
+	PTF_ASSERT_TRUE(client.open());
+	DeviceTeardown devTeardown(&client);
+	PTF_ASSERT_EQUAL(client.getLinkType(), pcpp::LINKTYPE_ETHERNET, enum);
+
+	CaptureStreamReceivedPackets received;
+	PTF_ASSERT_TRUE(client.startCapture(captureStreamOnBatchArrives, &received));
+	PTF_ASSERT_TRUE(client.captureActive());
+
+	pcpp::PcapFileReaderDevice reader(EXAMPLE_PCAP_PATH);
+	PTF_ASSERT_TRUE(reader.open());
+	PTF_ASSERT_EQUAL(server.streamFile(reader), (int)packetStream.size(), int);
+	reader.close();
+
+	PTF_ASSERT_TRUE(captureStreamWaitForPackets(received, packetStream.size()));
+	client.stopCapture();
+	PTF_ASSERT_FALSE(client.captureActive());
+
+	// packets should arrive in order and be identical to the ones in the file
+	int index = 0;
+	for (pcpp::RawPacketVector::VectorIterator iter = received.packets.begin(); iter != received.packets.end(); iter++, index++)
+	{
+		pcpp::RawPacket& expected = packetStream.at(index);
+		PTF_ASSERT_EQUAL((*iter)->getRawDataLen(), expected.getRawDataLen(), int);
+		PTF_ASSERT_EQUAL((*iter)->getFrameLength(), expected.getFrameLength(), int);
+		PTF_ASSERT_EQUAL((*iter)->getPacketTimeStamp().tv_sec, expected.getPacketTimeStamp().tv_sec, int);
+		PTF_ASSERT_EQUAL((*iter)->getPacketTimeStamp().tv_nsec, expected.getPacketTimeStamp().tv_nsec, int);
+		PTF_ASSERT_BUF_COMPARE((*iter)->getRawData(), expected.getRawData(), expected.getRawDataLen());
+	}
+
+	// packets are batched so there should be much less batches than packets
+	PTF_ASSERT_LOWER_THAN(received.numOfBatches, (int)packetStream.size(), int);
+
+	pcpp::CaptureStreamServer::Stats serverStats;
+	server.getStats(serverStats);
+	PTF_ASSERT_EQUAL(serverStats.packetsSent, (uint64_t)packetStream.size(), u64);
+	PTF_ASSERT_EQUAL(serverStats.packetsDropped, 0, u64);
+	PTF_ASSERT_EQUAL(serverStats.batchesSent, (uint64_t)received.numOfBatches, u64);
+	PTF_ASSERT_EQUAL(serverStats.numOfClients, 1, u32);
+	if (client.isCompressionEnabled())
+	{
+		PTF_ASSERT_LOWER_THAN(serverStats.bytesSent, serverStats.uncompressedBytes, u64);
+	}
+
+	pcpp::IPcapDevice::PcapStats clientStats;
+	client.getStatistics(clientStats);
+	PTF_ASSERT_EQUAL(clientStats.packetsRecv, (uint64_t)packetStream.size(), u64);
+	PTF_ASSERT_EQUAL(clientStats.packetsDrop, 0, u64);
+
+	// stopping the server should end the stream on the client side
+	server.stop();
+	PTF_ASSERT_FALSE(server.isRunning());
+	pcpp::RawPacketVector packets;
+	PTF_ASSERT_EQUAL(client.getNextBatch(packets, 2000), -1, int);
+	PTF_ASSERT_TRUE(client.isStreamEnded());
+	client.close();
+	PTF_ASSERT_FALSE(client.isOpened());
+} // TestCaptureStreamFile
+
+
+
+PTF_TEST_CASE(TestCaptureStreamFilter)
+{
+	std::vector<pcpp::RawPacket> packetStream;
+	std::string errMsg;
+	PTF_ASSERT_TRUE(readPcapIntoPacketVec(EXAMPLE_PCAP_PATH, packetStream, errMsg));
+
+	std::string filterAsString = "tcp port 80";
+	pcpp::BpfFilterWrapper filter;
+	PTF_ASSERT_TRUE(filter.setFilter(filterAsString));
+	int expectedPackets = 0;
+	for (std::vector<pcpp::RawPacket>::iterator iter = packetStream.begin(); iter != packetStream.end(); iter++)
+	{
+		if (filter.matchPacketWithFilter(&(*iter)))
+			expectedPackets++;
+	}
+	PTF_ASSERT_GREATER_THAN(expectedPackets, 0, int);
+
+	pcpp::CaptureStreamServer::Config config;
+	config.blockWhenQueueFull = true;
+	pcpp::CaptureStreamServer server(pcpp::IPv4Address(std::string("127.0.0.1")), 0, pcpp::LINKTYPE_ETHERNET, config);
+	PTF_ASSERT_TRUE(server.start());
+
+	pcpp::CaptureStreamClientDevice client(pcpp::IPv4Address(std::string("127.0.0.1")), server.getPort());
+	PTF_ASSERT_TRUE(client.open());
+	DeviceTeardown devTeardown(&client);
+
+	pcpp::LoggerPP::getInstance().supressErrors();
+	PTF_ASSERT_FALSE(client.setFilter("This is not a valid filter"));
+	pcpp::LoggerPP::getInstance().enableErrors();
+	PTF_ASSERT_TRUE(client.setFilter(filterAsString));
+
+	// the filter is applied by the server asynchronously
+	pcpp::multiPlatformSleep(1);
+
+	pcpp::PcapFileReaderDevice reader(EXAMPLE_PCAP_PATH);
+	PTF_ASSERT_TRUE(reader.open());
+	PTF_ASSERT_EQUAL(server.streamFile(reader), (int)packetStream.size(), int);
+	reader.close();
+
+	pcpp::RawPacketVector packets;
+	while ((int)packets.size() < expectedPackets && client.getNextBatch(packets, 2000) > 0);
+	PTF_ASSERT_EQUAL((int)packets.size(), expectedPackets, int);
+	for (pcpp::RawPacketVector::VectorIterator iter = packets.begin(); iter != packets.end(); iter++)
+	{
+		PTF_ASSERT_TRUE(filter.matchPacketWithFilter(*iter));
+	}
+
+	pcpp::CaptureStreamServer::Stats serverStats;
+	server.getStats(serverStats);
+	PTF_ASSERT_EQUAL(serverStats.packetsFiltered, (uint64_t)(packetStream.size() - expectedPackets), u64);
+
+	// clear the filter and stream the file again
+	PTF_ASSERT_TRUE(client.clearFilter());
+	pcpp::multiPlatformSleep(1);
+	PTF_ASSERT_TRUE(reader.open());
+	server.streamFile(reader);
+	reader.close();
+
+	pcpp::RawPacketVector allPackets;
+	while ((int)allPackets.size() < (int)packetStream.size() && client.getNextBatch(allPackets, 2000) > 0);
+	PTF_ASSERT_EQUAL(allPackets.size(), packetStream.size(), size);
+
+	client.close();
+	server.stop();
+} // TestCaptureStreamFilter
@@ -2,7 +2,11 @@
 #include "Logger.h"
 #include "Packet.h"
 #include "PcapFileDevice.h"
+#include "AsyncPcapFileDevice.h"
+#include "RotatingPcapFileWriterDevice.h"
 #include "../Common/PcapFileNamesDef.h"
+#include <string.h>
+#include <stdio.h>
 
 
 class FileReaderTeardown
@@ -745,3 +749,251 @@ PTF_TEST_CASE(TestPcapFileReadLinkTypeIPv4)
 
 } // TestPcapFileReadLinkTypeIPv4
 
+
+
+
+PTF_TEST_CASE(TestAsyncPcapFileReadWrite)
+{
+	// small chunks so packets and blocks cross chunk boundaries and all chunks are reused many times
+	pcpp::AsyncFileConfiguration config;
+	config.chunkSize = 4096;
+	config.queueDepth = 4;
+
+	pcpp::AsyncFileConfiguration::Backend backends[] = { pcpp::AsyncFileConfiguration::BackendPosix, pcpp::AsyncFileConfiguration::BackendAuto };
+	for (int backendIndex = 0; backendIndex < 2; backendIndex++)
+	{
+		config.backend = backends[backendIndex];
+
+		pcpp::AsyncPcapFileReaderDevice readerDev(EXAMPLE_PCAP_PATH, config);
+		PTF_ASSERT_TRUE(readerDev.open());
+		PTF_ASSERT_EQUAL(readerDev.getFileFormat(), pcpp::CaptureFilePcap, enum);
+		PTF_ASSERT_EQUAL(readerDev.getLinkLayerType(), pcpp::LINKTYPE_ETHERNET, enum);
+		if (config.backend == pcpp::AsyncFileConfiguration::BackendPosix)
+		{
+			PTF_ASSERT_FALSE(readerDev.isUsingIoUring());
+		}
+
+		pcpp::AsyncPcapFileWriterDevice pcapWriterDev(EXAMPLE_PCAP_WRITE_PATH, pcpp::LINKTYPE_ETHERNET, pcpp::CaptureFilePcap, config);
+		pcpp::AsyncPcapFileWriterDevice pcapNgWriterDev(EXAMPLE2_PCAPNG_WRITE_PATH, pcpp::LINKTYPE_ETHERNET, pcpp::CaptureFilePcapNg, config);
+		PTF_ASSERT_TRUE(pcapWriterDev.open());
+		PTF_ASSERT_TRUE(pcapNgWriterDev.open());
+		PTF_ASSERT_EQUAL(pcapWriterDev.isUsingIoUring(), readerDev.isUsingIoUring(), int);
+
+		pcpp::RawPacketVector packets;
+		pcpp::RawPacket rawPacket;
+		int tcpCount = 0;
+		while (readerDev.getNextPacket(rawPacket))
+		{
+			pcpp::Packet packet(&rawPacket);
+			if (packet.isPacketOfType(pcpp::TCP))
+				tcpCount++;
+			PTF_ASSERT_TRUE(pcapWriterDev.writePacket(rawPacket));
+			packets.pushBack(new pcpp::RawPacket(rawPacket));
+		}
+		PTF_ASSERT_TRUE(pcapNgWriterDev.writePackets(packets));
+
+		PTF_ASSERT_EQUAL((int)packets.size(), 4631, int);
+		PTF_ASSERT_EQUAL(tcpCount, 4492, int);
+		pcpp::IPcapDevice::PcapStats stats;
+		readerDev.getStatistics(stats);
+		PTF_ASSERT_EQUAL((uint32_t)stats.packetsRecv, 4631, u32);
+		pcapNgWriterDev.getStatistics(stats);
+		PTF_ASSERT_EQUAL((uint32_t)stats.packetsRecv, 4631, u32);
+		PTF_ASSERT_EQUAL((uint32_t)stats.packetsDrop, 0, u32);
+
+		pcpp::LoggerPP::getInstance().supressErrors();
+		pcpp::RawPacket sllPacket(packets.front()->getRawData(), packets.front()->getRawDataLen(), packets.front()->getPacketTimeStamp(), false, pcpp::LINKTYPE_LINUX_SLL);
+		PTF_ASSERT_FALSE(pcapWriterDev.writePacket(sllPacket));
+		pcpp::LoggerPP::getInstance().enableErrors();
+
+		readerDev.close();
+		PTF_ASSERT_TRUE(pcapWriterDev.flush());
+		pcapWriterDev.close();
+		pcapNgWriterDev.close();
+
+		// read both written files and compare them to the original packets
+		const char* writtenFiles[] = { EXAMPLE_PCAP_WRITE_PATH, EXAMPLE2_PCAPNG_WRITE_PATH };
+		for (int fileIndex = 0; fileIndex < 2; fileIndex++)
+		{
+			pcpp::AsyncPcapFileReaderDevice writtenFileReader(writtenFiles[fileIndex], config);
+			PTF_ASSERT_TRUE(writtenFileReader.open());
+			PTF_ASSERT_EQUAL(writtenFileReader.getFileFormat(), (fileIndex == 0 ? pcpp::CaptureFilePcap : pcpp::CaptureFilePcapNg), enum);
+			int packetCount = 0;
+			while (writtenFileReader.getNextPacket(rawPacket))
+			{
+				pcpp::RawPacket* origPacket = packets.at(packetCount++);
+				PTF_ASSERT_EQUAL(rawPacket.getRawDataLen(), origPacket->getRawDataLen(), int);
+				PTF_ASSERT_BUF_COMPARE(rawPacket.getRawData(), origPacket->getRawData(), rawPacket.getRawDataLen());
+				PTF_ASSERT_EQUAL(rawPacket.getPacketTimeStamp().tv_sec, origPacket->getPacketTimeStamp().tv_sec, u64);
+				PTF_ASSERT_EQUAL(rawPacket.getPacketTimeStamp().tv_nsec, origPacket->getPacketTimeStamp().tv_nsec, u64);
+				if (packetCount == (int)packets.size())
+				{
+					break;
+				}
+			}
+			PTF_ASSERT_EQUAL(packetCount, 4631, int);
+			PTF_ASSERT_FALSE(writtenFileReader.getNextPacket(rawPacket));
+		}
+
+		// append to both files
+		pcpp::AsyncPcapFileWriterDevice pcapAppendDev(EXAMPLE_PCAP_WRITE_PATH, pcpp::LINKTYPE_ETHERNET, pcpp::CaptureFilePcap, config);
+		pcpp::AsyncPcapFileWriterDevice pcapNgAppendDev(EXAMPLE2_PCAPNG_WRITE_PATH, pcpp::LINKTYPE_ETHERNET, pcpp::CaptureFilePcapNg, config);
+		PTF_ASSERT_TRUE(pcapAppendDev.open(true));
+		PTF_ASSERT_TRUE(pcapNgAppendDev.open(true));
+		for (int i = 0; i < 10; i++)
+		{
+			PTF_ASSERT_TRUE(pcapAppendDev.writePacket(*packets.at(i)));
+			PTF_ASSERT_TRUE(pcapNgAppendDev.writePacket(*packets.at(i)));
+		}
+		pcapAppendDev.close();
+		pcapNgAppendDev.close();
+
+		for (int fileIndex = 0; fileIndex < 2; fileIndex++)
+		{
+			pcpp::AsyncPcapFileReaderDevice appendedFileReader(writtenFiles[fileIndex], config);
+			PTF_ASSERT_TRUE(appendedFileReader.open());
+			int packetCount = 0;
+			while (appendedFileReader.getNextPacket(rawPacket))
+				packetCount++;
+			PTF_ASSERT_EQUAL(packetCount, 4641, int);
+		}
+
+		pcpp::LoggerPP::getInstance().supressErrors();
+		pcpp::AsyncPcapFileWriterDevice wrongLinkTypeDev(EXAMPLE_PCAP_WRITE_PATH, pcpp::LINKTYPE_LINUX_SLL, pcpp::CaptureFilePcap, config);
+		PTF_ASSERT_FALSE(wrongLinkTypeDev.open(true));
+		pcpp::AsyncPcapFileWriterDevice wrongFormatDev(EXAMPLE_PCAP_WRITE_PATH, pcpp::LINKTYPE_ETHERNET, pcpp::CaptureFilePcapNg, config);
+		PTF_ASSERT_FALSE(wrongFormatDev.open(true));
+		pcpp::AsyncPcapFileReaderDevice nonExistingReader("PcapExamples/no_such_file.pcap", config);
+		PTF_ASSERT_FALSE(nonExistingReader.open());
+		pcpp::LoggerPP::getInstance().enableErrors();
+	}
+
+	// a pcap-ng file with several interfaces and link layer types
+	pcpp::AsyncPcapFileReaderDevice pcapNgReaderDev(EXAMPLE_PCAPNG_PATH, config);
+	PTF_ASSERT_TRUE(pcapNgReaderDev.open());
+	PTF_ASSERT_EQUAL(pcapNgReaderDev.getFileFormat(), pcpp::CaptureFilePcapNg, enum);
+	pcpp::RawPacket rawPacket;
+	int packetCount = 0;
+	int ethLinkLayerCount = 0;
+	int nullLinkLayerCount = 0;
+	while (pcapNgReaderDev.getNextPacket(rawPacket))
+	{
+		packetCount++;
+		if (rawPacket.getLinkLayerType() == pcpp::LINKTYPE_ETHERNET)
+			ethLinkLayerCount++;
+		else if (rawPacket.getLinkLayerType() == pcpp::LINKTYPE_NULL)
+			nullLinkLayerCount++;
+	}
+	PTF_ASSERT_EQUAL(packetCount, 64, int);
+	PTF_ASSERT_EQUAL(ethLinkLayerCount, 62, int);
+	PTF_ASSERT_EQUAL(nullLinkLayerCount, 2, int);
+
+} // TestAsyncPcapFileReadWrite
+
+
+
+PTF_TEST_CASE(TestRotatingPcapFileWriter)
+{
+	pcpp::AsyncPcapFileReaderDevice readerDev(EXAMPLE_PCAP_PATH);
+	PTF_ASSERT_TRUE(readerDev.open());
+	pcpp::RawPacketVector packets;
+	pcpp::RawPacket rawPacket;
+	while (readerDev.getNextPacket(rawPacket))
+		packets.pushBack(new pcpp::RawPacket(rawPacket));
+	readerDev.close();
+	PTF_ASSERT_EQUAL((int)packets.size(), 4631, int);
+
+	// rotate by number of packets and keep only the last 3 files
+	pcpp::RotatingFileWriterConfiguration config;
+	config.maxPacketsPerFile = 1000;
+	config.maxFiles = 3;
+	pcpp::RotatingPcapFileWriterDevice packetCountWriter("PcapExamples/rotating_by_count.pcapng", config, pcpp::LINKTYPE_ETHERNET, pcpp::CaptureFilePcapNg);
+	PTF_ASSERT_TRUE(packetCountWriter.open());
+	PTF_ASSERT_EQUAL(packetCountWriter.getCurrentFileNumber(), 1, u32);
+	PTF_ASSERT_EQUAL(packetCountWriter.getCurrentFileName(), "PcapExamples/rotating_by_count_00001.tmp", string);
+	PTF_ASSERT_TRUE(packetCountWriter.writePackets(packets));
+	PTF_ASSERT_EQUAL(packetCountWriter.getCurrentFileNumber(), 5, u32);
+	PTF_ASSERT_EQUAL(packetCountWriter.getCurrentFileName().find("PcapExamples/rotating_by_count_00005_"), 0, size);
+	PTF_ASSERT_EQUAL(packetCountWriter.getCurrentFileName().substr(packetCountWriter.getCurrentFileName().size() - 7), ".pcapng", string);
+
+	pcpp::LoggerPP::getInstance().supressErrors();
+	pcpp::RawPacket sllPacket(packets.front()->getRawData(), packets.front()->getRawDataLen(), packets.front()->getPacketTimeStamp(), false, pcpp::LINKTYPE_LINUX_SLL);
+	PTF_ASSERT_FALSE(packetCountWriter.writePacket(sllPacket));
+	PTF_ASSERT_FALSE(packetCountWriter.open(true));
+	pcpp::LoggerPP::getInstance().enableErrors();
+
+	pcpp::IPcapDevice::PcapStats stats;
+	packetCountWriter.getStatistics(stats);
+	PTF_ASSERT_EQUAL((uint32_t)stats.packetsRecv, 4631, u32);
+	PTF_ASSERT_EQUAL((uint32_t)stats.packetsDrop, 1, u32);
+	packetCountWriter.close();
+
+	std::vector<std::string> fileNames = packetCountWriter.getFileNames();
+	PTF_ASSERT_EQUAL(fileNames.size(), 3, size);
+	int expectedPacketCounts[] = { 1000, 1000, 631 };
+	for (size_t i = 0; i < fileNames.size(); i++)
+	{
+		pcpp::AsyncPcapFileReaderDevice fileReader(fileNames[i].c_str());
+		PTF_ASSERT_TRUE(fileReader.open());
+		PTF_ASSERT_EQUAL(fileReader.getFileFormat(), pcpp::CaptureFilePcapNg, enum);
+		int packetCount = 0;
+		while (fileReader.getNextPacket(rawPacket))
+			packetCount++;
+		PTF_ASSERT_EQUAL(packetCount, expectedPacketCounts[i], int);
+		fileReader.close();
+	}
+
+	// the 2 oldest files and the file prepared for the next rotation were deleted
+	PTF_ASSERT_EQUAL(fileNames[0].find("PcapExamples/rotating_by_count_00003_"), 0, size);
+	FILE* deletedFile = fopen("PcapExamples/rotating_by_count_00006.tmp", "r");
+	PTF_ASSERT_NULL(deletedFile);
+	for (size_t i = 0; i < fileNames.size(); i++)
+	{
+		PTF_ASSERT_EQUAL(remove(fileNames[i].c_str()), 0, int);
+	}
+
+	// rotate by size with preallocation
+	config = pcpp::RotatingFileWriterConfiguration();
+	config.maxFileSize = 1000000;
+	pcpp::RotatingPcapFileWriterDevice sizeWriter("PcapExamples/rotating_by_size.pcap", config);
+	PTF_ASSERT_TRUE(sizeWriter.open());
+	PTF_ASSERT_TRUE(sizeWriter.writePackets(packets));
+	sizeWriter.close();
+	fileNames = sizeWriter.getFileNames();
+	PTF_ASSERT_EQUAL(fileNames.size(), 4, size);
+	int totalPacketCount = 0;
+	for (size_t i = 0; i < fileNames.size(); i++)
+	{
+		pcpp::AsyncPcapFileReaderDevice fileReader(fileNames[i].c_str());
+		PTF_ASSERT_TRUE(fileReader.open());
+		PTF_ASSERT_EQUAL(fileReader.getFileFormat(), pcpp::CaptureFilePcap, enum);
+		while (fileReader.getNextPacket(rawPacket))
+			totalPacketCount++;
+		fileReader.close();
+
+		FILE* file = fopen(fileNames[i].c_str(), "r");
+		PTF_ASSERT_NOT_NULL(file);
+		fseek(file, 0, SEEK_END);
+		long fileSize = ftell(file);
+		fclose(file);
+		PTF_ASSERT_LOWER_OR_EQUAL_THAN(fileSize, 1000000, int);
+		if (i < fileNames.size() - 1)
+		{
+			PTF_ASSERT_GREATER_THAN(fileSize, 900000, int);
+		}
+		PTF_ASSERT_EQUAL(remove(fileNames[i].c_str()), 0, int);
+	}
+	PTF_ASSERT_EQUAL(totalPacketCount, 4631, int);
+
+	// a file that got no packets is deleted
+	pcpp::RotatingPcapFileWriterDevice emptyWriter("PcapExamples/rotating_empty", config);
+	PTF_ASSERT_TRUE(emptyWriter.open());
+	PTF_ASSERT_EQUAL(emptyWriter.getCurrentFileName(), "PcapExamples/rotating_empty_00001.tmp", string);
+	emptyWriter.close();
+	PTF_ASSERT_EQUAL(emptyWriter.getFileNames().size(), 0, size);
+	deletedFile = fopen("PcapExamples/rotating_empty_00001.tmp", "r");
+	PTF_ASSERT_NULL(deletedFile);
+	deletedFile = fopen("PcapExamples/rotating_empty_00002.tmp", "r");
+	PTF_ASSERT_NULL(deletedFile);
+
+} // TestRotatingPcapFileWriter
@@ -0,0 +1,146 @@
+#include "../TestDefinition.h"
+#include "../Common/TestUtils.h"
+#include "../Common/PcapFileNamesDef.h"
+#include "Logger.h"
+#include "PacketFlightRecorder.h"
+#include "PcapFileDevice.h"
+#include "Packet.h"
+#include <stdio.h>
+
+
+#define FLIGHT_RECORDER_DUMP_PATH "PcapExamples/flight_recorder_dump.pcap"
+#define FLIGHT_RECORDER_DUMP_PCAPNG_PATH "PcapExamples/flight_recorder_dump.pcapng"
+
+struct FlightRecorderDumpResult
+{
+	int numOfCalls;
+	uint64_t numOfPackets;
+	bool success;
+
+	FlightRecorderDumpResult() : numOfCalls(0), numOfPackets(0), success(false) {}
+};
+
+static void flightRecorderOnDumpFinished(const std::string& fileName, uint64_t numOfPackets, bool success, void* userCookie)
+{
+	FlightRecorderDumpResult* result = (FlightRecorderDumpResult*)userCookie;
+	result->numOfCalls++;
+	result->numOfPackets = numOfPackets;
+	result->success = success;
+}
+
+static int timespecCompare(const timespec& a, const timespec& b)
+{
+	if (a.tv_sec != b.tv_sec)
+		return a.tv_sec < b.tv_sec ? -1 : 1;
+	if (a.tv_nsec != b.tv_nsec)
+		return a.tv_nsec < b.tv_nsec ? -1 : 1;
+	return 0;
+}
+
+
+
+PTF_TEST_CASE(TestFlightRecorderDump)
+{
+	std::vector<pcpp::RawPacket> packetStream;
+	std::string errMsg;
+	PTF_ASSERT_TRUE(readPcapIntoPacketVec(EXAMPLE_PCAP_PATH, packetStream, errMsg));
+	PTF_ASSERT_EQUAL(packetStream.size(), 4631, size);
+
+	pcpp::LoggerPP::getInstance().supressErrors();
+	pcpp::PacketFlightRecorder::Config invalidConfig;
+	invalidConfig.memorySize = 1024;
+	pcpp::PacketFlightRecorder invalidRecorder(invalidConfig);
+	PTF_ASSERT_FALSE(invalidRecorder.isValid());
+	PTF_ASSERT_FALSE(invalidRecorder.addPacket(packetStream[0]));
+	pcpp::LoggerPP::getInstance().enableErrors();
+
+	// 3 lanes of 4 slabs each. The packets are added to 2 lanes which are much smaller than the file so the oldest packets are overwritten
+	pcpp::PacketFlightRecorder::Config config;
+	config.memorySize = 3 * 1024 * 1024;
+	config.slabSize = 256 * 1024;
+	config.numOfLanes = 3;
+	pcpp::PacketFlightRecorder recorder(config);
+	PTF_ASSERT_TRUE(recorder.isValid());
+
+	timespec oldest, newest;
+	PTF_ASSERT_FALSE(recorder.getTimeRange(oldest, newest));
+
+	for (size_t i = 0; i < packetStream.size(); i++)
+	{
+		PTF_ASSERT_TRUE(recorder.addPacket(packetStream[i], (uint16_t)(i % 2)));
+	}
+	PTF_ASSERT_FALSE(recorder.addPacket(packetStream[0], 3));
+
+	pcpp::PacketFlightRecorder::Stats stats;
+	recorder.getStatistics(stats);
+	PTF_ASSERT_EQUAL(stats.packetsAdded, 4631, u64);
+	PTF_ASSERT_GREATER_THAN(stats.packetsOverwritten, 0, u64);
+	PTF_ASSERT_LOWER_OR_EQUAL_THAN(stats.bytesStored, config.memorySize, u64);
+	PTF_ASSERT_EQUAL(stats.packetsNotAdded, 0, u64);
+
+	PTF_ASSERT_TRUE(recorder.getTimeRange(oldest, newest));
+	PTF_ASSERT_EQUAL(timespecCompare(newest, packetStream.back().getPacketTimeStamp()), 0, int);
+	uint64_t numOfStoredPackets = stats.packetsAdded - stats.packetsOverwritten;
+
+	FlightRecorderDumpResult allPacketsResult, tcpPacketsResult;
+	PTF_ASSERT_TRUE(recorder.dumpRange(oldest, newest, FLIGHT_RECORDER_DUMP_PATH, "", pcpp::CaptureFilePcap, flightRecorderOnDumpFinished, &allPacketsResult));
+	PTF_ASSERT_TRUE(recorder.dumpRange(oldest, newest, FLIGHT_RECORDER_DUMP_PCAPNG_PATH, "tcp", pcpp::CaptureFilePcapNg, flightRecorderOnDumpFinished, &tcpPacketsResult));
+
+	// packets can be added while dumping. These packets are older than the dumped range so they aren't dumped
+	for (size_t i = 0; i < 100; i++)
+	{
+		PTF_ASSERT_TRUE(recorder.addPacket(packetStream[i], 2));
+	}
+
+	recorder.waitForDumps();
+	PTF_ASSERT_EQUAL(recorder.getNumOfPendingDumps(), 0, u32);
+	PTF_ASSERT_EQUAL(allPacketsResult.numOfCalls, 1, int);
+	PTF_ASSERT_TRUE(allPacketsResult.success);
+	PTF_ASSERT_EQUAL(tcpPacketsResult.numOfCalls, 1, int);
+	PTF_ASSERT_TRUE(tcpPacketsResult.success);
+	PTF_ASSERT_GREATER_THAN(tcpPacketsResult.numOfPackets, 0, u64);
+	PTF_ASSERT_LOWER_THAN(tcpPacketsResult.numOfPackets, allPacketsResult.numOfPackets, u64);
+
+	pcpp::PcapFileReaderDevice readerDev(FLIGHT_RECORDER_DUMP_PATH);
+	PTF_ASSERT_TRUE(readerDev.open());
+	pcpp::RawPacket rawPacket;
+	uint64_t numOfPacketsRead = 0;
+	timespec prevTimestamp = oldest;
+	while (readerDev.getNextPacket(rawPacket))
+	{
+		PTF_ASSERT_GREATER_OR_EQUAL_THAN(timespecCompare(rawPacket.getPacketTimeStamp(), prevTimestamp), 0, int);
+		prevTimestamp = rawPacket.getPacketTimeStamp();
+		numOfPacketsRead++;
+	}
+	readerDev.close();
+	PTF_ASSERT_EQUAL(numOfPacketsRead, allPacketsResult.numOfPackets, u64);
+	PTF_ASSERT_EQUAL(numOfPacketsRead, numOfStoredPackets, u64);
+
+	// dump a window in the middle
+	timespec windowStart = packetStream[4000].getPacketTimeStamp();
+	timespec windowEnd = packetStream[4099].getPacketTimeStamp();
+	FlightRecorderDumpResult windowResult;
+	PTF_ASSERT_TRUE(recorder.dumpRange(windowStart, windowEnd, FLIGHT_RECORDER_DUMP_PATH, "", pcpp::CaptureFilePcap, flightRecorderOnDumpFinished, &windowResult));
+	recorder.waitForDumps();
+	PTF_ASSERT_TRUE(windowResult.success);
+	uint64_t expectedWindowPackets = 0;
+	for (size_t i = 0; i < packetStream.size(); i++)
+	{
+		if (timespecCompare(packetStream[i].getPacketTimeStamp(), windowStart) >= 0 && timespecCompare(packetStream[i].getPacketTimeStamp(), windowEnd) <= 0)
+			expectedWindowPackets++;
+	}
+	PTF_ASSERT_EQUAL(windowResult.numOfPackets, expectedWindowPackets, u64);
+
+	// invalid time range and invalid filter
+	pcpp::LoggerPP::getInstance().supressErrors();
+	PTF_ASSERT_FALSE(recorder.dumpRange(windowEnd, windowStart, FLIGHT_RECORDER_DUMP_PATH));
+	FlightRecorderDumpResult invalidFilterResult;
+	PTF_ASSERT_TRUE(recorder.dumpRange(windowStart, windowEnd, FLIGHT_RECORDER_DUMP_PATH, "invalid filter###", pcpp::CaptureFilePcap, flightRecorderOnDumpFinished, &invalidFilterResult));
+	recorder.waitForDumps();
+	pcpp::LoggerPP::getInstance().enableErrors();
+	PTF_ASSERT_EQUAL(invalidFilterResult.numOfCalls, 1, int);
+	PTF_ASSERT_FALSE(invalidFilterResult.success);
+
+	remove(FLIGHT_RECORDER_DUMP_PATH);
+	remove(FLIGHT_RECORDER_DUMP_PCAPNG_PATH);
+} // TestFlightRecorderDump
@@ -1,6 +1,8 @@
 #include "../TestDefinition.h"
 #include "../Common/TestUtils.h"
 #include "IPReassembly.h"
+#include "IPFragmentation.h"
+#include "IPv4Layer.h"
 #include "IPv6Layer.h"
 #include "HttpLayer.h"
 #include "PcapFileDevice.h"
@@ -168,6 +170,101 @@ PTF_TEST_CASE(TestIPFragmentationSanity)
 
 
 
+PTF_TEST_CASE(TestIPFragmentationBatch)
+{
+	std::vector<pcpp::RawPacket> firstFrags;
+	std::vector<pcpp::RawPacket> nonIPPackets;
+	std::string errMsg;
+
+	PTF_ASSERT_TRUE(readPcapIntoPacketVec("PcapExamples/frag_http_req.pcap", firstFrags, errMsg));
+	PTF_ASSERT_EQUAL(firstFrags.size(), 11, size);
+	PTF_ASSERT_TRUE(readPcapIntoPacketVec("PcapExamples/VlanPackets.pcap", nonIPPackets, errMsg));
+
+	// reassemble the first packet so a second one with a different IP ID can be fragmented out of it
+	pcpp::IPReassembly ipReassembly;
+	pcpp::IPReassembly::ReassemblyStatus status;
+	pcpp::Packet* firstPacket = NULL;
+	for (size_t i = 0; i < firstFrags.size(); i++)
+	{
+		pcpp::Packet fragPacket(&firstFrags.at(i));
+		firstPacket = ipReassembly.processPacket(&fragPacket, status);
+	}
+	PTF_ASSERT_NOT_NULL(firstPacket);
+
+	pcpp::RawPacket secondRawPacket(*firstPacket->getRawPacket());
+	pcpp::Packet secondPacket(&secondRawPacket);
+	pcpp::IPv4Layer* secondIPLayer = secondPacket.getLayerOfType<pcpp::IPv4Layer>();
+	secondIPLayer->getIPv4Header()->ipId = htobe16(0x1234);
+	secondIPLayer->computeCalculateFields();
+
+	pcpp::IPFragmentation ipFrag;
+	ipFrag.setMaxFragmentPayloadSize(400);
+	pcpp::PointerVector<pcpp::RawPacket> secondFrags;
+	PTF_ASSERT_EQUAL(ipFrag.fragmentPacket(&secondPacket, secondFrags), 4, int);
+
+	// interleave the fragments of both packets with a non-IP packet and an out-of-order fragment
+	const int burstSize = 16;
+	pcpp::RawPacket* burst[burstSize] = { &firstFrags.at(0), secondFrags.at(0), &nonIPPackets.at(20),
+		&firstFrags.at(1), &firstFrags.at(2), &firstFrags.at(3), &firstFrags.at(4), secondFrags.at(2), secondFrags.at(1),
+		&firstFrags.at(5), &firstFrags.at(6), &firstFrags.at(7), &firstFrags.at(8), &firstFrags.at(9), &firstFrags.at(10), secondFrags.at(3) };
+
+	pcpp::Packet* packets[burstSize];
+	for (int i = 0; i < burstSize; i++)
+		packets[i] = new pcpp::Packet(burst[i]);
+
+	pcpp::IPReassembly batchReassembly;
+	pcpp::Packet* results[burstSize];
+	pcpp::IPReassembly::ReassemblyStatus statuses[burstSize];
+	batchReassembly.processPackets(packets, burstSize, results, statuses);
+
+	PTF_ASSERT_EQUAL(statuses[0], pcpp::IPReassembly::FIRST_FRAGMENT, enum);
+	PTF_ASSERT_EQUAL(statuses[1], pcpp::IPReassembly::FIRST_FRAGMENT, enum);
+	PTF_ASSERT_EQUAL(statuses[2], pcpp::IPReassembly::NON_IP_PACKET, enum);
+	PTF_ASSERT_TRUE(results[2] == packets[2]);
+	PTF_ASSERT_EQUAL(statuses[7], pcpp::IPReassembly::OUT_OF_ORDER_FRAGMENT, enum);
+	PTF_ASSERT_EQUAL(statuses[8], pcpp::IPReassembly::FRAGMENT, enum);
+	PTF_ASSERT_EQUAL(statuses[14], pcpp::IPReassembly::REASSEMBLED, enum);
+	PTF_ASSERT_EQUAL(statuses[15], pcpp::IPReassembly::REASSEMBLED, enum);
+	for (int i = 3; i < 14; i++)
+	{
+		if (i == 7)
+			continue;
+		PTF_ASSERT_EQUAL(statuses[i], pcpp::IPReassembly::FRAGMENT, enum);
+		PTF_ASSERT_NULL(results[i]);
+	}
+	PTF_ASSERT_NULL(results[0]);
+	PTF_ASSERT_NULL(results[1]);
+	PTF_ASSERT_NULL(results[7]);
+	PTF_ASSERT_EQUAL(batchReassembly.getCurrentCapacity(), 0, size);
+
+	// each packet is reassembled into its original form
+	PTF_ASSERT_NOT_NULL(results[14]);
+	PTF_ASSERT_EQUAL(results[14]->getRawPacket()->getRawDataLen(), firstPacket->getRawPacket()->getRawDataLen(), int);
+	PTF_ASSERT_BUF_COMPARE(results[14]->getRawPacket()->getRawData(), firstPacket->getRawPacket()->getRawData(), firstPacket->getRawPacket()->getRawDataLen());
+	PTF_ASSERT_NOT_NULL(results[15]);
+	PTF_ASSERT_EQUAL(results[15]->getRawPacket()->getRawDataLen(), secondRawPacket.getRawDataLen(), int);
+	PTF_ASSERT_BUF_COMPARE(results[15]->getRawPacket()->getRawData(), secondRawPacket.getRawData(), secondRawPacket.getRawDataLen());
+
+	// the statuses are the same as when processing the fragments one by one
+	pcpp::IPReassembly sequentialReassembly;
+	for (int i = 0; i < burstSize; i++)
+	{
+		pcpp::Packet* result = sequentialReassembly.processPacket(packets[i], status);
+		PTF_ASSERT_EQUAL(status, statuses[i], enum);
+		if (result != NULL && result != packets[i])
+			delete result;
+	}
+
+	delete results[14];
+	delete results[15];
+	for (int i = 0; i < burstSize; i++)
+		delete packets[i];
+	delete firstPacket;
+} // TestIPFragmentationBatch
+
+
+
+
 PTF_TEST_CASE(TestIPFragOutOfOrder)
 {
 	std::vector<pcpp::RawPacket> packetStream;
@@ -262,6 +262,13 @@ PTF_TEST_CASE(TestPcapLiveDeviceNoNetworking)
 	PTF_ASSERT_GREATER_THAN(liveDev->getMtu(), 0, u32);
 	PTF_ASSERT_NOT_EQUAL(liveDev->getMacAddress(), pcpp::MacAddress::Zero, object);
 
+	// the loopback flag reported by libpcap is kept, so the device of the loopback address is a loopback device
+	pcpp::PcapLiveDevice* loopbackDev = pcpp::PcapLiveDeviceList::getInstance().getPcapLiveDeviceByIp("127.0.0.1");
+	if (loopbackDev != NULL)
+	{
+		PTF_ASSERT_TRUE(loopbackDev->getLoopback());
+	}
+
 	// a negative test - check invalid IP address
 	liveDev = NULL;
 	pcpp::LoggerPP::getInstance().supressErrors();
@@ -0,0 +1,397 @@
+#include "../TestDefinition.h"
+#include "Logger.h"
+#include "PacketLoadBalancer.h"
+#include "Packet.h"
+#include "EthLayer.h"
+#include "ArpLayer.h"
+#include "IPv4Layer.h"
+#include "TcpLayer.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <map>
+#include <vector>
+#if !defined(WIN32) && !defined(WINx64) && !defined(PCAPPP_MINGW_ENV)
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+
+#define LOAD_BALANCER_NUM_OF_WORKERS 4
+#define LOAD_BALANCER_NUM_OF_FLOWS 32
+#define LOAD_BALANCER_PACKETS_PER_FLOW 10
+
+struct LoadBalancerResult
+{
+	// the flow hash of every received packet and the worker that received it
+	std::map<uint32_t, uint16_t> flowToWorker;
+	int numOfPackets;
+	bool isFlowOnOneWorker;
+
+	LoadBalancerResult() : numOfPackets(0), isFlowOnOneWorker(true) {}
+};
+
+struct LoadBalancerWorkerThread
+{
+	pcpp::PacketLoadBalancer* balancer;
+	uint16_t workerId;
+	pthread_mutex_t* mutex;
+	bool* stop;
+	LoadBalancerResult result;
+};
+
+static void loadBalancerOnPacketsReceived(pcpp::RawPacket* packets, uint32_t numOfPackets, uint16_t workerId, void* userCookie)
+{
+	LoadBalancerResult* result = (LoadBalancerResult*)userCookie;
+	for (uint32_t i = 0; i < numOfPackets; i++)
+	{
+		uint32_t hash = pcpp::PacketLoadBalancer::getFlowHash(packets[i]);
+		std::map<uint32_t, uint16_t>::iterator iter = result->flowToWorker.find(hash);
+		if (iter == result->flowToWorker.end())
+			result->flowToWorker[hash] = workerId;
+		else if (iter->second != workerId)
+			result->isFlowOnOneWorker = false;
+		result->numOfPackets++;
+	}
+}
+
+static void* loadBalancerWorkerMain(void* ptr)
+{
+	LoadBalancerWorkerThread* worker = (LoadBalancerWorkerThread*)ptr;
+	while (true)
+	{
+		// the stop flag is read before receiving, so the packets distributed before it was set are all received
+		pthread_mutex_lock(worker->mutex);
+		bool stop = *worker->stop;
+		pthread_mutex_unlock(worker->mutex);
+		if (worker->balancer->receivePackets(worker->workerId, loadBalancerOnPacketsReceived, &worker->result) == 0 && stop)
+			break;
+	}
+
+	return NULL;
+}
+
+// creates TCP flows with packets in both directions, interleaved between the flows
+static void loadBalancerCreatePackets(std::vector<pcpp::RawPacket>& packets)
+{
+	pcpp::MacAddress clientMac("00:11:22:33:44:55");
+	pcpp::MacAddress serverMac("66:77:88:99:aa:bb");
+	for (int i = 0; i < LOAD_BALANCER_PACKETS_PER_FLOW; i++)
+	{
+		for (int flow = 0; flow < LOAD_BALANCER_NUM_OF_FLOWS; flow++)
+		{
+			char clientIP[20], serverIP[20];
+			snprintf(clientIP, sizeof(clientIP), "10.0.0.%d", flow + 1);
+			snprintf(serverIP, sizeof(serverIP), "10.1.%d.1", flow % 4);
+			uint16_t clientPort = (uint16_t)(40000 + flow);
+			uint16_t serverPort = (uint16_t)(flow % 2 == 0 ? 80 : 443);
+			bool fromClient = (i % 2 == 0);
+
+			pcpp::EthLayer ethLayer(fromClient ? clientMac : serverMac, fromClient ? serverMac : clientMac);
+			pcpp::IPv4Layer ipLayer(pcpp::IPv4Address(fromClient ? clientIP : serverIP), pcpp::IPv4Address(fromClient ? serverIP : clientIP));
+			pcpp::TcpLayer tcpLayer(fromClient ? clientPort : serverPort, fromClient ? serverPort : clientPort);
+
+			pcpp::Packet packet(100);
+			packet.addLayer(&ethLayer);
+			packet.addLayer(&ipLayer);
+			packet.addLayer(&tcpLayer);
+			packet.computeCalculateFields();
+			packets.push_back(*packet.getRawPacket());
+		}
+	}
+}
+
+
+
+PTF_TEST_CASE(TestPacketLoadBalancer)
+{
+	std::vector<pcpp::RawPacket> packets;
+	loadBalancerCreatePackets(packets);
+
+	pcpp::LoggerPP::getInstance().supressErrors();
+	pcpp::PacketLoadBalancer::Config invalidConfig;
+	invalidConfig.numOfWorkers = 0;
+	pcpp::PacketLoadBalancer invalidBalancer(invalidConfig);
+	PTF_ASSERT_FALSE(invalidBalancer.isValid());
+	PTF_ASSERT_EQUAL(invalidBalancer.distributePacket(packets[0]), -1, int);
+	PTF_ASSERT_EQUAL(invalidBalancer.receivePackets(0, loadBalancerOnPacketsReceived), 0, u32);
+	pcpp::LoggerPP::getInstance().enableErrors();
+
+	pcpp::PacketLoadBalancer::Config config;
+	config.numOfWorkers = LOAD_BALANCER_NUM_OF_WORKERS;
+	config.ringSize = 300;
+	config.maxPacketLen = 64;
+	pcpp::PacketLoadBalancer balancer(config);
+	PTF_ASSERT_TRUE(balancer.isValid());
+	PTF_ASSERT_EQUAL(balancer.getConfig().ringSize, 512, u32);
+
+	// both directions of a flow have the same hash, so they go to the same worker
+	for (size_t i = 0; i < packets.size(); i++)
+	{
+		int workerId = balancer.distributePacket(packets[i]);
+		PTF_ASSERT_EQUAL(workerId, (int)balancer.getWorkerOfHash(pcpp::PacketLoadBalancer::getFlowHash(packets[i])), int);
+	}
+
+	pcpp::ArpLayer arpLayer(pcpp::ARP_REQUEST, pcpp::MacAddress("00:11:22:33:44:55"), pcpp::MacAddress::Zero, pcpp::IPv4Address("10.0.0.1"), pcpp::IPv4Address("10.0.0.2"));
+	pcpp::Packet arpPacket(100);
+	arpPacket.addLayer(&arpLayer);
+	PTF_ASSERT_EQUAL(pcpp::PacketLoadBalancer::getFlowHash(*arpPacket.getRawPacket()), 0, u32);
+	PTF_ASSERT_EQUAL(balancer.distributePacket(*arpPacket.getRawPacket()), (int)balancer.getWorkerOfHash(0), int);
+
+	LoadBalancerResult result;
+	int numOfWorkersWithPackets = 0;
+	for (uint16_t workerId = 0; workerId < LOAD_BALANCER_NUM_OF_WORKERS; workerId++)
+	{
+		pcpp::PacketLoadBalancer::WorkerStats workerStats;
+		PTF_ASSERT_TRUE(balancer.getWorkerStatistics(workerId, workerStats));
+		PTF_ASSERT_EQUAL(workerStats.packetsQueued, workerStats.packetsDistributed, u64);
+		PTF_ASSERT_EQUAL(workerStats.numOfBuckets, config.numOfBuckets / LOAD_BALANCER_NUM_OF_WORKERS, u32);
+
+		uint32_t numOfPackets = balancer.receivePackets(workerId, loadBalancerOnPacketsReceived, &result, 100000);
+		PTF_ASSERT_EQUAL(numOfPackets, workerStats.packetsDistributed, u64);
+		if (numOfPackets > 0)
+			numOfWorkersWithPackets++;
+
+		PTF_ASSERT_TRUE(balancer.getWorkerStatistics(workerId, workerStats));
+		PTF_ASSERT_EQUAL(workerStats.packetsQueued, 0, u32);
+	}
+
+	PTF_ASSERT_TRUE(result.isFlowOnOneWorker);
+	PTF_ASSERT_EQUAL(result.numOfPackets, (int)packets.size() + 1, int);
+	PTF_ASSERT_EQUAL(result.flowToWorker.size(), LOAD_BALANCER_NUM_OF_FLOWS + 1, size);
+	PTF_ASSERT_GREATER_THAN(numOfWorkersWithPackets, 1, int);
+	pcpp::PacketLoadBalancer::WorkerStats invalidWorkerStats;
+	PTF_ASSERT_FALSE(balancer.getWorkerStatistics(LOAD_BALANCER_NUM_OF_WORKERS, invalidWorkerStats));
+
+	pcpp::PacketLoadBalancer::Stats stats;
+	balancer.getStatistics(stats);
+	PTF_ASSERT_EQUAL(stats.packetsDistributed, packets.size() + 1, u64);
+	PTF_ASSERT_EQUAL(stats.packetsDropped, 0, u64);
+	PTF_ASSERT_EQUAL(stats.packetsWithoutFlow, 1, u64);
+	PTF_ASSERT_TRUE(stats.imbalance >= 1.0 && stats.imbalance <= LOAD_BALANCER_NUM_OF_WORKERS);
+
+	// the packets are copied to the ring, truncated to the max packet length
+	pcpp::PacketLoadBalancer::Config smallConfig;
+	smallConfig.numOfWorkers = 1;
+	smallConfig.ringSize = 2;
+	smallConfig.maxPacketLen = 32;
+	pcpp::PacketLoadBalancer smallBalancer(smallConfig);
+	PTF_ASSERT_EQUAL(smallBalancer.distributePacket(packets[0]), 0, int);
+	PTF_ASSERT_EQUAL(smallBalancer.distributePacket(packets[1]), 0, int);
+	PTF_ASSERT_EQUAL(smallBalancer.distributePacket(packets[2]), -1, int);
+	pcpp::PacketLoadBalancer::WorkerStats workerStats;
+	PTF_ASSERT_TRUE(smallBalancer.getWorkerStatistics(0, workerStats));
+	PTF_ASSERT_EQUAL(workerStats.packetsDistributed, 2, u64);
+	PTF_ASSERT_EQUAL(workerStats.bytesDistributed, 64, u64);
+	PTF_ASSERT_EQUAL(workerStats.packetsDropped, 1, u64);
+} // TestPacketLoadBalancer
+
+
+
+PTF_TEST_CASE(TestPacketLoadBalancerRebalance)
+{
+	std::vector<pcpp::RawPacket> packets;
+	loadBalancerCreatePackets(packets);
+
+	// buckets are assigned to workers round robin, so all buckets with an even hash are on worker 0
+	pcpp::PacketLoadBalancer::Config config;
+	config.numOfWorkers = 2;
+	config.numOfBuckets = 8;
+	config.ringSize = 1024;
+	pcpp::PacketLoadBalancer balancer(config);
+	PTF_ASSERT_TRUE(balancer.isValid());
+
+	for (int i = 0; i < 100; i++)
+	{
+		balancer.distributePacket(packets[0], 0);
+		balancer.distributePacket(packets[0], 2);
+		balancer.distributePacket(packets[0], 4);
+	}
+	for (int i = 0; i < 10; i++)
+		balancer.distributePacket(packets[0], 1);
+
+	pcpp::PacketLoadBalancer::Stats stats;
+	balancer.getStatistics(stats);
+	PTF_ASSERT_EQUAL(stats.packetsDistributed, 310, u64);
+	PTF_ASSERT_EQUAL(stats.busiestBucket, 0, u32);
+	PTF_ASSERT_TRUE(stats.imbalance > 1.9 && stats.imbalance < 2.0);
+	PTF_ASSERT_TRUE(stats.busiestBucketShare > 0.3 && stats.busiestBucketShare < 0.35);
+
+	// moving one of the busy buckets to worker 1 leaves 200 packets on worker 0 and 110 on worker 1. Moving another one wouldn't help.
+	// The packets of the moved bucket are still in the ring of worker 0, so the bucket stays there until worker 0 receives them
+	PTF_ASSERT_EQUAL(balancer.rebalance(), 1, u32);
+	PTF_ASSERT_EQUAL(balancer.getWorkerOfHash(0), 0, u16);
+	PTF_ASSERT_EQUAL(balancer.getWorkerOfHash(2), 0, u16);
+	PTF_ASSERT_EQUAL(balancer.getWorkerOfHash(4), 0, u16);
+	PTF_ASSERT_EQUAL(balancer.getWorkerOfHash(1), 1, u16);
+
+	balancer.getStatistics(stats);
+	PTF_ASSERT_EQUAL(stats.numOfRebalances, 1, u64);
+	PTF_ASSERT_EQUAL(stats.numOfBucketsMoved, 1, u64);
+	PTF_ASSERT_TRUE(stats.imbalance == 0);
+
+	pcpp::PacketLoadBalancer::WorkerStats workerStats;
+	PTF_ASSERT_TRUE(balancer.getWorkerStatistics(1, workerStats));
+	PTF_ASSERT_EQUAL(workerStats.numOfBuckets, 5, u32);
+
+	// a single dominant flow can't be balanced: its bucket is more than the fair share of a worker
+	for (int i = 0; i < 500; i++)
+		balancer.distributePacket(packets[0], 3);
+	for (int i = 0; i < 10; i++)
+		balancer.distributePacket(packets[0], 2);
+
+	balancer.getStatistics(stats);
+	PTF_ASSERT_EQUAL(stats.busiestBucket, 3, u32);
+	PTF_ASSERT_TRUE(stats.busiestBucketShare > 1.0 / config.numOfWorkers);
+	PTF_ASSERT_TRUE(stats.imbalance > 1.9);
+	PTF_ASSERT_EQUAL(balancer.rebalance(), 0, u32);
+	PTF_ASSERT_EQUAL(balancer.getWorkerOfHash(3), 1, u16);
+
+	// the moved bucket switches to worker 1 only after worker 0 received all of its packets, including the ones distributed meanwhile
+	PTF_ASSERT_EQUAL(balancer.distributePacket(packets[0], 0), 0, int);
+	LoadBalancerResult result;
+	PTF_ASSERT_EQUAL(balancer.receivePackets(0, loadBalancerOnPacketsReceived, &result, 300), 300, u32);
+	PTF_ASSERT_EQUAL(balancer.distributePacket(packets[0], 0), 0, int);
+	while (balancer.receivePackets(0, loadBalancerOnPacketsReceived, &result) > 0) {}
+	PTF_ASSERT_EQUAL(result.numOfPackets, 312, int);
+	PTF_ASSERT_EQUAL(balancer.distributePacket(packets[0], 0), 1, int);
+	PTF_ASSERT_EQUAL(balancer.getWorkerOfHash(0), 1, u16);
+	PTF_ASSERT_TRUE(balancer.getWorkerStatistics(1, workerStats));
+	PTF_ASSERT_EQUAL(workerStats.numOfBuckets, 5, u32);
+} // TestPacketLoadBalancerRebalance
+
+
+
+PTF_TEST_CASE(TestPacketLoadBalancerThreads)
+{
+	std::vector<pcpp::RawPacket> packets;
+	for (int i = 0; i < 20; i++)
+		loadBalancerCreatePackets(packets);
+
+	// small rings so the distributing thread waits for the workers
+	pcpp::PacketLoadBalancer::Config config;
+	config.numOfWorkers = LOAD_BALANCER_NUM_OF_WORKERS;
+	config.ringSize = 64;
+	pcpp::PacketLoadBalancer balancer(config);
+	PTF_ASSERT_TRUE(balancer.isValid());
+
+	pthread_mutex_t mutex;
+	pthread_mutex_init(&mutex, NULL);
+	bool stop = false;
+	pthread_t threads[LOAD_BALANCER_NUM_OF_WORKERS];
+	LoadBalancerWorkerThread workers[LOAD_BALANCER_NUM_OF_WORKERS];
+	for (int i = 0; i < LOAD_BALANCER_NUM_OF_WORKERS; i++)
+	{
+		workers[i].balancer = &balancer;
+		workers[i].workerId = i;
+		workers[i].mutex = &mutex;
+		workers[i].stop = &stop;
+		PTF_ASSERT_EQUAL(pthread_create(&threads[i], NULL, loadBalancerWorkerMain, &workers[i]), 0, int);
+	}
+
+	int numOfRetries = 0;
+	for (size_t i = 0; i < packets.size(); i++)
+	{
+		// the ring may be full until the worker catches up
+		while (balancer.distributePacket(packets[i]) < 0)
+			numOfRetries++;
+	}
+
+	pthread_mutex_lock(&mutex);
+	stop = true;
+	pthread_mutex_unlock(&mutex);
+	for (int i = 0; i < LOAD_BALANCER_NUM_OF_WORKERS; i++)
+		pthread_join(threads[i], NULL);
+	pthread_mutex_destroy(&mutex);
+
+	// each flow was received by a single worker
+	std::map<uint32_t, uint16_t> flowToWorker;
+	int numOfPackets = 0;
+	for (int i = 0; i < LOAD_BALANCER_NUM_OF_WORKERS; i++)
+	{
+		PTF_ASSERT_TRUE(workers[i].result.isFlowOnOneWorker);
+		numOfPackets += workers[i].result.numOfPackets;
+		flowToWorker.insert(workers[i].result.flowToWorker.begin(), workers[i].result.flowToWorker.end());
+	}
+
+	PTF_ASSERT_EQUAL(numOfPackets, (int)packets.size(), int);
+	PTF_ASSERT_EQUAL(flowToWorker.size(), LOAD_BALANCER_NUM_OF_FLOWS, size);
+
+	pcpp::PacketLoadBalancer::Stats stats;
+	balancer.getStatistics(stats);
+	PTF_ASSERT_EQUAL(stats.packetsDistributed, packets.size(), u64);
+	PTF_ASSERT_EQUAL(stats.packetsDropped, (uint64_t)numOfRetries, u64);
+} // TestPacketLoadBalancerThreads
+
+
+
+PTF_TEST_CASE(TestPacketLoadBalancerProcesses)
+{
+#if defined(WIN32) || defined(WINx64) || defined(PCAPPP_MINGW_ENV)
+	PTF_SKIP_TEST("Shared memory isn't supported on Windows");
+#else
+	std::vector<pcpp::RawPacket> packets;
+	loadBalancerCreatePackets(packets);
+
+	char sharedMemoryName[64];
+	snprintf(sharedMemoryName, sizeof(sharedMemoryName), "/pcpp_test_load_balancer_%d", (int)getpid());
+
+	pcpp::PacketLoadBalancer::Config config;
+	config.numOfWorkers = 2;
+	config.ringSize = 512;
+	config.sharedMemoryName = sharedMemoryName;
+	pcpp::PacketLoadBalancer balancer(config);
+	PTF_ASSERT_TRUE(balancer.isValid());
+
+	pcpp::LoggerPP::getInstance().supressErrors();
+	pcpp::PacketLoadBalancer sameNameBalancer(config);
+	PTF_ASSERT_FALSE(sameNameBalancer.isValid());
+	pcpp::PacketLoadBalancerWorker invalidWorker(sharedMemoryName, 2);
+	PTF_ASSERT_FALSE(invalidWorker.isValid());
+	pcpp::PacketLoadBalancerWorker unknownWorker("/pcpp_test_load_balancer_unknown", 0);
+	PTF_ASSERT_FALSE(unknownWorker.isValid());
+	pcpp::LoggerPP::getInstance().enableErrors();
+
+	int expectedPackets[2] = { 0, 0 };
+	for (size_t i = 0; i < packets.size(); i++)
+		expectedPackets[balancer.getWorkerOfHash(pcpp::PacketLoadBalancer::getFlowHash(packets[i]))]++;
+
+	// worker 1 is another process that attaches to the rings by name. The output buffer is flushed so the child doesn't print it again
+	fflush(stdout);
+	pid_t pid = fork();
+	PTF_ASSERT_TRUE(pid >= 0);
+	if (pid == 0)
+	{
+		pcpp::PacketLoadBalancerWorker worker(sharedMemoryName, 1);
+		LoadBalancerResult result;
+		for (int i = 0; i < 10000 && worker.isValid() && result.numOfPackets < expectedPackets[1]; i++)
+		{
+			if (worker.receivePackets(loadBalancerOnPacketsReceived, &result) == 0)
+				usleep(1000);
+		}
+
+		_exit(result.numOfPackets == expectedPackets[1] && result.isFlowOnOneWorker ? 0 : 1);
+	}
+
+	for (size_t i = 0; i < packets.size(); i++)
+		PTF_ASSERT_TRUE(balancer.distributePacket(packets[i]) >= 0);
+
+	int status = 0;
+	PTF_ASSERT_EQUAL(waitpid(pid, &status, 0), pid, int);
+	PTF_ASSERT_TRUE(WIFEXITED(status));
+	PTF_ASSERT_EQUAL(WEXITSTATUS(status), 0, int);
+
+	// worker 0 attaches from this process
+	pcpp::PacketLoadBalancerWorker worker(sharedMemoryName, 0);
+	PTF_ASSERT_TRUE(worker.isValid());
+	PTF_ASSERT_EQUAL(worker.getWorkerId(), 0, u16);
+	LoadBalancerResult result;
+	PTF_ASSERT_EQUAL(worker.receivePackets(loadBalancerOnPacketsReceived, &result, 100000), (uint32_t)expectedPackets[0], u32);
+	PTF_ASSERT_TRUE(result.isFlowOnOneWorker);
+
+	pcpp::PacketLoadBalancer::WorkerStats workerStats;
+	PTF_ASSERT_TRUE(balancer.getWorkerStatistics(1, workerStats));
+	PTF_ASSERT_EQUAL(workerStats.packetsDistributed, (uint64_t)expectedPackets[1], u64);
+	PTF_ASSERT_EQUAL(workerStats.packetsQueued, 0, u32);
+#endif
+} // TestPacketLoadBalancerProcesses
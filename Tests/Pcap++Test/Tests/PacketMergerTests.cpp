@@ -0,0 +1,236 @@
+#include "../TestDefinition.h"
+#include "Logger.h"
+#include "PacketMerger.h"
+#include <pthread.h>
+#include <string.h>
+#include <vector>
+
+
+#define PACKET_MERGER_NUM_OF_SOURCES 4
+#define PACKET_MERGER_PACKETS_PER_SOURCE 5000
+
+struct PacketMergerResult
+{
+	std::vector<uint64_t> timestamps;
+	std::vector<uint32_t> ids;
+	int numOfBatches;
+
+	PacketMergerResult() : numOfBatches(0) {}
+};
+
+struct PacketMergerProducer
+{
+	pcpp::PacketMerger* merger;
+	uint16_t source;
+	std::vector<pcpp::RawPacket>* packets;
+};
+
+static uint64_t timespecToNsec(const timespec& ts)
+{
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void packetMergerOnPacketsMerged(pcpp::RawPacket* packets, uint32_t numOfPackets, pcpp::PacketMerger* merger, void* userCookie)
+{
+	PacketMergerResult* result = (PacketMergerResult*)userCookie;
+	result->numOfBatches++;
+	for (uint32_t i = 0; i < numOfPackets; i++)
+	{
+		result->timestamps.push_back(timespecToNsec(packets[i].getPacketTimeStamp()));
+		uint32_t id;
+		memcpy(&id, packets[i].getRawData(), sizeof(id));
+		result->ids.push_back(id);
+	}
+}
+
+static void* packetMergerProducerMain(void* ptr)
+{
+	PacketMergerProducer* producer = (PacketMergerProducer*)ptr;
+	for (size_t i = 0; i < producer->packets->size(); i++)
+	{
+		// the ring may be full until the merge thread catches up
+		while (!producer->merger->addPacket(producer->packets->at(i), producer->source))
+		{
+		}
+	}
+
+	// the end of the stream, the packets of other sources don't need to wait for this source anymore
+	timespec endOfStream = producer->packets->back().getPacketTimeStamp();
+	endOfStream.tv_sec += 3600;
+	producer->merger->advanceWatermark(producer->source, endOfStream);
+	return NULL;
+}
+
+// creates the packets of each source in timestamp order, with the sources interleaved in time. The first 4 bytes of a packet are its id
+static void packetMergerCreatePackets(std::vector<pcpp::RawPacket> packets[PACKET_MERGER_NUM_OF_SOURCES])
+{
+	uint8_t data[64];
+	memset(data, 0, sizeof(data));
+	uint32_t seed = 1234;
+	for (uint16_t source = 0; source < PACKET_MERGER_NUM_OF_SOURCES; source++)
+	{
+		uint64_t ts = 1000000000ULL;
+		for (uint32_t i = 0; i < PACKET_MERGER_PACKETS_PER_SOURCE; i++)
+		{
+			seed = seed * 1103515245 + 12345;
+			ts += 1 + (seed >> 16) % 10000;
+			uint32_t id = source * PACKET_MERGER_PACKETS_PER_SOURCE + i;
+			memcpy(data, &id, sizeof(id));
+			timespec timestamp;
+			timestamp.tv_sec = ts / 1000000000ULL;
+			timestamp.tv_nsec = ts % 1000000000ULL;
+			// the packet data is copied
+			pcpp::RawPacket rawPacket(data, sizeof(data), timestamp, false);
+			packets[source].push_back(rawPacket);
+		}
+	}
+}
+
+static bool packetMergerIsSorted(const std::vector<uint64_t>& timestamps)
+{
+	for (size_t i = 1; i < timestamps.size(); i++)
+	{
+		if (timestamps[i] < timestamps[i - 1])
+			return false;
+	}
+
+	return true;
+}
+
+
+
+PTF_TEST_CASE(TestPacketMerger)
+{
+	std::vector<pcpp::RawPacket> packets[PACKET_MERGER_NUM_OF_SOURCES];
+	packetMergerCreatePackets(packets);
+
+	pcpp::LoggerPP::getInstance().supressErrors();
+	pcpp::PacketMerger::Config invalidConfig;
+	invalidConfig.numOfSources = 0;
+	pcpp::PacketMerger invalidMerger(invalidConfig);
+	PTF_ASSERT_FALSE(invalidMerger.isValid());
+	PTF_ASSERT_FALSE(invalidMerger.addPacket(packets[0][0]));
+	PTF_ASSERT_FALSE(invalidMerger.start(packetMergerOnPacketsMerged));
+	pcpp::LoggerPP::getInstance().enableErrors();
+
+	// the reorder window is long so packets are emitted only when they're known to be in order
+	pcpp::PacketMerger::Config config;
+	config.numOfSources = PACKET_MERGER_NUM_OF_SOURCES;
+	config.queueSize = 6000;
+	config.maxPacketLen = 32;
+	config.reorderWindowNsec = 3600 * 1000000000ULL;
+	pcpp::PacketMerger merger(config);
+	PTF_ASSERT_TRUE(merger.isValid());
+	PTF_ASSERT_EQUAL(merger.getConfig().queueSize, 8192, u32);
+
+	for (int source = 0; source < PACKET_MERGER_NUM_OF_SOURCES; source++)
+	{
+		PTF_ASSERT_EQUAL(merger.addPackets(&packets[source][0], PACKET_MERGER_PACKETS_PER_SOURCE, source), PACKET_MERGER_PACKETS_PER_SOURCE, u32);
+	}
+	PTF_ASSERT_FALSE(merger.addPacket(packets[0][0], PACKET_MERGER_NUM_OF_SOURCES));
+
+	// packets are emitted until the first source runs out of packets
+	PacketMergerResult result;
+	uint32_t numOfPacketsEmitted = merger.mergePackets(packetMergerOnPacketsMerged, &result);
+	PTF_ASSERT_TRUE(numOfPacketsEmitted > 0);
+	PTF_ASSERT_TRUE(numOfPacketsEmitted < PACKET_MERGER_NUM_OF_SOURCES * PACKET_MERGER_PACKETS_PER_SOURCE);
+	PTF_ASSERT_EQUAL(result.timestamps.size(), numOfPacketsEmitted, size);
+	PTF_ASSERT_EQUAL(merger.mergePackets(packetMergerOnPacketsMerged, &result), 0, u32);
+
+	// a watermark of the source that ran out of packets lets the packets of the other sources through
+	uint16_t exhaustedSource = 0;
+	for (uint16_t source = 1; source < PACKET_MERGER_NUM_OF_SOURCES; source++)
+	{
+		if (timespecToNsec(packets[source].back().getPacketTimeStamp()) < timespecToNsec(packets[exhaustedSource].back().getPacketTimeStamp()))
+			exhaustedSource = source;
+	}
+	PTF_ASSERT_TRUE(result.timestamps.back() >= timespecToNsec(packets[exhaustedSource].back().getPacketTimeStamp()));
+	timespec watermark = packets[exhaustedSource].back().getPacketTimeStamp();
+	watermark.tv_sec++;
+	merger.advanceWatermark(exhaustedSource, watermark);
+	PTF_ASSERT_TRUE(merger.mergePackets(packetMergerOnPacketsMerged, &result) > 0);
+
+	merger.mergePackets(packetMergerOnPacketsMerged, &result, true);
+	PTF_ASSERT_EQUAL(result.timestamps.size(), PACKET_MERGER_NUM_OF_SOURCES * PACKET_MERGER_PACKETS_PER_SOURCE, size);
+	PTF_ASSERT_TRUE(packetMergerIsSorted(result.timestamps));
+	PTF_ASSERT_TRUE(result.numOfBatches >= (int)(result.timestamps.size() / config.maxBatchSize));
+
+	// the packets are longer than the max packet length so they were all truncated
+	pcpp::PacketMerger::Stats stats;
+	merger.getStatistics(stats);
+	PTF_ASSERT_EQUAL(stats.packetsAdded, PACKET_MERGER_NUM_OF_SOURCES * PACKET_MERGER_PACKETS_PER_SOURCE, u64);
+	PTF_ASSERT_EQUAL(stats.packetsEmitted, stats.packetsAdded, u64);
+	PTF_ASSERT_EQUAL(stats.packetsTruncated, stats.packetsAdded, u64);
+	PTF_ASSERT_EQUAL(stats.packetsDropped, 0, u64);
+	PTF_ASSERT_EQUAL(stats.packetsLate, 0, u64);
+	PTF_ASSERT_EQUAL(stats.batchesEmitted, (uint64_t)result.numOfBatches, u64);
+	PTF_ASSERT_TRUE(stats.maxLatencyNsec >= stats.getAverageLatencyNsec());
+
+	// a packet that arrives after later packets were emitted is late
+	pcpp::PacketMerger::Config smallConfig;
+	smallConfig.numOfSources = 2;
+	smallConfig.queueSize = 2;
+	smallConfig.reorderWindowNsec = 0;
+	pcpp::PacketMerger smallMerger(smallConfig);
+	PTF_ASSERT_TRUE(smallMerger.addPacket(packets[0][1], 0));
+	PTF_ASSERT_TRUE(smallMerger.addPacket(packets[0][2], 0));
+	PTF_ASSERT_FALSE(smallMerger.addPacket(packets[0][3], 0));
+	PacketMergerResult smallResult;
+	PTF_ASSERT_EQUAL(smallMerger.mergePackets(packetMergerOnPacketsMerged, &smallResult), 2, u32);
+	PTF_ASSERT_TRUE(smallMerger.addPacket(packets[0][0], 1));
+	PTF_ASSERT_EQUAL(smallMerger.mergePackets(packetMergerOnPacketsMerged, &smallResult), 1, u32);
+	smallMerger.getStatistics(stats);
+	PTF_ASSERT_EQUAL(stats.packetsDropped, 1, u64);
+	PTF_ASSERT_EQUAL(stats.packetsLate, 1, u64);
+	PTF_ASSERT_EQUAL(stats.packetsTruncated, 0, u64);
+} // TestPacketMerger
+
+
+
+PTF_TEST_CASE(TestPacketMergerThreads)
+{
+	std::vector<pcpp::RawPacket> packets[PACKET_MERGER_NUM_OF_SOURCES];
+	packetMergerCreatePackets(packets);
+
+	// small rings so the producers wait for the merge thread. The reorder window is long so packets are emitted only when they're known
+	// to be in order, regardless of how the producer threads are scheduled
+	pcpp::PacketMerger::Config config;
+	config.numOfSources = PACKET_MERGER_NUM_OF_SOURCES;
+	config.queueSize = 256;
+	config.reorderWindowNsec = 3600 * 1000000000ULL;
+	config.pollingPolicy = pcpp::PollingPolicy(pcpp::PollingModeBusySpin);
+	pcpp::PacketMerger merger(config);
+	PTF_ASSERT_TRUE(merger.isValid());
+
+	PacketMergerResult result;
+	PTF_ASSERT_TRUE(merger.start(packetMergerOnPacketsMerged, &result));
+	PTF_ASSERT_TRUE(merger.isStarted());
+	pcpp::LoggerPP::getInstance().supressErrors();
+	PTF_ASSERT_FALSE(merger.start(packetMergerOnPacketsMerged, &result));
+	pcpp::LoggerPP::getInstance().enableErrors();
+
+	pthread_t threads[PACKET_MERGER_NUM_OF_SOURCES];
+	PacketMergerProducer producers[PACKET_MERGER_NUM_OF_SOURCES];
+	for (int i = 0; i < PACKET_MERGER_NUM_OF_SOURCES; i++)
+	{
+		producers[i].merger = &merger;
+		producers[i].source = i;
+		producers[i].packets = &packets[i];
+		PTF_ASSERT_EQUAL(pthread_create(&threads[i], NULL, packetMergerProducerMain, &producers[i]), 0, int);
+	}
+
+	for (int i = 0; i < PACKET_MERGER_NUM_OF_SOURCES; i++)
+		pthread_join(threads[i], NULL);
+
+	merger.stop();
+	PTF_ASSERT_FALSE(merger.isStarted());
+
+	PTF_ASSERT_EQUAL(result.timestamps.size(), PACKET_MERGER_NUM_OF_SOURCES * PACKET_MERGER_PACKETS_PER_SOURCE, size);
+	PTF_ASSERT_TRUE(packetMergerIsSorted(result.timestamps));
+
+	pcpp::PacketMerger::Stats stats;
+	merger.getStatistics(stats);
+	PTF_ASSERT_EQUAL(stats.packetsEmitted, PACKET_MERGER_NUM_OF_SOURCES * PACKET_MERGER_PACKETS_PER_SOURCE, u64);
+	PTF_ASSERT_EQUAL(stats.packetsLate, 0, u64);
+	PTF_ASSERT_EQUAL(stats.packetsAdded, stats.packetsEmitted, u64);
+} // TestPacketMergerThreads
@@ -284,6 +284,47 @@ PTF_TEST_CASE(TestPfRingDeviceSingleChannel)
 
 
 
+PTF_TEST_CASE(TestPfRingPollingPolicy)
+{
+#ifdef USE_PF_RING
+
+	pcpp::PfRingDeviceList& devList = pcpp::PfRingDeviceList::getInstance();
+	pcpp::PcapLiveDevice* pcapLiveDev = pcpp::PcapLiveDeviceList::getInstance().getPcapLiveDeviceByIp(PcapTestGlobalArgs.ipToSendReceivePackets.c_str());
+	PTF_ASSERT_NOT_NULL(pcapLiveDev);
+	pcpp::PfRingDevice* dev = devList.getPfRingDeviceByName(std::string(pcapLiveDev->getName()));
+	PTF_ASSERT_NOT_NULL(dev);
+
+	PfRingPacketData packetData;
+	PTF_ASSERT_TRUE(dev->openSingleRxChannel(0));
+	PTF_ASSERT_TRUE(dev->setPollingPolicy(pcpp::PollingPolicy(pcpp::PollingModeBackoff, 100, 10, 1000)));
+	PTF_ASSERT_EQUAL(dev->getPollingPolicy().mode, pcpp::PollingModeBackoff, enum);
+	PTF_ASSERT_TRUE(dev->startCaptureSingleThread(pfRingPacketsArrive, &packetData));
+	pcpp::LoggerPP::getInstance().supressErrors();
+	PTF_ASSERT_FALSE(dev->setPollingPolicy(pcpp::PollingPolicy()));
+	pcpp::LoggerPP::getInstance().enableErrors();
+	int totalSleepTime = incSleep(10, packetData);
+	dev->stopCapture();
+	PTF_PRINT_VERBOSE("Total sleep time: %d", totalSleepTime);
+	PTF_ASSERT_GREATER_THAN(packetData.PacketCount, 0, int);
+
+	pcpp::PollingStats pollingStats;
+	dev->getPollingStats(pollingStats);
+	PTF_ASSERT_GREATER_THAN(pollingStats.numOfPolls, pollingStats.numOfEmptyPolls, u64);
+	PTF_ASSERT_GREATER_THAN(pollingStats.numOfSleeps, 0, u64);
+	PTF_ASSERT_GREATER_THAN(pollingStats.sleepTimeNsec, 0, u64);
+	PTF_PRINT_VERBOSE("Polls: %d, empty polls: %d, sleeps: %d", (int)pollingStats.numOfPolls, (int)pollingStats.numOfEmptyPolls, (int)pollingStats.numOfSleeps);
+	PTF_PRINT_VERBOSE("Busy ratio: %f", pollingStats.getBusyRatio());
+
+	dev->close();
+	PTF_ASSERT_TRUE(dev->setPollingPolicy(pcpp::PollingPolicy()));
+
+#else
+	PTF_SKIP_TEST("PF_RING not configured");
+#endif
+} // TestPfRingPollingPolicy
+
+
+
 
 PTF_TEST_CASE(TestPfRingDeviceMultiThread)
 {
@@ -301,17 +342,9 @@ PTF_TEST_CASE(TestPfRingDeviceMultiThread)
 	PTF_ASSERT_EQUAL(dev->getNumOfOpenedRxChannels(), 0, u8);
 	int totalnumOfCores = pcpp::getNumOfCores();
 	int numOfCoresInUse = 0;
-	pcpp::CoreMask tempCoreMask = TestPfRingMultiThreadCoreMask;
-	int i = 0;
-	while ((tempCoreMask != 0) && (i < totalnumOfCores))
+	for (int coreId = TestPfRingMultiThreadCoreMask.getFirstCore(); coreId >= 0 && coreId < totalnumOfCores; coreId = TestPfRingMultiThreadCoreMask.getNextCore(coreId))
 	{
-		if (tempCoreMask & 1)
-		{
-			numOfCoresInUse++;
-		}
-
-		tempCoreMask = tempCoreMask >> 1;
-		i++;
+		numOfCoresInUse++;
 	}
 
 	PTF_ASSERT_TRUE(dev->openMultiRxChannels((uint8_t)numOfCoresInUse, pcpp::PfRingDevice::PerFlow));
@@ -0,0 +1,133 @@
+#include "../TestDefinition.h"
+#include "PollingPolicy.h"
+
+
+PTF_TEST_CASE(TestPollingControllerBusySpin)
+{
+	pcpp::PollingController poller;
+	PTF_ASSERT_EQUAL(poller.getPolicy().mode, pcpp::PollingModeBusySpin, enum);
+
+	// busy spin never sleeps nor waits for interrupts, no matter how many polls are empty
+	for (int i = 0; i < 5000; i++)
+	{
+		PTF_ASSERT_EQUAL(poller.onPoll(0), pcpp::PollingController::PollAgain, enum);
+	}
+	PTF_ASSERT_EQUAL(poller.onPoll(32), pcpp::PollingController::PollAgain, enum);
+
+	const pcpp::PollingStats& stats = poller.getStats();
+	PTF_ASSERT_EQUAL(stats.numOfPolls, 5001, u64);
+	PTF_ASSERT_EQUAL(stats.numOfEmptyPolls, 5000, u64);
+	PTF_ASSERT_EQUAL(stats.numOfSleeps, 0, u64);
+	PTF_ASSERT_EQUAL(stats.numOfInterruptWaits, 0, u64);
+	PTF_ASSERT_EQUAL(stats.sleepTimeNsec, 0, u64);
+} // TestPollingControllerBusySpin
+
+
+
+PTF_TEST_CASE(TestPollingControllerBackoff)
+{
+	// invalid sleep times are fixed: the minimum is at least 1 usec and the maximum isn't lower than the minimum
+	pcpp::PollingController poller(pcpp::PollingPolicy(pcpp::PollingModeBackoff, 3, 0, 0));
+	PTF_ASSERT_EQUAL(poller.getPolicy().minSleepUsec, 1, u32);
+	PTF_ASSERT_EQUAL(poller.getPolicy().maxSleepUsec, 1, u32);
+
+	poller.reset(pcpp::PollingPolicy(pcpp::PollingModeBackoff, 3, 100, 400));
+	PTF_ASSERT_EQUAL(poller.getPolicy().mode, pcpp::PollingModeBackoff, enum);
+	const pcpp::PollingStats& stats = poller.getStats();
+
+	// the first spinCount empty polls don't sleep
+	for (int i = 0; i < 3; i++)
+	{
+		PTF_ASSERT_EQUAL(poller.onPoll(0), pcpp::PollingController::PollAgain, enum);
+	}
+	PTF_ASSERT_EQUAL(stats.numOfSleeps, 0, u64);
+	PTF_ASSERT_EQUAL(stats.sleepTimeNsec, 0, u64);
+
+	// the rest of them sleep 100, 200, 400 and 400 usec: the sleep time doubles up to the maximum
+	for (int i = 0; i < 4; i++)
+	{
+		PTF_ASSERT_EQUAL(poller.onPoll(0), pcpp::PollingController::PollAgain, enum);
+	}
+	PTF_ASSERT_EQUAL(stats.numOfSleeps, 4, u64);
+	PTF_ASSERT_GREATER_OR_EQUAL_THAN(stats.sleepTimeNsec, 1100000, u64);
+
+	// a poll with packets resets the backoff: the thread spins again before sleeping and starts from the minimum sleep time
+	PTF_ASSERT_EQUAL(poller.onPoll(10), pcpp::PollingController::PollAgain, enum);
+	for (int i = 0; i < 3; i++)
+	{
+		PTF_ASSERT_EQUAL(poller.onPoll(0), pcpp::PollingController::PollAgain, enum);
+	}
+	PTF_ASSERT_EQUAL(stats.numOfSleeps, 4, u64);
+	PTF_ASSERT_EQUAL(poller.onPoll(0), pcpp::PollingController::PollAgain, enum);
+	PTF_ASSERT_EQUAL(stats.numOfSleeps, 5, u64);
+
+	PTF_ASSERT_EQUAL(stats.numOfPolls, 12, u64);
+	PTF_ASSERT_EQUAL(stats.numOfEmptyPolls, 11, u64);
+	PTF_ASSERT_EQUAL(stats.numOfInterruptWaits, 0, u64);
+
+	// reset zeroes the stats
+	poller.reset(pcpp::PollingPolicy());
+	PTF_ASSERT_EQUAL(stats.numOfPolls, 0, u64);
+	PTF_ASSERT_EQUAL(stats.numOfSleeps, 0, u64);
+	PTF_ASSERT_EQUAL(stats.sleepTimeNsec, 0, u64);
+} // TestPollingControllerBackoff
+
+
+
+PTF_TEST_CASE(TestPollingControllerInterrupt)
+{
+	pcpp::PollingController poller(pcpp::PollingPolicy(pcpp::PollingModeInterrupt, 2, 10, 20));
+	const pcpp::PollingStats& stats = poller.getStats();
+
+	// the thread spins and then asks to wait for an interrupt instead of sleeping
+	PTF_ASSERT_EQUAL(poller.onPoll(0), pcpp::PollingController::PollAgain, enum);
+	PTF_ASSERT_EQUAL(poller.onPoll(0), pcpp::PollingController::PollAgain, enum);
+	PTF_ASSERT_EQUAL(poller.onPoll(0), pcpp::PollingController::WaitForInterrupt, enum);
+	PTF_ASSERT_EQUAL(stats.numOfSleeps, 0, u64);
+	poller.onInterruptWaitDone();
+	PTF_ASSERT_EQUAL(stats.numOfInterruptWaits, 1, u64);
+
+	// after the wait the thread spins again
+	PTF_ASSERT_EQUAL(poller.onPoll(0), pcpp::PollingController::PollAgain, enum);
+	PTF_ASSERT_EQUAL(poller.onPoll(0), pcpp::PollingController::PollAgain, enum);
+	PTF_ASSERT_EQUAL(poller.onPoll(0), pcpp::PollingController::WaitForInterrupt, enum);
+	poller.onInterruptWaitDone();
+	PTF_ASSERT_EQUAL(stats.numOfInterruptWaits, 2, u64);
+
+	// when interrupts aren't available the thread sleeps instead
+	poller.fallBackToBackoff();
+	PTF_ASSERT_EQUAL(poller.getPolicy().mode, pcpp::PollingModeBackoff, enum);
+	PTF_ASSERT_EQUAL(poller.onPoll(0), pcpp::PollingController::PollAgain, enum);
+	PTF_ASSERT_EQUAL(poller.onPoll(0), pcpp::PollingController::PollAgain, enum);
+	PTF_ASSERT_EQUAL(stats.numOfSleeps, 0, u64);
+	PTF_ASSERT_EQUAL(poller.onPoll(0), pcpp::PollingController::PollAgain, enum);
+	PTF_ASSERT_EQUAL(stats.numOfSleeps, 1, u64);
+	PTF_ASSERT_EQUAL(stats.numOfInterruptWaits, 2, u64);
+} // TestPollingControllerInterrupt
+
+
+
+PTF_TEST_CASE(TestPollingStats)
+{
+	pcpp::PollingStats stats;
+	PTF_ASSERT_EQUAL(stats.numOfPolls, 0, u64);
+	PTF_ASSERT_EQUAL(stats.getBusyRatio(), 0, int);
+
+	stats.numOfPolls = 10;
+	stats.numOfEmptyPolls = 4;
+	stats.busyTimeNsec = 300;
+	stats.idleTimeNsec = 100;
+	stats.sleepTimeNsec = 600;
+
+	pcpp::PollingStats total;
+	total.add(stats);
+	total.add(stats);
+	PTF_ASSERT_EQUAL(total.numOfPolls, 20, u64);
+	PTF_ASSERT_EQUAL(total.numOfEmptyPolls, 8, u64);
+	PTF_ASSERT_EQUAL(total.busyTimeNsec, 600, u64);
+	PTF_ASSERT_EQUAL((int)(total.getBusyRatio() * 100), 30, int);
+
+	total.clear();
+	PTF_ASSERT_EQUAL(total.numOfPolls, 0, u64);
+	PTF_ASSERT_EQUAL(total.sleepTimeNsec, 0, u64);
+} // TestPollingStats
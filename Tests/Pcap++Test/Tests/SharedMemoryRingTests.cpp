@@ -0,0 +1,342 @@
+#include "../TestDefinition.h"
+#include "Logger.h"
+#include "SharedMemoryRing.h"
+#include "Packet.h"
+#include "EthLayer.h"
+#include "IPv4Layer.h"
+#include "UdpLayer.h"
+#include "PayloadLayer.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#if !defined(WIN32) && !defined(WINx64) && !defined(PCAPPP_MINGW_ENV)
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+
+#if !defined(WIN32) && !defined(WINx64) && !defined(PCAPPP_MINGW_ENV)
+
+#define SHARED_MEMORY_RING_NUM_OF_PACKETS 5000
+
+struct SharedMemoryRingResult
+{
+	std::vector<uint32_t> ids;
+	int numOfBatches;
+
+	SharedMemoryRingResult() : numOfBatches(0) {}
+};
+
+// creates a UDP packet whose last 4 bytes are its id. Packets with an even id are sent to port 1000 and the others to port 2000
+static pcpp::RawPacket sharedMemoryRingCreatePacket(uint32_t id)
+{
+	pcpp::EthLayer ethLayer(pcpp::MacAddress("00:11:22:33:44:55"), pcpp::MacAddress("66:77:88:99:aa:bb"));
+	pcpp::IPv4Layer ipLayer(pcpp::IPv4Address("10.0.0.1"), pcpp::IPv4Address("10.0.0.2"));
+	pcpp::UdpLayer udpLayer(40000, id % 2 == 0 ? 1000 : 2000);
+	pcpp::PayloadLayer payloadLayer((uint8_t*)&id, sizeof(id), false);
+
+	pcpp::Packet packet(100);
+	packet.addLayer(&ethLayer);
+	packet.addLayer(&ipLayer);
+	packet.addLayer(&udpLayer);
+	packet.addLayer(&payloadLayer);
+	packet.computeCalculateFields();
+	return *packet.getRawPacket();
+}
+
+static uint32_t sharedMemoryRingGetId(const pcpp::RawPacket& rawPacket)
+{
+	uint32_t id;
+	memcpy(&id, rawPacket.getRawData() + rawPacket.getRawDataLen() - sizeof(id), sizeof(id));
+	return id;
+}
+
+static void sharedMemoryRingOnPacketsReceived(pcpp::RawPacket* packets, uint32_t numOfPackets, pcpp::SharedMemoryRingReaderDevice* device, void* userCookie)
+{
+	SharedMemoryRingResult* result = (SharedMemoryRingResult*)userCookie;
+	result->numOfBatches++;
+	for (uint32_t i = 0; i < numOfPackets; i++)
+		result->ids.push_back(sharedMemoryRingGetId(packets[i]));
+}
+
+// the reader process of TestSharedMemoryRingProcesses. Returns the exit code
+static int sharedMemoryRingReaderProcess(const char* ringName)
+{
+	pcpp::SharedMemoryRingReaderDevice reader(ringName);
+	if (!reader.open())
+		return 1;
+
+	SharedMemoryRingResult result;
+	// the writer finishes in well under a minute
+	for (int i = 0; i < 60000 && !reader.isStreamEnded(); i++)
+	{
+		if (reader.receivePackets(sharedMemoryRingOnPacketsReceived, &result, 256) == 0)
+			usleep(1000);
+	}
+
+	if (result.ids.size() != SHARED_MEMORY_RING_NUM_OF_PACKETS)
+		return 2;
+
+	for (uint32_t i = 0; i < result.ids.size(); i++)
+	{
+		if (result.ids[i] != i)
+			return 3;
+	}
+
+	// packets the writer failed to write are counted as dropped by the readers too, but the writer wrote them again
+	pcpp::IPcapDevice::PcapStats stats;
+	reader.getStatistics(stats);
+	return (stats.packetsRecv == SHARED_MEMORY_RING_NUM_OF_PACKETS ? 0 : 4);
+}
+
+#endif // !WIN32 && !WINx64 && !PCAPPP_MINGW_ENV
+
+
+
+PTF_TEST_CASE(TestSharedMemoryRing)
+{
+#if defined(WIN32) || defined(WINx64) || defined(PCAPPP_MINGW_ENV)
+	PTF_SKIP_TEST("Shared memory rings aren't supported on Windows");
+#else
+	char ringName[64];
+	snprintf(ringName, sizeof(ringName), "/pcpp_test_ring_%d", (int)getpid());
+
+	std::vector<pcpp::RawPacket> packets;
+	for (uint32_t i = 0; i < 32; i++)
+		packets.push_back(sharedMemoryRingCreatePacket(i));
+
+	pcpp::SharedMemoryRingWriterDevice::Config config;
+	config.numOfSlots = 6;
+	config.maxConsumers = 2;
+	pcpp::SharedMemoryRingWriterDevice writer(ringName, config);
+	pcpp::SharedMemoryRingReaderDevice reader1(ringName);
+	pcpp::SharedMemoryRingReaderDevice reader2(ringName);
+	pcpp::SharedMemoryRingReaderDevice reader3(ringName);
+
+	pcpp::LoggerPP::getInstance().supressErrors();
+	PTF_ASSERT_FALSE(reader1.open());
+	PTF_ASSERT_FALSE(writer.writePacket(packets[0]));
+	pcpp::LoggerPP::getInstance().enableErrors();
+
+	PTF_ASSERT_TRUE(writer.open());
+	PTF_ASSERT_EQUAL(writer.getConfig().numOfSlots, 8, u32);
+	PTF_ASSERT_EQUAL(writer.getAttachName(), std::string(ringName), string);
+
+	// packets written before a reader attaches aren't seen by it
+	PTF_ASSERT_TRUE(writer.writePacket(packets[0]));
+	PTF_ASSERT_TRUE(reader1.open());
+	PTF_ASSERT_TRUE(reader2.open());
+	PTF_ASSERT_EQUAL(reader1.getSlowConsumerPolicy(), pcpp::SharedMemoryRingWriterDevice::DropNewestPackets, enum);
+	pcpp::LoggerPP::getInstance().supressErrors();
+	PTF_ASSERT_FALSE(reader3.open());
+	pcpp::LoggerPP::getInstance().enableErrors();
+	PTF_ASSERT_EQUAL(writer.getNumOfConsumers(), 2, int);
+
+	// the readers are a whole ring behind, so new packets are dropped
+	for (uint32_t i = 1; i <= 8; i++)
+		PTF_ASSERT_TRUE(writer.writePacket(packets[i]));
+	PTF_ASSERT_FALSE(writer.writePacket(packets[9]));
+	PTF_ASSERT_EQUAL(writer.getSlowestConsumerLag(), 8, u64);
+
+	// the packets of the first reader point to the ring
+	SharedMemoryRingResult result1;
+	PTF_ASSERT_EQUAL(reader1.receivePackets(sharedMemoryRingOnPacketsReceived, &result1, 100), 8, u32);
+	PTF_ASSERT_EQUAL(result1.numOfBatches, 1, int);
+	for (uint32_t i = 0; i < 8; i++)
+		PTF_ASSERT_EQUAL(result1.ids[i], i + 1, u32);
+
+	// the second reader still holds the ring
+	PTF_ASSERT_FALSE(writer.writePacket(packets[9]));
+	pcpp::RawPacket rawPacket;
+	PTF_ASSERT_TRUE(reader2.getNextPacket(rawPacket));
+	PTF_ASSERT_EQUAL(sharedMemoryRingGetId(rawPacket), 1, u32);
+	PTF_ASSERT_EQUAL(rawPacket.getRawDataLen(), packets[1].getRawDataLen(), int);
+	PTF_ASSERT_BUF_COMPARE(rawPacket.getRawData(), packets[1].getRawData(), packets[1].getRawDataLen());
+	PTF_ASSERT_TRUE(writer.writePacket(packets[9]));
+
+	pcpp::RawPacketVector packetVec;
+	PTF_ASSERT_EQUAL(reader2.getNextPackets(packetVec), 8, int);
+	PTF_ASSERT_EQUAL(sharedMemoryRingGetId(*packetVec.front()), 2, u32);
+	PTF_ASSERT_EQUAL(sharedMemoryRingGetId(*packetVec.at(packetVec.size() - 1)), 9, u32);
+	PTF_ASSERT_FALSE(reader2.getNextPacket(rawPacket));
+
+	pcpp::IPcapDevice::PcapStats stats;
+	reader1.getStatistics(stats);
+	PTF_ASSERT_EQUAL(stats.packetsRecv, 8, u64);
+	PTF_ASSERT_EQUAL(stats.packetsDrop, 2, u64);
+	writer.getStatistics(stats);
+	PTF_ASSERT_EQUAL(stats.packetsRecv, 10, u64);
+	PTF_ASSERT_EQUAL(stats.packetsDrop, 2, u64);
+
+	// a reader filter skips packets, a writer filter doesn't write them at all
+	PTF_ASSERT_TRUE(reader1.setFilter("udp dst port 1000"));
+	PTF_ASSERT_TRUE(writer.setFilter("udp"));
+	for (uint32_t i = 10; i < 16; i++)
+		PTF_ASSERT_TRUE(writer.writePacket(packets[i]));
+	SharedMemoryRingResult result2;
+	PTF_ASSERT_EQUAL(reader1.receivePackets(sharedMemoryRingOnPacketsReceived, &result2), 3, u32);
+	PTF_ASSERT_EQUAL(result2.ids.size(), 3, size);
+	PTF_ASSERT_EQUAL(result2.ids[0], 10, u32);
+	PTF_ASSERT_EQUAL(result2.ids[2], 14, u32);
+	PTF_ASSERT_TRUE(reader1.clearFilter());
+
+	PTF_ASSERT_TRUE(writer.setFilter("tcp"));
+	PTF_ASSERT_TRUE(writer.writePacket(packets[16]));
+	writer.getStatistics(stats);
+	PTF_ASSERT_EQUAL(stats.packetsRecv, 16, u64);
+	PTF_ASSERT_TRUE(writer.clearFilter());
+
+	// a closed reader doesn't hold the ring
+	reader2.close();
+	PTF_ASSERT_EQUAL(writer.getNumOfConsumers(), 1, int);
+	PTF_ASSERT_TRUE(reader3.open());
+	PTF_ASSERT_EQUAL(writer.getNumOfConsumers(), 2, int);
+	reader3.close();
+
+	// readers receive the packets left in the ring after the writer closes it
+	PTF_ASSERT_TRUE(writer.writePacket(packets[17]));
+	writer.close();
+	PTF_ASSERT_FALSE(reader1.isStreamEnded());
+	PTF_ASSERT_TRUE(reader1.getNextPacket(rawPacket));
+	PTF_ASSERT_EQUAL(sharedMemoryRingGetId(rawPacket), 17, u32);
+	PTF_ASSERT_TRUE(reader1.isStreamEnded());
+	reader1.close();
+
+	pcpp::LoggerPP::getInstance().supressErrors();
+	PTF_ASSERT_FALSE(reader1.open());
+	pcpp::LoggerPP::getInstance().enableErrors();
+#endif
+} // TestSharedMemoryRing
+
+
+
+PTF_TEST_CASE(TestSharedMemoryRingOverwrite)
+{
+#if defined(WIN32) || defined(WINx64) || defined(PCAPPP_MINGW_ENV)
+	PTF_SKIP_TEST("Shared memory rings aren't supported on Windows");
+#else
+	char ringName[64];
+	snprintf(ringName, sizeof(ringName), "/pcpp_test_ring_overwrite_%d", (int)getpid());
+
+	pcpp::SharedMemoryRingWriterDevice::Config config;
+	config.numOfSlots = 8;
+	config.slowConsumerPolicy = pcpp::SharedMemoryRingWriterDevice::OverwriteOldestPackets;
+#ifdef LINUX
+	config.memoryType = pcpp::SharedMemoryRingWriterDevice::MemfdSharedMemory;
+#endif
+	pcpp::SharedMemoryRingWriterDevice writer(ringName, config);
+	PTF_ASSERT_TRUE(writer.open());
+#ifdef LINUX
+	PTF_ASSERT_TRUE(writer.getAttachName().find("/proc/") == 0);
+#endif
+
+	pcpp::SharedMemoryRingReaderDevice fastReader(writer.getAttachName());
+	pcpp::SharedMemoryRingReaderDevice slowReader(writer.getAttachName());
+	PTF_ASSERT_TRUE(fastReader.open());
+	PTF_ASSERT_TRUE(slowReader.open());
+	PTF_ASSERT_EQUAL(slowReader.getSlowConsumerPolicy(), pcpp::SharedMemoryRingWriterDevice::OverwriteOldestPackets, enum);
+
+	// the writer is never held back. The fast reader receives every packet and the slow one only the last ring of packets
+	SharedMemoryRingResult fastResult;
+	for (uint32_t i = 0; i < 20; i++)
+	{
+		PTF_ASSERT_TRUE(writer.writePacket(sharedMemoryRingCreatePacket(i)));
+		PTF_ASSERT_EQUAL(fastReader.receivePackets(sharedMemoryRingOnPacketsReceived, &fastResult), 1, u32);
+	}
+
+	PTF_ASSERT_EQUAL(fastResult.ids.size(), 20, size);
+	PTF_ASSERT_EQUAL(fastResult.ids.back(), 19, u32);
+
+	pcpp::RawPacketVector packetVec;
+	PTF_ASSERT_EQUAL(slowReader.getNextPackets(packetVec), 8, int);
+	PTF_ASSERT_EQUAL(sharedMemoryRingGetId(*packetVec.front()), 12, u32);
+	PTF_ASSERT_EQUAL(sharedMemoryRingGetId(*packetVec.at(packetVec.size() - 1)), 19, u32);
+
+	pcpp::IPcapDevice::PcapStats stats;
+	slowReader.getStatistics(stats);
+	PTF_ASSERT_EQUAL(stats.packetsRecv, 8, u64);
+	PTF_ASSERT_EQUAL(stats.packetsDrop, 12, u64);
+	fastReader.getStatistics(stats);
+	PTF_ASSERT_EQUAL(stats.packetsDrop, 0, u64);
+	writer.getStatistics(stats);
+	PTF_ASSERT_EQUAL(stats.packetsRecv, 20, u64);
+	PTF_ASSERT_EQUAL(stats.packetsDrop, 0, u64);
+
+	pcpp::SharedMemoryRingWriterDevice::Config hugePagesConfig;
+	hugePagesConfig.useHugePages = true;
+	pcpp::SharedMemoryRingWriterDevice hugePagesWriter(ringName, hugePagesConfig);
+	pcpp::LoggerPP::getInstance().supressErrors();
+	PTF_ASSERT_FALSE(hugePagesWriter.open());
+	pcpp::LoggerPP::getInstance().enableErrors();
+#endif
+} // TestSharedMemoryRingOverwrite
+
+
+
+PTF_TEST_CASE(TestSharedMemoryRingProcesses)
+{
+#if defined(WIN32) || defined(WINx64) || defined(PCAPPP_MINGW_ENV)
+	PTF_SKIP_TEST("Shared memory rings aren't supported on Windows");
+#else
+	char ringName[64];
+	snprintf(ringName, sizeof(ringName), "/pcpp_test_ring_processes_%d", (int)getpid());
+
+	pcpp::SharedMemoryRingWriterDevice::Config config;
+	config.numOfSlots = 256;
+	pcpp::SharedMemoryRingWriterDevice writer(ringName, config);
+	PTF_ASSERT_TRUE(writer.open());
+
+	std::vector<pcpp::RawPacket> packets;
+	for (uint32_t i = 0; i < SHARED_MEMORY_RING_NUM_OF_PACKETS; i++)
+		packets.push_back(sharedMemoryRingCreatePacket(i));
+
+	// the reader is another process. The output buffer is flushed so the child doesn't print it again
+	fflush(stdout);
+	pid_t pid = fork();
+	PTF_ASSERT_TRUE(pid >= 0);
+	if (pid == 0)
+		_exit(sharedMemoryRingReaderProcess(ringName));
+
+	for (int i = 0; i < 10000 && writer.getNumOfConsumers() == 0; i++)
+		usleep(1000);
+	PTF_ASSERT_EQUAL(writer.getNumOfConsumers(), 1, int);
+
+	// the ring is much smaller than the stream, so the writer waits for the reader
+	int numOfRetries = 0;
+	for (uint32_t i = 0; i < SHARED_MEMORY_RING_NUM_OF_PACKETS; i++)
+	{
+		while (!writer.writePacket(packets[i]))
+			numOfRetries++;
+	}
+
+	pcpp::IPcapDevice::PcapStats stats;
+	writer.getStatistics(stats);
+	PTF_ASSERT_EQUAL(stats.packetsRecv, SHARED_MEMORY_RING_NUM_OF_PACKETS, u64);
+	PTF_ASSERT_EQUAL(stats.packetsDrop, (uint64_t)numOfRetries, u64);
+	writer.close();
+
+	int status = 0;
+	PTF_ASSERT_EQUAL(waitpid(pid, &status, 0), pid, int);
+	PTF_ASSERT_TRUE(WIFEXITED(status));
+	PTF_ASSERT_EQUAL(WEXITSTATUS(status), 0, int);
+
+	// a reader process that exits without closing its device doesn't hold the ring
+	PTF_ASSERT_TRUE(writer.open());
+	fflush(stdout);
+	pid = fork();
+	PTF_ASSERT_TRUE(pid >= 0);
+	if (pid == 0)
+	{
+		pcpp::SharedMemoryRingReaderDevice reader(ringName);
+		_exit(reader.open() ? 0 : 1);
+	}
+
+	PTF_ASSERT_EQUAL(waitpid(pid, &status, 0), pid, int);
+	PTF_ASSERT_EQUAL(WEXITSTATUS(status), 0, int);
+	PTF_ASSERT_EQUAL(writer.getNumOfConsumers(), 1, int);
+	for (uint32_t i = 0; i < config.numOfSlots + 1; i++)
+		PTF_ASSERT_TRUE(writer.writePacket(packets[i]));
+	PTF_ASSERT_EQUAL(writer.getNumOfConsumers(), 0, int);
+#endif
+} // TestSharedMemoryRingProcesses
@@ -0,0 +1,142 @@
+#include "../TestDefinition.h"
+#include "SystemUtils.h"
+#include <algorithm>
+
+
+// the core tables can be used during static initialization
+static const pcpp::CoreMask staticInitCoreMask = pcpp::SystemCores::Core1.Mask | pcpp::SystemCores::IdToSystemCore[70].Mask;
+
+
+PTF_TEST_CASE(TestCoreMask)
+{
+	// backward compatibility with the integer representation
+	pcpp::CoreMask legacyMask = 0x5;
+	PTF_ASSERT_TRUE(legacyMask.isCoreSet(0));
+	PTF_ASSERT_FALSE(legacyMask.isCoreSet(1));
+	PTF_ASSERT_TRUE(legacyMask.isCoreSet(2));
+	PTF_ASSERT_EQUAL(legacyMask.getCoreCount(), 2, int);
+	PTF_ASSERT_TRUE(legacyMask == (pcpp::SystemCores::Core0.Mask | pcpp::SystemCores::Core2.Mask));
+	PTF_ASSERT_TRUE((legacyMask & pcpp::SystemCores::Core1.Mask) == 0);
+	PTF_ASSERT_FALSE((legacyMask & pcpp::SystemCores::Core2.Mask) == 0);
+	PTF_ASSERT_EQUAL(legacyMask.toUint64(), 0x5, u64);
+	PTF_ASSERT_EQUAL(legacyMask.toHexString(), "0x5", string);
+
+	// cores beyond 32 and 64
+	pcpp::CoreMask wideMask;
+	PTF_ASSERT_TRUE(wideMask.isEmpty());
+	PTF_ASSERT_EQUAL(wideMask.getFirstCore(), -1, int);
+	PTF_ASSERT_EQUAL(wideMask.toHexString(), "0x0", string);
+	wideMask.setCore(3);
+	wideMask.setCore(40);
+	wideMask.setCore(64);
+	wideMask.setCore(127);
+	PTF_ASSERT_FALSE(wideMask.isEmpty());
+	PTF_ASSERT_EQUAL(wideMask.getCoreCount(), 4, int);
+	PTF_ASSERT_TRUE(wideMask.isCoreSet(127));
+	PTF_ASSERT_FALSE(wideMask.isCoreSet(126));
+	PTF_ASSERT_FALSE(wideMask.isCoreSet(1000));
+	PTF_ASSERT_EQUAL(wideMask.getLastCore(), 127, int);
+	PTF_ASSERT_EQUAL(wideMask.toHexString(), "0x80000000000000010000010000000008", string);
+	PTF_ASSERT_TRUE(wideMask == (pcpp::SystemCores::IdToSystemCore[127].Mask
+			| pcpp::SystemCores::IdToSystemCore[64].Mask
+			| pcpp::SystemCores::IdToSystemCore[40].Mask
+			| pcpp::SystemCores::Core3.Mask));
+
+	// iterate over the cores in the mask
+	int expectedCores[] = { 3, 40, 64, 127 };
+	int index = 0;
+	for (int coreId = wideMask.getFirstCore(); coreId >= 0; coreId = wideMask.getNextCore(coreId), index++)
+	{
+		PTF_ASSERT_LOWER_THAN(index, 4, int);
+		PTF_ASSERT_EQUAL(coreId, expectedCores[index], int);
+	}
+	PTF_ASSERT_EQUAL(index, 4, int);
+
+	std::vector<pcpp::SystemCore> coreVec;
+	pcpp::createCoreVectorFromCoreMask(wideMask, coreVec);
+	PTF_ASSERT_EQUAL(coreVec.size(), 4, size);
+	PTF_ASSERT_EQUAL(coreVec.at(1).Id, 40, u8);
+	PTF_ASSERT_EQUAL(coreVec.at(3).Id, 127, u8);
+	PTF_ASSERT_TRUE(pcpp::createCoreMaskFromCoreVector(coreVec) == wideMask);
+
+	std::vector<int> coreIds;
+	coreIds.push_back(127);
+	coreIds.push_back(3);
+	coreIds.push_back(64);
+	coreIds.push_back(40);
+	PTF_ASSERT_TRUE(pcpp::createCoreMaskFromCoreIds(coreIds) == wideMask);
+
+	// set operations
+	wideMask.clearCore(64);
+	PTF_ASSERT_FALSE(wideMask.isCoreSet(64));
+	PTF_ASSERT_EQUAL(wideMask.getCoreCount(), 3, int);
+	pcpp::CoreMask complement = ~wideMask;
+	PTF_ASSERT_EQUAL(complement.getCoreCount(), MAX_NUM_OF_CORES - 3, int);
+	PTF_ASSERT_EQUAL(complement.getLastCore(), MAX_NUM_OF_CORES - 1, int);
+	PTF_ASSERT_TRUE((complement & wideMask).isEmpty());
+	pcpp::CoreMask withoutCore40 = wideMask & ~pcpp::SystemCores::IdToSystemCore[40].Mask;
+	PTF_ASSERT_EQUAL(withoutCore40.getCoreCount(), 2, int);
+	PTF_ASSERT_FALSE(withoutCore40.isCoreSet(40));
+	PTF_ASSERT_TRUE(withoutCore40.isCoreSet(127));
+
+	// masks are equal if they have the same cores, regardless of cores that were set and cleared
+	pcpp::CoreMask narrowMask = 0x8;
+	pcpp::CoreMask paddedMask = narrowMask;
+	paddedMask.setCore(200);
+	paddedMask.clearCore(200);
+	PTF_ASSERT_TRUE(narrowMask == paddedMask);
+	PTF_ASSERT_FALSE(narrowMask != paddedMask);
+
+	PTF_ASSERT_EQUAL(staticInitCoreMask.getCoreCount(), 2, int);
+	PTF_ASSERT_TRUE(staticInitCoreMask.isCoreSet(1));
+	PTF_ASSERT_TRUE(staticInitCoreMask.isCoreSet(70));
+	PTF_ASSERT_EQUAL(pcpp::SystemCores::IdToSystemCore[70].Id, 70, u8);
+
+	// all machine cores
+	pcpp::CoreMask allCores = pcpp::getCoreMaskForAllMachineCores();
+	PTF_ASSERT_EQUAL(allCores.getCoreCount(), std::min(pcpp::getNumOfCores(), MAX_NUM_OF_CORES), int);
+	PTF_ASSERT_EQUAL(allCores.getFirstCore(), 0, int);
+} // TestCoreMask
+
+
+
+PTF_TEST_CASE(TestSystemCoreTopology)
+{
+	std::vector<pcpp::SystemCoreTopology> topology;
+	pcpp::getSystemCoreTopology(topology);
+	PTF_ASSERT_GREATER_THAN(topology.size(), 0, size);
+
+	pcpp::CoreMask allCores;
+	for (std::vector<pcpp::SystemCoreTopology>::iterator iter = topology.begin(); iter != topology.end(); iter++)
+	{
+		PTF_ASSERT_FALSE(allCores.isCoreSet(iter->CoreId));
+		allCores.setCore(iter->CoreId);
+		PTF_ASSERT_TRUE(iter->SmtSiblings.isCoreSet(iter->CoreId));
+	}
+
+	// every core belongs to exactly one NUMA node and one socket
+	pcpp::CoreMask coresInNodes, coresInSockets;
+	for (std::vector<pcpp::SystemCoreTopology>::iterator iter = topology.begin(); iter != topology.end(); iter++)
+	{
+		pcpp::CoreMask nodeCores = pcpp::getCoreMaskForNumaNode(iter->NumaNode);
+		PTF_ASSERT_TRUE(nodeCores.isCoreSet(iter->CoreId));
+		coresInNodes |= nodeCores;
+
+		pcpp::CoreMask socketCores = pcpp::getCoreMaskForSocket(iter->SocketId);
+		PTF_ASSERT_TRUE(socketCores.isCoreSet(iter->CoreId));
+		coresInSockets |= socketCores;
+	}
+	PTF_ASSERT_TRUE(coresInNodes == allCores);
+	PTF_ASSERT_TRUE(coresInSockets == allCores);
+	PTF_ASSERT_TRUE(pcpp::getCoreMaskForNumaNode(-1).isEmpty());
+	PTF_ASSERT_TRUE(pcpp::getCoreMaskForSocket(-1).isEmpty());
+
+	// without SMT siblings there should be one logical core per physical core
+	pcpp::CoreMask physicalCores = pcpp::getCoreMaskWithoutSmtSiblings(allCores);
+	PTF_ASSERT_GREATER_THAN(physicalCores.getCoreCount(), 0, int);
+	PTF_ASSERT_LOWER_OR_EQUAL_THAN(physicalCores.getCoreCount(), allCores.getCoreCount(), int);
+	for (std::vector<pcpp::SystemCoreTopology>::iterator iter = topology.begin(); iter != topology.end(); iter++)
+	{
+		PTF_ASSERT_EQUAL((physicalCores & iter->SmtSiblings).getCoreCount(), 1, int);
+	}
+} // TestSystemCoreTopology
@@ -6,6 +6,8 @@
 #include "EndianPortable.h"
 #include "SystemUtils.h"
 #include "TcpReassembly.h"
+#include "PacketUtils.h"
+#include "EthLayer.h"
 #include "IPv4Layer.h"
 #include "TcpLayer.h"
 #include "PayloadLayer.h"
@@ -263,6 +265,87 @@ static pcpp::RawPacket tcpReassemblyAddRetransmissions(pcpp::RawPacket rawPacket
 }
 
 
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// tcpReassemblyStreamBufferResults
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+struct TcpReassemblyStreamBufferResults
+{
+	std::vector<std::string> lines[2];
+	int numOfMessagesWithoutBuffer;
+	size_t totalMissingBytes;
+
+	TcpReassemblyStreamBufferResults() : numOfMessagesWithoutBuffer(0), totalMissingBytes(0) {}
+};
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// tcpReassemblyStreamBufferMsgReadyCallback()
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static void tcpReassemblyStreamBufferMsgReadyCallback(int8_t sideIndex, const pcpp::TcpStreamData& tcpData, void* userCookie)
+{
+	TcpReassemblyStreamBufferResults* results = (TcpReassemblyStreamBufferResults*)userCookie;
+	results->totalMissingBytes += tcpData.getMissingByteCount();
+
+	pcpp::TcpStreamBuffer* streamBuffer = tcpData.getStreamBuffer();
+	if (streamBuffer == NULL)
+	{
+		results->numOfMessagesWithoutBuffer++;
+		return;
+	}
+
+	// parse the complete lines in the buffer and leave the last partial line for the next time
+	while (streamBuffer->getDataLength() > 0)
+	{
+		const uint8_t* newLine = (const uint8_t*)memchr(streamBuffer->getData(), '\n', streamBuffer->getDataLength());
+		if (newLine == NULL)
+		{
+			// a line cut by missing data can't be completed, continue with the data after the gap
+			if (streamBuffer->hasGap())
+			{
+				streamBuffer->skipGap();
+				continue;
+			}
+			break;
+		}
+
+		size_t lineLen = newLine - streamBuffer->getData();
+		results->lines[sideIndex].push_back(std::string((const char*)streamBuffer->peek(lineLen + 1), lineLen));
+		streamBuffer->consume(lineLen + 1);
+	}
+}
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// tcpReassemblyCreatePacket()
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static pcpp::RawPacket tcpReassemblyCreatePacket(bool fromClient, uint32_t sequence, std::string payload, bool isSyn = false, uint16_t clientPort = 40000)
+{
+	pcpp::IPv4Address clientIP(std::string("10.0.0.1"));
+	pcpp::IPv4Address serverIP(std::string("10.0.0.2"));
+	pcpp::EthLayer ethLayer(pcpp::MacAddress("00:11:22:33:44:55"), pcpp::MacAddress("66:77:88:99:aa:bb"));
+	pcpp::IPv4Layer ipLayer(fromClient ? clientIP : serverIP, fromClient ? serverIP : clientIP);
+	ipLayer.getIPv4Header()->timeToLive = 64;
+	pcpp::TcpLayer tcpLayer(fromClient ? clientPort : 80, fromClient ? 80 : clientPort);
+	tcpLayer.getTcpHeader()->sequenceNumber = htobe32(sequence);
+	tcpLayer.getTcpHeader()->synFlag = (isSyn ? 1 : 0);
+	tcpLayer.getTcpHeader()->ackFlag = (fromClient && isSyn ? 0 : 1);
+	pcpp::PayloadLayer payloadLayer((const uint8_t*)payload.c_str(), payload.length(), false);
+
+	pcpp::Packet packet(100);
+	packet.addLayer(&ethLayer);
+	packet.addLayer(&ipLayer);
+	packet.addLayer(&tcpLayer);
+	if (!payload.empty())
+		packet.addLayer(&payloadLayer);
+	packet.computeCalculateFields();
+
+	return *(packet.getRawPacket());
+}
+
+
 
 // ~~~~~~~~~~~~~~~~~~~~~
 // ~~~~~~~~~~~~~~~~~~~~~
@@ -1053,4 +1136,195 @@ PTF_TEST_CASE(TestTcpReassemblyMaxSeq)
 
 	std::string expectedReassemblyData = readFileIntoString(std::string("PcapExamples/one_tcp_stream_output.txt"));
 	PTF_ASSERT_EQUAL(expectedReassemblyData, stats.begin()->second.reassembledData, string);
-} //TestTcpReassemblyMaxSeq
\ No newline at end of file
+} //TestTcpReassemblyMaxSeq
+
+
+PTF_TEST_CASE(TestTcpReassemblyStreamBuffers)
+{
+	std::vector<pcpp::RawPacket> packetStream;
+	packetStream.push_back(tcpReassemblyCreatePacket(true, 999, "", true));
+	packetStream.push_back(tcpReassemblyCreatePacket(false, 4999, "", true));
+	packetStream.push_back(tcpReassemblyCreatePacket(true, 1000, "GET /a"));
+	packetStream.push_back(tcpReassemblyCreatePacket(true, 1006, " HTTP\nGE"));
+	// out-of-order packet
+	packetStream.push_back(tcpReassemblyCreatePacket(true, 1019, "X\n"));
+	packetStream.push_back(tcpReassemblyCreatePacket(true, 1014, "T /b\n"));
+	// retransmission
+	packetStream.push_back(tcpReassemblyCreatePacket(true, 1006, " HTTP\nGE"));
+	// 10 bytes are missing before this packet
+	packetStream.push_back(tcpReassemblyCreatePacket(true, 1031, "late\n"));
+	// 5 bytes are missing in the middle of a line
+	packetStream.push_back(tcpReassemblyCreatePacket(true, 1036, "abc"));
+	packetStream.push_back(tcpReassemblyCreatePacket(true, 1044, "def\nghi\n"));
+	packetStream.push_back(tcpReassemblyCreatePacket(true, 1052, "zz"));
+	packetStream.push_back(tcpReassemblyCreatePacket(false, 5000, "OK"));
+	packetStream.push_back(tcpReassemblyCreatePacket(false, 5002, "\n"));
+	// this packet is larger than the stream buffer
+	packetStream.push_back(tcpReassemblyCreatePacket(false, 5003, std::string(40, 'x')));
+	packetStream.push_back(tcpReassemblyCreatePacket(false, 5043, "abc"));
+
+	TcpReassemblyStreamBufferResults results;
+	pcpp::TcpReassemblyConfiguration config(true, 5, 30, 0, true, 32);
+	pcpp::TcpReassembly tcpReassembly(tcpReassemblyStreamBufferMsgReadyCallback, &results, NULL, NULL, config);
+	for (std::vector<pcpp::RawPacket>::iterator iter = packetStream.begin(); iter != packetStream.end(); iter++)
+	{
+		pcpp::Packet packet(&(*iter));
+		tcpReassembly.reassemblePacket(packet);
+	}
+
+	PTF_ASSERT_EQUAL(tcpReassembly.getConnectionInformation().size(), 1, size);
+	uint32_t flowKey = tcpReassembly.getConnectionInformation().begin()->first;
+	PTF_ASSERT_EQUAL(results.numOfMessagesWithoutBuffer, 0, int);
+	PTF_ASSERT_EQUAL(results.totalMissingBytes, 15, size);
+
+	// the lines were parsed from the buffer although they span several packets, came out-of-order or after missing data.
+	// The partial line before the second gap wasn't joined to the data after it
+	PTF_ASSERT_EQUAL(results.lines[0].size(), 6, size);
+	PTF_ASSERT_EQUAL(results.lines[0][0], "GET /a HTTP", string);
+	PTF_ASSERT_EQUAL(results.lines[0][1], "GET /b", string);
+	PTF_ASSERT_EQUAL(results.lines[0][2], "X", string);
+	PTF_ASSERT_EQUAL(results.lines[0][3], "late", string);
+	PTF_ASSERT_EQUAL(results.lines[0][4], "def", string);
+	PTF_ASSERT_EQUAL(results.lines[0][5], "ghi", string);
+	PTF_ASSERT_EQUAL(results.lines[1].size(), 1, size);
+	PTF_ASSERT_EQUAL(results.lines[1][0], "OK", string);
+
+	// the data left in the buffer is still available after the connection is closed
+	tcpReassembly.closeAllConnections();
+	pcpp::TcpStreamBuffer* clientBuffer = tcpReassembly.getStreamBuffer(flowKey, 0);
+	PTF_ASSERT_NOT_NULL(clientBuffer);
+	PTF_ASSERT_FALSE(clientBuffer->hasGap());
+	PTF_ASSERT_FALSE(clientBuffer->isOverflowed());
+	PTF_ASSERT_EQUAL(clientBuffer->getConsumedByteCount(), 37, u64);
+	PTF_ASSERT_EQUAL(clientBuffer->getMissingByteCount(), 15, size);
+	PTF_ASSERT_EQUAL(clientBuffer->getDroppedByteCount(), 0, size);
+	PTF_ASSERT_EQUAL(clientBuffer->getMaxSize(), 32, size);
+	PTF_ASSERT_EQUAL(clientBuffer->getDataLength(), 2, size);
+	PTF_ASSERT_NULL(clientBuffer->peek(3));
+	PTF_ASSERT_NOT_NULL(clientBuffer->peek(2));
+	PTF_ASSERT_BUF_COMPARE(clientBuffer->peek(2), "zz", 2);
+	PTF_ASSERT_EQUAL(clientBuffer->consume(1), 1, size);
+	PTF_ASSERT_BUF_COMPARE(clientBuffer->getData(), "z", 1);
+	PTF_ASSERT_EQUAL(clientBuffer->consume(10), 1, size);
+	PTF_ASSERT_NULL(clientBuffer->getData());
+	PTF_ASSERT_EQUAL(clientBuffer->getConsumedByteCount(), 39, u64);
+
+	// the buffer overflowed with the large packet, so the data after it was dropped as well
+	pcpp::TcpStreamBuffer* serverBuffer = tcpReassembly.getStreamBuffer(flowKey, 1);
+	PTF_ASSERT_NOT_NULL(serverBuffer);
+	PTF_ASSERT_TRUE(serverBuffer->isOverflowed());
+	PTF_ASSERT_EQUAL(serverBuffer->getDroppedByteCount(), 43, size);
+	PTF_ASSERT_EQUAL(serverBuffer->getDataLength(), 0, size);
+	PTF_ASSERT_NULL(serverBuffer->peek(1));
+	PTF_ASSERT_EQUAL(serverBuffer->getConsumedByteCount(), 3, u64);
+
+	PTF_ASSERT_NULL(tcpReassembly.getStreamBuffer(flowKey, 2));
+	PTF_ASSERT_NULL(tcpReassembly.getStreamBuffer(flowKey + 1, 0));
+
+	// stream buffers aren't used by default
+	TcpReassemblyStreamBufferResults resultsWithoutBuffers;
+	pcpp::TcpReassembly tcpReassemblyWithoutBuffers(tcpReassemblyStreamBufferMsgReadyCallback, &resultsWithoutBuffers);
+	for (std::vector<pcpp::RawPacket>::iterator iter = packetStream.begin(); iter != packetStream.end(); iter++)
+	{
+		pcpp::Packet packet(&(*iter));
+		tcpReassemblyWithoutBuffers.reassemblePacket(packet);
+	}
+
+	PTF_ASSERT_EQUAL(resultsWithoutBuffers.numOfMessagesWithoutBuffer, 12, int);
+	PTF_ASSERT_NULL(tcpReassemblyWithoutBuffers.getStreamBuffer(flowKey, 0));
+} // TestTcpReassemblyStreamBuffers
+
+
+
+PTF_TEST_CASE(TestTcpReassemblyBatch)
+{
+	// two interleaved connections, the second one has an out-of-order packet
+	std::vector<pcpp::RawPacket> packetStream;
+	packetStream.push_back(tcpReassemblyCreatePacket(true, 999, "", true));
+	packetStream.push_back(tcpReassemblyCreatePacket(true, 1999, "", true, 40001));
+	packetStream.push_back(tcpReassemblyCreatePacket(false, 4999, "", true));
+	packetStream.push_back(tcpReassemblyCreatePacket(false, 6999, "", true, 40001));
+	packetStream.push_back(tcpReassemblyCreatePacket(true, 1000, "GET /a "));
+	packetStream.push_back(tcpReassemblyCreatePacket(true, 2000, "GET /x ", false, 40001));
+	packetStream.push_back(tcpReassemblyCreatePacket(true, 1007, "HTTP/1.1\n"));
+	packetStream.push_back(tcpReassemblyCreatePacket(true, 1016, "Host: a\n"));
+	packetStream.push_back(tcpReassemblyCreatePacket(true, 2016, "Host: x\n", false, 40001));
+	packetStream.push_back(tcpReassemblyCreatePacket(true, 2007, "HTTP/1.1\n", false, 40001));
+	packetStream.push_back(tcpReassemblyCreatePacket(false, 5000, "200 OK\n"));
+	packetStream.push_back(tcpReassemblyCreatePacket(false, 7000, "404\n", false, 40001));
+	packetStream.push_back(tcpReassemblyCreatePacket(false, 5007, "body"));
+	packetStream.push_back(tcpReassemblyCreatePacket(true, 1024, "more"));
+
+	const size_t numOfPackets = packetStream.size();
+	std::vector<pcpp::Packet*> packets;
+	for (std::vector<pcpp::RawPacket>::iterator iter = packetStream.begin(); iter != packetStream.end(); iter++)
+		packets.push_back(new pcpp::Packet(&(*iter)));
+
+	// reassemble the packets one by one
+	TcpReassemblyMultipleConnStats sequentialResults;
+	std::vector<pcpp::TcpReassembly::ReassemblyStatus> sequentialStatuses;
+	pcpp::TcpReassembly sequentialReassembly(tcpReassemblyMsgReadyCallback, &sequentialResults, tcpReassemblyConnectionStartCallback, tcpReassemblyConnectionEndCallback);
+	for (size_t i = 0; i < numOfPackets; i++)
+		sequentialStatuses.push_back(sequentialReassembly.reassemblePacket(*packets[i]));
+
+	// reassemble the packets as one burst
+	TcpReassemblyMultipleConnStats batchResults;
+	std::vector<pcpp::TcpReassembly::ReassemblyStatus> batchStatuses(numOfPackets);
+	pcpp::TcpReassembly batchReassembly(tcpReassemblyMsgReadyCallback, &batchResults, tcpReassemblyConnectionStartCallback, tcpReassemblyConnectionEndCallback);
+	batchReassembly.reassemblePackets(&packets[0], numOfPackets, &batchStatuses[0]);
+
+	// the per-packet statuses and the per-connection data are the same
+	for (size_t i = 0; i < numOfPackets; i++)
+	{
+		PTF_ASSERT_EQUAL(batchStatuses[i], sequentialStatuses[i], enum);
+	}
+	PTF_ASSERT_EQUAL(batchStatuses[8], pcpp::TcpReassembly::OutOfOrderTcpMessageBuffered, enum);
+	PTF_ASSERT_EQUAL(batchResults.flowKeysList.size(), 2, size);
+	PTF_ASSERT_EQUAL(batchResults.stats.size(), 2, size);
+	for (TcpReassemblyMultipleConnStats::Stats::iterator iter = batchResults.stats.begin(); iter != batchResults.stats.end(); iter++)
+	{
+		TcpReassemblyStats& sequentialStats = sequentialResults.stats[iter->first];
+		PTF_ASSERT_TRUE(iter->second.connectionsStarted);
+		PTF_ASSERT_EQUAL(iter->second.reassembledData, sequentialStats.reassembledData, string);
+		PTF_ASSERT_EQUAL(iter->second.numOfMessagesFromSide[0], sequentialStats.numOfMessagesFromSide[0], int);
+		PTF_ASSERT_EQUAL(iter->second.numOfMessagesFromSide[1], sequentialStats.numOfMessagesFromSide[1], int);
+	}
+
+	// consecutive in-order data of the same side is delivered in a single callback
+	uint32_t firstFlowKey = pcpp::hash5Tuple(packets[0]);
+	uint32_t secondFlowKey = pcpp::hash5Tuple(packets[1]);
+	PTF_ASSERT_EQUAL(batchResults.stats[firstFlowKey].reassembledData, "GET /a HTTP/1.1\nHost: a\n200 OK\nbodymore", string);
+	PTF_ASSERT_EQUAL(sequentialResults.stats[firstFlowKey].numOfDataPackets, 6, int);
+	PTF_ASSERT_EQUAL(batchResults.stats[firstFlowKey].numOfDataPackets, 3, int);
+	PTF_ASSERT_EQUAL(batchResults.stats[secondFlowKey].reassembledData, "GET /x HTTP/1.1\nHost: x\n404\n", string);
+	PTF_ASSERT_EQUAL(sequentialResults.stats[secondFlowKey].numOfDataPackets, 4, int);
+	PTF_ASSERT_EQUAL(batchResults.stats[secondFlowKey].numOfDataPackets, 2, int);
+
+	// with stream buffers the combined data is read from the buffer, and it's the same data
+	TcpReassemblyMultipleConnStats streamBufferResults;
+	pcpp::TcpReassemblyConfiguration streamBufferConfig(true, 5, 30, 0, true);
+	pcpp::TcpReassembly streamBufferReassembly(tcpReassemblyMsgReadyCallback, &streamBufferResults, NULL, NULL, streamBufferConfig);
+	streamBufferReassembly.reassemblePackets(&packets[0], numOfPackets);
+	PTF_ASSERT_EQUAL(streamBufferResults.stats[firstFlowKey].reassembledData, batchResults.stats[firstFlowKey].reassembledData, string);
+	PTF_ASSERT_EQUAL(streamBufferResults.stats[firstFlowKey].numOfDataPackets, 3, int);
+	PTF_ASSERT_EQUAL(streamBufferResults.stats[secondFlowKey].reassembledData, batchResults.stats[secondFlowKey].reassembledData, string);
+	PTF_ASSERT_EQUAL(streamBufferResults.stats[secondFlowKey].numOfDataPackets, 2, int);
+	pcpp::TcpStreamBuffer* clientBuffer = streamBufferReassembly.getStreamBuffer(firstFlowKey, 0);
+	PTF_ASSERT_NOT_NULL(clientBuffer);
+	PTF_ASSERT_EQUAL(clientBuffer->getDataLength(), 28, size);
+	PTF_ASSERT_BUF_COMPARE(clientBuffer->getData(), "GET /a HTTP/1.1\nHost: a\nmore", 28);
+
+	// single packets can still be processed after a burst
+	pcpp::RawPacket lastRawPacket = tcpReassemblyCreatePacket(true, 1028, "!");
+	pcpp::Packet lastPacket(&lastRawPacket);
+	PTF_ASSERT_EQUAL(batchReassembly.reassemblePacket(lastPacket), pcpp::TcpReassembly::TcpMessageHandled, enum);
+	PTF_ASSERT_EQUAL(batchResults.stats[firstFlowKey].numOfDataPackets, 4, int);
+	PTF_ASSERT_EQUAL(batchResults.stats[firstFlowKey].reassembledData, "GET /a HTTP/1.1\nHost: a\n200 OK\nbodymore!", string);
+
+	batchReassembly.closeAllConnections();
+	PTF_ASSERT_TRUE(batchResults.stats[firstFlowKey].connectionsEndedManually);
+	PTF_ASSERT_TRUE(batchResults.stats[secondFlowKey].connectionsEndedManually);
+
+	for (std::vector<pcpp::Packet*>::iterator iter = packets.begin(); iter != packets.end(); iter++)
+		delete *iter;
+} // TestTcpReassemblyBatch
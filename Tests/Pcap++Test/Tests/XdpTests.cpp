@@ -0,0 +1,166 @@
+#include "../TestDefinition.h"
+#include "../Common/TestUtils.h"
+#include "../Common/PcapFileNamesDef.h"
+#include "Logger.h"
+#include "XdpDevice.h"
+#include "SystemUtils.h"
+#include <stdlib.h>
+#include <string.h>
+
+
+#ifdef USE_XDP
+
+#define XDP_TEST_TX_INTERFACE "pcppXdpTest0"
+#define XDP_TEST_RX_INTERFACE "pcppXdpTest1"
+
+/**
+ * Creates a veth pair for the duration of a test so the tests don't depend on a real NIC. IPv6 is disabled on both ends so the kernel
+ * doesn't send its own packets over the pair
+ */
+class XdpVethPair
+{
+public:
+	XdpVethPair()
+	{
+		system("ip link del " XDP_TEST_TX_INTERFACE " > /dev/null 2>&1");
+		m_Created = system("ip link add " XDP_TEST_TX_INTERFACE " type veth peer name " XDP_TEST_RX_INTERFACE " > /dev/null 2>&1") == 0;
+		if (!m_Created)
+			return;
+
+		system("sysctl -qw net.ipv6.conf." XDP_TEST_TX_INTERFACE ".disable_ipv6=1 > /dev/null 2>&1");
+		system("sysctl -qw net.ipv6.conf." XDP_TEST_RX_INTERFACE ".disable_ipv6=1 > /dev/null 2>&1");
+		m_Created = system("ip link set " XDP_TEST_TX_INTERFACE " up && ip link set " XDP_TEST_RX_INTERFACE " up") == 0;
+		pcpp::multiPlatformSleep(1);
+	}
+
+	~XdpVethPair()
+	{
+		system("ip link del " XDP_TEST_TX_INTERFACE " > /dev/null 2>&1");
+	}
+
+	bool isCreated() const { return m_Created; }
+
+private:
+	bool m_Created;
+};
+
+static int countXdpSentPackets(pcpp::RawPacketVector& receivedPackets, std::vector<pcpp::RawPacket>& sentPackets)
+{
+	int count = 0;
+	for (pcpp::RawPacketVector::VectorIterator iter = receivedPackets.begin(); iter != receivedPackets.end(); iter++)
+	{
+		for (std::vector<pcpp::RawPacket>::iterator sentIter = sentPackets.begin(); sentIter != sentPackets.end(); sentIter++)
+		{
+			if ((*iter)->getRawDataLen() == sentIter->getRawDataLen() && memcmp((*iter)->getRawData(), sentIter->getRawData(), sentIter->getRawDataLen()) == 0)
+			{
+				count++;
+				break;
+			}
+		}
+	}
+
+	return count;
+}
+
+static void xdpOnPacketsArrive(pcpp::RawPacket* packets, uint32_t numOfPackets, uint8_t threadId, pcpp::XdpDevice* device, void* userCookie)
+{
+	pcpp::RawPacketVector* receivedPackets = (pcpp::RawPacketVector*)userCookie;
+	for (uint32_t i = 0; i < numOfPackets; i++)
+		receivedPackets->pushBack(new pcpp::RawPacket(packets[i]));
+}
+
+#endif
+
+
+
+PTF_TEST_CASE(TestXdpDevice)
+{
+#ifdef USE_XDP
+	XdpVethPair vethPair;
+	if (!vethPair.isCreated())
+	{
+		PTF_SKIP_TEST("Cannot create a veth pair");
+	}
+
+	std::vector<pcpp::RawPacket> packetStream;
+	std::string errMsg;
+	PTF_ASSERT_TRUE(readPcapIntoPacketVec(EXAMPLE_PCAP_PATH, packetStream, errMsg));
+	packetStream.resize(20);
+
+	pcpp::XdpDevice::XdpDeviceConfiguration config;
+	config.attachMode = pcpp::XdpDevice::XdpAttachModeGeneric;
+	config.numOfFrames = 512;
+	config.ringSize = 256;
+
+	pcpp::LoggerPP::getInstance().supressErrors();
+	pcpp::XdpDevice nonExistingDev("pcppNoSuchDev");
+	PTF_ASSERT_FALSE(nonExistingDev.open());
+	pcpp::XdpDevice::XdpDeviceConfiguration invalidConfig;
+	invalidConfig.ringSize = 1000;
+	pcpp::XdpDevice invalidConfigDev(XDP_TEST_RX_INTERFACE);
+	PTF_ASSERT_FALSE(invalidConfigDev.openMultiQueues(1, invalidConfig));
+	PTF_ASSERT_FALSE(invalidConfigDev.openMultiQueues(invalidConfigDev.getTotalNumOfRxQueues() + 1, config));
+	pcpp::LoggerPP::getInstance().enableErrors();
+
+	pcpp::XdpDevice txDev(XDP_TEST_TX_INTERFACE);
+	pcpp::XdpDevice rxDev(XDP_TEST_RX_INTERFACE);
+	PTF_ASSERT_TRUE(txDev.openMultiQueues(1, config));
+	DeviceTeardown txDevTeardown(&txDev);
+	PTF_ASSERT_TRUE(rxDev.openMultiQueues(1, config));
+	DeviceTeardown rxDevTeardown(&rxDev);
+	PTF_ASSERT_TRUE(rxDev.isOpened());
+	PTF_ASSERT_EQUAL(rxDev.getAttachMode(), pcpp::XdpDevice::XdpAttachModeGeneric, enum);
+	PTF_ASSERT_FALSE(rxDev.isZeroCopy());
+	PTF_ASSERT_EQUAL(rxDev.getNumOfOpenedQueues(), 1, u16);
+
+	// an XDP program is already attached to the interface
+	pcpp::LoggerPP::getInstance().supressErrors();
+	pcpp::XdpDevice secondRxDev(XDP_TEST_RX_INTERFACE);
+	PTF_ASSERT_FALSE(secondRxDev.openMultiQueues(1, config));
+	pcpp::LoggerPP::getInstance().enableErrors();
+
+	// receive by polling
+	PTF_ASSERT_EQUAL(txDev.sendPackets(&packetStream[0], packetStream.size()), packetStream.size(), u16);
+	pcpp::RawPacketVector receivedPackets;
+	for (int i = 0; i < 20 && countXdpSentPackets(receivedPackets, packetStream) < (int)packetStream.size(); i++)
+		rxDev.receivePackets(receivedPackets, 0, 100);
+	PTF_ASSERT_EQUAL(countXdpSentPackets(receivedPackets, packetStream), (int)packetStream.size(), int);
+
+	// receive with a capture thread
+	pcpp::RawPacketVector capturedPackets;
+	PTF_ASSERT_TRUE(rxDev.setPollingPolicy(pcpp::PollingPolicy(pcpp::PollingModeInterrupt, 10)));
+	PTF_ASSERT_TRUE(rxDev.startCaptureSingleThread(xdpOnPacketsArrive, &capturedPackets));
+	PTF_ASSERT_TRUE(rxDev.isCapturing());
+	pcpp::LoggerPP::getInstance().supressErrors();
+	PTF_ASSERT_FALSE(rxDev.setPollingPolicy(pcpp::PollingPolicy()));
+	pcpp::LoggerPP::getInstance().enableErrors();
+	for (std::vector<pcpp::RawPacket>::iterator iter = packetStream.begin(); iter != packetStream.end(); iter++)
+	{
+		PTF_ASSERT_TRUE(txDev.sendPacket(*iter));
+	}
+	pcpp::multiPlatformSleep(1);
+	rxDev.stopCapture();
+	PTF_ASSERT_FALSE(rxDev.isCapturing());
+	PTF_ASSERT_EQUAL(countXdpSentPackets(capturedPackets, packetStream), (int)packetStream.size(), int);
+
+	pcpp::PollingStats pollingStats;
+	rxDev.getPollingStats(pollingStats);
+	PTF_ASSERT_GREATER_THAN(pollingStats.numOfInterruptWaits, 0, u64);
+
+	pcpp::XdpDevice::XdpStats txStats, rxStats;
+	txDev.getStatistics(txStats);
+	rxDev.getStatistics(rxStats);
+	PTF_ASSERT_EQUAL(txStats.txPackets, (uint64_t)(2 * packetStream.size()), u64);
+	PTF_ASSERT_EQUAL(txStats.txDropped, 0, u64);
+	PTF_ASSERT_GREATER_OR_EQUAL_THAN(rxStats.rxPackets, (uint64_t)(2 * packetStream.size()), u64);
+	PTF_ASSERT_EQUAL(rxStats.rxDroppedByKernel, 0, u64);
+
+	// after closing the XDP program is detached and the interface can be opened again
+	rxDev.close();
+	PTF_ASSERT_FALSE(rxDev.isOpened());
+	PTF_ASSERT_TRUE(secondRxDev.openMultiQueues(1, config));
+	secondRxDev.close();
+#else
+	PTF_SKIP_TEST("AF_XDP not configured");
+#endif
+} // TestXdpDevice
@@ -209,6 +209,8 @@ int main(int argc, char* argv[])
 	PTF_RUN_TEST(TestPcapNgFileReadWriteAdv, "no_network;pcap;pcapng");
 	PTF_RUN_TEST(TestPcapFileReadLinkTypeIPv6, "no_network;pcap");
 	PTF_RUN_TEST(TestPcapFileReadLinkTypeIPv4, "no_network;pcap");
+	PTF_RUN_TEST(TestAsyncPcapFileReadWrite, "no_network;pcap;pcapng;async_file");
+	PTF_RUN_TEST(TestRotatingPcapFileWriter, "no_network;pcap;pcapng;async_file");
 
 	PTF_RUN_TEST(TestPcapLiveDeviceList, "no_network;live_device;skip_mem_leak_check");
 	PTF_RUN_TEST(TestPcapLiveDeviceListSearch, "live_device");
@@ -235,6 +237,7 @@ int main(int argc, char* argv[])
 
 	PTF_RUN_TEST(TestPfRingDevice, "pf_ring");
 	PTF_RUN_TEST(TestPfRingDeviceSingleChannel, "pf_ring");
+	PTF_RUN_TEST(TestPfRingPollingPolicy, "pf_ring");
 	PTF_RUN_TEST(TestPfRingMultiThreadAllCores, "pf_ring");
 	PTF_RUN_TEST(TestPfRingMultiThreadSomeCores, "pf_ring");
 	PTF_RUN_TEST(TestPfRingSendPacket, "pf_ring");
@@ -264,8 +267,11 @@ int main(int argc, char* argv[])
 	PTF_RUN_TEST(TestTcpReassemblyCleanup, "no_network;tcp_reassembly");
 	PTF_RUN_TEST(TestTcpReassemblyMaxOOOFrags, "no_network;tcp_reassembly");
 	PTF_RUN_TEST(TestTcpReassemblyMaxSeq, "no_network;tcp_reassembly");
+	PTF_RUN_TEST(TestTcpReassemblyStreamBuffers, "no_network;tcp_reassembly");
+	PTF_RUN_TEST(TestTcpReassemblyBatch, "no_network;tcp_reassembly");
 
 	PTF_RUN_TEST(TestIPFragmentationSanity, "no_network;ip_frag");
+	PTF_RUN_TEST(TestIPFragmentationBatch, "no_network;ip_frag");
 	PTF_RUN_TEST(TestIPFragOutOfOrder, "no_network;ip_frag");
 	PTF_RUN_TEST(TestIPFragPartialData, "no_network;ip_frag");
 	PTF_RUN_TEST(TestIPFragMultipleFrags, "no_network;ip_frag");
@@ -274,6 +280,31 @@ int main(int argc, char* argv[])
 
 	PTF_RUN_TEST(TestRawSockets, "raw_sockets");
 
+	PTF_RUN_TEST(TestCoreMask, "no_network;system_utils");
+	PTF_RUN_TEST(TestSystemCoreTopology, "no_network;system_utils");
+
+	PTF_RUN_TEST(TestPollingControllerBusySpin, "no_network;polling_policy");
+	PTF_RUN_TEST(TestPollingControllerBackoff, "no_network;polling_policy");
+	PTF_RUN_TEST(TestPollingControllerInterrupt, "no_network;polling_policy");
+	PTF_RUN_TEST(TestPollingStats, "no_network;polling_policy");
+
+	PTF_RUN_TEST(TestCaptureStreamFile, "no_network;capture_stream");
+	PTF_RUN_TEST(TestCaptureStreamFilter, "no_network;capture_stream");
+
+	PTF_RUN_TEST(TestXdpDevice, "xdp");
+
+	PTF_RUN_TEST(TestFlightRecorderDump, "no_network;flight_recorder");
+
+	PTF_RUN_TEST(TestPacketMerger, "no_network;packet_merger");
+	PTF_RUN_TEST(TestPacketMergerThreads, "no_network;packet_merger");
+	PTF_RUN_TEST(TestPacketLoadBalancer, "no_network;load_balancer");
+	PTF_RUN_TEST(TestPacketLoadBalancerRebalance, "no_network;load_balancer");
+	PTF_RUN_TEST(TestPacketLoadBalancerThreads, "no_network;load_balancer");
+	PTF_RUN_TEST(TestPacketLoadBalancerProcesses, "no_network;load_balancer");
+	PTF_RUN_TEST(TestSharedMemoryRing, "no_network;shared_memory_ring");
+	PTF_RUN_TEST(TestSharedMemoryRingOverwrite, "no_network;shared_memory_ring");
+	PTF_RUN_TEST(TestSharedMemoryRingProcesses, "no_network;shared_memory_ring");
+
 	PTF_END_RUNNING_TESTS;
 }
 